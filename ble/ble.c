@@ -22,12 +22,15 @@
 #include "nvs.h"
 #include "nvs_flash.h"
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "esp_bt.h"
 #include "esp_gap_ble_api.h"
 #include "esp_gattc_api.h"
 #include "esp_bt_main.h"
 #include "esp_gatt_common_api.h"
 #include "esp_timer.h"
+#include "scan_rank.h"
 
 #define TAG "BLE"
 
@@ -43,17 +46,106 @@ static bool s_connecting = false;
 /* 全局保存的 Notify 回调 */
 static ble_notify_callback_t s_notify_cb = NULL;
 
-/* Set logic layer disconnection state callback */
-/* 设置逻辑层断开连接状态回调 */
+/* Set logic layer link state callback */
+/* 设置逻辑层链路状态回调 */
 static connect_logic_state_callback_t s_state_cb = NULL;
 
+/* Globally saved MTU callback */
+/* 全局保存的 MTU 回调 */
+static ble_mtu_callback_t s_mtu_cb = NULL;
+
 /* Attempt to connect when the target device is scanned */
 /* 扫描到目标设备，尝试连接 */
-#define MIN_RSSI_THRESHOLD -80          // Set minimum signal strength threshold, adjust as needed
 static esp_bd_addr_t best_addr = {0};   // Store the address of the device with the strongest signal
 static int8_t best_rssi = -128;         // Store the RSSI value of the device with the strongest signal, initialized to the weakest signal strength
 static bool s_is_reconnecting = false;  // Whether in reconnection mode
 static bool s_found_previous_device = false;  // Whether the original device was found in reconnection mode
+static bool s_scan_cancelled = false;  // The running scan ends without connecting / 当前扫描结束时不发起连接
+
+/* Cameras heard by the running scan, ranked by smoothed RSSI; a fresh pairing stops once one clearly leads */
+/* 当前扫描听到的相机，按平滑 RSSI 排名；首次配对在某台相机明显领先时即停止扫描 */
+static scan_rank_t s_scan_rank;
+static bool s_scan_stop_requested = false;
+
+/* Handles of the last camera connected with notifications enabled, set from NVS by the logic layer */
+/* 最近一次成功使能通知的相机的句柄，由逻辑层从 NVS 设置 */
+static struct {
+    bool valid;
+    esp_bd_addr_t bda;
+    ble_gatt_handles_t handles;
+} s_handle_cache;
+
+/* Write Without Response frames waiting for controller buffers. Frames go out while the stack reports free
+ * buffers and is not congested; otherwise the queue stalls until a write completes or the congestion clears,
+ * and the GATTC callback then wakes the TX task to go on. The callback never takes s_tx_mutex, as a drain may
+ * block in esp_ble_gattc_write_char until the BTC task is free. */
+/* 等待控制器缓冲区的 Write Without Response 帧。协议栈报告有空闲缓冲区且未拥塞时发送；否则队列停滞，
+ * 直到有写入完成或拥塞解除，再由 GATTC 回调唤醒发送任务继续发送。回调从不获取 s_tx_mutex，
+ * 因为发送时可能阻塞在 esp_ble_gattc_write_char 中，直到 BTC 任务空闲。 */
+#define BLE_TX_LOCK_MS 100
+
+/* Quarters of the link's buffers a priority leaves free for higher ones: frames already handed to the controller
+ * cannot be overtaken, so bulk and stream traffic must not fill it ahead of a command */
+/* 各优先级为更高优先级保留的链路缓冲区比例（以四分之一计）：已交给控制器的帧无法被超越，
+ * 因此批量与流数据不得抢先占满控制器而使命令排在其后 */
+static const uint8_t s_tx_headroom_quarters[BLE_TX_PRIO_COUNT] = { 0, 1, 2 };
+
+static tx_queue_t s_tx_queue;
+static SemaphoreHandle_t s_tx_mutex = NULL;
+static TaskHandle_t s_tx_task = NULL;
+static volatile bool s_tx_congested = false;    // Set by ESP_GATTC_CONGEST_EVT / 由 ESP_GATTC_CONGEST_EVT 设置
+static volatile uint32_t s_tx_congestions = 0;
+static volatile bool s_tx_flush_pending = false;  // A link closed since the last drain / 上次发送后有链路关闭
+static uint16_t s_tx_credits_max = 0;   // Most buffers the stack reported free on this link / 本链路上协议栈报告的最多空闲缓冲区数
+
+static ble_link_timing_t s_link_timing;
+static bool s_validating_handles = false;   // Read of the cached notify declaration in flight / 缓存的通知特征声明正在读取
+static bool s_notify_requested = false;     // ble_register_notify was called on this link / 本次连接已调用 ble_register_notify
+
+/* Connection parameters of each link profile, intervals in 1.25 ms units and timeouts in 10 ms units.
+ * Idle keeps the 30 ms interval links are opened with and lets the camera skip 4 events in 5. The first command
+ * of a button press goes out at once on the current link: the camera listens at every event once it hears the
+ * update sent when the button went down, and the interactive interval follows.
+ * Data length and PHY are only ever raised: both shorten the air time of every frame, so an idle link keeps them. */
+/* 各链路配置的连接参数，间隔单位 1.25 ms，超时单位 10 ms。
+ * idle 保持建链时的 30 ms 间隔，并允许相机每 5 个事件跳过 4 个。按键后的第一条命令立即在当前链路上发出：
+ * 相机收到按下时发出的更新后在每个事件监听，随后交互间隔生效。
+ * 数据长度与 PHY 只升不降：两者都缩短每帧的空中时间，因此空闲链路也保留它们。 */
+typedef struct {
+    uint16_t min_int;
+    uint16_t max_int;
+    uint16_t latency;
+    uint16_t timeout;
+    uint16_t tx_octets;            // Data length to request, 0 keeps the current one / 请求的数据长度，0 表示保持当前值
+    bool phy_2m;                   // Ask for the 2M PHY / 请求 2M PHY
+} link_profile_params_t;
+
+static const link_profile_params_t s_link_profiles[BLE_LINK_PROFILE_COUNT] = {
+    [BLE_LINK_PROFILE_IDLE]        = { .min_int = 24, .max_int = 24,  .latency = 4, .timeout = 400 },
+    [BLE_LINK_PROFILE_INTERACTIVE] = { .min_int = 6,  .max_int = 12,  .latency = 0, .timeout = 400,
+                                       .tx_octets = 251, .phy_2m = true },
+    [BLE_LINK_PROFILE_STREAMING]   = { .min_int = 24, .max_int = 40,  .latency = 0, .timeout = 400,
+                                       .tx_octets = 251, .phy_2m = true },
+};
+
+/* Link profile state, written from the GAP callback and from the caller of ble_set_link_profile.
+ * Only one connection update is in flight; the wanted profile is applied once it completes. */
+/* 链路配置状态，由 GAP 回调与 ble_set_link_profile 的调用方写入。
+ * 同一时间只有一个连接参数更新在进行；它完成后再应用期望的配置。 */
+static portMUX_TYPE s_link_lock = portMUX_INITIALIZER_UNLOCKED;
+static struct {
+    bool ready;                    // Notifications enabled, parameters may change / 通知已使能，可以修改参数
+    bool update_pending;           // Connection update in flight / 连接参数更新进行中
+    bool dle_requested;            // Data length requested on this link / 本链路已请求数据长度
+    bool phy_requested;            // 2M PHY requested on this link / 本链路已请求 2M PHY
+    uint8_t refused;               // Profiles refused since they were last requested, one bit each / 自上次请求以来被拒绝的配置，每个一位
+    ble_link_profile_t wanted;
+    ble_link_profile_t requested;
+    ble_link_params_t params;
+} s_link = {
+    .wanted = BLE_LINK_PROFILE_COUNT,
+    .params = { .profile = BLE_LINK_PROFILE_COUNT, .tx_octets = 27, .phy = ESP_BLE_GAP_PHY_1M },
+};
 
 /* Only one profile is stored */
 /* 仅存一个 profile */
@@ -67,6 +159,7 @@ ble_profile_t s_ble_profile = {
     .read_char_handle = 0,
     .service_start_handle = 0,
     .service_end_handle = 0,
+    .mtu = BLE_DEFAULT_MTU,
     .connection_status = {
         .is_connected = false,
     },
@@ -74,6 +167,7 @@ ble_profile_t s_ble_profile = {
         .notify_char_handle_found = false,
         .write_char_handle_found = false,
     },
+    .notify_cccd_handle = 0,
 };
 
 /* Define the Service/Characteristic UUIDs to filter, for search use */
@@ -117,6 +211,166 @@ static void gattc_event_handler(esp_gattc_cb_event_t event,
 
 static TimerHandle_t scan_timer;
 
+static void report_link_event(ble_link_event_t event, int reason) {
+    if (s_state_cb) {
+        s_state_cb(event, reason);
+    }
+}
+
+/* Drop the frames of a closed link, called with s_tx_mutex held */
+/* 丢弃已关闭链路的帧，调用时持有 s_tx_mutex */
+static void tx_flush_closed_locked(int64_t now) {
+    if (s_tx_flush_pending || !s_ble_profile.connection_status.is_connected) {
+        s_tx_flush_pending = false;
+        s_tx_credits_max = 0;
+        const uint32_t flushed = tx_queue_flush(&s_tx_queue, now);
+        if (flushed) {
+            ESP_LOGW(TAG, "Link closed, dropped %u queued frames", (unsigned)flushed);
+        }
+    }
+}
+
+/* Hand queued frames to the stack while it has buffers, called with s_tx_mutex held */
+/* 在协议栈有缓冲区时将排队的帧交给协议栈，调用时持有 s_tx_mutex */
+static void tx_drain_locked(void) {
+    const int64_t now = esp_timer_get_time();
+
+    tx_flush_closed_locked(now);
+    if (!s_ble_profile.connection_status.is_connected) {
+        return;
+    }
+
+    const tx_frame_t *frame;
+    ble_tx_prio_t prio;
+    while ((frame = tx_queue_peek(&s_tx_queue, &prio)) != NULL) {
+        if (s_tx_congested) {
+            break;
+        }
+        const uint16_t credits = esp_ble_get_cur_sendable_packets_num(s_ble_profile.conn_id);
+        if (credits > s_tx_credits_max) {
+            s_tx_credits_max = credits;
+        }
+        if (credits == 0 || credits <= s_tx_credits_max * s_tx_headroom_quarters[prio] / 4) {
+            break;
+        }
+        esp_err_t ret = esp_ble_gattc_write_char(s_ble_profile.gattc_if,
+                                                 s_ble_profile.conn_id,
+                                                 frame->handle,
+                                                 frame->length,
+                                                 (uint8_t *)frame->data,
+                                                 ESP_GATT_WRITE_TYPE_NO_RSP,
+                                                 ESP_GATT_AUTH_REQ_NONE);
+        if (ret != ESP_OK) {
+            ESP_LOGD(TAG, "write_char NO_RSP deferred: %s", esp_err_to_name(ret));
+            break;
+        }
+        tx_queue_pop(&s_tx_queue, now);
+    }
+
+    const bool stalled = frame != NULL;
+    tx_queue_set_stalled(&s_tx_queue, stalled, now);
+    // A writer that stalls hands over to the TX task, which waits for the stack's next event
+    // 停滞的写入者交由发送任务接手，由其等待协议栈的下一个事件
+    if (stalled && xTaskGetCurrentTaskHandle() != s_tx_task) {
+        xTaskNotifyGive(s_tx_task);
+    }
+}
+
+/* Drains the queue whenever a GATTC event says the stack can take more, or a link closed */
+/* 每当 GATTC 事件表明协议栈可以接收更多数据或链路关闭时发送队列中的帧 */
+static void tx_task(void *arg) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        // A writer holding the lock drains the queue itself and wakes this task again if it stalls
+        // 持锁的写入者会自行发送，停滞时会再次唤醒本任务
+        if (xSemaphoreTake(s_tx_mutex, pdMS_TO_TICKS(BLE_TX_LOCK_MS)) != pdTRUE) {
+            ESP_LOGW(TAG, "TX queue busy, drain skipped");
+            continue;
+        }
+        tx_drain_locked();
+        xSemaphoreGive(s_tx_mutex);
+    }
+}
+
+/* Wake the TX task from a GATTC callback */
+/* 在 GATTC 回调中唤醒发送任务 */
+static void tx_wake(void) {
+    if (s_tx_task != NULL) {
+        xTaskNotifyGive(s_tx_task);
+    }
+}
+
+/* Forget the profile state of a closed link; the next link starts with the parameters it was opened with */
+/* 清除已关闭链路的配置状态；下一条链路以建链时的参数开始 */
+static void link_profile_reset(void) {
+    portENTER_CRITICAL(&s_link_lock);
+    s_link.ready = false;
+    s_link.update_pending = false;
+    s_link.dle_requested = false;
+    s_link.phy_requested = false;
+    s_link.refused = 0;
+    s_link.wanted = BLE_LINK_PROFILE_COUNT;
+    memset(&s_link.params, 0, sizeof(s_link.params));
+    s_link.params.profile = BLE_LINK_PROFILE_COUNT;
+    s_link.params.tx_octets = 27;
+    s_link.params.phy = ESP_BLE_GAP_PHY_1M;
+    portEXIT_CRITICAL(&s_link_lock);
+}
+
+/* Request the wanted profile unless an update is in flight or it is already in effect */
+/* 请求期望的配置，除非已有更新在进行或该配置已生效 */
+static void link_profile_apply(void) {
+    portENTER_CRITICAL(&s_link_lock);
+    const ble_link_profile_t profile = s_link.wanted;
+    const bool issue = s_link.ready && !s_link.update_pending && profile < BLE_LINK_PROFILE_COUNT &&
+                       profile != s_link.params.profile && !(s_link.refused & (1u << profile));
+    const link_profile_params_t *p = &s_link_profiles[issue ? profile : 0];
+    const bool dle = issue && p->tx_octets && !s_link.dle_requested;
+    const bool phy = issue && p->phy_2m && !s_link.phy_requested;
+    if (issue) {
+        s_link.update_pending = true;
+        s_link.requested = profile;
+        s_link.dle_requested |= dle;
+        s_link.phy_requested |= phy;
+    }
+    portEXIT_CRITICAL(&s_link_lock);
+    if (!issue) {
+        return;
+    }
+
+    esp_ble_conn_update_params_t conn_params = {
+        .min_int = p->min_int,
+        .max_int = p->max_int,
+        .latency = p->latency,
+        .timeout = p->timeout,
+    };
+    memcpy(conn_params.bda, s_ble_profile.remote_bda, sizeof(esp_bd_addr_t));
+    esp_err_t ret = esp_ble_gap_update_conn_params(&conn_params);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Connection update to %s failed: %s", ble_link_profile_name(profile), esp_err_to_name(ret));
+        portENTER_CRITICAL(&s_link_lock);
+        s_link.update_pending = false;
+        portEXIT_CRITICAL(&s_link_lock);
+        return;
+    }
+    ESP_LOGI(TAG, "Switching link to %s profile", ble_link_profile_name(profile));
+    if (dle) {
+        ret = esp_ble_gap_set_pkt_data_len(s_ble_profile.remote_bda, p->tx_octets);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Data length request failed: %s", esp_err_to_name(ret));
+        }
+    }
+    if (phy) {
+        ret = esp_ble_gap_set_preferred_phy(s_ble_profile.remote_bda, 0,
+                                            ESP_BLE_GAP_PHY_1M_PREF_MASK | ESP_BLE_GAP_PHY_2M_PREF_MASK,
+                                            ESP_BLE_GAP_PHY_1M_PREF_MASK | ESP_BLE_GAP_PHY_2M_PREF_MASK,
+                                            ESP_BLE_GAP_PHY_OPTIONS_NO_PREF);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "PHY request failed: %s", esp_err_to_name(ret));
+        }
+    }
+}
+
 void scan_stop_timer_callback(TimerHandle_t xTimer) {
     esp_ble_gap_stop_scanning();
     ESP_LOGI(TAG, "Scan stopped after timeout");
@@ -124,16 +378,16 @@ void scan_stop_timer_callback(TimerHandle_t xTimer) {
 
 static void trigger_scan_task(void) {
     ESP_LOGI(TAG, "esp_ble_gap_start_scanning...");
+    s_scan_cancelled = false;
+    s_scan_stop_requested = false;
+    scan_rank_reset(&s_scan_rank, NULL, esp_timer_get_time());
     esp_err_t ret = esp_ble_gap_start_scanning(6);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to start scanning: %s", esp_err_to_name(ret));
     }
-    // Start a timer to stop scanning after 4 seconds
-    // 启动定时器，在4秒后停止扫描
-    scan_timer = xTimerCreate("scan_timer", pdMS_TO_TICKS(4000), pdFALSE, (void *)0, scan_stop_timer_callback);
-    if (scan_timer != NULL) {
-        xTimerStart(scan_timer, 0);
-    }
+    // Stop scanning after 4 seconds unless the ranking ends the scan earlier
+    // 4 秒后停止扫描，除非排名提前结束扫描
+    xTimerStart(scan_timer, 0);
 }
 
 /* -------------------------
@@ -196,6 +450,29 @@ esp_err_t ble_init() {
         return ret;
     }
 
+    /* Create the TX queue lock and the task that resumes a stalled queue */
+    /* 创建发送队列锁及恢复停滞队列的任务 */
+    if (s_tx_mutex == NULL) {
+        tx_queue_init(&s_tx_queue);
+        s_tx_mutex = xSemaphoreCreateMutex();
+        if (s_tx_mutex == NULL || xTaskCreate(tx_task, "ble_tx", 3072, NULL, 4, &s_tx_task) != pdPASS) {
+            ESP_LOGE(TAG, "TX queue init failed");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    /* Create the scan window timer once; every scan restarts it and a scan that ends early stops it,
+     * so the timer of an earlier scan cannot stop a later one */
+    /* 扫描窗口定时器只创建一次；每次扫描重新启动它，提前结束的扫描将其停止，
+     * 避免前一次扫描的定时器停止后一次扫描 */
+    if (scan_timer == NULL) {
+        scan_timer = xTimerCreate("scan_timer", pdMS_TO_TICKS(4000), pdFALSE, (void *)0, scan_stop_timer_callback);
+        if (scan_timer == NULL) {
+            ESP_LOGE(TAG, "Scan timer init failed");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
     /* Register GAP callback */
     /* 注册 GAP 回调 */
     ret = esp_ble_gap_register_callback(gap_event_handler);
@@ -222,7 +499,7 @@ esp_err_t ble_init() {
 
     /* Set local MTU (optional) */
     /* 设置本地 MTU（可选） */
-    esp_ble_gatt_set_local_mtu(500);
+    esp_ble_gatt_set_local_mtu(BLE_LOCAL_MTU);
 
     ESP_LOGI(TAG, "ble_init success!");
     return ESP_OK;
@@ -261,12 +538,21 @@ esp_err_t ble_start_scanning_and_connect(void) {
     return ESP_OK;
 }
 
-static void try_to_connect(esp_bd_addr_t addr) {
+/**
+ * @brief Stop a running scan without connecting to the device it found
+ * 停止正在进行的扫描，且不连接已扫描到的设备
+ */
+void ble_stop_scanning(void) {
+    s_scan_cancelled = true;
+    esp_ble_gap_stop_scanning();
+}
+
+static bool try_to_connect(esp_bd_addr_t addr) {
     // Check if already connecting
     // 检查是否正在连接中
     if (s_connecting) {
         ESP_LOGW(TAG, "Already in connecting state, please wait...");
-        return;
+        return false;
     }
 
     // Check if the address is the initial value (all zeros)
@@ -281,10 +567,12 @@ static void try_to_connect(esp_bd_addr_t addr) {
 
     if (!is_valid) {
         ESP_LOGE(TAG, "Invalid device address (all zeros)");
-        return;
+        return false;
     }
 
     s_connecting = true;
+    memset(&s_link_timing, 0, sizeof(s_link_timing));
+    s_link_timing.open_us = esp_timer_get_time();
     ESP_LOGI(TAG, "Try to connect target device name = %s, MAC: %02X:%02X:%02X:%02X:%02X:%02X",
              s_remote_device_name,
              addr[0], addr[1], addr[2],
@@ -296,6 +584,7 @@ static void try_to_connect(esp_bd_addr_t addr) {
                        addr,
                        BLE_ADDR_TYPE_PUBLIC,
                        true);
+    return true;
 }
 
 void ble_set_reconnecting(bool flag) {
@@ -389,8 +678,8 @@ esp_err_t ble_read(uint16_t conn_id, uint16_t handle) {
 }
 
 /**
- * @brief Write characteristic (Write Without Response)
- * 写特征（Write Without Response）
+ * @brief Write characteristic (Write Without Response) at control priority
+ * 以控制优先级写特征（Write Without Response）
  *
  * @param conn_id   Connection ID
  *                  连接 ID
@@ -403,23 +692,146 @@ esp_err_t ble_read(uint16_t conn_id, uint16_t handle) {
  * @return esp_err_t
  */
 esp_err_t ble_write_without_response(uint16_t conn_id, uint16_t handle, const uint8_t *data, size_t length) {
+    return ble_write_without_response_prio(conn_id, handle, data, length, BLE_TX_PRIO_CONTROL);
+}
+
+/**
+ * @brief Queue a Write Without Response, sent as soon as the controller has a free buffer
+ * 将 Write Without Response 排队，控制器有空闲缓冲区时立即发送
+ *
+ * Frames of a higher priority overtake queued frames of a lower one. A full queue evicts the oldest
+ * frame of a lower priority, see tx_queue_push.
+ * 高优先级的帧会越过已排队的低优先级帧。队列满时挤出更低优先级中最旧的帧，参见 tx_queue_push。
+ *
+ * @param conn_id   Connection ID, the queue serves the current connection
+ *                  连接 ID，队列服务于当前连接
+ * @param handle    Handle of the characteristic
+ *                  特征 handle
+ * @param data      Data to be written, copied into the queue
+ *                  要写入的数据，会被拷贝进队列
+ * @param length    Length of the data, at most ATT MTU - 3
+ *                  数据长度，最大为 ATT MTU - 3
+ * @param prio      Priority of the frame
+ *                  帧的优先级
+ * @return esp_err_t ESP_OK once queued, ESP_ERR_NO_MEM if the queue is full of frames of the same or a higher priority
+ *                   入队后返回 ESP_OK，队列被同级或更高优先级的帧占满时返回 ESP_ERR_NO_MEM
+ */
+esp_err_t ble_write_without_response_prio(uint16_t conn_id, uint16_t handle, const uint8_t *data, size_t length,
+                                          ble_tx_prio_t prio) {
     if (!s_ble_profile.connection_status.is_connected) {
         ESP_LOGW(TAG, "Not connected, skip write_without_response");
         return ESP_FAIL;
     }
-    esp_err_t ret = esp_ble_gattc_write_char(s_ble_profile.gattc_if,
-                                             conn_id,
-                                             handle,
-                                             length,
-                                             (uint8_t *)data,
-                                             ESP_GATT_WRITE_TYPE_NO_RSP,
-                                             ESP_GATT_AUTH_REQ_NONE);
-    if (ret) {
-        ESP_LOGE(TAG, "write_char NO_RSP failed: %s", esp_err_to_name(ret));
+    if (data == NULL || length == 0 || length > (size_t)(s_ble_profile.mtu - 3) || length > TX_QUEUE_FRAME_MAX) {
+        ESP_LOGE(TAG, "write_char NO_RSP of %u bytes does not fit MTU %u", (unsigned)length, s_ble_profile.mtu);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (xSemaphoreTake(s_tx_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
     }
+    esp_err_t ret = ESP_OK;
+    const int64_t now = esp_timer_get_time();
+    tx_flush_closed_locked(now);
+    if (tx_queue_push(&s_tx_queue, prio, handle, data, length, now)) {
+        tx_drain_locked();
+    } else {
+        ESP_LOGW(TAG, "TX queue full, frame of priority %d dropped", prio);
+        ret = ESP_ERR_NO_MEM;
+    }
+    xSemaphoreGive(s_tx_mutex);
     return ret;
 }
 
+/**
+ * @brief Get the counters of the Write Without Response queue
+ * 获取 Write Without Response 队列的计数
+ *
+ * @param out Receives the counters
+ *            接收计数
+ */
+void ble_get_tx_stats(tx_queue_stats_t *out) {
+    memset(out, 0, sizeof(*out));
+    if (s_tx_mutex && xSemaphoreTake(s_tx_mutex, portMAX_DELAY) == pdTRUE) {
+        *out = s_tx_queue.stats;
+        xSemaphoreGive(s_tx_mutex);
+    }
+    out->congestions = s_tx_congestions;
+}
+
+/**
+ * @brief Clear the counters of the Write Without Response queue
+ * 清零 Write Without Response 队列的计数
+ */
+void ble_reset_tx_stats(void) {
+    if (s_tx_mutex && xSemaphoreTake(s_tx_mutex, portMAX_DELAY) == pdTRUE) {
+        tx_queue_reset_stats(&s_tx_queue);
+        s_tx_congestions = 0;
+        xSemaphoreGive(s_tx_mutex);
+    }
+}
+
+/**
+ * @brief Select the link profile; it is applied once notifications are enabled and no other update is in flight
+ * 选择链路配置；在通知已使能且没有其他更新进行时应用
+ *
+ * A closed link forgets the profile, so it has to be selected again for the next link. A profile the camera
+ * refused is not asked for again until it is selected again or an update the camera started ends, since a
+ * refusal may only mean the two updates collided.
+ * 链路关闭后配置被清除，下一条链路需要重新选择。相机拒绝的配置在再次被选择或相机发起的更新结束之前不会重新请求，
+ * 因为拒绝可能只是两次更新发生了冲突。
+ *
+ * @param profile Link profile
+ *                链路配置
+ * @return esp_err_t ESP_ERR_INVALID_ARG for an unknown profile
+ *                   未知配置时返回 ESP_ERR_INVALID_ARG
+ */
+esp_err_t ble_set_link_profile(ble_link_profile_t profile) {
+    if (profile >= BLE_LINK_PROFILE_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&s_link_lock);
+    s_link.wanted = profile;
+    s_link.refused &= ~(1u << profile);
+    portEXIT_CRITICAL(&s_link_lock);
+    link_profile_apply();
+    return ESP_OK;
+}
+
+/**
+ * @brief Get the parameters in effect on the current link
+ * 获取当前链路上生效的参数
+ *
+ * @param out Receives the parameters
+ *            接收参数
+ */
+void ble_get_link_params(ble_link_params_t *out) {
+    portENTER_CRITICAL(&s_link_lock);
+    *out = s_link.params;
+    portEXIT_CRITICAL(&s_link_lock);
+}
+
+/**
+ * @brief Get the name of a link profile, for logs
+ * 获取链路配置的名称，用于日志
+ *
+ * @param profile Link profile
+ *                链路配置
+ * @return const char* Profile name
+ *                     配置名称
+ */
+const char *ble_link_profile_name(ble_link_profile_t profile) {
+    switch (profile) {
+    case BLE_LINK_PROFILE_IDLE:
+        return "idle";
+    case BLE_LINK_PROFILE_INTERACTIVE:
+        return "interactive";
+    case BLE_LINK_PROFILE_STREAMING:
+        return "streaming";
+    default:
+        return "default";
+    }
+}
+
 /**
  * @brief Write characteristic (Write With Response)
  * 写特征（Write With Response）
@@ -469,6 +881,7 @@ esp_err_t ble_register_notify(uint16_t conn_id, uint16_t char_handle) {
     }
     /* Request to subscribe to notifications from the protocol stack */
     /* 向协议栈请求订阅通知 */
+    s_notify_requested = true;
     esp_err_t ret = esp_ble_gattc_register_for_notify(s_ble_profile.gattc_if,
                                                       s_ble_profile.remote_bda,
                                                       char_handle);
@@ -514,8 +927,11 @@ void ble_set_notify_callback(ble_notify_callback_t cb) {
 }
 
 /**
- * @brief Set global logic layer disconnection state callback
- * 设置全局的逻辑层断连状态回调
+ * @brief Set global logic layer link state callback
+ * 设置全局的逻辑层链路状态回调
+ *
+ * Called from the GAP/GATTC callbacks for every link event, so it must hand the event over and return.
+ * 每个链路事件都会在 GAP/GATTC 回调中调用它，因此它只能转交事件后立即返回。
  *
  * @param cb Callback function pointer
  *           回调函数指针
@@ -524,38 +940,78 @@ void ble_set_state_callback(connect_logic_state_callback_t cb) {
     s_state_cb = cb;
 }
 
+/**
+ * @brief Set global MTU callback (for sizing receive buffers)
+ * 设置全局的 MTU 回调（用于确定接收缓冲区大小）
+ *
+ * @param cb Callback function pointer
+ *           回调函数指针
+ */
+void ble_set_mtu_callback(ble_mtu_callback_t cb) {
+    s_mtu_cb = cb;
+}
+
+/**
+ * @brief Set the GATT handles to try first when connecting to a camera
+ * 设置连接相机时优先尝试的 GATT 句柄
+ *
+ * On a connection to this camera the handles are checked by reading the notify characteristic's
+ * declaration instead of running service discovery. If they do not match, discovery runs as usual.
+ * 连接到该相机时，通过读取通知特征的声明来校验这些句柄，而不执行服务发现；若不匹配，则照常执行服务发现。
+ *
+ * @param bda     Camera address the handles belong to
+ *                句柄所属的相机地址
+ * @param handles Handles saved from an earlier connection, NULL to forget them
+ *                先前连接保存的句柄，传 NULL 则清除
+ */
+void ble_set_cached_handles(const esp_bd_addr_t bda, const ble_gatt_handles_t *handles) {
+    if (handles == NULL || handles->notify_char_handle < 2 || handles->write_char_handle == 0 ||
+        handles->notify_cccd_handle == 0) {
+        s_handle_cache.valid = false;
+        return;
+    }
+    memcpy(s_handle_cache.bda, bda, sizeof(esp_bd_addr_t));
+    s_handle_cache.handles = *handles;
+    s_handle_cache.valid = true;
+}
+
+/**
+ * @brief Get the GATT handles of the current connection, for saving
+ * 获取当前连接的 GATT 句柄，用于保存
+ *
+ * @param out Receives the handles
+ *            接收句柄
+ * @return true once notifications are enabled on the current connection
+ *         当前连接的通知已使能时返回 true
+ */
+bool ble_get_gatt_handles(ble_gatt_handles_t *out) {
+    if (!s_ble_profile.connection_status.is_connected || s_link_timing.ready_us == 0) {
+        return false;
+    }
+    out->service_start_handle = s_ble_profile.service_start_handle;
+    out->service_end_handle = s_ble_profile.service_end_handle;
+    out->notify_char_handle = s_ble_profile.notify_char_handle;
+    out->write_char_handle = s_ble_profile.write_char_handle;
+    out->notify_cccd_handle = s_ble_profile.notify_cccd_handle;
+    return true;
+}
+
+/**
+ * @brief Get the timestamps of the last connection attempt
+ * 获取最近一次连接尝试的时间戳
+ *
+ * @param out Receives the timestamps
+ *            接收时间戳
+ */
+void ble_get_link_timing(ble_link_timing_t *out) {
+    *out = s_link_timing;
+}
+
 /* ----------------------------------------------------------------
  *   GAP & GATTC callback function implementation (simplified version)
  *   GAP & GATTC 回调函数实现（精简版）
  * ---------------------------------------------------------------- */
 
-/* 判断是否为 DJI 相机的广播 */
-/* Determine whether it is a DJI camera advertisement */
-static uint8_t bsp_link_is_dji_camera_adv(esp_ble_gap_cb_param_t *scan_result) {
-    const uint8_t *ble_adv = scan_result->scan_rst.ble_adv;
-    const uint8_t adv_len = scan_result->scan_rst.adv_data_len + scan_result->scan_rst.scan_rsp_len;
-
-    for (int i = 0; i < adv_len; ) {
-        const uint8_t len = ble_adv[i];
-        
-        if (len == 0 || (i + len + 1) > adv_len) break;
-
-        const uint8_t type = ble_adv[i+1];
-        const uint8_t *data = &ble_adv[i+2];
-        const uint8_t data_len = len - 1;
-
-        if (type == ESP_BLE_AD_MANUFACTURER_SPECIFIC_TYPE) {
-            if (data_len >= 5) {
-                if (data[0] == 0xAA && data[1] == 0x08 && data[4] == 0xFA) {
-                    return 1;
-                }
-            }
-        }
-        i += (len + 1);
-    }
-    return 0;
-}
-
 static void gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param) {
     switch (event) {
     case ESP_GAP_BLE_SCAN_PARAM_SET_COMPLETE_EVT:
@@ -564,12 +1020,42 @@ static void gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param
         break;
 
     case ESP_GAP_BLE_SCAN_STOP_COMPLETE_EVT:
+        if (param->scan_stop_cmpl.status != ESP_BT_STATUS_SUCCESS) {
+            // No scan was running, e.g. the scan timer fired after the scan had already stopped
+            // 没有正在进行的扫描，例如扫描已停止后扫描定时器才触发
+            ESP_LOGW(TAG, "scan stop failed, status=%d", param->scan_stop_cmpl.status);
+            s_scan_cancelled = false;
+            break;
+        }
         ESP_LOGI(TAG, "scan stopped");
+        xTimerStop(scan_timer, 0);
+        if (s_scan_cancelled) {
+            // Stopped by ble_stop_scanning, whoever stopped it no longer wants a connection
+            // 由 ble_stop_scanning 停止，调用方已不需要连接
+            s_scan_cancelled = false;
+            s_is_reconnecting = false;
+            break;
+        }
+        // A fresh pairing takes the camera with the strongest smoothed RSSI
+        // 首次配对选择平滑 RSSI 最强的相机
+        if (!ble_get_reconnecting()) {
+            const scan_candidate_t *leader = scan_rank_leader(&s_scan_rank);
+            if (leader && leader->rssi_q4 >= s_scan_rank.config.min_rssi * 16) {
+                memcpy(best_addr, leader->bda, sizeof(esp_bd_addr_t));
+                best_rssi = (int8_t)(leader->rssi_q4 / 16);
+                strncpy(s_remote_device_name, leader->name, sizeof(s_remote_device_name) - 1);
+                s_remote_device_name[sizeof(s_remote_device_name) - 1] = '\0';
+            }
+            ESP_LOGI(TAG, "Scan ran %lld ms, %u advertisements parsed, %u skipped",
+                     (long long)((esp_timer_get_time() - s_scan_rank.start_us) / 1000),
+                     (unsigned)s_scan_rank.adv_parsed, (unsigned)s_scan_rank.adv_skipped);
+        }
         // After scanning ends, decide whether to connect based on reconnection mode and device discovery status
         // 扫描结束后，根据重连模式和设备发现状态决定是否连接
+        bool connecting = false;
         if (best_rssi > -128) {
             if (!ble_get_reconnecting() || (ble_get_reconnecting() && s_found_previous_device)) {
-                try_to_connect(best_addr);
+                connecting = try_to_connect(best_addr);
                 ESP_LOGI(TAG, "Connected to device: %02x:%02x:%02x:%02x:%02x:%02x",
                          best_addr[0], best_addr[1], best_addr[2], best_addr[3], best_addr[4], best_addr[5]);
             } else {
@@ -579,74 +1065,183 @@ static void gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param
             ESP_LOGW(TAG, "No suitable device found with sufficient signal strength");
         }
         s_is_reconnecting = false;
+        if (!connecting) {
+            report_link_event(BLE_LINK_EVT_SCAN_DONE, 0);
+        }
         break;
 
     case ESP_GAP_BLE_SCAN_RESULT_EVT: {
         esp_ble_gap_cb_param_t *r = param;
         if (r->scan_rst.search_evt == ESP_GAP_SEARCH_INQ_RES_EVT) {
-            // Check if it is a DJI camera advertisement
-            // 检查是否为 DJI 相机广播
-            if (!bsp_link_is_dji_camera_adv(r)) {
+            // Rank DJI camera advertisements, the AD structures of a device are walked once per scan
+            // 对 DJI 相机广播排名，每个设备的 AD 结构每次扫描只遍历一次
+            const int64_t now_us = esp_timer_get_time();
+            bool is_new = false;
+            const scan_candidate_t *camera = scan_rank_observe(&s_scan_rank, r->scan_rst.bda, r->scan_rst.rssi,
+                                                               r->scan_rst.ble_adv,
+                                                               r->scan_rst.adv_data_len + r->scan_rst.scan_rsp_len,
+                                                               r->scan_rst.scan_rsp_len > 0, now_us, &is_new);
+            // A reconnect is after one address, which a table full of stronger cameras must not hide
+            // 重连只寻找一个地址，不能因表中已满是更强的相机而漏掉它
+            const bool is_previous = ble_get_reconnecting() &&
+                                     memcmp(best_addr, r->scan_rst.bda, sizeof(esp_bd_addr_t)) == 0 &&
+                                     (camera || scan_rank_parse_adv(r->scan_rst.ble_adv,
+                                                                    r->scan_rst.adv_data_len + r->scan_rst.scan_rsp_len,
+                                                                    NULL, 0));
+            if (camera == NULL && !is_previous) {
                 break;
             }
-            // Get the complete name from the advertisement data
-            // 获取广播数据里的完整名称
-            uint8_t *adv_name = NULL;
-            uint8_t adv_name_len = 0;
-            adv_name = esp_ble_resolve_adv_data_by_type(r->scan_rst.ble_adv,
-                                r->scan_rst.adv_data_len + r->scan_rst.scan_rsp_len,
-                                ESP_BLE_AD_TYPE_NAME_CMPL,
-                                &adv_name_len);
-
-            // Prepare a safe string pointer for logging
-            // 为打印日志准备安全的字符串指针
-            const char *adv_name_str = NULL;
-            if (adv_name && adv_name_len > 0) {
-                static char name_buf[64];
-                size_t copy_len = adv_name_len < sizeof(name_buf) - 1 ? adv_name_len : sizeof(name_buf) - 1;
-                memcpy(name_buf, adv_name, copy_len);
-                name_buf[copy_len] = '\0';
-                adv_name_str = name_buf;
-            } else {
-                adv_name_str = "NULL";
+            if (is_new) {
+                ESP_LOGI(TAG, "Found device: %s with RSSI: %d, MAC: %02X:%02X:%02X:%02X:%02X:%02X",
+                    camera->name[0] ? camera->name : "NULL",
+                    r->scan_rst.rssi,
+                    r->scan_rst.bda[0], r->scan_rst.bda[1], r->scan_rst.bda[2],
+                    r->scan_rst.bda[3], r->scan_rst.bda[4], r->scan_rst.bda[5]);
             }
 
-            ESP_LOGI(TAG, "Found device: %s with RSSI: %d, MAC: %02X:%02X:%02X:%02X:%02X:%02X",
-                adv_name_str,
-                r->scan_rst.rssi,
-                r->scan_rst.bda[0], r->scan_rst.bda[1], r->scan_rst.bda[2],
-                r->scan_rst.bda[3], r->scan_rst.bda[4], r->scan_rst.bda[5]);
-
-            // Compare names and record signal strength
-            // 对比名称并记录信号强度
             if (ble_get_reconnecting()) {
                 // In reconnection mode, compare device addresses
                 // 在重连模式下，比对设备地址
-                if (memcmp(best_addr, r->scan_rst.bda, sizeof(esp_bd_addr_t)) == 0) {
+                if (is_previous) {
                     s_found_previous_device = true;
                     best_rssi = r->scan_rst.rssi;
                     esp_ble_gap_stop_scanning();
-                    ESP_LOGI(TAG, "Found previous device: %s, RSSI: %d", adv_name_str, r->scan_rst.rssi);
+                    ESP_LOGI(TAG, "Found previous device: %s, RSSI: %d", camera ? camera->name : "", r->scan_rst.rssi);
                 }
+            } else if (!s_scan_stop_requested && scan_rank_decided(&s_scan_rank, now_us)) {
+                // In normal scan mode, stop as soon as one camera is stable and clearly the strongest
+                // 正常扫描模式，某台相机稳定且明显最强时立即停止扫描
+                const scan_candidate_t *leader = scan_rank_leader(&s_scan_rank);
+                s_scan_stop_requested = true;
+                esp_ble_gap_stop_scanning();
+                ESP_LOGI(TAG, "Camera %s leads with RSSI %d after %lld ms, stopping scan",
+                         leader->name, leader->rssi_q4 / 16, (long long)((now_us - s_scan_rank.start_us) / 1000));
+            }
+        }
+        break;
+    }
+
+    case ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT: {
+        // A connection update took effect or was refused; go on with the profile wanted meanwhile
+        // 连接参数更新已生效或被拒绝；继续应用期间所期望的配置
+        const bool accepted = param->update_conn_params.status == ESP_BT_STATUS_SUCCESS;
+        portENTER_CRITICAL(&s_link_lock);
+        const bool ours = s_link.update_pending;
+        const ble_link_profile_t requested = s_link.requested;
+        s_link.update_pending = false;
+        if (accepted) {
+            s_link.params.conn_interval = param->update_conn_params.conn_int;
+            s_link.params.latency = param->update_conn_params.latency;
+            s_link.params.timeout = param->update_conn_params.timeout;
+            s_link.params.updates++;
+            if (ours) {
+                s_link.params.profile = requested;
             } else {
-                // In normal scan mode, record the device with the strongest signal
-                // 正常扫描模式，记录信号最强的设备
-                if (r->scan_rst.rssi > best_rssi && r->scan_rst.rssi >= MIN_RSSI_THRESHOLD) {
-                    best_rssi = r->scan_rst.rssi;
-                    memcpy(best_addr, r->scan_rst.bda, sizeof(esp_bd_addr_t));
-                    strncpy(s_remote_device_name, adv_name_str, sizeof(s_remote_device_name) - 1);
-                    s_remote_device_name[sizeof(s_remote_device_name) - 1] = '\0';
-                }
+                // An update the camera started has ended; one refused because it collided may go through now
+                // 相机发起的更新已结束；因与其冲突而被拒绝的更新现在可以重试
+                s_link.refused = 0;
             }
+        } else if (ours) {
+            s_link.refused |= 1u << requested;
+        }
+        portEXIT_CRITICAL(&s_link_lock);
+        if (accepted) {
+            ESP_LOGI(TAG, "Connection interval %u.%02u ms, latency %u, timeout %u ms",
+                     param->update_conn_params.conn_int * 125 / 100, param->update_conn_params.conn_int * 125 % 100,
+                     param->update_conn_params.latency, param->update_conn_params.timeout * 10);
+        } else {
+            ESP_LOGW(TAG, "Connection update refused, status=%d", param->update_conn_params.status);
         }
+        link_profile_apply();
         break;
     }
 
+    case ESP_GAP_BLE_SET_PKT_LENGTH_COMPLETE_EVT:
+        if (param->pkt_data_length_cmpl.status == ESP_BT_STATUS_SUCCESS) {
+            portENTER_CRITICAL(&s_link_lock);
+            s_link.params.tx_octets = param->pkt_data_length_cmpl.params.tx_len;
+            portEXIT_CRITICAL(&s_link_lock);
+            ESP_LOGI(TAG, "Data length %u octets", param->pkt_data_length_cmpl.params.tx_len);
+        } else {
+            ESP_LOGW(TAG, "Data length update failed, status=%d", param->pkt_data_length_cmpl.status);
+        }
+        break;
+
+    case ESP_GAP_BLE_SET_PREFERRED_PHY_COMPLETE_EVT:
+        if (param->set_perf_phy.status != ESP_BT_STATUS_SUCCESS) {
+            ESP_LOGW(TAG, "Preferred PHY not set, status=%d", param->set_perf_phy.status);
+        }
+        break;
+
+    case ESP_GAP_BLE_PHY_UPDATE_COMPLETE_EVT:
+        if (param->phy_update.status == ESP_BT_STATUS_SUCCESS) {
+            portENTER_CRITICAL(&s_link_lock);
+            s_link.params.phy = param->phy_update.tx_phy;
+            portEXIT_CRITICAL(&s_link_lock);
+            ESP_LOGI(TAG, "PHY %s", param->phy_update.tx_phy == ESP_BLE_GAP_PHY_2M ? "2M" : "1M");
+        }
+        break;
+
     default:
         break;
     }
 }
 
+static void clear_profile_handles(void) {
+    s_ble_profile.service_start_handle = 0;
+    s_ble_profile.service_end_handle = 0;
+    s_ble_profile.notify_char_handle = 0;
+    s_ble_profile.write_char_handle = 0;
+    s_ble_profile.notify_cccd_handle = 0;
+    s_ble_profile.handle_discovery.notify_char_handle_found = false;
+    s_ble_profile.handle_discovery.write_char_handle_found = false;
+}
+
+/* Drop the cached handles of this camera and find the handles by service discovery */
+/* 丢弃该相机的缓存句柄，通过服务发现查找句柄 */
+static void start_fallback_discovery(esp_gatt_if_t gattc_if, const char *reason) {
+    ESP_LOGW(TAG, "Cached handles rejected (%s), running service discovery", reason);
+    s_handle_cache.valid = false;
+    s_link_timing.mode = BLE_DISCOVERY_FALLBACK;
+    clear_profile_handles();
+    esp_ble_gattc_search_service(gattc_if, s_ble_profile.conn_id, NULL);
+}
+
+/* Take the cached handles and check them with one read of the notify characteristic's declaration */
+/* 采用缓存的句柄，并通过一次读取通知特征声明进行校验 */
+static void start_cached_handle_check(esp_gatt_if_t gattc_if) {
+    const ble_gatt_handles_t *cached = &s_handle_cache.handles;
+    s_ble_profile.service_start_handle = cached->service_start_handle;
+    s_ble_profile.service_end_handle = cached->service_end_handle;
+    s_ble_profile.notify_char_handle = cached->notify_char_handle;
+    s_ble_profile.write_char_handle = cached->write_char_handle;
+    s_ble_profile.notify_cccd_handle = cached->notify_cccd_handle;
+
+    // The declaration sits right before the value and holds its properties, handle and UUID
+    // 特征声明紧位于特征值之前，包含其属性、句柄与 UUID
+    s_validating_handles = true;
+    esp_err_t ret = esp_ble_gattc_read_char(gattc_if, s_ble_profile.conn_id,
+                                            (uint16_t)(cached->notify_char_handle - 1), ESP_GATT_AUTH_REQ_NONE);
+    if (ret != ESP_OK) {
+        s_validating_handles = false;
+        start_fallback_discovery(gattc_if, "read failed");
+    }
+}
+
+/* Check a characteristic declaration: properties, value handle (LE) and 16-bit UUID (LE) */
+/* 校验特征声明：属性、值句柄（小端）与 16 位 UUID（小端） */
+static bool is_notify_declaration(const esp_ble_gattc_cb_param_t *param) {
+    if (param->read.status != ESP_GATT_OK || param->read.value_len != 5) {
+        return false;
+    }
+    const uint8_t *value = param->read.value;
+    const uint16_t value_handle = (uint16_t)(value[1] | (value[2] << 8));
+    const uint16_t uuid = (uint16_t)(value[3] | (value[4] << 8));
+    return (value[0] & ESP_GATT_CHAR_PROP_BIT_NOTIFY) &&
+           value_handle == s_ble_profile.notify_char_handle &&
+           uuid == REMOTE_NOTIFY_CHAR_UUID;
+}
+
 static void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_if, esp_ble_gattc_cb_param_t *param) {
     switch (event) {
     case ESP_GATTC_REG_EVT: {
@@ -667,6 +1262,12 @@ static void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_
         s_ble_profile.conn_id = param->connect.conn_id;
         s_ble_profile.connection_status.is_connected = true;
         memcpy(s_ble_profile.remote_bda, param->connect.remote_bda, sizeof(esp_bd_addr_t));
+        clear_profile_handles();
+        s_tx_congested = false;
+        s_link_timing.connected_us = esp_timer_get_time();
+        s_link_timing.mode = (s_handle_cache.valid &&
+                              memcmp(s_handle_cache.bda, param->connect.remote_bda, sizeof(esp_bd_addr_t)) == 0)
+                             ? BLE_DISCOVERY_CACHED : BLE_DISCOVERY_FULL;
         ESP_LOGI(TAG, "Connected, conn_id=%d", s_ble_profile.conn_id);
 
         ESP_LOGI(TAG, "Connect to camera MAC: %02X:%02X:%02X:%02X:%02X:%02X", 
@@ -680,6 +1281,7 @@ static void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_
         // Initiate MTU request
         // 发起 MTU 请求
         esp_ble_gattc_send_mtu_req(gattc_if, param->connect.conn_id);
+        report_link_event(BLE_LINK_EVT_CONNECTED, 0);
         break;
     }
     case ESP_GATTC_OPEN_EVT: {
@@ -688,6 +1290,7 @@ static void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_
         s_connecting = false;
         if (param->open.status != ESP_GATT_OK) {
             ESP_LOGE(TAG, "Open failed, status=%d", param->open.status);
+            report_link_event(BLE_LINK_EVT_OPEN_FAILED, param->open.status);
             break;
         }
         ESP_LOGI(TAG, "Open success, MTU=%u", param->open.mtu);
@@ -698,12 +1301,45 @@ static void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_
         // 处理 MTU 配置事件
         if (param->cfg_mtu.status != ESP_GATT_OK) {
             ESP_LOGE(TAG, "Config MTU Error, status=%d", param->cfg_mtu.status);
+            s_ble_profile.mtu = BLE_DEFAULT_MTU;
+        } else {
+            s_ble_profile.mtu = param->cfg_mtu.mtu;
+        }
+        ESP_LOGI(TAG, "MTU=%d", s_ble_profile.mtu);
+
+        // Let the receive path size its buffers before any notification arrives
+        // 在任何通知到达之前，让接收路径确定缓冲区大小
+        if (s_mtu_cb) {
+            s_mtu_cb(s_ble_profile.mtu);
         }
-        ESP_LOGI(TAG, "MTU=%d", param->cfg_mtu.mtu);
 
-        // Start service discovery after MTU configuration
-        // MTU 配置完后开始发现服务
-        esp_ble_gattc_search_service(gattc_if, param->cfg_mtu.conn_id, NULL);
+        // With handles cached for this camera only check them, otherwise start service discovery
+        // 若有该相机的缓存句柄则只做校验，否则开始发现服务
+        if (s_link_timing.mode == BLE_DISCOVERY_CACHED) {
+            start_cached_handle_check(gattc_if);
+        } else {
+            esp_ble_gattc_search_service(gattc_if, param->cfg_mtu.conn_id, NULL);
+        }
+        break;
+    }
+    case ESP_GATTC_READ_CHAR_EVT: {
+        // Handle read result; only the check of cached handles reads here
+        // 处理读取结果，此处只有缓存句柄的校验会发起读取
+        if (!s_validating_handles) {
+            break;
+        }
+        s_validating_handles = false;
+        if (!is_notify_declaration(param)) {
+            start_fallback_discovery(gattc_if, "notify declaration mismatch");
+            break;
+        }
+        s_ble_profile.handle_discovery.notify_char_handle_found = true;
+        s_ble_profile.handle_discovery.write_char_handle_found = true;
+        s_link_timing.handles_us = esp_timer_get_time();
+        ESP_LOGI(TAG, "Cached handles accepted, notify=0x%x write=0x%x cccd=0x%x",
+                 s_ble_profile.notify_char_handle, s_ble_profile.write_char_handle,
+                 s_ble_profile.notify_cccd_handle);
+        report_link_event(BLE_LINK_EVT_HANDLES_FOUND, 0);
         break;
     }
     case ESP_GATTC_SEARCH_RES_EVT: {
@@ -763,7 +1399,16 @@ static void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_
             ESP_LOGI(TAG, "Write Char found, handle=0x%x",
                      s_ble_profile.write_char_handle);
         }
-
+        s_link_timing.handles_us = esp_timer_get_time();
+
+        // Notifications were requested with cached handles that then failed: request them again
+        // 先前用缓存句柄请求通知但失败了：重新请求
+        if (s_notify_requested && s_ble_profile.handle_discovery.notify_char_handle_found) {
+            esp_ble_gattc_register_for_notify(gattc_if, s_ble_profile.remote_bda, s_ble_profile.notify_char_handle);
+        } else if (s_ble_profile.handle_discovery.notify_char_handle_found &&
+                   s_ble_profile.handle_discovery.write_char_handle_found) {
+            report_link_event(BLE_LINK_EVT_HANDLES_FOUND, 0);
+        }
         break;
     }
     case ESP_GATTC_REG_FOR_NOTIFY_EVT: {
@@ -775,21 +1420,27 @@ static void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_
         }
         ESP_LOGI(TAG, "Notify register success, handle=0x%x", param->reg_for_notify.handle);
 
-        // Find descriptor and write 0x01 to enable notification
-        // 找到对应描述符并写入 0x01 使能通知
-        uint16_t count = 1;
-        esp_gattc_descr_elem_t descr_elem;
-        esp_ble_gattc_get_descr_by_char_handle(gattc_if,
-                                               s_ble_profile.conn_id,
-                                               param->reg_for_notify.handle,
-                                               s_notify_descr_uuid,
-                                               &descr_elem,
-                                               &count);
-        if (count > 0 && descr_elem.handle) {
+        // Find descriptor and write 0x01 to enable notification. With cached handles the descriptor
+        // handle is already known, and the local lookup would fail as no discovery ran
+        // 找到对应描述符并写入 0x01 使能通知。使用缓存句柄时描述符句柄已知，且因未执行发现，本地查找会失败
+        if (s_ble_profile.notify_cccd_handle == 0) {
+            uint16_t count = 1;
+            esp_gattc_descr_elem_t descr_elem;
+            esp_ble_gattc_get_descr_by_char_handle(gattc_if,
+                                                   s_ble_profile.conn_id,
+                                                   param->reg_for_notify.handle,
+                                                   s_notify_descr_uuid,
+                                                   &descr_elem,
+                                                   &count);
+            if (count > 0 && descr_elem.handle) {
+                s_ble_profile.notify_cccd_handle = descr_elem.handle;
+            }
+        }
+        if (s_ble_profile.notify_cccd_handle) {
             uint16_t notify_en = 1;
             esp_ble_gattc_write_char_descr(gattc_if,
                                            s_ble_profile.conn_id,
-                                           descr_elem.handle,
+                                           s_ble_profile.notify_cccd_handle,
                                            sizeof(notify_en),
                                            (uint8_t *)&notify_en,
                                            ESP_GATT_WRITE_TYPE_RSP,
@@ -797,6 +1448,43 @@ static void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_
         }
         break;
     }
+    case ESP_GATTC_WRITE_DESCR_EVT: {
+        // Handle descriptor write result, the end of connection setup
+        // 处理描述符写入结果，即连接建立的最后一步
+        if (param->write.handle != s_ble_profile.notify_cccd_handle) {
+            break;
+        }
+        if (param->write.status != ESP_GATT_OK) {
+            if (s_link_timing.mode == BLE_DISCOVERY_CACHED) {
+                start_fallback_discovery(gattc_if, "CCCD write failed");
+            } else {
+                ESP_LOGE(TAG, "Enable notify failed, status=%d", param->write.status);
+            }
+            break;
+        }
+        s_link_timing.ready_us = esp_timer_get_time();
+        ESP_LOGI(TAG, "Notifications enabled %lld ms after open (%s)",
+                 (long long)((s_link_timing.ready_us - s_link_timing.open_us) / 1000),
+                 s_link_timing.mode == BLE_DISCOVERY_CACHED ? "cached handles" :
+                 s_link_timing.mode == BLE_DISCOVERY_FALLBACK ? "cache fallback" : "service discovery");
+
+        // Remember the handles for a reconnect to the same camera
+        // 记录句柄，供重连同一相机使用
+        ble_gatt_handles_t handles;
+        if (ble_get_gatt_handles(&handles)) {
+            ble_set_cached_handles(s_ble_profile.remote_bda, &handles);
+        }
+
+        // Connection setup is done, the link parameters may change from here on
+        // 连接建立完成，此后可以修改链路参数
+        portENTER_CRITICAL(&s_link_lock);
+        s_link.ready = true;
+        portEXIT_CRITICAL(&s_link_lock);
+        link_profile_apply();
+
+        report_link_event(BLE_LINK_EVT_READY, 0);
+        break;
+    }
     case ESP_GATTC_NOTIFY_EVT: {
         // Handle notification data event
         // 处理通知数据事件
@@ -805,6 +1493,33 @@ static void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_
         }
         break;
     }
+    case ESP_GATTC_CONGEST_EVT: {
+        // The stack's TX buffers for the link filled up or drained; resume sending from the TX task
+        // 链路的协议栈发送缓冲区已满或已清空；在发送任务中恢复发送
+        s_tx_congested = param->congest.congested;
+        if (param->congest.congested) {
+            s_tx_congestions++;
+        } else {
+            tx_wake();
+        }
+        break;
+    }
+    case ESP_GATTC_WRITE_CHAR_EVT: {
+        // A write completed and gave its buffer back, a stalled queue can go on
+        // 写入完成并归还了缓冲区，停滞的队列可以继续发送
+        if (param->write.status != ESP_GATT_OK) {
+            ESP_LOGD(TAG, "Write to handle 0x%04x failed, status=%d", param->write.handle, param->write.status);
+        }
+        tx_wake();
+        break;
+    }
+    case ESP_GATTC_SRVC_CHG_EVT: {
+        // The camera's attribute database changed, so cached handles may no longer hold
+        // 相机的属性数据库已改变，缓存的句柄可能不再有效
+        ESP_LOGW(TAG, "Service changed, dropping cached handles");
+        s_handle_cache.valid = false;
+        break;
+    }
     case ESP_GATTC_DISCONNECT_EVT: {
         // Handle disconnection event
         // 处理断开连接事件
@@ -812,11 +1527,17 @@ static void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_
         s_ble_profile.handle_discovery.write_char_handle_found = false;
         s_ble_profile.handle_discovery.notify_char_handle_found = false;
         s_connecting = false;
+        s_validating_handles = false;
+        s_notify_requested = false;
         ESP_LOGI(TAG, "Disconnected, reason=0x%x", param->disconnect.reason);
 
-        if (s_state_cb) {
-            s_state_cb();
-        }
+        // Queued frames belong to the closed link, the TX task drops them
+        // 排队的帧属于已关闭的链路，由发送任务丢弃
+        s_tx_flush_pending = true;
+        tx_wake();
+        link_profile_reset();
+
+        report_link_event(BLE_LINK_EVT_DISCONNECTED, param->disconnect.reason);
         break;
     }
     default:
@@ -26,6 +26,12 @@
 #include "esp_err.h"
 #include "esp_gatt_defs.h"
 #include "esp_gattc_api.h"
+#include "tx_queue.h"
+
+/* 本端提供的 ATT MTU，以及未协商时的默认 ATT MTU */
+/* ATT MTU offered locally, and the default ATT MTU when none was negotiated */
+#define BLE_LOCAL_MTU 500
+#define BLE_DEFAULT_MTU 23
 
 /* Connection status structure */
 /* 连接状态结构体 */
@@ -61,12 +67,78 @@ typedef struct {
     /* 远程设备地址 */
     esp_bd_addr_t remote_bda;      // Remote Bluetooth device address
 
+    uint16_t notify_cccd_handle;   // Client Characteristic Configuration of the notify characteristic
+                                   // 通知特征的客户端特征配置描述符
+
+    uint16_t mtu;                  // Negotiated ATT MTU
+                                   // 协商得到的 ATT MTU
+
     connection_status_t connection_status;     // Connection status
     handle_discovery_t handle_discovery;       // Handle discovery status
 } ble_profile_t;
 
 extern ble_profile_t s_ble_profile;
 
+/* GATT handles of the camera service, kept per camera so a reconnect can skip service discovery */
+/* 相机服务的 GATT 句柄，按相机保存，使重连可以跳过服务发现 */
+typedef struct {
+    uint16_t service_start_handle;
+    uint16_t service_end_handle;
+    uint16_t notify_char_handle;
+    uint16_t write_char_handle;
+    uint16_t notify_cccd_handle;
+} ble_gatt_handles_t;
+
+/* How the handles of a connection were obtained */
+/* 连接的句柄是如何获得的 */
+typedef enum {
+    BLE_DISCOVERY_FULL = 0,        // Full service discovery / 完整服务发现
+    BLE_DISCOVERY_CACHED,          // Cached handles, checked with one read / 缓存句柄，经一次读取校验
+    BLE_DISCOVERY_FALLBACK,        // Cached handles rejected, then full discovery / 缓存句柄被拒绝，随后完整发现
+} ble_discovery_mode_t;
+
+/* Timestamps (esp_timer_get_time) of the last connection attempt, 0 until reached */
+/* 最近一次连接尝试的时间戳（esp_timer_get_time），未到达的阶段为 0 */
+typedef struct {
+    int64_t open_us;               // esp_ble_gattc_open issued / 发出 esp_ble_gattc_open
+    int64_t connected_us;          // Link established / 链路建立
+    int64_t handles_us;            // Notify and write handles known / 通知与写句柄已知
+    int64_t ready_us;              // Notifications enabled on the camera / 相机上的通知已使能
+    ble_discovery_mode_t mode;
+} ble_link_timing_t;
+
+/* Named sets of connection parameters, trading latency and throughput against the camera's radio time */
+/* 命名的连接参数组合，在延迟、吞吐量与相机射频时间之间取舍 */
+typedef enum {
+    BLE_LINK_PROFILE_IDLE = 0,         // The interval links are opened with, camera may skip events / 建链时的间隔，相机可跳过事件
+    BLE_LINK_PROFILE_INTERACTIVE,      // Short interval while the user waits for the camera / 用户等待相机时的短间隔
+    BLE_LINK_PROFILE_STREAMING,        // Data length extension and 2M PHY for GPS pushes / GPS 推送使用数据长度扩展与 2M PHY
+    BLE_LINK_PROFILE_COUNT,            // No profile, the parameters the link was opened with / 无配置，沿用建链时的参数
+} ble_link_profile_t;
+
+/* Parameters in effect on the current link */
+/* 当前链路上生效的参数 */
+typedef struct {
+    ble_link_profile_t profile;        // Profile of the last accepted update / 最近一次被接受的更新所属的配置
+    uint16_t conn_interval;            // 1.25 ms units, 0 until the first update / 单位 1.25 ms，首次更新前为 0
+    uint16_t latency;                  // Connection events the camera may skip / 相机可跳过的连接事件数
+    uint16_t timeout;                  // Supervision timeout, 10 ms units / 监督超时，单位 10 ms
+    uint16_t tx_octets;                // LL payload per PDU / 每个 PDU 的链路层载荷
+    uint8_t phy;                       // ESP_BLE_GAP_PHY_1M or ESP_BLE_GAP_PHY_2M
+    uint32_t updates;                  // Connection parameter updates on this link / 本链路上的连接参数更新次数
+} ble_link_params_t;
+
+/* Link events reported to the logic layer from the GAP/GATTC callbacks */
+/* 由 GAP/GATTC 回调上报给逻辑层的链路事件 */
+typedef enum {
+    BLE_LINK_EVT_SCAN_DONE = 0,    // Scan ended without a connection attempt / 扫描结束且未发起连接
+    BLE_LINK_EVT_OPEN_FAILED,      // Connection attempt failed / 连接尝试失败
+    BLE_LINK_EVT_CONNECTED,        // Link established / 链路建立
+    BLE_LINK_EVT_HANDLES_FOUND,    // Notify and write handles known / 通知与写句柄已知
+    BLE_LINK_EVT_READY,            // Notifications enabled on the camera / 相机上的通知已使能
+    BLE_LINK_EVT_DISCONNECTED,     // Link closed, reason is the HCI reason / 链路断开，reason 为 HCI 原因码
+} ble_link_event_t;
+
 /**
  * @brief Notify callback function type for receiving data from remote
  * Notify 回调函数类型，用于接收从远端发来的数据
@@ -78,12 +150,33 @@ extern ble_profile_t s_ble_profile;
  */
 typedef void (*ble_notify_callback_t)(const uint8_t *data, size_t length);
 
-typedef void (*connect_logic_state_callback_t)(void);
+/**
+ * @brief Link state callback function type, runs on the Bluedroid task and must not block
+ * 链路状态回调函数类型，运行在 Bluedroid 任务中，不得阻塞
+ *
+ * @param event  Link event
+ *               链路事件
+ * @param reason HCI disconnect reason for BLE_LINK_EVT_DISCONNECTED, GATT status for
+ *               BLE_LINK_EVT_OPEN_FAILED, 0 otherwise
+ *               BLE_LINK_EVT_DISCONNECTED 时为 HCI 断开原因码，BLE_LINK_EVT_OPEN_FAILED 时为 GATT 状态，其余为 0
+ */
+typedef void (*connect_logic_state_callback_t)(ble_link_event_t event, int reason);
+
+/**
+ * @brief MTU callback function type, called once the ATT MTU of a connection is known
+ * MTU 回调函数类型，连接的 ATT MTU 确定后调用
+ *
+ * @param mtu Negotiated ATT MTU
+ *            协商得到的 ATT MTU
+ */
+typedef void (*ble_mtu_callback_t)(uint16_t mtu);
 
 esp_err_t ble_init();
 
 esp_err_t ble_start_scanning_and_connect(void);
 
+void ble_stop_scanning(void);
+
 void ble_set_reconnecting(bool flag);
 
 bool ble_get_reconnecting(void);
@@ -96,6 +189,9 @@ esp_err_t ble_read(uint16_t conn_id, uint16_t handle);
 
 esp_err_t ble_write_without_response(uint16_t conn_id, uint16_t handle, const uint8_t *data, size_t length);
 
+esp_err_t ble_write_without_response_prio(uint16_t conn_id, uint16_t handle, const uint8_t *data, size_t length,
+                                          ble_tx_prio_t prio);
+
 esp_err_t ble_write_with_response(uint16_t conn_id, uint16_t handle, const uint8_t *data, size_t length);
 
 esp_err_t ble_register_notify(uint16_t conn_id, uint16_t char_handle);
@@ -106,6 +202,24 @@ void ble_set_notify_callback(ble_notify_callback_t cb);
 
 void ble_set_state_callback(connect_logic_state_callback_t cb);
 
+void ble_set_mtu_callback(ble_mtu_callback_t cb);
+
 esp_err_t ble_start_advertising(void);
 
+void ble_set_cached_handles(const esp_bd_addr_t bda, const ble_gatt_handles_t *handles);
+
+bool ble_get_gatt_handles(ble_gatt_handles_t *out);
+
+void ble_get_link_timing(ble_link_timing_t *out);
+
+void ble_get_tx_stats(tx_queue_stats_t *out);
+
+void ble_reset_tx_stats(void);
+
+esp_err_t ble_set_link_profile(ble_link_profile_t profile);
+
+void ble_get_link_params(ble_link_params_t *out);
+
+const char *ble_link_profile_name(ble_link_profile_t profile);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,269 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#include <string.h>
+
+#include "scan_rank.h"
+
+/* AD types, as in the Core Specification Supplement */
+/* AD 类型，见核心规范补充文档 */
+#define AD_TYPE_NAME_CMPL           0x09
+#define AD_TYPE_MANUFACTURER        0xFF
+
+/* Smoothed RSSI of a candidate in 1/16 dBm, a rival with too few samples counts with its strongest one */
+/* 候选者的平滑 RSSI（单位 1/16 dBm），样本不足的对手按其最强样本计算 */
+static int16_t rival_rssi_q4(const scan_candidate_t *candidate, uint8_t min_samples) {
+    if (candidate->samples < min_samples && candidate->max_rssi * 16 > candidate->rssi_q4) {
+        return (int16_t)(candidate->max_rssi * 16);
+    }
+    return candidate->rssi_q4;
+}
+
+static bool is_rejected(const scan_rank_t *rank, const uint8_t bda[6]) {
+    for (int i = 0; i < rank->rejected_count; i++) {
+        if (memcmp(rank->rejected[i], bda, 6) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static scan_candidate_t *find_candidate(scan_rank_t *rank, const uint8_t bda[6]) {
+    for (int i = 0; i < rank->count; i++) {
+        if (memcmp(rank->candidates[i].bda, bda, 6) == 0) {
+            return &rank->candidates[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Defaults for the early end of a pairing scan
+ *        配对扫描提前结束的默认规则
+ *
+ * A sample deviates about 4 dB from the mean, the EWMA of a stable camera about 1.5 dB, so a
+ * 6 dB lead is rarely noise. 600 ms covers five advertisements at a 100 ms interval.
+ * 单个样本偏离均值约 4 dB，稳定相机的 EWMA 约 1.5 dB，因此 6 dB 的领先很少是噪声造成的。
+ * 600 ms 覆盖 100 ms 广播间隔下的五次广播。
+ */
+void scan_rank_default_config(scan_rank_config_t *config) {
+    config->min_rssi = -80;
+    config->min_samples = 4;
+    config->margin_db = 6;
+    config->min_scan_us = 800000;
+}
+
+/**
+ * @brief Start a new scan with an empty table
+ *        以空表开始新的扫描
+ *
+ * @param rank Table to reset
+ *             要重置的表
+ * @param config Early end rules, NULL for the defaults
+ *               提前结束规则，NULL 表示使用默认值
+ * @param now_us Start of the scan
+ *               扫描开始时刻
+ */
+void scan_rank_reset(scan_rank_t *rank, const scan_rank_config_t *config, int64_t now_us) {
+    memset(rank, 0, sizeof(*rank));
+    if (config) {
+        rank->config = *config;
+    } else {
+        scan_rank_default_config(&rank->config);
+    }
+    rank->start_us = now_us;
+}
+
+/**
+ * @brief Walk the AD structures of an advertisement once
+ *        遍历一次广播的 AD 结构
+ *
+ * @param adv Advertising data followed by the scan response
+ *            广播数据，后接扫描响应
+ * @param adv_len Length of both
+ *                两者的总长度
+ * @param name_out Receives the complete local name, may be NULL
+ *                 接收完整设备名，可为 NULL
+ * @param name_capacity Size of name_out
+ *                      name_out 的大小
+ * @return bool true if the manufacturer data marks a DJI camera
+ *              厂商数据标识为 DJI 相机时返回 true
+ */
+bool scan_rank_parse_adv(const uint8_t *adv, size_t adv_len, char *name_out, size_t name_capacity) {
+    bool is_camera = false;
+
+    if (name_out && name_capacity) {
+        name_out[0] = '\0';
+    }
+    for (size_t i = 0; i < adv_len; ) {
+        const uint8_t len = adv[i];
+        if (len == 0 || i + len + 1 > adv_len) {
+            break;
+        }
+        const uint8_t type = adv[i + 1];
+        const uint8_t *data = &adv[i + 2];
+        const uint8_t data_len = len - 1;
+
+        if (type == AD_TYPE_MANUFACTURER && data_len >= 5 &&
+            data[0] == 0xAA && data[1] == 0x08 && data[4] == 0xFA) {
+            is_camera = true;
+        } else if (type == AD_TYPE_NAME_CMPL && name_out && name_capacity) {
+            const size_t copy_len = data_len < name_capacity - 1 ? data_len : name_capacity - 1;
+            memcpy(name_out, data, copy_len);
+            name_out[copy_len] = '\0';
+        }
+        i += len + 1;
+    }
+    return is_camera;
+}
+
+/**
+ * @brief Feed one scan result into the table
+ *        将一条扫描结果加入排名表
+ *
+ * A full table gives the slot of its weakest camera to a stronger newcomer.
+ * 表满时，最弱相机的位置让给更强的新相机。
+ *
+ * @param rank Table of the running scan
+ *             当前扫描的表
+ * @param bda Advertiser address
+ *            广播者地址
+ * @param rssi RSSI of this advertisement
+ *             本条广播的 RSSI
+ * @param adv Advertising data followed by the scan response
+ *            广播数据，后接扫描响应
+ * @param adv_len Length of both
+ *                两者的总长度
+ * @param has_scan_rsp Whether the scan response is included, only then is a non-camera remembered
+ *                     是否包含扫描响应，仅此时才记住非相机设备
+ * @param now_us Reception time
+ *               接收时刻
+ * @param is_new Set to true if the camera was added by this advertisement, may be NULL
+ *               本条广播新增了相机时置为 true，可为 NULL
+ * @return const scan_candidate_t* The camera's entry, NULL if the advertiser is not a camera or
+ *                                 did not fit into the table
+ *                                 相机的条目；广播者不是相机或表中放不下时返回 NULL
+ */
+const scan_candidate_t *scan_rank_observe(scan_rank_t *rank, const uint8_t bda[6], int8_t rssi,
+                                          const uint8_t *adv, size_t adv_len, bool has_scan_rsp,
+                                          int64_t now_us, bool *is_new) {
+    if (is_new) {
+        *is_new = false;
+    }
+
+    scan_candidate_t *candidate = find_candidate(rank, bda);
+    if (candidate) {
+        rank->adv_skipped++;
+        candidate->rssi_q4 += (rssi * 16 - candidate->rssi_q4) / (1 << SCAN_RANK_EWMA_SHIFT);
+        if (rssi > candidate->max_rssi) {
+            candidate->max_rssi = rssi;
+        }
+        candidate->samples++;
+        candidate->last_seen_us = now_us;
+        return candidate;
+    }
+    if (is_rejected(rank, bda)) {
+        rank->adv_skipped++;
+        return NULL;
+    }
+
+    char name[SCAN_RANK_NAME_LEN];
+    rank->adv_parsed++;
+    if (!scan_rank_parse_adv(adv, adv_len, name, sizeof(name))) {
+        if (has_scan_rsp) {
+            memcpy(rank->rejected[rank->rejected_next], bda, 6);
+            rank->rejected_next = (rank->rejected_next + 1) % SCAN_RANK_MAX_REJECTED;
+            if (rank->rejected_count < SCAN_RANK_MAX_REJECTED) {
+                rank->rejected_count++;
+            }
+        }
+        return NULL;
+    }
+
+    if (rank->count < SCAN_RANK_MAX_CANDIDATES) {
+        candidate = &rank->candidates[rank->count++];
+    } else {
+        candidate = &rank->candidates[0];
+        for (int i = 1; i < rank->count; i++) {
+            if (rank->candidates[i].rssi_q4 < candidate->rssi_q4) {
+                candidate = &rank->candidates[i];
+            }
+        }
+        if (rssi * 16 <= candidate->rssi_q4) {
+            return NULL;
+        }
+    }
+
+    memset(candidate, 0, sizeof(*candidate));
+    memcpy(candidate->bda, bda, 6);
+    candidate->rssi_q4 = (int16_t)(rssi * 16);
+    candidate->max_rssi = rssi;
+    candidate->samples = 1;
+    candidate->first_seen_us = now_us;
+    candidate->last_seen_us = now_us;
+    memcpy(candidate->name, name, sizeof(name));
+    if (is_new) {
+        *is_new = true;
+    }
+    return candidate;
+}
+
+/**
+ * @brief Camera with the strongest smoothed RSSI
+ *        平滑 RSSI 最强的相机
+ *
+ * @return const scan_candidate_t* NULL if no camera was heard
+ *                                 未听到任何相机时返回 NULL
+ */
+const scan_candidate_t *scan_rank_leader(const scan_rank_t *rank) {
+    const scan_candidate_t *leader = NULL;
+    for (int i = 0; i < rank->count; i++) {
+        if (leader == NULL || rank->candidates[i].rssi_q4 > leader->rssi_q4) {
+            leader = &rank->candidates[i];
+        }
+    }
+    return leader;
+}
+
+/**
+ * @brief Whether the scan can stop now with the leader as the choice
+ *        扫描是否可以立即停止并选择领先者
+ *
+ * The leader must have been heard min_samples times above min_rssi, lead every other camera by
+ * margin_db, and the scan must have run min_scan_us.
+ * 领先者须在 min_rssi 之上被听到 min_samples 次，领先其他所有相机 margin_db，且扫描已持续 min_scan_us。
+ */
+bool scan_rank_decided(const scan_rank_t *rank, int64_t now_us) {
+    const scan_rank_config_t *config = &rank->config;
+    if (now_us - rank->start_us < (int64_t)config->min_scan_us) {
+        return false;
+    }
+
+    const scan_candidate_t *leader = scan_rank_leader(rank);
+    if (leader == NULL || leader->samples < config->min_samples || leader->rssi_q4 < config->min_rssi * 16) {
+        return false;
+    }
+    for (int i = 0; i < rank->count; i++) {
+        const scan_candidate_t *rival = &rank->candidates[i];
+        if (rival != leader && leader->rssi_q4 - rival_rssi_q4(rival, config->min_samples) < config->margin_db * 16) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,103 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#ifndef __SCAN_RANK_H__
+#define __SCAN_RANK_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define SCAN_RANK_MAX_CANDIDATES    8   // Cameras tracked per scan / 每次扫描跟踪的相机数
+#define SCAN_RANK_MAX_REJECTED      16  // Other devices remembered per scan / 每次扫描记住的其他设备数
+#define SCAN_RANK_NAME_LEN          32  // Longest stored device name, with the terminator / 存储设备名的最大长度（含结束符）
+#define SCAN_RANK_EWMA_SHIFT        2   // EWMA weight of a new sample is 1/4 / 新样本的 EWMA 权重为 1/4
+
+/**
+ * @brief Rules for ending a fresh pairing scan early
+ *        首次配对扫描提前结束的规则
+ */
+typedef struct {
+    int8_t min_rssi;                // Weakest smoothed RSSI a camera may be chosen with
+                                    // 可被选中的相机的最弱平滑 RSSI
+    uint8_t min_samples;            // Advertisements before a camera's RSSI counts as stable
+                                    // 相机 RSSI 视为稳定前所需的广播数
+    uint8_t margin_db;              // Lead over every other camera before the scan may stop
+                                    // 扫描可停止前需领先其他所有相机的幅度
+    uint32_t min_scan_us;           // Listen at least this long so other cameras are heard
+                                    // 至少扫描这么久，确保能听到其他相机
+} scan_rank_config_t;
+
+/**
+ * @brief One camera seen during the scan
+ *        扫描中发现的一台相机
+ */
+typedef struct {
+    uint8_t bda[6];
+    int16_t rssi_q4;                // EWMA of the RSSI in 1/16 dBm
+                                    // RSSI 的 EWMA，单位 1/16 dBm
+    int8_t max_rssi;                // Strongest single advertisement
+                                    // 单条广播的最强 RSSI
+    uint16_t samples;               // Advertisements received
+                                    // 收到的广播数
+    int64_t first_seen_us;
+    int64_t last_seen_us;
+    char name[SCAN_RANK_NAME_LEN];  // Complete local name, empty if none was advertised
+                                    // 完整设备名，未广播时为空
+} scan_candidate_t;
+
+/**
+ * @brief Ranked table of the cameras heard in one scan
+ *        一次扫描中听到的相机的排名表
+ *
+ * The advertising data of a device is parsed once per scan: later advertisements of a known
+ * camera only update its RSSI, and devices whose advertisement and scan response carried no DJI
+ * camera marker are remembered and skipped.
+ * 每个设备的广播数据每次扫描只解析一次：已知相机的后续广播仅更新其 RSSI，
+ * 广播与扫描响应中均不含 DJI 相机标识的设备会被记住并跳过。
+ */
+typedef struct {
+    scan_rank_config_t config;
+    int64_t start_us;
+    scan_candidate_t candidates[SCAN_RANK_MAX_CANDIDATES];
+    uint8_t count;
+    uint8_t rejected[SCAN_RANK_MAX_REJECTED][6];
+    uint8_t rejected_count;
+    uint8_t rejected_next;          // Slot the next rejected device overwrites / 下一个被拒设备覆盖的位置
+    uint32_t adv_parsed;            // Advertisements whose AD structures were walked
+                                    // 解析了 AD 结构的广播数
+    uint32_t adv_skipped;           // Advertisements answered from the tables
+                                    // 直接由表判定的广播数
+} scan_rank_t;
+
+void scan_rank_default_config(scan_rank_config_t *config);
+
+void scan_rank_reset(scan_rank_t *rank, const scan_rank_config_t *config, int64_t now_us);
+
+bool scan_rank_parse_adv(const uint8_t *adv, size_t adv_len, char *name_out, size_t name_capacity);
+
+const scan_candidate_t *scan_rank_observe(scan_rank_t *rank, const uint8_t bda[6], int8_t rssi,
+                                          const uint8_t *adv, size_t adv_len, bool has_scan_rsp,
+                                          int64_t now_us, bool *is_new);
+
+const scan_candidate_t *scan_rank_leader(const scan_rank_t *rank);
+
+bool scan_rank_decided(const scan_rank_t *rank, int64_t now_us);
+
+#endif
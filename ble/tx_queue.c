@@ -0,0 +1,213 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#include <string.h>
+
+#include "tx_queue.h"
+
+/* Remove the oldest frame of a priority and return its slot to the free list */
+/* 移除某优先级中最旧的帧，并将其槽位归还空闲列表 */
+static void remove_head(tx_queue_t *queue, ble_tx_prio_t prio) {
+    const uint8_t slot = queue->fifo[prio][queue->head[prio]];
+    queue->head[prio] = (uint8_t)((queue->head[prio] + 1) % TX_QUEUE_LEN);
+    queue->count[prio]--;
+    queue->free[queue->free_count++] = slot;
+    queue->stats.depth--;
+}
+
+/**
+ * @brief Empty the queue and clear its counters
+ *        清空队列并清零计数
+ *
+ * @param queue Queue to initialize
+ *              要初始化的队列
+ */
+void tx_queue_init(tx_queue_t *queue) {
+    memset(queue, 0, sizeof(*queue));
+    for (int i = 0; i < TX_QUEUE_LEN; i++) {
+        queue->free[i] = (uint8_t)i;
+    }
+    queue->free_count = TX_QUEUE_LEN;
+}
+
+/**
+ * @brief Queue a frame behind the other frames of its priority
+ *        将帧排在同优先级其他帧之后
+ *
+ * @param queue Queue
+ *              队列
+ * @param prio Priority of the frame
+ *             帧的优先级
+ * @param handle Characteristic the frame is written to
+ *               帧写入的特征
+ * @param data Frame, copied into the queue
+ *             帧数据，会被拷贝进队列
+ * @param length Length of the frame, 1 to TX_QUEUE_FRAME_MAX
+ *               帧长度，1 到 TX_QUEUE_FRAME_MAX
+ * @param now_us Queueing time
+ *               入队时刻
+ * @return bool false if the frame is invalid or the queue is full of frames of the same or a higher priority
+ *              帧无效，或队列已被同级或更高优先级的帧占满时返回 false
+ */
+bool tx_queue_push(tx_queue_t *queue, ble_tx_prio_t prio, uint16_t handle, const uint8_t *data, size_t length,
+                   int64_t now_us) {
+    if (prio >= BLE_TX_PRIO_COUNT || data == NULL || length == 0 || length > TX_QUEUE_FRAME_MAX) {
+        return false;
+    }
+    if (queue->free_count == 0) {
+        int victim = BLE_TX_PRIO_COUNT - 1;
+        while (victim > (int)prio && queue->count[victim] == 0) {
+            victim--;
+        }
+        if (victim <= (int)prio) {
+            queue->stats.dropped[prio]++;
+            return false;
+        }
+        remove_head(queue, (ble_tx_prio_t)victim);
+        queue->stats.dropped[victim]++;
+    }
+
+    const uint8_t slot = queue->free[--queue->free_count];
+    tx_frame_t *frame = &queue->slots[slot];
+    frame->handle = handle;
+    frame->length = (uint16_t)length;
+    frame->queued_us = now_us;
+    memcpy(frame->data, data, length);
+
+    queue->fifo[prio][(queue->head[prio] + queue->count[prio]) % TX_QUEUE_LEN] = slot;
+    queue->count[prio]++;
+    queue->stats.queued++;
+    queue->stats.depth++;
+    if (queue->stats.depth > queue->stats.max_depth) {
+        queue->stats.max_depth = queue->stats.depth;
+    }
+    return true;
+}
+
+/**
+ * @brief Frame to send next: the oldest frame of the highest priority
+ *        下一个要发送的帧：最高优先级中最旧的帧
+ *
+ * @param queue Queue
+ *              队列
+ * @param prio_out Receives the priority of the frame, may be NULL
+ *                 接收该帧的优先级，可为 NULL
+ * @return const tx_frame_t* The frame, valid until the next push, pop or flush; NULL if the queue is empty
+ *                           该帧，在下一次入队、出队或清空前有效；队列为空时返回 NULL
+ */
+const tx_frame_t *tx_queue_peek(const tx_queue_t *queue, ble_tx_prio_t *prio_out) {
+    for (int prio = 0; prio < BLE_TX_PRIO_COUNT; prio++) {
+        if (queue->count[prio]) {
+            if (prio_out) {
+                *prio_out = (ble_tx_prio_t)prio;
+            }
+            return &queue->slots[queue->fifo[prio][queue->head[prio]]];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Remove the frame returned by tx_queue_peek once the stack accepted it
+ *        协议栈接受 tx_queue_peek 返回的帧后将其移除
+ *
+ * @param queue Queue
+ *              队列
+ * @param now_us Sending time
+ *               发送时刻
+ */
+void tx_queue_pop(tx_queue_t *queue, int64_t now_us) {
+    ble_tx_prio_t prio;
+    const tx_frame_t *frame = tx_queue_peek(queue, &prio);
+    if (frame == NULL) {
+        return;
+    }
+    const int64_t wait = now_us - frame->queued_us;
+    if (wait > queue->stats.max_wait_us[prio]) {
+        queue->stats.max_wait_us[prio] = wait;
+    }
+    remove_head(queue, prio);
+    queue->stats.sent++;
+}
+
+/**
+ * @brief Drop every queued frame, e.g. when the link is gone
+ *        丢弃所有排队的帧，例如链路断开时
+ *
+ * @param queue Queue
+ *              队列
+ * @param now_us Current time, ends a running stall
+ *               当前时刻，用于结束正在进行的停滞
+ * @return uint32_t Number of frames dropped
+ *                  丢弃的帧数
+ */
+uint32_t tx_queue_flush(tx_queue_t *queue, int64_t now_us) {
+    uint32_t flushed = 0;
+    for (int prio = 0; prio < BLE_TX_PRIO_COUNT; prio++) {
+        queue->stats.dropped[prio] += queue->count[prio];
+        flushed += queue->count[prio];
+        while (queue->count[prio]) {
+            remove_head(queue, (ble_tx_prio_t)prio);
+        }
+    }
+    tx_queue_set_stalled(queue, false, now_us);
+    return flushed;
+}
+
+/**
+ * @brief Record the start or end of a wait for controller buffers
+ *        记录等待控制器缓冲区的开始或结束
+ *
+ * @param queue Queue
+ *              队列
+ * @param stalled true while frames are waiting and no credit is left
+ *                有帧等待且没有剩余额度时为 true
+ * @param now_us Current time
+ *               当前时刻
+ */
+void tx_queue_set_stalled(tx_queue_t *queue, bool stalled, int64_t now_us) {
+    if (stalled == queue->stalled) {
+        return;
+    }
+    queue->stalled = stalled;
+    if (stalled) {
+        queue->stall_start_us = now_us;
+        queue->stats.stalls++;
+        return;
+    }
+    const int64_t stall = now_us - queue->stall_start_us;
+    queue->stats.stall_us += stall;
+    if (stall > queue->stats.max_stall_us) {
+        queue->stats.max_stall_us = stall;
+    }
+}
+
+/**
+ * @brief Clear the cumulative counters, the depth of the frames still queued is kept
+ *        清零累计计数，保留仍在排队的帧数
+ *
+ * @param queue Queue
+ *              队列
+ */
+void tx_queue_reset_stats(tx_queue_t *queue) {
+    const uint32_t depth = queue->stats.depth;
+    memset(&queue->stats, 0, sizeof(queue->stats));
+    queue->stats.depth = depth;
+    queue->stats.max_depth = depth;
+}
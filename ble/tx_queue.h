@@ -0,0 +1,107 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#ifndef __TX_QUEUE_H__
+#define __TX_QUEUE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define TX_QUEUE_LEN                16  // Frames waiting for the controller / 等待控制器的帧数
+#define TX_QUEUE_FRAME_MAX          244 // Largest ATT value in one LL PDU with DLE / 启用 DLE 时单个链路层 PDU 可容纳的最大 ATT 值
+
+/**
+ * @brief Priority of a Write Without Response, lower values are sent first
+ *        Write Without Response 的优先级，数值越小越先发送
+ */
+typedef enum {
+    BLE_TX_PRIO_CONTROL = 0,        // Commands and acks of the protocol / 协议命令与应答
+    BLE_TX_PRIO_STREAM,             // Periodic data whose newest value supersedes older ones, e.g. GPS / 新值取代旧值的周期数据，例如 GPS
+    BLE_TX_PRIO_BULK,               // Test and bulk traffic / 测试与批量数据
+    BLE_TX_PRIO_COUNT,
+} ble_tx_prio_t;
+
+/**
+ * @brief One queued frame
+ *        一个排队的帧
+ */
+typedef struct {
+    uint16_t handle;
+    uint16_t length;
+    int64_t queued_us;
+    uint8_t data[TX_QUEUE_FRAME_MAX];
+} tx_frame_t;
+
+/**
+ * @brief Counters of the TX queue, cumulative until tx_queue_reset_stats
+ *        发送队列的计数，累计至 tx_queue_reset_stats
+ */
+typedef struct {
+    uint32_t queued;                // Frames accepted / 已接收的帧数
+    uint32_t sent;                  // Frames handed to the stack / 已交给协议栈的帧数
+    uint32_t dropped[BLE_TX_PRIO_COUNT];    // Frames rejected or evicted, per priority
+                                            // 被拒绝或被挤出的帧数，按优先级统计
+    uint32_t depth;                 // Frames waiting now / 当前等待的帧数
+    uint32_t max_depth;             // Most frames ever waiting / 曾经等待的最多帧数
+    uint32_t stalls;                // Times the queue had frames but no credit / 队列有帧但无发送额度的次数
+    int64_t stall_us;               // Total time spent stalled / 停滞的总时长
+    int64_t max_stall_us;           // Longest single stall / 最长的单次停滞
+    uint32_t congestions;           // Congestion events reported by the stack / 协议栈上报的拥塞事件数
+    int64_t max_wait_us[BLE_TX_PRIO_COUNT]; // Longest time from queueing to sending, per priority
+                                            // 从入队到发送的最长时间，按优先级统计
+} tx_queue_stats_t;
+
+/**
+ * @brief Frames waiting for controller buffers, in one FIFO per priority
+ *        等待控制器缓冲区的帧，每个优先级一个 FIFO
+ *
+ * A full queue makes room for a frame by evicting the oldest frame of a lower priority; when there
+ * is none, the new frame is rejected. Both count as a drop of the priority that lost its frame.
+ * 队列满时，通过挤出更低优先级中最旧的帧为新帧腾出空间；若没有更低优先级的帧，则拒绝新帧。
+ * 两种情况都计为失去帧的那个优先级的一次丢弃。
+ */
+typedef struct {
+    tx_frame_t slots[TX_QUEUE_LEN];
+    uint8_t free[TX_QUEUE_LEN];     // Indices of unused slots / 空闲槽位的下标
+    uint8_t free_count;
+    uint8_t fifo[BLE_TX_PRIO_COUNT][TX_QUEUE_LEN];  // Slot indices in queueing order / 按入队顺序排列的槽位下标
+    uint8_t head[BLE_TX_PRIO_COUNT];
+    uint8_t count[BLE_TX_PRIO_COUNT];
+    bool stalled;
+    int64_t stall_start_us;
+    tx_queue_stats_t stats;
+} tx_queue_t;
+
+void tx_queue_init(tx_queue_t *queue);
+
+bool tx_queue_push(tx_queue_t *queue, ble_tx_prio_t prio, uint16_t handle, const uint8_t *data, size_t length,
+                   int64_t now_us);
+
+const tx_frame_t *tx_queue_peek(const tx_queue_t *queue, ble_tx_prio_t *prio_out);
+
+void tx_queue_pop(tx_queue_t *queue, int64_t now_us);
+
+uint32_t tx_queue_flush(tx_queue_t *queue, int64_t now_us);
+
+void tx_queue_set_stalled(tx_queue_t *queue, bool stalled, int64_t now_us);
+
+void tx_queue_reset_stats(tx_queue_t *queue);
+
+#endif
@@ -22,20 +22,73 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "freertos/timers.h"
-#include "freertos/queue.h"
 #include "freertos/task.h"
 #include "esp_log.h"
 #include "esp_err.h"
 
 #include "data.h"
 #include "ble.h"
+#include "notify_ring.h"
+#include "frame_trace.h"
 #include "dji_protocol_parser.h"
+#include "dji_protocol_reassembler.h"
 
 #define TAG "DATA"
 
-/* 最大并行等待的命令数量 */
-/* Maximum number of commands that can be waited in parallel */
+/* 最大并行等待的命令数量，可通过 menuconfig 或编译选项调整 */
+/* Maximum number of commands that can be waited in parallel, adjustable via menuconfig or compiler flags */
+#ifndef MAX_SEQ_ENTRIES
+#ifdef CONFIG_DATA_MAX_SEQ_ENTRIES
+#define MAX_SEQ_ENTRIES CONFIG_DATA_MAX_SEQ_ENTRIES
+#else
 #define MAX_SEQ_ENTRIES 10
+#endif
+#endif
+
+/* 哈希索引位数，索引容量为条目数的 2 倍以上，保证负载因子不超过 0.5 */
+/* Hash index bits, the index holds at least twice as many slots as entries to keep the load factor <= 0.5 */
+#if MAX_SEQ_ENTRIES <= 8
+#define ENTRY_INDEX_BITS 4
+#elif MAX_SEQ_ENTRIES <= 16
+#define ENTRY_INDEX_BITS 5
+#elif MAX_SEQ_ENTRIES <= 32
+#define ENTRY_INDEX_BITS 6
+#elif MAX_SEQ_ENTRIES <= 64
+#define ENTRY_INDEX_BITS 7
+#elif MAX_SEQ_ENTRIES <= 128
+#define ENTRY_INDEX_BITS 8
+#elif MAX_SEQ_ENTRIES <= 256
+#define ENTRY_INDEX_BITS 9
+#elif MAX_SEQ_ENTRIES <= 512
+#define ENTRY_INDEX_BITS 10
+#elif MAX_SEQ_ENTRIES <= 1024
+#define ENTRY_INDEX_BITS 11
+#else
+#error "MAX_SEQ_ENTRIES must not exceed 1024"
+#endif
+
+#define ENTRY_INDEX_SIZE (1u << ENTRY_INDEX_BITS)
+#define ENTRY_INDEX_MASK (ENTRY_INDEX_SIZE - 1u)
+
+/* 空索引/空链表标记 */
+/* Marks an empty index slot or list end */
+#define ENTRY_NONE 0xFFFF
+
+/* 通知环形缓冲区可同时容纳的最大长度通知条数 */
+/* Number of maximum-size notifications the notification ring holds at once */
+#define NOTIFY_RING_DEPTH 10
+
+/* ATT 通知头（opcode + handle）长度，通知负载最多为 MTU 减去该值 */
+/* ATT notification header (opcode + handle), a notification carries at most MTU minus this */
+#define ATT_NOTIFY_HEADER_SIZE 3
+
+/* 有帧尚未收全时，链路空闲超过该时间（毫秒）即放弃该帧，释放其后被扣留的帧 */
+/* Link idle time in milliseconds after which a partially received frame is given up, releasing the frames held behind it */
+#define REASSEMBLY_IDLE_MS 100
+
+/* 条目内联保存的解析结果大小，状态推送等常见结果无需堆分配 */
+/* Size of the parse result kept inline in an entry, so common results such as status pushes need no heap */
+#define DATA_INLINE_RESULT_SIZE 64
 
 /* 定时删除的周期（单位：毫秒） */
 /* Cleanup interval in milliseconds */
@@ -70,27 +123,80 @@ typedef struct {
     // Valid if is_seq_based is false
     uint8_t cmd_id;
 
-    // 解析后的通用结构体
-    // Generic structure after parsing
+    // 解析后的通用结构体，指向 inline_result 或堆内存
+    // Generic structure after parsing, points at inline_result or heap memory
     void *parse_result;
 
     // 解析结果的长度
     // Length of parsed result
     size_t parse_result_length;
 
-    // 用于同步等待
-    // For synchronous waiting
+    // 用于同步等待，在 data_init 中为每个槽位创建一次并循环复用
+    // For synchronous waiting, created once per slot in data_init and recycled
     SemaphoreHandle_t sem;
 
+    // 槽位每次被分配时递增，用于识别属于前一个使用者的过期唤醒
+    // Bumped every time the slot is claimed, identifies stale wakeups meant for a previous owner
+    uint32_t generation;
+
+    // 最近一次释放 sem 时对应的 generation
+    // Generation the last give on sem was meant for
+    uint32_t signalled_generation;
+
+    // 阻塞在 sem 上的任务数，有等待者的条目不会被淘汰、清理或释放
+    // Tasks blocked on sem; entries with a waiter are never evicted, cleaned up or freed
+    uint8_t waiters;
+
+    // 等待者被 data_abort_waits 唤醒，不会再有结果
+    // The waiter was woken by data_abort_waits, no result will come
+    bool aborted;
+
     // 最近访问的时间戳，用于 LRU 策略
     // Last access timestamp for LRU policy
     TickType_t last_access_time;
+
+    // LRU 双向链表（使用中）或空闲链表（未使用，仅 next）的下标
+    // Indices in the LRU list (in use) or the free list (unused, next only)
+    uint16_t prev;
+    uint16_t next;
+
+    // 不超过 DATA_INLINE_RESULT_SIZE 的解析结果存放于此
+    // Parse results up to DATA_INLINE_RESULT_SIZE are stored here
+    uint8_t inline_result[DATA_INLINE_RESULT_SIZE] __attribute__((aligned(4)));
 } entry_t;
 
+/* 开放寻址哈希索引槽：键为 seq 或 (cmd_set << 8 | cmd_id)，值为条目下标 */
+/* Open-addressed index slot: key is seq or (cmd_set << 8 | cmd_id), value is the entry index */
+typedef struct {
+    uint16_t key;
+    uint16_t entry;
+} index_slot_t;
+
+/* 按最近访问排序的条目链表，头部最旧 */
+/* Entry list ordered by last access, oldest at the head */
+typedef struct {
+    uint16_t head;
+    uint16_t tail;
+} entry_list_t;
+
 /* 维护 seq 到解析结果的映射 */
 /* Maintains mapping from seq to parsed results */
 static entry_t s_entries[MAX_SEQ_ENTRIES];
 
+/* seq 索引与 (cmd_set, cmd_id) 索引 */
+/* seq index and (cmd_set, cmd_id) index */
+static index_slot_t s_seq_index[ENTRY_INDEX_SIZE];
+static index_slot_t s_cmd_index[ENTRY_INDEX_SIZE];
+
+/* 基于 seq 和基于 cmd 的条目分别维护 LRU 链表，淘汰时无需遍历整个数组 */
+/* Separate LRU lists for seq-based and cmd-based entries, so eviction never scans the whole array */
+static entry_list_t s_seq_lru;
+static entry_list_t s_cmd_lru;
+
+/* 空闲条目栈 */
+/* Stack of free entries */
+static uint16_t s_free_head = ENTRY_NONE;
+
 /* 互斥锁，保护 s_seq_entries */
 /* Mutex to protect s_seq_entries */
 static SemaphoreHandle_t s_map_mutex = NULL;
@@ -103,27 +209,214 @@ static TimerHandle_t cleanup_timer = NULL;
 /* Task handle for delayed notification processing */
 static TaskHandle_t notify_task_handle = NULL;
 
-/* 通知数据队列 */
-/* Queue for notification data */
-static QueueHandle_t notify_queue = NULL;
+/* 通知环形缓冲区，生产者为 GATTC 通知回调，消费者为 notify_processing_task */
+/* Notification ring, produced by the GATTC notify callback and consumed by notify_processing_task */
+static notify_ring_t s_notify_ring;
 
-/* 通知数据结构 */
-/* Structure for notification data */
-typedef struct {
-    uint8_t *data;
-    size_t data_length;
-} notify_data_t;
+/* 环中单条通知的最大长度 */
+/* Largest notification the ring accepts */
+static size_t s_notify_max_length = 0;
+
+/* 协商 MTU 后希望的单条通知最大长度，由 GATTC 回调写入，消费者在下一轮处理时据此调整环大小，0 表示无变化 */
+/* Largest notification wanted after the MTU exchange, written by the GATTC callback; the consumer resizes the ring on its next pass, 0 for none */
+static size_t s_wanted_notify_length = 0;
+
+/* 生产者正在写环 / 消费者正在替换环；两者配合使替换时没有生产者在写旧环，且生产者从不阻塞 */
+/* A producer is writing to the ring / the consumer is replacing it; together they keep producers off a ring being replaced without ever blocking them */
+static uint8_t s_ring_producing = 0;
+static uint8_t s_ring_resizing = 0;
+
+/* 因环正在替换而丢弃的通知数，计入溢出计数 */
+/* Notifications dropped because the ring was being replaced, part of the overflow count */
+static uint32_t s_resize_drop_count = 0;
+
+/* 帧重组器，通知可包含多帧或帧的一部分，仅由 notify_processing_task 使用 */
+/* Frame reassembler, a notification may carry several frames or part of one; used by notify_processing_task only */
+static protocol_reassembler_t s_reassembler;
+
+/* 数据段解析缓冲区，重组后的帧可长于单条通知，按最大帧长分配，仅由 notify_processing_task 使用 */
+/* Parse buffer for the data segment, sized for the largest frame since a reassembled frame can exceed one notification; used by notify_processing_task only */
+static uint8_t s_parse_buffer[PROTOCOL_MAX_FRAME_LENGTH];
 
 /* 前向声明 */
 /* Forward declarations */
 static void notify_processing_task(void *pvParameters);
-static void process_notification_data(const uint8_t *raw_data, size_t raw_data_length);
+static void process_notification_data(const uint8_t *raw_data, size_t raw_data_length, void *ctx);
+
+/**
+ * @brief Hash a 16-bit key into an index slot (Fibonacci hashing)
+ *        将 16 位键散列到索引槽（斐波那契散列）
+ */
+static inline uint16_t index_hash(uint16_t key) {
+    return (uint16_t)(((uint32_t)key * 2654435769u) >> (32 - ENTRY_INDEX_BITS));
+}
+
+/**
+ * @brief Look up a key in an index
+ *        在索引中查找键
+ *
+ * @return uint16_t Entry index, ENTRY_NONE if not found
+ *                  条目下标，未找到返回 ENTRY_NONE
+ */
+static uint16_t index_lookup(const index_slot_t *table, uint16_t key) {
+    for (uint16_t i = index_hash(key); table[i].entry != ENTRY_NONE; i = (i + 1) & ENTRY_INDEX_MASK) {
+        if (table[i].key == key) {
+            return table[i].entry;
+        }
+    }
+    return ENTRY_NONE;
+}
+
+/**
+ * @brief Insert a key, the caller guarantees it is not present yet
+ *        插入键，调用者保证该键尚不存在
+ */
+static void index_insert(index_slot_t *table, uint16_t key, uint16_t entry) {
+    uint16_t i = index_hash(key);
+    while (table[i].entry != ENTRY_NONE) {
+        i = (i + 1) & ENTRY_INDEX_MASK;
+    }
+    table[i].key = key;
+    table[i].entry = entry;
+}
+
+/**
+ * @brief Remove a key with backward-shift deletion, so probe chains never need tombstones
+ *        使用后移删除法移除键，探测链无需墓碑标记
+ */
+static void index_remove(index_slot_t *table, uint16_t key) {
+    uint16_t hole = index_hash(key);
+    while (table[hole].entry != ENTRY_NONE && table[hole].key != key) {
+        hole = (hole + 1) & ENTRY_INDEX_MASK;
+    }
+    if (table[hole].entry == ENTRY_NONE) {
+        return;
+    }
+
+    // Pull later members of the probe chain back into the hole when their home slot allows it
+    // 若探测链中后续元素的初始槽位允许，则将其前移填补空洞
+    for (uint16_t i = (hole + 1) & ENTRY_INDEX_MASK; table[i].entry != ENTRY_NONE; i = (i + 1) & ENTRY_INDEX_MASK) {
+        uint16_t home = index_hash(table[i].key);
+        bool stays = (hole < i) ? (home > hole && home <= i) : (home > hole || home <= i);
+        if (!stays) {
+            table[hole] = table[i];
+            hole = i;
+        }
+    }
+    table[hole].entry = ENTRY_NONE;
+}
+
+/**
+ * @brief Unlink an entry from an LRU list
+ *        将条目从 LRU 链表中摘除
+ */
+static void list_unlink(entry_list_t *list, uint16_t idx) {
+    entry_t *entry = &s_entries[idx];
+    if (entry->prev != ENTRY_NONE) {
+        s_entries[entry->prev].next = entry->next;
+    } else {
+        list->head = entry->next;
+    }
+    if (entry->next != ENTRY_NONE) {
+        s_entries[entry->next].prev = entry->prev;
+    } else {
+        list->tail = entry->prev;
+    }
+    entry->prev = ENTRY_NONE;
+    entry->next = ENTRY_NONE;
+}
+
+/**
+ * @brief Append an entry to the most recently used end of an LRU list
+ *        将条目追加到 LRU 链表的最近使用端
+ */
+static void list_push_tail(entry_list_t *list, uint16_t idx) {
+    entry_t *entry = &s_entries[idx];
+    entry->prev = list->tail;
+    entry->next = ENTRY_NONE;
+    if (list->tail != ENTRY_NONE) {
+        s_entries[list->tail].next = idx;
+    } else {
+        list->head = idx;
+    }
+    list->tail = idx;
+}
+
+static inline entry_list_t *entry_lru(const entry_t *entry) {
+    return entry->is_seq_based ? &s_seq_lru : &s_cmd_lru;
+}
+
+static inline uint16_t entry_index(const entry_t *entry) {
+    return (uint16_t)(entry - s_entries);
+}
+
+static inline uint16_t cmd_key(uint8_t cmd_set, uint8_t cmd_id) {
+    return (uint16_t)((cmd_set << 8) | cmd_id);
+}
+
+/**
+ * @brief Refresh the access time of an entry and move it to the MRU end
+ *        刷新条目的访问时间并移到最近使用端
+ */
+static void touch_entry(entry_t *entry) {
+    entry->last_access_time = xTaskGetTickCount();
+    entry_list_t *list = entry_lru(entry);
+    uint16_t idx = entry_index(entry);
+    if (list->tail != idx) {
+        list_unlink(list, idx);
+        list_push_tail(list, idx);
+    }
+}
+
+/**
+ * @brief Drop the parse result of an entry
+ *        丢弃条目的解析结果
+ */
+static void release_entry_result(entry_t *entry) {
+    if (entry->parse_result && entry->parse_result != (void *)entry->inline_result) {
+        free(entry->parse_result);
+    }
+    entry->parse_result = NULL;
+    entry->parse_result_length = 0;
+}
+
+/**
+ * @brief Copy a parse result into an entry, replacing any result nobody collected
+ *        将解析结果拷贝到条目中，替换尚未被取走的旧结果
+ *
+ * Results that fit in inline_result never touch the heap.
+ * 能放入 inline_result 的结果不会产生堆分配。
+ *
+ * @return bool true on success, false if a large result could not be allocated
+ *              成功返回 true，大结果分配内存失败返回 false
+ */
+static bool store_entry_result(entry_t *entry, const void *result, size_t result_length) {
+    void *target = entry->inline_result;
+    if (result_length > DATA_INLINE_RESULT_SIZE) {
+        target = malloc(result_length);
+        if (target == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate memory for parse result");
+            return false;
+        }
+    }
+    release_entry_result(entry);
+    memcpy(target, result, result_length);
+    entry->parse_result = target;
+    entry->parse_result_length = result_length;
+    return true;
+}
 
 /**
  * @brief Initialize seq_entries and mark all entries as unused
  *        初始化 seq_entries，将所有条目标记为未使用
+ *
+ * Also creates the wait semaphore of every slot on first use; they live for the whole session.
+ * 首次调用时同时为每个槽位创建等待信号量，之后在整个运行期间复用。
+ *
+ * @return bool true on success, false if a semaphore could not be created
+ *              成功返回 true，信号量创建失败返回 false
  */
-static void reset_entries(void) {
+static bool reset_entries(void) {
     for (int i = 0; i < MAX_SEQ_ENTRIES; i++) {
         s_entries[i].in_use = false;
         s_entries[i].is_seq_based = false;
@@ -131,16 +424,33 @@ static void reset_entries(void) {
         s_entries[i].cmd_set = 0;
         s_entries[i].cmd_id = 0;
         s_entries[i].last_access_time = 0;
-        if (s_entries[i].parse_result) {
-            free(s_entries[i].parse_result);
-            s_entries[i].parse_result = NULL;
-        }
-        s_entries[i].parse_result_length = 0;
-        if (s_entries[i].sem) {
-            vSemaphoreDelete(s_entries[i].sem);
-            s_entries[i].sem = NULL;
+        s_entries[i].waiters = 0;
+        s_entries[i].aborted = false;
+        release_entry_result(&s_entries[i]);
+        if (s_entries[i].sem == NULL) {
+            s_entries[i].sem = xSemaphoreCreateBinary();
+            if (s_entries[i].sem == NULL) {
+                ESP_LOGE(TAG, "Failed to create semaphore for entry %d", i);
+                return false;
+            }
         }
+        // Any token still pending on the semaphore now belongs to an older generation
+        // 信号量上残留的令牌此后都属于旧的 generation
+        s_entries[i].generation++;
+        // Chain every entry into the free stack
+        // 将所有条目串入空闲栈
+        s_entries[i].prev = ENTRY_NONE;
+        s_entries[i].next = (i + 1 < MAX_SEQ_ENTRIES) ? (uint16_t)(i + 1) : ENTRY_NONE;
     }
+    s_free_head = 0;
+
+    for (unsigned int i = 0; i < ENTRY_INDEX_SIZE; i++) {
+        s_seq_index[i].entry = ENTRY_NONE;
+        s_cmd_index[i].entry = ENTRY_NONE;
+    }
+    s_seq_lru.head = s_seq_lru.tail = ENTRY_NONE;
+    s_cmd_lru.head = s_cmd_lru.tail = ENTRY_NONE;
+    return true;
 }
 
 /**
@@ -153,13 +463,12 @@ static void reset_entries(void) {
  *                  找到的条目指针，未找到则返回 NULL
  */
 static entry_t* find_entry_by_seq(uint16_t seq) {
-    for (int i = 0; i < MAX_SEQ_ENTRIES; i++) {
-        if (s_entries[i].in_use && s_entries[i].is_seq_based && s_entries[i].seq == seq) {
-            s_entries[i].last_access_time = xTaskGetTickCount();
-            return &s_entries[i];
-        }
+    uint16_t idx = index_lookup(s_seq_index, seq);
+    if (idx == ENTRY_NONE) {
+        return NULL;
     }
-    return NULL;
+    touch_entry(&s_entries[idx]);
+    return &s_entries[idx];
 }
 
 /**
@@ -173,15 +482,13 @@ static entry_t* find_entry_by_seq(uint16_t seq) {
  * @return entry_t* Pointer to found entry, NULL if not found
  *                  找到的条目指针，未找到则返回 NULL
  */
-static entry_t* find_entry_by_cmd_id(uint16_t cmd_set, uint16_t cmd_id) {
-    for (int i = 0; i < MAX_SEQ_ENTRIES; i++) {
-        if (s_entries[i].in_use && !s_entries[i].is_seq_based && 
-            s_entries[i].cmd_set == cmd_set && s_entries[i].cmd_id == cmd_id) {
-            s_entries[i].last_access_time = xTaskGetTickCount();
-            return &s_entries[i];
-        }
+static entry_t* find_entry_by_cmd_id(uint8_t cmd_set, uint8_t cmd_id) {
+    uint16_t idx = index_lookup(s_cmd_index, cmd_key(cmd_set, cmd_id));
+    if (idx == ENTRY_NONE) {
+        return NULL;
     }
-    return NULL;
+    touch_entry(&s_entries[idx]);
+    return &s_entries[idx];
 }
 
 /**
@@ -192,23 +499,93 @@ static entry_t* find_entry_by_cmd_id(uint16_t cmd_set, uint16_t cmd_id) {
  *              要释放的条目指针
  */
 static void free_entry(entry_t *entry) {
-    if (entry) {
+    if (entry && entry->in_use) {
+        uint16_t idx = entry_index(entry);
+
+        // Drop the entry from its index and LRU list, then return it to the free stack
+        // 从索引和 LRU 链表中移除条目，再放回空闲栈
+        if (entry->is_seq_based) {
+            index_remove(s_seq_index, entry->seq);
+        } else {
+            index_remove(s_cmd_index, cmd_key(entry->cmd_set, entry->cmd_id));
+        }
+        list_unlink(entry_lru(entry), idx);
+
         entry->in_use = false;
         entry->is_seq_based = false;
         entry->seq = 0;
         entry->cmd_set = 0;
         entry->cmd_id = 0;
         entry->last_access_time = 0;
-        if (entry->parse_result) {
-            free(entry->parse_result);
-            entry->parse_result = NULL;
-        }
-        entry->parse_result_length = 0;
-        if (entry->sem) {
-            vSemaphoreDelete(entry->sem);
-            entry->sem = NULL;
+        entry->waiters = 0;
+        entry->aborted = false;
+        release_entry_result(entry);
+
+        // The semaphore stays with the slot for the next owner
+        // 信号量保留在槽位上，供下一个使用者复用
+        entry->next = s_free_head;
+        s_free_head = idx;
+    }
+}
+
+/* 没有任务等待时释放条目；否则由最后离开的等待者释放 */
+/* Free an entry unless a task still waits on it; otherwise the last waiter to leave frees it */
+static void release_entry(entry_t *entry) {
+    if (entry && entry->waiters == 0) {
+        free_entry(entry);
+    }
+}
+
+/**
+ * @brief Oldest entry of an LRU list that nobody is waiting on
+ *        LRU 链表中没有等待者的最旧条目
+ *
+ * Normally the head itself; only entries with a blocked waiter are skipped.
+ * 通常就是链表头，只会跳过有任务阻塞等待的条目。
+ */
+static entry_t *oldest_evictable(const entry_list_t *list) {
+    for (uint16_t idx = list->head; idx != ENTRY_NONE; idx = s_entries[idx].next) {
+        if (s_entries[idx].waiters == 0) {
+            return &s_entries[idx];
         }
     }
+    return NULL;
+}
+
+/**
+ * @brief Take an entry from the free stack and register it in the index and LRU list
+ *        从空闲栈取出一个条目，并登记到索引和 LRU 链表
+ *
+ * @return entry_t* Pointer to allocated entry, NULL if the stack is empty
+ *                  返回分配的条目指针，空闲栈为空时返回 NULL
+ */
+static entry_t *claim_free_entry(bool is_seq_based, uint16_t seq, uint8_t cmd_set, uint8_t cmd_id) {
+    if (s_free_head == ENTRY_NONE) {
+        return NULL;
+    }
+    uint16_t idx = s_free_head;
+    entry_t *entry = &s_entries[idx];
+    s_free_head = entry->next;
+
+    entry->in_use = true;
+    entry->is_seq_based = is_seq_based;
+    entry->seq = seq;
+    entry->cmd_set = cmd_set;
+    entry->cmd_id = cmd_id;
+    entry->parse_result = NULL;
+    entry->parse_result_length = 0;
+    entry->waiters = 0;
+    entry->aborted = false;
+    entry->generation++;
+    entry->last_access_time = xTaskGetTickCount();
+
+    if (is_seq_based) {
+        index_insert(s_seq_index, seq, idx);
+    } else {
+        index_insert(s_cmd_index, cmd_key(cmd_set, cmd_id), idx);
+    }
+    list_push_tail(entry_lru(entry), idx);
+    return entry;
 }
 
 /**
@@ -224,74 +601,43 @@ static entry_t* allocate_entry_by_seq(uint16_t seq) {
     // First check if an entry with the same seq exists
     // 首先检查是否已存在相同 seq 的条目
     entry_t *existing_entry = find_entry_by_seq(seq);
+    if (existing_entry && existing_entry->waiters > 0) {
+        // A task is already parked on this seq, keep its semaphore alive and let it receive the response
+        // 已有任务在等待此 seq，保留其信号量，由它接收应答
+        return existing_entry;
+    }
     if (existing_entry) {
         ESP_LOGI(TAG, "Overwriting existing entry for seq=0x%04X", seq);
         free_entry(existing_entry);
     }
 
-    // For tracking the least recently used entry
-    // 用于记录最久未使用的条目
-    entry_t* oldest_entry = NULL;
-
-    // Initialize with current time
-    // 初始时间为当前时间
-    TickType_t oldest_access_time = xTaskGetTickCount();
-
-    for (int i = 0; i < MAX_SEQ_ENTRIES; i++) {
-        if (!s_entries[i].in_use) {
-            s_entries[i].in_use = true;
-            s_entries[i].is_seq_based = true;
-            s_entries[i].seq = seq;
-            s_entries[i].cmd_set = 0;
-            s_entries[i].cmd_id = 0;
-            s_entries[i].parse_result = NULL;
-            s_entries[i].parse_result_length = 0;
-            s_entries[i].sem = xSemaphoreCreateBinary();
-            if (s_entries[i].sem == NULL) {
-                ESP_LOGE(TAG, "Failed to create semaphore for seq=0x%04X", seq);
-                s_entries[i].in_use = false;
-                return NULL;
+    // If no free entry, delete the least recently used entry of either kind
+    // 如果没有空闲条目，则删除两类条目中最久未使用的那个
+    if (s_free_head == ENTRY_NONE) {
+        entry_t *oldest_seq = oldest_evictable(&s_seq_lru);
+        entry_t *oldest_cmd = oldest_evictable(&s_cmd_lru);
+        entry_t *oldest_entry = oldest_seq;
+        if (oldest_cmd) {
+            // Compare ages rather than timestamps so tick wrap-around is harmless
+            // 比较存活时长而不是时间戳，避免 tick 回绕的影响
+            TickType_t now = xTaskGetTickCount();
+            if (oldest_seq == NULL ||
+                (TickType_t)(now - oldest_cmd->last_access_time) > (TickType_t)(now - oldest_seq->last_access_time)) {
+                oldest_entry = oldest_cmd;
             }
-            s_entries[i].last_access_time = xTaskGetTickCount();
-            return &s_entries[i];
         }
-
-        // Track the least recently used entry
-        // 最久未使用的条目
-        if (s_entries[i].last_access_time < oldest_access_time) {
-            oldest_access_time = s_entries[i].last_access_time;
-            oldest_entry = &s_entries[i];
+        if (oldest_entry == NULL) {
+            ESP_LOGE(TAG, "All entries have waiters, can't allocate seq=0x%04X", seq);
+            return NULL;
         }
-    }
-
-    // If no free entry, delete the least recently used entry
-    // 如果没有空闲条目，则删除最久未使用的条目
-    if (oldest_entry) {
         ESP_LOGW(TAG, "Deleting the least recently used entry: seq=0x%04X or cmd_set=0x%04X cmd_id=0x%04X",
                  oldest_entry->is_seq_based ? oldest_entry->seq : 0,
                  oldest_entry->cmd_set,
                  oldest_entry->cmd_id);
         free_entry(oldest_entry);
-        // Reallocate
-        // 重新分配
-        oldest_entry->in_use = true;
-        oldest_entry->is_seq_based = true;
-        oldest_entry->seq = seq;
-        oldest_entry->cmd_set = 0;
-        oldest_entry->cmd_id = 0;
-        oldest_entry->parse_result = NULL;
-        oldest_entry->parse_result_length = 0;
-        oldest_entry->sem = xSemaphoreCreateBinary();
-        if (oldest_entry->sem == NULL) {
-            ESP_LOGE(TAG, "Failed to create semaphore for seq=0x%04X", seq);
-            oldest_entry->in_use = false;
-            return NULL;
-        }
-        oldest_entry->last_access_time = xTaskGetTickCount();
-        return oldest_entry;
     }
 
-    return NULL;
+    return claim_free_entry(true, seq, 0, 0);
 }
 
 /**
@@ -316,70 +662,48 @@ static entry_t* allocate_entry_by_cmd(uint8_t cmd_set, uint8_t cmd_id) {
         return existing_entry;
     }
 
-    // Allocate new entry
-    // 分配新的条目
-    entry_t* oldest_entry = NULL;  // For tracking the least recently used non-seq-based entry
-                                  // 用于记录最久未使用的非 seq-based 条目
-    TickType_t oldest_access_time = xTaskGetTickCount();
-
-    for (int i = 0; i < MAX_SEQ_ENTRIES; i++) {
-        if (!s_entries[i].in_use) {
-            // Found a free entry
-            // 找到一个空闲条目
-            s_entries[i].in_use = true;
-            s_entries[i].is_seq_based = false;
-            s_entries[i].seq = 0;
-            s_entries[i].cmd_set = cmd_set;
-            s_entries[i].cmd_id = cmd_id;
-            s_entries[i].parse_result = NULL;
-            s_entries[i].parse_result_length = 0;
-            s_entries[i].sem = xSemaphoreCreateBinary();
-            if (s_entries[i].sem == NULL) {
-                ESP_LOGE(TAG, "Failed to create semaphore for cmd_set=0x%04X cmd_id=0x%04X", cmd_set, cmd_id);
-                s_entries[i].in_use = false;
-                return NULL;
-            }
-            s_entries[i].last_access_time = xTaskGetTickCount();
-            return &s_entries[i];
-        }
-
-        // Only consider non-seq-based entries as deletion candidates
-        // 仅考虑非基于 seq 的条目作为候选删除对象
-        if (!s_entries[i].is_seq_based && s_entries[i].last_access_time < oldest_access_time) {
-            oldest_access_time = s_entries[i].last_access_time;
-            oldest_entry = &s_entries[i];
-        }
-    }
-
     // If no free entry, try to delete the least recently used non-seq-based entry
     // 如果没有空闲条目，则尝试删除最久未使用的非 seq-based 条目
-    if (oldest_entry) {
+    if (s_free_head == ENTRY_NONE) {
+        entry_t *oldest_entry = oldest_evictable(&s_cmd_lru);
+        if (oldest_entry == NULL) {
+            ESP_LOGE(TAG, "No available cmd-based entry to allocate for cmd_set=0x%04X cmd_id=0x%04X", cmd_set, cmd_id);
+            return NULL;
+        }
         ESP_LOGW(TAG, "Deleting the least recently used cmd-based entry: cmd_set=0x%04X cmd_id=0x%04X",
                  oldest_entry->cmd_set,
                  oldest_entry->cmd_id);
         free_entry(oldest_entry);
+    }
 
-        // Reallocate the deleted entry
-        // 重新分配被删除的条目
-        oldest_entry->in_use = true;
-        oldest_entry->is_seq_based = false;
-        oldest_entry->seq = 0;
-        oldest_entry->cmd_set = cmd_set;
-        oldest_entry->cmd_id = cmd_id;
-        oldest_entry->parse_result = NULL;
-        oldest_entry->parse_result_length = 0;
-        oldest_entry->sem = xSemaphoreCreateBinary();
-        if (oldest_entry->sem == NULL) {
-            ESP_LOGE(TAG, "Failed to create semaphore for cmd_set=0x%04X cmd_id=0x%04X", cmd_set, cmd_id);
-            oldest_entry->in_use = false;
-            return NULL;
+    return claim_free_entry(false, 0, cmd_set, cmd_id);
+}
+
+/**
+ * @brief Free the expired entries of one LRU list
+ *        释放一个 LRU 链表中过期的条目
+ *
+ * The list is ordered by access time, so the walk stops at the first young entry.
+ * 链表按访问时间排序，遇到第一个未过期的条目即停止。
+ */
+static void cleanup_list(entry_list_t *list, TickType_t current_time) {
+    uint16_t idx = list->head;
+    while (idx != ENTRY_NONE) {
+        entry_t *entry = &s_entries[idx];
+        uint16_t next = entry->next;
+        if (entry->waiters == 0) {
+            if ((current_time - entry->last_access_time) <= pdMS_TO_TICKS(MAX_ENTRY_AGE * 1000)) {
+                break;
+            }
+            if (entry->is_seq_based) {
+                ESP_LOGI(TAG, "Cleaning up unused entry seq=0x%04X", entry->seq);
+            } else {
+                ESP_LOGI(TAG, "Cleaning up unused entry cmd_set=0x%04X cmd_id=0x%04X", entry->cmd_set, entry->cmd_id);
+            }
+            free_entry(entry);
         }
-        oldest_entry->last_access_time = xTaskGetTickCount();
-        return oldest_entry;
+        idx = next;
     }
-
-    ESP_LOGE(TAG, "No available cmd-based entry to allocate for cmd_set=0x%04X cmd_id=0x%04X", cmd_set, cmd_id);
-    return NULL;
 }
 
 /**
@@ -402,21 +726,62 @@ static void cleanup_old_entries(TimerHandle_t xTimer) {
         ESP_LOGE(TAG, "Failed to take mutex in cleanup");
         return;
     }
-    // Check each entry for expiration
-    // 检查每个条目是否过期
-    for (int i = 0; i < MAX_SEQ_ENTRIES; i++) {
-        if (s_entries[i].in_use && (current_time - s_entries[i].last_access_time) > pdMS_TO_TICKS(MAX_ENTRY_AGE * 1000)) {
-            if (s_entries[i].is_seq_based) {
-                ESP_LOGI(TAG, "Cleaning up unused entry seq=0x%04X", s_entries[i].seq);
-            } else {
-                ESP_LOGI(TAG, "Cleaning up unused entry cmd_set=0x%04X cmd_id=0x%04X", s_entries[i].cmd_set, s_entries[i].cmd_id);
-            }
-            free_entry(&s_entries[i]);
-        }
-    }
+    // Only the oldest entries of each list need to be checked
+    // 只需检查每个链表中最旧的条目
+    cleanup_list(&s_seq_lru, current_time);
+    cleanup_list(&s_cmd_lru, current_time);
     xSemaphoreGive(s_map_mutex);
 }
 
+/**
+ * @brief Replace the notification ring with one sized for max_length
+ *        用按 max_length 计算大小的环形缓冲区替换现有的
+ *
+ * Called from notify_processing_task, or from data_init before that task exists. Producers are
+ * kept off the ring while it is replaced, a notification arriving meanwhile is counted as an
+ * overflow. Notifications still queued and a partially reassembled frame are dropped; the old
+ * ring is kept if the new one cannot be allocated.
+ * 在 notify_processing_task 中调用，或在该任务创建之前由 data_init 调用。替换期间生产者不会写环，
+ * 其间到达的通知计为溢出。仍在排队的通知和重组了一半的帧会被丢弃；新环形缓冲区分配失败时保留旧的。
+ *
+ * @param max_length Largest notification to accept
+ *                   可接收的最大通知长度
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM on allocation failure
+ *                   成功返回 ESP_OK，分配失败返回 ESP_ERR_NO_MEM
+ */
+static esp_err_t resize_notify_ring(size_t max_length) {
+    notify_ring_t ring;
+    esp_err_t ret = notify_ring_init(&ring, notify_ring_capacity_for(max_length, NOTIFY_RING_DEPTH));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // Hold new producers off, then let a push already under way finish; it never blocks. Sleep
+    // rather than yield so a producer of any priority gets to run
+    // 阻止新的生产者，再等待已在进行的写入完成；写入从不阻塞。用休眠而非让出，使任意优先级的生产者都能运行
+    __atomic_store_n(&s_ring_resizing, 1, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&s_ring_producing, __ATOMIC_SEQ_CST)) {
+        vTaskDelay(1);
+    }
+
+    if (s_notify_ring.buf && s_notify_ring.head != s_notify_ring.tail) {
+        ESP_LOGW(TAG, "Dropping notifications queued before the ring resize");
+    }
+
+    // The overflow count covers the whole session
+    // 溢出计数覆盖整个运行期间
+    ring.overflow_count = s_notify_ring.overflow_count;
+    notify_ring_deinit(&s_notify_ring);
+    protocol_reassembler_reset(&s_reassembler);
+
+    s_notify_ring = ring;
+    s_notify_max_length = max_length;
+    __atomic_store_n(&s_ring_resizing, 0, __ATOMIC_RELEASE);
+    ESP_LOGI(TAG, "Notification ring sized for %u byte frames: %u bytes",
+             (unsigned)max_length, (unsigned)s_notify_ring.capacity);
+    return ESP_OK;
+}
+
 /**
  * @brief Data layer initialization
  *        数据层初始化
@@ -433,9 +798,11 @@ void data_init(void) {
         return;
     }
 
-    // Clear all entries
-    // 清空所有条目
-    reset_entries();
+    // Clear all entries and create the wait semaphore pool
+    // 清空所有条目并创建等待信号量池
+    if (!reset_entries()) {
+        return;
+    }
 
     // Initialize timer for cleaning up expired entries
     // 初始化定时器，用于清理过期的条目
@@ -446,13 +813,18 @@ void data_init(void) {
         xTimerStart(cleanup_timer, 0);
     }
 
-    // Initialize notification queue
-    // 初始化通知队列
-    notify_queue = xQueueCreate(MAX_SEQ_ENTRIES, sizeof(notify_data_t));
-    if (notify_queue == NULL) {
-        ESP_LOGE(TAG, "Failed to create notification queue");
+    // Initialize the notification ring for the largest MTU we offer, it shrinks once the real one is negotiated
+    // 按本端提供的最大 MTU 初始化通知环形缓冲区，协商出实际 MTU 后再缩小
+    protocol_reassembler_init(&s_reassembler, process_notification_data, NULL);
+    if (resize_notify_ring(BLE_LOCAL_MTU - ATT_NOTIFY_HEADER_SIZE) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create notification ring");
+        return;
     }
 
+    // Start the frame tracer, full frames are printed from its own low-priority task
+    // 启动帧跟踪，完整帧由其自身的低优先级任务打印
+    frame_trace_init();
+
     // Initialize notification task
     // 初始化通知任务
     if (xTaskCreate(notify_processing_task, "notify_processing_task", 2048, NULL, 1, &notify_task_handle) != pdPASS) {
@@ -465,6 +837,38 @@ void data_init(void) {
     ESP_LOGI(TAG, "Data layer initialized successfully");
 }
 
+/**
+ * @brief Size the notification ring for the negotiated MTU
+ *        按协商得到的 MTU 调整通知环形缓冲区大小
+ *
+ * Called from the GATTC callback, so it only records the size and wakes notify_processing_task,
+ * which replaces the ring on its next pass. The camera cannot notify before its CCCD is written,
+ * so the ring is resized long before the first notification on the new connection.
+ * 在 GATTC 回调中调用，因此只记录大小并唤醒 notify_processing_task，由其在下一轮处理时替换环形缓冲区。
+ * 相机在其 CCCD 写入前不会发送通知，因此环形缓冲区远在新连接的第一条通知之前完成调整。
+ *
+ * @param mtu Negotiated ATT MTU
+ *            协商得到的 ATT MTU
+ */
+void data_set_notify_mtu(uint16_t mtu) {
+    if (!data_layer_initialized || mtu <= ATT_NOTIFY_HEADER_SIZE) {
+        return;
+    }
+    __atomic_store_n(&s_wanted_notify_length, (size_t)(mtu - ATT_NOTIFY_HEADER_SIZE), __ATOMIC_RELEASE);
+    xTaskNotifyGive(notify_task_handle);
+}
+
+/**
+ * @brief Number of notifications dropped because the notification ring was full or being resized
+ *        因通知环形缓冲区已满或正在调整大小而丢弃的通知数
+ *
+ * @return uint32_t Dropped notifications since data_init
+ *                  自 data_init 以来丢弃的通知数
+ */
+uint32_t data_get_notify_overflow_count(void) {
+    return notify_ring_overflow_count(&s_notify_ring) + __atomic_load_n(&s_resize_drop_count, __ATOMIC_RELAXED);
+}
+
 /**
  * @brief Check if data layer is initialized
  *        检查数据层是否已初始化
@@ -539,7 +943,7 @@ esp_err_t data_write_with_response(uint16_t seq, const uint8_t *raw_data, size_t
         // Clean up on failure
         // 失败时清理资源
         if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-            free_entry(entry);
+            release_entry(entry);
             xSemaphoreGive(s_map_mutex);
         }
         return ret;
@@ -548,6 +952,20 @@ esp_err_t data_write_with_response(uint16_t seq, const uint8_t *raw_data, size_t
     return ESP_OK;
 }
 
+/* GPS pushes (0x00, 0x17) are superseded by the next fix, so they queue behind commands and acks */
+/* GPS 推送（0x00, 0x17）会被下一个定位取代，因此排在命令与应答之后 */
+static ble_tx_prio_t frame_tx_prio(const uint8_t *raw_data, size_t raw_data_length) {
+    if (raw_data_length < 16 || raw_data[0] != 0xAA) {
+        return BLE_TX_PRIO_CONTROL;
+    }
+    protocol_frame_t frame;
+    protocol_decode_frame(raw_data, raw_data_length, &frame);
+    if (frame.data && frame.data_length >= 2 && frame.data[0] == 0x00 && frame.data[1] == 0x17) {
+        return BLE_TX_PRIO_STREAM;
+    }
+    return BLE_TX_PRIO_CONTROL;
+}
+
 /**
  * @brief Send data frame without response
  *        发送数据帧（无响应）
@@ -573,66 +991,228 @@ esp_err_t data_write_without_response(uint16_t seq, const uint8_t *raw_data, siz
         return ESP_ERR_INVALID_ARG;
     }
 
-    // Take mutex for thread safety
-    // 获取互斥锁以保证线程安全
-    if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
-        ESP_LOGE(TAG, "Failed to take mutex");
-        return ESP_ERR_INVALID_STATE;
-    }
-
-    // Allocate an entry for this sequence
-    // 为此序列号分配一个条目
-    entry_t *entry = allocate_entry_by_seq(seq);
-    if (!entry) {
-        ESP_LOGE(TAG, "No free entry, can't write");
-        xSemaphoreGive(s_map_mutex);
-        return ESP_ERR_NO_MEM;
-    }
-
-    xSemaphoreGive(s_map_mutex);
+    // Nothing is collected for this frame, so it takes no entry. An entry already registered for
+    // the same seq belongs to a pending request and is left to its waiter
+    // 该帧没有结果需要收取，因此不占用条目。相同 seq 上已登记的条目属于在途请求，留给其等待者
+    (void)seq;
 
-    // Send write command without response
-    // 发送写命令（无响应）
-    esp_err_t ret = ble_write_without_response(
+    // Queue the write command without response, GPS pushes yield to commands when the controller is busy
+    // 将无响应写命令排队，控制器繁忙时 GPS 推送让位于命令
+    esp_err_t ret = ble_write_without_response_prio(
         s_ble_profile.conn_id,           // Current connection ID
                                          // 当前连接 ID
         s_ble_profile.write_char_handle, // Write characteristic handle
                                          // 写特征句柄
         raw_data,                        // Data to be sent
                                          // 要发送的数据
-        raw_data_length                  // Length of data
+        raw_data_length,                 // Length of data
                                          // 数据长度
+        frame_tx_prio(raw_data, raw_data_length)
     );
 
     // Handle write failure
     // 处理写入失败的情况
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "ble_write_without_response failed: %s", esp_err_to_name(ret));
-        // Clean up on failure
-        // 失败时清理资源
-        if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-            free_entry(entry);
-            xSemaphoreGive(s_map_mutex);
-        }
         return ret;
     }
 
-    // For write without response, release entry immediately
-    // 对于无响应写，立即释放条目
-    if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        free_entry(entry);
-        xSemaphoreGive(s_map_mutex);
+    return ESP_OK;
+}
+
+/* 等待者希望的结果去处：调用者的缓冲区，或 buffer 为 NULL 时的堆拷贝 */
+/* Where a waiter wants its result: the caller's buffer, or a heap copy when buffer is NULL */
+typedef struct {
+    void *buffer;
+    size_t buffer_size;
+    void **out_heap;
+    size_t *out_length;
+} result_dest_t;
+
+/**
+ * @brief Hand the parsed result of an entry to the caller and release the entry
+ *        将条目中的解析结果交给调用者并释放条目
+ *
+ * Must be called with s_map_mutex held. An entry other tasks still wait on keeps its result for them.
+ * 调用前必须持有 s_map_mutex。仍有其他任务等待的条目保留结果供它们取走。
+ *
+ * @param entry Entry holding the result
+ *              持有结果的条目
+ * @param out_seq Return sequence number, may be NULL
+ *                返回的 seq 值，可为 NULL
+ * @param dest Where the result goes
+ *             结果的去处
+ *
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_SIZE if the result does not fit the caller's buffer,
+ *                   other error code on failure
+ *                   成功返回 ESP_OK，结果放不进调用者缓冲区时返回 ESP_ERR_INVALID_SIZE，其他失败返回错误码
+ */
+static esp_err_t take_entry_result(entry_t *entry, uint16_t *out_seq, const result_dest_t *dest) {
+    if (entry->parse_result == NULL) {
+        ESP_LOGE(TAG, "Parse result is NULL for seq=0x%04X cmd_set=0x%04X cmd_id=0x%04X", entry->seq, entry->cmd_set, entry->cmd_id);
+        release_entry(entry);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    void *target = dest->buffer;
+    *dest->out_length = entry->parse_result_length;
+    if (target != NULL) {
+        if (entry->parse_result_length > dest->buffer_size) {
+            ESP_LOGE(TAG, "Result of %zu bytes exceeds the %zu byte buffer", entry->parse_result_length, dest->buffer_size);
+            release_entry(entry);
+            return ESP_ERR_INVALID_SIZE;
+        }
+    } else {
+        // Allocate new memory for out_result
+        // 为 out_result 分配新内存
+        target = malloc(entry->parse_result_length);
+        if (target == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate memory for out_result");
+            release_entry(entry);
+            return ESP_ERR_NO_MEM;
+        }
+        *dest->out_heap = target;
+    }
+
+    // Copy entry->parse_result data to out_result
+    // 拷贝 entry->parse_result 数据到 out_result
+    memcpy(target, entry->parse_result, entry->parse_result_length);
+    if (out_seq) {
+        *out_seq = entry->seq;
     }
 
+    release_entry(entry);
     return ESP_OK;
 }
 
+/**
+ * @brief Park the calling task on an entry until its result arrives
+ *        让调用任务阻塞在条目上，直到结果到达
+ *
+ * Must be called with s_map_mutex held, returns with it released. The task blocks on the
+ * entry's own semaphore, which process_notification_data gives as soon as the matching frame
+ * is stored, so the wake-up latency is bounded by the BLE link rather than a poll period.
+ * 调用前必须持有 s_map_mutex，返回时已释放。任务阻塞在条目自身的信号量上，
+ * process_notification_data 存入匹配帧后立即释放该信号量，唤醒延迟只取决于 BLE 链路而非轮询周期。
+ *
+ * Several tasks may wait on one entry, e.g. a command and the protocol handshake on the same cmd_set/cmd_id.
+ * Each of them gets a copy of the result, and the last one to leave frees the entry.
+ * 多个任务可以等待同一条目，例如命令与协议握手等待相同的 cmd_set/cmd_id。
+ * 每个任务都会得到结果的一份拷贝，最后离开的任务释放条目。
+ *
+ * @param entry Entry registered for the awaited seq or cmd_set/cmd_id
+ *              为等待的 seq 或 cmd_set/cmd_id 登记的条目
+ * @param timeout_ms Timeout in milliseconds
+ *                   等待的超时时间（毫秒）
+ * @param out_seq Return sequence number, may be NULL
+ *                返回的 seq 值，可为 NULL
+ * @param dest Where the result goes
+ *             结果的去处
+ *
+ * @return esp_err_t ESP_OK on success, error code on failure
+ *                   成功返回 ESP_OK，失败返回错误码
+ */
+static esp_err_t wait_for_entry_result(entry_t *entry, int timeout_ms, uint16_t *out_seq, const result_dest_t *dest) {
+    // Result may already be there, e.g. the camera pushed before anyone asked
+    // 结果可能已经到达，例如相机在调用前已主动推送
+    if (entry->parse_result == NULL) {
+        // Count ourselves in so the entry is neither evicted, cleaned up nor freed while we sleep on its semaphore
+        // 登记为等待者，避免在等待其信号量期间条目被淘汰、清理或释放
+        entry->waiters++;
+        SemaphoreHandle_t sem = entry->sem;
+        uint32_t generation = entry->generation;
+        TickType_t start_time = xTaskGetTickCount();
+        TickType_t timeout_ticks = pdMS_TO_TICKS(timeout_ms);
+        BaseType_t signalled = pdFALSE;
+
+        while (true) {
+            xSemaphoreGive(s_map_mutex);
+
+            TickType_t elapsed = xTaskGetTickCount() - start_time;
+            signalled = xSemaphoreTake(sem, elapsed < timeout_ticks ? timeout_ticks - elapsed : 0);
+
+            // The waiter count must be dropped, so do not give up on the mutex here
+            // 必须减少等待者计数，因此这里不放弃获取互斥锁
+            xSemaphoreTake(s_map_mutex, portMAX_DELAY);
+
+            // A token left over from a previous owner of this slot is not ours, keep waiting
+            // 该槽位前一个使用者遗留的令牌不属于本次等待，继续等待
+            if (signalled == pdTRUE && entry->signalled_generation != generation) {
+                continue;
+            }
+            break;
+        }
+        entry->waiters--;
+
+        // The semaphore holds one token: pass it on to the next task waiting for the same result
+        // 信号量只有一个令牌：将其传给等待同一结果的下一个任务
+        if (signalled == pdTRUE && entry->waiters > 0) {
+            xSemaphoreGive(sem);
+        }
+
+        // The link went away, the camera will not answer on it
+        // 链路已断开，相机不会再在其上应答
+        if (entry->aborted && entry->parse_result == NULL) {
+            release_entry(entry);
+            xSemaphoreGive(s_map_mutex);
+            return ESP_ERR_INVALID_STATE;
+        }
+
+        // A result stored just after the timeout still counts
+        // 超时后紧接着存入的结果仍然有效
+        if (signalled != pdTRUE && entry->parse_result == NULL) {
+            release_entry(entry);
+            xSemaphoreGive(s_map_mutex);
+            return ESP_ERR_TIMEOUT;
+        }
+    }
+
+    esp_err_t ret = take_entry_result(entry, out_seq, dest);
+    xSemaphoreGive(s_map_mutex);
+    return ret;
+}
+
+/* 按 seq 查找或登记条目并等待其结果 */
+/* Find or register the entry for seq and wait for its result */
+static esp_err_t wait_for_seq(uint16_t seq, int timeout_ms, const result_dest_t *dest) {
+    // Take mutex for thread safety
+    // 获取互斥锁以保证线程安全
+    if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        ESP_LOGE(TAG, "Failed to take mutex");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Find the registered entry, or register one now
+    // 查找已登记的条目，没有则立即登记
+    entry_t *entry = find_entry_by_seq(seq);
+    if (!entry) {
+        entry = allocate_entry_by_seq(seq);
+        if (!entry) {
+            ESP_LOGE(TAG, "No free entry to wait for seq=0x%04X", seq);
+            xSemaphoreGive(s_map_mutex);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    esp_err_t ret = wait_for_entry_result(entry, timeout_ms, NULL, dest);
+    if (ret == ESP_ERR_TIMEOUT) {
+        ESP_LOGW(TAG, "Wait for seq=0x%04X timed out", seq);
+    }
+    return ret;
+}
+
 /**
  * @brief Wait for parsing result of specific sequence number
  *        等待特定 seq 的解析结果
  * 
  * Wait for parsing result of a specific sequence number and return to caller.
+ * The entry is normally registered by data_write_with_response; if it is missing
+ * it is registered here, so the response can never slip past the waiter.
  * 等待一个特定 seq 的解析结果，并返回给调用者。
+ * 条目通常由 data_write_with_response 登记；若不存在则在此登记，保证应答不会被错过。
+ * 
+ * Note: The caller needs to free the returned result.
+ * 注意：调用方需要释放返回的结果。
  * 
  * @param seq Frame sequence number
  *            数据帧的序列号
@@ -654,93 +1234,69 @@ esp_err_t data_wait_for_result_by_seq(uint16_t seq, int timeout_ms, void **out_r
         return ESP_ERR_INVALID_ARG;
     }
 
-    // Get start time and calculate timeout ticks
-    // 获取开始时间并计算超时时钟数
-    TickType_t start_time = xTaskGetTickCount();
-    TickType_t timeout_ticks = pdMS_TO_TICKS(timeout_ms);
-
-    while (true) {
-        // Take mutex for thread safety
-        // 获取互斥锁以保证线程安全
-        if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
-            ESP_LOGE(TAG, "Failed to take mutex");
-            return ESP_ERR_INVALID_STATE;
-        }
-
-        // Try to find entry
-        // 尝试查找条目
-        entry_t *entry = find_entry_by_seq(seq);
-
-        if (entry) {
-            // Increase reference count to prevent release during waiting
-            // 增加引用计数，防止在等待期间被释放
-            xSemaphoreGive(s_map_mutex);
-
-            // Wait for semaphore to be released
-            // 等待信号量被释放
-            if (xSemaphoreTake(entry->sem, timeout_ticks) != pdTRUE) {
-                ESP_LOGW(TAG, "Wait for seq=0x%04X timed out", seq);
-                if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                    free_entry(entry);
-                    xSemaphoreGive(s_map_mutex);
-                }
-                return ESP_ERR_TIMEOUT;
-            }
-
-            // Get parsing result
-            // 取出解析结果
-            if (entry->parse_result) {
-                // Allocate new memory for out_result
-                // 为 out_result 分配新内存
-                *out_result = malloc(entry->parse_result_length);
-                if (*out_result == NULL) {
-                    ESP_LOGE(TAG, "Failed to allocate memory for out_result");
-                    if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                        free_entry(entry);
-                        xSemaphoreGive(s_map_mutex);
-                    }
-                    return ESP_ERR_NO_MEM;
-                }
+    const result_dest_t dest = { .out_heap = out_result, .out_length = out_result_length };
+    return wait_for_seq(seq, timeout_ms, &dest);
+}
 
-                // Copy entry->parse_result data to out_result
-                // 拷贝 entry->parse_result 数据到 out_result
-                memcpy(*out_result, entry->parse_result, entry->parse_result_length);
-                *out_result_length = entry->parse_result_length;  // Set length
-                                                                 // 设置长度
-            } else {
-                ESP_LOGE(TAG, "Parse result is NULL for seq=0x%04X", seq);
-                if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                    free_entry(entry);
-                    xSemaphoreGive(s_map_mutex);
-                }
-                return ESP_ERR_NOT_FOUND;
-            }
+/**
+ * @brief Wait for parsing result of specific sequence number into a caller buffer
+ *        等待特定 seq 的解析结果，并存入调用者的缓冲区
+ *
+ * Same as data_wait_for_result_by_seq without touching the heap.
+ * 与 data_wait_for_result_by_seq 相同，但不产生堆分配。
+ *
+ * @param seq Frame sequence number
+ *            数据帧的序列号
+ * @param timeout_ms Timeout in milliseconds
+ *                   等待的超时时间（毫秒）
+ * @param out_result Buffer receiving the parsed result
+ *                   接收解析结果的缓冲区
+ * @param result_size Size of out_result
+ *                    out_result 的大小
+ * @param out_result_length Return length of parsed result
+ *                          返回解析结果的长度
+ *
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_SIZE if the result does not fit, other error code on failure
+ *                   成功返回 ESP_OK，结果放不下时返回 ESP_ERR_INVALID_SIZE，其他失败返回错误码
+ */
+esp_err_t data_wait_for_result_by_seq_into(uint16_t seq, int timeout_ms, void *out_result, size_t result_size,
+                                           size_t *out_result_length) {
+    if (!out_result || !out_result_length) {
+        ESP_LOGE(TAG, "out_result or out_result_length is NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
 
-            // Free entry
-            // 释放条目
-            if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                free_entry(entry);
-                xSemaphoreGive(s_map_mutex);
-            }
+    const result_dest_t dest = { .buffer = out_result, .buffer_size = result_size, .out_length = out_result_length };
+    return wait_for_seq(seq, timeout_ms, &dest);
+}
 
-            return ESP_OK;
-        }
+/* 按 cmd_set/cmd_id 查找或登记条目并等待其结果 */
+/* Find or register the entry for cmd_set/cmd_id and wait for its result */
+static esp_err_t wait_for_cmd(uint8_t cmd_set, uint8_t cmd_id, int timeout_ms, uint16_t *out_seq,
+                              const result_dest_t *dest) {
+    // Take mutex for thread safety
+    // 获取互斥锁以保证线程安全
+    if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        ESP_LOGE(TAG, "Failed to take mutex");
+        return ESP_ERR_INVALID_STATE;
+    }
 
-        // Check for timeout if entry not found
-        // 如果没有找到条目，检查是否超时
-        TickType_t elapsed_time = xTaskGetTickCount() - start_time;
-        if (elapsed_time >= timeout_ticks) {
-            ESP_LOGW(TAG, "Timeout while waiting for seq=0x%04X, no entry found", seq);
+    // Reuse a pushed or registered entry, otherwise register one
+    // 复用已推送或已登记的条目，否则登记新条目
+    entry_t *entry = find_entry_by_cmd_id(cmd_set, cmd_id);
+    if (!entry) {
+        entry = allocate_entry_by_cmd(cmd_set, cmd_id);
+        if (!entry) {
             xSemaphoreGive(s_map_mutex);
-            return ESP_ERR_TIMEOUT;
+            return ESP_ERR_NO_MEM;
         }
+    }
 
-        // Entry not found, release lock and wait before retry
-        // 没有找到条目，释放锁并等待一段时间再重试
-        xSemaphoreGive(s_map_mutex);
-        vTaskDelay(pdMS_TO_TICKS(10)); // Wait 10ms before retry
-                                       // 等待 10 毫秒后重试
+    esp_err_t ret = wait_for_entry_result(entry, timeout_ms, out_seq, dest);
+    if (ret == ESP_ERR_TIMEOUT) {
+        ESP_LOGW(TAG, "Wait for cmd_set=0x%04X cmd_id=0x%04X timed out", cmd_set, cmd_id);
     }
+    return ret;
 }
 
 /**
@@ -748,7 +1304,13 @@ esp_err_t data_wait_for_result_by_seq(uint16_t seq, int timeout_ms, void **out_r
  *        等待特定 cmd_set 和 cmd_id 的解析结果，并返回 seq
  * 
  * Wait for parsing result of a specific command set and ID, and return its corresponding sequence number.
+ * If the camera has not pushed the command yet, a cmd-based entry is registered and the caller
+ * sleeps on it until process_notification_data stores the frame.
  * 等待一个特定 cmd_set 和 cmd_id 的解析结果，并返回其对应的 seq 值。
+ * 若相机尚未推送该命令，则登记一个基于 cmd 的条目，调用者阻塞在其上，直到 process_notification_data 存入该帧。
+ * 
+ * Note: The caller needs to free the returned result.
+ * 注意：调用方需要释放返回的结果。
  * 
  * @param cmd_set Command set
  *                命令集
@@ -774,136 +1336,72 @@ esp_err_t data_wait_for_result_by_cmd(uint8_t cmd_set, uint8_t cmd_id, int timeo
         return ESP_ERR_INVALID_ARG;
     }
 
-    // Get start time and calculate timeout ticks
-    // 获取开始时间并计算超时时钟数
-    TickType_t start_time = xTaskGetTickCount();
-    TickType_t timeout_ticks = pdMS_TO_TICKS(timeout_ms);
-
-    while (true) {
-        // Take mutex for thread safety
-        // 获取互斥锁以保证线程安全
-        if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
-            ESP_LOGE(TAG, "Failed to take mutex");
-            return ESP_ERR_INVALID_STATE;
-        }
-
-        // Try to find entry
-        // 尝试查找条目
-        entry_t *entry = find_entry_by_cmd_id(cmd_set, cmd_id);
-
-        if (entry) {
-            // Check if entry already has result
-            // 检查条目是否已经有结果
-            if (entry->parse_result != NULL) {
-                // Entry already has result, get it immediately
-                // 条目已经有结果，立即获取
-                *out_result = malloc(entry->parse_result_length);
-                if (*out_result == NULL) {
-                    ESP_LOGE(TAG, "Failed to allocate memory for out_result");
-                    xSemaphoreGive(s_map_mutex);
-                    return ESP_ERR_NO_MEM;
-                }
-                
-                // Copy entry->parse_result data to out_result
-                // 拷贝 entry->parse_result 数据到 out_result
-                memcpy(*out_result, entry->parse_result, entry->parse_result_length);
-                *out_result_length = entry->parse_result_length;
-                *out_seq = entry->seq;
-                
-                // Free entry
-                // 释放条目
-                free_entry(entry);
-                xSemaphoreGive(s_map_mutex);
-                return ESP_OK;
-            }
-            
-            // Entry exists but no result yet, need to wait
-            // 条目存在但还没有结果，需要等待
-            SemaphoreHandle_t sem_to_wait = entry->sem;
-            xSemaphoreGive(s_map_mutex);
-            
-            // Wait for semaphore to be released
-            // 等待信号量被释放
-            if (xSemaphoreTake(sem_to_wait, timeout_ticks) != pdTRUE) {
-                ESP_LOGW(TAG, "Wait for cmd_set=0x%04X cmd_id=0x%04X timed out", cmd_set, cmd_id);
-                // Try to clean up the entry if it still exists
-                // 尝试清理条目（如果仍然存在）
-                if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                    entry_t *timeout_entry = find_entry_by_cmd_id(cmd_set, cmd_id);
-                    if (timeout_entry) {
-                        free_entry(timeout_entry);
-                    }
-                    xSemaphoreGive(s_map_mutex);
-                }
-                return ESP_ERR_TIMEOUT;
-            }
-            
-            // Re-acquire mutex to get the result
-            // 重新获取互斥锁以获取结果
-            if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
-                ESP_LOGE(TAG, "Failed to take mutex after semaphore wait");
-                return ESP_ERR_INVALID_STATE;
-            }
-            
-            // Find entry again after waiting
-            // 等待后重新查找条目
-            entry = find_entry_by_cmd_id(cmd_set, cmd_id);
-            if (!entry) {
-                ESP_LOGE(TAG, "Entry not found after semaphore wait");
-                xSemaphoreGive(s_map_mutex);
-                return ESP_ERR_NOT_FOUND;
-            }
-            
-            // Get parsing result
-            // 取出解析结果
-            if (entry->parse_result) {
-                // Allocate new memory for out_result
-                // 为 out_result 分配新内存
-                *out_result = malloc(entry->parse_result_length);
-                if (*out_result == NULL) {
-                    ESP_LOGE(TAG, "Failed to allocate memory for out_result");
-                    free_entry(entry);
-                    xSemaphoreGive(s_map_mutex);
-                    return ESP_ERR_NO_MEM;
-                }
-                // Copy entry->parse_result data to out_result
-                // 拷贝 entry->parse_result 数据到 out_result
-                memcpy(*out_result, entry->parse_result, entry->parse_result_length);
-                *out_result_length = entry->parse_result_length;
-            } else {
-                ESP_LOGE(TAG, "Parse result is NULL for cmd_set=0x%04X cmd_id=0x%04X", cmd_set, cmd_id);
-                free_entry(entry);
-                xSemaphoreGive(s_map_mutex);
-                return ESP_ERR_NOT_FOUND;
-            }
-
-            // Save sequence number
-            // 保存序列号
-            *out_seq = entry->seq;
+    const result_dest_t dest = { .out_heap = out_result, .out_length = out_result_length };
+    return wait_for_cmd(cmd_set, cmd_id, timeout_ms, out_seq, &dest);
+}
 
-            // Free entry
-            // 释放条目
-            free_entry(entry);
-            xSemaphoreGive(s_map_mutex);
+/**
+ * @brief Wait for parsing result by command set and ID into a caller buffer
+ *        等待特定 cmd_set 和 cmd_id 的解析结果，并存入调用者的缓冲区
+ *
+ * Same as data_wait_for_result_by_cmd without touching the heap.
+ * 与 data_wait_for_result_by_cmd 相同，但不产生堆分配。
+ *
+ * @param cmd_set Command set
+ *                命令集
+ * @param cmd_id Command ID
+ *               命令 ID
+ * @param timeout_ms Timeout in milliseconds
+ *                   等待的超时时间（毫秒）
+ * @param out_seq Return sequence number
+ *                返回的 seq 值
+ * @param out_result Buffer receiving the parsed result
+ *                   接收解析结果的缓冲区
+ * @param result_size Size of out_result
+ *                    out_result 的大小
+ * @param out_result_length Return length of parsed result
+ *                          返回解析结果的长度
+ *
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_SIZE if the result does not fit, other error code on failure
+ *                   成功返回 ESP_OK，结果放不下时返回 ESP_ERR_INVALID_SIZE，其他失败返回错误码
+ */
+esp_err_t data_wait_for_result_by_cmd_into(uint8_t cmd_set, uint8_t cmd_id, int timeout_ms, uint16_t *out_seq,
+                                           void *out_result, size_t result_size, size_t *out_result_length) {
+    if (!out_result || !out_seq || !out_result_length) {
+        ESP_LOGE(TAG, "out_result, out_seq or out_result_length is NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
 
-            return ESP_OK;
-        }
+    const result_dest_t dest = { .buffer = out_result, .buffer_size = result_size, .out_length = out_result_length };
+    return wait_for_cmd(cmd_set, cmd_id, timeout_ms, out_seq, &dest);
+}
 
-        // Check for timeout if entry not found
-        // 如果没有找到条目，检查是否超时
-        TickType_t elapsed_time = xTaskGetTickCount() - start_time;
-        if (elapsed_time >= timeout_ticks) {
-            ESP_LOGW(TAG, "Timeout while waiting for cmd_set=0x%04X cmd_id=0x%04X, no entry found", cmd_set, cmd_id);
-            xSemaphoreGive(s_map_mutex);
-            return ESP_ERR_TIMEOUT;
+/**
+ * @brief Wake every task waiting for a result, e.g. because the link is gone
+ *        唤醒所有等待结果的任务，例如链路已断开时
+ *
+ * The woken data_wait_for_result_by_seq / data_wait_for_result_by_cmd calls return
+ * ESP_ERR_INVALID_STATE right away instead of running into their timeout. A result that was
+ * already stored is still returned. Waits that start afterwards are not affected.
+ * 被唤醒的 data_wait_for_result_by_seq / data_wait_for_result_by_cmd 立即返回 ESP_ERR_INVALID_STATE，
+ * 而不是等到超时。已存入的结果仍会返回。之后开始的等待不受影响。
+ */
+void data_abort_waits(void) {
+    if (!data_layer_initialized) {
+        return;
+    }
+    if (xSemaphoreTake(s_map_mutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    for (int i = 0; i < MAX_SEQ_ENTRIES; i++) {
+        entry_t *entry = &s_entries[i];
+        if (entry->in_use && entry->waiters > 0 && !entry->aborted) {
+            entry->aborted = true;
+            entry->signalled_generation = entry->generation;
+            xSemaphoreGive(entry->sem);
         }
-
-        // Entry not found, release lock and wait before retry
-        // 没有找到条目，释放锁并等待一段时间再重试
-        xSemaphoreGive(s_map_mutex);
-        vTaskDelay(pdMS_TO_TICKS(10)); // Wait 10ms before retry
-                                       // 等待 10 毫秒后重试
     }
+    xSemaphoreGive(s_map_mutex);
 }
 
 /**
@@ -931,27 +1429,43 @@ void data_register_new_status_update_callback(new_camera_status_update_cb_t call
  * @brief Task for processing notification data
  *        处理通知数据的任务
  * 
- * This task runs in task context and processes notification data from the queue
- * 此任务在任务上下文中运行，处理来自队列的通知数据
+ * This task runs in task context and drains the notification ring through the frame reassembler.
+ * Frames that lie inside one notification are parsed in place, frames split across notifications
+ * once their last byte arrives
+ * 此任务在任务上下文中运行，经帧重组器清空通知环形缓冲区。位于单条通知内的帧在原地解析，
+ * 跨通知的帧在最后一个字节到达后解析
  * 
  * @param pvParameters Task parameters (unused)
  *                    任务参数（未使用）
  */
 static void notify_processing_task(void *pvParameters) {
-    notify_data_t notify_data;
-    
+    const uint8_t *frame;
+    size_t frame_length;
+    bool frame_pending = false;
+
     while (1) {
-        // Wait for notification data from queue
-        // 等待来自队列的通知数据
-        if (xQueueReceive(notify_queue, &notify_data, portMAX_DELAY) == pdTRUE) {
-            // Process the notification data
-            // 处理通知数据
-            process_notification_data(notify_data.data, notify_data.data_length);
-            
-            // Free the allocated data
-            // 释放分配的数据
-            free(notify_data.data);
+        // Sleep until the notify handler signals new frames, or give up on a partial frame once the link goes quiet
+        // 休眠，直到通知回调告知有新帧；若有帧尚未收全，链路空闲后放弃该帧
+        bool notified = ulTaskNotifyTake(pdTRUE, frame_pending ? pdMS_TO_TICKS(REASSEMBLY_IDLE_MS) : portMAX_DELAY) != 0;
+
+        // Apply an MTU change here rather than in the GATTC callback that reported it
+        // 在此处而非上报 MTU 的 GATTC 回调中应用 MTU 变化
+        size_t wanted_length = __atomic_exchange_n(&s_wanted_notify_length, 0, __ATOMIC_ACQUIRE);
+        if (wanted_length != 0 && wanted_length != s_notify_max_length) {
+            resize_notify_ring(wanted_length);
+        }
+
+        if (!notified && s_reassembler.length > 0) {
+            ESP_LOGW(TAG, "Giving up on a %u byte partial frame", (unsigned)s_reassembler.length);
+            protocol_reassembler_flush(&s_reassembler);
         }
+        while (notify_ring_peek(&s_notify_ring, &frame, &frame_length)) {
+            // Emits every complete frame to process_notification_data
+            // 将每个完整帧交给 process_notification_data
+            protocol_reassembler_feed(&s_reassembler, frame, frame_length);
+            notify_ring_pop(&s_notify_ring);
+        }
+        frame_pending = s_reassembler.length > 0;
     }
 }
 
@@ -959,15 +1473,18 @@ static void notify_processing_task(void *pvParameters) {
  * @brief Process notification data (moved from interrupt context to task context)
  *        处理通知数据（从中断上下文移到任务上下文）
  * 
- * This function contains the original logic from receive_camera_notify_handler
- * 此函数包含来自 receive_camera_notify_handler 的原始逻辑
+ * This function contains the original logic from receive_camera_notify_handler and is called
+ * by the reassembler with one complete frame whose CRCs have been checked
+ * 此函数包含来自 receive_camera_notify_handler 的原始逻辑，由重组器以一个已校验 CRC 的完整帧调用
  * 
- * @param raw_data Raw notification data
- *                 原始通知数据
+ * @param raw_data Raw frame data
+ *                 原始帧数据
  * @param raw_data_length Data length
  *                        数据长度
+ * @param ctx Reassembler context (unused)
+ *            重组器上下文（未使用）
  */
-static void process_notification_data(const uint8_t *raw_data, size_t raw_data_length) {
+static void process_notification_data(const uint8_t *raw_data, size_t raw_data_length, void *ctx) {
     // Validate input parameters
     // 验证输入参数
     if (!raw_data || raw_data_length < 2) {
@@ -980,46 +1497,25 @@ static void process_notification_data(const uint8_t *raw_data, size_t raw_data_l
     if (raw_data[0] == 0xAA || raw_data[0] == 0xaa) {
         ESP_LOGI(TAG, "Notification received, attempting to parse...");
 
-        // ESP_LOG_BUFFER_HEX(TAG, raw_data, raw_data_length);  // Print notification content
-                                                                // 打印通知内容
-
-        // Print notification content in pink color
-        // 用粉色打印通知内容
-        printf("\033[95m");
-        printf("RX: [");
-        for (size_t i = 0; i < raw_data_length; i++) {
-            printf("%02X", raw_data[i]);
-            if (i < raw_data_length - 1) {
-                printf(", ");
-            }
-        }
-        printf("] (%zu bytes)\n", raw_data_length);
-        printf("\033[0m");
-        printf("\033[0;32m");
-                                                             
+        frame_trace(FRAME_TRACE_RX, raw_data, raw_data_length);
+
         // Define parsing result structure
         // 定义解析结果结构体
         protocol_frame_t frame;
         memset(&frame, 0, sizeof(frame));
 
-        // Call protocol_parse_notification to parse notification frame
-        // 调用 protocol_parse_notification 解析通知帧
-        int ret = protocol_parse_notification(raw_data, raw_data_length, &frame);
-        if (ret != 0) {
-            ESP_LOGE(TAG, "Failed to parse notification frame, error: %d", ret);
-            return;
-        }
+        // The reassembler has already checked SOF, length and both CRCs, only decode the fields
+        // 重组器已校验 SOF、长度和两个 CRC，此处只需解码各字段
+        protocol_decode_frame(raw_data, raw_data_length, &frame);
 
-        // Parse data segment
-        // 解析数据段
-        void *parse_result = NULL;
+        // Parse data segment into the parse buffer, the frame itself stays in the ring or the reassembler
+        // 将数据段解析到解析缓冲区，帧本身仍留在环形缓冲区或重组器中
+        const void *parse_result = s_parse_buffer;
         size_t parse_result_length = 0;
         if (frame.data && frame.data_length > 0) {
-            // Assume protocol_parse_data returns void* type
-            // 假设 protocol_parse_data 返回 void* 类型
-            parse_result = protocol_parse_data(frame.data, frame.data_length, frame.cmd_type, &parse_result_length);
-            if (parse_result == NULL) {
-                ESP_LOGE(TAG, "Failed to parse data segment, parse_result is null");
+            if (protocol_parse_data_into(frame.data, frame.data_length, frame.cmd_type,
+                                         s_parse_buffer, sizeof(s_parse_buffer), &parse_result_length) != 0) {
+                ESP_LOGE(TAG, "Failed to parse data segment");
                 return;
             } else {
                 ESP_LOGI(TAG, "Data segment parsed successfully");
@@ -1036,83 +1532,48 @@ static void process_notification_data(const uint8_t *raw_data, size_t raw_data_l
         uint8_t actual_cmd_id = frame.data[1];
         ESP_LOGI(TAG, "Parsed seq = 0x%04X, cmd_set=0x%04X, cmd_id=0x%04X", actual_seq, actual_cmd_set, actual_cmd_id);
 
+        // Handle camera actively pushed status; the callback borrows the parse buffer for the duration of the call
+        // 相机主动推送状态处理，回调仅在调用期间借用解析缓冲区
+        if (actual_cmd_set == 0x1D && actual_cmd_id == 0x02 && status_update_callback && parse_result_length > 0) {
+            status_update_callback(parse_result);
+        }
+
+        // Handle new camera actively pushed status
+        // 新相机主动推送状态处理
+        if (actual_cmd_set == 0x1D && actual_cmd_id == 0x06 && new_status_update_callback && parse_result_length > 0) {
+            new_status_update_callback(parse_result);
+        }
+
         // Find corresponding entry
         // 查找对应的条目
         if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
             entry_t *entry = find_entry_by_seq(actual_seq);
-            if (entry) {
-                // Assume parse_result is void* object returned by protocol_parse_data
-                // 假设 parse_result 是 protocol_parse_data 返回的 void* 对象
-                if (parse_result != NULL) {
-                    // Put parsing result into corresponding entry
-                    // 将解析结果放入对应的条目
-                    entry->parse_result = parse_result;  // Store void* result in entry's value field
-                                                         // 将 void* 结果存储到条目的 value 字段
-                    entry->parse_result_length = parse_result_length; // Record result length
-                                                                      // 记录结果长度
-                    // Wake up waiting task
-                    // 唤醒等待的任务
-                    xSemaphoreGive(entry->sem);
-                } else {
-                    ESP_LOGE(TAG, "Parsing data failed, entry not updated");
-                }
-            } else {
-                // Camera actively pushed notification
-                // 相机主动推送来的
-                ESP_LOGW(TAG, "No waiting entry found for seq=0x%04X, creating a new entry by cmd_set=0x%04X cmd_id=0x%04X", actual_seq, actual_cmd_set, actual_cmd_id);
-                // Allocate a new entry
-                // 分配一个新的条目
+            if (entry == NULL) {
+                // Camera actively pushed notification, reuse the entry a waiter registered or allocate a new one
+                // 相机主动推送来的，复用等待者登记的条目或分配新条目
                 entry = allocate_entry_by_cmd(actual_cmd_set, actual_cmd_id);
                 if (entry == NULL) {
                     ESP_LOGE(TAG, "Failed to allocate entry for seq=0x%04X cmd_set=0x%04X cmd_id=0x%04X", actual_seq, actual_cmd_set, actual_cmd_id);
                 } else {
-                    // Initialize parsing result
-                    // 初始化解析结果
-                    entry->parse_result = parse_result;
-                    entry->parse_result_length = parse_result_length;
                     entry->seq = actual_seq;
-                    entry->last_access_time = xTaskGetTickCount();
-                    ESP_LOGI(TAG, "New entry allocated for seq=0x%04X", actual_seq);
-                    // Wake up any waiting tasks
-                    // 唤醒任何等待的任务
-                    xSemaphoreGive(entry->sem);
                 }
             }
-            xSemaphoreGive(s_map_mutex);
-        }
 
-        // Handle camera actively pushed status
-        // 相机主动推送状态处理
-        if (actual_cmd_set == 0x1D && actual_cmd_id == 0x02 && status_update_callback) {
-            // Create new memory copy for status update callback
-            // 为状态更新回调创建新的内存副本
-            void *status_copy = NULL;
-            if (parse_result != NULL && parse_result_length > 0) {
-                status_copy = malloc(parse_result_length);
-                if (status_copy != NULL) {
-                    memcpy(status_copy, parse_result, parse_result_length);
-                    status_update_callback(status_copy);
-                } else {
-                    ESP_LOGE(TAG, "Failed to allocate memory for status update callback");
-                }
-            }
-        }
-
-        // Handle new camera actively pushed status
-        // 新相机主动推送状态处理
-        if (actual_cmd_set == 0x1D && actual_cmd_id == 0x06 && new_status_update_callback) {
-            // Create new memory copy for new status update callback
-            // 为新状态更新回调创建新的内存副本
-            void *new_status_copy = NULL;
-            if (parse_result != NULL && parse_result_length > 0) {
-                new_status_copy = malloc(parse_result_length);
-                if (new_status_copy != NULL) {
-                    memcpy(new_status_copy, parse_result, parse_result_length);
-                    new_status_update_callback(new_status_copy);
-                } else {
-                    ESP_LOGE(TAG, "Failed to allocate memory for new status update callback");
+            // A newer frame replaces a result nobody has collected yet
+            // 新帧替换尚未被取走的旧结果
+            if (entry && store_entry_result(entry, parse_result, parse_result_length)) {
+                entry->last_access_time = xTaskGetTickCount();
+
+                // Wake up the tasks parked on this entry, if any; each one passes the token on to the next.
+                // The generation lets them reject a token that outlives this owner of the slot
+                // 唤醒阻塞在此条目上的任务（如果有），每个被唤醒的任务再把令牌传给下一个。
+                // generation 用于让等待者识别遗留给后续使用者的令牌
+                if (entry->waiters > 0) {
+                    entry->signalled_generation = entry->generation;
+                    xSemaphoreGive(entry->sem);
                 }
             }
+            xSemaphoreGive(s_map_mutex);
         }
     } else {
         // ESP_LOGW(TAG, "Received frame does not start with 0xAA, ignoring...");
@@ -1123,8 +1584,9 @@ static void process_notification_data(const uint8_t *raw_data, size_t raw_data_l
  * @brief Handle camera notifications and parse data (callback function)
  *        处理相机通知并解析数据（回调函数）
  * 
- * This function is called from BLE interrupt context and queues the data for processing
- * 此函数从 BLE 中断上下文调用，并将数据排队等待处理
+ * This function is called from the GATTC callback and copies the frame into the notification ring,
+ * which is the only copy made before the frame is parsed
+ * 此函数在 GATTC 回调中调用，将帧拷贝进通知环形缓冲区，这也是帧在解析前唯一的一次拷贝
  * 
  * @param raw_data Raw notification data
  *                 原始通知数据
@@ -1139,31 +1601,36 @@ void receive_camera_notify_handler(const uint8_t *raw_data, size_t raw_data_leng
         return;
     }
 
-    // Allocate memory for the data
-    // 为数据分配内存
-    uint8_t *data_copy = malloc(raw_data_length);
-    if (data_copy == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate memory for notification data");
+    if (!data_layer_initialized) {
+        ESP_LOGW(TAG, "Data layer not initialized, dropping notification");
         return;
     }
 
-    // Copy the data
-    // 复制数据
-    memcpy(data_copy, raw_data, raw_data_length);
+    // Announce the push before looking at the ring, so a resize either waits for it or is seen here
+    // 查看环之前先声明写入，使调整大小要么等待本次写入，要么在此处被发现
+    __atomic_store_n(&s_ring_producing, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&s_ring_resizing, __ATOMIC_SEQ_CST)) {
+        __atomic_store_n(&s_ring_producing, 0, __ATOMIC_RELEASE);
+        __atomic_fetch_add(&s_resize_drop_count, 1, __ATOMIC_RELAXED);
+        ESP_LOGE(TAG, "Notification ring being resized, dropping notification");
+        return;
+    }
 
-    // Prepare notification data structure
-    // 准备通知数据结构
-    notify_data_t notify_data = {
-        .data = data_copy,
-        .data_length = raw_data_length
-    };
+    if (raw_data_length > s_notify_max_length) {
+        __atomic_store_n(&s_ring_producing, 0, __ATOMIC_RELEASE);
+        ESP_LOGE(TAG, "Notification of %u bytes exceeds the MTU, dropping", (unsigned)raw_data_length);
+        return;
+    }
 
-    // Send to queue for processing in task context
-    // 发送到队列，在任务上下文中处理
-    if (xQueueSend(notify_queue, &notify_data, 0) != pdTRUE) {
-        ESP_LOGE(TAG, "Failed to queue notification data");
-        free(data_copy);
+    // Queue the frame for processing in task context
+    // 将帧排队，在任务上下文中处理
+    bool queued = notify_ring_push(&s_notify_ring, raw_data, raw_data_length);
+    __atomic_store_n(&s_ring_producing, 0, __ATOMIC_RELEASE);
+    if (!queued) {
+        ESP_LOGE(TAG, "Notification ring full, dropping notification");
+        return;
     }
+    xTaskNotifyGive(notify_task_handle);
 }
 
 /**
@@ -37,14 +37,30 @@ esp_err_t data_wait_for_result_by_seq(uint16_t seq, int timeout_ms, void **out_r
 
 esp_err_t data_wait_for_result_by_cmd(uint8_t cmd_set, uint8_t cmd_id, int timeout_ms, uint16_t *out_seq, void **out_result, size_t *out_result_length);
 
+/* 与上面两个函数相同，但结果存入调用者的缓冲区，不产生堆分配 */
+/* Same as the two above, but the result goes into the caller's buffer without touching the heap */
+esp_err_t data_wait_for_result_by_seq_into(uint16_t seq, int timeout_ms, void *out_result, size_t result_size,
+                                           size_t *out_result_length);
+
+esp_err_t data_wait_for_result_by_cmd_into(uint8_t cmd_set, uint8_t cmd_id, int timeout_ms, uint16_t *out_seq,
+                                           void *out_result, size_t result_size, size_t *out_result_length);
+
 esp_err_t data_send_raw_bytes(const char *raw_data_string, int timeout_ms);
 
-typedef void (*camera_status_update_cb_t)(void *data);
+void data_abort_waits(void);
+
+/* 回调仅在调用期间借用 data，需要保留时请自行拷贝 */
+/* Callbacks borrow data for the duration of the call only, copy it to keep it */
+typedef void (*camera_status_update_cb_t)(const void *data);
 void data_register_status_update_callback(camera_status_update_cb_t callback);
 
-typedef void (*new_camera_status_update_cb_t)(void *data);
+typedef void (*new_camera_status_update_cb_t)(const void *data);
 void data_register_new_status_update_callback(new_camera_status_update_cb_t callback);
 
 void receive_camera_notify_handler(const uint8_t *raw_data, size_t raw_data_length);
 
+void data_set_notify_mtu(uint16_t mtu);
+
+uint32_t data_get_notify_overflow_count(void);
+
 #endif
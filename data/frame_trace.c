@@ -0,0 +1,269 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#include "frame_trace.h"
+
+#define TAG "FRAME_TRACE"
+
+#ifdef CONFIG_FRAME_TRACE_DEFAULT_LEVEL
+#define FRAME_TRACE_DEFAULT_LEVEL CONFIG_FRAME_TRACE_DEFAULT_LEVEL
+#else
+#define FRAME_TRACE_DEFAULT_LEVEL FRAME_TRACE_OFF
+#endif
+
+/* 输出任务清空捕获环的周期 */
+/* Period at which the drain task empties the capture ring */
+#define FRAME_TRACE_DRAIN_PERIOD_MS 200
+
+#define CAPTURE_MASK (FRAME_TRACE_CAPTURE_DEPTH - 1)
+
+_Static_assert((FRAME_TRACE_CAPTURE_DEPTH & CAPTURE_MASK) == 0, "FRAME_TRACE_CAPTURE_DEPTH must be a power of two");
+_Static_assert(FRAME_TRACE_CAPTURE_BYTES <= 255, "captured length is stored in a uint8_t");
+
+/**
+ * Capture slot, published seqlock style: the writer of ticket t stores 2t+1 before filling the
+ * record and 2t+2 after, so the reader can tell a finished record from one still being written
+ * or already overwritten by a later lap.
+ * 捕获槽，按 seqlock 方式发布：持有 ticket t 的写者在填写前写入 2t+1，填写后写入 2t+2，
+ * 读者据此区分已完成的记录、仍在写入的记录以及已被下一圈覆盖的记录。
+ */
+typedef struct {
+    uint32_t seq;
+    frame_trace_record_t record;
+} capture_slot_t;
+
+uint8_t g_frame_trace_level = FRAME_TRACE_DEFAULT_LEVEL;
+
+static capture_slot_t s_slots[FRAME_TRACE_CAPTURE_DEPTH];
+static uint32_t s_head = 0;        // Next ticket, claimed by producers with fetch_add / 下一个 ticket，生产者以 fetch_add 领取
+static uint32_t s_tail = 0;        // Next ticket to read, owned by the drain side / 下一个待读 ticket，由读取方维护
+static uint32_t s_dropped = 0;     // Records overwritten before they were drained / 被读取前即被覆盖的记录数
+static TaskHandle_t s_drain_task = NULL;
+
+static const char *dir_name(uint8_t dir) {
+    return dir == FRAME_TRACE_TX ? "TX" : "RX";
+}
+
+/**
+ * @brief Copy a frame into the capture ring without taking a lock
+ *        无锁地将一帧拷贝到捕获环
+ *
+ * Any number of tasks may capture at once, each claims its own slot with an atomic ticket.
+ * When the ring is full the oldest record is overwritten and counted as dropped on drain.
+ * 任意数量的任务可同时捕获，各自以原子 ticket 领取槽位。环满时覆盖最旧的记录，并在读取时计为丢弃。
+ */
+static void capture_frame(frame_trace_dir_t dir, const uint8_t *frame, size_t length) {
+    uint32_t ticket = __atomic_fetch_add(&s_head, 1, __ATOMIC_RELAXED);
+    capture_slot_t *slot = &s_slots[ticket & CAPTURE_MASK];
+    size_t captured = length < FRAME_TRACE_CAPTURE_BYTES ? length : FRAME_TRACE_CAPTURE_BYTES;
+
+    __atomic_store_n(&slot->seq, 2 * ticket + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    slot->record.timestamp = (uint32_t)xTaskGetTickCount();
+    slot->record.length = (uint16_t)length;
+    slot->record.captured = (uint8_t)captured;
+    slot->record.dir = (uint8_t)dir;
+    memcpy(slot->record.data, frame, captured);
+
+    __atomic_store_n(&slot->seq, 2 * ticket + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Slow path of frame_trace, only reached when tracing is on
+ *        frame_trace 的慢路径，仅在跟踪开启时进入
+ *
+ * @param dir Direction of the frame
+ *            帧的方向
+ * @param frame Complete frame, starting with SOF
+ *              以 SOF 开头的完整帧
+ * @param length Frame length
+ *               帧长度
+ */
+void frame_trace_record(frame_trace_dir_t dir, const uint8_t *frame, size_t length) {
+    if (frame == NULL || length == 0) {
+        return;
+    }
+
+    uint8_t level = __atomic_load_n(&g_frame_trace_level, __ATOMIC_RELAXED);
+    if (level == FRAME_TRACE_FULL) {
+        capture_frame(dir, frame, length);
+    } else if (level == FRAME_TRACE_HEADERS) {
+        if (length >= 14) {
+            ESP_LOGI(TAG, "%s seq=0x%04X type=0x%02X cmd=0x%02X/0x%02X len=%u", dir_name(dir),
+                     (unsigned)(frame[8] | (frame[9] << 8)), frame[3], frame[12], frame[13], (unsigned)length);
+        } else {
+            ESP_LOGI(TAG, "%s len=%u", dir_name(dir), (unsigned)length);
+        }
+    }
+}
+
+/**
+ * @brief Move captured records out of the ring
+ *        从捕获环中取出记录
+ *
+ * Only one task may drain at a time. A record that a producer is still writing stops the drain
+ * and is picked up by the next call; records overwritten by a later lap are skipped and counted.
+ * 同一时间只允许一个任务读取。遇到仍在写入的记录时停止，留待下次调用；已被下一圈覆盖的记录会被跳过并计数。
+ *
+ * @param out Array that receives the records
+ *            接收记录的数组
+ * @param max_records Size of out
+ *                    out 的长度
+ * @return size_t Number of records copied
+ *                拷贝的记录条数
+ */
+size_t frame_trace_drain(frame_trace_record_t *out, size_t max_records) {
+    size_t count = 0;
+    uint32_t dropped = 0;
+
+    while (count < max_records) {
+        uint32_t head = __atomic_load_n(&s_head, __ATOMIC_ACQUIRE);
+        if (s_tail == head) {
+            break;
+        }
+
+        // Producers lapped the reader, the oldest records are gone
+        // 生产者已超过读取方一圈，最旧的记录已被覆盖
+        if (head - s_tail > FRAME_TRACE_CAPTURE_DEPTH) {
+            dropped += head - FRAME_TRACE_CAPTURE_DEPTH - s_tail;
+            s_tail = head - FRAME_TRACE_CAPTURE_DEPTH;
+        }
+
+        capture_slot_t *slot = &s_slots[s_tail & CAPTURE_MASK];
+        uint32_t expected = 2 * s_tail + 2;
+        uint32_t before = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if (before != expected) {
+            if ((int32_t)(before - expected) > 0) {
+                dropped++;
+                s_tail++;
+                continue;
+            }
+            break;
+        }
+
+        memcpy(&out[count], &slot->record, sizeof(out[count]));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint32_t after = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+        s_tail++;
+        if (after != before) {
+            // Overwritten while it was being copied
+            // 拷贝期间被覆盖
+            dropped++;
+            continue;
+        }
+        count++;
+    }
+
+    if (dropped > 0) {
+        __atomic_fetch_add(&s_dropped, dropped, __ATOMIC_RELAXED);
+    }
+    return count;
+}
+
+/**
+ * @brief Print every captured record in the RX/TX hex format
+ *        以 RX/TX 十六进制格式打印所有已捕获的记录
+ */
+void frame_trace_dump(void) {
+    static uint32_t s_reported_dropped = 0;
+    frame_trace_record_t record;
+
+    while (frame_trace_drain(&record, 1) == 1) {
+        printf(record.dir == FRAME_TRACE_TX ? "\033[96m" : "\033[95m");
+        printf("%s @%lu: [", dir_name(record.dir), (unsigned long)record.timestamp);
+        for (size_t i = 0; i < record.captured; i++) {
+            printf(i + 1 < record.captured ? "%02X, " : "%02X", record.data[i]);
+        }
+        if (record.captured < record.length) {
+            printf(", ...");
+        }
+        printf("] (%u bytes)\033[0m\n", (unsigned)record.length);
+    }
+
+    uint32_t dropped = frame_trace_dropped_count();
+    if (dropped != s_reported_dropped) {
+        ESP_LOGW(TAG, "%lu frames dropped from the capture ring", (unsigned long)(dropped - s_reported_dropped));
+        s_reported_dropped = dropped;
+    }
+}
+
+static void frame_trace_drain_task(void *arg) {
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(FRAME_TRACE_DRAIN_PERIOD_MS));
+        if (__atomic_load_n(&s_head, __ATOMIC_ACQUIRE) != s_tail) {
+            frame_trace_dump();
+        }
+    }
+}
+
+/**
+ * @brief Start the task that prints captured frames
+ *        启动打印已捕获帧的任务
+ *
+ * The task runs at the lowest priority, so printing full frames never delays RX or TX.
+ * 该任务以最低优先级运行，打印完整帧不会延迟收发。
+ *
+ * @return esp_err_t ESP_OK on success, ESP_FAIL if the task could not be created
+ *                   成功返回 ESP_OK，任务创建失败返回 ESP_FAIL
+ */
+esp_err_t frame_trace_init(void) {
+    if (s_drain_task != NULL) {
+        return ESP_OK;
+    }
+    if (xTaskCreate(frame_trace_drain_task, "frame_trace", 3072, NULL, 0, &s_drain_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create frame trace drain task");
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "Frame trace level %u", (unsigned)g_frame_trace_level);
+    return ESP_OK;
+}
+
+/**
+ * @brief Change the trace level, takes effect on the next frame
+ *        修改跟踪级别，从下一帧起生效
+ */
+void frame_trace_set_level(frame_trace_level_t level) {
+    if (level > FRAME_TRACE_FULL) {
+        level = FRAME_TRACE_FULL;
+    }
+    __atomic_store_n(&g_frame_trace_level, (uint8_t)level, __ATOMIC_RELAXED);
+}
+
+frame_trace_level_t frame_trace_get_level(void) {
+    return (frame_trace_level_t)__atomic_load_n(&g_frame_trace_level, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Records lost because the ring was full or overwritten during a drain
+ *        因环满或读取期间被覆盖而丢失的记录数
+ */
+uint32_t frame_trace_dropped_count(void) {
+    return __atomic_load_n(&s_dropped, __ATOMIC_RELAXED);
+}
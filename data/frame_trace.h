@@ -0,0 +1,104 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#ifndef __FRAME_TRACE_H__
+#define __FRAME_TRACE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+/* 每个捕获帧保留的字节数，更长的帧会被截断（记录中保留原始长度） */
+/* Bytes kept per captured frame, longer frames are truncated (the record keeps the original length) */
+#ifndef FRAME_TRACE_CAPTURE_BYTES
+#define FRAME_TRACE_CAPTURE_BYTES 96
+#endif
+
+/* 捕获环的记录条数，必须为 2 的幂 */
+/* Number of records in the capture ring, must be a power of two */
+#ifndef FRAME_TRACE_CAPTURE_DEPTH
+#define FRAME_TRACE_CAPTURE_DEPTH 32
+#endif
+
+/**
+ * @brief Frame trace level, switchable at runtime
+ *        帧跟踪级别，可在运行时切换
+ */
+typedef enum {
+    FRAME_TRACE_OFF = 0,        // Nothing is traced
+                                // 不跟踪
+    FRAME_TRACE_HEADERS = 1,    // One log line per frame with seq, type, CmdSet/CmdID and length
+                                // 每帧一行日志，包含 seq、类型、CmdSet/CmdID 和长度
+    FRAME_TRACE_FULL = 2,       // Whole frames go to the capture ring, printed later by the drain task
+                                // 完整帧写入捕获环，稍后由输出任务打印
+} frame_trace_level_t;
+
+typedef enum {
+    FRAME_TRACE_RX = 0,
+    FRAME_TRACE_TX = 1,
+} frame_trace_dir_t;
+
+/**
+ * @brief One captured frame
+ *        一条捕获的帧
+ */
+typedef struct {
+    uint32_t timestamp;         // Tick count when the frame was traced
+                                // 跟踪该帧时的 tick 计数
+    uint16_t length;            // Original frame length
+                                // 帧原始长度
+    uint8_t captured;           // Bytes stored in data, at most FRAME_TRACE_CAPTURE_BYTES
+                                // data 中保存的字节数，不超过 FRAME_TRACE_CAPTURE_BYTES
+    uint8_t dir;                // frame_trace_dir_t
+    uint8_t data[FRAME_TRACE_CAPTURE_BYTES];
+} frame_trace_record_t;
+
+/* Current level, read on every frame; change it through frame_trace_set_level */
+/* 当前级别，每帧读取一次；请通过 frame_trace_set_level 修改 */
+extern uint8_t g_frame_trace_level;
+
+void frame_trace_record(frame_trace_dir_t dir, const uint8_t *frame, size_t length);
+
+/**
+ * @brief Trace one RX or TX frame
+ *        跟踪一帧收发数据
+ *
+ * With tracing off this is a single load and branch, everything else lives in frame_trace_record.
+ * 跟踪关闭时仅为一次读取和一次分支，其余工作都在 frame_trace_record 中完成。
+ */
+static inline void frame_trace(frame_trace_dir_t dir, const uint8_t *frame, size_t length) {
+    if (__builtin_expect(__atomic_load_n(&g_frame_trace_level, __ATOMIC_RELAXED) == FRAME_TRACE_OFF, 1)) {
+        return;
+    }
+    frame_trace_record(dir, frame, length);
+}
+
+esp_err_t frame_trace_init(void);
+
+void frame_trace_set_level(frame_trace_level_t level);
+
+frame_trace_level_t frame_trace_get_level(void);
+
+size_t frame_trace_drain(frame_trace_record_t *out, size_t max_records);
+
+void frame_trace_dump(void);
+
+uint32_t frame_trace_dropped_count(void);
+
+#endif
@@ -0,0 +1,236 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+
+#include "notify_ring.h"
+
+#define TAG "NOTIFY_RING"
+
+/* 记录头：32 位长度，WRAP 标记表示剩余空间被跳过，下一条记录位于偏移 0 */
+/* Record header: 32-bit length, the WRAP marker means the rest of the ring is skipped and the next record sits at offset 0 */
+#define RECORD_HEADER_SIZE sizeof(uint32_t)
+#define RECORD_WRAP 0xFFFFFFFFu
+
+/**
+ * @brief Bytes a record of the given payload length occupies in the ring
+ *        给定负载长度的记录在环中占用的字节数
+ */
+static inline uint32_t record_size(size_t length) {
+    return (uint32_t)(RECORD_HEADER_SIZE + ((length + 3u) & ~(size_t)3u));
+}
+
+static inline uint32_t load_acquire(const uint32_t *p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void store_release(uint32_t *p, uint32_t v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Ring size that always has room for depth records of max_record_length bytes
+ *        保证总能容纳 depth 条 max_record_length 字节记录的环大小
+ *
+ * One spare record covers the space lost when a record does not fit before the end of the
+ * ring, the extra header keeps head from catching up with tail.
+ * 多留一条记录的空间，抵消记录放不下环尾时跳过的部分；额外的记录头保证 head 不会追上 tail。
+ *
+ * @param max_record_length Largest payload that will be pushed
+ *                          将写入的最大负载长度
+ * @param depth Number of such records that must fit at once
+ *              需要同时容纳的记录条数
+ * @return size_t Capacity in bytes
+ *                容量（字节）
+ */
+size_t notify_ring_capacity_for(size_t max_record_length, size_t depth) {
+    return (depth + 1) * record_size(max_record_length) + RECORD_HEADER_SIZE;
+}
+
+/**
+ * @brief Allocate the ring storage
+ *        分配环形缓冲区存储
+ *
+ * @param ring Ring to initialize
+ *             要初始化的环
+ * @param capacity Size in bytes, rounded up to a multiple of 4
+ *                 字节数，向上取整为 4 的倍数
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM if the storage could not be allocated
+ *                   成功返回 ESP_OK，存储分配失败返回 ESP_ERR_NO_MEM
+ */
+esp_err_t notify_ring_init(notify_ring_t *ring, size_t capacity) {
+    if (ring == NULL || capacity < 2 * RECORD_HEADER_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    capacity = (capacity + 3u) & ~(size_t)3u;
+
+    // Storage is word aligned, so every record header is too
+    // 存储区按字对齐，因此每个记录头同样对齐
+    uint8_t *buf = malloc(capacity);
+    if (buf == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate %u byte ring", (unsigned)capacity);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ring->buf = buf;
+    ring->capacity = (uint32_t)capacity;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->overflow_count = 0;
+    ring->high_water = 0;
+    return ESP_OK;
+}
+
+/**
+ * @brief Release the ring storage, neither side may use the ring afterwards
+ *        释放环形缓冲区存储，之后双方都不得再使用该环
+ */
+void notify_ring_deinit(notify_ring_t *ring) {
+    if (ring && ring->buf) {
+        free(ring->buf);
+        ring->buf = NULL;
+        ring->capacity = 0;
+        ring->head = 0;
+        ring->tail = 0;
+    }
+}
+
+/**
+ * @brief Copy one record into the ring (producer side)
+ *        将一条记录拷贝进环（生产者侧）
+ *
+ * The record is published only after its bytes are in place, so the consumer never sees a
+ * partial record. A full ring drops the record and bumps overflow_count instead of blocking.
+ * 记录内容写完后才发布，消费者不会看到不完整的记录。环满时丢弃该记录并累加 overflow_count，不会阻塞。
+ *
+ * @param ring Target ring
+ *             目标环
+ * @param data Record payload
+ *             记录负载
+ * @param length Payload length
+ *               负载长度
+ * @return bool true if queued, false if dropped
+ *              入队返回 true，被丢弃返回 false
+ */
+bool notify_ring_push(notify_ring_t *ring, const uint8_t *data, size_t length) {
+    uint32_t need = record_size(length);
+    uint32_t head = ring->head;
+    uint32_t tail = load_acquire(&ring->tail);
+    uint32_t offset;
+
+    // head must never land on tail, that state means empty
+    // head 不能与 tail 重合，重合表示环为空
+    if (head >= tail) {
+        uint32_t to_end = ring->capacity - head;
+        if (need < to_end || (need == to_end && tail != 0)) {
+            offset = head;
+        } else if (need < tail) {
+            offset = 0;
+        } else {
+            ring->overflow_count++;
+            return false;
+        }
+    } else if (head + need < tail) {
+        offset = head;
+    } else {
+        ring->overflow_count++;
+        return false;
+    }
+
+    if (offset != head) {
+        // Skip the tail end of the ring, at least one header always fits there
+        // 跳过环尾剩余空间，那里至少能放下一个记录头
+        *(uint32_t *)(ring->buf + head) = RECORD_WRAP;
+    }
+    *(uint32_t *)(ring->buf + offset) = (uint32_t)length;
+    memcpy(ring->buf + offset + RECORD_HEADER_SIZE, data, length);
+
+    uint32_t new_head = offset + need;
+    if (new_head == ring->capacity) {
+        new_head = 0;
+    }
+
+    uint32_t used = (new_head >= tail) ? new_head - tail : ring->capacity - tail + new_head;
+    if (used > ring->high_water) {
+        ring->high_water = used;
+    }
+
+    store_release(&ring->head, new_head);
+    return true;
+}
+
+/**
+ * @brief Oldest record, read in place (consumer side)
+ *        读取最旧的记录，不做拷贝（消费者侧）
+ *
+ * The pointer stays valid until notify_ring_pop is called.
+ * 返回的指针在调用 notify_ring_pop 之前一直有效。
+ *
+ * @param ring Source ring
+ *             源环
+ * @param data Return pointer to the record payload
+ *             返回记录负载的指针
+ * @param length Return payload length
+ *               返回负载长度
+ * @return bool true if a record is available, false if the ring is empty
+ *              有记录返回 true，环为空返回 false
+ */
+bool notify_ring_peek(notify_ring_t *ring, const uint8_t **data, size_t *length) {
+    uint32_t tail = ring->tail;
+    uint32_t head = load_acquire(&ring->head);
+    if (tail == head) {
+        return false;
+    }
+
+    uint32_t header = *(const uint32_t *)(ring->buf + tail);
+    if (header == RECORD_WRAP) {
+        // The wrap marker is published together with the record at offset 0
+        // 回绕标记与偏移 0 处的记录一同发布
+        tail = 0;
+        store_release(&ring->tail, tail);
+        header = *(const uint32_t *)(ring->buf);
+    }
+
+    *data = ring->buf + tail + RECORD_HEADER_SIZE;
+    *length = header;
+    return true;
+}
+
+/**
+ * @brief Release the record returned by the last notify_ring_peek (consumer side)
+ *        释放上一次 notify_ring_peek 返回的记录（消费者侧）
+ */
+void notify_ring_pop(notify_ring_t *ring) {
+    uint32_t tail = ring->tail;
+    uint32_t new_tail = tail + record_size(*(const uint32_t *)(ring->buf + tail));
+    if (new_tail == ring->capacity) {
+        new_tail = 0;
+    }
+    store_release(&ring->tail, new_tail);
+}
+
+/**
+ * @brief Number of records dropped because the ring was full
+ *        因环满而丢弃的记录数
+ */
+uint32_t notify_ring_overflow_count(const notify_ring_t *ring) {
+    return __atomic_load_n(&ring->overflow_count, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,68 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#ifndef __NOTIFY_RING_H__
+#define __NOTIFY_RING_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/**
+ * @brief Single-producer/single-consumer byte ring for BLE notifications
+ *        用于 BLE 通知的单生产者/单消费者字节环形缓冲区
+ *
+ * Every notification is stored once as a length-prefixed record and handed to the consumer
+ * as a pointer into the ring, so no heap traffic happens per notification. Only one task may
+ * push and only one task may peek/pop; head and tail are published with acquire/release
+ * ordering, so no lock is needed between the two.
+ * 每条通知以带长度前缀的记录形式只写入一次，并以指向环内的指针交给消费者，单条通知不产生任何堆操作。
+ * 仅允许一个任务写入、一个任务读取；head 与 tail 以 acquire/release 语义发布，两者之间无需加锁。
+ */
+typedef struct {
+    uint8_t *buf;               // Record storage, 4-byte aligned
+                                // 记录存储区，4 字节对齐
+    uint32_t capacity;          // Size of buf in bytes
+                                // buf 的字节数
+    uint32_t head;              // Write offset, owned by the producer
+                                // 写偏移，由生产者维护
+    uint32_t tail;              // Read offset, owned by the consumer
+                                // 读偏移，由消费者维护
+    uint32_t overflow_count;    // Records dropped because the ring was full
+                                // 因环满而丢弃的记录数
+    uint32_t high_water;        // Largest number of bytes ever queued
+                                // 曾经排队的最大字节数
+} notify_ring_t;
+
+size_t notify_ring_capacity_for(size_t max_record_length, size_t depth);
+
+esp_err_t notify_ring_init(notify_ring_t *ring, size_t capacity);
+
+void notify_ring_deinit(notify_ring_t *ring);
+
+bool notify_ring_push(notify_ring_t *ring, const uint8_t *data, size_t length);
+
+bool notify_ring_peek(notify_ring_t *ring, const uint8_t **data, size_t *length);
+
+void notify_ring_pop(notify_ring_t *ring);
+
+uint32_t notify_ring_overflow_count(const notify_ring_t *ring);
+
+#endif
@@ -26,6 +26,7 @@
 
 #include "ble.h"
 #include "data.h"
+#include "frame_trace.h"
 #include "enums_logic.h"
 #include "connect_logic.h"
 #include "command_logic.h"
@@ -62,9 +63,51 @@ esp_err_t command_logic_send_raw_bytes(const char *raw_data_string, int timeout_
     return data_send_raw_bytes(raw_data_string, timeout_ms);
 }
 
+/* 在途命令槽位，固定数量并循环复用 */
+/* In-flight command slots, a fixed pool that is recycled */
+struct command_pending {
+    bool in_use;
+    bool expects_response;  // Written with response, a result will be collected by seq
+                            // 有响应写入，需按 seq 收取结果
+    bool wait_result;       // CMD_WAIT_RESULT / ACK_WAIT_RESULT, a missing result is an error
+                            // CMD_WAIT_RESULT / ACK_WAIT_RESULT，未收到结果视为错误
+    uint16_t seq;
+    TickType_t deadline;    // Tick at which the wait gives up
+                            // 等待放弃时的 tick
+};
+
+static struct command_pending s_pending[COMMAND_MAX_IN_FLIGHT];
+static portMUX_TYPE s_pending_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static command_handle_t claim_pending(void) {
+    command_handle_t handle = NULL;
+    portENTER_CRITICAL(&s_pending_lock);
+    for (int i = 0; i < COMMAND_MAX_IN_FLIGHT; i++) {
+        if (!s_pending[i].in_use) {
+            s_pending[i].in_use = true;
+            handle = &s_pending[i];
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_pending_lock);
+    return handle;
+}
+
+static void release_pending(command_handle_t handle) {
+    portENTER_CRITICAL(&s_pending_lock);
+    handle->in_use = false;
+    portEXIT_CRITICAL(&s_pending_lock);
+}
+
 /**
- * @brief General function for constructing data frames and sending commands
- *        构造数据帧并发送命令的通用函数
+ * @brief Construct a data frame and send it without waiting for the response
+ *        构造数据帧并发送，不等待应答
+ *
+ * The data layer registers the seq before the frame goes out, so the response is kept even if it
+ * arrives before command_await is called. Several commands can therefore be in flight at once:
+ * submit them all, then await each handle. Every handle returned must be passed to command_await.
+ * 数据层在帧发出前即登记 seq，即使应答在调用 command_await 之前到达也会被保留。因此可以同时
+ * 有多条命令在途：先全部提交，再逐个等待。返回的每个句柄都必须交给 command_await。
  *
  * @param cmd_set Command set, used to specify command category
  *                命令集，用于指定命令的类别
@@ -76,133 +119,201 @@ esp_err_t command_logic_send_raw_bytes(const char *raw_data_string, int timeout_
  *                 数据结构体指针，包含命令帧所需的输入数据
  * @param seq Sequence number, used to match request and response
  *            序列号，用于匹配请求与响应
- * @param timeout_ms Timeout for waiting result (in milliseconds)
- *                   等待结果的超时时间（以毫秒为单位）
- * 
- * Note: The caller needs to free the dynamically allocated memory after using the returned structure.
- * 注意：调用方需要在使用完返回的结构体后释放动态分配的内存。
- * 
- * @return CommandResult Returns parsed structure pointer and data length on success, NULL pointer and length 0 on failure
- *                       成功返回解析后的结构体指针及数据长度，失败返回 NULL 指针及长度 0
+ * @param timeout_ms Timeout for the result, counted from submission (in milliseconds)
+ *                   等待结果的超时时间，从提交时开始计算（以毫秒为单位）
+ *
+ * @return command_handle_t Handle to await, NULL if the frame could not be sent or COMMAND_MAX_IN_FLIGHT commands are pending
+ *                          用于等待的句柄，帧发送失败或已有 COMMAND_MAX_IN_FLIGHT 条命令在途时返回 NULL
  */
-CommandResult send_command(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const void *input_raw_data, uint16_t seq, int timeout_ms) { 
-    CommandResult result = { NULL, 0 };
-
+command_handle_t command_submit(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const void *input_raw_data, uint16_t seq, int timeout_ms) {
     if(connect_logic_get_state() <= BLE_INIT_COMPLETE){
         ESP_LOGE(TAG, "BLE not connected");
-        return result;
+        return NULL;
     }
 
+    bool expects_response;
+    switch (cmd_type) {
+        case CMD_NO_RESPONSE:
+        case ACK_NO_RESPONSE:
+            expects_response = false;
+            break;
+        case CMD_RESPONSE_OR_NOT:
+        case ACK_RESPONSE_OR_NOT:
+        case CMD_WAIT_RESULT:
+        case ACK_WAIT_RESULT:
+            expects_response = true;
+            break;
+        default:
+            ESP_LOGE(TAG, "Invalid cmd_type: %d", cmd_type);
+            return NULL;
+    }
+
+    command_handle_t handle = claim_pending();
+    if (handle == NULL) {
+        ESP_LOGE(TAG, "Too many commands in flight, can't send seq=0x%04X", seq);
+        return NULL;
+    }
+    handle->expects_response = expects_response;
+    handle->wait_result = (cmd_type == CMD_WAIT_RESULT || cmd_type == ACK_WAIT_RESULT);
+    handle->seq = seq;
+    handle->deadline = xTaskGetTickCount() + pdMS_TO_TICKS(timeout_ms);
+
     esp_err_t ret;
 
-    // Create protocol frame
-    // 创建协议帧
+    // Build the protocol frame on the stack, the BLE stack copies it on write
+    // 在栈上构建协议帧，BLE 协议栈写入时会自行拷贝
+    uint8_t protocol_frame[COMMAND_FRAME_MAX_LENGTH];
     size_t frame_length = 0;
-    uint8_t *protocol_frame = protocol_create_frame(cmd_set, cmd_id, cmd_type, input_raw_data, seq, &frame_length);
-    if (protocol_frame == NULL) {
-        ESP_LOGE(TAG, "Failed to create protocol frame");
-        return result;
+    int frame_ret = protocol_create_frame_into(cmd_set, cmd_id, cmd_type, input_raw_data, seq,
+                                               protocol_frame, sizeof(protocol_frame), &frame_length);
+    if (frame_ret != 0) {
+        if (frame_ret == -3) {
+            ESP_LOGE(TAG, "Protocol frame of %zu bytes exceeds COMMAND_FRAME_MAX_LENGTH", frame_length);
+        } else {
+            ESP_LOGE(TAG, "Failed to create protocol frame");
+        }
+        release_pending(handle);
+        return NULL;
     }
 
     ESP_LOGI(TAG, "Protocol frame created successfully, length: %zu", frame_length);
 
-    // Print ByteArray format for debugging
-    // 打印 ByteArray 格式，便于调试
-    printf("\033[96m");  // 设置青色输出
-    printf("TX: [");
-    for (size_t i = 0; i < frame_length; i++) {
-        printf("%02X", protocol_frame[i]);
-        if (i < frame_length - 1) {
-            printf(", ");
+    frame_trace(FRAME_TRACE_TX, protocol_frame, frame_length);
+
+    if (expects_response) {
+        ret = data_write_with_response(seq, protocol_frame, frame_length);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to send data frame (with response), error: %s", esp_err_to_name(ret));
+        } else {
+            ESP_LOGI(TAG, "Data frame sent, response pending (seq=0x%04X)", seq);
+        }
+    } else {
+        ret = data_write_without_response(seq, protocol_frame, frame_length);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to send data frame (no response), error: %s", esp_err_to_name(ret));
+        } else {
+            ESP_LOGI(TAG, "Data frame sent without response.");
         }
     }
-    printf("] (%zu bytes)\n", frame_length);
-    printf("\033[0m");
-    printf("\033[0;32m");
 
-    void *structure_data = NULL;
-    size_t structure_data_length = 0;
+    if (ret != ESP_OK) {
+        release_pending(handle);
+        return NULL;
+    }
+    return handle;
+}
 
-    switch (cmd_type) {
-        case CMD_NO_RESPONSE:
-        case ACK_NO_RESPONSE:
-            ret = data_write_without_response(seq, protocol_frame, frame_length);
-            if (ret != ESP_OK) {
-                ESP_LOGE(TAG, "Failed to send data frame (no response), error: %s", esp_err_to_name(ret));
-                free(protocol_frame);
-                return result;
-            }
-            ESP_LOGI(TAG, "Data frame sent without response.");
-            break;
+/**
+ * @brief Wait for a submitted command to complete and release its handle
+ *        等待已提交的命令完成并释放其句柄
+ *
+ * The response is copied into the caller's buffer, so collecting it does not touch the heap.
+ * 应答拷贝到调用者的缓冲区中，收取应答不产生堆分配。
+ *
+ * @param handle Handle returned by command_submit, NULL yields an empty result
+ *               command_submit 返回的句柄，传入 NULL 返回空结果
+ * @param buffer Receives the parsed response; may be NULL to collect and drop it
+ *               接收解析后的应答；为 NULL 时收取后丢弃
+ *
+ * @return CommandResult Returns the parsed structure inside buffer and data length on success, NULL pointer and length 0 on failure,
+ *                       for commands without response or when buffer is NULL
+ *                       成功返回位于 buffer 中的解析结构体及数据长度，失败、无应答命令或 buffer 为 NULL 时返回 NULL 指针及长度 0
+ */
+CommandResult command_await(command_handle_t handle, command_result_buffer_t *buffer) {
+    CommandResult result = { NULL, 0 };
+    if (handle == NULL) {
+        return result;
+    }
 
-        case CMD_RESPONSE_OR_NOT:
-        case ACK_RESPONSE_OR_NOT:
-            ret = data_write_with_response(seq, protocol_frame, frame_length);
-            if (ret != ESP_OK) {
-                ESP_LOGE(TAG, "Failed to send data frame (with response), error: %s", esp_err_to_name(ret));
-                free(protocol_frame);
-                return result;
-            }
-            ESP_LOGI(TAG, "Data frame sent, waiting for response...");
-            
-            ret = data_wait_for_result_by_seq(seq, timeout_ms, &structure_data, &structure_data_length);
-            if (ret != ESP_OK) {
-                ESP_LOGW(TAG, "No result received, but continuing (seq=0x%04X)", seq);
-            }
+    if (!handle->expects_response) {
+        release_pending(handle);
+        ESP_LOGI(TAG, "Command executed successfully");
+        return result;
+    }
 
-            break;
+    // Only the time left until the deadline, the response may well be stored already
+    // 只等待距截止时刻的剩余时间，应答很可能已经存入
+    TickType_t now = xTaskGetTickCount();
+    TickType_t remaining = (TickType_t)(handle->deadline - now);
+    if ((int32_t)remaining < 0) {
+        remaining = 0;
+    }
 
-        case CMD_WAIT_RESULT:
-        case ACK_WAIT_RESULT:
-            ret = data_write_with_response(seq, protocol_frame, frame_length);
-            if (ret != ESP_OK) {
-                ESP_LOGE(TAG, "Failed to send data frame (wait result), error: %s", esp_err_to_name(ret));
-                free(protocol_frame);
-                return result;
-            }
-            ESP_LOGI(TAG, "Data frame sent, waiting for result...");
-
-            ret = data_wait_for_result_by_seq(seq, timeout_ms, &structure_data, &structure_data_length);
-            if (ret != ESP_OK) {
-                ESP_LOGE(TAG, "Failed to get parse result for seq=0x%04X, error: 0x%x", seq, ret);
-                free(protocol_frame);
-                return result;
-            }
-
-            if (structure_data == NULL) {
-                ESP_LOGE(TAG, "Parse result is NULL for seq=0x%04X", seq);
-                free(protocol_frame);
-                return result;
-            }
+    uint16_t seq = handle->seq;
+    bool wait_result = handle->wait_result;
+    release_pending(handle);
 
-            break;
+    // The response still has to be collected to release its entry, even if the caller does not want it
+    // 即使调用者不需要应答，也要收取它以释放其条目
+    command_result_buffer_t scratch;
+    command_result_buffer_t *target = buffer ? buffer : &scratch;
 
-        default:
-            ESP_LOGE(TAG, "Invalid cmd_type: %d", cmd_type);
-            free(protocol_frame);
-            return result;
+    size_t structure_data_length = 0;
+    esp_err_t ret = data_wait_for_result_by_seq_into(seq, (int)(remaining * portTICK_PERIOD_MS),
+                                                     target->data, sizeof(target->data), &structure_data_length);
+    if (ret != ESP_OK) {
+        if (wait_result) {
+            ESP_LOGE(TAG, "Failed to get parse result for seq=0x%04X, error: 0x%x", seq, ret);
+        } else {
+            ESP_LOGW(TAG, "No result received, but continuing (seq=0x%04X)", seq);
+        }
+        return result;
     }
 
-    free(protocol_frame);
     ESP_LOGI(TAG, "Command executed successfully");
 
-    result.structure = structure_data;
-    result.length = structure_data_length;
+    if (buffer != NULL) {
+        result.structure = buffer->data;
+        result.length = structure_data_length;
+    }
 
     return result;
 }
 
+/**
+ * @brief General function for constructing data frames and sending commands
+ *        构造数据帧并发送命令的通用函数
+ *
+ * Synchronous form of command_submit + command_await.
+ * command_submit + command_await 的同步形式。
+ *
+ * @param cmd_set Command set, used to specify command category
+ *                命令集，用于指定命令的类别
+ * @param cmd_id Command ID, used to identify specific command
+ *               命令 ID，用于标识具体命令
+ * @param cmd_type Command type, indicates features like response requirement
+ *                 命令类型，指示是否需要应答等特性
+ * @param structure Data structure pointer, contains input data for command frame
+ *                 数据结构体指针，包含命令帧所需的输入数据
+ * @param seq Sequence number, used to match request and response
+ *            序列号，用于匹配请求与响应
+ * @param timeout_ms Timeout for waiting result (in milliseconds)
+ *                   等待结果的超时时间（以毫秒为单位）
+ * 
+ * @param buffer Receives the parsed response, may be NULL for commands without response
+ *               接收解析后的应答，无应答命令可为 NULL
+ * 
+ * @return CommandResult Returns the parsed structure inside buffer and data length on success, NULL pointer and length 0 on failure
+ *                       成功返回位于 buffer 中的解析结构体及数据长度，失败返回 NULL 指针及长度 0
+ */
+CommandResult send_command(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const void *input_raw_data, uint16_t seq, int timeout_ms,
+                           command_result_buffer_t *buffer) {
+    return command_await(command_submit(cmd_set, cmd_id, cmd_type, input_raw_data, seq, timeout_ms), buffer);
+}
+
 /**
  * @brief Switch camera mode
  *        切换相机模式
  *
  * @param mode Camera mode
  *             相机模式
- * 
+ * @param buffer Receives the response, the returned pointer points into it
+ *               接收应答，返回的指针指向其中
+ *
  * @return camera_mode_switch_response_frame_t* Returns parsed structure pointer, NULL on error
  *                                              返回解析后的结构体指针，如果发生错误返回 NULL
  */
-camera_mode_switch_response_frame_t* command_logic_switch_camera_mode(camera_mode_t mode) {
+camera_mode_switch_response_frame_t* command_logic_switch_camera_mode(camera_mode_t mode, command_result_buffer_t *buffer) {
     ESP_LOGI(TAG, "%s: Switching camera mode to: %d", __FUNCTION__, mode);
     if (connect_logic_get_state() != PROTOCOL_CONNECTED) {
         ESP_LOGE(TAG, "Protocol connection to the camera failed. Current connection state: %d", connect_logic_get_state());
@@ -226,7 +337,8 @@ camera_mode_switch_response_frame_t* command_logic_switch_camera_mode(camera_mod
         CMD_RESPONSE_OR_NOT,
         &command_frame,
         seq,
-        5000
+        5000,
+        buffer
     );
 
     if (result.structure == NULL) {
@@ -241,20 +353,17 @@ camera_mode_switch_response_frame_t* command_logic_switch_camera_mode(camera_mod
 }
 
 /**
- * @brief Query device version
- *        查询设备版本号
+ * @brief Send the device version query without waiting for the response
+ *        发送设备版本号查询，不等待应答
  *
- * This function sends a query command to get device version information.
- * 该函数通过发送查询命令，获取设备的版本号信息。
- * 
- * The returned version information includes acknowledgment result (`ack_result`), 
- * product ID (`product_id`) and SDK version (`sdk_version`).
- * 返回的版本号信息包括应答结果 (`ack_result`)、产品 ID (`product_id`) 和 SDK 版本号 (`sdk_version`)。
+ * Lets independent commands go out while the query is in flight; collect the result with
+ * command_logic_await_version.
+ * 查询在途期间可发送其他互不依赖的命令；结果通过 command_logic_await_version 获取。
  *
- * @return version_query_response_frame_t* Returns parsed version info structure, NULL on error
- *                                         返回解析后的版本信息结构体，如果发生错误返回 NULL
+ * @return command_handle_t Handle to pass to command_logic_await_version, NULL on error
+ *                          交给 command_logic_await_version 的句柄，发生错误返回 NULL
  */
-version_query_response_frame_t* command_logic_get_version(void) {
+command_handle_t command_logic_submit_get_version(void) {
     ESP_LOGI(TAG, "%s: Querying device version", __FUNCTION__);
     
     if (connect_logic_get_state() != PROTOCOL_CONNECTED) {
@@ -264,7 +373,7 @@ version_query_response_frame_t* command_logic_get_version(void) {
 
     uint16_t seq = generate_seq();
 
-    CommandResult result = send_command(
+    return command_submit(
         0x00,
         0x00,
         CMD_WAIT_RESULT,
@@ -272,6 +381,26 @@ version_query_response_frame_t* command_logic_get_version(void) {
         seq,
         5000
     );
+}
+
+/**
+ * @brief Collect the response of command_logic_submit_get_version
+ *        获取 command_logic_submit_get_version 的应答
+ *
+ * @param handle Handle returned by command_logic_submit_get_version
+ *               command_logic_submit_get_version 返回的句柄
+ * @param buffer Receives the response, the returned pointer points into it
+ *               接收应答，返回的指针指向其中
+ *
+ * @return version_query_response_frame_t* Returns parsed version info structure, NULL on error
+ *                                         返回解析后的版本信息结构体，如果发生错误返回 NULL
+ */
+version_query_response_frame_t* command_logic_await_version(command_handle_t handle, command_result_buffer_t *buffer) {
+    if (handle == NULL) {
+        return NULL;
+    }
+
+    CommandResult result = command_await(handle, buffer);
 
     if (result.structure == NULL) {
         ESP_LOGE(TAG, "Failed to send command or receive response");
@@ -288,14 +417,38 @@ version_query_response_frame_t* command_logic_get_version(void) {
     return response;
 }
 
+/**
+ * @brief Query device version
+ *        查询设备版本号
+ *
+ * This function sends a query command to get device version information.
+ * 该函数通过发送查询命令，获取设备的版本号信息。
+ * 
+ * The returned version information includes acknowledgment result (`ack_result`), 
+ * product ID (`product_id`) and SDK version (`sdk_version`).
+ * 返回的版本号信息包括应答结果 (`ack_result`)、产品 ID (`product_id`) 和 SDK 版本号 (`sdk_version`)。
+ *
+ * @param buffer Receives the response, the returned pointer points into it
+ *               接收应答，返回的指针指向其中
+ *
+ * @return version_query_response_frame_t* Returns parsed version info structure, NULL on error
+ *                                         返回解析后的版本信息结构体，如果发生错误返回 NULL
+ */
+version_query_response_frame_t* command_logic_get_version(command_result_buffer_t *buffer) {
+    return command_logic_await_version(command_logic_submit_get_version(), buffer);
+}
+
 /**
  * @brief Start recording
  *        开始录制
  *
+ * @param buffer Receives the response, the returned pointer points into it
+ *               接收应答，返回的指针指向其中
+ *
  * @return record_control_response_frame_t* Returns parsed response structure pointer, NULL on error
  *                                          返回解析后的应答结构体指针，如果发生错误返回 NULL
  */
-record_control_response_frame_t* command_logic_start_record(void) {
+record_control_response_frame_t* command_logic_start_record(command_result_buffer_t *buffer) {
     ESP_LOGI(TAG, "%s: Starting recording", __FUNCTION__);
 
     if (connect_logic_get_state() != PROTOCOL_CONNECTED) {
@@ -317,7 +470,8 @@ record_control_response_frame_t* command_logic_start_record(void) {
         CMD_RESPONSE_OR_NOT,
         &command_frame,
         seq,
-        5000
+        5000,
+        buffer
     );
 
     if (result.structure == NULL) {
@@ -336,10 +490,13 @@ record_control_response_frame_t* command_logic_start_record(void) {
  * @brief Stop recording
  *        停止录制
  *
+ * @param buffer Receives the response, the returned pointer points into it
+ *               接收应答，返回的指针指向其中
+ *
  * @return record_control_response_frame_t* Returns parsed response structure pointer, NULL on error
  *                                          返回解析后的应答结构体指针，如果发生错误返回 NULL
  */
-record_control_response_frame_t* command_logic_stop_record(void) {
+record_control_response_frame_t* command_logic_stop_record(command_result_buffer_t *buffer) {
     ESP_LOGI(TAG, "%s: Stopping recording", __FUNCTION__);
 
     if (connect_logic_get_state() != PROTOCOL_CONNECTED) {
@@ -361,7 +518,8 @@ record_control_response_frame_t* command_logic_stop_record(void) {
         CMD_RESPONSE_OR_NOT,
         &command_frame,
         seq,
-        5000
+        5000,
+        buffer
     );
 
     if (result.structure == NULL) {
@@ -411,11 +569,12 @@ gps_data_push_response_frame* command_logic_push_gps_data(const gps_data_push_co
         CMD_NO_RESPONSE,
         gps_data,
         seq,
-        5000
+        5000,
+        NULL
     );
 
-    // Return response structure pointer
-    // 返回应答结构体指针
+    // The push has no response, so this is always NULL
+    // 推送没有应答，因此始终为 NULL
     return (gps_data_push_response_frame *)result.structure;
 }
 
@@ -423,10 +582,13 @@ gps_data_push_response_frame* command_logic_push_gps_data(const gps_data_push_co
  * @brief Quick switch mode key report
  *        快速切换模式按键上报
  *
+ * @param buffer Receives the response, the returned pointer points into it
+ *               接收应答，返回的指针指向其中
+ *
  * @return key_report_response_frame_t* Returns parsed response structure pointer, NULL on error
  *                                      返回解析后的应答结构体指针，如果发生错误返回 NULL
  */
-key_report_response_frame_t* command_logic_key_report_qs(void) {
+key_report_response_frame_t* command_logic_key_report_qs(command_result_buffer_t *buffer) {
     ESP_LOGI(TAG, "%s: Reporting key press for mode switch", __FUNCTION__);
 
     if (connect_logic_get_state() != PROTOCOL_CONNECTED) {
@@ -451,7 +613,8 @@ key_report_response_frame_t* command_logic_key_report_qs(void) {
         CMD_RESPONSE_OR_NOT,
         &command_frame,
         seq,
-        5000
+        5000,
+        buffer
     );
 
     if (result.structure == NULL) {
@@ -467,7 +630,7 @@ key_report_response_frame_t* command_logic_key_report_qs(void) {
 }
 
 
-key_report_response_frame_t* command_logic_key_report_snapshot(void) {
+key_report_response_frame_t* command_logic_key_report_snapshot(command_result_buffer_t *buffer) {
     ESP_LOGI(TAG, "%s: Reporting key press for snapshot", __FUNCTION__);
 
     if (connect_logic_get_state() != PROTOCOL_CONNECTED) {
@@ -492,7 +655,8 @@ key_report_response_frame_t* command_logic_key_report_snapshot(void) {
         CMD_RESPONSE_OR_NOT,
         &command_frame,
         seq,
-        5000
+        5000,
+        buffer
     );
     
     if (result.structure == NULL) {
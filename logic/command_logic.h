@@ -34,27 +34,65 @@
 uint16_t generate_seq(void);
 
 typedef struct {
-    void *structure;
+    void *structure;  // Points into the caller's command_result_buffer_t, NULL on failure
+                      // 指向调用者的 command_result_buffer_t，失败时为 NULL
     size_t length;  // This is not the length of structure, but the length of DATA segment excluding CmdSet and CmdID
                     // 这里的长度并不是 structure 长度，而是 DATA 段除去 CmdSet 和 CmdID 的长度
 } CommandResult;
 
+/* 应答解析结果缓冲区大小，需容纳最长的应答（版本查询应答带有变长的 SDK 版本号） */
+/* Size of a response result buffer, must fit the longest response (the version query response carries a variable-length SDK version) */
+#ifndef COMMAND_RESULT_MAX_LENGTH
+#define COMMAND_RESULT_MAX_LENGTH 64
+#endif
+
+/* 调用者提供的应答缓冲区，通常位于栈上，收取应答不产生堆分配 */
+/* Caller-provided response buffer, usually on the stack, so collecting a response never touches the heap */
+typedef struct {
+    uint8_t data[COMMAND_RESULT_MAX_LENGTH] __attribute__((aligned(4)));
+} command_result_buffer_t;
+
+/* 最多同时在途的命令数量，需明显小于数据层的 MAX_SEQ_ENTRIES */
+/* Maximum number of commands in flight at once, keep well below the data layer's MAX_SEQ_ENTRIES */
+#ifndef COMMAND_MAX_IN_FLIGHT
+#define COMMAND_MAX_IN_FLIGHT 4
+#endif
+
+/* 发送帧栈缓冲区大小，需容纳最大的命令帧（GPS 推送为 66 字节） */
+/* Size of the stack buffer outgoing frames are built in, must fit the largest command frame (GPS push is 66 bytes) */
+#ifndef COMMAND_FRAME_MAX_LENGTH
+#define COMMAND_FRAME_MAX_LENGTH 128
+#endif
+
+/* 已提交命令的句柄 */
+/* Handle of a submitted command */
+typedef struct command_pending *command_handle_t;
+
 esp_err_t command_logic_send_raw_bytes(const char *raw_data_string, int timeout_ms);
 
-CommandResult send_command(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const void *structure, uint16_t seq, int timeout_ms);
+command_handle_t command_submit(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const void *structure, uint16_t seq, int timeout_ms);
+
+CommandResult command_await(command_handle_t handle, command_result_buffer_t *buffer);
+
+CommandResult send_command(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const void *structure, uint16_t seq, int timeout_ms,
+                           command_result_buffer_t *buffer);
+
+camera_mode_switch_response_frame_t* command_logic_switch_camera_mode(camera_mode_t mode, command_result_buffer_t *buffer);
+
+command_handle_t command_logic_submit_get_version(void);
 
-camera_mode_switch_response_frame_t* command_logic_switch_camera_mode(camera_mode_t mode);
+version_query_response_frame_t* command_logic_await_version(command_handle_t handle, command_result_buffer_t *buffer);
 
-version_query_response_frame_t* command_logic_get_version(void);
+version_query_response_frame_t* command_logic_get_version(command_result_buffer_t *buffer);
 
-record_control_response_frame_t* command_logic_start_record(void);
+record_control_response_frame_t* command_logic_start_record(command_result_buffer_t *buffer);
 
-record_control_response_frame_t* command_logic_stop_record(void);
+record_control_response_frame_t* command_logic_stop_record(command_result_buffer_t *buffer);
 
 gps_data_push_response_frame* command_logic_push_gps_data(const gps_data_push_command_frame *gps_data);
 
-key_report_response_frame_t* command_logic_key_report_qs(void);
+key_report_response_frame_t* command_logic_key_report_qs(command_result_buffer_t *buffer);
 
-key_report_response_frame_t* command_logic_key_report_snapshot(void);
+key_report_response_frame_t* command_logic_key_report_snapshot(command_result_buffer_t *buffer);
 
 #endif
@@ -20,6 +20,8 @@
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
 
 #include "ble.h"
@@ -32,8 +34,95 @@
 
 #define TAG "LOGIC_CONNECT"
 
+#define CONNECT_WAIT_MS 15000
+
+/* How long a lost link is retried before giving up, and the pause before scanning again */
+/* 断链后重试多久才放弃，以及再次扫描前的间隔 */
+#ifndef CONNECT_RECONNECT_WINDOW_MS
+#define CONNECT_RECONNECT_WINDOW_MS 30000
+#endif
+#define CONNECT_RETRY_DELAY_MS 200
+
+#define CONNECT_EVENT_QUEUE_LEN 16
+
+/* Select the link profile from activity; 0 keeps the parameters the link was opened with */
+/* 根据活动选择链路配置；为 0 时沿用建链时的参数 */
+#ifndef CONNECT_LINK_PROFILES
+#define CONNECT_LINK_PROFILES 1
+#endif
+
+/* How long activity holds its link profile: the camera answers a button press well within the first,
+ * GPS pushes arrive every 100 ms while streaming */
+/* 活动保持其链路配置的时长：相机对按键的应答远在前者之内到达，推流时 GPS 数据每 100 ms 推送一次 */
+#ifndef CONNECT_KEY_HOLD_MS
+#define CONNECT_KEY_HOLD_MS 3000
+#endif
+#ifndef CONNECT_GPS_HOLD_MS
+#define CONNECT_GPS_HOLD_MS 1500
+#endif
+
 static connect_state_t connect_state = BLE_NOT_INIT;
 
+/* Told about every state change, on the task that made it */
+/* 每次状态变化时调用，运行在做出变化的任务中 */
+static connect_state_change_cb_t s_state_cb = NULL;
+
+typedef enum {
+    CONNECT_EVT_LINK = 0,          // Link event from ble.c / 来自 ble.c 的链路事件
+    CONNECT_EVT_STOP,              // Stop reconnecting, from connect_logic_ble_disconnect / 停止重连
+    CONNECT_EVT_ACTIVITY,          // Activity calls for another link profile / 活动需要另一个链路配置
+} connect_event_type_t;
+
+typedef struct {
+    connect_event_type_t type;
+    ble_link_event_t link_event;
+    int reason;
+} connect_event_t;
+
+/* Steps of a reconnect, advanced by link events on the connection manager task */
+/* 重连的各个步骤，由连接管理任务根据链路事件推进 */
+typedef enum {
+    RECONNECT_IDLE = 0,
+    RECONNECT_WAIT_RETRY,          // Waiting to scan again / 等待再次扫描
+    RECONNECT_SCANNING,            // Scanning for and connecting to the camera / 扫描并连接相机
+    RECONNECT_DISCOVERING,         // Link up, finding the handles / 链路已建立，查找句柄
+    RECONNECT_SUBSCRIBING,         // Enabling notifications / 使能通知
+} reconnect_step_t;
+
+static QueueHandle_t s_connect_queue = NULL;
+static SemaphoreHandle_t s_stop_done = NULL;
+static SemaphoreHandle_t s_link_changed = NULL;      // Given after every link event the manager handled / 连接管理任务每处理一个链路事件后给出
+
+/* Owned by the connection manager task, read by others to see whether a reconnect is running */
+/* 由连接管理任务独占写入，其他任务读取以判断重连是否在进行 */
+static volatile reconnect_step_t s_reconnect_step = RECONNECT_IDLE;
+static TickType_t s_reconnect_start;
+static TickType_t s_retry_at;
+
+/* Bumped on every link loss, lets a protocol handshake tell whether its link is still the current one.
+ * s_state_lock makes the bump and the handshake's final check-and-set of connect_state atomic */
+/* 每次断链时递增，供协议握手判断其所在的链路是否仍是当前链路。
+ * s_state_lock 保证递增与握手最后的检查并设置 connect_state 互不穿插 */
+static volatile uint32_t s_link_generation = 0;
+static portMUX_TYPE s_state_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Last activity of each kind and the link profile the connection manager selected from them */
+/* 各类活动的最近时间，以及连接管理任务据此选择的链路配置 */
+static portMUX_TYPE s_activity_lock = portMUX_INITIALIZER_UNLOCKED;
+static TickType_t s_activity_tick[LINK_ACTIVITY_COUNT];
+static bool s_activity_seen[LINK_ACTIVITY_COUNT];
+static bool s_activity_queued = false;
+static ble_link_profile_t s_link_profile = BLE_LINK_PROFILE_COUNT;
+static bool s_link_ready = false;    // Owned by the connection manager task / 由连接管理任务独占
+
+static const struct {
+    ble_link_profile_t profile;
+    uint32_t hold_ms;
+} s_activity_profiles[LINK_ACTIVITY_COUNT] = {
+    [LINK_ACTIVITY_KEY] = { BLE_LINK_PROFILE_INTERACTIVE, CONNECT_KEY_HOLD_MS },
+    [LINK_ACTIVITY_GPS] = { BLE_LINK_PROFILE_STREAMING, CONNECT_GPS_HOLD_MS },
+};
+
 /**
  * @brief Get current connection state
  *        获取当前连接状态
@@ -46,61 +135,356 @@ connect_state_t connect_logic_get_state(void) {
 }
 
 /**
- * @brief Handle camera disconnection (callback function)
- *        处理相机断开连接（回调函数）
- * 
- * Perform operations according to current connection state and reset connection state to BLE initialization complete (BLE_INIT_COMPLETE).
- * 根据当前连接状态进行相应的操作，并将连接状态重置为 BLE 初始化完成（BLE_INIT_COMPLETE）。
+ * @brief Register a callback for connection state changes
+ *        注册连接状态变化回调
+ *
+ * The callback runs on whichever task changed the state, the connection manager included, so it
+ * must not block.
+ * 回调运行在改变状态的任务中（包括连接管理任务），因此不得阻塞。
+ *
+ * @param cb Callback, NULL to remove it
+ *           回调函数，为 NULL 时移除
+ */
+void connect_logic_set_state_callback(connect_state_change_cb_t cb) {
+    s_state_cb = cb;
+}
+
+/* Tell the state callback about connect_state; never called with s_state_lock held */
+/* 将 connect_state 告知状态回调；从不在持有 s_state_lock 时调用 */
+static void report_state(void) {
+    const connect_state_change_cb_t cb = s_state_cb;
+    if (cb != NULL) {
+        cb(connect_state);
+    }
+}
+
+static void set_state(connect_state_t state) {
+    connect_state = state;
+    report_state();
+}
+
+/**
+ * @brief Hand a link event over to the connection manager task (callback function)
+ *        将链路事件转交给连接管理任务（回调函数）
+ *
+ * Runs on the Bluedroid task, so it only queues the event and never blocks.
+ * 运行在 Bluedroid 任务中，因此只将事件入队，从不阻塞。
+ */
+static void receive_camera_link_event_handler(ble_link_event_t event, int reason) {
+    const connect_event_t connect_event = {
+        .type = CONNECT_EVT_LINK,
+        .link_event = event,
+        .reason = reason,
+    };
+    if (s_connect_queue == NULL || xQueueSend(s_connect_queue, &connect_event, 0) != pdTRUE) {
+        ESP_LOGE(TAG, "Connection event queue full, dropping link event %d", event);
+    }
+}
+
+static TickType_t ticks_until(TickType_t when) {
+    const TickType_t left = when - xTaskGetTickCount();
+    return (int32_t)left > 0 ? left : 0;
+}
+
+/* Profile of the most urgent activity still within its hold, idle without any; called with s_activity_lock held */
+/* 仍在保持时间内的最紧急活动所对应的配置，没有则为空闲；调用时持有 s_activity_lock */
+static ble_link_profile_t choose_link_profile_locked(TickType_t now, TickType_t *until) {
+    for (int i = 0; i < LINK_ACTIVITY_COUNT; i++) {
+        const TickType_t end = s_activity_tick[i] + pdMS_TO_TICKS(s_activity_profiles[i].hold_ms);
+        if (s_activity_seen[i] && (int32_t)(end - now) > 0) {
+            *until = end;
+            return s_activity_profiles[i].profile;
+        }
+    }
+    return BLE_LINK_PROFILE_IDLE;
+}
+
+/**
+ * @brief Select the link profile for the current activity, on the connection manager task
+ *        在连接管理任务中为当前活动选择链路配置
+ *
+ * @return TickType_t Ticks until the selection has to be made again, portMAX_DELAY when idle
+ *                    距下次需要重新选择的节拍数，空闲时为 portMAX_DELAY
  */
-void receive_camera_disconnect_handler() {
-    switch (connect_state) {
+static TickType_t update_link_profile(void) {
+    const TickType_t now = xTaskGetTickCount();
+    TickType_t until = now;
+    portENTER_CRITICAL(&s_activity_lock);
+    s_activity_queued = false;
+    if (!CONNECT_LINK_PROFILES || !s_link_ready) {
+        portEXIT_CRITICAL(&s_activity_lock);
+        return portMAX_DELAY;
+    }
+    const ble_link_profile_t profile = choose_link_profile_locked(now, &until);
+    const bool changed = profile != s_link_profile;
+    s_link_profile = profile;
+    portEXIT_CRITICAL(&s_activity_lock);
+
+    if (changed) {
+        ble_set_link_profile(profile);
+    }
+    return profile == BLE_LINK_PROFILE_IDLE ? portMAX_DELAY : ticks_until(until);
+}
+
+/* A new link starts with the parameters it was opened with; its setup and handshake count as interactive */
+/* 新链路以建链时的参数开始；其建立与握手按交互处理 */
+static void restart_link_profile(bool ready) {
+    s_link_ready = ready;
+    portENTER_CRITICAL(&s_activity_lock);
+    if (ready) {
+        s_activity_tick[LINK_ACTIVITY_KEY] = xTaskGetTickCount();
+        s_activity_seen[LINK_ACTIVITY_KEY] = true;
+    }
+    s_link_profile = BLE_LINK_PROFILE_COUNT;
+    portEXIT_CRITICAL(&s_activity_lock);
+}
+
+static void schedule_reconnect_retry(void) {
+    s_retry_at = xTaskGetTickCount() + pdMS_TO_TICKS(CONNECT_RETRY_DELAY_MS);
+    s_reconnect_step = RECONNECT_WAIT_RETRY;
+}
+
+static void start_reconnect_attempt(void) {
+    ESP_LOGI(TAG, "Reconnection attempt...");
+    s_reconnect_step = RECONNECT_SCANNING;
+    ble_set_reconnecting(true);
+    if (ble_start_scanning_and_connect() != ESP_OK) {
+        schedule_reconnect_retry();
+    }
+}
+
+static void give_up_reconnect(void) {
+    ESP_LOGE(TAG, "Reconnection failed after %d ms", CONNECT_RECONNECT_WINDOW_MS);
+    if (s_reconnect_step == RECONNECT_SCANNING) {
+        ble_stop_scanning();
+    }
+    s_reconnect_step = RECONNECT_IDLE;
+    set_state(BLE_INIT_COMPLETE);
+    camera_status_initialized = false;
+    ble_disconnect();
+    ESP_LOGI(TAG, "Current state: DISCONNECTED.");
+}
+
+/**
+ * @brief Handle camera disconnection
+ *        处理相机断开连接
+ *
+ * Perform operations according to current connection state: a normal disconnection returns to BLE
+ * initialization complete (BLE_INIT_COMPLETE), an unexpected one starts a reconnect.
+ * 根据当前连接状态进行相应的操作：正常断开回到 BLE 初始化完成（BLE_INIT_COMPLETE），意外断开则开始重连。
+ */
+static void handle_link_lost(int reason) {
+    // A handshake either sees the new generation or has already set PROTOCOL_CONNECTED, which is handled below.
+    // The state leaves BLE_CONNECTED / PROTOCOL_CONNECTED together with the bump, so nobody woken below
+    // still sees the lost link as connected
+    // 握手要么看到新的代数，要么已设置 PROTOCOL_CONNECTED，后者由下面的分支处理。
+    // 状态与代数递增同时离开 BLE_CONNECTED / PROTOCOL_CONNECTED，因此下面被唤醒的任务不会再把已断开的链路视为已连接
+    portENTER_CRITICAL(&s_state_lock);
+    s_link_generation++;
+    const connect_state_t state = connect_state;
+    if (state == BLE_DISCONNECTING) {
+        connect_state = BLE_INIT_COMPLETE;
+    } else if (state != BLE_SEARCHING && state != BLE_INIT_COMPLETE) {
+        connect_state = BLE_SEARCHING;
+    }
+    const bool changed = connect_state != state;
+    portEXIT_CRITICAL(&s_state_lock);
+    if (changed) {
+        report_state();
+    }
+
+    // Whoever waits for the camera's answer on this link would only run into its timeout
+    // 在此链路上等待相机应答的任务只会等到超时，直接唤醒
+    data_abort_waits();
+
+    switch (state) {
         case BLE_SEARCHING:
+            // Link lost in the middle of a reconnect, e.g. during service discovery: try again.
+            // Without a reconnect running, connect_logic_ble_connect handles its own failure
+            // 重连过程中断链（例如服务发现期间）：再试一次。没有进行中的重连时，由 connect_logic_ble_connect 自行处理失败
+            if (s_reconnect_step != RECONNECT_IDLE) {
+                ESP_LOGW(TAG, "Link lost during reconnection, reason=0x%x, retrying", reason);
+                schedule_reconnect_retry();
+            }
             break;
         case BLE_INIT_COMPLETE:
             ESP_LOGI(TAG, "Already in DISCONNECTED state.");
             break;
         case BLE_DISCONNECTING: {
             ESP_LOGI(TAG, "Normal disconnection process.");
-            // Normal disconnection also needs to reset state
-            // 正常断开也需要重置状态
-            connect_state = BLE_INIT_COMPLETE;
+            // Normal disconnection also needs to reset state, connect_state was reset above
+            // 正常断开也需要重置状态，connect_state 已在上面重置
             camera_status_initialized = false;
+            s_reconnect_step = RECONNECT_IDLE;
             ESP_LOGI(TAG, "Current state: DISCONNECTED.");
             break;
         }
         case BLE_CONNECTED:
         case PROTOCOL_CONNECTED:
         default: {
-            ESP_LOGW(TAG, "Unexpected disconnection from state: %d, attempting reconnection...", connect_state);
-            
-            // Try to reconnect once
-            // 尝试重连一次
-            bool reconnected = false;
-            ESP_LOGI(TAG, "Reconnection attempt...");
-            if (connect_logic_ble_connect(true) == ESP_OK) {
-                // Wait for reconnection result
-                // 等待重连结果
-                for (int j = 0; j < 300; j++) { // Wait for 30 seconds
-                                                // 等待 30 秒
-                    if (s_ble_profile.connection_status.is_connected) {
-                        ESP_LOGI(TAG, "Reconnection successful");
-                        reconnected = true;
-                        return;  // 重连成功，直接返回
-                    }
-                    vTaskDelay(pdMS_TO_TICKS(100));
-                }
-            }
+            ESP_LOGW(TAG, "Unexpected disconnection from state: %d, reason=0x%x, attempting reconnection...",
+                     state, reason);
+            camera_status_initialized = false;
+            s_reconnect_start = xTaskGetTickCount();
+            start_reconnect_attempt();
+            break;
+        }
+    }
+}
 
-            if (!reconnected) {
-                ESP_LOGE(TAG, "Reconnection failed after 1 attempts");
-                // Reconnection failed, execute disconnection logic
-                // 重连失败，执行断开逻辑
-                connect_state = BLE_INIT_COMPLETE;
-                camera_status_initialized = false;
+static void handle_link_event(ble_link_event_t event, int reason) {
+    switch (event) {
+        case BLE_LINK_EVT_DISCONNECTED:
+            restart_link_profile(false);
+            handle_link_lost(reason);
+            break;
+        case BLE_LINK_EVT_SCAN_DONE:
+        case BLE_LINK_EVT_OPEN_FAILED:
+            if (s_reconnect_step == RECONNECT_SCANNING) {
+                ESP_LOGW(TAG, "Camera not reached (event %d), scanning again", event);
+                schedule_reconnect_retry();
+            }
+            break;
+        case BLE_LINK_EVT_CONNECTED:
+            if (s_reconnect_step == RECONNECT_SCANNING) {
+                s_reconnect_step = RECONNECT_DISCOVERING;
+            } else if (s_reconnect_step == RECONNECT_IDLE && connect_state == BLE_INIT_COMPLETE) {
+                // The scan of a reconnect that was given up or stopped found the camera after all
+                // 已放弃或已停止的重连所发起的扫描最终找到了相机
+                ESP_LOGW(TAG, "Closing a link nobody is waiting for");
                 ble_disconnect();
-                ESP_LOGI(TAG, "Current state: DISCONNECTED.");
             }
             break;
+        case BLE_LINK_EVT_HANDLES_FOUND:
+            if (s_reconnect_step == RECONNECT_DISCOVERING) {
+                // Register notification; if that fails, drop the link and let the retry take over
+                // 注册通知；失败则断开链路，交由重试处理
+                if (ble_register_notify(s_ble_profile.conn_id, s_ble_profile.notify_char_handle) == ESP_OK) {
+                    s_reconnect_step = RECONNECT_SUBSCRIBING;
+                } else {
+                    ble_disconnect();
+                }
+            }
+            break;
+        case BLE_LINK_EVT_READY:
+            restart_link_profile(true);
+            // A disconnection requested meanwhile keeps its state
+            // 期间请求的断开保持其状态
+            if (s_reconnect_step == RECONNECT_SUBSCRIBING) {
+                s_reconnect_step = RECONNECT_IDLE;
+                if (connect_state == BLE_SEARCHING) {
+                    set_state(BLE_CONNECTED);
+                    ESP_LOGI(TAG, "Reconnection successful after %u ms",
+                             (unsigned)((xTaskGetTickCount() - s_reconnect_start) * portTICK_PERIOD_MS));
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/* Stop a running reconnect on behalf of connect_logic_ble_disconnect */
+/* 代表 connect_logic_ble_disconnect 停止进行中的重连 */
+static void stop_reconnect(void) {
+    if (s_reconnect_step != RECONNECT_IDLE) {
+        ESP_LOGI(TAG, "Reconnection stopped");
+        if (s_reconnect_step == RECONNECT_SCANNING) {
+            ble_stop_scanning();
+        }
+        s_reconnect_step = RECONNECT_IDLE;
+    }
+    // Without a link no disconnection event will come to finish the disconnection, whether a reconnect ran or not
+    // 没有链路时不会有断开事件来完成断开流程
+    if (!s_ble_profile.connection_status.is_connected && connect_state == BLE_DISCONNECTING) {
+        set_state(BLE_INIT_COMPLETE);
+        camera_status_initialized = false;
+    }
+}
+
+/**
+ * @brief Record activity on the link, called from the key and GPS tasks
+ *        记录链路上的活动，由按键与 GPS 任务调用
+ *
+ * Only wakes the connection manager when the activity calls for another link profile, so a GPS push
+ * costs a timestamp while streaming.
+ * 仅当活动需要另一个链路配置时才唤醒连接管理任务，因此推流时每次 GPS 推送只需记录时间戳。
+ *
+ * @param activity Kind of activity
+ *                 活动类型
+ */
+void connect_logic_note_activity(link_activity_t activity) {
+    if (activity >= LINK_ACTIVITY_COUNT) {
+        return;
+    }
+    const TickType_t now = xTaskGetTickCount();
+    TickType_t until;
+    portENTER_CRITICAL(&s_activity_lock);
+    s_activity_tick[activity] = now;
+    s_activity_seen[activity] = true;
+    const bool wake = !s_activity_queued && choose_link_profile_locked(now, &until) != s_link_profile;
+    if (wake) {
+        s_activity_queued = true;
+    }
+    portEXIT_CRITICAL(&s_activity_lock);
+
+    if (wake && s_connect_queue != NULL) {
+        const connect_event_t event = { .type = CONNECT_EVT_ACTIVITY };
+        if (xQueueSend(s_connect_queue, &event, 0) != pdTRUE) {
+            portENTER_CRITICAL(&s_activity_lock);
+            s_activity_queued = false;
+            portEXIT_CRITICAL(&s_activity_lock);
+        }
+    }
+}
+
+/**
+ * @brief Connection manager task
+ *        连接管理任务
+ *
+ * Owns the reaction to link events: it turns an unexpected disconnection into a reconnect and
+ * drives it step by step from the events ble.c reports, so neither the Bluedroid task nor this
+ * task ever waits on the link. A reconnect gives up after CONNECT_RECONNECT_WINDOW_MS.
+ * It also selects the link profile from the recorded activity.
+ * 负责响应链路事件：将意外断开转为重连，并根据 ble.c 上报的事件逐步推进，因此 Bluedroid 任务和本任务都不会等待链路。
+ * 重连在 CONNECT_RECONNECT_WINDOW_MS 后放弃。它还根据记录的活动选择链路配置。
+ */
+static void connect_manager_task(void *arg) {
+    connect_event_t event;
+    while (1) {
+        TickType_t wait = update_link_profile();
+        if (s_reconnect_step != RECONNECT_IDLE) {
+            const TickType_t deadline = s_reconnect_start + pdMS_TO_TICKS(CONNECT_RECONNECT_WINDOW_MS);
+            if (ticks_until(deadline) < wait) {
+                wait = ticks_until(deadline);
+            }
+            if (s_reconnect_step == RECONNECT_WAIT_RETRY && ticks_until(s_retry_at) < wait) {
+                wait = ticks_until(s_retry_at);
+            }
+        }
+
+        if (xQueueReceive(s_connect_queue, &event, wait) == pdTRUE) {
+            if (event.type == CONNECT_EVT_STOP) {
+                stop_reconnect();
+                xSemaphoreGive(s_stop_done);
+            } else if (event.type == CONNECT_EVT_LINK) {
+                handle_link_event(event.link_event, event.reason);
+                xSemaphoreGive(s_link_changed);
+            }
+            continue;
+        }
+
+        // Timed out: either the reconnect window is over, it is time to scan again or a profile hold ran out,
+        // which the next round handles
+        // 等待超时：要么重连窗口已结束，要么到了再次扫描的时间，要么配置保持时间已到（由下一轮处理）
+        if (s_reconnect_step == RECONNECT_IDLE) {
+            continue;
+        }
+        if (ticks_until(s_reconnect_start + pdMS_TO_TICKS(CONNECT_RECONNECT_WINDOW_MS)) == 0) {
+            give_up_reconnect();
+            xSemaphoreGive(s_link_changed);
+        } else if (s_reconnect_step == RECONNECT_WAIT_RETRY && ticks_until(s_retry_at) == 0) {
+            start_reconnect_attempt();
         }
     }
 }
@@ -126,11 +510,52 @@ int connect_logic_ble_init() {
         return -1;
     }
 
-    connect_state = BLE_INIT_COMPLETE;
+    /* 2. Start the connection manager, which takes the link events off the Bluedroid task
+     * 2. 启动连接管理任务，由其在 Bluedroid 任务之外处理链路事件 */
+    s_connect_queue = xQueueCreate(CONNECT_EVENT_QUEUE_LEN, sizeof(connect_event_t));
+    s_stop_done = xSemaphoreCreateBinary();
+    s_link_changed = xSemaphoreCreateBinary();
+    if (s_connect_queue == NULL || s_stop_done == NULL || s_link_changed == NULL ||
+        xTaskCreate(connect_manager_task, "connect_manager", 3072, NULL, 3, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start connection manager");
+        return -1;
+    }
+    ble_set_state_callback(receive_camera_link_event_handler);
+
+    set_state(BLE_INIT_COMPLETE);
     ESP_LOGI(TAG, "BLE init successfully");
     return 0;
 }
 
+/* Predicates connect_logic_ble_connect waits for */
+/* connect_logic_ble_connect 等待的条件 */
+static bool reconnect_finished(void) {
+    return s_reconnect_step == RECONNECT_IDLE;
+}
+
+static bool link_connected(void) {
+    return s_ble_profile.connection_status.is_connected;
+}
+
+static bool handles_found(void) {
+    return s_ble_profile.handle_discovery.notify_char_handle_found &&
+           s_ble_profile.handle_discovery.write_char_handle_found;
+}
+
+/* Block until done() holds, woken by the connection manager after each link event; false on timeout */
+/* 阻塞直到 done() 成立，连接管理任务每处理一个链路事件后唤醒；超时返回 false */
+static bool wait_for_link(bool (*done)(void), uint32_t timeout_ms) {
+    const TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(timeout_ms);
+    while (!done()) {
+        const TickType_t left = ticks_until(deadline);
+        if (left == 0) {
+            return false;
+        }
+        xSemaphoreTake(s_link_changed, left);
+    }
+    return true;
+}
+
 /**
  * @brief Connect to BLE device
  *        连接到 BLE 设备
@@ -145,14 +570,25 @@ int connect_logic_ble_init() {
  *             成功返回 0，失败返回 -1
  */
 int connect_logic_ble_connect(bool is_reconnecting) {
-    connect_state = BLE_SEARCHING;
+    /* A reconnect of the connection manager is already after the camera, wait for its outcome */
+    /* 连接管理任务的重连已在寻找相机，等待其结果 */
+    if (s_reconnect_step != RECONNECT_IDLE) {
+        ESP_LOGI(TAG, "Reconnection in progress, waiting for it...");
+        (void)wait_for_link(reconnect_finished, CONNECT_RECONNECT_WINDOW_MS);
+        if (connect_state == BLE_CONNECTED) {
+            return 0;
+        }
+    }
+
+    set_state(BLE_SEARCHING);
 
     esp_err_t ret;
 
     /* 1. Set a global Notify callback for receiving remote data and protocol parsing */
     /* 设置一个全局 Notify 回调，用于接收远端数据并进行协议解析 */
     ble_set_notify_callback(receive_camera_notify_handler);
-    ble_set_state_callback(receive_camera_disconnect_handler);
+    ble_set_state_callback(receive_camera_link_event_handler);
+    ble_set_mtu_callback(data_set_notify_mtu);
 
     /* 2. Start scanning and attempt connection */
     /* 开始扫描并尝试连接 */
@@ -160,45 +596,30 @@ int connect_logic_ble_connect(bool is_reconnecting) {
     ret = ble_start_scanning_and_connect();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to start scanning and connect, error: 0x%x", ret);
-        connect_state = BLE_INIT_COMPLETE;
+        set_state(BLE_INIT_COMPLETE);
         return -1;
     }
 
     /* 3. Wait up to 30 seconds to ensure BLE connection success */
     /* 等待最多 30 秒以确保 BLE 连接成功 */
     ESP_LOGI(TAG, "Waiting up to 15s for BLE to connect...");
-    bool connected = false;
-    for (int i = 0; i < 150; i++) { // 150 * 100ms = 15s
-        if (s_ble_profile.connection_status.is_connected) {
-            ESP_LOGI(TAG, "BLE connected successfully");
-            connected = true;
-            break;
-        }
-        vTaskDelay(pdMS_TO_TICKS(100));
-    }
-    if (!connected) {
+    if (wait_for_link(link_connected, CONNECT_WAIT_MS)) {
+        ESP_LOGI(TAG, "BLE connected successfully");
+    } else {
         ESP_LOGW(TAG, "BLE connection timed out");
-        connect_state = BLE_INIT_COMPLETE;
+        set_state(BLE_INIT_COMPLETE);
         return -1;
     }
 
     /* 4. Wait for characteristic handle discovery completion (up to 30 seconds) */
     /* 等待特征句柄查找完成（最多等待30秒） */
     ESP_LOGI(TAG, "Waiting up to 15s for characteristic handles discovery...");
-    bool handles_found = false;
-    for (int i = 0; i < 150; i++) { // 150 * 100ms = 15s
-        if (s_ble_profile.handle_discovery.notify_char_handle_found && 
-            s_ble_profile.handle_discovery.write_char_handle_found) {
-            ESP_LOGI(TAG, "Required characteristic handles found");
-            handles_found = true;
-            break;
-        }
-        vTaskDelay(pdMS_TO_TICKS(100));
-    }
-    if (!handles_found) {
+    if (wait_for_link(handles_found, CONNECT_WAIT_MS)) {
+        ESP_LOGI(TAG, "Required characteristic handles found");
+    } else {
         ESP_LOGW(TAG, "Characteristic handles not found within timeout");
         ble_disconnect();
-        connect_state = BLE_INIT_COMPLETE;
+        set_state(BLE_INIT_COMPLETE);
         return -1;
     }
 
@@ -208,13 +629,13 @@ int connect_logic_ble_connect(bool is_reconnecting) {
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to register notify, error: %s", esp_err_to_name(ret));
         ble_disconnect();
-        connect_state = BLE_INIT_COMPLETE;
+        set_state(BLE_INIT_COMPLETE);
         return -1;
     }
 
     // Update state to BLE connected
     // 更新状态为 BLE 已连接
-    connect_state = BLE_CONNECTED;
+    set_state(BLE_CONNECTED);
 
     // 延迟展示氛围灯
     ESP_LOGI(TAG, "BLE connect successfully");
@@ -233,16 +654,27 @@ int connect_logic_ble_connect(bool is_reconnecting) {
  */
 int connect_logic_ble_disconnect(void) {
     connect_state_t old_state = connect_state;
-    connect_state = BLE_DISCONNECTING;
+    set_state(BLE_DISCONNECTING);
     
     ESP_LOGI(TAG, "Disconnecting camera...");
 
+    // Stop a running reconnect first, so it does not bring the link back up. The connection manager also
+    // finishes the disconnection when there is no link left to close
+    // 先停止进行中的重连，避免其重新建立链路。没有可关闭的链路时，连接管理任务也会直接完成断开
+    if (s_connect_queue != NULL) {
+        const connect_event_t stop = { .type = CONNECT_EVT_STOP };
+        xSemaphoreTake(s_stop_done, 0);
+        if (xQueueSend(s_connect_queue, &stop, pdMS_TO_TICKS(100)) == pdTRUE) {
+            xSemaphoreTake(s_stop_done, pdMS_TO_TICKS(1000));
+        }
+    }
+
     // Call BLE layer's ble_disconnect function
     // 调用 BLE 层的 ble_disconnect 函数
     esp_err_t ret = ble_disconnect();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to disconnect camera, BLE error: %s", esp_err_to_name(ret));
-        connect_state = old_state;
+        set_state(old_state);
         return -1;
     }
 
@@ -250,6 +682,18 @@ int connect_logic_ble_disconnect(void) {
     return 0;
 }
 
+/* Give up a protocol handshake; the link is only closed if it is still the one the handshake started on */
+/* 放弃协议握手；仅当链路仍是握手开始时的链路才将其关闭 */
+static void abandon_protocol_connect(uint32_t link_generation) {
+    if (link_generation != s_link_generation || !s_ble_profile.connection_status.is_connected) {
+        // The connection manager is already reconnecting, or will be once it sees the loss; leave the link to it
+        // 连接管理任务已在重连，或在发现断链后即将重连；链路交由其处理
+        ESP_LOGW(TAG, "Link lost during protocol handshake");
+        return;
+    }
+    connect_logic_ble_disconnect();
+}
+
 /**
  * @brief Protocol connection function
  *        协议连接函数
@@ -288,6 +732,17 @@ int connect_logic_protocol_connect(uint32_t device_id, uint8_t mac_addr_len, con
                                    uint32_t fw_version, uint8_t verify_mode, uint16_t verify_data,
                                    uint8_t camera_reserved) {
     ESP_LOGI(TAG, "%s: Starting protocol connection", __FUNCTION__);
+
+    // Take the link generation together with the state, a link already lost is not handshaken on
+    // 与状态一起读取链路代数，不在已断开的链路上握手
+    portENTER_CRITICAL(&s_state_lock);
+    const uint32_t link_generation = s_link_generation;
+    const connect_state_t start_state = connect_state;
+    portEXIT_CRITICAL(&s_state_lock);
+    if (start_state != BLE_CONNECTED && start_state != PROTOCOL_CONNECTED) {
+        ESP_LOGE(TAG, "No BLE link for the protocol handshake, state %d", start_state);
+        return -1;
+    }
     uint16_t seq = generate_seq();
 
     // Construct connection request command frame
@@ -304,8 +759,17 @@ int connect_logic_protocol_connect(uint32_t device_id, uint8_t mac_addr_len, con
 
     // STEP1: Send connection request command to camera
     // 相机发送连接请求命令
+    // The response and the camera's own command are collected into these stack buffers, not the heap
+    // 应答与相机自身的命令均收取到这些栈缓冲区中，而非堆
+    command_result_buffer_t response_buffer;
+    command_result_buffer_t camera_command;
+    const connection_request_command_frame *camera_request = (const connection_request_command_frame *)camera_command.data;
+    size_t camera_command_length = 0;
+    uint16_t received_seq = 0;
+    esp_err_t ret;
+
     ESP_LOGI(TAG, "Sending connection request to camera...");
-    CommandResult result = send_command(0x00, 0x19, CMD_WAIT_RESULT, &connection_request, seq, 1000);
+    CommandResult result = send_command(0x00, 0x19, CMD_WAIT_RESULT, &connection_request, seq, 1000, &response_buffer);
 
     /**** Connection issue: camera may return either response frame or command frame ****/
     /****************** 连接问题，这里相机可能返回 应答帧 也可能返回 命令帧 ******************/
@@ -314,26 +778,31 @@ int connect_logic_protocol_connect(uint32_t device_id, uint8_t mac_addr_len, con
         // If a command frame is sent, execute this block of code
         // 如果发命令帧，走这里的代码
 
-        // Directly call data_wait_for_result_by_cmd(0x00, 0x19, 30000, &received_seq, &parse_result, &parse_result_length);
-        // 这里直接去 esp_err_t ret = data_wait_for_result_by_cmd(0x00, 0x19, 30000, &received_seq, &parse_result, &parse_result_length);
+        // Directly call data_wait_for_result_by_cmd_into(0x00, 0x19, ...) for the camera's command frame
+        // 这里直接调用 data_wait_for_result_by_cmd_into(0x00, 0x19, ...) 等待相机的命令帧
         
         // If != OK, it means no message was received, timeout occurred
         // 如果 != OK 说明确实没有收到消息，超时
         
-        // Otherwise, GOTO wait_for_camera_command label
-        // 否则 GOTO 到 wait_for_camera_command 标识
-        void *parse_result = NULL;
-        size_t parse_result_length = 0;
-        uint16_t received_seq = 0;
-        esp_err_t ret = data_wait_for_result_by_cmd(0x00, 0x19, 1000, &received_seq, &parse_result, &parse_result_length);
+        // Otherwise the command frame is already in hand, GOTO camera_command_received
+        // 否则命令帧已收到，GOTO 到 camera_command_received 标识
+        // Unless the link dropped under the request, then the camera will not send it either
+        // 除非链路在请求期间断开，此时相机也不会再发送命令帧
+        if (link_generation != s_link_generation) {
+            abandon_protocol_connect(link_generation);
+            return -1;
+        }
+
+        ret = data_wait_for_result_by_cmd_into(0x00, 0x19, 1000, &received_seq,
+                                               camera_command.data, sizeof(camera_command.data), &camera_command_length);
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "Timeout or error waiting for camera connection command, GOTO Failed.");
-            connect_logic_ble_disconnect();
+            abandon_protocol_connect(link_generation);
             return -1;
         } else {
             // If data is received, skip parsing camera response and directly enter STEP3
             // 如果能收到数据，跳过解析相机返回响应，直接进入STEP3
-            goto wait_for_camera_command;
+            goto camera_command_received;
         }
     }
 
@@ -342,36 +811,28 @@ int connect_logic_protocol_connect(uint32_t device_id, uint8_t mac_addr_len, con
     connection_request_response_frame *response = (connection_request_response_frame *)result.structure;
     if (response->ret_code != 0) {
         ESP_LOGE(TAG, "Connection handshake failed: unexpected response from camera, ret_code: %d", response->ret_code);
-        free(response);
-        connect_logic_ble_disconnect();
+        abandon_protocol_connect(link_generation);
         return -1;
     }
 
     ESP_LOGI(TAG, "Handshake successful, waiting for the camera to actively send the connection command frame...");
-    free(response);
 
     // STEP3: Wait for camera to send connection request
     // 等待相机主动发送连接请求
-wait_for_camera_command:
-    void *parse_result = NULL;
-    size_t parse_result_length = 0;
-    uint16_t received_seq = 0;
-    esp_err_t ret = data_wait_for_result_by_cmd(0x00, 0x19, 60000, &received_seq, &parse_result, &parse_result_length);
-
-    if (ret != ESP_OK || parse_result == NULL) {
+    ret = data_wait_for_result_by_cmd_into(0x00, 0x19, 60000, &received_seq,
+                                           camera_command.data, sizeof(camera_command.data), &camera_command_length);
+    if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Timeout or error waiting for camera connection command");
-        connect_logic_ble_disconnect();
+        abandon_protocol_connect(link_generation);
         return -1;
     }
 
+camera_command_received:
     // Parse the connection request command sent by camera
     // 解析相机发送的连接请求命令
-    connection_request_command_frame *camera_request = (connection_request_command_frame *)parse_result;
-
     if (camera_request->verify_mode != 2) {
         ESP_LOGE(TAG, "Unexpected verify_mode from camera: %d", camera_request->verify_mode);
-        free(parse_result);
-        connect_logic_ble_disconnect();
+        abandon_protocol_connect(link_generation);
         return -1;
     }
 
@@ -391,19 +852,27 @@ wait_for_camera_command:
 
         // STEP4: Send connection response frame
         // 发送连接应答帧
-        send_command(0x00, 0x19, ACK_NO_RESPONSE, &connection_response, received_seq, 5000);
-
-        // Set connection state to protocol connected
-        // 设置连接状态为协议连接
-        connect_state = PROTOCOL_CONNECTED;
+        send_command(0x00, 0x19, ACK_NO_RESPONSE, &connection_response, received_seq, 5000, NULL);
+
+        // Set connection state to protocol connected, unless the link dropped in the meantime
+        // 设置连接状态为协议连接，除非链路在此期间已断开
+        portENTER_CRITICAL(&s_state_lock);
+        const bool same_link = link_generation == s_link_generation;
+        if (same_link) {
+            connect_state = PROTOCOL_CONNECTED;
+        }
+        portEXIT_CRITICAL(&s_state_lock);
+        if (!same_link) {
+            abandon_protocol_connect(link_generation);
+            return -1;
+        }
+        report_state();
 
         ESP_LOGI(TAG, "Connection successfully established with camera.");
-        free(parse_result);
         return 0;
     } else {
         ESP_LOGW(TAG, "Camera rejected the connection, closing Bluetooth link...");
-        free(parse_result);
-        connect_logic_ble_disconnect();
+        abandon_protocol_connect(link_generation);
         return -1;
     }
 }
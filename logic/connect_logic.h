@@ -30,8 +30,23 @@ typedef enum {
                              // 主动断开连接中状态
 } connect_state_t;
 
+/* Activity that decides the link profile */
+/* 决定链路配置的活动 */
+typedef enum {
+    LINK_ACTIVITY_KEY = 0,   // Button pressed, a command to the camera follows
+                             // 按键按下，随后会向相机发送命令
+    LINK_ACTIVITY_GPS,       // GPS data pushed to the camera
+                             // 向相机推送了 GPS 数据
+    LINK_ACTIVITY_COUNT,
+} link_activity_t;
+
 connect_state_t connect_logic_get_state(void);
 
+/* 在改变状态的任务中调用，不得阻塞 */
+/* Runs on the task that changed the state, must not block */
+typedef void (*connect_state_change_cb_t)(connect_state_t state);
+void connect_logic_set_state_callback(connect_state_change_cb_t cb);
+
 int connect_logic_ble_init();
 
 int connect_logic_ble_connect(bool is_reconnecting);
@@ -44,4 +59,6 @@ int connect_logic_protocol_connect(uint32_t device_id, uint8_t mac_addr_len, con
 
 int connect_logic_ble_wakeup(void);
 
+void connect_logic_note_activity(link_activity_t activity);
+
 #endif
\ No newline at end of file
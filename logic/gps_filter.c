@@ -0,0 +1,367 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gps_filter.h"
+
+/* WGS84 长半轴与第一偏心率平方 */
+/* WGS84 semi-major axis and first eccentricity squared */
+#define WGS84_A_M   6378137.0f
+#define WGS84_E2    6.69437999014e-3f
+
+#define RADIANS_PER_E7_DEGREE ((float)M_PI / 180.0f * 1e-7f)
+
+/* 本地坐标超过此距离时将原点移到当前位置附近，保持单精度分辨率 */
+/* Once the local position is this far out the origin moves next to it, keeping single precision resolution */
+#define RECENTRE_DISTANCE_M 1000.0f
+
+/* 重新初始化时，没有速度测量的轴所取的速度 1 sigma */
+/* Velocity 1 sigma on (re)start for an axis without a velocity measurement */
+#define START_HORIZONTAL_SPEED_SIGMA_M_S 10.0f
+#define START_VERTICAL_SPEED_SIGMA_M_S   1.0f
+
+/* 一天和半天的毫秒数 */
+/* Milliseconds in a day and in half a day */
+#define MS_PER_DAY      86400000
+#define MS_PER_HALF_DAY 43200000
+
+/* 接收机误差估计的合理范围，GST 可能报告 0.0 */
+/* Sane range for a receiver error estimate, GST may report 0.0 */
+#define MIN_SIGMA_M 0.3f
+#define MAX_SIGMA_M 100.0f
+
+/**
+ * @brief Time from b to a in ms, across midnight UTC
+ *        从 b 到 a 的毫秒数，可跨过 UTC 零点
+ */
+static int32_t time_difference_ms(int32_t a, int32_t b) {
+    int32_t dt = a - b;
+    if (dt < -MS_PER_HALF_DAY) {  // 跨过 UTC 零点
+                                  // Crossed midnight UTC
+        dt += MS_PER_DAY;
+    } else if (dt > MS_PER_HALF_DAY) {
+        dt -= MS_PER_DAY;
+    }
+    return dt;
+}
+
+/**
+ * @brief Recompute the metres per 1e-7 degree at the origin latitude
+ *        重新计算原点纬度处每 1e-7 度对应的米数
+ */
+static void update_scale(gps_filter_t *filter) {
+    float phi = (float)filter->origin_latitude_e7 * RADIANS_PER_E7_DEGREE;
+    float s = sinf(phi);
+    float w2 = 1.0f - WGS84_E2 * s * s;
+    float w = sqrtf(w2);
+    // 子午圈与卯酉圈曲率半径
+    // Meridian and prime vertical radii of curvature
+    float meridian = WGS84_A_M * (1.0f - WGS84_E2) / (w2 * w);
+    float prime_vertical = WGS84_A_M / w;
+    filter->metres_per_e7_north = meridian * RADIANS_PER_E7_DEGREE;
+    filter->metres_per_e7_east = prime_vertical * cosf(phi) * RADIANS_PER_E7_DEGREE;
+}
+
+static void start_axis(gps_filter_axis_t *axis, float position, float position_sigma, float velocity, float velocity_sigma) {
+    axis->position = position;
+    axis->velocity = velocity;
+    axis->p_pp = position_sigma * position_sigma;
+    axis->p_pv = 0.0f;
+    axis->p_vv = velocity_sigma * velocity_sigma;
+}
+
+/**
+ * @brief Advance one axis by dt seconds under white acceleration noise of spectral density q
+ *        在谱密度为 q 的白噪声加速度下，将一个轴推进 dt 秒
+ */
+static void predict_axis(gps_filter_axis_t *axis, float dt, float q) {
+    float dt2 = dt * dt;
+    axis->position += axis->velocity * dt;
+    axis->p_pp += dt * (2.0f * axis->p_pv + dt * axis->p_vv) + q * dt2 * dt / 3.0f;
+    axis->p_pv += dt * axis->p_vv + q * dt2 / 2.0f;
+    axis->p_vv += q * dt;
+}
+
+static void update_position(gps_filter_axis_t *axis, float measured, float variance) {
+    float s = axis->p_pp + variance;
+    float k_p = axis->p_pp / s;
+    float k_v = axis->p_pv / s;
+    float innovation = measured - axis->position;
+    axis->position += k_p * innovation;
+    axis->velocity += k_v * innovation;
+    axis->p_vv -= k_v * axis->p_pv;
+    axis->p_pp *= 1.0f - k_p;
+    axis->p_pv *= 1.0f - k_p;
+}
+
+static void update_velocity(gps_filter_axis_t *axis, float measured, float variance) {
+    float s = axis->p_vv + variance;
+    float k_p = axis->p_pv / s;
+    float k_v = axis->p_vv / s;
+    float innovation = measured - axis->velocity;
+    axis->position += k_p * innovation;
+    axis->velocity += k_v * innovation;
+    axis->p_pp -= k_p * axis->p_pv;
+    axis->p_pv *= 1.0f - k_v;
+    axis->p_vv *= 1.0f - k_v;
+}
+
+static inline float or_default(float value, float fallback) {
+    return value > 0.0f ? value : fallback;
+}
+
+/**
+ * @brief Restart the filter at a measurement, which also becomes the origin
+ *        以一次测量重新初始化滤波器，该测量同时作为原点
+ */
+static void start_filter(gps_filter_t *filter, const gps_filter_measurement_t *m) {
+    float h_sigma = or_default(m->horizontal_sigma_m, GPS_FILTER_HORIZONTAL_SIGMA_M);
+    float v_sigma = or_default(m->vertical_sigma_m, GPS_FILTER_VERTICAL_SIGMA_M);
+    float s_sigma = or_default(m->speed_sigma_m_s, GPS_FILTER_SPEED_SIGMA_M_S);
+
+    filter->initialized = true;
+    filter->origin_latitude_e7 = m->latitude_e7;
+    filter->origin_longitude_e7 = m->longitude_e7;
+    filter->origin_altitude_mm = m->altitude_mm;
+    update_scale(filter);
+    filter->rejects_in_row = 0;
+
+    if (m->has_velocity) {
+        start_axis(&filter->north, 0.0f, h_sigma, m->velocity_north, s_sigma);
+        start_axis(&filter->east, 0.0f, h_sigma, m->velocity_east, s_sigma);
+    } else {
+        start_axis(&filter->north, 0.0f, h_sigma, 0.0f, START_HORIZONTAL_SPEED_SIGMA_M_S);
+        start_axis(&filter->east, 0.0f, h_sigma, 0.0f, START_HORIZONTAL_SPEED_SIGMA_M_S);
+    }
+    start_axis(&filter->up, 0.0f, v_sigma, 0.0f, START_VERTICAL_SPEED_SIGMA_M_S);
+}
+
+/**
+ * @brief Move the origin next to the estimate so local coordinates stay small
+ *        将原点移到估计位置附近，使本地坐标保持较小
+ */
+static void recentre(gps_filter_t *filter) {
+    if (fabsf(filter->north.position) < RECENTRE_DISTANCE_M && fabsf(filter->east.position) < RECENTRE_DISTANCE_M) {
+        return;
+    }
+    int32_t shift_north = (int32_t)lroundf(filter->north.position / filter->metres_per_e7_north);
+    int32_t shift_east = (int32_t)lroundf(filter->east.position / filter->metres_per_e7_east);
+    filter->north.position -= (float)shift_north * filter->metres_per_e7_north;
+    filter->east.position -= (float)shift_east * filter->metres_per_e7_east;
+    filter->origin_latitude_e7 += shift_north;
+    filter->origin_longitude_e7 += shift_east;
+    update_scale(filter);
+}
+
+static uint32_t sigma_to_units(float variance, float units_per_unit) {
+    float value = sqrtf(variance > 0.0f ? variance : 0.0f) * units_per_unit + 0.5f;
+    return value < 1.0f ? 1u : (uint32_t)value;
+}
+
+static void fill_output(const gps_filter_t *filter, gps_filter_output_t *out) {
+    out->latitude_e7 = filter->origin_latitude_e7 + (int32_t)lroundf(filter->north.position / filter->metres_per_e7_north);
+    out->longitude_e7 = filter->origin_longitude_e7 + (int32_t)lroundf(filter->east.position / filter->metres_per_e7_east);
+    out->altitude_mm = filter->origin_altitude_mm + (int32_t)lroundf(filter->up.position * 1000.0f);
+    out->velocity_north = filter->north.velocity;
+    out->velocity_east = filter->east.velocity;
+    out->velocity_descend = -filter->up.velocity;
+    // 平均无法消除的慢变误差不在协方差中，按 GPS_FILTER_CORRELATED_SHARE 加回
+    // The slowly drifting error that averaging cannot remove is not in the covariance, add back GPS_FILTER_CORRELATED_SHARE of it
+    float correlated_h = GPS_FILTER_CORRELATED_SHARE * filter->horizontal_variance;
+    float correlated_v = GPS_FILTER_CORRELATED_SHARE * filter->vertical_variance;
+    out->horizontal_accuracy_mm = sigma_to_units(filter->north.p_pp + filter->east.p_pp + 2.0f * correlated_h, 1000.0f);
+    out->vertical_accuracy_mm = sigma_to_units(filter->up.p_pp + correlated_v, 1000.0f);
+    out->speed_accuracy_cm_s = sigma_to_units(filter->north.p_vv + filter->east.p_vv + filter->up.p_vv, 100.0f);
+}
+
+/**
+ * @brief Clear the filter, the next fix starts it
+ *        清空滤波器，下一次定位将重新初始化
+ */
+void gps_filter_reset(gps_filter_t *filter) {
+    memset(filter, 0, sizeof(*filter));
+}
+
+/**
+ * @brief Fold one fix into the estimate
+ *        将一次定位并入估计
+ *
+ * The state is first predicted to the time of the fix. If the horizontal innovation falls outside
+ * GPS_FILTER_GATE_CHI2 the fix is rejected and out holds the prediction; because the gate is scaled
+ * by the predicted covariance, fast but consistent motion is not rejected the way a fixed distance
+ * threshold would. A gap longer than GPS_FILTER_MAX_GAP_MS, a time step back or
+ * GPS_FILTER_MAX_REJECTS rejects in a row restart the filter at the fix.
+ * 先将状态预测到该定位的时刻。水平新息超出 GPS_FILTER_GATE_CHI2 时剔除该定位，out 中为预测值；门限按预测协方差缩放，
+ * 因此不会像固定距离阈值那样剔除快速但连续的运动。间隔超过 GPS_FILTER_MAX_GAP_MS、时间回退或连续
+ * GPS_FILTER_MAX_REJECTS 次剔除时，以该定位重新初始化滤波器。
+ *
+ * @param filter 滤波器状态
+ *               Filter state
+ * @param measurement 接收机报告的定位，sigma 不大于 0 时使用默认值
+ *                    Fix reported by the receiver, a sigma of 0 or less falls back to the default
+ * @param out 滤波后的定位
+ *            Filtered fix
+ * @return int 已并入或重新初始化返回 0，被门限剔除返回 -1
+ *             0 if the fix was folded in or restarted the filter, -1 if the gate rejected it
+ */
+int gps_filter_update(gps_filter_t *filter, const gps_filter_measurement_t *measurement, gps_filter_output_t *out) {
+    int result = 0;
+
+    float h_sigma = or_default(measurement->horizontal_sigma_m, GPS_FILTER_HORIZONTAL_SIGMA_M);
+    float v_sigma = or_default(measurement->vertical_sigma_m, GPS_FILTER_VERTICAL_SIGMA_M);
+    float s_sigma = or_default(measurement->speed_sigma_m_s, GPS_FILTER_SPEED_SIGMA_M_S);
+    float h_variance = h_sigma * h_sigma;
+    float v_variance = v_sigma * v_sigma;
+    float s_variance = s_sigma * s_sigma;
+
+    int32_t dt_ms = time_difference_ms(measurement->time_ms, filter->last_time_ms);
+
+    if (!filter->initialized || dt_ms <= 0 || dt_ms > GPS_FILTER_MAX_GAP_MS) {
+        if (filter->initialized) {
+            filter->restarts++;
+        }
+        start_filter(filter, measurement);
+        filter->accepted++;
+    } else {
+        float dt = (float)dt_ms * 1e-3f;
+        const float q_h = GPS_FILTER_HORIZONTAL_ACCEL_M_S2 * GPS_FILTER_HORIZONTAL_ACCEL_M_S2;
+        const float q_v = GPS_FILTER_VERTICAL_ACCEL_M_S2 * GPS_FILTER_VERTICAL_ACCEL_M_S2;
+        predict_axis(&filter->north, dt, q_h);
+        predict_axis(&filter->east, dt, q_h);
+        predict_axis(&filter->up, dt, q_v);
+
+        // 测量值转换为本地坐标，整数差值保证远离原点时不丢精度
+        // Measurement in local coordinates; the integer difference keeps precision away from the origin
+        float north = (float)((int64_t)measurement->latitude_e7 - filter->origin_latitude_e7) * filter->metres_per_e7_north;
+        float east = (float)((int64_t)measurement->longitude_e7 - filter->origin_longitude_e7) * filter->metres_per_e7_east;
+        float up = (float)((int64_t)measurement->altitude_mm - filter->origin_altitude_mm) * 1e-3f;
+
+        float y_north = north - filter->north.position;
+        float y_east = east - filter->east.position;
+        float d2 = y_north * y_north / (filter->north.p_pp + h_variance) +
+                   y_east * y_east / (filter->east.p_pp + h_variance);
+
+        if (d2 > GPS_FILTER_GATE_CHI2) {
+            filter->rejected++;
+            if (++filter->rejects_in_row >= GPS_FILTER_MAX_REJECTS) {
+                filter->restarts++;
+                start_filter(filter, measurement);
+                filter->accepted++;
+            } else {
+                result = -1;
+            }
+        } else {
+            filter->rejects_in_row = 0;
+            update_position(&filter->north, north, h_variance);
+            update_position(&filter->east, east, h_variance);
+            update_position(&filter->up, up, v_variance);
+            if (measurement->has_velocity) {
+                update_velocity(&filter->north, measurement->velocity_north, s_variance);
+                update_velocity(&filter->east, measurement->velocity_east, s_variance);
+            }
+            recentre(filter);
+            filter->accepted++;
+        }
+    }
+
+    filter->last_time_ms = measurement->time_ms;
+    filter->horizontal_variance = h_variance;
+    filter->vertical_variance = v_variance;
+    fill_output(filter, out);
+    return result;
+}
+
+/**
+ * @brief Forget all receiver error estimates
+ *        清除所有接收机误差估计
+ */
+void gps_receiver_accuracy_reset(gps_receiver_accuracy_t *accuracy) {
+    accuracy->gga_time_ms = -1;
+    accuracy->gga_hdop_x100 = 0;
+    accuracy->gsa_time_ms = -1;
+    accuracy->pdop_x100 = 0;
+    accuracy->hdop_x100 = 0;
+    accuracy->vdop_x100 = 0;
+    accuracy->gst_time_ms = -1;
+    accuracy->latitude_sigma_mm = 0;
+    accuracy->longitude_sigma_mm = 0;
+    accuracy->altitude_sigma_mm = 0;
+}
+
+static bool is_fresh(int32_t stamp_ms, int32_t time_ms) {
+    if (stamp_ms < 0) {
+        return false;
+    }
+    int32_t age = time_difference_ms(time_ms, stamp_ms);
+    return age >= -GPS_FILTER_ACCURACY_MAX_AGE_MS && age <= GPS_FILTER_ACCURACY_MAX_AGE_MS;
+}
+
+static float clamp_sigma(float sigma) {
+    return sigma < MIN_SIGMA_M ? MIN_SIGMA_M : (sigma > MAX_SIGMA_M ? MAX_SIGMA_M : sigma);
+}
+
+/**
+ * @brief Set the measurement sigmas from the receiver's own error estimates
+ *        根据接收机自身的误差估计设置测量 sigma
+ *
+ * The GST error estimate is used when it is recent, otherwise the DOP times GPS_FILTER_UERE_M,
+ * preferring the GSA values over the GGA HDOP. A sigma without any estimate is left at 0, so
+ * gps_filter_update falls back to its default.
+ * GST 误差估计足够新时直接使用，否则用 DOP 乘以 GPS_FILTER_UERE_M，GSA 的数值优先于 GGA 的 HDOP。
+ * 没有任何估计的 sigma 保持为 0，由 gps_filter_update 使用默认值。
+ *
+ * @param accuracy 接收机误差估计
+ *                 Receiver error estimates
+ * @param measurement 按其 time_ms 判断估计是否过期，写入 horizontal_sigma_m 与 vertical_sigma_m
+ *                    Freshness is judged against its time_ms; horizontal_sigma_m and vertical_sigma_m are written
+ */
+void gps_filter_measurement_sigmas(const gps_receiver_accuracy_t *accuracy, gps_filter_measurement_t *measurement) {
+    int32_t time_ms = measurement->time_ms;
+    measurement->horizontal_sigma_m = 0.0f;
+    measurement->vertical_sigma_m = 0.0f;
+
+    if (is_fresh(accuracy->gst_time_ms, time_ms)) {
+        // 北向与东向误差的均方根作为每轴 sigma
+        // The RMS of the north and east errors is the per-axis sigma
+        float lat = (float)accuracy->latitude_sigma_mm * 1e-3f;
+        float lon = (float)accuracy->longitude_sigma_mm * 1e-3f;
+        measurement->horizontal_sigma_m = clamp_sigma(sqrtf(0.5f * (lat * lat + lon * lon)));
+        measurement->vertical_sigma_m = clamp_sigma((float)accuracy->altitude_sigma_mm * 1e-3f);
+        return;
+    }
+
+    // HDOP 乘以 UERE 是水平误差的均方根，除以 sqrt(2) 得到每轴 sigma
+    // HDOP times UERE is the horizontal RMS error, dividing by sqrt(2) gives the per-axis sigma
+    bool gsa_fresh = is_fresh(accuracy->gsa_time_ms, time_ms);
+    int32_t hdop_x100 = 0;
+    if (gsa_fresh && accuracy->hdop_x100 > 0) {
+        hdop_x100 = accuracy->hdop_x100;
+    } else if (accuracy->gga_time_ms == time_ms && accuracy->gga_hdop_x100 > 0) {
+        hdop_x100 = accuracy->gga_hdop_x100;
+    }
+    if (hdop_x100 > 0) {
+        measurement->horizontal_sigma_m = clamp_sigma((float)hdop_x100 * 0.01f * GPS_FILTER_UERE_M * (float)M_SQRT1_2);
+    }
+    if (gsa_fresh && accuracy->vdop_x100 > 0) {
+        measurement->vertical_sigma_m = clamp_sigma((float)accuracy->vdop_x100 * 0.01f * GPS_FILTER_UERE_M);
+    }
+}
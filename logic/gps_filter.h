@@ -0,0 +1,210 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#ifndef __GPS_FILTER_H__
+#define __GPS_FILTER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* 单个位置测量的默认 1 sigma 误差，接收机未给出误差估计时使用 */
+/* Default 1 sigma error of one position measurement, used when the receiver gives no estimate */
+#ifndef GPS_FILTER_HORIZONTAL_SIGMA_M
+#define GPS_FILTER_HORIZONTAL_SIGMA_M 2.5f
+#endif
+#ifndef GPS_FILTER_VERTICAL_SIGMA_M
+#define GPS_FILTER_VERTICAL_SIGMA_M 4.0f
+#endif
+#ifndef GPS_FILTER_SPEED_SIGMA_M_S
+#define GPS_FILTER_SPEED_SIGMA_M_S 0.2f
+#endif
+
+/* 接收机误差中缓慢变化、无法靠平均相邻定位消除的方差占比，报告精度时加回 */
+/* Share of the receiver error variance that drifts slowly and cannot be averaged out over consecutive fixes,
+   added back when reporting accuracy */
+#ifndef GPS_FILTER_CORRELATED_SHARE
+#define GPS_FILTER_CORRELATED_SHARE 0.6f
+#endif
+
+/* 用户等效测距误差，与 DOP 相乘得到位置误差；仅在没有 GST 误差估计时使用 */
+/* User equivalent range error, times the DOP gives the position error; only used without a GST error estimate */
+#ifndef GPS_FILTER_UERE_M
+#define GPS_FILTER_UERE_M 3.0f
+#endif
+
+/* 接收机给出的误差估计早于定位这么久即不再使用 */
+/* A receiver error estimate older than this relative to the fix is no longer used */
+#ifndef GPS_FILTER_ACCURACY_MAX_AGE_MS
+#define GPS_FILTER_ACCURACY_MAX_AGE_MS 2000
+#endif
+
+/* 过程噪声：未建模加速度的 1 sigma，水平按车辆、垂直按道路坡度变化取值 */
+/* Process noise: 1 sigma of the unmodelled acceleration, horizontal sized for a vehicle, vertical for road grade changes */
+#ifndef GPS_FILTER_HORIZONTAL_ACCEL_M_S2
+#define GPS_FILTER_HORIZONTAL_ACCEL_M_S2 2.0f
+#endif
+#ifndef GPS_FILTER_VERTICAL_ACCEL_M_S2
+#define GPS_FILTER_VERTICAL_ACCEL_M_S2 0.5f
+#endif
+
+/* 水平新息的卡方门限（2 自由度，99.9%），超过则视为异常值 */
+/* Chi-square gate on the horizontal innovation (2 degrees of freedom, 99.9%), beyond it a fix is an outlier */
+#ifndef GPS_FILTER_GATE_CHI2
+#define GPS_FILTER_GATE_CHI2 13.8f
+#endif
+
+/* 连续这么多个定位被剔除后，认为是真实跳变，以新测量重新初始化 */
+/* After this many fixes rejected in a row the jump is taken as real and the filter restarts from the measurement */
+#ifndef GPS_FILTER_MAX_REJECTS
+#define GPS_FILTER_MAX_REJECTS 5
+#endif
+
+/* 两次定位间隔超过此值时重新初始化，不再外推 */
+/* A gap between fixes longer than this restarts the filter instead of extrapolating across it */
+#ifndef GPS_FILTER_MAX_GAP_MS
+#define GPS_FILTER_MAX_GAP_MS 10000
+#endif
+
+/**
+ * @brief Position and velocity along one local axis, with their 2x2 covariance
+ *        本地坐标系一个轴上的位置与速度，以及 2x2 协方差
+ */
+typedef struct {
+    float position;             // Metres from the origin
+                                // 相对原点的米数
+    float velocity;             // m/s
+    float p_pp;                 // Position variance (m^2)
+                                // 位置方差 (m^2)
+    float p_pv;                 // Position/velocity covariance (m^2/s)
+                                // 位置/速度协方差 (m^2/s)
+    float p_vv;                 // Velocity variance (m^2/s^2)
+                                // 速度方差 (m^2/s^2)
+} gps_filter_axis_t;
+
+/**
+ * @brief Constant-velocity Kalman filter in a local north/east/up frame
+ *        本地北/东/天坐标系下的匀速卡尔曼滤波器
+ *
+ * The three axes are filtered independently, so an update is a handful of scalar operations
+ * instead of a 6x6 matrix product. Positions are kept in metres from an origin near the receiver,
+ * which keeps single precision at millimetre level; the origin follows the receiver.
+ * 三个轴相互独立滤波，一次更新只需少量标量运算，无需 6x6 矩阵乘法。位置以相对接收机附近原点的米数保存，
+ * 单精度即可保持毫米级分辨率；原点会跟随接收机移动。
+ */
+typedef struct {
+    bool initialized;
+    int32_t origin_latitude_e7;     // Origin of the local frame (1e-7 degrees)
+                                    // 本地坐标系原点 (1e-7 度)
+    int32_t origin_longitude_e7;
+    int32_t origin_altitude_mm;
+    float metres_per_e7_north;      // Local scale at the origin latitude
+                                    // 原点纬度处的比例
+    float metres_per_e7_east;
+    int32_t last_time_ms;           // UTC time of day of the last update (ms)
+                                    // 上次更新的 UTC 当日时间 (毫秒)
+    uint8_t rejects_in_row;
+    float horizontal_variance;      // Position variance of the last fix (m^2)
+                                    // 最近一次定位的位置方差 (m^2)
+    float vertical_variance;
+    gps_filter_axis_t north;
+    gps_filter_axis_t east;
+    gps_filter_axis_t up;
+    uint32_t accepted;              // Fixes folded into the estimate
+                                    // 已并入估计的定位数
+    uint32_t rejected;              // Fixes rejected by the innovation gate
+                                    // 被新息门限剔除的定位数
+    uint32_t restarts;              // Restarts after a gap, a time step back or a run of rejects
+                                    // 因间隔过长、时间回退或连续剔除而重新初始化的次数
+} gps_filter_t;
+
+/**
+ * @brief One fix as reported by the receiver
+ *        接收机报告的一次定位
+ */
+typedef struct {
+    int32_t time_ms;            // UTC time of day (ms)
+                                // UTC 当日时间 (毫秒)
+    int32_t latitude_e7;        // 1e-7 degrees
+                                // 1e-7 度
+    int32_t longitude_e7;
+    int32_t altitude_mm;
+    bool has_velocity;          // velocity_north/east are valid
+                                // velocity_north/east 有效
+    float velocity_north;       // m/s
+    float velocity_east;
+    float horizontal_sigma_m;   // 1 sigma of the north and of the east position error
+                                // 北向与东向位置误差各自的 1 sigma
+    float vertical_sigma_m;
+    float speed_sigma_m_s;      // 1 sigma of each velocity component
+                                // 各速度分量的 1 sigma
+} gps_filter_measurement_t;
+
+/**
+ * @brief Filtered fix, in the units of gps_data_push_command_frame
+ *        滤波后的定位，单位与 gps_data_push_command_frame 一致
+ */
+typedef struct {
+    int32_t latitude_e7;
+    int32_t longitude_e7;
+    int32_t altitude_mm;
+    float velocity_north;           // m/s
+    float velocity_east;
+    float velocity_descend;         // Positive when descending
+                                    // 下降为正
+    uint32_t horizontal_accuracy_mm;    // sqrt of the north plus east position variance, see GPS_FILTER_CORRELATED_SHARE
+                                        // 北向与东向位置方差之和的平方根，参见 GPS_FILTER_CORRELATED_SHARE
+    uint32_t vertical_accuracy_mm;
+    uint32_t speed_accuracy_cm_s;       // sqrt of the summed velocity variances
+                                        // 各速度方差之和的平方根
+} gps_filter_output_t;
+
+/**
+ * @brief Error estimates reported by the receiver, as parsed from GGA, GSA and GST
+ *        接收机报告的误差估计，由 GGA、GSA 和 GST 解析得到
+ *
+ * Times are UTC time of day in ms, -1 until the value has been seen. GSA carries no time, so it is
+ * stamped with the time of the last RMC or GGA before it.
+ * 时间为 UTC 当日毫秒数，收到对应数值前为 -1。GSA 不带时间，以其前最近一条 RMC 或 GGA 的时间为准。
+ */
+typedef struct {
+    int32_t gga_time_ms;            // GGA HDOP, every fix
+                                    // GGA 的 HDOP，每次定位都有
+    int32_t gga_hdop_x100;
+    int32_t gsa_time_ms;            // GSA dilution of precision
+                                    // GSA 精度因子
+    int32_t pdop_x100;
+    int32_t hdop_x100;
+    int32_t vdop_x100;
+    int32_t gst_time_ms;            // GST 1 sigma errors
+                                    // GST 的 1 sigma 误差
+    int32_t latitude_sigma_mm;
+    int32_t longitude_sigma_mm;
+    int32_t altitude_sigma_mm;
+} gps_receiver_accuracy_t;
+
+void gps_filter_reset(gps_filter_t *filter);
+
+void gps_receiver_accuracy_reset(gps_receiver_accuracy_t *accuracy);
+
+void gps_filter_measurement_sigmas(const gps_receiver_accuracy_t *accuracy, gps_filter_measurement_t *measurement);
+
+
+int gps_filter_update(gps_filter_t *filter, const gps_filter_measurement_t *measurement, gps_filter_output_t *out);
+
+#endif
@@ -17,28 +17,49 @@
  * failure to do so.
  */
 
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
-#include <ctype.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
 
 #include "gps_logic.h"
+#include "nmea_parser.h"
+#include "ubx_parser.h"
+#include "gps_push.h"
+#include "gps_filter.h"
+#include "gps_snapshot.h"
 #include "connect_logic.h"
 #include "command_logic.h"
 #include "dji_protocol_data_structures.h"
 
 #define TAG "LOGIC_GPS"
 
-// Define buffer to store received data
-// 定义缓冲区用于存储接收到的数据
-static char buff_t[RX_BUF_SIZE]={0};
-
-// Initialize GPS data structure
-// 初始化 GPS 数据结构
+// Fix being assembled, only touched by the GPS receive task
+// 正在组装的定位，只由 GPS 接收任务访问
 static GPS_Data_t GPS_Data;
 
-// Counter for consecutive invalid GPS readings
-// GPS连续无效次数计数器
+// Latest complete fix, other tasks read it through gps_get_fix
+// 最新的完整定位，其他任务通过 gps_get_fix 读取
+static gps_snapshot_t gps_snapshot;
+
+// Position/velocity filter, smooths the fixes and rejects outliers
+// 位置/速度滤波器，平滑定位并剔除异常值
+static gps_filter_t gps_filter;
+
+// Error estimates from GGA, GSA and GST, they set the filter's measurement sigmas
+// 来自 GGA、GSA 与 GST 的误差估计，用于设置滤波器的测量 sigma
+static gps_receiver_accuracy_t receiver_accuracy;
+
+// Counter for consecutive invalid GPS readings, written by the receive task and read atomically elsewhere
+// GPS连续无效次数计数器，由接收任务写入，其他任务原子读取
 static uint8_t gps_invalid_count = 0;
 
 /**
@@ -54,29 +75,41 @@ static void init_gps_data(void) {
     GPS_Data.Day = 0;
     GPS_Data.Hour = 0;
     GPS_Data.Minute = 0;
-    GPS_Data.Second = 0.0;
+    GPS_Data.Second = 0;
+    GPS_Data.Millisecond = 0;
 
-    GPS_Data.Latitude = 0.0;
+    GPS_Data.Latitude_e7 = 0;
     GPS_Data.Lat_Indicator = 'N';
-    GPS_Data.Longitude = 0.0;
+    GPS_Data.Longitude_e7 = 0;
     GPS_Data.Lon_Indicator = 'E';
 
-    GPS_Data.Speed_knots = 0.0;
-    GPS_Data.Course = 0.0;
-    GPS_Data.Altitude = 0.0;
+    GPS_Data.Speed_mknots = 0;
+    GPS_Data.Course_cdeg = 0;
+    GPS_Data.Altitude_mm = 0;
     GPS_Data.Num_Satellites = 0;
 
-    GPS_Data.Velocity_North = 0.0;
-    GPS_Data.Velocity_East = 0.0;
-    GPS_Data.Velocity_Descend = 0.0;
+    GPS_Data.Velocity_North = 0.0f;
+    GPS_Data.Velocity_East = 0.0f;
+    GPS_Data.Velocity_Descend = 0.0f;
+
+    GPS_Data.Horizontal_Accuracy_mm = 0;
+    GPS_Data.Vertical_Accuracy_mm = 0;
+    GPS_Data.Speed_Accuracy_cm_s = 0;
 
     // GPS_Data.Status = 0;
     GPS_Data.RMC_Valid = 0;
     GPS_Data.GGA_Valid = 0;
-    GPS_Data.RMC_Latitude = 0.0;
-    GPS_Data.RMC_Longitude = 0.0;
-    GPS_Data.GGA_Latitude = 0.0;
-    GPS_Data.GGA_Longitude = 0.0;
+    GPS_Data.RMC_Latitude_e7 = 0;
+    GPS_Data.RMC_Longitude_e7 = 0;
+    GPS_Data.GGA_Latitude_e7 = 0;
+    GPS_Data.GGA_Longitude_e7 = 0;
+    GPS_Data.GGA_Altitude_mm = 0;
+    GPS_Data.RMC_Velocity_North = 0.0f;
+    GPS_Data.RMC_Velocity_East = 0.0f;
+
+    gps_filter_reset(&gps_filter);
+    gps_receiver_accuracy_reset(&receiver_accuracy);
+    gps_snapshot_init(&gps_snapshot);
 }
 
 /**
@@ -87,7 +120,7 @@ static void init_gps_data(void) {
  *              如果 GPS 连续无效次数小于10，返回 true；否则返回 false
  */
 bool is_gps_found(void) {
-    return (gps_invalid_count < 10);
+    return (__atomic_load_n(&gps_invalid_count, __ATOMIC_RELAXED) < 10);
 }
 
 /**
@@ -98,389 +131,449 @@ bool is_gps_found(void) {
  *              如果 GPS 状态为有效，返回 true；否则返回 false
  */
 bool is_current_gps_data_valid(void) {
-    if (GPS_Data.Status == 1) {
-        return true;
-    }
-    return false;
+    GPS_Data_t fix;
+    return gps_get_fix(&fix);
 }
 
-// Store previous altitude and time for velocity calculation
-// 用于存储前一时刻的高度和时间，用于计算速度
-static double Previous_Altitude = 0.0;
-static double Previous_Time = 0.0;
-
-// Used to store the previous latitude and longitude for outlier removal
-// 用于存储前一时刻的纬度和经度，用于剔除异常值
-static double Previous_Latitude = 0.0;
-static double Previous_Longitude = 0.0;
-
 /**
- * @brief Convert NMEA format coordinates to decimal degrees
- *        将 NMEA 格式的经纬度转换为十进制度
- * 
- * @param nmea NMEA format coordinate string
- *             NMEA 格式的经纬度字符串
- * @param direction Direction character ('N', 'S', 'E', 'W')
- *                  方向字符（'N', 'S', 'E', 'W'）
- * 
- * @return double Converted decimal degree value
- *                转换后的十进制度值
+ * @brief Copy the latest complete fix, safe from any task
+ *        拷贝最新的完整定位，可在任意任务中调用
+ *
+ * The copy never mixes two fixes and never waits for the receive task, see gps_snapshot.h.
+ * 拷贝结果不会混合两次定位，也不会等待接收任务，参见 gps_snapshot.h。
+ *
+ * @param out Receives the fix
+ *            接收定位
+ * @return bool true if the fix is valid (Status 1)
+ *              定位有效（Status 为 1）时返回 true
  */
-double Convert_NMEA_To_Degree(const char *nmea, char direction) {
-    double deg = 0.0;
-    double min = 0.0;
-
-    // Determine integer and decimal parts
-    // 确定整数部分和小数部分
-    const char *dot = nmea;
-    while (*dot && *dot != '.') { // Find decimal point position
-                                  // 找到小数点的位置
-        dot++;
-    }
+bool gps_get_fix(GPS_Data_t *out) {
+    gps_snapshot_read(&gps_snapshot, out);
+    return out->Status == 1;
+}
 
-    // Calculate integer part
-    // 计算整数部分
-    int int_part = 0;
-    const char *ptr = nmea;
-    while (ptr < dot && isdigit((unsigned char)*ptr)) {
-        int_part = int_part * 10 + (*ptr - '0'); // Accumulate digits
-                                                 // 累积数字
-        ptr++;
-    }
+// UART event queue depth, and how many '\n' positions the driver remembers
+// UART 事件队列深度，以及驱动记录的 '\n' 位置数
+#define GPS_UART_QUEUE_LENGTH   20
+#define GPS_PATTERN_QUEUE_LENGTH 20
 
-    // Calculate decimal part
-    // 计算小数部分
-    double frac_part = 0.0;
-    double divisor = 10.0;
-    ptr = dot + 1; // Skip decimal point
-                   // 跳过小数点
-    while (*ptr && isdigit((unsigned char)*ptr)) {
-        frac_part += (*ptr - '0') / divisor;
-        divisor *= 10.0;
-        ptr++;
-    }
+// UART event queue, receives a pattern event for every '\n'
+// UART 事件队列，每个 '\n' 产生一次模式检测事件
+static QueueHandle_t gps_uart_queue = NULL;
 
-    // Combine integer and decimal parts
-    // 合并整数部分和小数部分
-    deg = int_part + frac_part;
+// Keeps a sentence split across UART reads until its line end arrives
+// 保存跨 UART 读取被拆分的语句，直到其行尾到达
+static nmea_line_assembler_t nmea_assembler;
 
-    // Separate degrees and minutes
-    // 分离度和分
-    min = deg - ((int)(deg / 100)) * 100;
-    deg = ((int)(deg / 100)) + min / 60.0;
+// UTC time of the RMC and GGA of the fix being assembled (ms of day), -1 until seen
+// 正在组装的定位中 RMC 与 GGA 的 UTC 时间（当日毫秒数），未收到时为 -1
+static int32_t rmc_time_ms = -1;
+static int32_t gga_time_ms = -1;
 
-    // Adjust sign based on direction
-    // 根据方向调整正负
-    if (direction == 'S' || direction == 'W') {
-        deg = -deg;
-    }
+// UTC time of the last RMC or GGA (ms of day), GSA carries no time of its own
+// 最近一条 RMC 或 GGA 的 UTC 时间（当日毫秒数），GSA 本身不带时间
+static int32_t last_sentence_time_ms = -1;
+
+void gps_push_data(void);
 
-    return deg;
+static inline int32_t time_of_day_ms(uint8_t hour, uint8_t minute, uint8_t second, uint16_t millisecond) {
+    return ((hour * 60 + minute) * 60 + second) * 1000 + millisecond;
 }
 
+/* RMC 字段序号（地址字段之后从 0 开始） */
+/* RMC field indices, counted from 0 after the address field */
+enum {
+    RMC_FIELD_TIME = 0,
+    RMC_FIELD_STATUS = 1,
+    RMC_FIELD_LATITUDE = 2,
+    RMC_FIELD_LAT_HEMISPHERE = 3,
+    RMC_FIELD_LONGITUDE = 4,
+    RMC_FIELD_LON_HEMISPHERE = 5,
+    RMC_FIELD_SPEED_KNOTS = 6,
+    RMC_FIELD_COURSE = 7,
+    RMC_FIELD_DATE = 8,
+};
+
+/* GGA 字段序号（地址字段之后从 0 开始） */
+/* GGA field indices, counted from 0 after the address field */
+enum {
+    GGA_FIELD_TIME = 0,
+    GGA_FIELD_LATITUDE = 1,
+    GGA_FIELD_LAT_HEMISPHERE = 2,
+    GGA_FIELD_LONGITUDE = 3,
+    GGA_FIELD_LON_HEMISPHERE = 4,
+    GGA_FIELD_QUALITY = 5,
+    GGA_FIELD_SATELLITES = 6,
+    GGA_FIELD_HDOP = 7,
+    GGA_FIELD_ALTITUDE = 8,
+};
+
+/* GSA 字段序号（地址字段之后从 0 开始），12 个卫星号之后为 DOP */
+/* GSA field indices, counted from 0 after the address field; the DOPs follow 12 satellite IDs */
+enum {
+    GSA_FIELD_FIX_TYPE = 1,
+    GSA_FIELD_PDOP = 14,
+    GSA_FIELD_HDOP = 15,
+    GSA_FIELD_VDOP = 16,
+};
+
+/* GST 字段序号（地址字段之后从 0 开始） */
+/* GST field indices, counted from 0 after the address field */
+enum {
+    GST_FIELD_TIME = 0,
+    GST_FIELD_LATITUDE_SIGMA = 5,
+    GST_FIELD_LONGITUDE_SIGMA = 6,
+    GST_FIELD_ALTITUDE_SIGMA = 7,
+};
+
 /**
  * @brief Parse GNRMC sentence, e.g.: $GNRMC,074700.000,A,2234.732734,N,11356.317512,E,1.67,285.57,150125,,,A,V*03
  *        解析 GNRMC 语句，例如：$GNRMC,074700.000,A,2234.732734,N,11356.317512,E,1.67,285.57,150125,,,A,V*03
  * 
  * Parse GNRMC sentence to extract GPS data including time, status, latitude, longitude, speed, course, etc.
- * (There may be data accuracy issues that can be optimized as needed)
- * 解析 GNRMC 语句，提取 GPS 数据，包括时间、状态、纬度、经度、速度、航向等信息（可能存在数据不精确问题，可自行优化）。
+ * Empty fields leave the corresponding value untouched.
+ * 解析 GNRMC 语句，提取 GPS 数据，包括时间、状态、纬度、经度、速度、航向等信息。空字段不会修改对应的值。
  * 
- * @param sentence Input GNRMC sentence string
- *                 输入的 GNRMC 语句字符串
+ * @param sentence Tokenized RMC sentence
+ *                 已分词的 RMC 语句
  */
-void Parse_GNRMC(char *sentence) {
-    char *token = strtok(sentence, ",");
-    int field = 0;
-
-    double temp_latitude = 0.0;
-    double temp_longitude = 0.0;
-
-    while (token != NULL) {
-        field++;
-        switch (field) {
-            case 2: {
-                // 时间 hhmmss.sss
-                // Time hhmmss.sss
-                uint8_t hour = 0, minute = 0;
-                double second = 0.0;
-
-                // 手动解析时间
-                // Manually parse time
-                const char *ptr = token;
-                hour = (ptr[0] - '0') * 10 + (ptr[1] - '0');
-                minute = (ptr[2] - '0') * 10 + (ptr[3] - '0');
-                second = atof(ptr + 4);
-
-                GPS_Data.Hour = hour;
-                GPS_Data.Minute = minute;
-                GPS_Data.Second = second;
-                break;
-            }
-            case 3:
-                // 状态 A/V
-                // Status A/V
-                GPS_Data.RMC_Valid = (token[0] == 'A') ? 1 : 0;
-                break;
-            case 4:
-                // 纬度（暂时存储）
-                // Latitude (temporary storage)
-                temp_latitude = Convert_NMEA_To_Degree(token, 'N');
-                break;
-            case 5:
-                // 更新纬度方向
-                // Update latitude direction
-                GPS_Data.Lat_Indicator = token[0];
-                GPS_Data.RMC_Latitude = (GPS_Data.Lat_Indicator == 'S') ? -temp_latitude : temp_latitude;
-                break;
-            case 6:
-                // 经度（暂时存储）
-                // Longitude (temporary storage)
-                temp_longitude = Convert_NMEA_To_Degree(token, 'E');
-                break;
-            case 7:
-                // 更新经度方向
-                // Update longitude direction
-                GPS_Data.Lon_Indicator = token[0];
-                GPS_Data.RMC_Longitude = (GPS_Data.Lon_Indicator == 'W') ? -temp_longitude : temp_longitude;
-                break;
-            case 8:
-                // 地面速度 (节)
-                // Ground speed (knots)
-                GPS_Data.Speed_knots = atof(token);
-                break;
-            case 9:
-                // 航向 (度)
-                // Course (degrees)
-                GPS_Data.Course = atof(token);
-                break;
-            case 10: {
-                // 日期 ddmmyy
-                // Date ddmmyy
-                uint8_t day = 0, month = 0, year = 0;
-
-                // 手动解析日期
-                // Manually parse date
-                const char *ptr = token;
-                day = (ptr[0] - '0') * 10 + (ptr[1] - '0');
-                month = (ptr[2] - '0') * 10 + (ptr[3] - '0');
-                year = (ptr[4] - '0') * 10 + (ptr[5] - '0');
-
-                GPS_Data.Day = day;
-                GPS_Data.Month = month;
-                GPS_Data.Year = year;
-                break;
-            }
-            default:
-                break;
-        }
-        token = strtok(NULL, ",");
+void Parse_GNRMC(const nmea_sentence_t *sentence) {
+    // 时间 hhmmss.sss
+    // Time hhmmss.sss
+    if (nmea_field_time(sentence, RMC_FIELD_TIME, &GPS_Data.Hour, &GPS_Data.Minute, &GPS_Data.Second, &GPS_Data.Millisecond)) {
+        rmc_time_ms = time_of_day_ms(GPS_Data.Hour, GPS_Data.Minute, GPS_Data.Second, GPS_Data.Millisecond);
+        last_sentence_time_ms = rmc_time_ms;
+    } else {
+        rmc_time_ms = -1;
     }
 
-    // 计算向北和向东的速度分量 (米/秒)，节转米/秒
-    // Calculate velocity components to north and east (m/s), convert from knots to m/s
-    double speed_m_s = GPS_Data.Speed_knots * 0.514444;
-    GPS_Data.Velocity_North = speed_m_s * cos(GPS_Data.Course * M_PI / 180.0);
-    GPS_Data.Velocity_East = speed_m_s * sin(GPS_Data.Course * M_PI / 180.0);
+    // 状态 A/V
+    // Status A/V
+    GPS_Data.RMC_Valid = (nmea_field_char(sentence, RMC_FIELD_STATUS) == 'A') ? 1 : 0;
+
+    // 纬度及方向
+    // Latitude and direction
+    int32_t latitude;
+    char lat_indicator = nmea_field_char(sentence, RMC_FIELD_LAT_HEMISPHERE);
+    if (nmea_field_degrees_e7(sentence, RMC_FIELD_LATITUDE, &latitude) && lat_indicator != '\0') {
+        GPS_Data.Lat_Indicator = lat_indicator;
+        GPS_Data.RMC_Latitude_e7 = (lat_indicator == 'S') ? -latitude : latitude;
+    }
+
+    // 经度及方向
+    // Longitude and direction
+    int32_t longitude;
+    char lon_indicator = nmea_field_char(sentence, RMC_FIELD_LON_HEMISPHERE);
+    if (nmea_field_degrees_e7(sentence, RMC_FIELD_LONGITUDE, &longitude) && lon_indicator != '\0') {
+        GPS_Data.Lon_Indicator = lon_indicator;
+        GPS_Data.RMC_Longitude_e7 = (lon_indicator == 'W') ? -longitude : longitude;
+    }
+
+    // 地面速度 (0.001 节) 与航向 (0.01 度)
+    // Ground speed (0.001 knots) and course (0.01 degrees)
+    nmea_field_fixed(sentence, RMC_FIELD_SPEED_KNOTS, 3, &GPS_Data.Speed_mknots);
+    nmea_field_fixed(sentence, RMC_FIELD_COURSE, 2, &GPS_Data.Course_cdeg);
+
+    // 日期 ddmmyy
+    // Date ddmmyy
+    nmea_field_date(sentence, RMC_FIELD_DATE, &GPS_Data.Day, &GPS_Data.Month, &GPS_Data.Year);
+
+    // 计算向北和向东的速度分量 (米/秒)，0.001 节转米/秒，单精度即可满足 cm/s 的推送精度
+    // Calculate velocity components to north and east (m/s), convert from 0.001 knots to m/s,
+    // single precision is enough for the cm/s that gets pushed
+    float speed_m_s = (float)GPS_Data.Speed_mknots * 0.000514444f;
+    float course_rad = (float)GPS_Data.Course_cdeg * ((float)M_PI / 18000.0f);
+    GPS_Data.RMC_Velocity_North = speed_m_s * cosf(course_rad);
+    GPS_Data.RMC_Velocity_East = speed_m_s * sinf(course_rad);
 }
 
 /**
  * @brief Parse GNGGA sentence, e.g.: $GNGGA,074700.000,2234.732734,N,11356.317512,E,1,7,1.31,47.379,M,-2.657,M,,*65
  *        解析 GNGGA 语句，例如：$GNGGA,074700.000,2234.732734,N,11356.317512,E,1,7,1.31,47.379,M,-2.657,M,,*65
  * 
- * Parse GNGGA sentence to extract GPS data including time, latitude, longitude, number of satellites, altitude, etc.
- * (There may be data accuracy issues that can be optimized as needed)
- * 解析 GNGGA 语句，提取 GPS 数据，包括时间、纬度、经度、卫星数量、海拔高度等信息（可能存在数据不精确问题，可自行优化）。
+ * Parse GNGGA sentence to extract GPS data including latitude, longitude, number of satellites, altitude, etc.
+ * Empty fields leave the corresponding value untouched.
+ * 解析 GNGGA 语句，提取 GPS 数据，包括纬度、经度、卫星数量、海拔高度等信息。空字段不会修改对应的值。
  * 
- * @param sentence Input GNGGA sentence string
- *                 输入的 GNGGA 语句字符串
+ * @param sentence Tokenized GGA sentence
+ *                 已分词的 GGA 语句
  */
-void Parse_GNGGA(char *sentence) {
-    char *token = strtok(sentence, ",");
-    int field = 0;
-
-    double temp_latitude = 0.0;
-    double temp_longitude = 0.0;
-
-    while (token != NULL) {
-        field++;
-        switch (field) {
-            case 1:
-                // $GNGGA
-                break;
-            case 2:
-                // 时间 hhmmss.sss，可与GNRMC中的时间对比，确保同步
-                // Time hhmmss.sss, can be compared with GNRMC time for synchronization
-                break;
-            case 3:
-                // 纬度
-                // Latitude
-                temp_latitude = Convert_NMEA_To_Degree(token, 'N');
-                break;
-            case 4:
-                // N/S
-                // North/South indicator
-                GPS_Data.Lat_Indicator = token[0];
-                GPS_Data.GGA_Latitude = (GPS_Data.Lat_Indicator == 'S') ? -temp_latitude : temp_latitude;
-                break;
-            case 5:
-                // 经度
-                // Longitude
-                temp_longitude = Convert_NMEA_To_Degree(token, 'E');
-                break;
-            case 6:
-                // E/W
-                // East/West indicator
-                GPS_Data.Lon_Indicator = token[0];
-                GPS_Data.GGA_Longitude = (GPS_Data.Lon_Indicator == 'W') ? -temp_longitude : temp_longitude;
-                break;
-            case 7:
-                // 定位质量
-                // Position fix quality
-                if (token[0] != '\0') {
-                    int quality = atoi(token);
-                    GPS_Data.GGA_Valid = (quality > 0) ? 1 : 0;
-                }
-                break;
-            case 8:
-                // 可见卫星数量
-                // Number of satellites in view
-                GPS_Data.Num_Satellites = (uint8_t) atoi(token);
-                break;
-            case 9:
-                // HDOP，可根据需要解析
-                // HDOP, can be parsed if needed
-                break;
-            case 10:
-                // 海拔高度 (米)
-                // Altitude (meters)
-                GPS_Data.Altitude = atof(token);
-                // 计算下降速度 (需要上一高度和时间)
-                // Calculate descent velocity (needs previous altitude and time)
-                if (Previous_Time > 0.0) {
-                    double current_time = GPS_Data.Hour * 3600 + GPS_Data.Minute * 60 + GPS_Data.Second;
-                    double delta_time = current_time - Previous_Time;
-                    
-                    // 处理跨天情况
-                    // Handle day crossover
-                    if (delta_time < -43200) {  // 如果时间差小于-12小时，说明跨天了
-                                                // If time difference is less than -12 hours, day has changed
-                        delta_time += 86400;    // 加上24小时
-                                                // Add 24 hours
-                    } else if (delta_time > 43200) {  // 如果时间差大于12小时，说明是前一天的数据
-                                                      // If time difference is more than 12 hours, it's previous day's data
-                        delta_time -= 86400;
-                    }
-                    
-                    if (delta_time > 0 && delta_time < 10) {  // 只处理合理的时间差（比如小于10秒）
-                                                              // Only process reasonable time differences (e.g., less than 10 seconds)
-                        double delta_altitude = GPS_Data.Altitude - Previous_Altitude;
-                        // 过滤异常值（比如高度差太大）
-                        // Filter abnormal values (e.g., too large altitude differences)
-                        if (fabs(delta_altitude) < 100) {  // 假设最大垂直速度不超过100m/s
-                                                           // Assume maximum vertical speed doesn't exceed 100m/s
-                            GPS_Data.Velocity_Descend = -delta_altitude / delta_time;  // 注意符号：上升为负，下降为正
-                                                                                       // Note: negative for ascent, positive for descent
-                        }
-                    }
-                }
-                Previous_Altitude = GPS_Data.Altitude;
-                Previous_Time = GPS_Data.Hour * 3600 + GPS_Data.Minute * 60 + GPS_Data.Second;
-                break;
-            // 其他字段可根据需要解析
-            // Other fields can be parsed as needed
-            default:
-                break;
-        }
-        token = strtok(NULL, ",");
+void Parse_GNGGA(const nmea_sentence_t *sentence) {
+    // 时间与GNRMC中的时间对比，确定两者属于同一次定位
+    // Time is compared with GNRMC time to pair both sentences of one fix
+    uint8_t hour, minute, second;
+    uint16_t millisecond;
+    if (nmea_field_time(sentence, GGA_FIELD_TIME, &hour, &minute, &second, &millisecond)) {
+        gga_time_ms = time_of_day_ms(hour, minute, second, millisecond);
+        last_sentence_time_ms = gga_time_ms;
+    } else {
+        gga_time_ms = -1;
+    }
+
+    // 纬度及方向
+    // Latitude and direction
+    int32_t latitude;
+    char lat_indicator = nmea_field_char(sentence, GGA_FIELD_LAT_HEMISPHERE);
+    if (nmea_field_degrees_e7(sentence, GGA_FIELD_LATITUDE, &latitude) && lat_indicator != '\0') {
+        GPS_Data.Lat_Indicator = lat_indicator;
+        GPS_Data.GGA_Latitude_e7 = (lat_indicator == 'S') ? -latitude : latitude;
     }
+
+    // 经度及方向
+    // Longitude and direction
+    int32_t longitude;
+    char lon_indicator = nmea_field_char(sentence, GGA_FIELD_LON_HEMISPHERE);
+    if (nmea_field_degrees_e7(sentence, GGA_FIELD_LONGITUDE, &longitude) && lon_indicator != '\0') {
+        GPS_Data.Lon_Indicator = lon_indicator;
+        GPS_Data.GGA_Longitude_e7 = (lon_indicator == 'W') ? -longitude : longitude;
+    }
+
+    // 定位质量，字段为空视为无效
+    // Position fix quality, an empty field counts as invalid
+    int32_t quality;
+    GPS_Data.GGA_Valid = (nmea_field_int(sentence, GGA_FIELD_QUALITY, &quality) && quality > 0) ? 1 : 0;
+
+    // 可见卫星数量
+    // Number of satellites in view
+    int32_t satellites;
+    if (nmea_field_int(sentence, GGA_FIELD_SATELLITES, &satellites)) {
+        GPS_Data.Num_Satellites = (uint8_t)satellites;
+    }
+
+    // HDOP (0.01)，没有 GSA/GST 时用于估计位置误差
+    // HDOP (0.01), estimates the position error when there is no GSA/GST
+    receiver_accuracy.gga_time_ms = -1;
+    if (gga_time_ms >= 0 && nmea_field_fixed(sentence, GGA_FIELD_HDOP, 2, &receiver_accuracy.gga_hdop_x100)) {
+        receiver_accuracy.gga_time_ms = gga_time_ms;
+    }
+
+    // 海拔高度 (毫米)
+    // Altitude (millimeters)
+    nmea_field_fixed(sentence, GGA_FIELD_ALTITUDE, 3, &GPS_Data.GGA_Altitude_mm);
 }
 
 /**
- * @brief 解析 NMEA 缓冲区中的所有语句
- *        Parse all sentences in NMEA buffer
- * 
- * 遍历缓冲区中的每一行，识别并解析 GNRMC 和 GNGGA 语句。
- * Traverse each line in the buffer, identify and parse GNRMC and GNGGA sentences.
- * 
- * @param buffer 包含 NMEA 语句的缓冲区
- *               Buffer containing NMEA sentences
+ * @brief Parse GSA sentence, e.g.: $GNGSA,A,3,05,12,15,18,24,25,,,,,,,1.60,1.00,1.30,1*0F
+ *        解析 GSA 语句，例如：$GNGSA,A,3,05,12,15,18,24,25,,,,,,,1.60,1.00,1.30,1*0F
+ *
+ * Takes the PDOP, HDOP and VDOP of the position solution. With several constellations one GSA
+ * is sent per constellation, all with the same DOPs, so the last one wins.
+ * 提取定位解的 PDOP、HDOP 与 VDOP。多星座时每个星座各有一条 GSA，其 DOP 相同，以最后一条为准。
+ *
+ * @param sentence Tokenized GSA sentence
+ *                 已分词的 GSA 语句
  */
-void Parse_NMEA_Buffer(char *buffer) {
-    init_gps_data();
+void Parse_GNGSA(const nmea_sentence_t *sentence) {
+    // 定位类型：1 无定位，2 二维，3 三维
+    // Fix type: 1 no fix, 2 2D, 3 3D
+    int32_t fix_type;
+    if (!nmea_field_int(sentence, GSA_FIELD_FIX_TYPE, &fix_type) || fix_type < 2 || last_sentence_time_ms < 0) {
+        return;
+    }
+    if (!nmea_field_fixed(sentence, GSA_FIELD_HDOP, 2, &receiver_accuracy.hdop_x100)) {
+        return;
+    }
+    nmea_field_fixed(sentence, GSA_FIELD_PDOP, 2, &receiver_accuracy.pdop_x100);
+    if (fix_type < 3 || !nmea_field_fixed(sentence, GSA_FIELD_VDOP, 2, &receiver_accuracy.vdop_x100)) {
+        receiver_accuracy.vdop_x100 = 0;
+    }
+    receiver_accuracy.gsa_time_ms = last_sentence_time_ms;
+}
 
-    char *start = buffer; // 指向字符串的开始
-                          // Points to the start of string
-    char *end = NULL;     // 指向每行的结束位置
-                          // Points to the end of each line
-
-    while ((end = strchr(start, '\n')) != NULL) {
-        size_t line_length = end - start; // 计算每行的长度
-                                          // Calculate length of each line
-
-        if (line_length > 0) {
-            char line[RX_BUF_SIZE] = {0}; // 创建一个临时缓冲区存储单行
-                                          // Create a temporary buffer to store single line
-            strncpy(line, start, line_length); // 将该行拷贝到缓冲区
-                                               // Copy the line to buffer
-            line[line_length] = '\0'; // 确保以空字符结尾
-                                      // Ensure null-terminated string
-
-            // 解析该行
-            // Parse the line
-            if (strncmp(line, "$GNRMC", 6) == 0 || strncmp(line, "$GPRMC", 6) == 0) {
-                Parse_GNRMC(line);
-            } else if (strncmp(line, "$GNGGA", 6) == 0 || strncmp(line, "$GPGGA", 6) == 0) {
-                Parse_GNGGA(line);
-            }
-        }
+/**
+ * @brief Parse GST sentence, e.g.: $GNGST,074700.000,3.0,2.2,1.4,35.0,1.5,1.9,3.4*46
+ *        解析 GST 语句，例如：$GNGST,074700.000,3.0,2.2,1.4,35.0,1.5,1.9,3.4*46
+ *
+ * Takes the 1 sigma latitude, longitude and altitude errors; the error ellipse itself is not needed
+ * once the per-axis sigmas are known.
+ * 提取纬度、经度与高度的 1 sigma 误差；已知各轴 sigma 后无需误差椭圆本身。
+ *
+ * @param sentence Tokenized GST sentence
+ *                 已分词的 GST 语句
+ */
+void Parse_GNGST(const nmea_sentence_t *sentence) {
+    uint8_t hour, minute, second;
+    uint16_t millisecond;
+    int32_t latitude_sigma, longitude_sigma, altitude_sigma;
+    if (!nmea_field_time(sentence, GST_FIELD_TIME, &hour, &minute, &second, &millisecond) ||
+        !nmea_field_fixed(sentence, GST_FIELD_LATITUDE_SIGMA, 3, &latitude_sigma) ||
+        !nmea_field_fixed(sentence, GST_FIELD_LONGITUDE_SIGMA, 3, &longitude_sigma) ||
+        !nmea_field_fixed(sentence, GST_FIELD_ALTITUDE_SIGMA, 3, &altitude_sigma)) {
+        return;
+    }
+    receiver_accuracy.latitude_sigma_mm = latitude_sigma;
+    receiver_accuracy.longitude_sigma_mm = longitude_sigma;
+    receiver_accuracy.altitude_sigma_mm = altitude_sigma;
+    receiver_accuracy.gst_time_ms = time_of_day_ms(hour, minute, second, millisecond);
+}
 
-        start = end + 1; // 移动到下一行的开始
-                         // Move to the start of next line
+/**
+ * @brief 滤波一次有效定位的测量值，并写入最终状态和位置
+ *        Filter the measurement of one valid fix and write the final status and position
+ */
+static void apply_gps_measurement(const gps_filter_measurement_t *measurement) {
+    __atomic_store_n(&gps_invalid_count, 0, __ATOMIC_RELAXED);  // 重置计数器
+                                                                // Reset counter
+
+    // 滤波器按预测协方差剔除异常值，快速但连续的运动不会被剔除
+    // The filter gates outliers on the predicted covariance, so fast but consistent motion is kept
+    gps_filter_output_t filtered;
+    GPS_Data.Status = (gps_filter_update(&gps_filter, measurement, &filtered) == 0) ? 1 : 0;
+
+    GPS_Data.Latitude_e7 = filtered.latitude_e7;
+    GPS_Data.Longitude_e7 = filtered.longitude_e7;
+    GPS_Data.Altitude_mm = filtered.altitude_mm;
+    GPS_Data.Velocity_North = filtered.velocity_north;
+    GPS_Data.Velocity_East = filtered.velocity_east;
+    GPS_Data.Velocity_Descend = filtered.velocity_descend;
+    GPS_Data.Horizontal_Accuracy_mm = filtered.horizontal_accuracy_mm;
+    GPS_Data.Vertical_Accuracy_mm = filtered.vertical_accuracy_mm;
+    GPS_Data.Speed_Accuracy_cm_s = filtered.speed_accuracy_cm_s;
+
+    // 定位完整后才对其他任务可见
+    // Only a complete fix becomes visible to other tasks
+    gps_snapshot_publish(&gps_snapshot, &GPS_Data);
+}
+
+/**
+ * @brief 记录一次无效定位
+ *        Record a fix without a valid position
+ */
+static void mark_gps_fix_invalid(void) {
+    GPS_Data.Status = 0;
+    if (gps_invalid_count < UINT8_MAX) {  // 防止溢出
+                                          // Prevent overflow
+        __atomic_store_n(&gps_invalid_count, (uint8_t)(gps_invalid_count + 1), __ATOMIC_RELAXED);
     }
+    gps_snapshot_publish(&gps_snapshot, &GPS_Data);
+}
 
-    // 处理最后一行（如果没有以换行符结尾）
-    // Process the last line (if not ending with newline)
-    if (*start != '\0') {
-        if (strncmp(start, "$GNRMC", 6) == 0 || strncmp(start, "$GPRMC", 6) == 0) {
-            Parse_GNRMC(start);
-        } else if (strncmp(start, "$GNGGA", 6) == 0 || strncmp(start, "$GPGGA", 6) == 0) {
-            Parse_GNGGA(start);
-        }
+/**
+ * @brief 同一次定位的 RMC 与 GGA 都已解析后，合并为最终状态和位置
+ *        Combine the RMC and GGA of one fix into the final status and position
+ */
+static void complete_gps_fix(void) {
+    // RMC 与 GGA 均已解析，更新最终状态和位置数据
+    // Both RMC and GGA are parsed, update final status and position data
+    if (!GPS_Data.RMC_Valid || !GPS_Data.GGA_Valid) {
+        mark_gps_fix_invalid();
+        return;
     }
 
-    // 在所有语句解析完成后，更新最终状态和位置数据
-    // After parsing all sentences, update final status and position data
-    if (GPS_Data.RMC_Valid && GPS_Data.GGA_Valid) {
-        GPS_Data.Status = 1;
-        gps_invalid_count = 0;  // 重置计数器
-                                // Reset counter
-        // 计算平均值
-        // Calculate average
-        GPS_Data.Latitude = (GPS_Data.RMC_Latitude + GPS_Data.GGA_Latitude) / 2.0;
-        GPS_Data.Longitude = (GPS_Data.RMC_Longitude + GPS_Data.GGA_Longitude) / 2.0;
-
-        // 与前一时刻的纬度和经度做对比
-        // Compare with previous latitude and longitude
-        if (fabs(GPS_Data.Latitude - Previous_Latitude) > 0.009 || fabs(GPS_Data.Longitude - Previous_Longitude) > 0.0127) {
-            // 超过阈值，剔除异常值并更新前一时刻经纬度
-            // If the change exceeds threshold, set status to 0 and update the previous latitude and longitude
-            GPS_Data.Status = 0;
-        }
+    // RMC 与 GGA 位置取平均作为本次测量
+    // The mean of the RMC and GGA positions is this fix's measurement
+    gps_filter_measurement_t measurement = {
+        .time_ms = gga_time_ms,
+        .latitude_e7 = (int32_t)(((int64_t)GPS_Data.RMC_Latitude_e7 + GPS_Data.GGA_Latitude_e7) / 2),
+        .longitude_e7 = (int32_t)(((int64_t)GPS_Data.RMC_Longitude_e7 + GPS_Data.GGA_Longitude_e7) / 2),
+        .altitude_mm = GPS_Data.GGA_Altitude_mm,
+        .has_velocity = true,
+        .velocity_north = GPS_Data.RMC_Velocity_North,
+        .velocity_east = GPS_Data.RMC_Velocity_East,
+        .speed_sigma_m_s = GPS_FILTER_SPEED_SIGMA_M_S,
+    };
 
-        // 更新前一时刻的经纬度
-        // Update the previous latitude and longitude
-        Previous_Latitude = GPS_Data.Latitude;
-        Previous_Longitude = GPS_Data.Longitude;
-    } else {
-        GPS_Data.Status = 0;
-        if (gps_invalid_count < UINT8_MAX) {  // 防止溢出
-                                              // Prevent overflow
-            gps_invalid_count++;
+    // 位置 sigma 取自接收机的 GST 误差或 DOP，二者都没有时使用默认值
+    // Position sigmas come from the receiver's GST errors or DOPs, the defaults apply without either
+    gps_filter_measurement_sigmas(&receiver_accuracy, &measurement);
+    apply_gps_measurement(&measurement);
+}
+
+/**
+ * @brief Dispatch one tokenized sentence on its talker and sentence ID
+ *        按发送方和语句类型分发一条已分词的语句
+ *
+ * A fix is complete once an RMC and a GGA with the same UTC time have both been seen, in either order,
+ * and a valid fix is published at once. Publishing only overwrites the push mailbox, so it never blocks
+ * the parser.
+ * 收到 UTC 时间相同的 RMC 与 GGA（顺序不限）后，一次定位即完成，有效定位立即发布。
+ * 发布只覆盖推送信箱，不会阻塞解析。
+ */
+static void handle_nmea_sentence(const nmea_sentence_t *sentence, void *ctx) {
+    if (!nmea_talker_is_gnss(sentence)) {
+        return;
+    }
+    switch (sentence->id) {
+        case NMEA_SENTENCE_RMC:
+            Parse_GNRMC(sentence);
+            break;
+        case NMEA_SENTENCE_GGA:
+            Parse_GNGGA(sentence);
+            break;
+        // 误差估计在同一次扫描中解析，不会再遍历缓冲区
+        // Error estimates are parsed in the same scan, the buffer is not walked again
+        case NMEA_SENTENCE_GSA:
+            Parse_GNGSA(sentence);
+            return;
+        case NMEA_SENTENCE_GST:
+            Parse_GNGST(sentence);
+            return;
+        default:
+            return;
+    }
+    if (rmc_time_ms >= 0 && rmc_time_ms == gga_time_ms) {
+        complete_gps_fix();
+        rmc_time_ms = -1;
+        gga_time_ms = -1;
+        if (GPS_Data.Status == 1) {
+            gps_push_data();
         }
     }
 }
 
+/**
+ * @brief 解析从 UART 读到的 NMEA 数据
+ *        Parse NMEA data read from the UART
+ * 
+ * 数据可在任意位置被拆分：完整行直接在缓冲区上解析，未结束的语句保留到下一次调用补齐。
+ * 校验和错误或缺失的语句在分词时即被丢弃，不会修改 GPS 数据。
+ * Data may be split anywhere: complete lines are parsed in place, an unfinished sentence is kept
+ * until the next call completes it. Sentences with a wrong or missing checksum are dropped while
+ * tokenizing and never touch the GPS data.
+ * 
+ * @param buffer 从 UART 读到的数据，无需以 NUL 结尾
+ *               Data read from the UART, does not need to be NUL terminated
+ * @param length 缓冲区字节数
+ *               Bytes in buffer
+ */
+void Parse_NMEA_Buffer(const char *buffer, size_t length) {
+    nmea_assembler_feed(&nmea_assembler, buffer, length, handle_nmea_sentence, NULL);
+}
+
+/**
+ * @brief 获取 NMEA 语句的校验统计
+ *        Get checksum counters of the NMEA sentences received
+ *
+ * @param good 校验通过并已解析的语句数
+ *             Sentences whose checksum matched and were parsed
+ * @param bad 校验不匹配而丢弃的语句数
+ *            Sentences dropped for a checksum mismatch
+ * @param truncated 缺少完整校验字段而丢弃的语句数
+ *                  Sentences dropped for lacking a complete checksum
+ */
+void get_nmea_checksum_stats(uint32_t *good, uint32_t *bad, uint32_t *truncated) {
+    *good = nmea_assembler.checksum.good;
+    *bad = nmea_assembler.checksum.bad;
+    *truncated = nmea_assembler.checksum.truncated;
+}
+
+/**
+ * @brief 获取位置滤波器的统计
+ *        Get counters of the position filter
+ *
+ * @param accepted 被滤波器接受的定位数
+ *                 Fixes accepted by the filter
+ * @param rejected 被门限剔除的定位数
+ *                 Fixes rejected by the gate
+ * @param restarts 滤波器重新初始化的次数
+ *                 Times the filter restarted
+ */
+void get_gps_filter_stats(uint32_t *accepted, uint32_t *rejected, uint32_t *restarts) {
+    *accepted = gps_filter.accepted;
+    *rejected = gps_filter.rejected;
+    *restarts = gps_filter.restarts;
+}
+
 /**
  * @brief 打印当前的 GPS 数据
  *        Print current GPS data
@@ -490,42 +583,60 @@ void Parse_NMEA_Buffer(char *buffer) {
  */
 void print_gps_data() {
     ESP_LOGI(TAG, 
-        "GPS Data: Time=%02d:%02d:%06.3f, Date=%02d-%02d-20%02d, "
-        "Lat=%f %c, Lon=%f %c, Speed=%.2f knots, Course=%.2f deg, "
-        "Altitude=%.2f m, Satellites=%d, V_North=%.2f m/s, V_East=%.2f m/s, V_Descend=%.2f m/s",
-        GPS_Data.Hour, GPS_Data.Minute, GPS_Data.Second,
+        "GPS Data: Time=%02d:%02d:%02d.%03d, Date=%02d-%02d-20%02d, "
+        "Lat=%ld e-7 deg %c, Lon=%ld e-7 deg %c, Speed=%ld e-3 knots, Course=%ld e-2 deg, "
+        "Altitude=%ld mm, Satellites=%d, V_North=%.2f m/s, V_East=%.2f m/s, V_Descend=%.2f m/s",
+        GPS_Data.Hour, GPS_Data.Minute, GPS_Data.Second, GPS_Data.Millisecond,
         GPS_Data.Day, GPS_Data.Month, GPS_Data.Year,
-        GPS_Data.Latitude, GPS_Data.Lat_Indicator,
-        GPS_Data.Longitude, GPS_Data.Lon_Indicator,
-        GPS_Data.Speed_knots, GPS_Data.Course,
-        GPS_Data.Altitude, GPS_Data.Num_Satellites,
+        (long)GPS_Data.Latitude_e7, GPS_Data.Lat_Indicator,
+        (long)GPS_Data.Longitude_e7, GPS_Data.Lon_Indicator,
+        (long)GPS_Data.Speed_mknots, (long)GPS_Data.Course_cdeg,
+        (long)GPS_Data.Altitude_mm, GPS_Data.Num_Satellites,
         GPS_Data.Velocity_North, GPS_Data.Velocity_East,
         GPS_Data.Velocity_Descend
     );
 }
 
 /**
- * @brief 推送 GPS 数据到相机
- *        Push GPS data to camera
+ * @brief 发送一帧 GPS 数据到相机，由推送调度任务调用
+ *        Send one GPS frame to the camera, called from the push scheduler task
+ *
+ * @return int 已发送返回 0，未连接相机返回 -1
+ *             0 if sent, -1 if the camera is not connected
+ */
+static int send_gps_frame(const gps_data_push_command_frame *gps_frame) {
+    if (connect_logic_get_state() != PROTOCOL_CONNECTED) {
+        return -1;
+    }
+    // 推送期间链路保持流式配置
+    // Keep the link in the streaming profile while pushing
+    connect_logic_note_activity(LINK_ACTIVITY_GPS);
+
+    // 推送 GPS 数据到相机，无应答，始终返回 NULL
+    // Push GPS data to camera, no response, always returns NULL
+    (void)command_logic_push_gps_data(gps_frame);
+    return 0;
+}
+
+/**
+ * @brief 发布 GPS 数据，等待推送到相机
+ *        Publish GPS data for pushing to the camera
  * 
- * 将当前的 GPS 数据转换为指定格式，并通过命令逻辑推送到相机。
- * Convert current GPS data to specified format and push to camera through command logic.
+ * 将当前的 GPS 数据转换为指定格式并放入推送信箱，不等待 BLE 发送；推送调度任务按设定频率发送最新的一帧。
+ * Convert current GPS data to specified format and put it in the push mailbox without waiting for BLE;
+ * the push scheduler task sends the newest frame at the configured rate.
  */
 void gps_push_data() {
     // 时间转换
     // Time conversion
     int32_t year_month_day = (GPS_Data.Year + 2000) * 10000 + GPS_Data.Month * 100 + GPS_Data.Day;
-    int32_t hour_minute_second = (GPS_Data.Hour + 8) * 10000 + GPS_Data.Minute * 100 + (int32_t)GPS_Data.Second;
+    int32_t hour_minute_second = (GPS_Data.Hour + 8) * 10000 + GPS_Data.Minute * 100 + GPS_Data.Second;
 
-    // 经纬度转换
-    // Longitude and latitude conversion
-    int32_t gps_longitude = (int32_t)(GPS_Data.Longitude * 1e7);
-    int32_t gps_latitude = (int32_t)(GPS_Data.Latitude * 1e7);
-
-    // 高度转换
-    // Height conversion
-    int32_t height = (int32_t)(GPS_Data.Altitude * 1000);    // 单位 mm
-                                                             // Unit: mm
+    // 经纬度已是 1e-7 度，高度已是 mm，无需转换
+    // Longitude and latitude are already in 1e-7 degrees and height in mm, no conversion needed
+    int32_t gps_longitude = GPS_Data.Longitude_e7;
+    int32_t gps_latitude = GPS_Data.Latitude_e7;
+    int32_t height = GPS_Data.Altitude_mm;
 
     // 速度转换
     // Speed conversion
@@ -563,21 +674,150 @@ void gps_push_data() {
         .speed_to_north = speed_to_north,
         .speed_to_east = speed_to_east,
         .speed_to_wnward = speed_to_wnward,
-        .vertical_accuracy = 1000,    // 垂直默认精度为 1000 mm
-                                      // Default vertical accuracy is 1000 mm
-        .horizontal_accuracy = 1000,  // 水平精度为 1000 mm
-                                      // Horizontal accuracy is 1000 mm
-        .speed_accuracy = 10,         // 速度精度为 10 cm/s
-                                      // Speed accuracy is 10 cm/s
+        .vertical_accuracy = GPS_Data.Vertical_Accuracy_mm,      // 滤波器给出的精度 (mm)
+                                                                 // Accuracy from the filter (mm)
+        .horizontal_accuracy = GPS_Data.Horizontal_Accuracy_mm,
+        .speed_accuracy = GPS_Data.Speed_Accuracy_cm_s,          // cm/s
         .satellite_number = satellite_number
     };
 
-    // 推送 GPS 数据到相机，无应答，默认返回 NULL
-    // Push GPS data to camera, no response, returns NULL by default
-    gps_data_push_response_frame *response = command_logic_push_gps_data(&gps_frame);
-    if (response != NULL) {
-        free(response);
+    // 放入推送信箱，覆盖尚未发送的旧帧
+    // Put it in the push mailbox, replacing an older frame not sent yet
+    gps_push_publish(&gps_frame);
+}
+
+#if CONFIG_GPS_INPUT_UBX
+// 超过这么久没有 NAV-PVT 即重新解析 NMEA，例如接收机未接受 UBX 配置
+// Without a NAV-PVT for this long NMEA is parsed again, e.g. when the receiver ignored the UBX configuration
+#define GPS_UBX_FALLBACK_MS 3000
+
+// 组装跨 UART 读取被拆分的 UBX 帧
+// Reassembles UBX frames split across UART reads
+static ubx_decoder_t ubx_decoder;
+
+// 最近一个 NAV-PVT 的到达时刻，决定是否回退到 NMEA
+// Arrival of the last NAV-PVT, decides whether to fall back to NMEA
+static TickType_t ubx_last_frame_tick;
+static bool ubx_frame_seen = false;
+static bool ubx_stream_was_active = false;
+
+// CFG-VALSET 负载，写入 RAM 层：10 Hz 测量，UART1 每个历元输出 NAV-PVT，只输出 UBX
+// CFG-VALSET payload for the RAM layer: 10 Hz measurements, NAV-PVT on UART1 every epoch, UBX output only
+static const uint8_t ubx_config_payload[] = {
+    0x00, 0x01, 0x00, 0x00,             // version 0, RAM layer, reserved
+    0x01, 0x00, 0x21, 0x30, 0x64, 0x00, // CFG-RATE-MEAS = 100 ms
+    0x07, 0x00, 0x91, 0x20, 0x01,       // CFG-MSGOUT-UBX_NAV_PVT_UART1 = 1
+    0x01, 0x00, 0x74, 0x10, 0x01,       // CFG-UART1OUTPROT-UBX = 1
+    0x02, 0x00, 0x74, 0x10, 0x00,       // CFG-UART1OUTPROT-NMEA = 0
+};
+
+/**
+ * @brief 将一个 NAV-PVT 解码为一次定位，替代同一历元的 RMC 与 GGA
+ *        Decode a NAV-PVT into one fix, in place of the RMC and GGA of that epoch
+ *
+ * 数值已是二进制整数，只需换算单位；接收机自身的精度估计按 GST 误差交给滤波器。
+ * The values are already binary integers and only need unit conversions; the receiver's own accuracy
+ * estimates go to the filter the way GST errors do.
+ */
+static void handle_ubx_frame(const ubx_frame_t *frame, void *ctx) {
+    ubx_nav_pvt_t pvt;
+    if (ubx_parse_nav_pvt(frame, &pvt) != 0) {
+        return;
+    }
+    ubx_frame_seen = true;
+    ubx_last_frame_tick = xTaskGetTickCount();
+
+    if (!ubx_nav_pvt_fix_ok(&pvt)) {
+        mark_gps_fix_invalid();
+        return;
     }
+
+    // 周内时的毫秒部分即 UTC 毫秒，闰秒为整秒
+    // The ms of the time of week are the UTC ms, leap seconds being whole seconds
+    GPS_Data.Year = (uint8_t)(pvt.year % 100);
+    GPS_Data.Month = pvt.month;
+    GPS_Data.Day = pvt.day;
+    GPS_Data.Hour = pvt.hour;
+    GPS_Data.Minute = pvt.minute;
+    GPS_Data.Second = pvt.second;
+    GPS_Data.Millisecond = (uint16_t)(pvt.itow_ms % 1000);
+    GPS_Data.Lat_Indicator = pvt.latitude_e7 < 0 ? 'S' : 'N';
+    GPS_Data.Lon_Indicator = pvt.longitude_e7 < 0 ? 'W' : 'E';
+    GPS_Data.Speed_mknots = (int32_t)((int64_t)pvt.ground_speed_mm_s * 1943844 / 1000000);  // mm/s 转 0.001 节
+                                                                                              // mm/s to 0.001 knots
+    GPS_Data.Course_cdeg = pvt.heading_motion_e5 / 1000;
+    GPS_Data.Num_Satellites = pvt.num_sv;
+
+    int32_t time_ms = time_of_day_ms(pvt.hour, pvt.minute, pvt.second, GPS_Data.Millisecond);
+    uint32_t horizontal_mm = pvt.horizontal_accuracy_mm > INT32_MAX ? INT32_MAX : pvt.horizontal_accuracy_mm;
+    uint32_t vertical_mm = pvt.vertical_accuracy_mm > INT32_MAX ? INT32_MAX : pvt.vertical_accuracy_mm;
+
+    // 水平精度均分到北向与东向，各为其 1/sqrt(2)
+    // The horizontal accuracy is split evenly over north and east, 1/sqrt(2) of it each
+    receiver_accuracy.gst_time_ms = time_ms;
+    receiver_accuracy.latitude_sigma_mm = (int32_t)((uint64_t)horizontal_mm * 7071 / 10000);
+    receiver_accuracy.longitude_sigma_mm = receiver_accuracy.latitude_sigma_mm;
+    receiver_accuracy.altitude_sigma_mm = (int32_t)vertical_mm;
+
+    gps_filter_measurement_t measurement = {
+        .time_ms = time_ms,
+        .latitude_e7 = pvt.latitude_e7,
+        .longitude_e7 = pvt.longitude_e7,
+        .altitude_mm = pvt.height_msl_mm,
+        .has_velocity = true,
+        .velocity_north = (float)pvt.velocity_north_mm_s * 1e-3f,
+        .velocity_east = (float)pvt.velocity_east_mm_s * 1e-3f,
+        .speed_sigma_m_s = (float)pvt.speed_accuracy_mm_s * 1e-3f,
+    };
+    gps_filter_measurement_sigmas(&receiver_accuracy, &measurement);
+    apply_gps_measurement(&measurement);
+
+    if (GPS_Data.Status == 1) {
+        gps_push_data();
+    }
+}
+
+/**
+ * @brief 切换接收机为 UBX NAV-PVT 输出
+ *        Switch the receiver to UBX NAV-PVT output
+ */
+static void send_ubx_config(void) {
+    uint8_t frame[sizeof(ubx_config_payload) + UBX_FRAME_OVERHEAD];
+    size_t length = ubx_build_frame(UBX_CLASS_CFG, UBX_ID_CFG_VALSET, ubx_config_payload,
+                                    sizeof(ubx_config_payload), frame, sizeof(frame));
+    uart_write_bytes(UART_GPS_PORT, frame, length);
+}
+
+/**
+ * @brief NAV-PVT 是否仍在按时到达
+ *        Whether NAV-PVT frames are still arriving
+ */
+static bool ubx_stream_active(void) {
+    return ubx_frame_seen && (xTaskGetTickCount() - ubx_last_frame_tick) < pdMS_TO_TICKS(GPS_UBX_FALLBACK_MS);
+}
+#endif
+
+/**
+ * @brief 将 UART 数据交给解码器
+ *        Hand UART data to the decoders
+ *
+ * 启用 UBX 时先交给 UBX 解码器；NAV-PVT 按时到达期间不再解析 NMEA，停止到达后回退到 NMEA。
+ * With UBX enabled the data goes to the UBX decoder first; NMEA is not parsed while NAV-PVT frames
+ * keep arriving, and parsing falls back to NMEA once they stop.
+ */
+static void parse_gps_bytes(const uint8_t *data, size_t length) {
+#if CONFIG_GPS_INPUT_UBX
+    ubx_decoder_feed(&ubx_decoder, data, length, handle_ubx_frame, NULL);
+    bool active = ubx_stream_active();
+    if (active != ubx_stream_was_active) {
+        ubx_stream_was_active = active;
+        ESP_LOGI(TAG, "GPS input: %s", active ? "UBX NAV-PVT" : "NMEA");
+    }
+    if (active) {
+        return;
+    }
+#endif
+    Parse_NMEA_Buffer((const char *)data, length);
 }
 
 /**
@@ -599,17 +839,46 @@ static void initUartGps(void)
         .source_clk = LP_UART_SCLK_DEFAULT,     //LP UART
     };
     // We won't use a buffer for sending data.
-    uart_driver_install(UART_GPS_PORT, RX_BUF_SIZE * 2, 0, 0, NULL, 0);
+    uart_driver_install(UART_GPS_PORT, RX_BUF_SIZE * 2, 0, GPS_UART_QUEUE_LENGTH, &gps_uart_queue, 0);
     uart_param_config(UART_GPS_PORT, &uart_config);
     uart_set_pin(UART_GPS_PORT, UART_GPS_TXD_PIN, UART_GPS_RXD_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+
+#if !CONFIG_GPS_INPUT_UBX
+    // 每收到一个 '\n' 产生一次 UART_PATTERN_DET 事件，按语句到达唤醒接收任务
+    // Raise a UART_PATTERN_DET event for every '\n', so the receive task wakes per sentence
+    uart_enable_pattern_det_baud_intr(UART_GPS_PORT, '\n', 1, 9, 0, 0);
+    uart_pattern_queue_reset(UART_GPS_PORT, GPS_PATTERN_QUEUE_LENGTH);
+#endif
+}
+
+/**
+ * @brief 读取 UART 中已缓存的数据并送入语句拼接器
+ *        Read data buffered in the UART and feed it to the sentence assembler
+ *
+ * @param data 读缓冲区，RX_BUF_SIZE 字节
+ *             Read buffer, RX_BUF_SIZE bytes
+ * @param length 需要读取的字节数
+ *               Bytes to read
+ */
+static void read_and_parse(uint8_t *data, size_t length) {
+    while (length > 0) {
+        size_t chunk = length < RX_BUF_SIZE ? length : RX_BUF_SIZE;
+        int rxBytes = uart_read_bytes(UART_GPS_PORT, data, chunk, 0);
+        if (rxBytes <= 0) {
+            break;
+        }
+        parse_gps_bytes(data, (size_t)rxBytes);
+        length -= (size_t)rxBytes;
+    }
 }
 
 /**
  * @brief GPS 数据接收任务
  *        GPS data receiving task
  * 
- * 从 GPS UART 端口读取数据，解析并处理 NMEA 数据。
- * Read data from GPS UART port, parse and process NMEA data.
+ * 阻塞等待 UART 事件，每收到一行就读取到 '\n' 为止并解析，定位完成后由解析器立即发布，不再依赖固定延时。
+ * Block on UART events, read up to each '\n' as it arrives and parse it; the parser publishes as soon
+ * as a fix is complete instead of relying on fixed delays.
  * 
  * @param arg 任务参数
  *            Task parameters
@@ -617,45 +886,55 @@ static void initUartGps(void)
 static void rx_task_GPS(void *arg)
 {
     static const char *RX_TASK_TAG = "RX_TASK_GPS";
-    uint8_t* data = (uint8_t*) malloc(RX_BUF_SIZE + 1);
+    uint8_t* data = (uint8_t*) malloc(RX_BUF_SIZE);
+    uart_event_t event;
 
     while (1) {
-        const int rxBytes = uart_read_bytes(UART_GPS_PORT, data, RX_BUF_SIZE, 20 / portTICK_PERIOD_MS);
-        if (rxBytes > 0) {
-            // 给看门狗喂狗的机会
-            // Give watchdog a chance to reset
-            vTaskDelay(pdMS_TO_TICKS(5));
-
-            data[rxBytes] = '\0';
-
-            // ESP_LOGI(RX_TASK_TAG, "Read %d bytes: '%s'", rxBytes, data);
-
-            // 将读取到的数据存储到全局缓冲区 buff_t 中
-            // Store the read data into global buffer buff_t
-            memcpy(buff_t, data, rxBytes);
-            buff_t[rxBytes] = '\0'; // 确保缓冲区结束
-                                    // Ensure buffer termination
-
-            // 解析数据
-            // Parse data
-            Parse_NMEA_Buffer(buff_t);
-
-            // 给看门狗喂狗的机会
-            // Give watchdog a chance to reset
-            vTaskDelay(pdMS_TO_TICKS(5));
-
-            // 打印解析后的GPS数据
-            // Print parsed GPS data
-            // print_gps_data();
-
-            if(connect_logic_get_state() == PROTOCOL_CONNECTED && is_current_gps_data_valid()){
-                gps_push_data();
+        if (xQueueReceive(gps_uart_queue, &event, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
 
+        switch (event.type) {
+            case UART_PATTERN_DET: {
+                // 读取到 '\n' 为止；位置队列溢出时读取全部缓存数据，由拼接器处理拆分
+                // Read through the '\n'; if the position queue overflowed read everything buffered,
+                // the assembler copes with the split
+                int pos = uart_pattern_pop_pos(UART_GPS_PORT);
+                size_t buffered = 0;
+                uart_get_buffered_data_len(UART_GPS_PORT, &buffered);
+                read_and_parse(data, pos >= 0 ? (size_t)pos + 1 : buffered);
+                break;
+            }
+#if CONFIG_GPS_INPUT_UBX
+            case UART_DATA: {
+                // 二进制帧中没有可用的行尾，按到达的数据读取，由解码器处理拆分
+                // Binary frames have no line end to detect, read what arrived and let the decoders cope with the split
+                size_t buffered = 0;
+                uart_get_buffered_data_len(UART_GPS_PORT, &buffered);
+                read_and_parse(data, buffered);
+                break;
             }
+#endif
+            case UART_FIFO_OVF:
+            case UART_BUFFER_FULL:
+                // 数据已丢失，清空并从下一行重新开始
+                // Data was lost, flush and restart at the next line
+                ESP_LOGW(RX_TASK_TAG, "UART overflow, flushing");
+                uart_flush_input(UART_GPS_PORT);
+                xQueueReset(gps_uart_queue);
+                uart_pattern_queue_reset(UART_GPS_PORT, GPS_PATTERN_QUEUE_LENGTH);
+                nmea_assembler_reset(&nmea_assembler);
+#if CONFIG_GPS_INPUT_UBX
+                ubx_decoder_reset(&ubx_decoder);
+#endif
+                break;
+            default:
+                break;
         }
-        // 如果没有数据读取，休眠一小段时间，避免任务占用 CPU
-        // If no data is read, sleep for a short time to avoid CPU occupation
-        vTaskDelay(pdMS_TO_TICKS(10));
+
+        // 打印解析后的GPS数据
+        // Print parsed GPS data
+        // print_gps_data();
     }
     free(data);
 }
@@ -668,6 +947,8 @@ static void rx_task_GPS(void *arg)
  * Initialize GPS UART and related tasks to periodically receive GPS data.
  */
 void initSendGpsDataToCameraTask(void) {
+    init_gps_data();
+    nmea_assembler_reset(&nmea_assembler);
     initUartGps();
     // "$PAIR050,1000*12\r\n" 为 1Hz 更新率
     // "$PAIR050,1000*12\r\n" for 1Hz update rate
@@ -678,7 +959,17 @@ void initSendGpsDataToCameraTask(void) {
     char* gps_command = "$PAIR050,100*22\r\n";  // （>1Hz 仅 RMC 和 GGA 支持）
                                                 // (>1Hz only RMC and GGA supported)
     uart_write_bytes(UART_GPS_PORT, gps_command, strlen(gps_command));
-    
+#if CONFIG_GPS_INPUT_UBX
+    // NMEA 命令仍然发送，接收机不支持 UBX 时按 NMEA 继续工作
+    // The NMEA command is still sent, so a receiver without UBX keeps working on NMEA
+    ubx_decoder_reset(&ubx_decoder);
+    send_ubx_config();
+#endif
+
+    if (gps_push_init(send_gps_frame) != ESP_OK) {
+        ESP_LOGE(TAG, "GPS push scheduler not started");
+    }
+
     xTaskCreate(rx_task_GPS, "uart_rx_task_GPS", 1024 * 4, NULL, 0, NULL);
     ESP_LOGI(TAG, "uart_rx_task_GPS are running\n");
 }
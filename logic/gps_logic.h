@@ -20,6 +20,7 @@
 #ifndef __GPS_LOGIC_H__
 #define __GPS_LOGIC_H__
 
+#include <stdbool.h>
 #include "driver/gpio.h"
 #include "driver/uart.h"
 #include "esp_log.h"
@@ -48,38 +49,49 @@ typedef struct {
                               // 时
     uint8_t Minute;           // Minute
                               // 分
-    double Second;            // Second
+    uint8_t Second;           // Second
                               // 秒
+    uint16_t Millisecond;     // Millisecond
+                              // 毫秒
 
     // Position
     // 位置
-    double Latitude;          // Latitude
-                              // 纬度
+    int32_t Latitude_e7;      // Filtered latitude (1e-7 degrees)
+                              // 滤波后的纬度 (1e-7 度)
     char Lat_Indicator;       // N/S
-    double Longitude;         // Longitude
-                              // 经度
+    int32_t Longitude_e7;     // Filtered longitude (1e-7 degrees)
+                              // 滤波后的经度 (1e-7 度)
     char Lon_Indicator;       // E/W
 
     // Other Information
     // 其他信息
-    double Speed_knots;       // Ground Speed (knots)
-                              // 地面速度 (节)
-    double Course;            // Course (degrees)
-                              // 航向 (度)
-    double Altitude;          // Altitude (meters)
-                              // 海拔高度 (米)
+    int32_t Speed_mknots;     // Ground Speed (0.001 knots)
+                              // 地面速度 (0.001 节)
+    int32_t Course_cdeg;      // Course (0.01 degrees)
+                              // 航向 (0.01 度)
+    int32_t Altitude_mm;      // Filtered altitude (millimeters)
+                              // 滤波后的海拔高度 (毫米)
     uint8_t Num_Satellites;   // Number of Visible Satellites
                               // 可见卫星数量
 
-    // Calculated Velocity Components
-    // 计算后的速度分量
-    double Velocity_North;    // Northward Velocity (m/s)
+    // Filtered Velocity Components
+    // 滤波后的速度分量
+    float Velocity_North;     // Northward Velocity (m/s)
                               // 向北速度 (米/秒)
-    double Velocity_East;     // Eastward Velocity (m/s)
+    float Velocity_East;      // Eastward Velocity (m/s)
                               // 向东速度 (米/秒)
-    double Velocity_Descend;  // Descent Velocity (m/s)
+    float Velocity_Descend;   // Descent Velocity (m/s)
                               // 下降速度 (米/秒)
 
+    // Accuracy of the filtered fix, from the filter covariance
+    // 滤波后定位的精度，取自滤波器协方差
+    uint32_t Horizontal_Accuracy_mm;  // Horizontal accuracy (mm)
+                                      // 水平精度 (毫米)
+    uint32_t Vertical_Accuracy_mm;    // Vertical accuracy (mm)
+                                      // 垂直精度 (毫米)
+    uint32_t Speed_Accuracy_cm_s;     // Speed accuracy (cm/s)
+                                      // 速度精度 (厘米/秒)
+
     // Status
     // 状态
     uint8_t Status;          // 1: Both RMC and GGA valid, 0: Other cases
@@ -88,14 +100,20 @@ typedef struct {
                              // RMC 数据是否有效
     uint8_t GGA_Valid;       // Whether GGA data is valid
                              // GGA 数据是否有效
-    double RMC_Latitude;     // Latitude from RMC
-                             // RMC 的纬度
-    double RMC_Longitude;    // Longitude from RMC
-                             // RMC 的经度
-    double GGA_Latitude;     // Latitude from GGA
-                             // GGA 的纬度
-    double GGA_Longitude;    // Longitude from GGA
-                             // GGA 的经度
+    int32_t RMC_Latitude_e7;  // Latitude from RMC (1e-7 degrees)
+                              // RMC 的纬度 (1e-7 度)
+    int32_t RMC_Longitude_e7; // Longitude from RMC (1e-7 degrees)
+                              // RMC 的经度 (1e-7 度)
+    int32_t GGA_Latitude_e7;  // Latitude from GGA (1e-7 degrees)
+                              // GGA 的纬度 (1e-7 度)
+    int32_t GGA_Longitude_e7; // Longitude from GGA (1e-7 degrees)
+                              // GGA 的经度 (1e-7 度)
+    int32_t GGA_Altitude_mm;  // Altitude from GGA (millimeters)
+                              // GGA 的海拔高度 (毫米)
+    float RMC_Velocity_North; // Northward velocity from RMC speed and course (m/s)
+                              // 由 RMC 速度与航向得到的向北速度 (米/秒)
+    float RMC_Velocity_East;  // Eastward velocity from RMC speed and course (m/s)
+                              // 由 RMC 速度与航向得到的向东速度 (米/秒)
 } GPS_Data_t;
 
 void initSendGpsDataToCameraTask(void);
@@ -104,4 +122,12 @@ bool is_gps_found(void);
 
 bool is_current_gps_data_valid(void);
 
+bool gps_get_fix(GPS_Data_t *out);
+
+void Parse_NMEA_Buffer(const char *buffer, size_t length);
+
+void get_nmea_checksum_stats(uint32_t *good, uint32_t *bad, uint32_t *truncated);
+
+void get_gps_filter_stats(uint32_t *accepted, uint32_t *rejected, uint32_t *restarts);
+
 #endif
\ No newline at end of file
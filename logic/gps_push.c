@@ -0,0 +1,239 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#include "gps_push.h"
+
+#define TAG "GPS_PUSH"
+
+#ifdef CONFIG_GPS_PUSH_RATE_HZ
+#undef GPS_PUSH_DEFAULT_RATE_HZ
+#define GPS_PUSH_DEFAULT_RATE_HZ CONFIG_GPS_PUSH_RATE_HZ
+#endif
+
+/* 发送任务的优先级高于 GPS 接收任务，BLE 往返期间接收任务仍可运行 */
+/* The sender runs above the GPS receive task; the receive task keeps running during a BLE round trip */
+#define GPS_PUSH_TASK_PRIORITY   1
+#define GPS_PUSH_TASK_STACK_SIZE 4096
+
+/**
+ * @brief One fix in the mailbox, stamped when the parser published it
+ *        信箱中的一个定位，带有解析器发布时的时间戳
+ */
+typedef struct {
+    gps_data_push_command_frame frame;
+    int64_t published_us;
+} gps_push_mail_t;
+
+/* Single-slot mailbox, xQueueOverwrite always leaves the newest fix in it */
+/* 单槽信箱，xQueueOverwrite 保证其中始终是最新的定位 */
+static QueueHandle_t s_mailbox = NULL;
+static TaskHandle_t s_sender_task = NULL;
+static gps_push_send_t s_send = NULL;
+static uint32_t s_rate_hz = GPS_PUSH_DEFAULT_RATE_HZ;
+
+/* Each counter has a single writer: published in the parser, the rest in the sender */
+/* 每个计数只有一个写入方：published 由解析器写入，其余由发送任务写入 */
+static uint32_t s_published = 0;
+static uint32_t s_taken = 0;
+static uint32_t s_dropped_stale = 0;
+static uint32_t s_not_sent = 0;
+
+/* Sent count and age statistics, written by the sender and copied out together under s_stats_lock */
+/* 发送计数与时长统计，由发送任务写入，在 s_stats_lock 保护下一并拷出 */
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_sent = 0;
+static uint32_t s_age_min_us = UINT32_MAX;
+static uint32_t s_age_max_us = 0;
+static uint64_t s_age_sum_us = 0;
+
+static void record_sent(int64_t age_us) {
+    uint32_t age = (age_us < 0) ? 0 : (age_us > UINT32_MAX ? UINT32_MAX : (uint32_t)age_us);
+    portENTER_CRITICAL(&s_stats_lock);
+    s_sent++;
+    if (age < s_age_min_us) {
+        s_age_min_us = age;
+    }
+    if (age > s_age_max_us) {
+        s_age_max_us = age;
+    }
+    s_age_sum_us += age;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+/**
+ * @brief Sender task: waits for a fix, keeps to the push rate, then sends the newest one
+ *        发送任务：等待定位，遵守推送频率，然后发送最新的定位
+ *
+ * The fix is only peeked while waiting for its slot, so anything the parser publishes in the
+ * meantime replaces it and the newest one is taken when the slot opens.
+ * 等待发送时机期间只窥视定位而不取出，解析器在此期间发布的定位会将其替换，时机到来时取出的就是最新的定位。
+ */
+static void gps_push_task(void *arg) {
+    gps_push_mail_t mail;
+    TickType_t last_send = xTaskGetTickCount() - pdMS_TO_TICKS(1000);
+
+    while (1) {
+        if (xQueuePeek(s_mailbox, &mail, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        uint32_t rate = __atomic_load_n(&s_rate_hz, __ATOMIC_RELAXED);
+        TickType_t period = pdMS_TO_TICKS(1000 / rate);
+        TickType_t elapsed = xTaskGetTickCount() - last_send;
+        if (elapsed < period) {
+            vTaskDelay(period - elapsed);
+        }
+
+        if (xQueueReceive(s_mailbox, &mail, 0) != pdTRUE) {
+            continue;
+        }
+        __atomic_fetch_add(&s_taken, 1, __ATOMIC_RELAXED);
+
+        if (esp_timer_get_time() - mail.published_us > (int64_t)GPS_PUSH_MAX_AGE_MS * 1000) {
+            __atomic_fetch_add(&s_dropped_stale, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        last_send = xTaskGetTickCount();
+        if (s_send(&mail.frame) != 0) {
+            __atomic_fetch_add(&s_not_sent, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+        record_sent(esp_timer_get_time() - mail.published_us);
+    }
+}
+
+/**
+ * @brief Create the mailbox and the sender task
+ *        创建信箱和发送任务
+ *
+ * @param send Called from the sender task for every fix that is due
+ *             发送任务对每个到期的定位调用此函数
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG without send, ESP_FAIL if the task or queue cannot be created
+ *                   成功返回 ESP_OK，send 为空返回 ESP_ERR_INVALID_ARG，无法创建任务或队列时返回 ESP_FAIL
+ */
+esp_err_t gps_push_init(gps_push_send_t send) {
+    if (send == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_sender_task != NULL) {
+        return ESP_OK;
+    }
+    s_send = send;
+    s_mailbox = xQueueCreate(1, sizeof(gps_push_mail_t));
+    if (s_mailbox == NULL) {
+        ESP_LOGE(TAG, "Failed to create GPS push mailbox");
+        return ESP_FAIL;
+    }
+    if (xTaskCreate(gps_push_task, "gps_push", GPS_PUSH_TASK_STACK_SIZE, NULL, GPS_PUSH_TASK_PRIORITY, &s_sender_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create GPS push task");
+        vQueueDelete(s_mailbox);
+        s_mailbox = NULL;
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "GPS push at %lu Hz", (unsigned long)s_rate_hz);
+    return ESP_OK;
+}
+
+/**
+ * @brief Publish the latest fix, never blocks
+ *        发布最新的定位，不会阻塞
+ *
+ * An unsent fix still in the mailbox is replaced and counted as coalesced.
+ * 信箱中尚未发送的定位会被替换，并计为 coalesced。
+ */
+void gps_push_publish(const gps_data_push_command_frame *frame) {
+    if (s_mailbox == NULL || frame == NULL) {
+        return;
+    }
+    gps_push_mail_t mail;
+    mail.frame = *frame;
+    mail.published_us = esp_timer_get_time();
+    xQueueOverwrite(s_mailbox, &mail);
+    __atomic_fetch_add(&s_published, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Change the push rate, 1 to 10 Hz; takes effect from the next fix
+ *        修改推送频率，1 到 10 Hz；从下一个定位起生效
+ */
+void gps_push_set_rate(uint32_t rate_hz) {
+    if (rate_hz < 1) {
+        rate_hz = 1;
+    } else if (rate_hz > 10) {
+        rate_hz = 10;
+    }
+    __atomic_store_n(&s_rate_hz, rate_hz, __ATOMIC_RELAXED);
+}
+
+uint32_t gps_push_get_rate(void) {
+    return __atomic_load_n(&s_rate_hz, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Copy the counters; coalesced is derived from what was published but never taken
+ *        拷贝计数；coalesced 由已发布但从未被取出的数量推算
+ */
+void gps_push_get_stats(gps_push_stats_t *out) {
+    memset(out, 0, sizeof(*out));
+    uint32_t taken = __atomic_load_n(&s_taken, __ATOMIC_RELAXED);
+    uint32_t waiting = (s_mailbox != NULL) ? (uint32_t)uxQueueMessagesWaiting(s_mailbox) : 0;
+    out->published = __atomic_load_n(&s_published, __ATOMIC_RELAXED);
+    out->coalesced = out->published - taken - waiting;
+    out->dropped_stale = __atomic_load_n(&s_dropped_stale, __ATOMIC_RELAXED);
+    out->not_sent = __atomic_load_n(&s_not_sent, __ATOMIC_RELAXED);
+
+    portENTER_CRITICAL(&s_stats_lock);
+    out->sent = s_sent;
+    if (s_sent > 0) {
+        out->age_min_us = s_age_min_us;
+        out->age_max_us = s_age_max_us;
+        out->age_mean_us = (uint32_t)(s_age_sum_us / s_sent);
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+/**
+ * @brief Clear the counters, call while no fixes are being published
+ *        清零计数，请在没有定位发布时调用
+ */
+void gps_push_reset_stats(void) {
+    uint32_t waiting = (s_mailbox != NULL) ? (uint32_t)uxQueueMessagesWaiting(s_mailbox) : 0;
+    __atomic_store_n(&s_published, waiting, __ATOMIC_RELAXED);
+    __atomic_store_n(&s_taken, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&s_dropped_stale, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&s_not_sent, 0, __ATOMIC_RELAXED);
+    portENTER_CRITICAL(&s_stats_lock);
+    s_sent = 0;
+    s_age_min_us = UINT32_MAX;
+    s_age_max_us = 0;
+    s_age_sum_us = 0;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
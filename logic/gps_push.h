@@ -0,0 +1,85 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#ifndef __GPS_PUSH_H__
+#define __GPS_PUSH_H__
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "dji_protocol_data_structures.h"
+
+/* 默认推送频率，可通过 menuconfig 或 gps_push_set_rate 修改 */
+/* Default push rate, change it in menuconfig or with gps_push_set_rate */
+#ifndef GPS_PUSH_DEFAULT_RATE_HZ
+#define GPS_PUSH_DEFAULT_RATE_HZ 10
+#endif
+
+/* 轮到发送时早于此时长的定位视为过期并丢弃 */
+/* A fix older than this when its turn comes is stale and dropped */
+#ifndef GPS_PUSH_MAX_AGE_MS
+#define GPS_PUSH_MAX_AGE_MS 1000
+#endif
+
+/**
+ * @brief Sends one frame to the camera
+ *        向相机发送一帧
+ *
+ * @return int 0 if the frame was sent, non-zero if it was not (e.g. not connected)
+ *             已发送返回 0，未发送（例如未连接）返回非零值
+ */
+typedef int (*gps_push_send_t)(const gps_data_push_command_frame *frame);
+
+/**
+ * @brief Push scheduler counters
+ *        推送调度计数
+ *
+ * Every published fix ends up in exactly one of coalesced, dropped_stale, sent and not_sent,
+ * or is still waiting in the mailbox.
+ * 每个发布的定位最终恰好计入 coalesced、dropped_stale、sent、not_sent 之一，或仍在信箱中等待。
+ */
+typedef struct {
+    uint32_t published;         // Fixes published by the parser
+                                // 解析器发布的定位数
+    uint32_t coalesced;         // Replaced in the mailbox by a newer fix before being sent
+                                // 发送前在信箱中被更新的定位替换
+    uint32_t dropped_stale;     // Older than GPS_PUSH_MAX_AGE_MS when taken
+                                // 取出时已超过 GPS_PUSH_MAX_AGE_MS
+    uint32_t sent;              // Handed to the camera
+                                // 已发送给相机
+    uint32_t not_sent;          // Rejected by the send function, e.g. camera not connected
+                                // 被发送函数拒绝，例如相机未连接
+    uint32_t age_min_us;        // Fix age from publish to send completion, over the sent fixes
+                                // 已发送定位从发布到发送完成的时长
+    uint32_t age_max_us;
+    uint32_t age_mean_us;
+} gps_push_stats_t;
+
+esp_err_t gps_push_init(gps_push_send_t send);
+
+void gps_push_publish(const gps_data_push_command_frame *frame);
+
+void gps_push_set_rate(uint32_t rate_hz);
+
+uint32_t gps_push_get_rate(void);
+
+void gps_push_get_stats(gps_push_stats_t *out);
+
+void gps_push_reset_stats(void);
+
+#endif
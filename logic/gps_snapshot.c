@@ -0,0 +1,96 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#include <string.h>
+
+#include "gps_snapshot.h"
+
+static void store_copy(uint32_t *words, const GPS_Data_t *data) {
+    uint32_t buffer[GPS_SNAPSHOT_WORDS] = { 0 };
+    memcpy(buffer, data, sizeof(GPS_Data_t));
+    for (size_t i = 0; i < GPS_SNAPSHOT_WORDS; i++) {
+        __atomic_store_n(&words[i], buffer[i], __ATOMIC_RELAXED);
+    }
+}
+
+/* The copy written before the bump is visible before it, the copy written after it is not */
+/* 递增之前写入的副本先于递增可见，递增之后写入的副本不会早于递增可见 */
+static void advance_sequence(gps_snapshot_t *snapshot, uint32_t sequence) {
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&snapshot->sequence, sequence, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Start with an all-zero fix, Status 0
+ *        以全零定位（Status 为 0）开始
+ */
+void gps_snapshot_init(gps_snapshot_t *snapshot) {
+    memset(snapshot, 0, sizeof(*snapshot));
+}
+
+/**
+ * @brief Publish a complete fix (single writer)
+ *        发布一次完整定位（单一写入方）
+ *
+ * @param snapshot Snapshot to update, only one task may publish to it
+ *                 要更新的快照，只允许一个任务发布
+ * @param data Complete fix to copy
+ *             要拷贝的完整定位
+ */
+void gps_snapshot_publish(gps_snapshot_t *snapshot, const GPS_Data_t *data) {
+    uint32_t sequence = __atomic_load_n(&snapshot->sequence, __ATOMIC_RELAXED);
+
+    // 读取方转到另一份副本后，再改写原来那份；之后两份各轮换一次
+    // Move readers to the other copy before rewriting the one they were using, then swap once more
+    advance_sequence(snapshot, sequence + 1);
+    store_copy(snapshot->copy[sequence & 1], data);
+    advance_sequence(snapshot, sequence + 2);
+    store_copy(snapshot->copy[(sequence + 1) & 1], data);
+}
+
+/**
+ * @brief Copy the latest complete fix, from any task, without blocking
+ *        从任意任务拷贝最新的完整定位，不阻塞
+ *
+ * @param snapshot Snapshot to read
+ *                 要读取的快照
+ * @param out Receives the fix
+ *            接收定位
+ * @return uint32_t Number of retries because the writer moved on during the copy, for diagnostics
+ *                  拷贝期间写入方前进导致的重试次数，用于诊断
+ */
+uint32_t gps_snapshot_read(const gps_snapshot_t *snapshot, GPS_Data_t *out) {
+    uint32_t buffer[GPS_SNAPSHOT_WORDS];
+    uint32_t retries = 0;
+    for (;;) {
+        uint32_t sequence = __atomic_load_n(&snapshot->sequence, __ATOMIC_ACQUIRE);
+        const uint32_t *words = snapshot->copy[sequence & 1];
+        for (size_t i = 0; i < GPS_SNAPSHOT_WORDS; i++) {
+            buffer[i] = __atomic_load_n(&words[i], __ATOMIC_RELAXED);
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&snapshot->sequence, __ATOMIC_RELAXED) == sequence) {
+            break;
+        }
+        retries++;
+    }
+    memcpy(out, buffer, sizeof(GPS_Data_t));
+    return retries;
+}
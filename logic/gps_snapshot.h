@@ -0,0 +1,57 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#ifndef __GPS_SNAPSHOT_H__
+#define __GPS_SNAPSHOT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "gps_logic.h"
+
+/* GPS_Data_t 按 32 位字存放，使读写可以逐字原子完成 */
+/* GPS_Data_t stored as 32-bit words, so it can be copied word by word with atomic accesses */
+#define GPS_SNAPSHOT_WORDS ((sizeof(GPS_Data_t) + sizeof(uint32_t) - 1) / sizeof(uint32_t))
+
+/**
+ * @brief Latest complete fix, written by one task and read by any number of tasks without locks
+ *        最新的完整定位，由一个任务写入，任意多个任务无锁读取
+ *
+ * Two copies with a sequence counter (a seqlock "latch"): the writer bumps the counter, so readers
+ * switch to the copy it is not writing, updates one copy, bumps again and updates the other. A reader
+ * copies the copy selected by the counter and retries only if the counter moved meanwhile. Readers
+ * therefore never wait for a writer that is part-way through, which matters on a single core where a
+ * higher-priority reader would otherwise spin while the lower-priority parse task cannot run.
+ * 两份副本加序号计数（seqlock 的 "latch" 形式）：写入方先递增计数，使读取方改读其未在写的副本，写完一份
+ * 后再次递增并写另一份。读取方按计数选择副本拷贝，仅当期间计数变化时重试。因此读取方从不等待写到一半的
+ * 写入方；在单核上，否则高优先级的读取方会一直自旋，而低优先级的解析任务无法运行。
+ */
+typedef struct {
+    uint32_t sequence;                          // Even: readers use copy 0, odd: copy 1
+                                                // 偶数：读取方使用副本 0，奇数：副本 1
+    uint32_t copy[2][GPS_SNAPSHOT_WORDS];
+} gps_snapshot_t;
+
+void gps_snapshot_init(gps_snapshot_t *snapshot);
+
+void gps_snapshot_publish(gps_snapshot_t *snapshot, const GPS_Data_t *data);
+
+uint32_t gps_snapshot_read(const gps_snapshot_t *snapshot, GPS_Data_t *out);
+
+#endif
@@ -205,16 +205,15 @@ static int protocol_connect_and_prepare(bool used_stored_camera_bda, bool force_
         0
     );
     if (res != 0) {
+        // connect_logic_protocol_connect has closed the link, unless it was lost and is being reconnected
         ESP_LOGE(TAG, "Protocol connect failed");
         light_logic_signal_error(PRODUCT_ERROR_SIGNAL_MS);
-        (void)connect_logic_ble_disconnect();
         return -1;
     }
 
-    version_query_response_frame_t *version_resp = command_logic_get_version();
-    if (version_resp) {
-        free(version_resp);
-    }
+    // The version query and the status subscription are independent: subscribe while the
+    // version response is in flight, so the first status push is not held up by the query.
+    command_handle_t version_query = command_logic_submit_get_version();
 
     const int sub_res = subscript_camera_status(PUSH_MODE_PERIODIC_WITH_STATE_CHANGE, PUSH_FREQ_2HZ);
     if (sub_res != 0) {
@@ -222,9 +221,18 @@ static int protocol_connect_and_prepare(bool used_stored_camera_bda, bool force_
         light_logic_signal_error(PRODUCT_ERROR_SIGNAL_MS);
     }
 
+    command_result_buffer_t version_resp;
+    (void)command_logic_await_version(version_query, &version_resp);
+
     (void)product_nvs_set_last_camera_bda(s_ble_profile.remote_bda);
     (void)product_nvs_set_paired(true);
 
+    // Keep the GATT handles so the next reconnect can skip service discovery
+    ble_gatt_handles_t handles;
+    if (ble_get_gatt_handles(&handles)) {
+        (void)product_nvs_set_gatt_handles(s_ble_profile.remote_bda, &handles);
+    }
+
     ESP_LOGI(TAG, "Camera linked: %02X:%02X:%02X:%02X:%02X:%02X",
              s_ble_profile.remote_bda[0], s_ble_profile.remote_bda[1], s_ble_profile.remote_bda[2],
              s_ble_profile.remote_bda[3], s_ble_profile.remote_bda[4], s_ble_profile.remote_bda[5]);
@@ -244,6 +252,10 @@ static int connect_ble_and_protocol(bool prefer_last_camera, bool force_pairing)
 
     if (prefer_last_camera && have_last) {
         memcpy(s_ble_profile.remote_bda, last_bda, ESP_BD_ADDR_LEN);
+        ble_gatt_handles_t handles;
+        if (product_nvs_get_gatt_handles(last_bda, &handles)) {
+            ble_set_cached_handles(last_bda, &handles);
+        }
         ESP_LOGI(TAG, "Reconnect to last camera...");
         if (connect_logic_ble_connect(true) == 0) {
             if (protocol_connect_and_prepare(true, force_pairing) == 0) {
@@ -268,10 +280,10 @@ static void action_record_toggle(void) {
         return;
     }
 
+    command_result_buffer_t response;
+
     if (is_camera_recording()) {
-        record_control_response_frame_t *resp = command_logic_stop_record();
-        if (resp) {
-            free(resp);
+        if (command_logic_stop_record(&response)) {
             return;
         }
         light_logic_signal_error(PRODUCT_ERROR_SIGNAL_MS);
@@ -279,21 +291,17 @@ static void action_record_toggle(void) {
     }
 
     if ((camera_mode_t)current_camera_mode == CAMERA_MODE_PHOTO) {
-        camera_mode_switch_response_frame_t *sw = command_logic_switch_camera_mode(CAMERA_MODE_NORMAL);
-        if (sw) {
-            free(sw);
-        }
+        (void)command_logic_switch_camera_mode(CAMERA_MODE_NORMAL, &response);
         vTaskDelay(pdMS_TO_TICKS(250));
     }
 
-    record_control_response_frame_t *resp = command_logic_start_record();
+    record_control_response_frame_t *resp = command_logic_start_record(&response);
     if (!resp) {
         (void)connect_logic_ble_wakeup();
         vTaskDelay(pdMS_TO_TICKS(250));
-        resp = command_logic_start_record();
+        resp = command_logic_start_record(&response);
     }
     if (resp) {
-        free(resp);
         return;
     }
     light_logic_signal_error(PRODUCT_ERROR_SIGNAL_MS);
@@ -304,9 +312,8 @@ static void action_mode_next(void) {
         light_logic_signal_error(PRODUCT_ERROR_SIGNAL_MS);
         return;
     }
-    key_report_response_frame_t *resp = command_logic_key_report_qs();
-    if (resp) {
-        free(resp);
+    command_result_buffer_t response;
+    if (command_logic_key_report_qs(&response)) {
         return;
     }
     light_logic_signal_error(PRODUCT_ERROR_SIGNAL_MS);
@@ -318,30 +325,22 @@ static void action_take_photo(void) {
         return;
     }
 
+    command_result_buffer_t response;
+
     if ((camera_mode_t)current_camera_mode != CAMERA_MODE_PHOTO) {
-        camera_mode_switch_response_frame_t *sw = command_logic_switch_camera_mode(CAMERA_MODE_PHOTO);
-        if (sw) {
-            free(sw);
-        }
+        (void)command_logic_switch_camera_mode(CAMERA_MODE_PHOTO, &response);
         vTaskDelay(pdMS_TO_TICKS(350));
     }
 
-    key_report_response_frame_t *resp = command_logic_key_report_snapshot();
-    if (resp) {
-        free(resp);
+    if (command_logic_key_report_snapshot(&response)) {
         return;
     }
 
     // Fallback: force photo mode then retry shutter
-    camera_mode_switch_response_frame_t *sw = command_logic_switch_camera_mode(CAMERA_MODE_PHOTO);
-    if (sw) {
-        free(sw);
-    }
+    (void)command_logic_switch_camera_mode(CAMERA_MODE_PHOTO, &response);
     vTaskDelay(pdMS_TO_TICKS(350));
 
-    resp = command_logic_key_report_snapshot();
-    if (resp) {
-        free(resp);
+    if (command_logic_key_report_snapshot(&response)) {
         return;
     }
     light_logic_signal_error(PRODUCT_ERROR_SIGNAL_MS);
@@ -355,6 +354,7 @@ static void action_factory_reset_link(void) {
     ESP_LOGW(TAG, "Factory reset link (NVS clear + force re-pair)");
     (void)connect_logic_ble_disconnect();
     (void)product_nvs_factory_reset();
+    ble_set_cached_handles(s_ble_profile.remote_bda, NULL);
     memset(s_ble_profile.remote_bda, 0, ESP_BD_ADDR_LEN);
     (void)connect_ble_and_protocol(false, true);
 }
@@ -431,6 +431,8 @@ static void button_task(void *arg) {
             if (event.level == 0 && !pressed) {
                 pressed = true;
                 press_tick = event.tick;
+                // Shorten the connection interval while the press is still being classified
+                connect_logic_note_activity(LINK_ACTIVITY_KEY);
                 (void)esp_timer_stop(s_multiclick_timer);
                 continue;
             }
@@ -0,0 +1,598 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#include <string.h>
+
+#include "nmea_parser.h"
+
+/* 语句类型键：三个 ASCII 字符打包为一个整数，便于 switch 分发 */
+/* Sentence type key: the three ASCII characters packed into one integer for a switch */
+#define SENTENCE_KEY(a, b, c) (((uint32_t)(a) << 16) | ((uint32_t)(b) << 8) | (uint32_t)(c))
+
+/* 10 的整数次幂，uint64_t 最大可表示 10^19 */
+/* Powers of ten, 10^19 is the largest that fits in uint64_t */
+static const uint64_t s_pow10[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL,
+};
+
+/* 坐标分数部分最多保留的位数，更低的位不会改变 1e-7 度的舍入结果 */
+/* Coordinate fraction digits kept, lower digits cannot change the rounding to 1e-7 degree */
+#define MAX_MINUTE_FRACTION_DIGITS 17
+
+static inline bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static inline bool is_line_end(char c) {
+    return c == '\r' || c == '\n' || c == '\0' || c == '$';
+}
+
+static uint8_t identify_sentence(const char *type) {
+    switch (SENTENCE_KEY(type[0], type[1], type[2])) {
+        case SENTENCE_KEY('R', 'M', 'C'): return NMEA_SENTENCE_RMC;
+        case SENTENCE_KEY('G', 'G', 'A'): return NMEA_SENTENCE_GGA;
+        case SENTENCE_KEY('G', 'S', 'A'): return NMEA_SENTENCE_GSA;
+        case SENTENCE_KEY('G', 'S', 'V'): return NMEA_SENTENCE_GSV;
+        case SENTENCE_KEY('G', 'S', 'T'): return NMEA_SENTENCE_GST;
+        case SENTENCE_KEY('V', 'T', 'G'): return NMEA_SENTENCE_VTG;
+        default: return NMEA_SENTENCE_UNKNOWN;
+    }
+}
+
+/* NMEA 0183 writes the checksum as two upper case hex digits */
+/* NMEA 0183 规定校验和为两位大写十六进制数 */
+static inline int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/**
+ * @brief Split one sentence into fields and verify its checksum in a single pass, without copying it
+ *        单次遍历将一条语句拆分为字段并校验其校验和，不拷贝语句
+ *
+ * Scanning stops at the checksum delimiter '*', a line end, a '$' that starts the next sentence,
+ * or after length bytes. Empty fields are recorded with length 0 rather than skipped. The XOR of
+ * every byte between '$' and '*' is accumulated on the way and compared with the two hex digits
+ * after '*'.
+ * 扫描在校验分隔符 '*'、行尾、下一条语句的 '$' 或 length 字节处停止。空字段以长度 0 记录而不会被跳过。
+ * 扫描过程中同时累计 '$' 与 '*' 之间所有字节的异或值，并与 '*' 之后的两位十六进制数比较。
+ *
+ * @param line Points at the '$' of the sentence
+ *             指向语句的 '$'
+ * @param length Bytes available from line
+ *               从 line 起可用的字节数
+ * @param out Tokenized sentence, out->checksum holds the nmea_checksum_status_t
+ *            分词结果，out->checksum 为 nmea_checksum_status_t
+ * @return int 0 on success, -1 if line does not start with a sentence address
+ *             成功返回 0，line 不以语句地址开头时返回 -1
+ */
+int nmea_tokenize(const char *line, size_t length, nmea_sentence_t *out) {
+    if (line == NULL || out == NULL || length < 6 || line[0] != '$') {
+        return -1;
+    }
+    if (length > UINT16_MAX) {
+        length = UINT16_MAX;
+    }
+
+    // Address field: two talker characters and the sentence type
+    // 地址字段：两个发送方字符和语句类型
+    uint8_t sum = 0;
+    size_t i = 1;
+    while (i < length && line[i] != ',' && line[i] != '*' && !is_line_end(line[i])) {
+        sum ^= (uint8_t)line[i];
+        i++;
+    }
+    if (i < 6) {
+        return -1;
+    }
+
+    out->line = line;
+    out->talker[0] = line[1];
+    out->talker[1] = line[2];
+    out->id = (i == 6) ? identify_sentence(&line[3]) : NMEA_SENTENCE_UNKNOWN;
+
+    uint8_t count = 0;
+    if (i < length && line[i] == ',') {
+        sum ^= (uint8_t)',';
+        size_t start = ++i;
+        for (;; i++) {
+            char c = (i < length) ? line[i] : '\0';
+            if (c != ',' && c != '*' && !is_line_end(c)) {
+                sum ^= (uint8_t)c;
+                continue;
+            }
+            if (count < NMEA_MAX_FIELDS) {
+                out->fields[count].offset = (uint16_t)start;
+                out->fields[count].length = (uint16_t)(i - start);
+                count++;
+            }
+            if (c != ',') {
+                break;
+            }
+            sum ^= (uint8_t)',';
+            start = i + 1;
+        }
+    }
+    out->field_count = count;
+
+    // Compare with the two checksum digits, then step over them so the caller can resume after the sentence
+    // 与两位校验字符比较，然后跳过它们，便于调用方从语句之后继续
+    out->checksum = NMEA_CHECKSUM_MISSING;
+    if (i < length && line[i] == '*') {
+        int high = (i + 1 < length) ? hex_value(line[i + 1]) : -1;
+        int low = (i + 2 < length) ? hex_value(line[i + 2]) : -1;
+        if (high >= 0 && low >= 0) {
+            out->checksum = ((uint8_t)((high << 4) | low) == sum) ? NMEA_CHECKSUM_OK : NMEA_CHECKSUM_BAD;
+            i += 3;
+        } else {
+            size_t checksum_end = i + 3;
+            for (i++; i < length && i < checksum_end && !is_line_end(line[i]); i++) {
+            }
+        }
+    }
+    out->length = (uint16_t)i;
+    return 0;
+}
+
+/**
+ * @brief Tokenize every sentence in a buffer and hand each one with a valid checksum to a handler
+ *        对缓冲区中的每条语句分词，并将校验和正确的语句交给处理函数
+ *
+ * Works in place on the buffer, which does not need to be NUL terminated. Bytes before the
+ * first '$' and anything that is not a sentence address are skipped. Sentences with a wrong or
+ * missing checksum are counted and dropped before the handler converts any field.
+ * 直接在缓冲区上处理，缓冲区无需以 NUL 结尾。首个 '$' 之前的字节以及非语句地址的内容会被跳过。
+ * 校验和错误或缺失的语句只计数并丢弃，不会交给处理函数做任何字段转换。
+ *
+ * @param buffer NMEA text
+ *               NMEA 文本
+ * @param length Bytes in buffer
+ *               缓冲区字节数
+ * @param handler Called once per sentence with a valid checksum, may be NULL
+ *                每条校验和正确的语句调用一次，可为 NULL
+ * @param ctx Passed through to handler
+ *            透传给 handler
+ * @param stats Checksum counters to update, may be NULL
+ *              需要更新的校验计数，可为 NULL
+ * @return size_t Number of sentences handed to handler
+ *                交给 handler 的语句数
+ */
+size_t nmea_scan_buffer(const char *buffer, size_t length, nmea_sentence_handler_t handler, void *ctx,
+                        nmea_checksum_stats_t *stats) {
+    size_t sentences = 0;
+    const char *end = buffer + length;
+    const char *p = buffer;
+
+    while (p < end) {
+        const char *dollar = memchr(p, '$', (size_t)(end - p));
+        if (dollar == NULL) {
+            break;
+        }
+
+        // Resume after the sentence, so each byte is looked at once
+        // 从语句之后继续，每个字节只扫描一次
+        nmea_sentence_t sentence;
+        if (nmea_tokenize(dollar, (size_t)(end - dollar), &sentence) != 0) {
+            p = dollar + 1;
+            continue;
+        }
+        p = dollar + (sentence.length > 0 ? sentence.length : 1);
+
+        switch (sentence.checksum) {
+            case NMEA_CHECKSUM_OK:
+                if (stats) {
+                    stats->good++;
+                }
+                sentences++;
+                if (handler) {
+                    handler(&sentence, ctx);
+                }
+                break;
+            case NMEA_CHECKSUM_BAD:
+                if (stats) {
+                    stats->bad++;
+                }
+                break;
+            default:
+                if (stats) {
+                    stats->truncated++;
+                }
+                break;
+        }
+    }
+    return sentences;
+}
+
+/**
+ * @brief Forget any partial sentence, e.g. after the UART dropped bytes
+ *        丢弃未完成的语句，例如在 UART 丢失数据之后
+ */
+void nmea_assembler_reset(nmea_line_assembler_t *assembler) {
+    assembler->carry_length = 0;
+    assembler->discarding = false;
+}
+
+/**
+ * @brief Keep the unfinished tail of a read for the next one
+ *        保留读取数据中未结束的尾部，留给下一次读取
+ */
+static void assembler_keep_tail(nmea_line_assembler_t *assembler, const char *tail, size_t length) {
+    const char *dollar = memchr(tail, '$', length);
+    if (dollar == NULL) {
+        return;
+    }
+    length -= (size_t)(dollar - tail);
+    if (length > sizeof(assembler->carry)) {
+        assembler->overflows++;
+        assembler->discarding = true;
+        return;
+    }
+    memcpy(assembler->carry, dollar, length);
+    assembler->carry_length = (uint16_t)length;
+}
+
+/**
+ * @brief Feed one read and hand every sentence it completes to a handler
+ *        送入一次读取的数据，并将其补齐的每条语句交给处理函数
+ *
+ * A sentence split across reads is completed from carry before the rest of the read is scanned
+ * in place. A line longer than NMEA_MAX_SENTENCE_LENGTH is dropped up to its line end.
+ * 跨读取拆分的语句先由 carry 补齐，随后原地扫描读取数据的其余部分。超过 NMEA_MAX_SENTENCE_LENGTH
+ * 的行会被丢弃，直到其行尾。
+ *
+ * @param assembler Assembler state, kept across reads
+ *                  拼接器状态，跨读取保留
+ * @param data Bytes from the UART, any length, does not need to be NUL terminated
+ *             来自 UART 的数据，长度任意，无需以 NUL 结尾
+ * @param length Bytes in data
+ *               data 的字节数
+ * @param handler Called once per completed sentence with a valid checksum, may be NULL
+ *                每条补齐且校验和正确的语句调用一次，可为 NULL
+ * @param ctx Passed through to handler
+ *            透传给 handler
+ * @return size_t Number of sentences handed to handler
+ *                交给 handler 的语句数
+ */
+size_t nmea_assembler_feed(nmea_line_assembler_t *assembler, const char *data, size_t length,
+                           nmea_sentence_handler_t handler, void *ctx) {
+    size_t sentences = 0;
+    const char *end = data + length;
+    const char *p = data;
+
+    // Finish the line carried over from the previous read, or the one being discarded
+    // 补齐上一次读取遗留的行，或继续丢弃超长行
+    if (assembler->carry_length > 0 || assembler->discarding) {
+        const char *newline = memchr(p, '\n', length);
+        size_t head = newline ? (size_t)(newline - p) + 1 : length;
+        if (!assembler->discarding) {
+            if (assembler->carry_length + head > sizeof(assembler->carry)) {
+                assembler->overflows++;
+                assembler->carry_length = 0;
+                assembler->discarding = true;
+            } else {
+                memcpy(assembler->carry + assembler->carry_length, p, head);
+                assembler->carry_length = (uint16_t)(assembler->carry_length + head);
+            }
+        }
+        if (newline == NULL) {
+            return 0;
+        }
+        if (!assembler->discarding) {
+            sentences += nmea_scan_buffer(assembler->carry, assembler->carry_length, handler, ctx,
+                                          &assembler->checksum);
+        }
+        nmea_assembler_reset(assembler);
+        p = newline + 1;
+    }
+
+    // Scan every complete line in place, keep what follows the last line end
+    // 原地扫描所有完整行，保留最后一个行尾之后的内容
+    const char *last_newline = NULL;
+    for (const char *q = end; q > p; q--) {
+        if (q[-1] == '\n') {
+            last_newline = q - 1;
+            break;
+        }
+    }
+    if (last_newline != NULL) {
+        sentences += nmea_scan_buffer(p, (size_t)(last_newline + 1 - p), handler, ctx, &assembler->checksum);
+        p = last_newline + 1;
+    }
+    assembler_keep_tail(assembler, p, (size_t)(end - p));
+    return sentences;
+}
+
+/**
+ * @brief Whether the sentence comes from a satellite receiver (GP, GN, GL, GA, GB, BD ...)
+ *        语句是否来自卫星接收机（GP、GN、GL、GA、GB、BD 等）
+ */
+bool nmea_talker_is_gnss(const nmea_sentence_t *sentence) {
+    return sentence->talker[0] == 'G' || (sentence->talker[0] == 'B' && sentence->talker[1] == 'D');
+}
+
+static inline const char *field_span(const nmea_sentence_t *sentence, uint8_t index, size_t *length) {
+    if (index >= sentence->field_count) {
+        *length = 0;
+        return NULL;
+    }
+    *length = sentence->fields[index].length;
+    return sentence->line + sentence->fields[index].offset;
+}
+
+/**
+ * @brief Parse a decimal number such as "-12.3456" from a span into an integer scaled by 10^decimals
+ *        从区间中解析 "-12.3456" 形式的十进制数，结果为放大 10^decimals 倍的整数
+ *
+ * Only integer arithmetic is used. The digit after the last kept one decides the rounding,
+ * half away from zero, which is exact because every lower digit only adds to the magnitude.
+ * 仅使用整数运算。保留位之后的一位决定舍入（四舍五入，远离零），由于更低的位只会增大数值，结果是精确的。
+ */
+static bool parse_fixed(const char *p, size_t length, uint8_t decimals, int32_t *out) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < length && (p[i] == '-' || p[i] == '+')) {
+        negative = (p[i] == '-');
+        i++;
+    }
+
+    uint64_t value = 0;
+    size_t digits = 0;
+    while (i < length && is_digit(p[i])) {
+        value = value * 10 + (uint64_t)(p[i] - '0');
+        if (value > INT32_MAX) {
+            return false;
+        }
+        i++;
+        digits++;
+    }
+
+    uint8_t kept = 0;
+    bool round_up = false;
+    if (i < length && p[i] == '.') {
+        i++;
+        while (i < length && is_digit(p[i])) {
+            if (kept < decimals) {
+                value = value * 10 + (uint64_t)(p[i] - '0');
+                kept++;
+            } else if (kept == decimals) {
+                round_up = (p[i] >= '5');
+                kept++;
+            }
+            i++;
+            digits++;
+        }
+    }
+
+    if (digits == 0 || i != length) {
+        return false;
+    }
+
+    // Digits the field did not have are zeros
+    // 字段中缺少的小数位补零
+    for (; kept < decimals; kept++) {
+        value *= 10;
+    }
+    value += round_up ? 1 : 0;
+    if (value > INT32_MAX) {
+        return false;
+    }
+    *out = negative ? -(int32_t)value : (int32_t)value;
+    return true;
+}
+
+bool nmea_field_is_empty(const nmea_sentence_t *sentence, uint8_t index) {
+    size_t length;
+    field_span(sentence, index, &length);
+    return length == 0;
+}
+
+/**
+ * @brief First character of a field, '\0' if the field is empty or missing
+ *        字段的首字符，字段为空或不存在时返回 '\0'
+ */
+char nmea_field_char(const nmea_sentence_t *sentence, uint8_t index) {
+    size_t length;
+    const char *p = field_span(sentence, index, &length);
+    return length > 0 ? p[0] : '\0';
+}
+
+/**
+ * @brief Integer value of a field, a fractional part is ignored
+ *        字段的整数值，忽略小数部分
+ *
+ * @return bool false if the field is empty, missing or not a number
+ *              字段为空、不存在或不是数字时返回 false
+ */
+bool nmea_field_int(const nmea_sentence_t *sentence, uint8_t index, int32_t *out) {
+    size_t length;
+    const char *p = field_span(sentence, index, &length);
+    size_t i = 0;
+    bool negative = false;
+    if (i < length && (p[i] == '-' || p[i] == '+')) {
+        negative = (p[i] == '-');
+        i++;
+    }
+
+    int32_t value = 0;
+    size_t digits = 0;
+    while (i < length && is_digit(p[i])) {
+        value = value * 10 + (p[i] - '0');
+        i++;
+        digits++;
+    }
+    if (digits == 0 || (i != length && p[i] != '.')) {
+        return false;
+    }
+    *out = negative ? -value : value;
+    return true;
+}
+
+/**
+ * @brief Decimal value of a field as an integer scaled by 10^decimals, e.g. metres to millimetres with 3
+ *        字段的十进制数值，以放大 10^decimals 倍的整数表示，例如 decimals 为 3 时米转换为毫米
+ *
+ * @param decimals Fraction digits kept, the next one rounds half away from zero
+ *                 保留的小数位数，其后一位按四舍五入（远离零）处理
+ * @return bool false if the field is empty, missing, not a number or does not fit in int32_t
+ *              字段为空、不存在、不是数字或超出 int32_t 范围时返回 false
+ */
+bool nmea_field_fixed(const nmea_sentence_t *sentence, uint8_t index, uint8_t decimals, int32_t *out) {
+    size_t length;
+    const char *p = field_span(sentence, index, &length);
+    return length > 0 && decimals < 10 && parse_fixed(p, length, decimals, out);
+}
+
+/**
+ * @brief Convert a ddmm.mmmm / dddmm.mmmm coordinate field to unsigned 1e-7 degrees
+ *        将 ddmm.mmmm / dddmm.mmmm 坐标字段转换为以 1e-7 度为单位的无符号整数
+ *
+ * The minutes with k fraction digits are an integer M in units of 10^-k minute, so the result is
+ * degrees * 10^7 + M * 10^7 / (60 * 10^k), rounded to nearest with ties away from zero. Fraction
+ * digits beyond MAX_MINUTE_FRACTION_DIGITS are dropped: they add less than one unit of M, which
+ * cannot move an even divisor's remainder across the half way point.
+ * The hemisphere is in the following field and is applied by the caller.
+ * 带 k 位小数的分值可视为以 10^-k 分为单位的整数 M，结果为 度 * 10^7 + M * 10^7 / (60 * 10^k)，
+ * 四舍五入（远离零）。超过 MAX_MINUTE_FRACTION_DIGITS 的小数位被舍弃：它们对 M 的贡献不足一个单位，
+ * 而除数为偶数，余数不会因此越过中点。半球位于下一个字段，由调用方处理正负号。
+ *
+ * @return bool false if the field is empty, not a coordinate, has minutes of 60 or more, or exceeds 180 degrees
+ *              字段为空、不是坐标、分值不小于 60 或超过 180 度时返回 false
+ */
+bool nmea_field_degrees_e7(const nmea_sentence_t *sentence, uint8_t index, int32_t *out) {
+    size_t length;
+    const char *p = field_span(sentence, index, &length);
+
+    uint32_t integer = 0;
+    size_t i = 0;
+    while (i < length && is_digit(p[i])) {
+        integer = integer * 10 + (uint32_t)(p[i] - '0');
+        if (integer > 18000) {
+            return false;
+        }
+        i++;
+    }
+    if (i == 0) {
+        return false;
+    }
+
+    uint32_t degrees = integer / 100;
+    uint64_t minutes = integer % 100;
+    uint8_t k = 0;
+    if (i < length && p[i] == '.') {
+        for (i++; i < length && is_digit(p[i]); i++) {
+            if (k < MAX_MINUTE_FRACTION_DIGITS) {
+                minutes = minutes * 10 + (uint64_t)(p[i] - '0');
+                k++;
+            }
+        }
+    }
+    if (i != length || minutes >= 60 * s_pow10[k]) {
+        return false;
+    }
+
+    // numerator / denominator == minutes in 1e-7 degree, reduced so neither overflows
+    // numerator / denominator 即以 1e-7 度为单位的分值，约分后两者都不会溢出
+    uint64_t numerator, denominator;
+    if (k <= 7) {
+        numerator = minutes * s_pow10[7 - k];
+        denominator = 60;
+    } else {
+        numerator = minutes;
+        denominator = 60 * s_pow10[k - 7];
+    }
+    uint64_t fraction = numerator / denominator;
+    if (2 * (numerator % denominator) >= denominator) {
+        fraction++;
+    }
+
+    uint64_t value = (uint64_t)degrees * 10000000ULL + fraction;
+    if (value > 1800000000ULL) {
+        return false;
+    }
+    *out = (int32_t)value;
+    return true;
+}
+
+/**
+ * @brief Parse an hhmmss.sss time field, digits below the millisecond are truncated
+ *        解析 hhmmss.sss 时间字段，毫秒以下的位被截断
+ */
+bool nmea_field_time(const nmea_sentence_t *sentence, uint8_t index, uint8_t *hour, uint8_t *minute,
+                     uint8_t *second, uint16_t *millisecond) {
+    size_t length;
+    const char *p = field_span(sentence, index, &length);
+    if (length < 6) {
+        return false;
+    }
+    for (size_t i = 0; i < 6; i++) {
+        if (!is_digit(p[i])) {
+            return false;
+        }
+    }
+
+    uint16_t ms = 0;
+    if (length > 6) {
+        if (p[6] != '.') {
+            return false;
+        }
+        uint16_t scale = 100;
+        for (size_t i = 7; i < length; i++) {
+            if (!is_digit(p[i])) {
+                return false;
+            }
+            ms += (uint16_t)((p[i] - '0') * scale);
+            scale /= 10;
+        }
+    }
+
+    *hour = (uint8_t)((p[0] - '0') * 10 + (p[1] - '0'));
+    *minute = (uint8_t)((p[2] - '0') * 10 + (p[3] - '0'));
+    *second = (uint8_t)((p[4] - '0') * 10 + (p[5] - '0'));
+    *millisecond = ms;
+    return true;
+}
+
+/**
+ * @brief Parse a ddmmyy date field
+ *        解析 ddmmyy 日期字段
+ */
+bool nmea_field_date(const nmea_sentence_t *sentence, uint8_t index, uint8_t *day, uint8_t *month, uint8_t *year) {
+    size_t length;
+    const char *p = field_span(sentence, index, &length);
+    if (length != 6) {
+        return false;
+    }
+    for (size_t i = 0; i < 6; i++) {
+        if (!is_digit(p[i])) {
+            return false;
+        }
+    }
+    *day = (uint8_t)((p[0] - '0') * 10 + (p[1] - '0'));
+    *month = (uint8_t)((p[2] - '0') * 10 + (p[3] - '0'));
+    *year = (uint8_t)((p[4] - '0') * 10 + (p[5] - '0'));
+    return true;
+}
@@ -0,0 +1,148 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#ifndef __NMEA_PARSER_H__
+#define __NMEA_PARSER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* 单条语句最多记录的数据字段数，GSV/GSA 约 20 个，多余字段被忽略 */
+/* Data fields recorded per sentence, GSV/GSA carry about 20, any beyond this are ignored */
+#define NMEA_MAX_FIELDS 24
+
+/* 跨读取拼接时可缓存的最长语句，NMEA 0183 规定不超过 82 字节，此处为厂商扩展语句留出余量 */
+/* Longest sentence carried over between reads; NMEA 0183 caps it at 82 bytes, the rest is headroom for vendor sentences */
+#define NMEA_MAX_SENTENCE_LENGTH 128
+
+typedef enum {
+    NMEA_SENTENCE_UNKNOWN = 0,
+    NMEA_SENTENCE_RMC,
+    NMEA_SENTENCE_GGA,
+    NMEA_SENTENCE_GSA,
+    NMEA_SENTENCE_GSV,
+    NMEA_SENTENCE_GST,
+    NMEA_SENTENCE_VTG,
+} nmea_sentence_id_t;
+
+typedef enum {
+    NMEA_CHECKSUM_MISSING = 0,  // No '*hh', e.g. the line was cut short
+                                // 没有 '*hh'，例如该行被截断
+    NMEA_CHECKSUM_OK,
+    NMEA_CHECKSUM_BAD,
+} nmea_checksum_status_t;
+
+/**
+ * @brief Sentence counters by checksum result
+ *        按校验结果统计的语句计数
+ */
+typedef struct {
+    uint32_t good;              // Checksum matched, handed to the handler
+                                // 校验通过，已交给处理函数
+    uint32_t bad;               // Checksum did not match, dropped
+                                // 校验不匹配，已丢弃
+    uint32_t truncated;         // No complete '*hh', dropped
+                                // 没有完整的 '*hh'，已丢弃
+} nmea_checksum_stats_t;
+
+/**
+ * @brief One field of a sentence, as a span of the caller's buffer
+ *        语句中的一个字段，以调用方缓冲区中的区间表示
+ */
+typedef struct {
+    uint16_t offset;            // Offset from the '$' of the sentence
+                                // 相对语句 '$' 的偏移
+    uint16_t length;            // Field length, 0 for an empty field
+                                // 字段长度，空字段为 0
+} nmea_field_t;
+
+/**
+ * @brief A tokenized sentence; the fields point into the buffer it was scanned from
+ *        分词后的语句，字段指向被扫描的缓冲区
+ *
+ * fields[0] is the first field after the address, e.g. the UTC time of RMC and GGA.
+ * Empty fields are kept, so field indices always match the NMEA specification.
+ * fields[0] 是地址字段之后的第一个字段，例如 RMC 和 GGA 的 UTC 时间。空字段会被保留，因此字段序号始终与 NMEA 规范一致。
+ */
+typedef struct {
+    const char *line;           // Start of the sentence ('$'), not NUL terminated
+                                // 语句起始位置（'$'），不以 NUL 结尾
+    char talker[2];             // Talker ID, e.g. "GN", "GP", "GL"
+                                // 发送方标识，例如 "GN"、"GP"、"GL"
+    uint8_t id;                 // nmea_sentence_id_t
+    uint8_t field_count;        // Number of entries used in fields
+                                // fields 中已使用的条目数
+    uint8_t checksum;           // nmea_checksum_status_t
+    uint16_t length;            // Bytes scanned from '$', up to the line end or the next '$'
+                                // 从 '$' 起扫描的字节数，到行尾或下一个 '$' 为止
+    nmea_field_t fields[NMEA_MAX_FIELDS];
+} nmea_sentence_t;
+
+typedef void (*nmea_sentence_handler_t)(const nmea_sentence_t *sentence, void *ctx);
+
+/**
+ * @brief Reassembles sentences from reads that split them at arbitrary points
+ *        将在任意位置被拆分的读取数据重新拼接为完整语句
+ *
+ * Complete lines in a read are tokenized in place; only the unfinished tail is copied into carry
+ * and completed by the next read.
+ * 读取数据中的完整行直接原地分词，只有未结束的尾部会拷贝到 carry，由下一次读取补齐。
+ */
+typedef struct {
+    char carry[NMEA_MAX_SENTENCE_LENGTH];   // Start of a sentence whose line end has not arrived yet
+                                            // 尚未收到行尾的语句开头
+    uint16_t carry_length;                  // Bytes in carry
+                                            // carry 中的字节数
+    bool discarding;                        // Dropping an over-long line until its line end
+                                            // 正在丢弃超长行，直到其行尾
+    uint32_t overflows;                     // Lines dropped for exceeding NMEA_MAX_SENTENCE_LENGTH
+                                            // 因超过 NMEA_MAX_SENTENCE_LENGTH 而丢弃的行数
+    nmea_checksum_stats_t checksum;         // Sentences seen, by checksum result
+                                            // 按校验结果统计的语句数
+} nmea_line_assembler_t;
+
+int nmea_tokenize(const char *line, size_t length, nmea_sentence_t *out);
+
+size_t nmea_scan_buffer(const char *buffer, size_t length, nmea_sentence_handler_t handler, void *ctx,
+                        nmea_checksum_stats_t *stats);
+
+void nmea_assembler_reset(nmea_line_assembler_t *assembler);
+
+size_t nmea_assembler_feed(nmea_line_assembler_t *assembler, const char *data, size_t length,
+                           nmea_sentence_handler_t handler, void *ctx);
+
+bool nmea_talker_is_gnss(const nmea_sentence_t *sentence);
+
+bool nmea_field_is_empty(const nmea_sentence_t *sentence, uint8_t index);
+
+char nmea_field_char(const nmea_sentence_t *sentence, uint8_t index);
+
+bool nmea_field_int(const nmea_sentence_t *sentence, uint8_t index, int32_t *out);
+
+bool nmea_field_fixed(const nmea_sentence_t *sentence, uint8_t index, uint8_t decimals, int32_t *out);
+
+bool nmea_field_degrees_e7(const nmea_sentence_t *sentence, uint8_t index, int32_t *out);
+
+bool nmea_field_time(const nmea_sentence_t *sentence, uint8_t index, uint8_t *hour, uint8_t *minute,
+                     uint8_t *second, uint16_t *millisecond);
+
+bool nmea_field_date(const nmea_sentence_t *sentence, uint8_t index, uint8_t *day, uint8_t *month, uint8_t *year);
+
+#endif
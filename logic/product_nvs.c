@@ -18,6 +18,16 @@ static const char *NVS_NS = "onebtn";
 static const char *KEY_CAM_BDA = "cam_bda";
 static const char *KEY_PAIRED = "paired";
 static const char *KEY_DEVICE_ID = "dev_id";
+static const char *KEY_CAM_GATT = "cam_gatt";
+
+#define GATT_CACHE_VERSION 1
+
+/* GATT handles of one camera, stored with its address */
+typedef struct {
+    uint8_t version;
+    uint8_t bda[ESP_BD_ADDR_LEN];
+    ble_gatt_handles_t handles;
+} gatt_cache_blob_t;
 
 static bool bda_is_zero(const esp_bd_addr_t bda) {
     static const uint8_t zero[ESP_BD_ADDR_LEN] = {0};
@@ -82,11 +92,71 @@ esp_err_t product_nvs_clear_last_camera_bda(void) {
         return ret;
     }
     (void)nvs_erase_key(handle, KEY_CAM_BDA);
+    (void)nvs_erase_key(handle, KEY_CAM_GATT);
     ret = nvs_commit(handle);
     nvs_close(handle);
     return ret;
 }
 
+static bool read_gatt_cache(nvs_handle_t handle, gatt_cache_blob_t *blob) {
+    size_t len = sizeof(*blob);
+    esp_err_t ret = nvs_get_blob(handle, KEY_CAM_GATT, blob, &len);
+    return ret == ESP_OK && len == sizeof(*blob) && blob->version == GATT_CACHE_VERSION;
+}
+
+bool product_nvs_get_gatt_handles(const esp_bd_addr_t bda, ble_gatt_handles_t *out) {
+    if (!bda || !out) {
+        return false;
+    }
+
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(NVS_NS, NVS_READONLY, &handle);
+    if (ret != ESP_OK) {
+        return false;
+    }
+
+    gatt_cache_blob_t blob;
+    const bool found = read_gatt_cache(handle, &blob) && memcmp(blob.bda, bda, ESP_BD_ADDR_LEN) == 0;
+    nvs_close(handle);
+
+    if (found) {
+        *out = blob.handles;
+    }
+    return found;
+}
+
+esp_err_t product_nvs_set_gatt_handles(const esp_bd_addr_t bda, const ble_gatt_handles_t *handles) {
+    if (!bda || bda_is_zero(bda) || !handles) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(NVS_NS, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    gatt_cache_blob_t blob;
+    memset(&blob, 0, sizeof(blob));
+    blob.version = GATT_CACHE_VERSION;
+    memcpy(blob.bda, bda, ESP_BD_ADDR_LEN);
+    blob.handles = *handles;
+
+    // Reconnects mostly find the same handles, skip the flash write then
+    gatt_cache_blob_t stored;
+    if (read_gatt_cache(handle, &stored) && memcmp(&stored, &blob, sizeof(blob)) == 0) {
+        nvs_close(handle);
+        return ESP_OK;
+    }
+
+    ret = nvs_set_blob(handle, KEY_CAM_GATT, &blob, sizeof(blob));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return ret;
+}
+
 bool product_nvs_get_paired(void) {
     nvs_handle_t handle;
     esp_err_t ret = nvs_open(NVS_NS, NVS_READONLY, &handle);
@@ -159,6 +229,7 @@ esp_err_t product_nvs_factory_reset(void) {
     (void)nvs_erase_key(handle, KEY_CAM_BDA);
     (void)nvs_erase_key(handle, KEY_PAIRED);
     (void)nvs_erase_key(handle, KEY_DEVICE_ID);
+    (void)nvs_erase_key(handle, KEY_CAM_GATT);
 
     ret = nvs_commit(handle);
     nvs_close(handle);
@@ -11,6 +11,7 @@
 
 #include "esp_err.h"
 #include "esp_bt_defs.h"
+#include "ble.h"
 
 esp_err_t product_nvs_init(void);
 
@@ -18,6 +19,9 @@ bool product_nvs_get_last_camera_bda(esp_bd_addr_t out_bda);
 esp_err_t product_nvs_set_last_camera_bda(const esp_bd_addr_t bda);
 esp_err_t product_nvs_clear_last_camera_bda(void);
 
+bool product_nvs_get_gatt_handles(const esp_bd_addr_t bda, ble_gatt_handles_t *out);
+esp_err_t product_nvs_set_gatt_handles(const esp_bd_addr_t bda, const ble_gatt_handles_t *handles);
+
 bool product_nvs_get_paired(void);
 esp_err_t product_nvs_set_paired(bool paired);
 
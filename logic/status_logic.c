@@ -129,7 +129,7 @@ int subscript_camera_status(uint8_t push_mode, uint8_t push_freq) {
         .reserved = {0, 0, 0, 0}
     };
 
-    send_command(0x1D, 0x05, CMD_NO_RESPONSE, &command_frame, seq, 5000);
+    send_command(0x1D, 0x05, CMD_NO_RESPONSE, &command_frame, seq, 5000, NULL);
 
     return 0;
 }
@@ -141,10 +141,10 @@ int subscript_camera_status(uint8_t push_mode, uint8_t push_freq) {
  * Process and update various camera states, check for state changes and print updated information.
  * 处理并更新相机的各项状态，检查状态是否发生变化并打印更新后的信息。
  * 
- * @param data Input camera status data
- *             传入的相机状态数据
+ * @param data Input camera status data, borrowed from the data layer for the duration of the call
+ *             传入的相机状态数据，仅在调用期间从数据层借用
  */
-void update_camera_state_handler(void *data) {
+void update_camera_state_handler(const void *data) {
     if (!data) {
         ESP_LOGE(TAG, "logic_update_camera_state: Received NULL data.");
         return;
@@ -240,11 +240,9 @@ void update_camera_state_handler(void *data) {
     if (state_changed) {
         print_camera_status();
     }
-
-    free(data);
 }
 
-void update_new_camera_state_handler(void *data) {
+void update_new_camera_state_handler(const void *data) {
     if (!data) {
         ESP_LOGE(TAG, "update_new_camera_state_handler: Received NULL data.");
         return;
@@ -295,6 +293,4 @@ void update_new_camera_state_handler(void *data) {
     ESP_LOGI(TAG, "[1D06] Mode parameters: %s", mode_param_str);
 
     ESP_LOGI(TAG, "[1D06] ==========================================");
-
-    free(data);
 }
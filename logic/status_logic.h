@@ -37,8 +37,8 @@ void print_camera_status();
 
 int subscript_camera_status(uint8_t push_mode, uint8_t push_freq);
 
-void update_camera_state_handler(void *data);
+void update_camera_state_handler(const void *data);
 
-void update_new_camera_state_handler(void *data);
+void update_new_camera_state_handler(const void *data);
 
 #endif
\ No newline at end of file
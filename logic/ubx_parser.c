@@ -0,0 +1,305 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#include <string.h>
+
+#include "ubx_parser.h"
+
+/* 解码器状态：正在等待的帧字段 */
+/* Decoder states: the frame field being waited for */
+enum {
+    UBX_STATE_SYNC_1 = 0,
+    UBX_STATE_SYNC_2,
+    UBX_STATE_CLASS,
+    UBX_STATE_ID,
+    UBX_STATE_LENGTH_LOW,
+    UBX_STATE_LENGTH_HIGH,
+    UBX_STATE_PAYLOAD,
+    UBX_STATE_CHECKSUM_A,
+    UBX_STATE_CHECKSUM_B,
+};
+
+/* NAV-PVT 负载中各字段的偏移 */
+/* Field offsets in the NAV-PVT payload */
+enum {
+    PVT_ITOW = 0,
+    PVT_YEAR = 4,
+    PVT_MONTH = 6,
+    PVT_DAY = 7,
+    PVT_HOUR = 8,
+    PVT_MINUTE = 9,
+    PVT_SECOND = 10,
+    PVT_VALID = 11,
+    PVT_NANO = 16,
+    PVT_FIX_TYPE = 20,
+    PVT_FLAGS = 21,
+    PVT_NUM_SV = 23,
+    PVT_LONGITUDE = 24,
+    PVT_LATITUDE = 28,
+    PVT_HEIGHT_MSL = 36,
+    PVT_H_ACC = 40,
+    PVT_V_ACC = 44,
+    PVT_VEL_N = 48,
+    PVT_VEL_E = 52,
+    PVT_VEL_D = 56,
+    PVT_G_SPEED = 60,
+    PVT_HEAD_MOT = 64,
+    PVT_S_ACC = 68,
+    PVT_PDOP = 76,
+};
+
+static inline uint16_t read_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t read_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline int32_t read_i32(const uint8_t *p) {
+    return (int32_t)read_u32(p);
+}
+
+static inline void checksum_add(ubx_decoder_t *decoder, uint8_t c) {
+    decoder->checksum_a = (uint8_t)(decoder->checksum_a + c);
+    decoder->checksum_b = (uint8_t)(decoder->checksum_b + decoder->checksum_a);
+}
+
+/**
+ * @brief Forget any partial frame, e.g. after the UART dropped bytes
+ *        丢弃未完成的帧，例如在 UART 丢失数据之后
+ */
+void ubx_decoder_reset(ubx_decoder_t *decoder) {
+    decoder->state = UBX_STATE_SYNC_1;
+    decoder->received = 0;
+}
+
+/**
+ * @brief Feed one read and hand every frame it completes to a handler
+ *        送入一次读取的数据，并将其补齐的每个帧交给处理函数
+ *
+ * Bytes outside a frame, e.g. NMEA text, are skipped while searching for the sync characters. A frame
+ * with a wrong checksum or a length above UBX_MAX_PAYLOAD_LENGTH is counted and dropped, and the
+ * search resumes at the byte after it, so a corrupted length costs at most that frame's bytes.
+ * 帧之外的字节（例如 NMEA 文本）在搜索同步字符时被跳过。校验和错误或长度超过 UBX_MAX_PAYLOAD_LENGTH
+ * 的帧只计数并丢弃，并从其后的字节继续搜索，因此损坏的长度最多影响该帧的字节。
+ *
+ * @param decoder Decoder state, kept across reads
+ *                解码器状态，跨读取保留
+ * @param data Bytes from the UART, any length
+ *             来自 UART 的数据，长度任意
+ * @param length Bytes in data
+ *               data 的字节数
+ * @param handler Called once per completed frame with a valid checksum, may be NULL
+ *                每个补齐且校验和正确的帧调用一次，可为 NULL
+ * @param ctx Passed through to handler
+ *            透传给 handler
+ * @return size_t Number of frames handed to handler
+ *                交给 handler 的帧数
+ */
+size_t ubx_decoder_feed(ubx_decoder_t *decoder, const uint8_t *data, size_t length, ubx_frame_handler_t handler,
+                        void *ctx) {
+    size_t frames = 0;
+    const uint8_t *p = data;
+    const uint8_t *end = data + length;
+
+    while (p < end) {
+        // 负载整块拷贝，不逐字节经过状态机
+        // The payload is copied as a block rather than byte by byte through the state machine
+        if (decoder->state == UBX_STATE_PAYLOAD) {
+            size_t take = (size_t)(end - p);
+            if (take > (size_t)(decoder->length - decoder->received)) {
+                take = (size_t)(decoder->length - decoder->received);
+            }
+            memcpy(decoder->payload + decoder->received, p, take);
+            for (size_t i = 0; i < take; i++) {
+                checksum_add(decoder, p[i]);
+            }
+            decoder->received = (uint16_t)(decoder->received + take);
+            p += take;
+            if (decoder->received == decoder->length) {
+                decoder->state = UBX_STATE_CHECKSUM_A;
+            }
+            continue;
+        }
+        if (decoder->state == UBX_STATE_SYNC_1) {
+            const uint8_t *sync = memchr(p, UBX_SYNC_CHAR_1, (size_t)(end - p));
+            if (sync == NULL) {
+                break;
+            }
+            p = sync + 1;
+            decoder->state = UBX_STATE_SYNC_2;
+            continue;
+        }
+
+        uint8_t c = *p++;
+        switch (decoder->state) {
+            case UBX_STATE_SYNC_2:
+                if (c == UBX_SYNC_CHAR_2) {
+                    decoder->checksum_a = 0;
+                    decoder->checksum_b = 0;
+                    decoder->state = UBX_STATE_CLASS;
+                } else if (c != UBX_SYNC_CHAR_1) {
+                    decoder->state = UBX_STATE_SYNC_1;
+                }
+                break;
+            case UBX_STATE_CLASS:
+                decoder->msg_class = c;
+                checksum_add(decoder, c);
+                decoder->state = UBX_STATE_ID;
+                break;
+            case UBX_STATE_ID:
+                decoder->msg_id = c;
+                checksum_add(decoder, c);
+                decoder->state = UBX_STATE_LENGTH_LOW;
+                break;
+            case UBX_STATE_LENGTH_LOW:
+                decoder->length = c;
+                checksum_add(decoder, c);
+                decoder->state = UBX_STATE_LENGTH_HIGH;
+                break;
+            case UBX_STATE_LENGTH_HIGH:
+                decoder->length = (uint16_t)(decoder->length | (c << 8));
+                checksum_add(decoder, c);
+                decoder->received = 0;
+                if (decoder->length > UBX_MAX_PAYLOAD_LENGTH) {
+                    decoder->stats.oversize++;
+                    decoder->state = UBX_STATE_SYNC_1;
+                } else {
+                    decoder->state = decoder->length > 0 ? UBX_STATE_PAYLOAD : UBX_STATE_CHECKSUM_A;
+                }
+                break;
+            case UBX_STATE_CHECKSUM_A:
+                if (c == decoder->checksum_a) {
+                    decoder->state = UBX_STATE_CHECKSUM_B;
+                } else {
+                    decoder->stats.bad++;
+                    decoder->state = UBX_STATE_SYNC_1;
+                }
+                break;
+            case UBX_STATE_CHECKSUM_B:
+                decoder->state = UBX_STATE_SYNC_1;
+                if (c != decoder->checksum_b) {
+                    decoder->stats.bad++;
+                    break;
+                }
+                decoder->stats.good++;
+                frames++;
+                if (handler != NULL) {
+                    ubx_frame_t frame = {
+                        .msg_class = decoder->msg_class,
+                        .msg_id = decoder->msg_id,
+                        .length = decoder->length,
+                        .payload = decoder->payload,
+                    };
+                    handler(&frame, ctx);
+                }
+                break;
+            default:
+                decoder->state = UBX_STATE_SYNC_1;
+                break;
+        }
+    }
+    return frames;
+}
+
+/**
+ * @brief Decode a NAV-PVT frame
+ *        解码 NAV-PVT 帧
+ *
+ * @return int 0 on success, -1 if the frame is not a NAV-PVT of the expected length
+ *             成功返回 0，帧不是预期长度的 NAV-PVT 时返回 -1
+ */
+int ubx_parse_nav_pvt(const ubx_frame_t *frame, ubx_nav_pvt_t *out) {
+    if (frame->msg_class != UBX_CLASS_NAV || frame->msg_id != UBX_ID_NAV_PVT || frame->length < UBX_NAV_PVT_LENGTH) {
+        return -1;
+    }
+    const uint8_t *p = frame->payload;
+    out->itow_ms = read_u32(p + PVT_ITOW);
+    out->year = read_u16(p + PVT_YEAR);
+    out->month = p[PVT_MONTH];
+    out->day = p[PVT_DAY];
+    out->hour = p[PVT_HOUR];
+    out->minute = p[PVT_MINUTE];
+    out->second = p[PVT_SECOND];
+    out->valid = p[PVT_VALID];
+    out->nano_ns = read_i32(p + PVT_NANO);
+    out->fix_type = p[PVT_FIX_TYPE];
+    out->flags = p[PVT_FLAGS];
+    out->num_sv = p[PVT_NUM_SV];
+    out->longitude_e7 = read_i32(p + PVT_LONGITUDE);
+    out->latitude_e7 = read_i32(p + PVT_LATITUDE);
+    out->height_msl_mm = read_i32(p + PVT_HEIGHT_MSL);
+    out->horizontal_accuracy_mm = read_u32(p + PVT_H_ACC);
+    out->vertical_accuracy_mm = read_u32(p + PVT_V_ACC);
+    out->velocity_north_mm_s = read_i32(p + PVT_VEL_N);
+    out->velocity_east_mm_s = read_i32(p + PVT_VEL_E);
+    out->velocity_down_mm_s = read_i32(p + PVT_VEL_D);
+    out->ground_speed_mm_s = read_i32(p + PVT_G_SPEED);
+    out->heading_motion_e5 = read_i32(p + PVT_HEAD_MOT);
+    out->speed_accuracy_mm_s = read_u32(p + PVT_S_ACC);
+    out->pdop_x100 = read_u16(p + PVT_PDOP);
+    return 0;
+}
+
+/**
+ * @brief Whether the solution is a valid 2D/3D fix with a valid UTC date and time
+ *        导航解是否为有效的 2D/3D 定位，且 UTC 日期与时间有效
+ */
+bool ubx_nav_pvt_fix_ok(const ubx_nav_pvt_t *pvt) {
+    uint8_t date_time = UBX_NAV_PVT_VALID_DATE | UBX_NAV_PVT_VALID_TIME;
+    return (pvt->flags & UBX_NAV_PVT_GNSS_FIX_OK) && (pvt->valid & date_time) == date_time &&
+           pvt->fix_type >= UBX_FIX_TYPE_2D && pvt->fix_type <= UBX_FIX_TYPE_GNSS_DR;
+}
+
+/**
+ * @brief Build a frame around a payload, e.g. a configuration command for the receiver
+ *        为负载加上帧头与校验，例如发给接收机的配置命令
+ *
+ * @param out Output buffer, at least length + UBX_FRAME_OVERHEAD bytes
+ *            输出缓冲区，至少 length + UBX_FRAME_OVERHEAD 字节
+ * @param size Bytes available in out
+ *             out 的可用字节数
+ * @return size_t Frame bytes written, 0 if it does not fit
+ *                写入的帧字节数，放不下时返回 0
+ */
+size_t ubx_build_frame(uint8_t msg_class, uint8_t msg_id, const uint8_t *payload, uint16_t length, uint8_t *out,
+                       size_t size) {
+    size_t total = (size_t)length + UBX_FRAME_OVERHEAD;
+    if (out == NULL || size < total || (payload == NULL && length > 0)) {
+        return 0;
+    }
+    out[0] = UBX_SYNC_CHAR_1;
+    out[1] = UBX_SYNC_CHAR_2;
+    out[2] = msg_class;
+    out[3] = msg_id;
+    out[4] = (uint8_t)(length & 0xFF);
+    out[5] = (uint8_t)(length >> 8);
+    if (length > 0) {
+        memcpy(out + 6, payload, length);
+    }
+    uint8_t a = 0, b = 0;
+    for (size_t i = 2; i < total - 2; i++) {
+        a = (uint8_t)(a + out[i]);
+        b = (uint8_t)(b + a);
+    }
+    out[total - 2] = a;
+    out[total - 1] = b;
+    return total;
+}
@@ -0,0 +1,156 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#ifndef __UBX_PARSER_H__
+#define __UBX_PARSER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* UBX 帧格式：0xB5 0x62、类、ID、2 字节小端长度、负载、2 字节 Fletcher 校验 */
+/* UBX frame layout: 0xB5 0x62, class, ID, 2-byte little-endian length, payload, 2-byte Fletcher checksum */
+#define UBX_SYNC_CHAR_1     0xB5
+#define UBX_SYNC_CHAR_2     0x62
+#define UBX_FRAME_OVERHEAD  8
+
+/* 解码器可接收的最大负载，NAV-PVT 为 92 字节，更长的帧被丢弃 */
+/* Largest payload the decoder accepts; NAV-PVT is 92 bytes, longer frames are dropped */
+#define UBX_MAX_PAYLOAD_LENGTH 100
+
+#define UBX_CLASS_NAV       0x01
+#define UBX_ID_NAV_PVT      0x07
+#define UBX_NAV_PVT_LENGTH  92
+
+#define UBX_CLASS_CFG       0x06
+#define UBX_ID_CFG_VALSET   0x8A
+
+/* NAV-PVT 字段取值 */
+/* NAV-PVT field values */
+#define UBX_NAV_PVT_VALID_DATE  0x01    // valid: UTC date is valid
+                                        // valid：UTC 日期有效
+#define UBX_NAV_PVT_VALID_TIME  0x02    // valid: UTC time of day is valid
+                                        // valid：UTC 时间有效
+#define UBX_NAV_PVT_GNSS_FIX_OK 0x01    // flags: fix within the receiver's accuracy masks
+                                        // flags：定位满足接收机的精度门限
+#define UBX_FIX_TYPE_2D         2
+#define UBX_FIX_TYPE_3D         3
+#define UBX_FIX_TYPE_GNSS_DR    4
+
+/**
+ * @brief Frame counters by checksum result
+ *        按校验结果统计的帧计数
+ */
+typedef struct {
+    uint32_t good;              // Checksum matched, handed to the handler
+                                // 校验通过，已交给处理函数
+    uint32_t bad;               // Checksum did not match, dropped
+                                // 校验不匹配，已丢弃
+    uint32_t oversize;          // Length above UBX_MAX_PAYLOAD_LENGTH, dropped
+                                // 长度超过 UBX_MAX_PAYLOAD_LENGTH，已丢弃
+} ubx_frame_stats_t;
+
+/**
+ * @brief One frame with a valid checksum; payload points into the decoder and is only valid in the handler
+ *        一个校验和正确的帧；payload 指向解码器内部，仅在处理函数中有效
+ */
+typedef struct {
+    uint8_t msg_class;
+    uint8_t msg_id;
+    uint16_t length;            // Payload bytes
+                                // 负载字节数
+    const uint8_t *payload;
+} ubx_frame_t;
+
+typedef void (*ubx_frame_handler_t)(const ubx_frame_t *frame, void *ctx);
+
+/**
+ * @brief Reassembles frames from reads that split them at arbitrary points
+ *        将在任意位置被拆分的读取数据重新组装为完整帧
+ *
+ * A byte-wise state machine for the header and checksum; the payload is copied in one block per read.
+ * 帧头与校验逐字节用状态机处理，负载每次读取整块拷贝。
+ */
+typedef struct {
+    uint8_t state;              // Position in the frame, internal
+                                // 在帧中的位置，内部使用
+    uint8_t msg_class;
+    uint8_t msg_id;
+    uint8_t checksum_a;         // Running Fletcher sums over class, ID, length and payload
+                                // 对类、ID、长度与负载累计的 Fletcher 校验
+    uint8_t checksum_b;
+    uint16_t length;
+    uint16_t received;          // Payload bytes received so far
+                                // 已接收的负载字节数
+    uint8_t payload[UBX_MAX_PAYLOAD_LENGTH];
+    ubx_frame_stats_t stats;    // Frames seen, by checksum result
+                                // 按校验结果统计的帧数
+} ubx_decoder_t;
+
+/**
+ * @brief Navigation solution from NAV-PVT, in the message's own units
+ *        NAV-PVT 中的导航解，单位与报文一致
+ */
+typedef struct {
+    uint32_t itow_ms;           // GPS time of week (ms)
+                                // GPS 周内时 (毫秒)
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint8_t valid;              // UBX_NAV_PVT_VALID_* bits
+                                // UBX_NAV_PVT_VALID_* 标志位
+    int32_t nano_ns;            // Fraction of the second, may be negative
+                                // 秒的小数部分，可为负
+    uint8_t fix_type;
+    uint8_t flags;              // UBX_NAV_PVT_GNSS_FIX_OK ...
+    uint8_t num_sv;             // Satellites used in the solution
+                                // 参与解算的卫星数
+    int32_t longitude_e7;       // 1e-7 degrees
+                                // 1e-7 度
+    int32_t latitude_e7;
+    int32_t height_msl_mm;      // Height above mean sea level (mm), as GGA reports it
+                                // 平均海平面以上高度 (毫米)，与 GGA 一致
+    uint32_t horizontal_accuracy_mm;
+    uint32_t vertical_accuracy_mm;
+    int32_t velocity_north_mm_s;
+    int32_t velocity_east_mm_s;
+    int32_t velocity_down_mm_s;
+    int32_t ground_speed_mm_s;
+    int32_t heading_motion_e5;  // Course over ground (1e-5 degrees)
+                                // 对地航向 (1e-5 度)
+    uint32_t speed_accuracy_mm_s;
+    uint16_t pdop_x100;
+} ubx_nav_pvt_t;
+
+void ubx_decoder_reset(ubx_decoder_t *decoder);
+
+size_t ubx_decoder_feed(ubx_decoder_t *decoder, const uint8_t *data, size_t length, ubx_frame_handler_t handler,
+                        void *ctx);
+
+int ubx_parse_nav_pvt(const ubx_frame_t *frame, ubx_nav_pvt_t *out);
+
+bool ubx_nav_pvt_fix_ok(const ubx_nav_pvt_t *pvt);
+
+size_t ubx_build_frame(uint8_t msg_class, uint8_t msg_id, const uint8_t *payload, uint16_t length, uint8_t *out,
+                       size_t size);
+
+#endif
@@ -25,6 +25,8 @@
 #include "key_logic.h"
 #include "light_logic.h"
 #include "product_config.h"
+#include "custom_crc16.h"
+#include "custom_crc32.h"
 
 #include "sdkconfig.h"
 
@@ -48,6 +50,15 @@ void app_main(void) {
     int res = 0;
     ESP_LOGI("APP", "DJI Osmo Action single-button remote v%s", PRODUCT_VERSION);
 
+    /* Check the CRC kernels, a failing one falls back to the byte-at-a-time path */
+    /* 校验 CRC 内核，未通过时回退到逐字节计算 */
+    if (!crc16_self_test()) {
+        ESP_LOGE("APP", "CRC-16 self-test failed, using byte-at-a-time kernel");
+    }
+    if (!crc32_self_test()) {
+        ESP_LOGE("APP", "CRC-32 self-test failed, using byte-at-a-time kernel");
+    }
+
     /* Initialize RGB light */
     /* 初始化氛围灯 */
     res = init_light_logic();
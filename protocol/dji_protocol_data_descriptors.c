@@ -28,74 +28,156 @@
 
 /* Structure support, but need to define creator and parser for each structure */
 /* 结构体支持，但要为每个结构体定义 creator 和 parser */
+
+/**
+ * Every supported command, one X(cmd_set, cmd_id, creator, parser) per line. The descriptor
+ * array and the dispatch index below are both generated from this list. cmd_set must be
+ * spelled exactly as in DATA_DESCRIPTOR_CMD_SETS.
+ * 所有支持的命令，每行一个 X(cmd_set, cmd_id, creator, parser)。下方的描述符数组和分发索引均由此列表生成，
+ * cmd_set 的写法必须与 DATA_DESCRIPTOR_CMD_SETS 中完全一致。
+ */
+#define DATA_DESCRIPTOR_TABLE(X) \
+    /* Camera mode switch */ \
+    /* 拍摄模式切换 */ \
+    X(0x1D, 0x04, camera_mode_switch_creator, camera_mode_switch_parser) \
+    /* Version query */ \
+    /* 版本号查询 */ \
+    X(0x00, 0x00, NULL, version_query_parser) \
+    /* Record control */ \
+    /* 拍录控制 */ \
+    X(0x1D, 0x03, record_control_creator, record_control_parser) \
+    /* GPS data push */ \
+    /* GPS 数据推送 */ \
+    X(0x00, 0x17, gps_data_creator, gps_data_parser) \
+    /* Connection request */ \
+    /* 连接请求 */ \
+    X(0x00, 0x19, connection_data_creator, connection_data_parser) \
+    /* Camera status subscription */ \
+    /* 相机状态订阅 */ \
+    X(0x1D, 0x05, camera_status_subscription_creator, NULL) \
+    /* Camera status push */ \
+    /* 相机状态推送 */ \
+    X(0x1D, 0x02, NULL, camera_status_push_data_parser) \
+    /* New Camera status push */ \
+    /* 新相机状态推送 */ \
+    X(0x1D, 0x06, NULL, new_camera_status_push_data_parser) \
+    /* Key report */ \
+    /* 按键上报 */ \
+    X(0x00, 0x11, key_report_creator, key_report_parser)
+
+/**
+ * Command sets used in DATA_DESCRIPTOR_TABLE, each gets one 256-slot row of the dispatch index
+ * DATA_DESCRIPTOR_TABLE 中用到的命令集，每个命令集在分发索引中占一行 256 个槽位
+ */
+#define DATA_DESCRIPTOR_CMD_SETS(Y) \
+    Y(0x00) \
+    Y(0x1D)
+
+#define DESCRIPTOR_ENTRY(cmd_set, cmd_id, creator, parser) \
+    {cmd_set, cmd_id, (data_creator_func_t)creator, (data_parser_func_t)parser},
+
 const data_descriptor_t data_descriptors[] = {
-    // Camera mode switch
-    // 拍摄模式切换
-    {0x1D, 0x04, (data_creator_func_t)camera_mode_switch_creator, (data_parser_func_t)camera_mode_switch_parser},
-    // Version query
-    // 版本号查询
-    {0x00, 0x00, NULL, (data_parser_func_t)version_query_parser},
-    // Record control
-    // 拍录控制
-    {0x1D, 0x03, (data_creator_func_t)record_control_creator, (data_parser_func_t)record_control_parser},
-    // GPS data push
-    // GPS 数据推送
-    {0x00, 0x17, (data_creator_func_t)gps_data_creator, (data_parser_func_t)gps_data_parser},
-    // Connection request
-    // 连接请求
-    {0x00, 0x19, (data_creator_func_t)connection_data_creator, (data_parser_func_t)connection_data_parser},
-    // Camera status subscription
-    // 相机状态订阅
-    {0x1D, 0x05, (data_creator_func_t)camera_status_subscription_creator, NULL},
-    // Camera status push
-    // 相机状态推送
-    {0x1D, 0x02, NULL, (data_parser_func_t)camera_status_push_data_parser},
-    // New Camera status push
-    // 新相机状态推送
-    {0x1D, 0x06, NULL, (data_parser_func_t)new_camera_status_push_data_parser},
-    // Key report
-    // 按键上报
-    {0x00, 0x11, (data_creator_func_t)key_report_creator, (data_parser_func_t)key_report_parser},
+    DATA_DESCRIPTOR_TABLE(DESCRIPTOR_ENTRY)
 };
 const size_t DATA_DESCRIPTORS_COUNT = sizeof(data_descriptors) / sizeof(data_descriptors[0]);
 
+/* Position of every descriptor in data_descriptors[] */
+/* 每个描述符在 data_descriptors[] 中的位置 */
+#define DESCRIPTOR_POSITION(cmd_set, cmd_id, creator, parser) DESCRIPTOR_POSITION_##cmd_set##_##cmd_id,
+enum {
+    DATA_DESCRIPTOR_TABLE(DESCRIPTOR_POSITION)
+    DESCRIPTOR_POSITION_COUNT
+};
+
+/* Row of every command set in data_descriptor_index */
+/* 每个命令集在 data_descriptor_index 中的行号 */
+#define DESCRIPTOR_ROW(cmd_set) DESCRIPTOR_ROW_##cmd_set,
+enum {
+    DATA_DESCRIPTOR_CMD_SETS(DESCRIPTOR_ROW)
+    DESCRIPTOR_ROW_COUNT
+};
+
+_Static_assert(DESCRIPTOR_POSITION_COUNT < 255, "data_descriptor_index stores positions as uint8_t");
+_Static_assert(DESCRIPTOR_ROW_COUNT < 255, "data_descriptor_cmd_set_row stores rows as uint8_t");
+
+/**
+ * Dispatch index used by find_data_descriptor: cmd_set selects a row, cmd_id a slot in it.
+ * Both hold the row or position plus one, so the zero-filled slots mean "not supported".
+ * find_data_descriptor 使用的分发索引：cmd_set 选择行，cmd_id 选择行内槽位。
+ * 两者均保存行号或位置加一，因此零填充的槽位表示“不支持”。
+ */
+#define DESCRIPTOR_CMD_SET_ROW(cmd_set) [cmd_set] = DESCRIPTOR_ROW_##cmd_set + 1,
+const uint8_t data_descriptor_cmd_set_row[256] = {
+    DATA_DESCRIPTOR_CMD_SETS(DESCRIPTOR_CMD_SET_ROW)
+};
+
+#define DESCRIPTOR_INDEX(cmd_set, cmd_id, creator, parser) \
+    [DESCRIPTOR_ROW_##cmd_set][cmd_id] = DESCRIPTOR_POSITION_##cmd_set##_##cmd_id + 1,
+const uint8_t data_descriptor_index[][256] = {
+    [DESCRIPTOR_ROW_COUNT - 1] = {0},
+    DATA_DESCRIPTOR_TABLE(DESCRIPTOR_INDEX)
+};
+
+/**
+ * Never called, fails the build with "duplicate case value" if two lines of
+ * DATA_DESCRIPTOR_TABLE share (cmd_set, cmd_id), however the numbers are spelled
+ * 从不调用；若 DATA_DESCRIPTOR_TABLE 中有两行 (cmd_set, cmd_id) 相同，无论数字如何书写，
+ * 都会以 "duplicate case value" 使编译失败
+ */
+#define DESCRIPTOR_KEY_CASE(cmd_set, cmd_id, creator, parser) case ((cmd_set) << 8) | (cmd_id):
+static inline void data_descriptor_duplicate_check(int key) {
+    switch (key) {
+    DATA_DESCRIPTOR_TABLE(DESCRIPTOR_KEY_CASE)
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * Serialize a packed structure into the caller's buffer
+ * 将紧凑结构体序列化到调用方缓冲区
+ *
+ * Every creator goes through here. The size is always reported, so a call with data_out NULL
+ * sizes the buffer and a second call fills it.
+ * 所有 creator 都经由此函数。无论是否写入都会返回所需长度，因此可先以 data_out 为 NULL 调用获取大小，再调用一次写入。
+ *
+ * @return 0 on success or for a size query, -3 if data_capacity is too small
+ *         成功或仅查询大小时返回 0，data_capacity 不足时返回 -3
+ */
+static int encode_structure(const void *structure, size_t structure_size, uint8_t *data_out, size_t data_capacity, size_t *data_length) {
+    *data_length = structure_size;
+    if (data_out == NULL) {
+        return 0;
+    }
+    if (data_capacity < structure_size) {
+        ESP_LOGE(TAG, "Output buffer too small: need %zu, have %zu", structure_size, data_capacity);
+        return -3;
+    }
+    memcpy(data_out, structure, structure_size);
+    return 0;
+}
+
 /* Structure support creators and parsers
  * 结构体支持的 creator 和 parser */
-uint8_t* camera_mode_switch_creator(const void *structure, size_t *data_length, uint8_t cmd_type) {
+int camera_mode_switch_creator(const void *structure, uint8_t *data_out, size_t data_capacity, size_t *data_length, uint8_t cmd_type) {
     if (structure == NULL || data_length == NULL) {
         ESP_LOGE(TAG, "Invalid input: structure or data_length is NULL");
-        return NULL;
+        return -1;
     }
 
-    uint8_t *data = NULL;
-
     // Check if it's a command frame
     // 判断是否为命令帧
     if ((cmd_type & 0x20) == 0) {
-        const camera_mode_switch_command_frame_t *command_frame = 
-            (const camera_mode_switch_command_frame_t *)structure;
+        ESP_LOGI(TAG, "Data length calculated for camera_mode_switch_command_frame: %zu", sizeof(camera_mode_switch_command_frame_t));
 
-        *data_length = sizeof(camera_mode_switch_command_frame_t);
-        
-        ESP_LOGI(TAG, "Data length calculated for camera_mode_switch_command_frame: %zu", *data_length);
-
-        data = (uint8_t *)malloc(*data_length);
-        if (data == NULL) {
-            ESP_LOGE(TAG, "Memory allocation failed in camera_mode_switch_creator");
-            return NULL;
-        }
-
-        ESP_LOGI(TAG, "Memory allocation succeeded for command frame, copying data...");
-        
-        memcpy(data, command_frame, *data_length);
+        return encode_structure(structure, sizeof(camera_mode_switch_command_frame_t), data_out, data_capacity, data_length);
     } else {
         // 暂不支持此功能的应答帧创建
         // Response frame creation for this functionality is not yet supported.
         ESP_LOGE(TAG, "Response frames are not supported in camera_mode_switch_creator");
-        return NULL;
+        return -1;
     }
-
-    return data;
 }
 
 int camera_mode_switch_parser(const uint8_t *data, size_t data_length, void *structure_out, uint8_t cmd_type) {
@@ -175,37 +257,20 @@ int version_query_parser(const uint8_t *data, size_t data_length, void *structur
     return 0;
 }
 
-uint8_t* record_control_creator(const void *structure, size_t *data_length, uint8_t cmd_type) {
+int record_control_creator(const void *structure, uint8_t *data_out, size_t data_capacity, size_t *data_length, uint8_t cmd_type) {
     if (structure == NULL || data_length == NULL) {
         ESP_LOGE(TAG, "Invalid input: structure or data_length is NULL");
-        return NULL;
+        return -1;
     }
 
-    uint8_t *data = NULL;
-
     if ((cmd_type & 0x20) == 0) {
-        const record_control_command_frame_t *command_frame = 
-            (const record_control_command_frame_t *)structure;
-
-        *data_length = sizeof(record_control_command_frame_t);
-        
-        ESP_LOGI(TAG, "Data length calculated for record_control_command_frame: %zu", *data_length);
-
-        data = (uint8_t *)malloc(*data_length);
-        if (data == NULL) {
-            ESP_LOGE(TAG, "Memory allocation failed in record_control_creator");
-            return NULL;
-        }
+        ESP_LOGI(TAG, "Data length calculated for record_control_command_frame: %zu", sizeof(record_control_command_frame_t));
 
-        ESP_LOGI(TAG, "Memory allocation succeeded for command frame, copying data...");
-        
-        memcpy(data, command_frame, *data_length);
+        return encode_structure(structure, sizeof(record_control_command_frame_t), data_out, data_capacity, data_length);
     } else {
         ESP_LOGE(TAG, "Response frames are not supported in record_control_creator");
-        return NULL;
+        return -1;
     }
-
-    return data;
 }
 
 int record_control_parser(const uint8_t *data, size_t data_length, void *structure_out, uint8_t cmd_type) {
@@ -237,48 +302,21 @@ int record_control_parser(const uint8_t *data, size_t data_length, void *structu
     return 0;
 }
 
-uint8_t* gps_data_creator(const void *structure, size_t *data_length, uint8_t cmd_type) {
+int gps_data_creator(const void *structure, uint8_t *data_out, size_t data_capacity, size_t *data_length, uint8_t cmd_type) {
     if (structure == NULL || data_length == NULL) {
         ESP_LOGE(TAG, "Invalid input: structure or data_length is NULL");
-        return NULL;
+        return -1;
     }
 
-    uint8_t *data = NULL;
-
     if ((cmd_type & 0x20) == 0) {
-        const gps_data_push_command_frame *gps_command_frame = (const gps_data_push_command_frame *)structure;
-
-        *data_length = sizeof(gps_data_push_command_frame);
+        ESP_LOGI(TAG, "Data length calculated for gps_data_push_command_frame: %zu", sizeof(gps_data_push_command_frame));
 
-        ESP_LOGI(TAG, "Data length calculated for gps_data_push_command_frame: %zu", *data_length);
-
-        data = (uint8_t *)malloc(*data_length);
-        if (data == NULL) {
-            ESP_LOGE(TAG, "Memory allocation failed in gps_data_creator (command frame)");
-            return NULL;
-        }
-
-        ESP_LOGI(TAG, "Memory allocation succeeded for command frame, copying data...");
-
-        memcpy(data, gps_command_frame, *data_length);
+        return encode_structure(structure, sizeof(gps_data_push_command_frame), data_out, data_capacity, data_length);
     } else {
-        const gps_data_push_response_frame *gps_response_frame = (const gps_data_push_response_frame *)structure;
-
-        *data_length = sizeof(gps_data_push_response_frame);
+        ESP_LOGI(TAG, "Data length calculated for gps_data_push_response_frame: %zu", sizeof(gps_data_push_response_frame));
 
-        ESP_LOGI(TAG, "Data length calculated for gps_data_push_response_frame: %zu", *data_length);
-
-        data = (uint8_t *)malloc(*data_length);
-        if (data == NULL) {
-            ESP_LOGE(TAG, "Memory allocation failed in gps_data_creator (response frame)");
-            return NULL;
-        }
-
-        ESP_LOGI(TAG, "Memory allocation succeeded for response frame, copying data...");
-
-        memcpy(data, gps_response_frame, *data_length);
+        return encode_structure(structure, sizeof(gps_data_push_response_frame), data_out, data_capacity, data_length);
     }
-    return data;
 }
 
 int gps_data_parser(const uint8_t *data, size_t data_length, void *structure_out, uint8_t cmd_type) {
@@ -307,45 +345,21 @@ int gps_data_parser(const uint8_t *data, size_t data_length, void *structure_out
     return 0;
 }
 
-uint8_t* connection_data_creator(const void *structure, size_t *data_length, uint8_t cmd_type) {
+int connection_data_creator(const void *structure, uint8_t *data_out, size_t data_capacity, size_t *data_length, uint8_t cmd_type) {
     if (structure == NULL || data_length == NULL) {
         ESP_LOGE(TAG, "connection_request_data_creator: NULL input detected");
-        return NULL;
+        return -1;
     }
 
-    uint8_t *data = NULL;
-
     if ((cmd_type & 0x20) == 0) {
-        const connection_request_command_frame *command_frame = (const connection_request_command_frame *)structure;
+        ESP_LOGI(TAG, "Data length calculated for connection_request_command_frame: %zu", sizeof(connection_request_command_frame));
 
-        *data_length = sizeof(connection_request_command_frame);
-
-        ESP_LOGI(TAG, "Data length calculated for connection_request_command_frame: %zu", *data_length);
-
-        data = (uint8_t *)malloc(*data_length);
-        if (data == NULL) {
-            ESP_LOGE(TAG, "Memory allocation failed in connection_request_data_creator (command frame)");
-            return NULL;
-        }
-
-        memcpy(data, command_frame, *data_length);
+        return encode_structure(structure, sizeof(connection_request_command_frame), data_out, data_capacity, data_length);
     } else {
-        const connection_request_response_frame *response_frame = (const connection_request_response_frame *)structure;
-
-        *data_length = sizeof(connection_request_response_frame);
+        ESP_LOGI(TAG, "Data length calculated for connection_request_response_frame: %zu", sizeof(connection_request_response_frame));
 
-        ESP_LOGI(TAG, "Data length calculated for connection_request_response_frame: %zu", *data_length);
-
-        data = (uint8_t *)malloc(*data_length);
-        if (data == NULL) {
-            ESP_LOGE(TAG, "Memory allocation failed in connection_request_data_creator (response frame)");
-            return NULL;
-        }
-
-        memcpy(data, response_frame, *data_length);
+        return encode_structure(structure, sizeof(connection_request_response_frame), data_out, data_capacity, data_length);
     }
-
-    return data;
 }
 
 int connection_data_parser(const uint8_t *data, size_t data_length, void *structure_out, uint8_t cmd_type) {
@@ -398,36 +412,20 @@ int connection_data_parser(const uint8_t *data, size_t data_length, void *struct
     }
 }
 
-uint8_t* camera_status_subscription_creator(const void *structure, size_t *data_length, uint8_t cmd_type) {
+int camera_status_subscription_creator(const void *structure, uint8_t *data_out, size_t data_capacity, size_t *data_length, uint8_t cmd_type) {
     if (structure == NULL || data_length == NULL) {
         ESP_LOGE(TAG, "Invalid input: structure or data_length is NULL");
-        return NULL;
+        return -1;
     }
 
-    uint8_t *data = NULL;
-
     if ((cmd_type & 0x20) == 0) {
-        const camera_status_subscription_command_frame *camera_command_frame = 
-            (const camera_status_subscription_command_frame *)structure;
+        ESP_LOGI(TAG, "Data length calculated for camera_status_subscription_command_frame: %zu", sizeof(camera_status_subscription_command_frame));
 
-        *data_length = sizeof(camera_status_subscription_command_frame);
-        
-        ESP_LOGI(TAG, "Data length calculated for camera_status_subscription_command_frame: %zu", *data_length);
-
-        data = (uint8_t *)malloc(*data_length);
-        if (data == NULL) {
-            ESP_LOGE(TAG, "Memory allocation failed in camera_status_subscription_creator");
-            return NULL;
-        }
-
-        ESP_LOGI(TAG, "Memory allocation succeeded for command frame, copying data...");
-        
-        memcpy(data, camera_command_frame, *data_length);
+        return encode_structure(structure, sizeof(camera_status_subscription_command_frame), data_out, data_capacity, data_length);
     } else {
         ESP_LOGE(TAG, "Response frames are not supported in camera_status_subscription_creator");
-        return NULL;
+        return -1;
     }
-    return data;
 }
 
 int camera_status_push_data_parser(const uint8_t *data, size_t data_length, void *structure_out, uint8_t cmd_type) {
@@ -518,37 +516,20 @@ int new_camera_status_push_data_parser(const uint8_t *data, size_t data_length,
     }
 }
 
-uint8_t* key_report_creator(const void *structure, size_t *data_length, uint8_t cmd_type) {
+int key_report_creator(const void *structure, uint8_t *data_out, size_t data_capacity, size_t *data_length, uint8_t cmd_type) {
     if (structure == NULL || data_length == NULL) {
         ESP_LOGE(TAG, "Invalid input: structure or data_length is NULL");
-        return NULL;
+        return -1;
     }
 
-    uint8_t *data = NULL;
-
     if ((cmd_type & 0x20) == 0) {
-        const key_report_command_frame_t *command_frame = 
-            (const key_report_command_frame_t *)structure;
-
-        *data_length = sizeof(key_report_command_frame_t);
-        
-        ESP_LOGI(TAG, "Data length calculated for key_report_command_frame: %zu", *data_length);
+        ESP_LOGI(TAG, "Data length calculated for key_report_command_frame: %zu", sizeof(key_report_command_frame_t));
 
-        data = (uint8_t *)malloc(*data_length);
-        if (data == NULL) {
-            ESP_LOGE(TAG, "Memory allocation failed in key_report_creator");
-            return NULL;
-        }
-
-        ESP_LOGI(TAG, "Memory allocation succeeded for command frame, copying data...");
-        
-        memcpy(data, command_frame, *data_length);
+        return encode_structure(structure, sizeof(key_report_command_frame_t), data_out, data_capacity, data_length);
     } else {
         ESP_LOGE(TAG, "Response frames are not supported in key_report_creator");
-        return NULL;
+        return -1;
     }
-
-    return data;
 }
 
 int key_report_parser(const uint8_t *data, size_t data_length, void *structure_out, uint8_t cmd_type) {
@@ -24,7 +24,7 @@
 
 /* Structure support */
 /* 结构体支持 */
-typedef uint8_t* (*data_creator_func_t)(const void *structure, size_t *data_length, uint8_t cmd_type);
+typedef int (*data_creator_func_t)(const void *structure, uint8_t *data_out, size_t data_capacity, size_t *data_length, uint8_t cmd_type);
 typedef int (*data_parser_func_t)(const uint8_t *data, size_t data_length, void *structure_out, uint8_t cmd_type);
 
 typedef struct {
@@ -32,35 +32,40 @@ typedef struct {
                                   // 命令集标识符 (CmdSet)
     uint8_t cmd_id;               // Command identifier (CmdID)
                                   // 命令标识符 (CmdID)
-    data_creator_func_t creator;  // Data creation function pointer
-                                  // 数据创建函数指针
+    data_creator_func_t creator;  // Serializes into a caller buffer, reports the size first
+                                  // 序列化到调用方缓冲区，并先给出所需长度
     data_parser_func_t parser;    // Data parsing function pointer
                                   // 数据解析函数指针
 } data_descriptor_t;
 extern const data_descriptor_t data_descriptors[];
 extern const size_t DATA_DESCRIPTORS_COUNT;
 
-uint8_t* camera_mode_switch_creator(const void *structure, size_t *data_length, uint8_t cmd_type);
+/* Direct-index dispatch generated from the descriptor list, see find_data_descriptor */
+/* 由描述符列表生成的直接索引分发表，参见 find_data_descriptor */
+extern const uint8_t data_descriptor_cmd_set_row[256];
+extern const uint8_t data_descriptor_index[][256];
+
+int camera_mode_switch_creator(const void *structure, uint8_t *data_out, size_t data_capacity, size_t *data_length, uint8_t cmd_type);
 int camera_mode_switch_parser(const uint8_t *data, size_t data_length, void *structure_out, uint8_t cmd_type);
 
 int version_query_parser(const uint8_t *data, size_t data_length, void *structure_out, uint8_t cmd_type);
 
-uint8_t* record_control_creator(const void *structure, size_t *data_length, uint8_t cmd_type);
+int record_control_creator(const void *structure, uint8_t *data_out, size_t data_capacity, size_t *data_length, uint8_t cmd_type);
 int record_control_parser(const uint8_t *data, size_t data_length, void *structure_out, uint8_t cmd_type);
 
-uint8_t* gps_data_creator(const void *structure, size_t *data_length, uint8_t cmd_type);
+int gps_data_creator(const void *structure, uint8_t *data_out, size_t data_capacity, size_t *data_length, uint8_t cmd_type);
 int gps_data_parser(const uint8_t *data, size_t data_length, void *structure_out, uint8_t cmd_type);
 
-uint8_t* connection_data_creator(const void *structure, size_t *data_length, uint8_t cmd_type);
+int connection_data_creator(const void *structure, uint8_t *data_out, size_t data_capacity, size_t *data_length, uint8_t cmd_type);
 int connection_data_parser(const uint8_t *data, size_t data_length, void *structure_out, uint8_t cmd_type);
 
-uint8_t* camera_status_subscription_creator(const void *structure, size_t *data_length, uint8_t cmd_type);
+int camera_status_subscription_creator(const void *structure, uint8_t *data_out, size_t data_capacity, size_t *data_length, uint8_t cmd_type);
 
 int camera_status_push_data_parser(const uint8_t *data, size_t data_length, void *structure_out, uint8_t cmd_type);
 
 int new_camera_status_push_data_parser(const uint8_t *data, size_t data_length, void *structure_out, uint8_t cmd_type);
 
-uint8_t* key_report_creator(const void *structure, size_t *data_length, uint8_t cmd_type);
+int key_report_creator(const void *structure, uint8_t *data_out, size_t data_capacity, size_t *data_length, uint8_t cmd_type);
 int key_report_parser(const uint8_t *data, size_t data_length, void *structure_out, uint8_t cmd_type);
 
 #endif
\ No newline at end of file
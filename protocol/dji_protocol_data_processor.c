@@ -37,12 +37,17 @@
  *         返回找到的数据描述符指针，如果未找到则返回NULL
  */
 const data_descriptor_t *find_data_descriptor(uint8_t cmd_set, uint8_t cmd_id) {
-    for (size_t i = 0; i < DATA_DESCRIPTORS_COUNT; ++i) {
-        if (data_descriptors[i].cmd_set == cmd_set && data_descriptors[i].cmd_id == cmd_id) {
-            return &data_descriptors[i];
-        }
+    // Two table loads regardless of how many descriptors exist
+    // 无论描述符有多少，都只需两次查表
+    uint8_t row = data_descriptor_cmd_set_row[cmd_set];
+    if (row == 0) {
+        return NULL;
+    }
+    uint8_t position = data_descriptor_index[row - 1][cmd_id];
+    if (position == 0) {
+        return NULL;
     }
-    return NULL;
+    return &data_descriptors[position - 1];
 }
 
 /**
@@ -70,6 +75,10 @@ int data_parser_by_structure(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type,
     // Find corresponding descriptor
     // 查找对应的命令描述符
     const data_descriptor_t *descriptor = find_data_descriptor(cmd_set, cmd_id);
+    if (descriptor == NULL) {
+        ESP_LOGW(TAG, "Descriptor not found for CmdSet: 0x%02X, CmdID: 0x%02X", cmd_set, cmd_id);
+        return -1;
+    }
 
     // Check if parser function exists
     // 检查解析函数是否存在
@@ -93,26 +102,31 @@ int data_parser_by_structure(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type,
  *                 命令类型
  * @param structure Input structure pointer
  *                  输入结构体指针
- * @param data_length Output data length
- *                    输出数据长度
- * @return Return pointer to created data buffer, NULL on failure
- *         返回创建的数据缓冲区指针，失败返回NULL
+ * @param data_out Buffer the payload is written into, NULL to only query the length
+ *                 写入负载的缓冲区，为 NULL 时仅查询长度
+ * @param data_capacity Size of data_out
+ *                      data_out 的大小
+ * @param data_length Output data length, set even when data_out is NULL
+ *                    输出数据长度，data_out 为 NULL 时同样会设置
+ * @return 0 on success, -1 if the command is not found or the creator rejects the input,
+ *         -2 if the command has no creator, -3 if data_capacity is too small
+ *         成功返回0，未找到命令或创建失败返回-1，无创建函数返回-2，缓冲区不足返回-3
  */
-uint8_t* data_creator_by_structure(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const void *structure, size_t *data_length) {
+int data_creator_by_structure(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const void *structure, uint8_t *data_out, size_t data_capacity, size_t *data_length) {
     // Find corresponding descriptor
     // 查找对应的命令描述符
     const data_descriptor_t *descriptor = find_data_descriptor(cmd_set, cmd_id);
     if (descriptor == NULL) {
         ESP_LOGW(TAG, "Descriptor not found for CmdSet: 0x%02X, CmdID: 0x%02X", cmd_set, cmd_id);
-        return NULL;
+        return -1;
     }
 
     // Check if creator function exists
     // 检查创建函数是否存在
     if (descriptor->creator == NULL) {
         ESP_LOGW(TAG, "Creator function is NULL for CmdSet: 0x%02X, CmdID: 0x%02X", cmd_set, cmd_id);
-        return NULL;
+        return -2;
     }
 
-    return descriptor->creator(structure, data_length, cmd_type);
+    return descriptor->creator(structure, data_out, data_capacity, data_length, cmd_type);
 }
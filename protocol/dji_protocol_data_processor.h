@@ -29,6 +29,6 @@ const data_descriptor_t *find_data_descriptor(uint8_t cmd_set, uint8_t cmd_id);
 
 int data_parser_by_structure(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const uint8_t *data, size_t data_length, void *output);
 
-uint8_t* data_creator_by_structure(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const void *structure, size_t *data_length);
+int data_creator_by_structure(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const void *structure, uint8_t *data_out, size_t data_capacity, size_t *data_length);
 
 #endif
\ No newline at end of file
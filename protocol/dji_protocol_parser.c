@@ -93,6 +93,54 @@
 
 
 
+/**
+ * Decode the fields of a frame that has already been checked
+ * 解码已校验过的帧的各字段
+ *
+ * Used by protocol_parse_notification and for frames emitted by the reassembler, which checks
+ * SOF, length and both CRCs itself
+ * 供 protocol_parse_notification 以及重组器输出的帧使用，重组器自身已校验 SOF、长度和两个 CRC
+ *
+ * @param frame_data Complete frame, at least 16 bytes
+ *                   完整帧，至少 16 字节
+ * @param frame_length Frame length
+ *                     帧长度
+ * @param frame_out Output structure for parsed result
+ *                  解析结果输出结构体
+ */
+void protocol_decode_frame(const uint8_t *frame_data, size_t frame_length, protocol_frame_t *frame_out)
+{
+    frame_out->sof = frame_data[0];
+    frame_out->version = ((frame_data[2] << 8) | frame_data[1]) >> 10; // High 6 bits of Ver/Length
+                                                                       // Ver/Length 的高 6 位
+    frame_out->frame_length = (uint16_t)frame_length;
+    frame_out->cmd_type = frame_data[3];
+    frame_out->enc = frame_data[4];
+    memcpy(frame_out->res, &frame_data[5], 3);
+    frame_out->seq = (frame_data[9] << 8) | frame_data[8];
+    frame_out->crc16 = (frame_data[11] << 8) | frame_data[10];
+
+    // Process data segment (DATA)
+    // 处理数据段 (DATA)
+    if (frame_length > 16)
+    { // DATA segment exists
+      // DATA 段存在
+        frame_out->data = &frame_data[12];
+        frame_out->data_length = frame_length - 16; // DATA length
+                                                    // DATA 长度
+    }
+    else
+    { // DATA segment is empty
+      // DATA 段为空
+        frame_out->data = NULL;
+        frame_out->data_length = 0;
+        ESP_LOGW(TAG, "DATA segment is empty");
+    }
+
+    frame_out->crc32 = ((uint32_t)frame_data[frame_length - 1] << 24) | ((uint32_t)frame_data[frame_length - 2] << 16) |
+                       ((uint32_t)frame_data[frame_length - 3] << 8) | frame_data[frame_length - 4];
+}
+
 /**
  * Parse notification frame
  * 解析通知帧
@@ -131,8 +179,6 @@ int protocol_parse_notification(const uint8_t *frame_data, size_t frame_length,
     // Parse Ver/Length
     // 解析 Ver/Length
     uint16_t ver_length = (frame_data[2] << 8) | frame_data[1];
-    uint16_t version = ver_length >> 10;            // High 6 bits for version
-                                                    // 高 6 位为版本号
     uint16_t expected_length = ver_length & 0x03FF; // Low 10 bits for frame length
                                                     // 低 10 位为帧长度
 
@@ -167,44 +213,19 @@ int protocol_parse_notification(const uint8_t *frame_data, size_t frame_length,
 
     // Fill parsing results into structure
     // 填充解析结果到结构体
-    frame_out->sof = frame_data[0];
-    frame_out->version = version;
-    frame_out->frame_length = expected_length;
-    frame_out->cmd_type = frame_data[3];
-    frame_out->enc = frame_data[4];
-    memcpy(frame_out->res, &frame_data[5], 3);
-    frame_out->seq = (frame_data[9] << 8) | frame_data[8];
-    frame_out->crc16 = crc16_received;
-
-    // Process data segment (DATA)
-    // 处理数据段 (DATA)
-    if (frame_length > 16)
-    { // DATA segment exists
-      // DATA 段存在
-        frame_out->data = &frame_data[12];
-        frame_out->data_length = frame_length - 16; // DATA length
-                                                    // DATA 长度
-    }
-    else
-    { // DATA segment is empty
-      // DATA 段为空
-        frame_out->data = NULL;
-        frame_out->data_length = 0;
-        ESP_LOGW(TAG, "DATA segment is empty");
-    }
-
-    frame_out->crc32 = crc32_received;
+    protocol_decode_frame(frame_data, frame_length, frame_out);
 
     ESP_LOGI(TAG, "Frame parsed successfully");
     return 0;
 }
 
 /**
- * @brief Parse data segment from protocol frame
- *        解析协议帧中的数据段
+ * @brief Parse data segment from protocol frame into a caller-provided buffer
+ *        将协议帧中的数据段解析到调用者提供的缓冲区
  *
- * Takes DATA segment, length and command type, returns parsed result length through data_length_without_cmd_out
- * 传入 DATA 数据段、长度和命令类型，data_length_without_cmd_out 返回上层
+ * Same as protocol_parse_data, but no memory is allocated, so it can run directly on a frame
+ * that still sits in a receive buffer.
+ * 与 protocol_parse_data 相同，但不分配内存，可直接作用于仍位于接收缓冲区中的帧。
  *
  * @param data Raw data segment
  *             原始数据段
@@ -212,18 +233,25 @@ int protocol_parse_notification(const uint8_t *frame_data, size_t frame_length,
  *                    数据段长度
  * @param cmd_type Command type
  *                 命令类型
+ * @param structure_out Buffer receiving the parsed structure
+ *                      接收解析结果结构体的缓冲区
+ * @param structure_capacity Size of structure_out, at least data_length - 2
+ *                           structure_out 的大小，至少为 data_length - 2
  * @param data_length_without_cmd_out Output parameter for data length without cmdSet&CmdID
  *                                    不包含 cmdSet&CmdID 的数据长度输出参数
  *
- * @return void* Pointer to parsed result structure, NULL on failure
- *               指向解析结果结构体的指针，失败时返回 NULL
+ * @return int 0 on success, -1 on invalid input or unknown command, -2 if the command has no parser,
+ *             -3 if structure_out is too small, other negative values on parse failure
+ *             成功返回 0，输入无效或命令未知返回 -1，命令无解析函数返回 -2，
+ *             structure_out 过小返回 -3，解析失败返回其他负值
  */
-void *protocol_parse_data(const uint8_t *data, size_t data_length, uint8_t cmd_type, size_t *data_length_without_cmd_out)
+int protocol_parse_data_into(const uint8_t *data, size_t data_length, uint8_t cmd_type,
+                             void *structure_out, size_t structure_capacity, size_t *data_length_without_cmd_out)
 {
-    if (data == NULL || data_length < 2)
+    if (data == NULL || data_length < 2 || structure_out == NULL)
     {
         ESP_LOGE(TAG, "Invalid data segment: data is NULL or too short");
-        return NULL;
+        return -1;
     }
 
     uint8_t cmd_set = data[0];
@@ -236,7 +264,7 @@ void *protocol_parse_data(const uint8_t *data, size_t data_length, uint8_t cmd_t
     if (descriptor == NULL)
     {
         ESP_LOGW(TAG, "No descriptor found for CmdSet 0x%02X and CmdID 0x%02X by trying structure descriptor", cmd_set, cmd_id);
-        return NULL;
+        return -1;
     }
 
     // 取出应答帧数据
@@ -246,18 +274,13 @@ void *protocol_parse_data(const uint8_t *data, size_t data_length, uint8_t cmd_t
 
     ESP_LOGI(TAG, "CmdSet: 0x%02X, CmdID: 0x%02X", cmd_set, cmd_id);
 
-    void *response_struct = malloc(response_length);
-    if (response_struct == NULL)
+    if (response_length > structure_capacity)
     {
-        ESP_LOGE(TAG, "Memory allocation failed for parsed data");
-        return NULL;
+        ESP_LOGE(TAG, "Output buffer too small for CmdSet 0x%02X and CmdID 0x%02X", cmd_set, cmd_id);
+        return -3;
     }
 
-    int result = -1;
-    if (descriptor != NULL)
-    {
-        result = data_parser_by_structure(cmd_set, cmd_id, cmd_type, response_data, response_length, response_struct);
-    }
+    int result = data_parser_by_structure(cmd_set, cmd_id, cmd_type, response_data, response_length, structure_out);
 
     if (result == 0)
     {
@@ -270,12 +293,52 @@ void *protocol_parse_data(const uint8_t *data, size_t data_length, uint8_t cmd_t
     else if (result == -2)
     {
         ESP_LOGW(TAG, "Parser function is NULL for CmdSet 0x%02X and CmdID 0x%02X by trying structure descriptor", cmd_set, cmd_id);
-        free(response_struct);
-        return NULL;
     }
     else
     {
         ESP_LOGE(TAG, "Failed to parse data for CmdSet 0x%02X and CmdID 0x%02X", cmd_set, cmd_id);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Parse data segment from protocol frame
+ *        解析协议帧中的数据段
+ *
+ * Takes DATA segment, length and command type, returns parsed result length through data_length_without_cmd_out
+ * 传入 DATA 数据段、长度和命令类型，data_length_without_cmd_out 返回上层
+ *
+ * @param data Raw data segment
+ *             原始数据段
+ * @param data_length Length of data segment
+ *                    数据段长度
+ * @param cmd_type Command type
+ *                 命令类型
+ * @param data_length_without_cmd_out Output parameter for data length without cmdSet&CmdID
+ *                                    不包含 cmdSet&CmdID 的数据长度输出参数
+ *
+ * @return void* Pointer to parsed result structure, NULL on failure
+ *               指向解析结果结构体的指针，失败时返回 NULL
+ */
+void *protocol_parse_data(const uint8_t *data, size_t data_length, uint8_t cmd_type, size_t *data_length_without_cmd_out)
+{
+    if (data == NULL || data_length < 2)
+    {
+        ESP_LOGE(TAG, "Invalid data segment: data is NULL or too short");
+        return NULL;
+    }
+
+    size_t response_length = data_length - 2;
+    void *response_struct = malloc(response_length);
+    if (response_struct == NULL)
+    {
+        ESP_LOGE(TAG, "Memory allocation failed for parsed data");
+        return NULL;
+    }
+
+    if (protocol_parse_data_into(data, data_length, cmd_type, response_struct, response_length, data_length_without_cmd_out) != 0)
+    {
         free(response_struct);
         return NULL;
     }
@@ -284,11 +347,12 @@ void *protocol_parse_data(const uint8_t *data, size_t data_length, uint8_t cmd_t
 }
 
 /**
- * @brief Create protocol frame
- *        创建协议帧
+ * @brief Create protocol frame in a caller-provided buffer
+ *        在调用方提供的缓冲区中创建协议帧
  *
- * Creates a complete protocol frame with given parameters and data structure
- * 根据给定的参数和数据结构创建完整的协议帧
+ * The creator serializes the payload straight into frame_out, the header and both CRCs are
+ * filled around it, so building a frame does not touch the heap.
+ * creator 直接将负载序列化到 frame_out 中，再在其前后填充帧头和两个 CRC，构建过程不使用堆内存。
  *
  * @param cmd_set Command set
  *                命令集
@@ -300,117 +364,174 @@ void *protocol_parse_data(const uint8_t *data, size_t data_length, uint8_t cmd_t
  *                 数据结构指针
  * @param seq Sequence number
  *            序列号
- * @param frame_length_out Output parameter for total frame length
- *                        总帧长度输出参数
+ * @param frame_out Buffer that receives the frame, NULL to only query the frame length
+ *                  接收协议帧的缓冲区，为 NULL 时仅查询帧长度
+ * @param frame_capacity Size of frame_out
+ *                       frame_out 的大小
+ * @param frame_length_out Output parameter for total frame length, set even when the buffer is too small
+ *                        总帧长度输出参数，缓冲区不足时同样会设置
  *
- * @return uint8_t* Pointer to created frame buffer, NULL on failure
- *                  指向创建的帧缓冲区的指针，失败时返回 NULL
+ * @return int 0 on success, -1 if the command is unknown or cannot be created,
+ *             -2 if the command has no creator, -3 if frame_capacity is too small
+ *             成功返回 0，命令未知或无法创建返回 -1，无创建函数返回 -2，缓冲区不足返回 -3
  */
-uint8_t *protocol_create_frame(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const void *structure, uint16_t seq, size_t *frame_length_out)
+int protocol_create_frame_into(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const void *structure, uint16_t seq,
+                               uint8_t *frame_out, size_t frame_capacity, size_t *frame_length_out)
 {
-    size_t data_length = 0;
-    uint8_t *payload_data = NULL;
-
-    // Create payload data from structure
-    // 从结构体创建有效载荷数据
-    payload_data = data_creator_by_structure(cmd_set, cmd_id, cmd_type, structure, &data_length);
+    if (frame_length_out == NULL)
+    {
+        ESP_LOGE(TAG, "Invalid input: frame_length_out is NULL");
+        return -1;
+    }
 
-    // Handle empty payload case
-    // 处理空数据段的情况
-    if (payload_data == NULL && data_length > 0)
+    // Serialize the payload first, straight at its final offset; a NULL frame_out only queries the length
+    // 先将负载直接序列化到其最终位置；frame_out 为 NULL 时仅查询长度
+    size_t data_length = 0;
+    uint8_t *payload_out = NULL;
+    size_t payload_capacity = 0;
+    if (frame_out != NULL && frame_capacity >= PROTOCOL_HEADER_LENGTH + PROTOCOL_TAIL_LENGTH)
     {
-        ESP_LOGE(TAG, "Failed to create payload data with non-zero length");
-        return NULL;
+        payload_out = &frame_out[PROTOCOL_HEADER_LENGTH];
+        payload_capacity = frame_capacity - PROTOCOL_HEADER_LENGTH - PROTOCOL_TAIL_LENGTH;
+    }
+    int ret = data_creator_by_structure(cmd_set, cmd_id, cmd_type, structure, payload_out, payload_capacity, &data_length);
+    if (ret != 0 && ret != -3)
+    {
+        ESP_LOGE(TAG, "Failed to create payload data, ret: %d", ret);
+        return ret;
     }
 
     // Calculate total frame length
     // 计算总帧长度
-    *frame_length_out = PROTOCOL_HEADER_LENGTH + data_length + PROTOCOL_TAIL_LENGTH;
+    size_t frame_length = PROTOCOL_HEADER_LENGTH + data_length + PROTOCOL_TAIL_LENGTH;
+    *frame_length_out = frame_length;
 
-    // Allocate memory for complete frame
-    // 为完整帧分配内存
-    uint8_t *frame = (uint8_t *)malloc(*frame_length_out);
-    if (frame == NULL)
+    if (frame_out == NULL)
     {
-        ESP_LOGE(TAG, "Memory allocation failed for protocol frame");
-        free(payload_data);
-        return NULL;
+        return 0;
+    }
+    if (ret == -3 || payload_out == NULL || frame_length > 0x03FF)
+    {
+        ESP_LOGE(TAG, "Frame buffer too small: need %zu, have %zu", frame_length, frame_capacity);
+        return -3;
     }
-
-    // Initialize frame content
-    // 初始化帧内容
-    memset(frame, 0, *frame_length_out);
 
     // Fill protocol header
     // 填充协议头部
     size_t offset = 0;
-    frame[offset++] = 0xAA; // SOF start byte
-                            // SOF 起始字节
+    frame_out[offset++] = 0xAA; // SOF start byte
+                                // SOF 起始字节
 
     // Ver/Length field
     // Ver/Length 字段
     uint16_t version = 0; // Fixed version number
                           // 固定版本号
-    uint16_t ver_length = (version << 10) | (*frame_length_out & 0x03FF);
-    frame[offset++] = ver_length & 0xFF;        // Ver/Length low byte
-                                                // Ver/Length 低字节
-    frame[offset++] = (ver_length >> 8) & 0xFF; // Ver/Length high byte
-                                                // Ver/Length 高字节
+    uint16_t ver_length = (version << 10) | (frame_length & 0x03FF);
+    frame_out[offset++] = ver_length & 0xFF;        // Ver/Length low byte
+                                                    // Ver/Length 低字节
+    frame_out[offset++] = (ver_length >> 8) & 0xFF; // Ver/Length high byte
+                                                    // Ver/Length 高字节
 
     // Fill command type
     // 填充命令类型
-    frame[offset++] = cmd_type;
+    frame_out[offset++] = cmd_type;
 
     // ENC (no encryption, fixed 0)
     // ENC（不加密，固定 0）
-    frame[offset++] = 0x00;
+    frame_out[offset++] = 0x00;
 
     // RES (reserved bytes, fixed 0)
     // RES（保留字节，固定 0）
-    frame[offset++] = 0x00;
-    frame[offset++] = 0x00;
-    frame[offset++] = 0x00;
+    frame_out[offset++] = 0x00;
+    frame_out[offset++] = 0x00;
+    frame_out[offset++] = 0x00;
 
     // Sequence number
     // 序列号
-    frame[offset++] = seq & 0xFF;        // Low byte of sequence number
-                                         // 序列号低字节
-    frame[offset++] = (seq >> 8) & 0xFF; // High byte of sequence number
-                                         // 序列号高字节
+    frame_out[offset++] = seq & 0xFF;        // Low byte of sequence number
+                                             // 序列号低字节
+    frame_out[offset++] = (seq >> 8) & 0xFF; // High byte of sequence number
+                                             // 序列号高字节
 
     // Calculate and fill CRC-16 (covers from SOF to SEQ)
     // 计算并填充 CRC-16（覆盖从 SOF 到 SEQ）
-    uint16_t crc16 = calculate_crc16(frame, offset);
-    frame[offset++] = crc16 & 0xFF;        // CRC-16 low byte
-                                           // CRC-16 低字节
-    frame[offset++] = (crc16 >> 8) & 0xFF; // CRC-16 high byte
-                                           // CRC-16 高字节
+    uint16_t crc16 = calculate_crc16(frame_out, offset);
+    frame_out[offset++] = crc16 & 0xFF;        // CRC-16 low byte
+                                               // CRC-16 低字节
+    frame_out[offset++] = (crc16 >> 8) & 0xFF; // CRC-16 high byte
+                                               // CRC-16 高字节
 
     // Fill command set and ID
     // 填充命令集和命令 ID
-    frame[offset++] = cmd_set;
-    frame[offset++] = cmd_id;
+    frame_out[offset++] = cmd_set;
+    frame_out[offset++] = cmd_id;
 
-    // Fill payload data
-    // 填充有效载荷数据
-    memcpy(&frame[offset], payload_data, data_length);
+    // Payload is already in place
+    // 负载已就位
     offset += data_length;
 
     // Calculate and fill CRC-32 (covers from SOF to DATA)
     // 计算并填充 CRC-32（覆盖从 SOF 到 DATA）
-    uint32_t crc32 = calculate_crc32(frame, offset);
-    frame[offset++] = crc32 & 0xFF;         // CRC-32 byte 1
-                                            // CRC-32 第 1 字节
-    frame[offset++] = (crc32 >> 8) & 0xFF;  // CRC-32 byte 2
-                                            // CRC-32 第 2 字节
-    frame[offset++] = (crc32 >> 16) & 0xFF; // CRC-32 byte 3
-                                            // CRC-32 第 3 字节
-    frame[offset++] = (crc32 >> 24) & 0xFF; // CRC-32 byte 4
-                                            // CRC-32 第 4 字节
-
-    // Free payload data
-    // 释放有效载荷数据
-    free(payload_data);
+    uint32_t crc32 = calculate_crc32(frame_out, offset);
+    frame_out[offset++] = crc32 & 0xFF;         // CRC-32 byte 1
+                                                // CRC-32 第 1 字节
+    frame_out[offset++] = (crc32 >> 8) & 0xFF;  // CRC-32 byte 2
+                                                // CRC-32 第 2 字节
+    frame_out[offset++] = (crc32 >> 16) & 0xFF; // CRC-32 byte 3
+                                                // CRC-32 第 3 字节
+    frame_out[offset++] = (crc32 >> 24) & 0xFF; // CRC-32 byte 4
+                                                // CRC-32 第 4 字节
+
+    return 0;
+}
+
+/**
+ * @brief Create protocol frame
+ *        创建协议帧
+ *
+ * Creates a complete protocol frame with given parameters and data structure. The frame is
+ * allocated on the heap and must be freed by the caller, use protocol_create_frame_into to
+ * build into a stack or static buffer instead.
+ * 根据给定的参数和数据结构创建完整的协议帧。帧在堆上分配，需由调用方释放；
+ * 如需构建到栈或静态缓冲区，请使用 protocol_create_frame_into。
+ *
+ * @param cmd_set Command set
+ *                命令集
+ * @param cmd_id Command ID
+ *               命令 ID
+ * @param cmd_type Command type
+ *                 命令类型
+ * @param structure Pointer to data structure
+ *                 数据结构指针
+ * @param seq Sequence number
+ *            序列号
+ * @param frame_length_out Output parameter for total frame length
+ *                        总帧长度输出参数
+ *
+ * @return uint8_t* Pointer to created frame buffer, NULL on failure
+ *                  指向创建的帧缓冲区的指针，失败时返回 NULL
+ */
+uint8_t *protocol_create_frame(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const void *structure, uint16_t seq, size_t *frame_length_out)
+{
+    if (protocol_create_frame_into(cmd_set, cmd_id, cmd_type, structure, seq, NULL, 0, frame_length_out) != 0)
+    {
+        return NULL;
+    }
+
+    // Allocate memory for complete frame
+    // 为完整帧分配内存
+    uint8_t *frame = (uint8_t *)malloc(*frame_length_out);
+    if (frame == NULL)
+    {
+        ESP_LOGE(TAG, "Memory allocation failed for protocol frame");
+        return NULL;
+    }
+
+    if (protocol_create_frame_into(cmd_set, cmd_id, cmd_type, structure, seq, frame, *frame_length_out, frame_length_out) != 0)
+    {
+        free(frame);
+        return NULL;
+    }
 
     return frame;
 }
@@ -52,10 +52,18 @@ typedef struct {
                             // CRC-32 校验值
 } protocol_frame_t;
 
+void protocol_decode_frame(const uint8_t *frame_data, size_t frame_length, protocol_frame_t *frame_out);
+
 int protocol_parse_notification(const uint8_t *frame_data, size_t frame_length, protocol_frame_t *frame_out);
 
+int protocol_parse_data_into(const uint8_t *data, size_t data_length, uint8_t cmd_type,
+                             void *structure_out, size_t structure_capacity, size_t *data_length_without_cmd_out);
+
 void* protocol_parse_data(const uint8_t *data, size_t data_length, uint8_t cmd_type, size_t *data_length_without_cmd_out);
 
+int protocol_create_frame_into(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const void *structure, uint16_t seq,
+                               uint8_t *frame_out, size_t frame_capacity, size_t *frame_length_out);
+
 uint8_t* protocol_create_frame(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const void *structure, uint16_t seq, size_t *frame_length_out);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,250 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "custom_crc16.h"
+#include "custom_crc32.h"
+
+#include "dji_protocol_reassembler.h"
+
+// Frame header byte
+// 帧头字节
+#define PROTOCOL_SOF 0xAA
+// SOF through CRC-16, the part needed to accept a frame start
+// 从 SOF 到 CRC-16，判断帧起点所需的部分
+#define PROTOCOL_CHECKED_HEADER_LENGTH 12
+// Header without DATA plus CRC-32
+// 不含 DATA 的帧头加 CRC-32
+#define PROTOCOL_MIN_FRAME_LENGTH 16
+
+/**
+ * Frame length from the Ver/Length field
+ * 从 Ver/Length 字段取出帧长度
+ */
+static inline size_t frame_length_field(const uint8_t *frame)
+{
+    return ((frame[2] << 8) | frame[1]) & 0x03FF;
+}
+
+/**
+ * Check length and CRC-16 of the 12 header bytes at frame
+ * 校验 frame 处 12 字节帧头的长度与 CRC-16
+ */
+static bool header_valid(const uint8_t *frame)
+{
+    if (frame_length_field(frame) < PROTOCOL_MIN_FRAME_LENGTH) {
+        return false;
+    }
+    uint16_t crc16_received = (frame[11] << 8) | frame[10];
+    return calculate_crc16(frame, 10) == crc16_received;
+}
+
+/**
+ * Check the CRC-32 of a complete frame
+ * 校验完整帧的 CRC-32
+ */
+static bool crc32_valid(const uint8_t *frame, size_t frame_length)
+{
+    const uint8_t *tail = frame + frame_length - 4;
+    uint32_t crc32_received = ((uint32_t)tail[3] << 24) | ((uint32_t)tail[2] << 16) |
+                              ((uint32_t)tail[1] << 8) | tail[0];
+    return calculate_crc32(frame, frame_length - 4) == crc32_received;
+}
+
+/**
+ * Emit the frames in data and skip garbage between them
+ * 输出 data 中的帧并跳过帧之间的无效数据
+ *
+ * A rejected SOF candidate only skips its own SOF byte, so a real frame that starts inside a
+ * truncated or corrupted one is still found. The header CRC-16 rejects almost every false SOF
+ * after 12 bytes instead of waiting for the length it claims.
+ * 被拒绝的 SOF 候选只跳过其自身的 SOF 字节，因此从被截断或损坏的帧内部开始的真实帧仍能被找到。
+ * 帧头 CRC-16 让绝大多数伪 SOF 在 12 字节后即被拒绝，而不必等到其声称的长度。
+ *
+ * @return Bytes that are settled; the rest is the start of a frame that is still incomplete
+ *         已处理完毕的字节数；其余部分是尚未收全的帧的开头
+ */
+static size_t scan(protocol_reassembler_t *reassembler, const uint8_t *data, size_t length)
+{
+    size_t pos = 0;
+
+    while (pos < length) {
+        if (data[pos] != PROTOCOL_SOF) {
+            const uint8_t *sof = memchr(data + pos, PROTOCOL_SOF, length - pos);
+            size_t next = sof ? (size_t)(sof - data) : length;
+            reassembler->discarded_bytes += next - pos;
+            pos = next;
+            continue;
+        }
+
+        const uint8_t *frame = data + pos;
+        size_t available = length - pos;
+        if (available < PROTOCOL_CHECKED_HEADER_LENGTH) {
+            break;
+        }
+        if (!header_valid(frame)) {
+            reassembler->header_errors++;
+            reassembler->discarded_bytes++;
+            pos++;
+            continue;
+        }
+
+        size_t frame_length = frame_length_field(frame);
+        if (available < frame_length) {
+            break;
+        }
+        if (!crc32_valid(frame, frame_length)) {
+            reassembler->crc32_errors++;
+            reassembler->discarded_bytes++;
+            pos++;
+            continue;
+        }
+
+        reassembler->frame_count++;
+        reassembler->handler(frame, frame_length, reassembler->ctx);
+        pos += frame_length;
+    }
+    return pos;
+}
+
+/**
+ * Bytes the buffered frame start needs before it can be checked again
+ * 缓冲的帧开头在下次校验前还需要的字节数
+ */
+static size_t missing_bytes(const protocol_reassembler_t *reassembler)
+{
+    if (reassembler->length < PROTOCOL_CHECKED_HEADER_LENGTH) {
+        return PROTOCOL_CHECKED_HEADER_LENGTH - reassembler->length;
+    }
+    // The header was checked when it was buffered, so the frame is longer than what we hold
+    // 帧头在缓冲时已校验，因此帧长必然大于已缓冲的字节数
+    return frame_length_field(reassembler->buffer) - reassembler->length;
+}
+
+/**
+ * Initialize a reassembler
+ * 初始化重组器
+ *
+ * @param reassembler Reassembler to initialize
+ *                    要初始化的重组器
+ * @param handler Called for every complete frame
+ *                每个完整帧的回调
+ * @param ctx Passed to handler
+ *            传给回调的参数
+ */
+void protocol_reassembler_init(protocol_reassembler_t *reassembler, protocol_frame_handler_t handler, void *ctx)
+{
+    memset(reassembler, 0, sizeof(*reassembler));
+    reassembler->handler = handler;
+    reassembler->ctx = ctx;
+}
+
+/**
+ * Drop a partially received frame, e.g. when the link is re-established
+ * 丢弃接收了一部分的帧，例如链路重新建立时
+ *
+ * @param reassembler Reassembler to reset
+ *                    要重置的重组器
+ */
+void protocol_reassembler_reset(protocol_reassembler_t *reassembler)
+{
+    reassembler->discarded_bytes += reassembler->length;
+    reassembler->length = 0;
+}
+
+/**
+ * Give up on a partially received frame and emit the complete frames held behind it
+ * 放弃接收了一部分的帧，并输出缓冲在其后的完整帧
+ *
+ * A frame whose tail was lost keeps every frame after it in buffer until enough bytes arrive
+ * to fill the length it claims. Call this when the link has gone quiet with a frame pending so
+ * those frames are not held back any longer.
+ * 丢失了帧尾的帧会把其后的所有帧留在 buffer 中，直到收到足以填满其声称长度的字节。链路空闲而仍有待续的帧时
+ * 调用此函数，避免这些帧被继续扣留。
+ *
+ * @param reassembler Reassembler
+ *                    重组器
+ *
+ * @return Number of frames emitted
+ *         输出的帧数
+ */
+size_t protocol_reassembler_flush(protocol_reassembler_t *reassembler)
+{
+    uint32_t frames_before = reassembler->frame_count;
+
+    while (reassembler->length > 0) {
+        // Skip the SOF of the stalled frame and look again behind it
+        // 跳过停滞帧的 SOF，在其后重新查找
+        reassembler->discarded_bytes++;
+        reassembler->length--;
+        memmove(reassembler->buffer, reassembler->buffer + 1, reassembler->length);
+
+        size_t settled = scan(reassembler, reassembler->buffer, reassembler->length);
+        reassembler->length -= settled;
+        memmove(reassembler->buffer, reassembler->buffer + settled, reassembler->length);
+    }
+    return reassembler->frame_count - frames_before;
+}
+
+/**
+ * Feed the next chunk of the byte stream
+ * 送入字节流的下一个数据块
+ *
+ * @param reassembler Reassembler
+ *                    重组器
+ * @param chunk Received bytes
+ *              收到的字节
+ * @param chunk_length Number of bytes in chunk
+ *                     chunk 中的字节数
+ *
+ * @return Number of frames emitted for this chunk
+ *         本数据块输出的帧数
+ */
+size_t protocol_reassembler_feed(protocol_reassembler_t *reassembler, const uint8_t *chunk, size_t chunk_length)
+{
+    uint32_t frames_before = reassembler->frame_count;
+
+    while (chunk_length > 0) {
+        if (reassembler->length == 0) {
+            // Nothing pending, work on the chunk in place and keep only an incomplete tail
+            // 没有待续的帧，直接在数据块上处理，仅保留未收全的尾部
+            size_t settled = scan(reassembler, chunk, chunk_length);
+            memcpy(reassembler->buffer, chunk + settled, chunk_length - settled);
+            reassembler->length = chunk_length - settled;
+            break;
+        }
+
+        // Complete the pending frame start, then go back to the in-place path once it is settled
+        // 补全待续的帧开头，处理完毕后回到原地处理路径
+        size_t take = missing_bytes(reassembler);
+        if (take > chunk_length) {
+            take = chunk_length;
+        }
+        memcpy(reassembler->buffer + reassembler->length, chunk, take);
+        reassembler->length += take;
+        chunk += take;
+        chunk_length -= take;
+
+        size_t settled = scan(reassembler, reassembler->buffer, reassembler->length);
+        reassembler->length -= settled;
+        memmove(reassembler->buffer, reassembler->buffer + settled, reassembler->length);
+    }
+    return reassembler->frame_count - frames_before;
+}
@@ -0,0 +1,80 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#ifndef DJI_PROTOCOL_REASSEMBLER_H
+#define DJI_PROTOCOL_REASSEMBLER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Largest frame the 10-bit length field of Ver/Length can describe
+ * Ver/Length 中 10 位长度字段能表示的最大帧长
+ */
+#define PROTOCOL_MAX_FRAME_LENGTH 0x3FF
+
+/**
+ * Called once for every complete frame whose CRC-16 and CRC-32 both check out
+ * 每个 CRC-16 与 CRC-32 均校验通过的完整帧调用一次
+ *
+ * The frame is only valid for the duration of the call. It may point into the chunk being fed
+ * or into the reassembler's own buffer, so the handler must not feed the same reassembler.
+ * 帧仅在回调期间有效，可能指向正在送入的数据块或重组器自身的缓冲区，因此回调中不能向同一重组器送入数据。
+ */
+typedef void (*protocol_frame_handler_t)(const uint8_t *frame, size_t frame_length, void *ctx);
+
+/**
+ * Streaming frame reassembler
+ * 流式帧重组器
+ *
+ * Accepts the byte stream in chunks of any size, such as BLE notifications carrying several
+ * frames or only part of one, and emits every complete frame in order. Frames that lie
+ * entirely inside a chunk are handed out in place; only the tail of a frame that continues in
+ * the next chunk is copied into buffer.
+ * 以任意大小的数据块接收字节流（例如包含多帧或仅包含一帧一部分的 BLE 通知），并按顺序输出每个完整帧。
+ * 完全位于数据块内的帧原地交出；只有延续到下一个数据块的帧尾会被拷贝进 buffer。
+ */
+typedef struct {
+    protocol_frame_handler_t handler;           // Frame handler
+                                                // 帧回调
+    void *ctx;                                  // Passed to handler
+                                                // 传给回调的参数
+    uint8_t buffer[PROTOCOL_MAX_FRAME_LENGTH];  // Start of a frame still missing bytes, begins with SOF
+                                                // 尚未收全的帧的开头部分，以 SOF 开头
+    size_t length;                              // Bytes held in buffer
+                                                // buffer 中的字节数
+    uint32_t frame_count;                       // Frames emitted
+                                                // 已输出的帧数
+    uint32_t discarded_bytes;                   // Bytes skipped while looking for a frame
+                                                // 寻找帧时跳过的字节数
+    uint32_t header_errors;                     // SOF candidates rejected by length or CRC-16
+                                                // 因长度或 CRC-16 被拒绝的 SOF 候选
+    uint32_t crc32_errors;                      // Frames rejected by CRC-32
+                                                // 因 CRC-32 被拒绝的帧
+} protocol_reassembler_t;
+
+void protocol_reassembler_init(protocol_reassembler_t *reassembler, protocol_frame_handler_t handler, void *ctx);
+
+void protocol_reassembler_reset(protocol_reassembler_t *reassembler);
+
+size_t protocol_reassembler_feed(protocol_reassembler_t *reassembler, const uint8_t *chunk, size_t chunk_length);
+
+size_t protocol_reassembler_flush(protocol_reassembler_t *reassembler);
+
+#endif
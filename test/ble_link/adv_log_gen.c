@@ -0,0 +1,224 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Advertisement stream generator for the scan replay test.
+ * 扫描回放测试的广播流生成器。
+ *
+ * Writes what a 4 s pairing scan of ble.c receives, one scan result per line, in the order the
+ * controller reports them; a log holds several recordings of one scenario:
+ * 输出 ble.c 一次 4 秒配对扫描收到的内容，每行一条扫描结果，按控制器上报顺序排列；一个日志包含同一场景的多次录制：
+ *
+ *   # recording <n> truth <bda or none>
+ *   <t_us> <bda> <rssi> <adv hex> <scan response hex or ->
+ *
+ * truth is the DJI camera with the strongest mean RSSI at or above -80 dBm. Each advertisement is
+ * received with the 60% duty cycle of ble.c's scan window/interval, and its RSSI deviates 4 dB
+ * (Gaussian) from the device's mean; some scenarios add fades and multipath spikes.
+ * truth 为平均 RSSI 最强且不低于 -80 dBm 的 DJI 相机。每条广播按 ble.c 扫描窗口/间隔的 60% 占空比被收到，
+ * 其 RSSI 以 4 dB（高斯）偏离设备均值；部分场景加入衰落与多径尖峰。
+ *
+ * Usage / 用法: adv_log_gen <scenario> [recordings] [seed] > scenario.adv
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#define SCAN_US             4000000     // Full scan of ble.c / ble.c 的完整扫描时长
+#define RECEIVE_PERMILLE    600         // scan_window / scan_interval = 0x30 / 0x50
+#define ADV_DELAY_US        10000       // Random advDelay of 0-10 ms / 0-10 ms 的随机 advDelay
+#define RSSI_SIGMA_DB       4.0
+#define TRUTH_MIN_RSSI      -80
+#define MAX_DEVICES         12
+#define MAX_EVENTS          4096
+
+typedef struct {
+    bool camera;
+    int mean_rssi;
+    int interval_ms;
+    int start_ms;                   // Starts advertising this late / 延迟开始广播的时间
+    int fade_permille;              // Advertisements 15 dB weaker / 弱 15 dB 的广播比例
+    int spike_permille;             // Advertisements 15 dB stronger / 强 15 dB 的广播比例
+} device_spec_t;
+
+typedef struct {
+    const char *name;
+    const char *description;
+    int count;
+    device_spec_t devices[MAX_DEVICES];
+} scenario_t;
+
+#define CAMERA(rssi) { true, rssi, 100, 0, 0, 0 }
+#define PHONE(rssi, interval) { false, rssi, interval, 0, 0, 0 }
+
+static const scenario_t s_scenarios[] = {
+    { "single", "one camera and three phones", 4,
+      { CAMERA(-50), PHONE(-45, 200), PHONE(-60, 350), PHONE(-70, 1000) } },
+    { "two_far", "two cameras 20 dB apart", 3,
+      { CAMERA(-48), CAMERA(-68), PHONE(-55, 250) } },
+    { "two_near", "two cameras 4 dB apart", 2,
+      { CAMERA(-55), CAMERA(-59) } },
+    { "crowd", "four cameras among six other devices", 10,
+      { CAMERA(-52), CAMERA(-62), CAMERA(-66), CAMERA(-70), PHONE(-40, 100), PHONE(-50, 150),
+        PHONE(-58, 200), PHONE(-65, 300), PHONE(-72, 500), PHONE(-78, 1000) } },
+    { "fading", "a fading camera and a distant one with multipath spikes", 2,
+      { { true, -58, 100, 0, 200, 0 }, { true, -72, 100, 0, 0, 100 } } },
+    { "slow", "the nearest camera advertises every 200 ms, the other every 100 ms", 2,
+      { CAMERA(-62), { true, -46, 200, 0, 0, 0 } } },
+    { "weak", "one camera below the RSSI threshold", 2,
+      { CAMERA(-86), PHONE(-50, 200) } },
+};
+
+typedef struct {
+    int64_t t_us;
+    int device;
+    int rssi;
+} adv_event_t;
+
+static uint64_t s_rng;
+
+static uint32_t next_random(void) {
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 7;
+    s_rng ^= s_rng << 17;
+    return (uint32_t)(s_rng >> 11);
+}
+
+static double gaussian(void) {
+    const double u1 = (next_random() + 1.0) / 4294967297.0;
+    const double u2 = (next_random() + 1.0) / 4294967297.0;
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static int compare_events(const void *a, const void *b) {
+    const adv_event_t *x = a, *y = b;
+    return x->t_us < y->t_us ? -1 : x->t_us > y->t_us;
+}
+
+static void print_bda(const uint8_t bda[6]) {
+    printf("%02X:%02X:%02X:%02X:%02X:%02X", bda[0], bda[1], bda[2], bda[3], bda[4], bda[5]);
+}
+
+static void print_hex(const uint8_t *data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        printf("%02X", data[i]);
+    }
+}
+
+static void write_recording(const scenario_t *scenario, int index) {
+    static adv_event_t events[MAX_EVENTS];
+    uint8_t bda[MAX_DEVICES][6];
+    int mean[MAX_DEVICES];
+    int count = 0;
+    int truth = -1;
+
+    for (int d = 0; d < scenario->count; d++) {
+        const device_spec_t *spec = &scenario->devices[d];
+        for (int i = 0; i < 6; i++) {
+            bda[d][i] = (uint8_t)next_random();
+        }
+        // Each recording is taken at a slightly different spot / 每次录制位置略有不同
+        mean[d] = spec->mean_rssi + (int)(next_random() % 3) - 1;
+        if (spec->camera && mean[d] >= TRUTH_MIN_RSSI && (truth < 0 || mean[d] > mean[truth])) {
+            truth = d;
+        }
+
+        const int64_t interval_us = spec->interval_ms * 1000LL;
+        for (int64_t t = spec->start_ms * 1000LL + next_random() % interval_us; t < SCAN_US && count < MAX_EVENTS;
+             t += interval_us + next_random() % ADV_DELAY_US) {
+            if (next_random() % 1000 >= RECEIVE_PERMILLE) {
+                continue;
+            }
+            double rssi = mean[d] + RSSI_SIGMA_DB * gaussian();
+            if ((int)(next_random() % 1000) < spec->fade_permille) {
+                rssi -= 15;
+            }
+            if ((int)(next_random() % 1000) < spec->spike_permille) {
+                rssi += 15;
+            }
+            events[count].t_us = t;
+            events[count].device = d;
+            events[count].rssi = rssi < -100 ? -100 : rssi > -20 ? -20 : (int)lround(rssi);
+            count++;
+        }
+    }
+    qsort(events, count, sizeof(events[0]), compare_events);
+
+    printf("# recording %d truth ", index);
+    if (truth >= 0) {
+        print_bda(bda[truth]);
+    } else {
+        printf("none");
+    }
+    printf("\n");
+
+    for (int i = 0; i < count; i++) {
+        const int d = events[i].device;
+        printf("%lld ", (long long)events[i].t_us);
+        print_bda(bda[d]);
+        printf(" %d ", events[i].rssi);
+        if (scenario->devices[d].camera) {
+            const uint8_t adv[] = {
+                0x02, 0x01, 0x06,
+                0x06, 0xFF, 0xAA, 0x08, bda[d][4], bda[d][5], 0xFA,
+                0x0B, 0x09, 'O', 's', 'm', 'o', 'A', 'c', 't', 'i', 'o', 'n',
+            };
+            print_hex(adv, sizeof(adv));
+            printf(" -\n");
+        } else {
+            // A phone: Apple manufacturer data, name in the scan response / 手机：Apple 厂商数据，名称在扫描响应中
+            const uint8_t adv[] = { 0x02, 0x01, 0x1A, 0x07, 0xFF, 0x4C, 0x00, 0x10, 0x02, 0x0B, 0x00 };
+            const uint8_t rsp[] = { 0x06, 0x09, 'P', 'h', 'o', 'n', 'e' };
+            print_hex(adv, sizeof(adv));
+            printf(" ");
+            print_hex(rsp, sizeof(rsp));
+            printf("\n");
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    const scenario_t *scenario = NULL;
+    const int count = sizeof(s_scenarios) / sizeof(s_scenarios[0]);
+
+    for (int i = 0; argc > 1 && i < count; i++) {
+        if (strcmp(argv[1], s_scenarios[i].name) == 0) {
+            scenario = &s_scenarios[i];
+        }
+    }
+    const int recordings = argc > 2 ? atoi(argv[2]) : 200;
+    s_rng = argc > 3 ? strtoull(argv[3], NULL, 10) : 1;
+    if (scenario == NULL || recordings <= 0 || s_rng == 0) {
+        fprintf(stderr, "usage: %s <scenario> [recordings] [seed]\nscenarios:\n", argv[0]);
+        for (int i = 0; i < count; i++) {
+            fprintf(stderr, "  %-10s %s\n", s_scenarios[i].name, s_scenarios[i].description);
+        }
+        return 2;
+    }
+
+    printf("# adv_log_gen %s: %s, seed %llu\n", scenario->name, scenario->description, (unsigned long long)s_rng);
+    for (int i = 0; i < recordings; i++) {
+        write_recording(scenario, i);
+    }
+    return 0;
+}
@@ -0,0 +1,264 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Reconnect benchmark of ble.c and connect_logic.c against the simulated Bluedroid stack.
+ * ble.c 与 connect_logic.c 在模拟 Bluedroid 协议栈上的重连基准。
+ *
+ * Reconnects to the simulated camera the way key_logic.c does after a wake-up, in three modes:
+ * 以 key_logic.c 唤醒后重连的方式重连模拟相机，共三种模式：
+ * - full:     no cached handles, every reconnect runs service discovery
+ *             无缓存句柄，每次重连都执行服务发现
+ * - cached:   handles saved in NVS after the previous connection are validated with one read
+ *             上一次连接后保存在 NVS 中的句柄经一次读取校验后使用
+ * - fallback: the camera's database moved before every reconnect, so the cached handles are
+ *             rejected and discovery runs after the validation read
+ *             每次重连前相机数据库都发生移动，缓存句柄被拒绝，校验读取后再执行服务发现
+ *
+ * Each connection must end with the camera's notify CCCD enabled and the handles of the camera's
+ * current layout; the cached mode must not run discovery or rewrite NVS.
+ * 每次连接结束时相机的 notify CCCD 必须已使能且句柄与相机当前布局一致；缓存模式不得执行发现，也不得重写 NVS。
+ *
+ * Usage / 用法: ble_reconnect_bench [trials] [conn_interval_ms]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "nvs.h"
+
+#include "ble.h"
+#include "data.h"
+#include "connect_logic.h"
+#include "product_nvs.h"
+#include "sim_bluedroid.h"
+
+#define DEFAULT_TRIALS      20
+#define READY_TIMEOUT_MS    5000
+#define SETTLE_MS           150    // Idle time after a disconnect / 断开后的空闲时间
+
+typedef enum {
+    MODE_FULL = 0,
+    MODE_CACHED,
+    MODE_FALLBACK,
+    MODE_COUNT,
+} bench_mode_t;
+
+static const char *const s_mode_names[MODE_COUNT] = { "full", "cached", "fallback" };
+
+typedef struct {
+    int trials;
+    int failures;
+    double scan_ms;                 // connect_logic_ble_connect called -> esp_ble_gattc_open / 调用 -> 发起连接
+    double link_ms;                 // esp_ble_gattc_open -> link up / 发起连接 -> 链路建立
+    double handles_ms;              // link up -> handles known / 链路建立 -> 句柄已知
+    double ready_ms;                // link up -> notifications enabled / 链路建立 -> 通知已使能
+    double ready_max_ms;
+    double return_ms;               // connect_logic_ble_connect called -> returned / 调用 -> 返回
+    double att_requests;
+} bench_result_t;
+
+static esp_bd_addr_t s_camera_bda;
+static uint16_t s_first_handle = 1;
+
+static bool wait_ms(bool (*done)(void), int timeout_ms) {
+    for (int i = 0; i < timeout_ms; i++) {
+        if (done()) {
+            return true;
+        }
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    return done();
+}
+
+static bool link_ready(void) {
+    ble_link_timing_t timing;
+    ble_get_link_timing(&timing);
+    return timing.ready_us != 0;
+}
+
+static bool link_down(void) {
+    return !s_ble_profile.connection_status.is_connected && connect_logic_get_state() == BLE_INIT_COMPLETE;
+}
+
+static bool gattc_registered(void) {
+    return s_ble_profile.gattc_if != ESP_GATT_IF_NONE;
+}
+
+static bool handles_match_camera(const ble_gatt_handles_t *handles) {
+    sim_camera_handles_t expected;
+    sim_get_camera_handles(&expected);
+    return handles->service_start_handle == expected.service_start_handle &&
+           handles->service_end_handle == expected.service_end_handle &&
+           handles->notify_char_handle == expected.notify_char_handle &&
+           handles->notify_cccd_handle == expected.notify_cccd_handle &&
+           handles->write_char_handle == expected.write_char_handle;
+}
+
+/* Load the cache the way key_logic.c does before a reconnect */
+/* 按 key_logic.c 重连前的方式加载缓存 */
+static void prepare_trial(bench_mode_t mode) {
+    ble_gatt_handles_t handles;
+
+    if (mode == MODE_FALLBACK) {
+        s_first_handle = s_first_handle == 1 ? 9 : 1;
+        sim_set_first_handle(s_first_handle);
+    }
+    if (mode != MODE_FULL && product_nvs_get_gatt_handles(s_camera_bda, &handles)) {
+        ble_set_cached_handles(s_camera_bda, &handles);
+    } else {
+        ble_set_cached_handles(s_camera_bda, NULL);
+    }
+    memcpy(s_ble_profile.remote_bda, s_camera_bda, sizeof(esp_bd_addr_t));
+}
+
+static bool run_trial(bench_mode_t mode, bench_result_t *result) {
+    static const ble_discovery_mode_t expected_mode[MODE_COUNT] = {
+        BLE_DISCOVERY_FULL, BLE_DISCOVERY_CACHED, BLE_DISCOVERY_FALLBACK,
+    };
+    sim_stats_t before, after;
+    ble_link_timing_t timing;
+    ble_gatt_handles_t handles;
+    bool ok = true;
+
+    prepare_trial(mode);
+    sim_get_stats(&before);
+    unsigned long nvs_writes = host_nvs_write_count();
+
+    int64_t start_us = esp_timer_get_time();
+    int ret = connect_logic_ble_connect(true);
+    int64_t return_us = esp_timer_get_time();
+    if (ret != 0 || !wait_ms(link_ready, READY_TIMEOUT_MS)) {
+        printf("  %s: connection not ready (ret %d)\n", s_mode_names[mode], ret);
+        ok = false;
+    }
+
+    ble_get_link_timing(&timing);
+    sim_get_stats(&after);
+    if (ok) {
+        /* Same bookkeeping as key_logic.c once the protocol connection is up */
+        /* 与 key_logic.c 协议连接建立后的处理相同 */
+        if (!ble_get_gatt_handles(&handles) || !handles_match_camera(&handles)) {
+            printf("  %s: handles do not match the camera's layout\n", s_mode_names[mode]);
+            ok = false;
+        } else {
+            product_nvs_set_gatt_handles(s_camera_bda, &handles);
+        }
+        if (timing.mode != expected_mode[mode]) {
+            printf("  %s: connected in mode %d, expected %d\n", s_mode_names[mode], timing.mode, expected_mode[mode]);
+            ok = false;
+        }
+        if (after.notify_enabled_us == 0) {
+            printf("  %s: camera notifications not enabled\n", s_mode_names[mode]);
+            ok = false;
+        }
+        if (mode == MODE_CACHED && (after.discoveries != before.discoveries || host_nvs_write_count() != nvs_writes)) {
+            printf("  %s: cached reconnect ran discovery or rewrote NVS\n", s_mode_names[mode]);
+            ok = false;
+        }
+    }
+
+    if (ok) {
+        double ready_ms = (timing.ready_us - timing.connected_us) / 1000.0;
+        result->scan_ms += (timing.open_us - start_us) / 1000.0;
+        result->link_ms += (timing.connected_us - timing.open_us) / 1000.0;
+        result->handles_ms += (timing.handles_us - timing.connected_us) / 1000.0;
+        result->ready_ms += ready_ms;
+        result->return_ms += (return_us - start_us) / 1000.0;
+        result->att_requests += after.att_requests;
+        if (ready_ms > result->ready_max_ms) {
+            result->ready_max_ms = ready_ms;
+        }
+        result->trials++;
+    } else {
+        result->failures++;
+    }
+
+    connect_logic_ble_disconnect();
+    if (!wait_ms(link_down, READY_TIMEOUT_MS)) {
+        printf("  %s: link did not go down\n", s_mode_names[mode]);
+        result->failures++;
+        return false;
+    }
+    vTaskDelay(pdMS_TO_TICKS(SETTLE_MS));
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    int trials = argc > 1 ? atoi(argv[1]) : DEFAULT_TRIALS;
+    sim_config_t config;
+    bench_result_t results[MODE_COUNT];
+
+    sim_default_config(&config);
+    if (argc > 2) {
+        config.conn_interval_us = (uint32_t)(atof(argv[2]) * 1000);
+    }
+    if (trials <= 0 || config.conn_interval_us == 0) {
+        fprintf(stderr, "usage: %s [trials] [conn_interval_ms]\n", argv[0]);
+        return 2;
+    }
+
+    sim_init(&config);
+    sim_camera_bda(s_camera_bda);
+    data_init();
+    product_nvs_init();
+    if (connect_logic_ble_init() != 0 || !wait_ms(gattc_registered, READY_TIMEOUT_MS)) {
+        printf("FAIL: BLE init\n");
+        return 1;
+    }
+
+    /* First pairing: a full discovery whose handles seed the cache */
+    /* 首次配对：一次完整发现，其句柄作为缓存的初始内容 */
+    bench_result_t first = { 0 };
+    run_trial(MODE_FULL, &first);
+
+    memset(results, 0, sizeof(results));
+    for (int i = 0; i < trials; i++) {
+        for (int mode = 0; mode < MODE_COUNT; mode++) {
+            run_trial((bench_mode_t)mode, &results[mode]);
+        }
+    }
+
+    printf("Reconnect to a known camera, %d trials per mode, %.1f ms connection interval\n",
+           trials, config.conn_interval_us / 1000.0);
+    printf("mode       scan ms  link ms  handles ms  ready ms  ready max  ATT reqs  connect() ms  failures\n");
+    int failures = first.failures;
+    for (int mode = 0; mode < MODE_COUNT; mode++) {
+        bench_result_t *r = &results[mode];
+        int n = r->trials ? r->trials : 1;
+        printf("%-9s %8.1f %8.1f %11.1f %9.1f %10.1f %9.1f %13.1f %9d\n", s_mode_names[mode],
+               r->scan_ms / n, r->link_ms / n, r->handles_ms / n, r->ready_ms / n, r->ready_max_ms,
+               r->att_requests / n, r->return_ms / n, r->failures);
+        failures += r->failures;
+    }
+
+    if (failures == 0 && results[MODE_CACHED].trials > 0 && results[MODE_FULL].trials > 0) {
+        printf("Link up -> notifications enabled: %.1f ms cached vs %.1f ms full discovery (%.1fx)\n",
+               results[MODE_CACHED].ready_ms / results[MODE_CACHED].trials,
+               results[MODE_FULL].ready_ms / results[MODE_FULL].trials,
+               (results[MODE_FULL].ready_ms / results[MODE_FULL].trials) /
+               (results[MODE_CACHED].ready_ms / results[MODE_CACHED].trials));
+    }
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,567 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Connection manager test of connect_logic.c and ble.c against the simulated Bluedroid stack.
+ * connect_logic.c 与 ble.c 连接管理在模拟 Bluedroid 协议栈上的测试。
+ *
+ * A simulated camera answers the protocol handshake (command set 0x00, command 0x19) while the
+ * link is dropped at chosen points: while idle, during service discovery, during the validation
+ * of cached handles, during the protocol handshake, around the handshake's final reply, with the
+ * camera gone for good and while the user disconnects. Every loss must be recovered by the connection manager task without any
+ * GAP/GATTC callback blocking, and a handshake whose link dropped must fail at once instead of
+ * running into its timeout or tearing down the link that replaced it.
+ * 模拟相机应答协议握手（命令集 0x00，命令 0x19），同时在选定的时刻断开链路：空闲时、服务发现期间、
+ * 缓存句柄校验期间、协议握手期间、握手最后应答前后、相机彻底消失时以及用户主动断开时。每次断链都必须由连接管理任务恢复，
+ * 且 GAP/GATTC 回调不得阻塞；链路已断开的握手必须立即失败，既不能等到超时，也不能断开替代它的新链路。
+ *
+ * Every scenario starts from a protocol-connected link, re-established if the previous one left
+ * anything else behind, and waits on state changes and simulator events rather than sleeping.
+ * 每个场景都从已协议连接的链路开始，若上一个场景留下了其他状态则重新建立；场景等待状态变化与模拟器事件，而非休眠。
+ *
+ * Build with a short CONNECT_RECONNECT_WINDOW_MS so the give-up case runs in seconds.
+ * 编译时使用较短的 CONNECT_RECONNECT_WINDOW_MS，使放弃重连的用例在数秒内完成。
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+
+#include "ble.h"
+#include "data.h"
+#include "connect_logic.h"
+#include "enums_logic.h"
+#include "product_nvs.h"
+#include "dji_protocol_parser.h"
+#include "dji_protocol_data_structures.h"
+#include "sim_bluedroid.h"
+
+#define LINK_TIMEOUT_MS         8000
+#define HANDSHAKE_ABORT_MS      500     // A handshake on a dropped link must fail within this / 链路断开后握手须在此时间内失败
+#define CALLBACK_LIMIT_US       5000    // Longest a GAP/GATTC callback may run / GAP/GATTC 回调的最长允许时间
+#define SCAN_END_MS             4500    // Longer than one scan of ble.c / 长于 ble.c 的一次扫描
+#define REASON_TIMEOUT          0x08    // Supervision timeout / 监督超时
+#define REPLY_DROP_ROUNDS       10      // Handshakes whose reply is lost with the link / 应答随链路丢失的握手次数
+
+typedef enum {
+    CAMERA_ACCEPT = 0,              // Answer and approve the handshake / 应答并批准握手
+    CAMERA_DROP_AFTER_RESPONSE,     // Answer, then drop the link before approving / 应答后在批准前断开链路
+    CAMERA_DROP_AT_REPLY,           // Approve, then drop the link as the reply is written / 批准后在写入应答时断开链路
+} sim_camera_mode_t;
+
+typedef struct {
+    const char *name;
+    bool ok;
+    double elapsed_ms;              // Link loss -> BLE_CONNECTED again, or the call under test / 断链 -> 再次 BLE_CONNECTED，或被测调用的耗时
+    uint32_t connections;           // Links opened to recover / 恢复过程中建立的链路数
+} scenario_result_t;
+
+static esp_bd_addr_t s_camera_bda;
+static QueueHandle_t s_camera_queue;
+static volatile sim_camera_mode_t s_camera_mode = CAMERA_ACCEPT;
+static volatile int s_camera_acks;
+static uint16_t s_camera_seq = 0x4000;
+static double s_handshake_abort_ms;
+
+/* Given on every connection state change and simulator event, wakes wait_for */
+/* 每次连接状态变化与模拟器事件时释放，用于唤醒 wait_for */
+static SemaphoreHandle_t s_changed;
+static int s_acks_expected;
+static uint32_t s_connections_before;
+
+static void something_changed(void);
+
+/* ---------- simulated camera ---------- */
+
+static void camera_write_handler(const uint8_t *value, uint16_t length) {
+    if (length < 14 || value[0] != 0xAA || value[12] != 0x00 || value[13] != 0x19) {
+        return;
+    }
+    if (value[3] & 0x20) {
+        s_camera_acks++;
+        something_changed();
+        return;
+    }
+    const uint16_t seq = value[8] | (value[9] << 8);
+    xQueueSend(s_camera_queue, &seq, 0);
+}
+
+/* Answers connection requests outside the simulator's callbacks, like the camera's own firmware */
+/* 在模拟器回调之外应答连接请求，如同相机自身的固件 */
+static void camera_task(void *arg) {
+    uint8_t frame[128];
+    size_t length;
+    uint16_t seq;
+
+    while (1) {
+        xQueueReceive(s_camera_queue, &seq, portMAX_DELAY);
+
+        connection_request_response_frame response = { .device_id = 0x12345678, .ret_code = 0 };
+        if (protocol_create_frame_into(0x00, 0x19, ACK_NO_RESPONSE, &response, seq,
+                                       frame, sizeof(frame), &length) == 0) {
+            sim_notify(frame, (uint16_t)length);
+        }
+        if (s_camera_mode == CAMERA_DROP_AFTER_RESPONSE) {
+            vTaskDelay(pdMS_TO_TICKS(50));
+            sim_drop_link(REASON_TIMEOUT);
+            continue;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(20));
+        connection_request_command_frame request = { .device_id = 0x12345678, .verify_mode = 2, .verify_data = 0 };
+        if (protocol_create_frame_into(0x00, 0x19, CMD_WAIT_RESULT, &request, s_camera_seq++,
+                                       frame, sizeof(frame), &length) == 0) {
+            sim_notify(frame, (uint16_t)length);
+        }
+        if (s_camera_mode == CAMERA_DROP_AT_REPLY) {
+            sim_drop_link_at_write(REASON_TIMEOUT);
+        }
+    }
+}
+
+/* ---------- helpers ---------- */
+
+static void something_changed(void) {
+    xSemaphoreGive(s_changed);
+}
+
+static void state_changed(connect_state_t state) {
+    something_changed();
+}
+
+/* Wait until done() holds, checking it whenever the state or the simulator moves on */
+/* 等待 done() 成立，每当状态或模拟器有变化时检查一次 */
+static bool wait_for(bool (*done)(void), int timeout_ms) {
+    const int64_t deadline = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+    while (!done()) {
+        const int64_t left_us = deadline - esp_timer_get_time();
+        if (left_us <= 0 || xSemaphoreTake(s_changed, pdMS_TO_TICKS((left_us + 999) / 1000)) != pdTRUE) {
+            return done();
+        }
+    }
+    return true;
+}
+
+static bool gattc_registered(void) {
+    return s_ble_profile.gattc_if != ESP_GATT_IF_NONE;
+}
+
+static bool link_ready(void) {
+    ble_link_timing_t timing;
+    ble_get_link_timing(&timing);
+    return timing.ready_us != 0;
+}
+
+static bool link_lost(void) {
+    return connect_logic_get_state() == BLE_SEARCHING;
+}
+
+static bool ble_connected(void) {
+    return connect_logic_get_state() == BLE_CONNECTED;
+}
+
+static bool link_down(void) {
+    return !s_ble_profile.connection_status.is_connected && connect_logic_get_state() == BLE_INIT_COMPLETE;
+}
+
+static uint32_t connections(void) {
+    sim_stats_t stats;
+    sim_get_stats(&stats);
+    return stats.connections;
+}
+
+static bool scanning(void) {
+    sim_stats_t stats;
+    sim_get_stats(&stats);
+    return stats.scanning;
+}
+
+/* A link was opened since s_connections_before was taken */
+/* 自记录 s_connections_before 以来建立了新链路 */
+static bool link_opened(void) {
+    return connections() != s_connections_before;
+}
+
+/* The manager is on a link opened since s_connections_before, whatever the state looked like before */
+/* 连接管理任务已处于自记录 s_connections_before 以来建立的链路上，无论此前状态如何 */
+static bool relinked(void) {
+    return link_opened() && ble_connected();
+}
+
+static bool camera_replied(void) {
+    return s_camera_acks >= s_acks_expected;
+}
+
+static double ms_since(int64_t start_us) {
+    return (esp_timer_get_time() - start_us) / 1000.0;
+}
+
+/* Run the handshake the way key_logic.c does and check it ends in PROTOCOL_CONNECTED */
+/* 按 key_logic.c 的方式执行握手，并检查最终处于 PROTOCOL_CONNECTED */
+static bool handshake(const char *name) {
+    const int8_t mac[6] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 };
+    const int acks = s_camera_acks;
+
+    s_camera_mode = CAMERA_ACCEPT;
+    if (connect_logic_protocol_connect(0x12345678, 6, mac, 0x01000000, 0, 1234, 0) != 0 ||
+        connect_logic_get_state() != PROTOCOL_CONNECTED) {
+        printf("  %s: protocol handshake failed, state %d\n", name, connect_logic_get_state());
+        return false;
+    }
+    s_acks_expected = acks + 1;
+    if (!wait_for(camera_replied, LINK_TIMEOUT_MS) || s_camera_acks != acks + 1) {
+        printf("  %s: camera received %d handshake replies, expected 1\n", name, s_camera_acks - acks);
+        return false;
+    }
+    return true;
+}
+
+/* Wait for the manager to notice a loss and bring the link back */
+/* 等待连接管理任务发现断链并恢复链路 */
+static bool wait_recovered(scenario_result_t *r, int64_t lost_us, uint32_t connections_before) {
+    if (!wait_for(link_lost, LINK_TIMEOUT_MS)) {
+        printf("  %s: link loss not noticed, state %d\n", r->name, connect_logic_get_state());
+        return false;
+    }
+    s_connections_before = connections_before;
+    if (!wait_for(relinked, LINK_TIMEOUT_MS)) {
+        printf("  %s: link not recovered, state %d\n", r->name, connect_logic_get_state());
+        return false;
+    }
+    r->elapsed_ms = ms_since(lost_us);
+    r->connections = connections() - connections_before;
+    return true;
+}
+
+/*
+ * Bring the manager back to a protocol-connected link, whatever the previous scenario left behind,
+ * so one failure does not carry over into the scenarios after it.
+ * 无论上一个场景留下什么状态，都将连接管理恢复到已协议连接的链路，使一次失败不会延续到后续场景。
+ */
+static bool reset_manager(void) {
+    s_camera_mode = CAMERA_ACCEPT;
+    sim_cancel_drops();
+    sim_set_advertising(true);
+    if (connect_logic_get_state() == PROTOCOL_CONNECTED && link_ready()) {
+        return true;
+    }
+
+    if (!link_down()) {
+        connect_logic_ble_disconnect();
+        if (!wait_for(link_down, LINK_TIMEOUT_MS)) {
+            printf("  reset: link not closed, state %d\n", connect_logic_get_state());
+            return false;
+        }
+    }
+    if (connect_logic_ble_connect(false) != 0 || !ble_connected() || !wait_for(link_ready, LINK_TIMEOUT_MS)) {
+        printf("  reset: connect failed, state %d\n", connect_logic_get_state());
+        return false;
+    }
+    return handshake("reset");
+}
+
+/* ---------- scenarios ---------- */
+
+static bool initial_connect(scenario_result_t *r) {
+    const int64_t start = esp_timer_get_time();
+    /* connect_logic_ble_connect returns once the handles are known, key_logic.c starts the handshake then */
+    /* connect_logic_ble_connect 在句柄已知时即返回，key_logic.c 随即开始握手 */
+    if (connect_logic_ble_connect(false) != 0 || !ble_connected() || !wait_for(link_ready, LINK_TIMEOUT_MS)) {
+        printf("  %s: connect failed, state %d\n", r->name, connect_logic_get_state());
+        return false;
+    }
+    r->elapsed_ms = ms_since(start);
+    r->connections = 1;
+    return handshake(r->name);
+}
+
+static bool loss_while_idle(scenario_result_t *r) {
+    const uint32_t before = connections();
+    const int64_t lost = esp_timer_get_time();
+    sim_drop_link(REASON_TIMEOUT);
+    if (!wait_recovered(r, lost, before)) {
+        return false;
+    }
+    ble_link_timing_t timing;
+    ble_get_link_timing(&timing);
+    if (timing.mode != BLE_DISCOVERY_CACHED) {
+        printf("  %s: reconnected in discovery mode %d, expected cached\n", r->name, timing.mode);
+        return false;
+    }
+    return handshake(r->name);
+}
+
+static bool loss_during_discovery(scenario_result_t *r) {
+    const uint32_t before = connections();
+    ble_set_cached_handles(s_camera_bda, NULL);
+    sim_drop_link_at_request(3, REASON_TIMEOUT);
+    const int64_t lost = esp_timer_get_time();
+    sim_drop_link(REASON_TIMEOUT);
+    if (!wait_recovered(r, lost, before)) {
+        return false;
+    }
+    if (r->connections != 2) {
+        printf("  %s: %u links opened, expected the dropped one and its retry\n", r->name, (unsigned)r->connections);
+        return false;
+    }
+    return handshake(r->name);
+}
+
+static bool loss_during_validation(scenario_result_t *r) {
+    const uint32_t before = connections();
+    sim_drop_link_at_request(2, REASON_TIMEOUT);
+    const int64_t lost = esp_timer_get_time();
+    sim_drop_link(REASON_TIMEOUT);
+    if (!wait_recovered(r, lost, before)) {
+        return false;
+    }
+    if (r->connections != 2) {
+        printf("  %s: %u links opened, expected the dropped one and its retry\n", r->name, (unsigned)r->connections);
+        return false;
+    }
+    return handshake(r->name);
+}
+
+static bool loss_during_handshake(scenario_result_t *r) {
+    const int8_t mac[6] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 };
+
+    /* Start from a bare link, as key_logic.c does after a wake-up */
+    /* 与 key_logic.c 唤醒后一样，从仅建立 BLE 链路的状态开始 */
+    uint32_t before = connections();
+    sim_drop_link(REASON_TIMEOUT);
+    if (!wait_recovered(r, esp_timer_get_time(), before)) {
+        return false;
+    }
+
+    before = connections();
+    s_camera_mode = CAMERA_DROP_AFTER_RESPONSE;
+    const int64_t start = esp_timer_get_time();
+    const int ret = connect_logic_protocol_connect(0x12345678, 6, mac, 0x01000000, 0, 1234, 0);
+    const double failed_ms = ms_since(start);
+    s_handshake_abort_ms = failed_ms;
+    s_camera_mode = CAMERA_ACCEPT;
+    if (ret == 0 || failed_ms > HANDSHAKE_ABORT_MS) {
+        printf("  %s: handshake returned %d after %.1f ms, expected a failure within %d ms\n",
+               r->name, ret, failed_ms, HANDSHAKE_ABORT_MS);
+        return false;
+    }
+    /* The loss that failed the handshake is already in the state, nobody may start another on the dead link */
+    /* 导致握手失败的断链已体现在状态中，任何人都不得在已断开的链路上再次握手 */
+    const connect_state_t failed_state = connect_logic_get_state();
+    if (failed_state == BLE_CONNECTED || failed_state == PROTOCOL_CONNECTED) {
+        printf("  %s: handshake failed on a lost link, state still %d\n", r->name, failed_state);
+        return false;
+    }
+    s_connections_before = before;
+    if (!wait_for(relinked, LINK_TIMEOUT_MS) || !wait_for(link_ready, LINK_TIMEOUT_MS)) {
+        printf("  %s: link not recovered, state %d\n", r->name, connect_logic_get_state());
+        return false;
+    }
+    r->elapsed_ms = ms_since(start);
+    r->connections = connections() - before;
+    if (!handshake(r->name)) {
+        return false;
+    }
+    /* The failed handshake returned before, anything it did to the new link shows by now */
+    /* 失败的握手早已返回，它对新链路所做的任何事此时都已可见 */
+    if (connect_logic_get_state() != PROTOCOL_CONNECTED || connections() - before != r->connections) {
+        printf("  %s: reconnected link was closed, state %d\n", r->name, connect_logic_get_state());
+        return false;
+    }
+    return true;
+}
+
+/*
+ * The link drops from inside the handshake's own reply write, so the loss reaches the connection
+ * manager while the handshake checks its link and sets PROTOCOL_CONNECTED. Whichever side wins,
+ * the reconnected link must end up in BLE_CONNECTED: a handshake may not mark a link
+ * PROTOCOL_CONNECTED that the manager already counts as lost.
+ * 链路在握手自身写入应答时断开，使断链在握手检查链路并设置 PROTOCOL_CONNECTED 的同时到达连接管理任务。
+ * 无论哪一方先完成，重连后的链路都必须处于 BLE_CONNECTED：握手不得将管理任务已判定断开的链路标记为 PROTOCOL_CONNECTED。
+ */
+static bool loss_at_handshake_reply(scenario_result_t *r) {
+    const int8_t mac[6] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 };
+    const uint32_t before = connections();
+    const int64_t start = esp_timer_get_time();
+
+    for (int round = 0; round < REPLY_DROP_ROUNDS; round++) {
+        if (connect_logic_get_state() == PROTOCOL_CONNECTED) {
+            sim_drop_link(REASON_TIMEOUT);
+        }
+        if (!wait_for(ble_connected, LINK_TIMEOUT_MS) || !wait_for(link_ready, LINK_TIMEOUT_MS)) {
+            printf("  %s: no link for round %d, state %d\n", r->name, round, connect_logic_get_state());
+            return false;
+        }
+
+        const uint32_t round_before = connections();
+        s_camera_mode = CAMERA_DROP_AT_REPLY;
+        const int ret = connect_logic_protocol_connect(0x12345678, 6, mac, 0x01000000, 0, 1234, 0);
+        s_camera_mode = CAMERA_ACCEPT;
+
+        s_connections_before = round_before;
+        if (!wait_for(relinked, LINK_TIMEOUT_MS)) {
+            printf("  %s: round %d left state %d after the handshake returned %d\n",
+                   r->name, round, connect_logic_get_state(), ret);
+            return false;
+        }
+        if (connect_logic_get_state() != BLE_CONNECTED) {
+            printf("  %s: reconnected link in state %d in round %d\n", r->name, connect_logic_get_state(), round);
+            return false;
+        }
+    }
+    r->elapsed_ms = ms_since(start);
+    r->connections = connections() - before;
+    return handshake(r->name);
+}
+
+static bool camera_gone(scenario_result_t *r) {
+    sim_set_advertising(false);
+    const int64_t lost = esp_timer_get_time();
+    sim_drop_link(REASON_TIMEOUT);
+    if (!wait_for(link_lost, LINK_TIMEOUT_MS) || !wait_for(link_down, CONNECT_RECONNECT_WINDOW_MS + LINK_TIMEOUT_MS)) {
+        printf("  %s: reconnect did not give up, state %d\n", r->name, connect_logic_get_state());
+        sim_set_advertising(true);
+        return false;
+    }
+    const double gave_up_ms = ms_since(lost);
+    if (gave_up_ms < CONNECT_RECONNECT_WINDOW_MS) {
+        printf("  %s: gave up after %.1f ms, before the %d ms window\n", r->name, gave_up_ms, CONNECT_RECONNECT_WINDOW_MS);
+        sim_set_advertising(true);
+        return false;
+    }
+
+    /* The camera comes back after the scan would have ended: no link may open by itself */
+    /* 相机在扫描本应结束后回来：不得自行建立链路 */
+    const uint32_t before = connections();
+    s_connections_before = before;
+    sim_set_advertising(true);
+    if (wait_for(link_opened, SCAN_END_MS) || !link_down()) {
+        printf("  %s: link opened after giving up\n", r->name);
+        return false;
+    }
+
+    const int64_t start = esp_timer_get_time();
+    if (connect_logic_ble_connect(true) != 0 || !ble_connected() || !wait_for(link_ready, LINK_TIMEOUT_MS)) {
+        printf("  %s: user reconnect failed, state %d\n", r->name, connect_logic_get_state());
+        return false;
+    }
+    r->elapsed_ms = ms_since(start);
+    r->connections = connections() - before;
+    return handshake(r->name);
+}
+
+static bool disconnect_during_reconnect(scenario_result_t *r) {
+    sim_set_advertising(false);
+    sim_drop_link(REASON_TIMEOUT);
+    if (!wait_for(link_lost, LINK_TIMEOUT_MS) || !wait_for(scanning, LINK_TIMEOUT_MS)) {
+        printf("  %s: link loss not noticed\n", r->name);
+        sim_set_advertising(true);
+        return false;
+    }
+
+    const int64_t start = esp_timer_get_time();
+    connect_logic_ble_disconnect();
+    r->elapsed_ms = ms_since(start);
+    if (!link_down()) {
+        printf("  %s: state %d after disconnect, expected BLE_INIT_COMPLETE\n", r->name, connect_logic_get_state());
+        sim_set_advertising(true);
+        return false;
+    }
+
+    const uint32_t before = connections();
+    s_connections_before = before;
+    sim_set_advertising(true);
+    const bool opened = wait_for(link_opened, SCAN_END_MS);
+    r->connections = connections() - before;
+    if (opened || !link_down()) {
+        printf("  %s: link opened after the user disconnected\n", r->name);
+        return false;
+    }
+    return true;
+}
+
+int main(void) {
+    static const struct {
+        const char *name;
+        bool (*run)(scenario_result_t *r);
+    } scenarios[] = {
+        { "initial connect", initial_connect },
+        { "loss while idle", loss_while_idle },
+        { "loss in discovery", loss_during_discovery },
+        { "loss in validation", loss_during_validation },
+        { "loss in handshake", loss_during_handshake },
+        { "loss at reply", loss_at_handshake_reply },
+        { "camera gone", camera_gone },
+        { "user disconnect", disconnect_during_reconnect },
+    };
+    const int count = sizeof(scenarios) / sizeof(scenarios[0]);
+    scenario_result_t results[sizeof(scenarios) / sizeof(scenarios[0])];
+    sim_config_t config;
+
+    s_changed = xSemaphoreCreateBinary();
+    sim_default_config(&config);
+    sim_init(&config);
+    sim_camera_bda(s_camera_bda);
+    sim_set_write_handler(camera_write_handler);
+    sim_set_event_hook(something_changed);
+    connect_logic_set_state_callback(state_changed);
+    s_camera_queue = xQueueCreate(4, sizeof(uint16_t));
+    xTaskCreate(camera_task, "camera", 4096, NULL, 5, NULL);
+    data_init();
+    product_nvs_init();
+    if (connect_logic_ble_init() != 0 || !wait_for(gattc_registered, LINK_TIMEOUT_MS)) {
+        printf("FAIL: BLE init\n");
+        return 1;
+    }
+
+    int failures = 0;
+    for (int i = 0; i < count; i++) {
+        memset(&results[i], 0, sizeof(results[i]));
+        results[i].name = scenarios[i].name;
+        // The first scenario makes the initial connection itself
+        // 第一个场景自行建立初始连接
+        results[i].ok = (i == 0 || reset_manager()) && scenarios[i].run(&results[i]);
+        if (!results[i].ok) {
+            failures++;
+        }
+    }
+
+    sim_stats_t stats;
+    sim_get_stats(&stats);
+    printf("Connection manager, %.1f ms connection interval, %d ms reconnect window\n",
+           config.conn_interval_us / 1000.0, CONNECT_RECONNECT_WINDOW_MS);
+    printf("scenario             result  elapsed ms  links\n");
+    for (int i = 0; i < count; i++) {
+        printf("%-20s %-6s %11.1f %6u\n", results[i].name, results[i].ok ? "ok" : "FAIL",
+               results[i].elapsed_ms, (unsigned)results[i].connections);
+    }
+    printf("Handshake on a dropped link failed after %.1f ms\n", s_handshake_abort_ms);
+    printf("Longest GAP/GATTC callback: %.3f ms\n", stats.max_callback_us / 1000.0);
+    if (stats.max_callback_us > CALLBACK_LIMIT_US) {
+        printf("  a callback ran longer than %d ms\n", CALLBACK_LIMIT_US / 1000);
+        failures++;
+    }
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
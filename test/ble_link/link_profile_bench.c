@@ -0,0 +1,488 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Link profile benchmark of ble.c and connect_logic.c against the simulated Bluedroid stack.
+ * ble.c 与 connect_logic.c 的链路配置在模拟 Bluedroid 协议栈上的基准。
+ *
+ * Drives the activity that selects each link profile and measures it once the link has switched:
+ * 产生选择各链路配置的活动，并在链路切换完成后进行测量：
+ * - interactive: the link just came up, then a button press every second
+ *                链路刚建立，随后每秒一次按键
+ * - idle:        no activity until the holds run out
+ *                无活动，直至保持时间结束
+ * - streaming:   GPS pushes at 10 Hz
+ *                10 Hz 的 GPS 推送
+ *
+ * For each profile: the switch time from the moment the policy calls for it, the round trip of a
+ * command answered by the camera, the throughput of 70 byte stream frames, and the connection events
+ * per second of both ends as a measure of radio time. Finally a button press from idle, with the
+ * command sent after the multi-click window as key_logic.c does.
+ * 每个配置测量：从策略需要它到切换完成的时间、相机应答命令的往返时间、70 字节流帧的吞吐量，以及两端
+ * 每秒的连接事件数（作为射频时间的度量）。最后测量空闲时的一次按键，命令与 key_logic.c 一样在多击窗口后发送。
+ *
+ * Usage / 用法: link_profile_bench [seconds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_gap_ble_api.h"
+
+#include "ble.h"
+#include "data.h"
+#include "connect_logic.h"
+#include "product_nvs.h"
+#include "sim_bluedroid.h"
+
+#define DEFAULT_SECONDS     3
+#define READY_TIMEOUT_MS    5000
+#define SWITCH_TIMEOUT_MS   2000    // Bound on a switch once the policy calls for it / 策略需要切换后完成切换的上限
+#define REPLY_TIMEOUT_MS    2000
+#define COMMAND_LENGTH      20
+#define FRAME_LENGTH        70
+#define COMMAND_GAP_MS      137     // Not a multiple of any interval, so commands sample every phase / 非任何间隔的整数倍，使命令落在各个相位
+#define KEY_PERIOD_MS       1000
+#define GPS_PERIOD_MS       100
+#define MULTICLICK_MS       380     // PRODUCT_MULTICLICK_FINALIZE_WINDOW_US / PRODUCT_MULTICLICK_FINALIZE_WINDOW_US
+#define KEY_HOLD_MS         3000    // CONNECT_KEY_HOLD_MS
+#define GPS_HOLD_MS         1500    // CONNECT_GPS_HOLD_MS
+#define HOST_SLACK_US       2000    // Host to controller and one scheduler tick on top of the air time / 空中时间之外主机到控制器及一个调度节拍的余量
+
+#define FRAME_COMMAND       'C'
+#define FRAME_DATA          'D'
+
+typedef struct {
+    const char *name;
+    ble_link_profile_t profile;
+    int activity;                   // link_activity_t, -1 for none / 无活动时为 -1
+} phase_t;
+
+static const phase_t s_phases[] = {
+    { "interactive", BLE_LINK_PROFILE_INTERACTIVE, LINK_ACTIVITY_KEY },
+    { "idle",        BLE_LINK_PROFILE_IDLE,        -1 },
+    { "streaming",   BLE_LINK_PROFILE_STREAMING,   LINK_ACTIVITY_GPS },
+};
+
+#define PHASE_COUNT (sizeof(s_phases) / sizeof(s_phases[0]))
+
+typedef struct {
+    ble_link_params_t params;
+    int64_t switch_us;
+    uint32_t commands;
+    int64_t rtt_sum_us;
+    int64_t rtt_max_us;
+    double kbps;
+} phase_result_t;
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t s_reply_seq;
+static int64_t s_reply_us;
+static uint32_t s_data_bytes;
+
+/* When the policy last saw activity of each kind, to tell when a hold runs out */
+/* 策略最近一次看到各类活动的时刻，用于判断保持时间何时结束 */
+static int64_t s_last_key_us;
+static int64_t s_last_gps_us;
+static int64_t s_next_key_us;
+static int64_t s_next_gps_us;
+
+static bool wait_ms(bool (*done)(void), int timeout_ms) {
+    for (int i = 0; i < timeout_ms; i++) {
+        if (done()) {
+            return true;
+        }
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    return done();
+}
+
+static bool link_ready(void) {
+    ble_link_timing_t timing;
+    ble_get_link_timing(&timing);
+    return timing.ready_us != 0;
+}
+
+static bool gattc_registered(void) {
+    return s_ble_profile.gattc_if != ESP_GATT_IF_NONE;
+}
+
+/* The camera side: commands are echoed as notifications, stream frames are counted */
+/* 相机一侧：命令以通知原样返回，流帧只计数 */
+static void camera_write_handler(const uint8_t *value, uint16_t length) {
+    if (length == COMMAND_LENGTH && value[0] == FRAME_COMMAND) {
+        sim_notify(value, length);
+    } else if (length == FRAME_LENGTH && value[0] == FRAME_DATA) {
+        pthread_mutex_lock(&s_lock);
+        s_data_bytes += length;
+        pthread_mutex_unlock(&s_lock);
+    }
+}
+
+static void bench_notify_handler(const uint8_t *data, size_t length) {
+    if (length != COMMAND_LENGTH || data[0] != FRAME_COMMAND) {
+        return;
+    }
+    uint32_t seq;
+    memcpy(&seq, &data[1], sizeof(seq));
+    pthread_mutex_lock(&s_lock);
+    s_reply_seq = seq;
+    s_reply_us = esp_timer_get_time();
+    pthread_mutex_unlock(&s_lock);
+}
+
+static esp_err_t send_data_frame(void) {
+    uint8_t frame[FRAME_LENGTH];
+    memset(frame, 0x5A, sizeof(frame));
+    frame[0] = FRAME_DATA;
+    return ble_write_without_response_prio(s_ble_profile.conn_id, s_ble_profile.write_char_handle,
+                                           frame, sizeof(frame), BLE_TX_PRIO_STREAM);
+}
+
+/* Keep up the activity of a phase the way key_logic.c and gps_logic.c report it */
+/* 以 key_logic.c 与 gps_logic.c 上报的方式维持某阶段的活动 */
+static void pump_activity(int activity) {
+    const int64_t now = esp_timer_get_time();
+    if (activity == LINK_ACTIVITY_KEY && now >= s_next_key_us) {
+        connect_logic_note_activity(LINK_ACTIVITY_KEY);
+        s_last_key_us = now;
+        s_next_key_us = now + KEY_PERIOD_MS * 1000;
+    } else if (activity == LINK_ACTIVITY_GPS && now >= s_next_gps_us) {
+        connect_logic_note_activity(LINK_ACTIVITY_GPS);
+        send_data_frame();
+        s_last_gps_us = now;
+        s_next_gps_us = now + GPS_PERIOD_MS * 1000;
+    }
+}
+
+static void sleep_with_activity(int activity, int ms) {
+    const int64_t end = esp_timer_get_time() + (int64_t)ms * 1000;
+    while (esp_timer_get_time() < end) {
+        pump_activity(activity);
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+}
+
+/* A profile is settled once its parameters, data length and PHY are all in effect */
+/* 配置的参数、数据长度与 PHY 全部生效后才算切换完成 */
+static bool profile_settled(ble_link_profile_t profile) {
+    ble_link_params_t params;
+    ble_get_link_params(&params);
+    if (params.profile != profile) {
+        return false;
+    }
+    return profile == BLE_LINK_PROFILE_IDLE || (params.tx_octets == 251 && params.phy == ESP_BLE_GAP_PHY_2M);
+}
+
+static bool wait_settled(ble_link_profile_t profile, int activity, int timeout_ms) {
+    const int64_t end = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+    while (!profile_settled(profile)) {
+        if (esp_timer_get_time() >= end) {
+            return false;
+        }
+        pump_activity(activity);
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    return true;
+}
+
+/* Send one command and wait for the camera's answer, returns the round trip or -1 */
+/* 发送一条命令并等待相机应答，返回往返时间，超时返回 -1 */
+static int64_t command_round_trip(int activity) {
+    static uint32_t seq = 0;
+    uint8_t frame[COMMAND_LENGTH];
+    memset(frame, 0, sizeof(frame));
+    frame[0] = FRAME_COMMAND;
+    seq++;
+    memcpy(&frame[1], &seq, sizeof(seq));
+
+    const int64_t start = esp_timer_get_time();
+    if (ble_write_without_response(s_ble_profile.conn_id, s_ble_profile.write_char_handle,
+                                   frame, sizeof(frame)) != ESP_OK) {
+        return -1;
+    }
+    while (esp_timer_get_time() - start < (int64_t)REPLY_TIMEOUT_MS * 1000) {
+        pthread_mutex_lock(&s_lock);
+        const bool answered = s_reply_seq == seq;
+        const int64_t reply_us = s_reply_us;
+        pthread_mutex_unlock(&s_lock);
+        if (answered) {
+            return reply_us - start;
+        }
+        pump_activity(activity);
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    return -1;
+}
+
+/* Keep half of the TX queue filled with stream frames for the given time, returns kB/s at the camera */
+/* 在给定时间内使发送队列保持半满的流帧，返回相机处的 kB/s */
+static double measure_throughput(int activity, int seconds) {
+    pthread_mutex_lock(&s_lock);
+    s_data_bytes = 0;
+    pthread_mutex_unlock(&s_lock);
+    const int64_t start = esp_timer_get_time();
+    const int64_t end = start + (int64_t)seconds * 1000000;
+    while (esp_timer_get_time() < end) {
+        tx_queue_stats_t tx;
+        ble_get_tx_stats(&tx);
+        for (uint32_t depth = tx.depth; depth < TX_QUEUE_LEN / 2; depth++) {
+            send_data_frame();
+        }
+        pump_activity(activity);
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    pthread_mutex_lock(&s_lock);
+    const uint32_t bytes = s_data_bytes;
+    pthread_mutex_unlock(&s_lock);
+    return bytes / ((esp_timer_get_time() - start) / 1e6) / 1000.0;
+}
+
+static double central_events_hz(const ble_link_params_t *params) {
+    return 1e6 / (params->conn_interval * 1250.0);
+}
+
+static double camera_events_hz(const ble_link_params_t *params) {
+    return central_events_hz(params) / (params->latency + 1);
+}
+
+/* Frames per second the link carries with the parameters it was opened with, as in tx_flow_bench.c */
+/* 链路以建链参数每秒可承载的帧数，算法同 tx_flow_bench.c */
+static double opened_capacity_kbps(const sim_config_t *config) {
+    const int pdus_per_frame = (FRAME_LENGTH + 3 + 4 + config->max_tx_octets - 1) / config->max_tx_octets;
+    const double hz = (double)(config->tx_pdus_per_event / pdus_per_frame) * 1e6 / config->conn_interval_us;
+    return hz * FRAME_LENGTH / 1000.0;
+}
+
+/* Longest round trip of a command on the link as it was opened: out at the next event, answered at the one after */
+/* 建链时链路上命令的最长往返时间：在下一个事件发出，并在其后的事件得到应答 */
+static int64_t opened_round_trip_us(const sim_config_t *config) {
+    return 2LL * config->conn_interval_us + HOST_SLACK_US;
+}
+
+static int run_phase(const phase_t *phase, int64_t wanted_us, int seconds, phase_result_t *r) {
+    memset(r, 0, sizeof(*r));
+    if (!wait_settled(phase->profile, phase->activity,
+                      (int)((wanted_us - esp_timer_get_time()) / 1000) + SWITCH_TIMEOUT_MS)) {
+        printf("  %s: profile not in effect %d ms after the policy called for it\n", phase->name,
+               SWITCH_TIMEOUT_MS);
+        return 1;
+    }
+    r->switch_us = esp_timer_get_time() - wanted_us;
+    ble_get_link_params(&r->params);
+
+    const int commands = seconds * 1000 / COMMAND_GAP_MS;
+    for (int i = 0; i < commands; i++) {
+        const int64_t rtt = command_round_trip(phase->activity);
+        if (rtt < 0) {
+            printf("  %s: command not answered\n", phase->name);
+            return 1;
+        }
+        r->commands++;
+        r->rtt_sum_us += rtt;
+        if (rtt > r->rtt_max_us) {
+            r->rtt_max_us = rtt;
+        }
+        sleep_with_activity(phase->activity, COMMAND_GAP_MS - (int)(rtt / 1000) % COMMAND_GAP_MS);
+    }
+    r->kbps = measure_throughput(phase->activity, seconds);
+    return 0;
+}
+
+static void print_phase(const phase_t *phase, const phase_result_t *r) {
+    printf("%-12s %11.2f %8u %7u %4s %10.1f %12.1f %11.1f %6.1f %13.1f %12.1f\n",
+           phase->name, r->params.conn_interval * 1.25, (unsigned)r->params.latency, (unsigned)r->params.tx_octets,
+           r->params.phy == ESP_BLE_GAP_PHY_2M ? "2M" : "1M", r->switch_us / 1000.0,
+           r->commands ? r->rtt_sum_us / 1000.0 / r->commands : 0.0, r->rtt_max_us / 1000.0, r->kbps,
+           central_events_hz(&r->params), camera_events_hz(&r->params));
+}
+
+static int check(const phase_result_t results[PHASE_COUNT], const sim_config_t *config) {
+    const phase_result_t *interactive = &results[0];
+    const phase_result_t *idle = &results[1];
+    const phase_result_t *streaming = &results[2];
+    const double opened_hz = 1e6 / config->conn_interval_us;
+    int failures = 0;
+
+    // A command is on the air at the next event and answered at the one after
+    // 命令在下一个事件发出，并在其后的事件得到应答
+    const int64_t interactive_bound = 4LL * interactive->params.conn_interval * 1250;
+    if (interactive->rtt_max_us > interactive_bound) {
+        printf("  interactive: command took %.1f ms, bound %.1f ms\n", interactive->rtt_max_us / 1000.0,
+               interactive_bound / 1000.0);
+        failures++;
+    }
+    if (!(interactive->rtt_sum_us / interactive->commands < streaming->rtt_sum_us / streaming->commands &&
+          streaming->rtt_sum_us / streaming->commands < idle->rtt_sum_us / idle->commands)) {
+        printf("  command round trips not ordered interactive < streaming < idle\n");
+        failures++;
+    }
+    if (streaming->kbps < 1.5 * opened_capacity_kbps(config)) {
+        printf("  streaming: %.1f kB/s, less than 1.5 times the %.1f kB/s of the opened link\n", streaming->kbps,
+               opened_capacity_kbps(config));
+        failures++;
+    }
+    // Idle keeps the opened interval so a press is answered at once, but the camera sleeps through most events;
+    // a fifth may come out exactly, so rounding is allowed for
+    // idle 保持建链时的间隔使按键立即得到应答，但相机在大部分事件中休眠；五分之一可能恰好相等，因此允许舍入误差
+    if (camera_events_hz(&idle->params) > opened_hz / 5 + 0.01 || central_events_hz(&idle->params) > opened_hz) {
+        printf("  idle: %.1f camera and %.1f central events/s against %.1f on the opened link\n",
+               camera_events_hz(&idle->params), central_events_hz(&idle->params), opened_hz);
+        failures++;
+    }
+    return failures;
+}
+
+/* A button press while idle: the switch starts when the button goes down and the first command goes out at once, as in key_logic.c */
+/* 空闲时按键：按下时开始切换，第一条命令立即发出，与 key_logic.c 相同 */
+static int key_from_idle(const sim_config_t *config) {
+    if (!wait_settled(BLE_LINK_PROFILE_IDLE, -1, KEY_HOLD_MS + GPS_HOLD_MS + SWITCH_TIMEOUT_MS)) {
+        printf("  key from idle: link did not return to idle\n");
+        return 1;
+    }
+    s_next_key_us = 0;
+    const int64_t press_us = esp_timer_get_time();
+    pump_activity(LINK_ACTIVITY_KEY);
+    sleep_with_activity(LINK_ACTIVITY_KEY, MULTICLICK_MS);
+    const int64_t first = command_round_trip(LINK_ACTIVITY_KEY);
+    const bool settled = wait_settled(BLE_LINK_PROFILE_INTERACTIVE, LINK_ACTIVITY_KEY, SWITCH_TIMEOUT_MS);
+    const int64_t settled_us = esp_timer_get_time() - press_us;
+    const int64_t next = command_round_trip(LINK_ACTIVITY_KEY);
+
+    printf("Key press from idle: first command after %d ms answered in %.1f ms, interactive after %.1f ms, "
+           "next command %.1f ms\n", MULTICLICK_MS, first / 1000.0, settled_us / 1000.0, next / 1000.0);
+
+    int failures = 0;
+    // The press must not cost more than it did on the link as it was opened
+    // 按键的代价不得超过建链时链路上的代价
+    const int64_t first_bound = opened_round_trip_us(config);
+    if (first < 0 || first > first_bound) {
+        printf("  key from idle: first command took %.1f ms, %.1f ms on the opened link\n",
+               first / 1000.0, first_bound / 1000.0);
+        failures++;
+    }
+    if (!settled) {
+        printf("  key from idle: not interactive %d ms after the press\n", SWITCH_TIMEOUT_MS);
+        failures++;
+    }
+    return failures;
+}
+
+/* A press whose update the camera refuses stays on idle; the next press from idle asks for interactive again */
+/* 相机拒绝按键的更新时链路保持 idle；空闲时的下一次按键再次请求 interactive */
+static int refused_key_from_idle(void) {
+    if (!wait_settled(BLE_LINK_PROFILE_IDLE, -1, KEY_HOLD_MS + SWITCH_TIMEOUT_MS)) {
+        printf("  refused key: link did not return to idle\n");
+        return 1;
+    }
+    sim_refuse_conn_updates(1);
+    s_next_key_us = 0;
+    pump_activity(LINK_ACTIVITY_KEY);
+    sleep_with_activity(-1, KEY_HOLD_MS + SWITCH_TIMEOUT_MS);
+    ble_link_params_t params;
+    ble_get_link_params(&params);
+    if (params.profile != BLE_LINK_PROFILE_IDLE) {
+        printf("  refused key: link went %s although the camera refused the update\n",
+               ble_link_profile_name(params.profile));
+        return 1;
+    }
+
+    s_next_key_us = 0;
+    const int64_t press_us = esp_timer_get_time();
+    const bool settled = wait_settled(BLE_LINK_PROFILE_INTERACTIVE, LINK_ACTIVITY_KEY, SWITCH_TIMEOUT_MS);
+    printf("Key press after a refused update: interactive after %.1f ms\n",
+           (esp_timer_get_time() - press_us) / 1000.0);
+    if (!settled) {
+        printf("  refused key: not interactive %d ms after the next press\n", SWITCH_TIMEOUT_MS);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int seconds = argc > 1 ? atoi(argv[1]) : DEFAULT_SECONDS;
+    sim_config_t config;
+
+    sim_default_config(&config);
+    if (seconds <= 0) {
+        fprintf(stderr, "usage: %s [seconds]\n", argv[0]);
+        return 2;
+    }
+
+    sim_init(&config);
+    sim_set_write_handler(camera_write_handler);
+    data_init();
+    product_nvs_init();
+    if (connect_logic_ble_init() != 0 || !wait_ms(gattc_registered, READY_TIMEOUT_MS)) {
+        printf("FAIL: BLE init\n");
+        return 1;
+    }
+    sim_camera_bda(s_ble_profile.remote_bda);
+    if (connect_logic_ble_connect(true) != 0 || !wait_ms(link_ready, READY_TIMEOUT_MS)) {
+        printf("FAIL: connection not ready\n");
+        return 1;
+    }
+    ble_set_notify_callback(bench_notify_handler);
+    ble_link_timing_t timing;
+    ble_get_link_timing(&timing);
+
+    printf("Link profiles, link opened at %.1f ms with %u octet PDUs on the 1M PHY, %.1f kB/s of 70 byte frames\n",
+           config.conn_interval_us / 1000.0, config.max_tx_octets, opened_capacity_kbps(&config));
+    printf("profile      interval ms  latency  octets  PHY  switch ms  cmd mean ms  cmd max ms   kB/s  "
+           "central ev/s  camera ev/s\n");
+
+    // Each profile is wanted from the activity that calls for it, idle from the end of the last hold
+    // 每个配置从需要它的活动开始计时，空闲从最后一个保持时间结束时开始计时
+    phase_result_t results[PHASE_COUNT];
+    int failures = 0;
+    for (size_t i = 0; i < PHASE_COUNT; i++) {
+        const phase_t *phase = &s_phases[i];
+        int64_t wanted_us = esp_timer_get_time();
+        if (phase->profile == BLE_LINK_PROFILE_INTERACTIVE) {
+            wanted_us = timing.ready_us;
+        } else if (phase->profile == BLE_LINK_PROFILE_IDLE) {
+            const int64_t key_end = s_last_key_us + KEY_HOLD_MS * 1000LL;
+            const int64_t gps_end = s_last_gps_us + GPS_HOLD_MS * 1000LL;
+            wanted_us = key_end > gps_end ? key_end : gps_end;
+        } else {
+            s_next_gps_us = 0;
+        }
+        if (run_phase(phase, wanted_us, seconds, &results[i]) != 0) {
+            failures++;
+            continue;
+        }
+        print_phase(phase, &results[i]);
+    }
+    if (failures == 0) {
+        failures += check(results, &config);
+        failures += key_from_idle(&config);
+        failures += refused_key_from_idle();
+    }
+
+    sim_stats_t stats;
+    sim_get_stats(&stats);
+    printf("Connection updates: %u\n", (unsigned)stats.conn_updates);
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,262 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Replays recorded advertisement streams through ble/scan_rank.c.
+ * 将录制的广播流回放给 ble/scan_rank.c。
+ *
+ * Every recording is scanned twice:
+ * 每段录制扫描两次：
+ * - previous: the rule ble.c used before, the full 4 s scan and the single strongest camera
+ *             advertisement at or above -80 dBm, with the AD structures walked for every result
+ *   previous：ble.c 之前的规则，完整扫描 4 秒，选择单条广播最强且不低于 -80 dBm 的相机，每条结果都遍历 AD 结构
+ * - ranked:   scan_rank_observe for every result, the scan stops once scan_rank_decided holds
+ *             and the leader is chosen, or at 4 s the leader if it is at or above -80 dBm
+ *   ranked：每条结果调用 scan_rank_observe，scan_rank_decided 成立即停止扫描并选择领先者，
+ *             否则 4 秒时选择不低于 -80 dBm 的领先者
+ *
+ * A choice is correct if it is the recording's truth (see adv_log_gen.c), or no camera when the
+ * truth is none. A scan that stops early can miss a camera it has not heard yet, so the process
+ * exits non-zero if the ranked scan is right in fewer recordings than the previous rule by more
+ * than 2% of a log, or in fewer recordings over all logs, or if it parses more advertisements
+ * than it skips.
+ * 选择与录制的 truth 相同（见 adv_log_gen.c），或 truth 为 none 时未选择相机，即为正确。
+ * 提前停止的扫描可能错过尚未听到的相机，因此当排名扫描在任一日志中的正确次数比旧规则少超过该日志的 2%、
+ * 或在全部日志中正确次数更少、或解析的广播多于跳过的广播时，进程返回非零值。
+ *
+ * Usage / 用法: scan_replay_test <log.adv>...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "scan_rank.h"
+
+#define SCAN_US             4000000
+#define MIN_RSSI            -80
+#define MAX_RESULTS         4096
+#define MAX_ADV             62          // Advertising data plus scan response / 广播数据加扫描响应
+#define TOLERANCE_PERCENT   2           // Accuracy the early stop may cost per log / 提前停止在每个日志中允许损失的准确率
+
+typedef struct {
+    int64_t t_us;
+    uint8_t bda[6];
+    int8_t rssi;
+    uint8_t adv[MAX_ADV];
+    uint8_t adv_len;
+    bool has_scan_rsp;
+} scan_result_t;
+
+typedef struct {
+    uint8_t truth[6];
+    bool has_truth;
+    int count;
+    scan_result_t results[MAX_RESULTS];
+} recording_t;
+
+typedef struct {
+    int recordings;
+    int previous_correct;
+    int ranked_correct;
+    int early_stops;
+    double ranked_scan_ms;
+    double ranked_scan_max_ms;
+    unsigned long previous_walks;
+    unsigned long ranked_walks;
+    unsigned long ranked_skipped;
+} log_result_t;
+
+static int parse_hex(const char *hex, uint8_t *out, int capacity) {
+    int n = 0;
+    if (strcmp(hex, "-") == 0) {
+        return 0;
+    }
+    for (; hex[0] && hex[1] && n < capacity; hex += 2) {
+        unsigned int byte;
+        if (sscanf(hex, "%2x", &byte) != 1) {
+            return -1;
+        }
+        out[n++] = (uint8_t)byte;
+    }
+    return n;
+}
+
+static bool parse_bda(const char *text, uint8_t bda[6]) {
+    unsigned int b[6];
+    if (sscanf(text, "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6) {
+        return false;
+    }
+    for (int i = 0; i < 6; i++) {
+        bda[i] = (uint8_t)b[i];
+    }
+    return true;
+}
+
+/* Read the next recording, false at the end of the log */
+/* 读取下一段录制，日志结束时返回 false */
+static bool read_recording(FILE *f, recording_t *rec) {
+    char line[512];
+    bool started = false;
+
+    rec->count = 0;
+    while (true) {
+        const long pos = ftell(f);
+        if (!fgets(line, sizeof(line), f)) {
+            return started;
+        }
+        char truth[32];
+        if (sscanf(line, "# recording %*d truth %31s", truth) == 1) {
+            if (started) {
+                fseek(f, pos, SEEK_SET);
+                return true;
+            }
+            started = true;
+            rec->has_truth = parse_bda(truth, rec->truth);
+            continue;
+        }
+        if (line[0] == '#' || !started || rec->count == MAX_RESULTS) {
+            continue;
+        }
+
+        scan_result_t *r = &rec->results[rec->count];
+        long long t_us;
+        char bda[32], adv[160], rsp[160];
+        int rssi;
+        if (sscanf(line, "%lld %31s %d %159s %159s", &t_us, bda, &rssi, adv, rsp) != 5 || !parse_bda(bda, r->bda)) {
+            continue;
+        }
+        const int adv_len = parse_hex(adv, r->adv, MAX_ADV);
+        const int rsp_len = adv_len < 0 ? -1 : parse_hex(rsp, r->adv + adv_len, MAX_ADV - adv_len);
+        if (adv_len < 0 || rsp_len < 0) {
+            continue;
+        }
+        r->t_us = t_us;
+        r->rssi = (int8_t)rssi;
+        r->adv_len = (uint8_t)(adv_len + rsp_len);
+        r->has_scan_rsp = rsp_len > 0;
+        rec->count++;
+    }
+}
+
+static bool choice_correct(const recording_t *rec, const uint8_t *choice) {
+    if (!rec->has_truth) {
+        return choice == NULL;
+    }
+    return choice != NULL && memcmp(choice, rec->truth, 6) == 0;
+}
+
+static void replay(const recording_t *rec, log_result_t *result) {
+    /* previous: strongest single advertisement over the whole scan */
+    /* previous：整个扫描中单条广播最强者 */
+    uint8_t previous[6];
+    int8_t previous_rssi = -128;
+    for (int i = 0; i < rec->count; i++) {
+        const scan_result_t *r = &rec->results[i];
+        result->previous_walks++;
+        if (scan_rank_parse_adv(r->adv, r->adv_len, NULL, 0) && r->rssi > previous_rssi && r->rssi >= MIN_RSSI) {
+            previous_rssi = r->rssi;
+            memcpy(previous, r->bda, 6);
+        }
+    }
+
+    /* ranked: stop once decided */
+    /* ranked：判定后即停止 */
+    static scan_rank_t rank;
+    int64_t stop_us = SCAN_US;
+    scan_rank_reset(&rank, NULL, 0);
+    for (int i = 0; i < rec->count; i++) {
+        const scan_result_t *r = &rec->results[i];
+        if (scan_rank_observe(&rank, r->bda, r->rssi, r->adv, r->adv_len, r->has_scan_rsp, r->t_us, NULL) &&
+            scan_rank_decided(&rank, r->t_us)) {
+            stop_us = r->t_us;
+            result->early_stops++;
+            break;
+        }
+    }
+    const scan_candidate_t *leader = scan_rank_leader(&rank);
+    const uint8_t *ranked = leader && leader->rssi_q4 >= MIN_RSSI * 16 ? leader->bda : NULL;
+
+    result->recordings++;
+    result->previous_correct += choice_correct(rec, previous_rssi > -128 ? previous : NULL);
+    result->ranked_correct += choice_correct(rec, ranked);
+    result->ranked_scan_ms += stop_us / 1000.0;
+    if (stop_us / 1000.0 > result->ranked_scan_max_ms) {
+        result->ranked_scan_max_ms = stop_us / 1000.0;
+    }
+    result->ranked_walks += rank.adv_parsed;
+    result->ranked_skipped += rank.adv_skipped;
+}
+
+int main(int argc, char **argv) {
+    static recording_t rec;
+    int failures = 0;
+    int previous_total = 0;
+    int ranked_total = 0;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <log.adv>...\n", argv[0]);
+        return 2;
+    }
+
+    printf("log              recs  previous ok  ranked ok  early stop  scan ms  scan max ms  AD walks prev/ranked\n");
+    for (int i = 1; i < argc; i++) {
+        FILE *f = fopen(argv[i], "r");
+        if (f == NULL) {
+            printf("%s: cannot open\n", argv[i]);
+            failures++;
+            continue;
+        }
+        log_result_t result = { 0 };
+        while (read_recording(f, &rec)) {
+            replay(&rec, &result);
+        }
+        fclose(f);
+        previous_total += result.previous_correct;
+        ranked_total += result.ranked_correct;
+
+        const char *name = strrchr(argv[i], '/') ? strrchr(argv[i], '/') + 1 : argv[i];
+        const int n = result.recordings ? result.recordings : 1;
+        printf("%-16s %4d %11.1f%% %9.1f%% %10.1f%% %8.1f %12.1f %10lu / %lu\n", name, result.recordings,
+               100.0 * result.previous_correct / n, 100.0 * result.ranked_correct / n,
+               100.0 * result.early_stops / n, result.ranked_scan_ms / n, result.ranked_scan_max_ms,
+               result.previous_walks, result.ranked_walks);
+
+        if (result.recordings == 0) {
+            printf("  %s: no recordings\n", name);
+            failures++;
+        }
+        if ((result.previous_correct - result.ranked_correct) * 100 > TOLERANCE_PERCENT * result.recordings) {
+            printf("  %s: ranked scan chose worse than the previous rule\n", name);
+            failures++;
+        }
+        if (result.ranked_walks > result.ranked_skipped) {
+            printf("  %s: %lu advertisements parsed, only %lu skipped\n", name, result.ranked_walks, result.ranked_skipped);
+            failures++;
+        }
+    }
+    printf("Correct choices over all logs: %d previous, %d ranked\n", previous_total, ranked_total);
+    if (ranked_total < previous_total) {
+        failures++;
+    }
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
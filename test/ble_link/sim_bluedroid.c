@@ -0,0 +1,1439 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Simulated Bluedroid stack and camera, see sim_bluedroid.h.
+ * 模拟 Bluedroid 协议栈与相机，参见 sim_bluedroid.h。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "esp_bt.h"
+#include "esp_bt_main.h"
+#include "esp_gap_ble_api.h"
+#include "esp_gattc_api.h"
+#include "esp_gatt_common_api.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+
+#include "sim_bluedroid.h"
+
+#define SIM_GATTC_IF            3
+#define SIM_CONN_ID             0
+#define SIM_DEFAULT_MTU         23
+#define SIM_HOST_LATENCY_US     500     // Host to controller before a request can go out / 请求可发出前主机到控制器的延迟
+#define SIM_ADV_DELAY_US        10000   // advDelay, 0-10 ms added to every advertising interval / 每个广播间隔附加的 0-10 ms
+#define SIM_CONNECT_DELAY_US    2500    // CONNECT_IND to the first connection event / CONNECT_IND 到第一个连接事件
+#define SIM_MAX_EVENTS          64
+#define SIM_MAX_VALUE           512
+#define SIM_MAX_ATTRS           64
+#define SIM_MAX_SERVICES        8
+#define SIM_MAX_CHARS           16
+
+#define SIM_PROP_INDICATE       (1 << 5)
+
+#define REASON_LOCAL_HOST_TERMINATED 0x16
+
+/* ---------- camera GATT database ---------- */
+
+typedef struct {
+    uint16_t uuid;
+    uint8_t props;
+} sim_char_def_t;
+
+typedef struct {
+    uint16_t uuid;
+    sim_char_def_t chars[4];
+    int char_count;
+} sim_service_def_t;
+
+/* GAP, GATT, Device Information and the vendor service with the write (0xFFF5) and notify (0xFFF4) characteristics */
+/* GAP、GATT、设备信息服务，以及含写特征（0xFFF5）与通知特征（0xFFF4）的厂商服务 */
+static const sim_service_def_t s_service_defs[] = {
+    { 0x1800, { { 0x2A00, ESP_GATT_CHAR_PROP_BIT_READ },
+                { 0x2A01, ESP_GATT_CHAR_PROP_BIT_READ },
+                { 0x2A04, ESP_GATT_CHAR_PROP_BIT_READ } }, 3 },
+    { 0x1801, { { 0x2A05, SIM_PROP_INDICATE } }, 1 },
+    { 0x180A, { { 0x2A29, ESP_GATT_CHAR_PROP_BIT_READ },
+                { 0x2A24, ESP_GATT_CHAR_PROP_BIT_READ },
+                { 0x2A26, ESP_GATT_CHAR_PROP_BIT_READ } }, 3 },
+    { 0xFFF0, { { 0xFFF3, ESP_GATT_CHAR_PROP_BIT_READ | ESP_GATT_CHAR_PROP_BIT_WRITE },
+                { 0xFFF4, ESP_GATT_CHAR_PROP_BIT_NOTIFY },
+                { 0xFFF5, ESP_GATT_CHAR_PROP_BIT_WRITE | ESP_GATT_CHAR_PROP_BIT_WRITE_NR } }, 3 },
+};
+
+typedef enum {
+    ATTR_SERVICE,
+    ATTR_CHAR_DECL,
+    ATTR_CHAR_VALUE,
+    ATTR_CCCD,
+} sim_attr_type_t;
+
+typedef struct {
+    sim_attr_type_t type;
+    uint16_t uuid;
+    uint8_t props;
+    uint16_t value_handle;      // For a declaration / 声明属性使用
+    uint16_t cccd;              // Current value of a CCCD / CCCD 的当前值
+} sim_attr_t;
+
+typedef struct {
+    uint16_t uuid;
+    uint16_t start;
+    uint16_t end;
+} sim_service_t;
+
+typedef struct {
+    uint16_t uuid;
+    uint8_t props;
+    uint16_t decl;
+    uint16_t value;
+    uint16_t cccd;              // 0 without one / 无 CCCD 时为 0
+    uint16_t service_end;
+} sim_char_t;
+
+/* ---------- events ---------- */
+
+typedef enum {
+    EV_GAP,                     // Deliver a GAP event as is / 原样投递 GAP 事件
+    EV_GATTC,                   // Deliver a GATTC event as is / 原样投递 GATTC 事件
+    EV_ADV,                     // The camera advertises / 相机广播
+    EV_SCAN_TIMEOUT,
+    EV_CONNECT,
+    EV_DISCONNECT,
+    EV_MTU_DONE,
+    EV_SEARCH_DONE,
+    EV_READ_DONE,
+    EV_WRITE_DONE,
+    EV_WRITE_DESCR_DONE,
+    EV_NOTIFY,
+    EV_DROP,                    // Injected link loss / 注入的断链
+    EV_TX_DONE,                 // A Write Without Response reached the camera / Write Without Response 到达相机
+    EV_CONN_UPDATE,             // Connection update instant / 连接参数更新时刻
+    EV_DATA_LEN,                // Data length exchange done / 数据长度交换完成
+    EV_PHY_UPDATE,              // PHY update instant / PHY 更新时刻
+} sim_event_type_t;
+
+typedef struct {
+    int64_t due_us;
+    uint64_t order;
+    sim_event_type_t type;
+    uint32_t gen;               // Link or scan generation the event belongs to, 0 for any / 事件所属的连接或扫描代数，0 表示不限
+    int cb_event;
+    union {
+        esp_ble_gap_cb_param_t gap;
+        esp_ble_gattc_cb_param_t gattc;
+    } param;
+    uint16_t handle;
+    uint16_t length;
+    uint8_t data[SIM_MAX_VALUE];
+} sim_event_t;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    sim_config_t config;
+    uint32_t rng;
+
+    esp_gap_ble_cb_t gap_cb;
+    esp_gattc_cb_t gattc_cb;
+    uint16_t local_mtu;
+
+    esp_bd_addr_t camera_bda;
+    uint8_t adv[ESP_BLE_ADV_DATA_LEN_MAX];
+    uint8_t adv_len;
+    bool advertising;
+    bool adv_enabled;
+
+    sim_attr_t attrs[SIM_MAX_ATTRS];
+    int attr_count;
+    sim_service_t services[SIM_MAX_SERVICES];
+    int service_count;
+    sim_char_t chars[SIM_MAX_CHARS];
+    int char_count;
+
+    bool scanning;
+    uint32_t scan_gen;
+    uint32_t scan_duty_permille;
+
+    bool opening;
+    esp_bd_addr_t open_bda;
+    bool connected;
+    uint32_t link_gen;
+    int64_t anchor_us;
+    uint32_t conn_interval_us;  // Current connection interval / 当前连接间隔
+    uint16_t latency;           // Connection events the camera may skip / 相机可跳过的连接事件数
+    uint16_t tx_octets;         // LL payload per PDU / 每个 PDU 的链路层载荷
+    uint8_t phy;                // ESP_BLE_GAP_PHY_1M or ESP_BLE_GAP_PHY_2M
+    int64_t ll_free_us;         // End of the running LL control procedure / 正在进行的链路层控制过程的结束时刻
+    int64_t awake_from_us;      // The camera listens at every event from here, see next_listen_event / 相机自此在每个事件监听，见 next_listen_event
+    int64_t awake_until_us;     // End of that window / 该时间窗的结束
+    uint32_t refuse_updates;    // Connection updates still to refuse / 仍需拒绝的连接参数更新数
+    int64_t att_free_us;
+    uint16_t mtu;
+    bool cache_ready;
+    uint32_t drop_at_request;   // 0 when no drop is armed / 未设置断链时为 0
+    bool drop_at_write;
+    int drop_reason;
+    sim_write_handler_t write_handler;
+    sim_event_hook_t event_hook;
+    uint16_t tx_free;           // Free controller buffers / 空闲的控制器缓冲区
+    bool tx_congested;
+    int64_t tx_event_us;        // Connection event being filled with PDUs / 正在填充 PDU 的连接事件
+    uint32_t tx_event_air_us;   // Air time already used in that event / 该事件已用的空中时间
+
+    sim_stats_t stats;
+
+    sim_event_t events[SIM_MAX_EVENTS];
+    int event_count;
+    uint64_t order;
+} s_sim;
+
+static uint32_t next_random(void) {
+    uint32_t x = s_sim.rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    s_sim.rng = x;
+    return x;
+}
+
+static int64_t now_us(void) {
+    return esp_timer_get_time();
+}
+
+/* Queue an event; the caller holds the lock and fills in the rest through the returned pointer */
+/* 排入一个事件；调用者持有锁，并通过返回的指针填写其余字段 */
+static sim_event_t *push_event(sim_event_type_t type, int64_t due_us, uint32_t gen) {
+    if (s_sim.event_count >= SIM_MAX_EVENTS) {
+        fprintf(stderr, "sim_bluedroid: event queue full\n");
+        abort();
+    }
+    sim_event_t *ev = &s_sim.events[s_sim.event_count++];
+    memset(ev, 0, offsetof(sim_event_t, data));
+    ev->type = type;
+    ev->due_us = due_us;
+    ev->order = s_sim.order++;
+    ev->gen = gen;
+    pthread_cond_signal(&s_sim.cond);
+    return ev;
+}
+
+static sim_event_t *push_gap(esp_gap_ble_cb_event_t event, int64_t due_us) {
+    sim_event_t *ev = push_event(EV_GAP, due_us, 0);
+    ev->cb_event = event;
+    return ev;
+}
+
+static sim_event_t *push_gattc(esp_gattc_cb_event_t event, int64_t due_us, uint32_t gen) {
+    sim_event_t *ev = push_event(EV_GATTC, due_us, gen);
+    ev->cb_event = event;
+    return ev;
+}
+
+/* ---------- database ---------- */
+
+static void build_database(uint16_t first_handle) {
+    s_sim.attr_count = 0;
+    s_sim.service_count = 0;
+    s_sim.char_count = 0;
+    uint16_t handle = first_handle;
+    for (size_t s = 0; s < sizeof(s_service_defs) / sizeof(s_service_defs[0]); s++) {
+        const sim_service_def_t *def = &s_service_defs[s];
+        sim_service_t *service = &s_sim.services[s_sim.service_count++];
+        service->uuid = def->uuid;
+        service->start = handle;
+        s_sim.attrs[s_sim.attr_count++] = (sim_attr_t){ .type = ATTR_SERVICE, .uuid = def->uuid };
+        handle++;
+        for (int c = 0; c < def->char_count; c++) {
+            sim_char_t *ch = &s_sim.chars[s_sim.char_count++];
+            ch->uuid = def->chars[c].uuid;
+            ch->props = def->chars[c].props;
+            ch->decl = handle;
+            ch->value = (uint16_t)(handle + 1);
+            ch->cccd = 0;
+            s_sim.attrs[s_sim.attr_count++] = (sim_attr_t){
+                .type = ATTR_CHAR_DECL, .uuid = ch->uuid, .props = ch->props, .value_handle = ch->value };
+            s_sim.attrs[s_sim.attr_count++] = (sim_attr_t){
+                .type = ATTR_CHAR_VALUE, .uuid = ch->uuid, .props = ch->props };
+            handle += 2;
+            if (ch->props & (ESP_GATT_CHAR_PROP_BIT_NOTIFY | SIM_PROP_INDICATE)) {
+                ch->cccd = handle++;
+                s_sim.attrs[s_sim.attr_count++] = (sim_attr_t){
+                    .type = ATTR_CCCD, .uuid = ESP_GATT_UUID_CHAR_CLIENT_CONFIG };
+            }
+        }
+        service->end = (uint16_t)(handle - 1);
+        for (int c = s_sim.char_count - def->char_count; c < s_sim.char_count; c++) {
+            s_sim.chars[c].service_end = service->end;
+        }
+    }
+    s_sim.config.first_handle = first_handle;
+}
+
+static sim_attr_t *find_attr(uint16_t handle) {
+    if (handle < s_sim.config.first_handle || handle >= s_sim.config.first_handle + s_sim.attr_count) {
+        return NULL;
+    }
+    return &s_sim.attrs[handle - s_sim.config.first_handle];
+}
+
+static const sim_char_t *find_char(uint16_t uuid) {
+    for (int i = 0; i < s_sim.char_count; i++) {
+        if (s_sim.chars[i].uuid == uuid) {
+            return &s_sim.chars[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * ATT requests of a discovery without cache at the given MTU: Read By Group Type for the primary
+ * services, then per service Read By Type for included services and for characteristics, and a
+ * Find Information for every characteristic with room for descriptors after its value. Each
+ * listing ends with a request answered by Attribute Not Found.
+ * 在给定 MTU 下无缓存发现所需的 ATT 请求数：主服务用 Read By Group Type；每个服务用 Read By Type 查找包含服务与特征；
+ * 每个值句柄之后还有描述符空间的特征各用一次 Find Information。每种列举都以一个返回 Attribute Not Found 的请求结束。
+ */
+static uint32_t discovery_requests(uint16_t mtu) {
+    const uint32_t services_per_response = (uint32_t)(mtu - 2) / 6;
+    const uint32_t chars_per_response = (uint32_t)(mtu - 2) / 7;
+    uint32_t requests = (uint32_t)(s_sim.service_count + services_per_response - 1) / services_per_response + 1;
+    for (int s = 0; s < s_sim.service_count; s++) {
+        uint32_t chars = 0;
+        for (int c = 0; c < s_sim.char_count; c++) {
+            const sim_char_t *ch = &s_sim.chars[c];
+            if (ch->decl > s_sim.services[s].start && ch->decl <= s_sim.services[s].end) {
+                chars++;
+                if (ch->cccd) {
+                    requests++;
+                }
+            }
+        }
+        requests += 1 + (chars + chars_per_response - 1) / chars_per_response + 1;
+    }
+    return requests;
+}
+
+/* ---------- link timing ---------- */
+
+static int64_t next_event_every(int64_t t, int64_t interval) {
+    if (t <= s_sim.anchor_us) {
+        return s_sim.anchor_us;
+    }
+    return s_sim.anchor_us + (t - s_sim.anchor_us + interval - 1) / interval * interval;
+}
+
+static int64_t next_connection_event(int64_t t) {
+    return next_event_every(t, s_sim.conn_interval_us);
+}
+
+/* With peripheral latency the camera only listens every latency + 1 events, so data to it waits for such an event.
+ * From receiving an LL control procedure until it ends the camera listens at every event, as it acknowledges the traffic. */
+/* 存在外设延迟时相机每 latency + 1 个事件才监听一次，发往相机的数据须等待这样的事件。
+ * 从收到链路层控制过程到该过程结束，相机因需确认这些数据而在每个事件监听。 */
+static int64_t next_listen_event(int64_t t) {
+    const int64_t every = next_connection_event(t);
+    if (every >= s_sim.awake_from_us && every < s_sim.awake_until_us) {
+        return every;
+    }
+    return next_event_every(t, (int64_t)s_sim.conn_interval_us * (s_sim.latency + 1));
+}
+
+/* The camera received a control procedure at sent that runs until end */
+/* 相机在 sent 时刻收到一个持续到 end 的控制过程 */
+static void camera_awake(int64_t sent, int64_t end) {
+    if (sent > s_sim.awake_until_us) {
+        s_sim.awake_from_us = sent;
+    }
+    s_sim.awake_until_us = end;
+}
+
+/* Air time of one data PDU and the camera's empty reply, with both inter frame spaces */
+/* 一个数据 PDU 及相机空回复的空中时间，含两个帧间隔 */
+static uint32_t pdu_air_us(uint32_t octets, uint8_t phy) {
+    const uint32_t us_per_octet = phy == ESP_BLE_GAP_PHY_2M ? 4 : 8;
+    const uint32_t overhead = phy == ESP_BLE_GAP_PHY_2M ? 11 : 10;   // Preamble, access address, header, CRC / 前导、接入地址、头、CRC
+    return (octets + overhead) * us_per_octet + 150 + overhead * us_per_octet + 150;
+}
+
+/* Reserve the ATT bearer for a chain of requests and return when the last response arrives */
+/* 为一串请求占用 ATT 通道，返回最后一个响应到达的时刻 */
+static int64_t schedule_att(uint32_t requests) {
+    int64_t t = s_sim.att_free_us > now_us() ? s_sim.att_free_us : now_us();
+    int64_t response = t;
+    for (uint32_t i = 0; i < requests; i++) {
+        const int64_t sent = next_listen_event(t + SIM_HOST_LATENCY_US);
+        if (s_sim.drop_at_request && s_sim.stats.att_requests + i + 1 == s_sim.drop_at_request) {
+            sim_event_t *ev = push_event(EV_DROP, sent, s_sim.link_gen);
+            ev->param.gattc.disconnect.reason = s_sim.drop_reason;
+            s_sim.drop_at_request = 0;
+        }
+        response = sent + s_sim.conn_interval_us;
+        t = response;
+    }
+    s_sim.att_free_us = response;
+    s_sim.stats.att_requests += requests;
+    return response;
+}
+
+/* Place the PDUs of a Write Without Response in the next connection events with air time left, return the last one.
+ * An event lasts as long as tx_pdus_per_event PDUs of 27 octets on the 1M PHY. */
+/* 将 Write Without Response 的 PDU 放入后续仍有空中时间的连接事件，返回最后一个事件的时刻。
+ * 每个事件的时长相当于 1M PHY 上 tx_pdus_per_event 个 27 字节 PDU。 */
+static int64_t schedule_tx(uint16_t value_len) {
+    const uint32_t budget = s_sim.config.tx_pdus_per_event * pdu_air_us(27, ESP_BLE_GAP_PHY_1M);
+    uint32_t remaining = (uint32_t)value_len + 3 + 4;     // ATT and L2CAP headers / ATT 与 L2CAP 头
+    int64_t t = next_listen_event(now_us() + SIM_HOST_LATENCY_US);
+    if (t < s_sim.tx_event_us) {
+        t = s_sim.tx_event_us;
+    }
+    while (1) {
+        if (t != s_sim.tx_event_us) {
+            s_sim.tx_event_us = t;
+            s_sim.tx_event_air_us = 0;
+        }
+        const uint32_t octets = remaining < s_sim.tx_octets ? remaining : s_sim.tx_octets;
+        const uint32_t air = pdu_air_us(octets, s_sim.phy);
+        // An event always carries at least one PDU / 每个事件至少承载一个 PDU
+        if (s_sim.tx_event_air_us == 0 || s_sim.tx_event_air_us + air <= budget) {
+            s_sim.tx_event_air_us += air;
+            remaining -= octets;
+            if (remaining == 0) {
+                return t;
+            }
+        } else {
+            t += s_sim.conn_interval_us;
+        }
+    }
+}
+
+static void push_congest(bool congested) {
+    sim_event_t *ev = push_gattc(ESP_GATTC_CONGEST_EVT, now_us(), s_sim.link_gen);
+    ev->param.gattc.congest.conn_id = SIM_CONN_ID;
+    ev->param.gattc.congest.congested = congested;
+}
+
+static void schedule_adv(int64_t from_us) {
+    if (!s_sim.adv_enabled) {
+        s_sim.advertising = false;
+        return;
+    }
+    s_sim.advertising = true;
+    push_event(EV_ADV, from_us + s_sim.config.adv_interval_us + next_random() % SIM_ADV_DELAY_US, 0);
+}
+
+static void start_disconnect(int64_t due_us, int reason) {
+    s_sim.connected = false;
+    s_sim.link_gen++;
+    sim_event_t *ev = push_event(EV_DISCONNECT, due_us, 0);
+    ev->param.gattc.disconnect.reason = reason;
+}
+
+/* ---------- event handling, on the simulated BTC thread ---------- */
+
+static void record_callback_time(int64_t start_us) {
+    const int64_t elapsed = now_us() - start_us;
+    pthread_mutex_lock(&s_sim.lock);
+    if (elapsed > s_sim.stats.max_callback_us) {
+        s_sim.stats.max_callback_us = elapsed;
+    }
+    pthread_mutex_unlock(&s_sim.lock);
+}
+
+static void deliver_gattc(esp_gattc_cb_event_t event, esp_ble_gattc_cb_param_t *param) {
+    if (s_sim.gattc_cb) {
+        const int64_t start = now_us();
+        s_sim.gattc_cb(event, SIM_GATTC_IF, param);
+        record_callback_time(start);
+    }
+}
+
+static void deliver_gap(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param) {
+    if (s_sim.gap_cb) {
+        const int64_t start = now_us();
+        s_sim.gap_cb(event, param);
+        record_callback_time(start);
+    }
+}
+
+static void handle_adv(void) {
+    pthread_mutex_lock(&s_sim.lock);
+    if (s_sim.connected) {
+        s_sim.advertising = false;
+        pthread_mutex_unlock(&s_sim.lock);
+        return;
+    }
+    const int64_t now = now_us();
+    if (s_sim.opening && memcmp(s_sim.open_bda, s_sim.camera_bda, ESP_BD_ADDR_LEN) == 0) {
+        s_sim.opening = false;
+        s_sim.advertising = false;
+        push_event(EV_CONNECT, now + SIM_CONNECT_DELAY_US, 0);
+        pthread_mutex_unlock(&s_sim.lock);
+        return;
+    }
+    bool report = s_sim.scanning && next_random() % 1000 < s_sim.scan_duty_permille;
+    esp_ble_gap_cb_param_t param;
+    memset(&param, 0, sizeof(param));
+    if (report) {
+        param.scan_rst.search_evt = ESP_GAP_SEARCH_INQ_RES_EVT;
+        memcpy(param.scan_rst.bda, s_sim.camera_bda, ESP_BD_ADDR_LEN);
+        param.scan_rst.rssi = s_sim.config.rssi + (int)(next_random() % 7) - 3;
+        memcpy(param.scan_rst.ble_adv, s_sim.adv, s_sim.adv_len);
+        param.scan_rst.adv_data_len = s_sim.adv_len;
+    }
+    schedule_adv(now);
+    pthread_mutex_unlock(&s_sim.lock);
+    if (report) {
+        deliver_gap(ESP_GAP_BLE_SCAN_RESULT_EVT, &param);
+    }
+}
+
+static void handle_connect(void) {
+    esp_ble_gattc_cb_param_t param;
+    memset(&param, 0, sizeof(param));
+
+    pthread_mutex_lock(&s_sim.lock);
+    const int64_t now = now_us();
+    s_sim.connected = true;
+    s_sim.link_gen++;
+    s_sim.anchor_us = now;
+    s_sim.att_free_us = now;
+    s_sim.mtu = SIM_DEFAULT_MTU;
+    s_sim.cache_ready = false;
+    for (int i = 0; i < s_sim.attr_count; i++) {
+        s_sim.attrs[i].cccd = 0;
+    }
+    s_sim.tx_free = s_sim.config.tx_buffers;
+    s_sim.tx_congested = false;
+    s_sim.tx_event_us = 0;
+    s_sim.tx_event_air_us = 0;
+    s_sim.conn_interval_us = s_sim.config.conn_interval_us;
+    s_sim.latency = 0;
+    s_sim.tx_octets = s_sim.config.max_tx_octets;
+    s_sim.phy = ESP_BLE_GAP_PHY_1M;
+    s_sim.ll_free_us = now;
+    s_sim.awake_from_us = 0;
+    s_sim.awake_until_us = 0;
+    s_sim.stats.att_requests = 0;
+    s_sim.stats.connections++;
+    s_sim.stats.connected_us = now;
+    s_sim.stats.notify_enabled_us = 0;
+    pthread_mutex_unlock(&s_sim.lock);
+
+    param.connect.conn_id = SIM_CONN_ID;
+    memcpy(param.connect.remote_bda, s_sim.camera_bda, ESP_BD_ADDR_LEN);
+    deliver_gattc(ESP_GATTC_CONNECT_EVT, &param);
+
+    memset(&param, 0, sizeof(param));
+    param.open.status = ESP_GATT_OK;
+    param.open.conn_id = SIM_CONN_ID;
+    memcpy(param.open.remote_bda, s_sim.camera_bda, ESP_BD_ADDR_LEN);
+    param.open.mtu = SIM_DEFAULT_MTU;
+    deliver_gattc(ESP_GATTC_OPEN_EVT, &param);
+}
+
+static void handle_disconnect(sim_event_t *ev) {
+    pthread_mutex_lock(&s_sim.lock);
+    s_sim.cache_ready = false;
+    s_sim.stats.notify_enabled_us = 0;
+    if (!s_sim.advertising) {
+        schedule_adv(now_us());
+    }
+    pthread_mutex_unlock(&s_sim.lock);
+
+    esp_ble_gattc_cb_param_t param;
+    memset(&param, 0, sizeof(param));
+    param.disconnect.reason = ev->param.gattc.disconnect.reason;
+    param.disconnect.conn_id = SIM_CONN_ID;
+    memcpy(param.disconnect.remote_bda, s_sim.camera_bda, ESP_BD_ADDR_LEN);
+    deliver_gattc(ESP_GATTC_DISCONNECT_EVT, &param);
+
+    memset(&param, 0, sizeof(param));
+    param.close.status = ESP_GATT_OK;
+    param.close.conn_id = SIM_CONN_ID;
+    param.close.reason = ev->param.gattc.disconnect.reason;
+    memcpy(param.close.remote_bda, s_sim.camera_bda, ESP_BD_ADDR_LEN);
+    deliver_gattc(ESP_GATTC_CLOSE_EVT, &param);
+}
+
+static void handle_search_done(void) {
+    sim_service_t services[SIM_MAX_SERVICES];
+    pthread_mutex_lock(&s_sim.lock);
+    s_sim.cache_ready = true;
+    const int count = s_sim.service_count;
+    memcpy(services, s_sim.services, sizeof(services));
+    pthread_mutex_unlock(&s_sim.lock);
+
+    esp_ble_gattc_cb_param_t param;
+    for (int i = 0; i < count; i++) {
+        memset(&param, 0, sizeof(param));
+        param.search_res.conn_id = SIM_CONN_ID;
+        param.search_res.start_handle = services[i].start;
+        param.search_res.end_handle = services[i].end;
+        param.search_res.srvc_id.uuid.len = ESP_UUID_LEN_16;
+        param.search_res.srvc_id.uuid.uuid.uuid16 = services[i].uuid;
+        param.search_res.is_primary = true;
+        deliver_gattc(ESP_GATTC_SEARCH_RES_EVT, &param);
+    }
+    memset(&param, 0, sizeof(param));
+    param.search_cmpl.status = ESP_GATT_OK;
+    param.search_cmpl.conn_id = SIM_CONN_ID;
+    deliver_gattc(ESP_GATTC_SEARCH_CMPL_EVT, &param);
+}
+
+static void handle_read_done(sim_event_t *ev) {
+    esp_ble_gattc_cb_param_t param;
+    memset(&param, 0, sizeof(param));
+    param.read.conn_id = SIM_CONN_ID;
+    param.read.handle = ev->handle;
+
+    pthread_mutex_lock(&s_sim.lock);
+    const sim_attr_t *attr = find_attr(ev->handle);
+    uint16_t length = 0;
+    if (attr == NULL) {
+        param.read.status = ESP_GATT_INVALID_HANDLE;
+    } else if (attr->type == ATTR_CHAR_DECL) {
+        ev->data[0] = attr->props;
+        ev->data[1] = (uint8_t)attr->value_handle;
+        ev->data[2] = (uint8_t)(attr->value_handle >> 8);
+        ev->data[3] = (uint8_t)attr->uuid;
+        ev->data[4] = (uint8_t)(attr->uuid >> 8);
+        length = 5;
+    } else if (attr->type == ATTR_SERVICE) {
+        ev->data[0] = (uint8_t)attr->uuid;
+        ev->data[1] = (uint8_t)(attr->uuid >> 8);
+        length = 2;
+    } else if (attr->type == ATTR_CCCD) {
+        ev->data[0] = (uint8_t)attr->cccd;
+        ev->data[1] = (uint8_t)(attr->cccd >> 8);
+        length = 2;
+    } else if (attr->props & ESP_GATT_CHAR_PROP_BIT_READ) {
+        length = (uint16_t)snprintf((char *)ev->data, sizeof(ev->data), "sim %04x", attr->uuid);
+    } else {
+        param.read.status = ESP_GATT_READ_NOT_PERMIT;
+    }
+    pthread_mutex_unlock(&s_sim.lock);
+
+    param.read.value = length ? ev->data : NULL;
+    param.read.value_len = length;
+    deliver_gattc(ESP_GATTC_READ_CHAR_EVT, &param);
+}
+
+static esp_gatt_status_t write_attr(uint16_t handle, const uint8_t *value, uint16_t length, bool descriptor) {
+    sim_attr_t *attr = find_attr(handle);
+    if (attr == NULL) {
+        return ESP_GATT_INVALID_HANDLE;
+    }
+    if (attr->type == ATTR_CCCD) {
+        if (length != 2) {
+            return ESP_GATT_INVALID_PDU;
+        }
+        attr->cccd = (uint16_t)(value[0] | (value[1] << 8));
+        const sim_char_t *notify = find_char(0xFFF4);
+        if (notify && handle == notify->cccd) {
+            s_sim.stats.notify_enabled_us = (attr->cccd & 1) ? now_us() : 0;
+        }
+        return ESP_GATT_OK;
+    }
+    // A characteristic value written through the descriptor API is still written, as ATT does not know the difference
+    // 通过描述符 API 写入的特征值仍会被写入，ATT 层并不区分两者
+    if (attr->type == ATTR_CHAR_VALUE &&
+        (attr->props & (ESP_GATT_CHAR_PROP_BIT_WRITE | ESP_GATT_CHAR_PROP_BIT_WRITE_NR))) {
+        (void)descriptor;
+        return ESP_GATT_OK;
+    }
+    return ESP_GATT_WRITE_NOT_PERMIT;
+}
+
+/* Hand a value written to the write characteristic to the camera; called without the lock */
+/* 将写入写特征的值交给相机；调用时不持有锁 */
+static void camera_receive(uint16_t handle, const uint8_t *value, uint16_t length) {
+    pthread_mutex_lock(&s_sim.lock);
+    const sim_char_t *write = find_char(0xFFF5);
+    const sim_write_handler_t handler = write && write->value == handle ? s_sim.write_handler : NULL;
+    pthread_mutex_unlock(&s_sim.lock);
+    if (handler) {
+        handler(value, length);
+    }
+}
+
+static void handle_write_done(sim_event_t *ev, bool descriptor) {
+    esp_ble_gattc_cb_param_t param;
+    memset(&param, 0, sizeof(param));
+    param.write.conn_id = SIM_CONN_ID;
+    param.write.handle = ev->handle;
+    pthread_mutex_lock(&s_sim.lock);
+    param.write.status = write_attr(ev->handle, ev->data, ev->length, descriptor);
+    pthread_mutex_unlock(&s_sim.lock);
+    if (param.write.status == ESP_GATT_OK && !descriptor) {
+        camera_receive(ev->handle, ev->data, ev->length);
+    }
+    deliver_gattc(descriptor ? ESP_GATTC_WRITE_DESCR_EVT : ESP_GATTC_WRITE_CHAR_EVT, &param);
+}
+
+static void handle_tx_done(sim_event_t *ev) {
+    pthread_mutex_lock(&s_sim.lock);
+    s_sim.tx_free++;
+    if (s_sim.tx_congested && s_sim.tx_free >= (s_sim.config.tx_buffers + 1) / 2) {
+        s_sim.tx_congested = false;
+        push_congest(false);
+    }
+    esp_ble_gattc_cb_param_t param;
+    memset(&param, 0, sizeof(param));
+    param.write.conn_id = SIM_CONN_ID;
+    param.write.handle = ev->handle;
+    param.write.status = write_attr(ev->handle, ev->data, ev->length, false);
+    pthread_mutex_unlock(&s_sim.lock);
+    if (param.write.status == ESP_GATT_OK) {
+        camera_receive(ev->handle, ev->data, ev->length);
+    }
+    deliver_gattc(ESP_GATTC_WRITE_CHAR_EVT, &param);
+}
+
+/* The new parameters apply from the instant on, which becomes the anchor of the following events */
+/* 新参数从更新时刻起生效，该时刻成为后续事件的锚点 */
+static void handle_conn_update(sim_event_t *ev) {
+    esp_ble_gap_cb_param_t *param = &ev->param.gap;
+    pthread_mutex_lock(&s_sim.lock);
+    if (param->update_conn_params.status == ESP_BT_STATUS_SUCCESS) {
+        s_sim.anchor_us = now_us();
+        s_sim.conn_interval_us = param->update_conn_params.conn_int * 1250u;
+        s_sim.latency = param->update_conn_params.latency;
+        s_sim.tx_event_us = 0;
+        s_sim.tx_event_air_us = 0;
+        s_sim.stats.conn_updates++;
+    }
+    pthread_mutex_unlock(&s_sim.lock);
+    deliver_gap(ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT, param);
+}
+
+static void handle_data_len(sim_event_t *ev) {
+    pthread_mutex_lock(&s_sim.lock);
+    s_sim.tx_octets = ev->param.gap.pkt_data_length_cmpl.params.tx_len;
+    pthread_mutex_unlock(&s_sim.lock);
+    deliver_gap(ESP_GAP_BLE_SET_PKT_LENGTH_COMPLETE_EVT, &ev->param.gap);
+}
+
+static void handle_phy_update(sim_event_t *ev) {
+    pthread_mutex_lock(&s_sim.lock);
+    s_sim.phy = ev->param.gap.phy_update.tx_phy;
+    pthread_mutex_unlock(&s_sim.lock);
+    deliver_gap(ESP_GAP_BLE_PHY_UPDATE_COMPLETE_EVT, &ev->param.gap);
+}
+
+static void handle_notify(sim_event_t *ev) {
+    esp_ble_gattc_cb_param_t param;
+    memset(&param, 0, sizeof(param));
+    param.notify.conn_id = SIM_CONN_ID;
+    memcpy(param.notify.remote_bda, s_sim.camera_bda, ESP_BD_ADDR_LEN);
+    param.notify.handle = ev->handle;
+    param.notify.value = ev->data;
+    param.notify.value_len = ev->length;
+    param.notify.is_notify = true;
+    deliver_gattc(ESP_GATTC_NOTIFY_EVT, &param);
+}
+
+static void handle_mtu_done(void) {
+    esp_ble_gattc_cb_param_t param;
+    memset(&param, 0, sizeof(param));
+    pthread_mutex_lock(&s_sim.lock);
+    s_sim.mtu = s_sim.local_mtu < s_sim.config.camera_mtu ? s_sim.local_mtu : s_sim.config.camera_mtu;
+    param.cfg_mtu.mtu = s_sim.mtu;
+    pthread_mutex_unlock(&s_sim.lock);
+    param.cfg_mtu.status = ESP_GATT_OK;
+    param.cfg_mtu.conn_id = SIM_CONN_ID;
+    deliver_gattc(ESP_GATTC_CFG_MTU_EVT, &param);
+}
+
+static void handle_event(sim_event_t *ev) {
+    switch (ev->type) {
+    case EV_GAP:
+        deliver_gap((esp_gap_ble_cb_event_t)ev->cb_event, &ev->param.gap);
+        break;
+    case EV_GATTC:
+        deliver_gattc((esp_gattc_cb_event_t)ev->cb_event, &ev->param.gattc);
+        break;
+    case EV_ADV:
+        handle_adv();
+        break;
+    case EV_SCAN_TIMEOUT: {
+        esp_ble_gap_cb_param_t param;
+        memset(&param, 0, sizeof(param));
+        param.scan_rst.search_evt = ESP_GAP_SEARCH_INQ_CMPL_EVT;
+        pthread_mutex_lock(&s_sim.lock);
+        s_sim.scanning = false;
+        pthread_mutex_unlock(&s_sim.lock);
+        deliver_gap(ESP_GAP_BLE_SCAN_RESULT_EVT, &param);
+        break;
+    }
+    case EV_CONNECT:
+        handle_connect();
+        break;
+    case EV_DISCONNECT:
+        handle_disconnect(ev);
+        break;
+    case EV_MTU_DONE:
+        handle_mtu_done();
+        break;
+    case EV_SEARCH_DONE:
+        handle_search_done();
+        break;
+    case EV_READ_DONE:
+        handle_read_done(ev);
+        break;
+    case EV_WRITE_DONE:
+        handle_write_done(ev, false);
+        break;
+    case EV_WRITE_DESCR_DONE:
+        handle_write_done(ev, true);
+        break;
+    case EV_NOTIFY:
+        handle_notify(ev);
+        break;
+    case EV_TX_DONE:
+        handle_tx_done(ev);
+        break;
+    case EV_CONN_UPDATE:
+        handle_conn_update(ev);
+        break;
+    case EV_DATA_LEN:
+        handle_data_len(ev);
+        break;
+    case EV_PHY_UPDATE:
+        handle_phy_update(ev);
+        break;
+    case EV_DROP:
+        pthread_mutex_lock(&s_sim.lock);
+        start_disconnect(now_us(), ev->param.gattc.disconnect.reason);
+        pthread_mutex_unlock(&s_sim.lock);
+        break;
+    }
+}
+
+/* Events of a connection that has gone, or of a scan that was stopped, are dropped */
+/* 已断开连接或已停止扫描的事件被丢弃 */
+static bool event_is_stale(const sim_event_t *ev) {
+    if (ev->gen == 0) {
+        return false;
+    }
+    if (ev->type == EV_SCAN_TIMEOUT) {
+        return ev->gen != s_sim.scan_gen;
+    }
+    return ev->gen != s_sim.link_gen || !s_sim.connected;
+}
+
+static void *btc_thread(void *arg) {
+    static sim_event_t ev;
+    pthread_mutex_lock(&s_sim.lock);
+    while (1) {
+        int next = -1;
+        for (int i = 0; i < s_sim.event_count; i++) {
+            if (next < 0 || s_sim.events[i].due_us < s_sim.events[next].due_us ||
+                (s_sim.events[i].due_us == s_sim.events[next].due_us && s_sim.events[i].order < s_sim.events[next].order)) {
+                next = i;
+            }
+        }
+        if (next < 0) {
+            pthread_cond_wait(&s_sim.cond, &s_sim.lock);
+            continue;
+        }
+        const int64_t due = s_sim.events[next].due_us;
+        if (due > now_us()) {
+            struct timespec ts = { .tv_sec = due / 1000000, .tv_nsec = (due % 1000000) * 1000 };
+            pthread_cond_timedwait(&s_sim.cond, &s_sim.lock, &ts);
+            continue;
+        }
+        ev = s_sim.events[next];
+        s_sim.events[next] = s_sim.events[--s_sim.event_count];
+        const bool stale = event_is_stale(&ev);
+        const sim_event_hook_t hook = s_sim.event_hook;
+        pthread_mutex_unlock(&s_sim.lock);
+        if (!stale) {
+            handle_event(&ev);
+            if (hook) {
+                hook();
+            }
+        }
+        pthread_mutex_lock(&s_sim.lock);
+    }
+    return NULL;
+}
+
+/* ---------- control ---------- */
+
+void sim_default_config(sim_config_t *config) {
+    memset(config, 0, sizeof(*config));
+    config->conn_interval_us = 30000;
+    config->adv_interval_us = 100000;
+    config->camera_mtu = 247;
+    config->first_handle = 1;
+    config->rssi = -55;
+    config->seed = 1;
+    config->tx_buffers = 10;
+    config->tx_pdus_per_event = 6;
+    config->max_tx_octets = 27;
+    config->camera_max_octets = 251;
+    config->camera_2m = true;
+}
+
+void sim_init(const sim_config_t *config) {
+    static const uint8_t camera_bda[ESP_BD_ADDR_LEN] = { 0x60, 0x60, 0x1F, 0x4A, 0x2B, 0x3C };
+    static const uint8_t adv[] = {
+        0x02, 0x01, 0x06,                                   // Flags
+        0x06, 0xFF, 0xAA, 0x08, 0x12, 0x34, 0xFA,           // DJI manufacturer data
+        0x0B, 0x09, 'O', 's', 'm', 'o', 'A', 'c', 't', 'i', 'o', 'n',
+    };
+
+    pthread_mutex_init(&s_sim.lock, NULL);
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&s_sim.cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    s_sim.config = *config;
+    s_sim.rng = config->seed ? config->seed : 1;
+    s_sim.local_mtu = SIM_DEFAULT_MTU;
+    s_sim.mtu = SIM_DEFAULT_MTU;
+    memcpy(s_sim.camera_bda, camera_bda, ESP_BD_ADDR_LEN);
+    memcpy(s_sim.adv, adv, sizeof(adv));
+    s_sim.adv_len = sizeof(adv);
+    s_sim.adv_enabled = true;
+    build_database(config->first_handle);
+
+    pthread_mutex_lock(&s_sim.lock);
+    schedule_adv(now_us());
+    pthread_mutex_unlock(&s_sim.lock);
+    pthread_create(&s_sim.thread, NULL, btc_thread, NULL);
+    pthread_detach(s_sim.thread);
+}
+
+void sim_camera_bda(esp_bd_addr_t out_bda) {
+    memcpy(out_bda, s_sim.camera_bda, ESP_BD_ADDR_LEN);
+}
+
+void sim_set_first_handle(uint16_t first_handle) {
+    pthread_mutex_lock(&s_sim.lock);
+    build_database(first_handle);
+    pthread_mutex_unlock(&s_sim.lock);
+}
+
+void sim_get_camera_handles(sim_camera_handles_t *out) {
+    pthread_mutex_lock(&s_sim.lock);
+    const sim_char_t *notify = find_char(0xFFF4);
+    const sim_char_t *write = find_char(0xFFF5);
+    out->service_start_handle = s_sim.services[s_sim.service_count - 1].start;
+    out->service_end_handle = s_sim.services[s_sim.service_count - 1].end;
+    out->notify_char_handle = notify->value;
+    out->notify_cccd_handle = notify->cccd;
+    out->write_char_handle = write->value;
+    pthread_mutex_unlock(&s_sim.lock);
+}
+
+void sim_get_stats(sim_stats_t *out) {
+    pthread_mutex_lock(&s_sim.lock);
+    *out = s_sim.stats;
+    out->scanning = s_sim.scanning;
+    pthread_mutex_unlock(&s_sim.lock);
+}
+
+void sim_drop_link(int reason) {
+    pthread_mutex_lock(&s_sim.lock);
+    if (s_sim.connected) {
+        start_disconnect(now_us(), reason);
+    }
+    pthread_mutex_unlock(&s_sim.lock);
+}
+
+void sim_drop_link_at_request(uint32_t request, int reason) {
+    pthread_mutex_lock(&s_sim.lock);
+    s_sim.drop_at_request = request;
+    s_sim.drop_reason = reason;
+    pthread_mutex_unlock(&s_sim.lock);
+}
+
+void sim_drop_link_at_write(int reason) {
+    pthread_mutex_lock(&s_sim.lock);
+    s_sim.drop_at_write = true;
+    s_sim.drop_reason = reason;
+    pthread_mutex_unlock(&s_sim.lock);
+}
+
+void sim_refuse_conn_updates(uint32_t count) {
+    pthread_mutex_lock(&s_sim.lock);
+    s_sim.refuse_updates = count;
+    pthread_mutex_unlock(&s_sim.lock);
+}
+
+void sim_cancel_drops(void) {
+    pthread_mutex_lock(&s_sim.lock);
+    s_sim.drop_at_request = 0;
+    s_sim.drop_at_write = false;
+    pthread_mutex_unlock(&s_sim.lock);
+}
+
+void sim_set_advertising(bool enabled) {
+    pthread_mutex_lock(&s_sim.lock);
+    s_sim.adv_enabled = enabled;
+    if (enabled && !s_sim.advertising && !s_sim.connected) {
+        schedule_adv(now_us());
+    }
+    pthread_mutex_unlock(&s_sim.lock);
+}
+
+void sim_set_write_handler(sim_write_handler_t handler) {
+    pthread_mutex_lock(&s_sim.lock);
+    s_sim.write_handler = handler;
+    pthread_mutex_unlock(&s_sim.lock);
+}
+
+void sim_set_event_hook(sim_event_hook_t hook) {
+    pthread_mutex_lock(&s_sim.lock);
+    s_sim.event_hook = hook;
+    pthread_mutex_unlock(&s_sim.lock);
+}
+
+void sim_notify(const uint8_t *value, uint16_t length) {
+    if (length > SIM_MAX_VALUE) {
+        return;
+    }
+    pthread_mutex_lock(&s_sim.lock);
+    const sim_char_t *notify = find_char(0xFFF4);
+    const sim_attr_t *cccd = notify ? find_attr(notify->cccd) : NULL;
+    if (s_sim.connected && cccd && (cccd->cccd & 1)) {
+        sim_event_t *ev = push_event(EV_NOTIFY, next_connection_event(now_us()), s_sim.link_gen);
+        ev->handle = notify->value;
+        ev->length = length;
+        memcpy(ev->data, value, length);
+    }
+    pthread_mutex_unlock(&s_sim.lock);
+}
+
+/* ---------- controller and Bluedroid ---------- */
+
+esp_err_t esp_bt_controller_mem_release(esp_bt_mode_t mode) {
+    return ESP_OK;
+}
+
+esp_err_t esp_bt_controller_init(esp_bt_controller_config_t *cfg) {
+    return ESP_OK;
+}
+
+esp_err_t esp_bt_controller_enable(esp_bt_mode_t mode) {
+    return ESP_OK;
+}
+
+esp_err_t esp_bluedroid_init(void) {
+    return ESP_OK;
+}
+
+esp_err_t esp_bluedroid_enable(void) {
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gatt_set_local_mtu(uint16_t mtu) {
+    pthread_mutex_lock(&s_sim.lock);
+    s_sim.local_mtu = mtu;
+    pthread_mutex_unlock(&s_sim.lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_read_mac(uint8_t *mac, esp_mac_type_t type) {
+    static const uint8_t local_mac[6] = { 0x40, 0x4C, 0xCA, 0x01, 0x02, 0x03 };
+    memcpy(mac, local_mac, sizeof(local_mac));
+    return ESP_OK;
+}
+
+uint32_t esp_random(void) {
+    pthread_mutex_lock(&s_sim.lock);
+    uint32_t value = next_random();
+    pthread_mutex_unlock(&s_sim.lock);
+    return value;
+}
+
+/* ---------- GAP ---------- */
+
+esp_err_t esp_ble_gap_register_callback(esp_gap_ble_cb_t callback) {
+    s_sim.gap_cb = callback;
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_set_scan_params(esp_ble_scan_params_t *scan_params) {
+    pthread_mutex_lock(&s_sim.lock);
+    s_sim.scan_duty_permille = scan_params->scan_interval ?
+        (uint32_t)scan_params->scan_window * 1000 / scan_params->scan_interval : 0;
+    push_gap(ESP_GAP_BLE_SCAN_PARAM_SET_COMPLETE_EVT, now_us());
+    pthread_mutex_unlock(&s_sim.lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_start_scanning(uint32_t duration) {
+    pthread_mutex_lock(&s_sim.lock);
+    const int64_t now = now_us();
+    s_sim.scanning = true;
+    s_sim.scan_gen++;
+    s_sim.stats.scans++;
+    push_gap(ESP_GAP_BLE_SCAN_START_COMPLETE_EVT, now);
+    if (duration) {
+        push_event(EV_SCAN_TIMEOUT, now + (int64_t)duration * 1000000, s_sim.scan_gen);
+    }
+    pthread_mutex_unlock(&s_sim.lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_stop_scanning(void) {
+    pthread_mutex_lock(&s_sim.lock);
+    // Stopping a scan that is not running completes with an error status, like the controller's Command Disallowed
+    // 停止未在运行的扫描会以错误状态完成，与控制器返回 Command Disallowed 相同
+    sim_event_t *ev = push_gap(ESP_GAP_BLE_SCAN_STOP_COMPLETE_EVT, now_us() + 1000);
+    ev->param.gap.scan_stop_cmpl.status = s_sim.scanning ? ESP_BT_STATUS_SUCCESS : ESP_BT_STATUS_FAIL;
+    s_sim.scanning = false;
+    s_sim.scan_gen++;
+    pthread_mutex_unlock(&s_sim.lock);
+    return ESP_OK;
+}
+
+/* Requests on a connection that does not exist fail right away, as Bluedroid has no link to queue them on */
+/* 在不存在的连接上发出的请求立即失败，因为 Bluedroid 没有可排队的链路 */
+static bool link_up_locked(void) {
+    return s_sim.connected;
+}
+
+/* Start an LL control procedure once the previous one is done; the first PDU waits for a camera listen event */
+/* 在上一个链路层控制过程结束后开始新过程；第一个 PDU 需等待相机的监听事件 */
+static int64_t start_ll_procedure(void) {
+    const int64_t t = s_sim.ll_free_us > now_us() ? s_sim.ll_free_us : now_us();
+    return next_listen_event(t + SIM_HOST_LATENCY_US);
+}
+
+/* LL_CONNECTION_UPDATE_IND with its instant latency + 6 events later; the controller takes the shortest interval allowed */
+/* LL_CONNECTION_UPDATE_IND，其生效时刻在 latency + 6 个事件之后；控制器取允许的最短间隔 */
+esp_err_t esp_ble_gap_update_conn_params(esp_ble_conn_update_params_t *params) {
+    pthread_mutex_lock(&s_sim.lock);
+    if (!link_up_locked()) {
+        pthread_mutex_unlock(&s_sim.lock);
+        return ESP_FAIL;
+    }
+    const bool valid = params->min_int >= 6 && params->min_int <= params->max_int && params->max_int <= 3200 &&
+                       params->latency <= 499 && params->timeout >= 10 && params->timeout <= 3200 &&
+                       params->timeout * 10000u > (1u + params->latency) * params->max_int * 1250u * 2;
+    const int64_t sent = start_ll_procedure();
+    int64_t instant = valid ? sent + (int64_t)(s_sim.latency + 6) * s_sim.conn_interval_us : now_us() + 1000;
+    // A refused update is answered with LL_REJECT_EXT_IND at the event after the camera heard it
+    // 被拒绝的更新在相机收到后的下一个事件以 LL_REJECT_EXT_IND 应答
+    const bool taken = valid && s_sim.refuse_updates == 0;
+    if (valid && !taken) {
+        s_sim.refuse_updates--;
+        instant = sent + s_sim.conn_interval_us;
+        s_sim.ll_free_us = instant;
+    } else if (valid) {
+        s_sim.ll_free_us = instant;
+        camera_awake(sent, instant);
+    }
+    sim_event_t *ev = push_event(EV_CONN_UPDATE, instant, s_sim.link_gen);
+    ev->param.gap.update_conn_params.status = taken ? ESP_BT_STATUS_SUCCESS : ESP_BT_STATUS_FAIL;
+    memcpy(ev->param.gap.update_conn_params.bda, s_sim.camera_bda, ESP_BD_ADDR_LEN);
+    ev->param.gap.update_conn_params.min_int = params->min_int;
+    ev->param.gap.update_conn_params.max_int = params->max_int;
+    ev->param.gap.update_conn_params.latency = taken ? params->latency : s_sim.latency;
+    ev->param.gap.update_conn_params.conn_int = taken ? params->min_int : (uint16_t)(s_sim.conn_interval_us / 1250);
+    ev->param.gap.update_conn_params.timeout = params->timeout;
+    pthread_mutex_unlock(&s_sim.lock);
+    return ESP_OK;
+}
+
+/* LL_LENGTH_REQ and LL_LENGTH_RSP, the new length is the smaller of both sides */
+/* LL_LENGTH_REQ 与 LL_LENGTH_RSP，新长度取双方中较小者 */
+esp_err_t esp_ble_gap_set_pkt_data_len(esp_bd_addr_t remote_device, uint16_t tx_data_length) {
+    pthread_mutex_lock(&s_sim.lock);
+    if (!link_up_locked() || tx_data_length < 27 || tx_data_length > 251) {
+        pthread_mutex_unlock(&s_sim.lock);
+        return ESP_FAIL;
+    }
+    const int64_t sent = start_ll_procedure();
+    const int64_t done = sent + s_sim.conn_interval_us;
+    s_sim.ll_free_us = done;
+    camera_awake(sent, done);
+    sim_event_t *ev = push_event(EV_DATA_LEN, done, s_sim.link_gen);
+    const uint16_t len = tx_data_length < s_sim.config.camera_max_octets ? tx_data_length : s_sim.config.camera_max_octets;
+    ev->param.gap.pkt_data_length_cmpl.status = ESP_BT_STATUS_SUCCESS;
+    ev->param.gap.pkt_data_length_cmpl.params.tx_len = len;
+    ev->param.gap.pkt_data_length_cmpl.params.rx_len = len;
+    pthread_mutex_unlock(&s_sim.lock);
+    return ESP_OK;
+}
+
+/* LL_PHY_REQ, LL_PHY_RSP and LL_PHY_UPDATE_IND with its instant latency + 6 events later */
+/* LL_PHY_REQ、LL_PHY_RSP 与 LL_PHY_UPDATE_IND，其生效时刻在 latency + 6 个事件之后 */
+esp_err_t esp_ble_gap_set_preferred_phy(esp_bd_addr_t bd_addr, esp_ble_gap_all_phys_t all_phys_mask,
+                                        esp_ble_gap_phy_mask_t tx_phy_mask, esp_ble_gap_phy_mask_t rx_phy_mask,
+                                        esp_ble_gap_prefer_phy_options_t phy_options) {
+    pthread_mutex_lock(&s_sim.lock);
+    if (!link_up_locked()) {
+        pthread_mutex_unlock(&s_sim.lock);
+        return ESP_FAIL;
+    }
+    sim_event_t *ev = push_gap(ESP_GAP_BLE_SET_PREFERRED_PHY_COMPLETE_EVT, now_us() + 1000);
+    ev->param.gap.set_perf_phy.status = ESP_BT_STATUS_SUCCESS;
+
+    const bool use_2m = s_sim.config.camera_2m && (tx_phy_mask & ESP_BLE_GAP_PHY_2M_PREF_MASK) &&
+                        (rx_phy_mask & ESP_BLE_GAP_PHY_2M_PREF_MASK);
+    const int64_t sent = start_ll_procedure();
+    const int64_t instant = sent + (int64_t)(s_sim.latency + 7) * s_sim.conn_interval_us;
+    s_sim.ll_free_us = instant;
+    camera_awake(sent, instant);
+    ev = push_event(EV_PHY_UPDATE, instant, s_sim.link_gen);
+    ev->param.gap.phy_update.status = ESP_BT_STATUS_SUCCESS;
+    memcpy(ev->param.gap.phy_update.bda, s_sim.camera_bda, ESP_BD_ADDR_LEN);
+    ev->param.gap.phy_update.tx_phy = use_2m ? ESP_BLE_GAP_PHY_2M : ESP_BLE_GAP_PHY_1M;
+    ev->param.gap.phy_update.rx_phy = ev->param.gap.phy_update.tx_phy;
+    pthread_mutex_unlock(&s_sim.lock);
+    return ESP_OK;
+}
+
+uint8_t *esp_ble_resolve_adv_data_by_type(uint8_t *adv_data, uint16_t adv_data_len, esp_ble_adv_data_type type,
+                                          uint8_t *length) {
+    *length = 0;
+    for (uint16_t i = 0; i + 1 < adv_data_len && adv_data[i] != 0; i += (uint16_t)(adv_data[i] + 1)) {
+        if (i + 1 + adv_data[i] > adv_data_len) {
+            break;
+        }
+        if (adv_data[i + 1] == type) {
+            *length = (uint8_t)(adv_data[i] - 1);
+            return &adv_data[i + 2];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t esp_ble_gap_config_adv_data_raw(uint8_t *raw_data, uint32_t raw_data_len) {
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_start_advertising(esp_ble_adv_params_t *adv_params) {
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_stop_advertising(void) {
+    return ESP_OK;
+}
+
+/* ---------- GATT client ---------- */
+
+esp_err_t esp_ble_gattc_register_callback(esp_gattc_cb_t callback) {
+    s_sim.gattc_cb = callback;
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gattc_app_register(uint16_t app_id) {
+    pthread_mutex_lock(&s_sim.lock);
+    sim_event_t *ev = push_gattc(ESP_GATTC_REG_EVT, now_us(), 0);
+    ev->param.gattc.reg.status = ESP_GATT_OK;
+    ev->param.gattc.reg.app_id = app_id;
+    pthread_mutex_unlock(&s_sim.lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gattc_open(esp_gatt_if_t gattc_if, esp_bd_addr_t remote_bda, esp_ble_addr_type_t remote_addr_type,
+                             bool is_direct) {
+    pthread_mutex_lock(&s_sim.lock);
+    if (s_sim.connected || s_sim.opening) {
+        sim_event_t *ev = push_gattc(ESP_GATTC_OPEN_EVT, now_us(), 0);
+        ev->param.gattc.open.status = ESP_GATT_ERROR;
+        memcpy(ev->param.gattc.open.remote_bda, remote_bda, ESP_BD_ADDR_LEN);
+    } else {
+        s_sim.opening = true;
+        memcpy(s_sim.open_bda, remote_bda, ESP_BD_ADDR_LEN);
+    }
+    pthread_mutex_unlock(&s_sim.lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gattc_close(esp_gatt_if_t gattc_if, uint16_t conn_id) {
+    pthread_mutex_lock(&s_sim.lock);
+    if (s_sim.connected) {
+        start_disconnect(next_listen_event(now_us() + SIM_HOST_LATENCY_US) + s_sim.conn_interval_us,
+                         REASON_LOCAL_HOST_TERMINATED);
+    } else {
+        s_sim.opening = false;
+    }
+    pthread_mutex_unlock(&s_sim.lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gattc_send_mtu_req(esp_gatt_if_t gattc_if, uint16_t conn_id) {
+    pthread_mutex_lock(&s_sim.lock);
+    esp_err_t ret = ESP_FAIL;
+    if (link_up_locked()) {
+        push_event(EV_MTU_DONE, schedule_att(1), s_sim.link_gen);
+        ret = ESP_OK;
+    }
+    pthread_mutex_unlock(&s_sim.lock);
+    return ret;
+}
+
+esp_err_t esp_ble_gattc_search_service(esp_gatt_if_t gattc_if, uint16_t conn_id, esp_bt_uuid_t *filter_uuid) {
+    pthread_mutex_lock(&s_sim.lock);
+    esp_err_t ret = ESP_FAIL;
+    if (link_up_locked()) {
+        s_sim.stats.discoveries++;
+        push_event(EV_SEARCH_DONE, schedule_att(discovery_requests(s_sim.mtu)), s_sim.link_gen);
+        ret = ESP_OK;
+    }
+    pthread_mutex_unlock(&s_sim.lock);
+    return ret;
+}
+
+esp_gatt_status_t esp_ble_gattc_get_char_by_uuid(esp_gatt_if_t gattc_if, uint16_t conn_id, uint16_t start_handle,
+                                                 uint16_t end_handle, esp_bt_uuid_t char_uuid,
+                                                 esp_gattc_char_elem_t *result, uint16_t *count) {
+    pthread_mutex_lock(&s_sim.lock);
+    uint16_t found = 0;
+    if (s_sim.cache_ready) {
+        for (int i = 0; i < s_sim.char_count && found < *count; i++) {
+            const sim_char_t *ch = &s_sim.chars[i];
+            if (ch->decl >= start_handle && ch->decl <= end_handle && ch->uuid == char_uuid.uuid.uuid16) {
+                result[found].char_handle = ch->value;
+                result[found].properties = ch->props;
+                result[found].uuid = char_uuid;
+                found++;
+            }
+        }
+    }
+    pthread_mutex_unlock(&s_sim.lock);
+    *count = found;
+    return found ? ESP_GATT_OK : ESP_GATT_NOT_FOUND;
+}
+
+esp_gatt_status_t esp_ble_gattc_get_descr_by_char_handle(esp_gatt_if_t gattc_if, uint16_t conn_id,
+                                                         uint16_t char_handle, esp_bt_uuid_t descr_uuid,
+                                                         esp_gattc_descr_elem_t *result, uint16_t *count) {
+    pthread_mutex_lock(&s_sim.lock);
+    uint16_t found = 0;
+    if (s_sim.cache_ready && *count > 0 && descr_uuid.uuid.uuid16 == ESP_GATT_UUID_CHAR_CLIENT_CONFIG) {
+        for (int i = 0; i < s_sim.char_count; i++) {
+            if (s_sim.chars[i].value == char_handle && s_sim.chars[i].cccd) {
+                result[0].handle = s_sim.chars[i].cccd;
+                result[0].uuid = descr_uuid;
+                found = 1;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&s_sim.lock);
+    *count = found;
+    return found ? ESP_GATT_OK : ESP_GATT_NOT_FOUND;
+}
+
+esp_err_t esp_ble_gattc_read_char(esp_gatt_if_t gattc_if, uint16_t conn_id, uint16_t handle,
+                                  esp_gatt_auth_req_t auth_req) {
+    pthread_mutex_lock(&s_sim.lock);
+    esp_err_t ret = ESP_FAIL;
+    if (link_up_locked()) {
+        sim_event_t *ev = push_event(EV_READ_DONE, schedule_att(1), s_sim.link_gen);
+        ev->handle = handle;
+        ret = ESP_OK;
+    }
+    pthread_mutex_unlock(&s_sim.lock);
+    return ret;
+}
+
+static esp_err_t queue_write(sim_event_type_t type, uint16_t handle, uint16_t value_len, const uint8_t *value,
+                             esp_gatt_write_type_t write_type) {
+    if (value_len > SIM_MAX_VALUE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    bool deliver = false;
+    pthread_mutex_lock(&s_sim.lock);
+    esp_err_t ret = ESP_FAIL;
+    if (link_up_locked()) {
+        if (write_type == ESP_GATT_WRITE_TYPE_RSP) {
+            sim_event_t *ev = push_event(type, schedule_att(1), s_sim.link_gen);
+            ev->handle = handle;
+            ev->length = value_len;
+            memcpy(ev->data, value, value_len);
+        } else if (type == EV_WRITE_DONE) {
+            // Bluedroid refuses a Write Without Response on a congested channel
+            // Bluedroid 在拥塞的通道上拒绝 Write Without Response
+            if (s_sim.tx_congested) {
+                s_sim.stats.tx_rejected++;
+                pthread_mutex_unlock(&s_sim.lock);
+                return ESP_FAIL;
+            }
+            sim_event_t *ev = push_event(EV_TX_DONE, schedule_tx(value_len), s_sim.link_gen);
+            ev->handle = handle;
+            ev->length = value_len;
+            memcpy(ev->data, value, value_len);
+            s_sim.stats.tx_writes++;
+            if (--s_sim.tx_free == 0) {
+                s_sim.tx_congested = true;
+                s_sim.stats.congestions++;
+                push_congest(true);
+            }
+            // The write is accepted, then lost with the link
+            // 写入被接受，随后随链路一起丢失
+            if (s_sim.drop_at_write) {
+                s_sim.drop_at_write = false;
+                start_disconnect(now_us(), s_sim.drop_reason);
+            }
+        } else {
+            deliver = write_attr(handle, value, value_len, type == EV_WRITE_DESCR_DONE) == ESP_GATT_OK &&
+                      type == EV_WRITE_DONE;
+        }
+        ret = ESP_OK;
+    }
+    pthread_mutex_unlock(&s_sim.lock);
+    if (deliver) {
+        camera_receive(handle, value, value_len);
+    }
+    return ret;
+}
+
+uint16_t esp_ble_get_cur_sendable_packets_num(uint16_t connid) {
+    pthread_mutex_lock(&s_sim.lock);
+    const uint16_t free = link_up_locked() && !s_sim.tx_congested ? s_sim.tx_free : 0;
+    pthread_mutex_unlock(&s_sim.lock);
+    return free;
+}
+
+esp_err_t esp_ble_gattc_write_char(esp_gatt_if_t gattc_if, uint16_t conn_id, uint16_t handle, uint16_t value_len,
+                                   uint8_t *value, esp_gatt_write_type_t write_type, esp_gatt_auth_req_t auth_req) {
+    return queue_write(EV_WRITE_DONE, handle, value_len, value, write_type);
+}
+
+esp_err_t esp_ble_gattc_write_char_descr(esp_gatt_if_t gattc_if, uint16_t conn_id, uint16_t handle,
+                                         uint16_t value_len, uint8_t *value, esp_gatt_write_type_t write_type,
+                                         esp_gatt_auth_req_t auth_req) {
+    return queue_write(EV_WRITE_DESCR_DONE, handle, value_len, value, write_type);
+}
+
+esp_err_t esp_ble_gattc_register_for_notify(esp_gatt_if_t gattc_if, esp_bd_addr_t server_bda, uint16_t handle) {
+    pthread_mutex_lock(&s_sim.lock);
+    sim_event_t *ev = push_gattc(ESP_GATTC_REG_FOR_NOTIFY_EVT, now_us(), 0);
+    ev->param.gattc.reg_for_notify.status = ESP_GATT_OK;
+    ev->param.gattc.reg_for_notify.handle = handle;
+    pthread_mutex_unlock(&s_sim.lock);
+    return ESP_OK;
+}
@@ -0,0 +1,168 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Simulated Bluedroid stack and camera for the BLE link host tests.
+ * BLE 链路主机测试使用的模拟 Bluedroid 协议栈与相机。
+ *
+ * Implements the esp_ble_gap_* and esp_ble_gattc_* functions ble.c calls, and delivers their events to
+ * the registered GAP and GATTC callbacks from one thread, the way the Bluedroid BTC task does. The camera
+ * advertises, accepts one connection and serves a GATT database whose handles start at a configurable
+ * first handle, so a firmware update that moves the handles can be simulated.
+ * 实现 ble.c 调用的 esp_ble_gap_* 与 esp_ble_gattc_* 函数，并像 Bluedroid BTC 任务一样在单一线程中将事件交给
+ * 已注册的 GAP 与 GATTC 回调。相机会广播、接受一个连接，并提供起始句柄可配置的 GATT 数据库，
+ * 从而可以模拟固件升级导致句柄移动的情况。
+ *
+ * Timing model / 时序模型:
+ * - The camera advertises every adv_interval_us plus 0-10 ms of random delay. While scanning, each
+ *   advertisement is received with probability scan_window / scan_interval.
+ *   相机每隔 adv_interval_us 加 0-10 ms 随机延迟广播一次；扫描时每次广播以 scan_window / scan_interval 的概率被收到。
+ * - esp_ble_gattc_open connects on the next advertisement of the target. Connection events then
+ *   follow every conn_interval_us.
+ *   esp_ble_gattc_open 在目标的下一次广播时建立连接，此后每隔 conn_interval_us 一个连接事件。
+ * - One ATT request is outstanding at a time. A request goes out in the first connection event at
+ *   least 0.5 ms after it was issued, and its response arrives one interval later, so chained requests
+ *   cost two intervals each.
+ *   同一时间只有一个 ATT 请求在途。请求在发出后至少 0.5 ms 的第一个连接事件中发送，响应在一个间隔后到达，
+ *   因此连续的请求每个需要两个间隔。
+ * - Connection parameter, data length and PHY updates run one LL procedure at a time. A connection or
+ *   PHY update takes effect latency + 6 connection events after it was sent. With peripheral latency the
+ *   camera only listens every latency + 1 events, so requests and writes to it wait for such an event.
+ *   连接参数、数据长度与 PHY 更新一次只运行一个链路层过程。连接参数或 PHY 更新在发出后 latency + 6 个连接事件生效。
+ *   存在外设延迟时相机每 latency + 1 个事件才监听一次，发往相机的请求与写入需等待这样的事件。
+ * - A Write Without Response takes one of tx_buffers controller buffers and is split into LL PDUs of
+ *   the current data length; each connection event has the air time of tx_pdus_per_event PDUs of 27
+ *   octets on the 1M PHY, and the buffer is free again in the event that carries the last PDU, which is
+ *   reported with ESP_GATTC_WRITE_CHAR_EVT. With no buffer left the link is congested: writes fail
+ *   with ESP_FAIL until half of the buffers are free, and both edges are reported with ESP_GATTC_CONGEST_EVT.
+ *   Write Without Response 占用 tx_buffers 个控制器缓冲区中的一个，并按当前数据长度拆分为链路层 PDU；
+ *   每个连接事件的空中时间相当于 1M PHY 上 tx_pdus_per_event 个 27 字节 PDU，承载最后一个 PDU 的事件中缓冲区被释放，
+ *   并以 ESP_GATTC_WRITE_CHAR_EVT 上报。缓冲区耗尽时链路拥塞：
+ *   在一半缓冲区空闲前写入以 ESP_FAIL 失败，拥塞的开始与结束均以 ESP_GATTC_CONGEST_EVT 上报。
+ * - esp_ble_gattc_search_service runs the discovery Bluedroid runs without a GATT cache: primary
+ *   services, then the included services, characteristics and descriptors of each service. The
+ *   results are reported once the whole database is known. The get_*_by_* lookups only answer after
+ *   such a discovery on the current connection.
+ *   esp_ble_gattc_search_service 执行 Bluedroid 在没有 GATT 缓存时的发现流程：先发现主服务，再逐个服务发现其包含服务、
+ *   特征与描述符，整个数据库都已知后才上报结果。get_*_by_* 查询只有在当前连接完成这样的发现后才会返回结果。
+ */
+
+#ifndef SIM_BLUEDROID_H
+#define SIM_BLUEDROID_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "esp_bt_defs.h"
+
+typedef struct {
+    uint32_t conn_interval_us;      // Connection interval / 连接间隔
+    uint32_t adv_interval_us;       // Camera advertising interval / 相机广播间隔
+    uint16_t camera_mtu;            // ATT MTU the camera accepts / 相机接受的 ATT MTU
+    uint16_t first_handle;          // Handle of the camera's first attribute / 相机第一个属性的句柄
+    int8_t rssi;                    // RSSI of the camera's advertisements / 相机广播的 RSSI
+    uint32_t seed;                  // Seed for the advertising and reception jitter / 广播与接收抖动的随机种子
+    uint16_t tx_buffers;            // Controller buffers for Write Without Response / Write Without Response 可用的控制器缓冲区数
+    uint16_t tx_pdus_per_event;     // LL data PDUs sent per connection event / 每个连接事件发送的链路层数据 PDU 数
+    uint16_t max_tx_octets;         // LL payload per PDU until a data length exchange / 数据长度交换前每个 PDU 的链路层载荷
+    uint16_t camera_max_octets;     // Longest LL payload the camera accepts / 相机接受的最大链路层载荷
+    bool camera_2m;                 // The camera supports the 2M PHY / 相机支持 2M PHY
+} sim_config_t;
+
+/* Handles of the camera's vendor service in the current layout */
+/* 当前布局下相机厂商服务的句柄 */
+typedef struct {
+    uint16_t service_start_handle;
+    uint16_t service_end_handle;
+    uint16_t notify_char_handle;
+    uint16_t notify_cccd_handle;
+    uint16_t write_char_handle;
+} sim_camera_handles_t;
+
+typedef struct {
+    uint32_t att_requests;          // ATT requests on the current or last connection / 当前或上一次连接的 ATT 请求数
+    uint32_t discoveries;           // Full discoveries run / 完整发现的次数
+    uint32_t connections;           // Connections established / 已建立的连接数
+    int64_t connected_us;           // When the current or last connection was established / 当前或上一次连接建立的时刻
+    int64_t notify_enabled_us;      // When the camera's notify CCCD was last enabled, 0 if it is off / 相机 notify CCCD 最近一次被使能的时刻，关闭时为 0
+    uint32_t scans;                 // Scans started / 已开始的扫描次数
+    int64_t max_callback_us;        // Longest time a GAP or GATTC callback ran / GAP 或 GATTC 回调的最长运行时间
+    uint32_t tx_writes;             // Writes Without Response accepted / 已接受的 Write Without Response 数
+    uint32_t tx_rejected;           // Writes Without Response refused while congested / 拥塞时被拒绝的 Write Without Response 数
+    uint32_t congestions;           // Times the link became congested / 链路进入拥塞的次数
+    uint32_t conn_updates;          // Connection parameter updates applied / 已生效的连接参数更新数
+    bool scanning;                  // A scan is running / 扫描正在进行
+} sim_stats_t;
+
+/* Called with every value the central writes to the camera's write characteristic (0xFFF5) */
+/* 中心设备每次写入相机写特征（0xFFF5）时调用，参数为写入的值 */
+typedef void (*sim_write_handler_t)(const uint8_t *value, uint16_t length);
+
+/* Called on the simulated BTC thread after each event, so a test can wait for a condition instead of polling */
+/* 每个事件处理完后在模拟 BTC 线程中调用，使测试可以等待条件成立而非轮询 */
+typedef void (*sim_event_hook_t)(void);
+
+void sim_init(const sim_config_t *config);
+
+void sim_default_config(sim_config_t *config);
+
+void sim_camera_bda(esp_bd_addr_t out_bda);
+
+/* Rebuild the camera's database from a new first handle; only while disconnected */
+/* 以新的起始句柄重建相机的数据库，仅在未连接时调用 */
+void sim_set_first_handle(uint16_t first_handle);
+
+void sim_get_camera_handles(sim_camera_handles_t *out);
+
+void sim_get_stats(sim_stats_t *out);
+
+/* Drop the connection from the camera side, e.g. a supervision timeout (reason 0x08) */
+/* 从相机一侧断开连接，例如监督超时（reason 0x08） */
+void sim_drop_link(int reason);
+
+/* Drop the link when the request-th ATT request of the current or next connection goes out */
+/* 当前或下一个连接的第 request 个 ATT 请求发出时断开链路 */
+void sim_drop_link_at_request(uint32_t request, int reason);
+
+/* Drop the link right after the next Write Without Response is accepted, from the writer's own call */
+/* 在下一个 Write Without Response 被接受后立即断开链路，断链发生在写入者自身的调用中 */
+void sim_drop_link_at_write(int reason);
+
+/* Disarm the drops set up by sim_drop_link_at_request and sim_drop_link_at_write */
+/* 取消由 sim_drop_link_at_request 与 sim_drop_link_at_write 设置的断链 */
+void sim_cancel_drops(void);
+
+/* Refuse the next count connection updates, as a camera does when one collides with an update it started */
+/* 拒绝接下来的 count 次连接参数更新，如同更新与相机自身发起的更新冲突时相机的做法 */
+void sim_refuse_conn_updates(uint32_t count);
+
+/* Stop or resume the camera's advertising, e.g. to simulate a camera that is out of range */
+/* 停止或恢复相机广播，例如模拟相机超出范围 */
+void sim_set_advertising(bool enabled);
+
+void sim_set_write_handler(sim_write_handler_t handler);
+
+void sim_set_event_hook(sim_event_hook_t hook);
+
+/* Send a notification on the write/notify service at the next connection event, if notifications are enabled */
+/* 若通知已使能，在下一个连接事件发送一条通知 */
+void sim_notify(const uint8_t *value, uint16_t length);
+
+#endif
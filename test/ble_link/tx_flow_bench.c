@@ -0,0 +1,344 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Write Without Response flow control benchmark of ble.c against the simulated Bluedroid stack.
+ * ble.c 的 Write Without Response 流量控制在模拟 Bluedroid 协议栈上的基准。
+ *
+ * Sends mixed traffic to the simulated camera in two modes:
+ * 以两种模式向模拟相机发送混合流量：
+ * - direct: every frame goes straight to esp_ble_gattc_write_char, as ble_write_without_response
+ *           did before the TX queue; a write refused by the congested stack is lost
+ *           每帧直接交给 esp_ble_gattc_write_char，与引入发送队列前的 ble_write_without_response 相同；
+ *           被拥塞的协议栈拒绝的写入即丢失
+ * - queued: every frame goes through ble_write_without_response_prio
+ *           每帧经由 ble_write_without_response_prio 发送
+ *
+ * Traffic is 70 byte frames, the size of a GPS push, of three priorities: control (commands and
+ * acks), stream (GPS) and bulk (start_ble_packet_test). The queued mode must deliver every control
+ * and stream frame wherever the link can carry them, keep control frames within a few connection
+ * intervals even under overload, and deliver at least as much as the direct mode.
+ * 流量为 70 字节的帧（即 GPS 推送的大小），分为三个优先级：控制（命令与应答）、流（GPS）与批量
+ * （start_ble_packet_test）。队列模式须在链路承载得下时送达所有控制帧与流帧，即使过载也要使控制帧
+ * 在数个连接间隔内送达，且送达量不少于直接模式。
+ *
+ * Usage / 用法: tx_flow_bench [seconds] [conn_interval_ms]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+#include "ble.h"
+#include "data.h"
+#include "connect_logic.h"
+#include "product_nvs.h"
+#include "sim_bluedroid.h"
+
+#define DEFAULT_SECONDS     3
+#define READY_TIMEOUT_MS    5000
+#define DRAIN_TIMEOUT_MS    3000
+#define FRAME_LENGTH        70
+#define CONTROL_MAX_LATENCY_INTERVALS 6    // Bound on control frame latency under overload, in connection intervals
+                                            // 过载时控制帧时延的上限，单位为连接间隔
+
+typedef enum {
+    MODE_DIRECT = 0,
+    MODE_QUEUED,
+    MODE_COUNT,
+} bench_mode_t;
+
+static const char *const s_mode_names[MODE_COUNT] = { "direct", "queued" };
+static const char *const s_prio_names[BLE_TX_PRIO_COUNT] = { "control", "stream", "bulk" };
+
+/* Frames per second of each priority, a burst sends burst_frames stream frames at once every burst_ms */
+/* 每个优先级每秒的帧数；突发每隔 burst_ms 一次性发送 burst_frames 个流帧 */
+typedef struct {
+    const char *name;
+    int hz[BLE_TX_PRIO_COUNT];
+    int burst_frames;
+    int burst_ms;
+} scenario_t;
+
+static const scenario_t s_scenarios[] = {
+    { "gps 10 Hz",   { 2, 10,   0 },  0,   0 },
+    { "gps 50 Hz",   { 2, 50,   0 },  0,   0 },
+    { "burst",       { 5,  0,   0 }, 12, 250 },
+    { "overload",    { 5, 10, 100 },  0,   0 },
+};
+
+#define SCENARIO_COUNT (sizeof(s_scenarios) / sizeof(s_scenarios[0]))
+
+typedef struct {
+    uint32_t offered[BLE_TX_PRIO_COUNT];
+    uint32_t refused[BLE_TX_PRIO_COUNT];    // The write call failed / 写入调用失败
+    uint32_t delivered[BLE_TX_PRIO_COUNT];
+    int64_t latency_sum_us[BLE_TX_PRIO_COUNT];
+    int64_t latency_max_us[BLE_TX_PRIO_COUNT];
+    double seconds;
+    tx_queue_stats_t tx;
+    sim_stats_t sim;
+} run_result_t;
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static run_result_t *s_current;
+
+static bool wait_ms(bool (*done)(void), int timeout_ms) {
+    for (int i = 0; i < timeout_ms; i++) {
+        if (done()) {
+            return true;
+        }
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    return done();
+}
+
+static bool link_ready(void) {
+    ble_link_timing_t timing;
+    ble_get_link_timing(&timing);
+    return timing.ready_us != 0;
+}
+
+static bool gattc_registered(void) {
+    return s_ble_profile.gattc_if != ESP_GATT_IF_NONE;
+}
+
+static bool tx_idle(void) {
+    tx_queue_stats_t tx;
+    sim_stats_t before, after;
+    ble_get_tx_stats(&tx);
+    sim_get_stats(&before);
+    vTaskDelay(pdMS_TO_TICKS(100));
+    sim_get_stats(&after);
+    return tx.depth == 0 && before.tx_writes == after.tx_writes;
+}
+
+/* The camera side: frames carry their priority and the time they were offered */
+/* 相机一侧：帧中携带其优先级与提交时刻 */
+static void camera_write_handler(const uint8_t *value, uint16_t length) {
+    if (length != FRAME_LENGTH || value[0] >= BLE_TX_PRIO_COUNT) {
+        return;
+    }
+    int64_t offered_us;
+    memcpy(&offered_us, &value[1], sizeof(offered_us));
+    const int64_t latency = esp_timer_get_time() - offered_us;
+    pthread_mutex_lock(&s_lock);
+    if (s_current) {
+        s_current->delivered[value[0]]++;
+        s_current->latency_sum_us[value[0]] += latency;
+        if (latency > s_current->latency_max_us[value[0]]) {
+            s_current->latency_max_us[value[0]] = latency;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+}
+
+static void send_frame(bench_mode_t mode, ble_tx_prio_t prio, run_result_t *result) {
+    uint8_t frame[FRAME_LENGTH];
+    memset(frame, 0x5A, sizeof(frame));
+    frame[0] = (uint8_t)prio;
+    const int64_t now = esp_timer_get_time();
+    memcpy(&frame[1], &now, sizeof(now));
+
+    esp_err_t ret;
+    if (mode == MODE_DIRECT) {
+        ret = esp_ble_gattc_write_char(s_ble_profile.gattc_if, s_ble_profile.conn_id, s_ble_profile.write_char_handle,
+                                       sizeof(frame), frame, ESP_GATT_WRITE_TYPE_NO_RSP, ESP_GATT_AUTH_REQ_NONE);
+    } else {
+        ret = ble_write_without_response_prio(s_ble_profile.conn_id, s_ble_profile.write_char_handle,
+                                              frame, sizeof(frame), prio);
+    }
+    pthread_mutex_lock(&s_lock);
+    result->offered[prio]++;
+    if (ret != ESP_OK) {
+        result->refused[prio]++;
+    }
+    pthread_mutex_unlock(&s_lock);
+}
+
+static void run(bench_mode_t mode, const scenario_t *scenario, int seconds, run_result_t *result) {
+    int64_t next_us[BLE_TX_PRIO_COUNT];
+    int64_t next_burst_us;
+    sim_stats_t before;
+
+    memset(result, 0, sizeof(*result));
+    ble_reset_tx_stats();
+    sim_get_stats(&before);
+    pthread_mutex_lock(&s_lock);
+    s_current = result;
+    pthread_mutex_unlock(&s_lock);
+
+    const int64_t start = esp_timer_get_time();
+    const int64_t end = start + (int64_t)seconds * 1000000;
+    for (int prio = 0; prio < BLE_TX_PRIO_COUNT; prio++) {
+        // Stagger the first frames so the priorities do not line up
+        // 错开各优先级的第一帧，避免对齐
+        next_us[prio] = start + prio * 1700;
+    }
+    next_burst_us = start;
+
+    while (1) {
+        const int64_t now = esp_timer_get_time();
+        if (now >= end) {
+            break;
+        }
+        for (int prio = 0; prio < BLE_TX_PRIO_COUNT; prio++) {
+            if (scenario->hz[prio] && now >= next_us[prio]) {
+                send_frame(mode, (ble_tx_prio_t)prio, result);
+                next_us[prio] += 1000000 / scenario->hz[prio];
+            }
+        }
+        if (scenario->burst_frames && now >= next_burst_us) {
+            for (int i = 0; i < scenario->burst_frames; i++) {
+                send_frame(mode, BLE_TX_PRIO_STREAM, result);
+            }
+            next_burst_us += (int64_t)scenario->burst_ms * 1000;
+        }
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    result->seconds = (esp_timer_get_time() - start) / 1e6;
+
+    wait_ms(tx_idle, DRAIN_TIMEOUT_MS);
+    pthread_mutex_lock(&s_lock);
+    s_current = NULL;
+    pthread_mutex_unlock(&s_lock);
+
+    ble_get_tx_stats(&result->tx);
+    sim_get_stats(&result->sim);
+    result->sim.tx_writes -= before.tx_writes;
+    result->sim.tx_rejected -= before.tx_rejected;
+    result->sim.congestions -= before.congestions;
+}
+
+static uint32_t total(const uint32_t counts[BLE_TX_PRIO_COUNT]) {
+    uint32_t sum = 0;
+    for (int prio = 0; prio < BLE_TX_PRIO_COUNT; prio++) {
+        sum += counts[prio];
+    }
+    return sum;
+}
+
+/* Frames per second the link carries, from the simulator's PDUs per connection event */
+/* 链路每秒可承载的帧数，由模拟器每个连接事件的 PDU 数算出 */
+static double link_capacity_hz(const sim_config_t *config) {
+    const int pdus_per_frame = (FRAME_LENGTH + 3 + 4 + config->max_tx_octets - 1) / config->max_tx_octets;
+    return (double)(config->tx_pdus_per_event / pdus_per_frame) * 1e6 / config->conn_interval_us;
+}
+
+static double offered_hz(const scenario_t *scenario, ble_tx_prio_t lowest) {
+    double hz = scenario->burst_frames && lowest >= BLE_TX_PRIO_STREAM ?
+                scenario->burst_frames * 1000.0 / scenario->burst_ms : 0;
+    for (int prio = 0; prio <= (int)lowest; prio++) {
+        hz += scenario->hz[prio];
+    }
+    return hz;
+}
+
+static int check(const scenario_t *scenario, const run_result_t *direct, const run_result_t *queued,
+                 const sim_config_t *config) {
+    int failures = 0;
+    const double capacity = link_capacity_hz(config);
+
+    if (total(queued->delivered) < total(direct->delivered)) {
+        printf("  %s: queued mode delivered %u frames, direct mode %u\n", scenario->name,
+               (unsigned)total(queued->delivered), (unsigned)total(direct->delivered));
+        failures++;
+    }
+    for (int prio = 0; prio < BLE_TX_PRIO_COUNT; prio++) {
+        // Every frame of a priority must arrive if it and the priorities above it fit with a margin
+        // 若某优先级及其以上优先级的负载留有余量地放得下，则该优先级的每一帧都必须送达
+        const bool must_deliver = offered_hz(scenario, (ble_tx_prio_t)prio) <= 0.8 * capacity;
+        if (must_deliver && queued->delivered[prio] != queued->offered[prio]) {
+            printf("  %s: %s frames delivered %u of %u\n", scenario->name, s_prio_names[prio],
+                   (unsigned)queued->delivered[prio], (unsigned)queued->offered[prio]);
+            failures++;
+        }
+    }
+    const int64_t bound = (int64_t)CONTROL_MAX_LATENCY_INTERVALS * config->conn_interval_us;
+    if (queued->latency_max_us[BLE_TX_PRIO_CONTROL] > bound) {
+        printf("  %s: control frame took %.1f ms, bound %.1f ms\n", scenario->name,
+               queued->latency_max_us[BLE_TX_PRIO_CONTROL] / 1000.0, bound / 1000.0);
+        failures++;
+    }
+    if (queued->sim.tx_rejected != 0) {
+        printf("  %s: queued mode wrote %u frames into a congested stack\n", scenario->name,
+               (unsigned)queued->sim.tx_rejected);
+        failures++;
+    }
+    return failures;
+}
+
+int main(int argc, char **argv) {
+    int seconds = argc > 1 ? atoi(argv[1]) : DEFAULT_SECONDS;
+    sim_config_t config;
+
+    sim_default_config(&config);
+    if (argc > 2) {
+        config.conn_interval_us = (uint32_t)(atof(argv[2]) * 1000);
+    }
+    if (seconds <= 0 || config.conn_interval_us == 0) {
+        fprintf(stderr, "usage: %s [seconds] [conn_interval_ms]\n", argv[0]);
+        return 2;
+    }
+
+    sim_init(&config);
+    sim_set_write_handler(camera_write_handler);
+    data_init();
+    product_nvs_init();
+    if (connect_logic_ble_init() != 0 || !wait_ms(gattc_registered, READY_TIMEOUT_MS)) {
+        printf("FAIL: BLE init\n");
+        return 1;
+    }
+    sim_camera_bda(s_ble_profile.remote_bda);
+    if (connect_logic_ble_connect(true) != 0 || !wait_ms(link_ready, READY_TIMEOUT_MS)) {
+        printf("FAIL: connection not ready\n");
+        return 1;
+    }
+
+    printf("Write Without Response of %d byte frames, %.1f ms connection interval, %u controller buffers, "
+           "%u PDUs of %u octets per event\n", FRAME_LENGTH, config.conn_interval_us / 1000.0,
+           config.tx_buffers, config.tx_pdus_per_event, config.max_tx_octets);
+    printf("scenario   mode    offered  delivered  lost  kB/s   ctrl max ms  stream max ms  "
+           "depth max  stall ms  congested\n");
+
+    int failures = 0;
+    for (size_t s = 0; s < SCENARIO_COUNT; s++) {
+        run_result_t results[MODE_COUNT];
+        for (int mode = 0; mode < MODE_COUNT; mode++) {
+            run_result_t *r = &results[mode];
+            run((bench_mode_t)mode, &s_scenarios[s], seconds, r);
+            const uint32_t offered = total(r->offered);
+            const uint32_t delivered = total(r->delivered);
+            printf("%-10s %-7s %7u %10u %5u %5.1f %12.1f %14.1f %10u %9.1f %10u\n",
+                   s_scenarios[s].name, s_mode_names[mode], (unsigned)offered, (unsigned)delivered,
+                   (unsigned)(offered - delivered), delivered * FRAME_LENGTH / r->seconds / 1000.0,
+                   r->latency_max_us[BLE_TX_PRIO_CONTROL] / 1000.0, r->latency_max_us[BLE_TX_PRIO_STREAM] / 1000.0,
+                   (unsigned)r->tx.max_depth, r->tx.stall_us / 1000.0, (unsigned)r->sim.congestions);
+        }
+        failures += check(&s_scenarios[s], &results[MODE_DIRECT], &results[MODE_QUEUED], &config);
+    }
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
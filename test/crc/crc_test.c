@@ -0,0 +1,139 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Bit-exact test of the CRC-16/CRC-32 kernels in utils/crc.
+ * utils/crc 中 CRC-16/CRC-32 内核的逐位一致性测试。
+ *
+ * Every kernel width is checked against a bitwise reference that shares no table with the code
+ * under test: random buffers at every start offset 0-7, split into random chunks, plus the
+ * standard check string and a recorded camera frame. Built once per width like crc_bench.
+ * 每种内核宽度都与不共享任何查找表的逐位参考实现对比：随机缓冲区覆盖起始偏移 0-7，并被切分为随机块，
+ * 另加标准校验串和一帧录制的相机数据。与 crc_bench 一样按宽度分别编译。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "custom_crc16.h"
+#include "custom_crc32.h"
+
+#ifndef CRC_SLICE_BY
+#define CRC_SLICE_BY 8
+#endif
+
+#define RANDOM_ROUNDS 20000
+#define MAX_LEN       600
+
+static int s_failures;
+
+#define CHECK(cond, ...)                                      \
+    do {                                                      \
+        if (!(cond)) {                                        \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);       \
+            printf(__VA_ARGS__);                              \
+            printf("\n");                                     \
+            s_failures++;                                     \
+        }                                                     \
+    } while (0)
+
+/* Reflected CRC, one bit at a time / 反射 CRC，逐位计算 */
+static uint32_t ref_crc(uint32_t crc, uint32_t poly, const uint8_t *data, size_t len) {
+    while (len--) {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ poly : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+static uint16_t ref_crc16(const uint8_t *data, size_t len) {
+    return (uint16_t)ref_crc(0x3aa3, 0xa001, data, len);
+}
+
+static uint32_t ref_crc32(const uint8_t *data, size_t len) {
+    return ref_crc(0x3aa3, 0xedb88320, data, len);
+}
+
+/* Feed the buffer through crc*_update in random-sized pieces / 以随机长度分块送入 crc*_update */
+static void check_chunked(const uint8_t *data, size_t len) {
+    crc16_t c16 = crc_init();
+    crc32_t c32 = crc32_init();
+    size_t pos = 0;
+
+    while (pos < len) {
+        size_t step = 1 + (size_t)rand() % 24;
+        if (step > len - pos) {
+            step = len - pos;
+        }
+        c16 = crc16_update(c16, data + pos, step);
+        c32 = crc32_update(c32, data + pos, step);
+        pos += step;
+    }
+    CHECK(crc16_finalize(c16) == ref_crc16(data, len), "chunked crc16 len %zu", len);
+    CHECK(crc32_finalize(c32) == ref_crc32(data, len), "chunked crc32 len %zu", len);
+}
+
+int main(void) {
+    static const uint8_t check[] = "123456789";
+    /* Start of a camera status push (1D02) from the test/frame_check examples */
+    /* 相机状态推送（1D02）的开头部分，取自 test/frame_check 的示例 */
+    static const uint8_t frame[] = {
+        0xAA, 0x38, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x71, 0xD5, 0x3C, 0x40,
+        0x1D, 0x02, 0x3C, 0x01, 0x0E, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x74, 0x25, 0x01, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0xBA, 0x16, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    };
+    uint8_t buf[MAX_LEN + 8];
+
+    CHECK(calculate_crc16(check, 9) == 0x2752, "crc16 check value 0x%04x", calculate_crc16(check, 9));
+    CHECK(calculate_crc32(check, 9) == 0xe4d9dc14, "crc32 check value 0x%08x", (unsigned)calculate_crc32(check, 9));
+    CHECK(calculate_crc16(frame, 10) == ref_crc16(frame, 10), "camera frame header crc16");
+    CHECK(calculate_crc32(frame, sizeof(frame)) == ref_crc32(frame, sizeof(frame)), "camera frame crc32");
+
+    CHECK(crc16_self_test(), "crc16_self_test");
+    CHECK(crc32_self_test(), "crc32_self_test");
+
+    srand(0x3aa3);
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = (uint8_t)rand();
+    }
+
+    /* Every length up to MAX_LEN at every start offset / 每种起始偏移下覆盖至 MAX_LEN 的每个长度 */
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t len = 0; len <= MAX_LEN; len++) {
+            const uint8_t *p = buf + offset;
+            CHECK(calculate_crc16(p, len) == ref_crc16(p, len), "crc16 offset %zu len %zu", offset, len);
+            CHECK(calculate_crc32(p, len) == ref_crc32(p, len), "crc32 offset %zu len %zu", offset, len);
+        }
+    }
+
+    for (int round = 0; round < RANDOM_ROUNDS && s_failures == 0; round++) {
+        size_t len = (size_t)rand() % MAX_LEN;
+        for (size_t i = 0; i < len; i++) {
+            buf[i] = (uint8_t)rand();
+        }
+        check_chunked(buf, len);
+    }
+
+    printf("slice-by-%d: %s\n", CRC_SLICE_BY, s_failures ? "FAIL" : "PASS");
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,135 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Command pipelining benchmark: sends batches of 0x1D04 commands through command_logic, once one
+ * after another with send_command and once with all of them submitted before the first await.
+ * 命令流水线基准：通过 command_logic 发送成批的 0x1D04 命令，一次用 send_command 逐条发送，
+ * 一次先全部提交再逐个等待。
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "data.h"
+#include "enums_logic.h"
+#include "connect_logic.h"
+#include "command_logic.h"
+#include "dji_protocol_data_structures.h"
+
+#include "fake_camera.h"
+
+#define DEFAULT_ROUNDS  50
+
+/* command_logic only sends while the protocol link is up */
+/* command_logic 仅在协议连接建立后发送 */
+connect_state_t connect_logic_get_state(void) {
+    return PROTOCOL_CONNECTED;
+}
+
+static const camera_mode_switch_command_frame_t s_mode_switch = {
+    .device_id = 0xFF330000,
+    .mode = CAMERA_MODE_PHOTO,
+    .reserved = {0x01, 0x47, 0x39, 0x36}
+};
+
+/* One batch of commands sent one after another, returns elapsed microseconds or 0 on failure */
+/* 逐条发送一批命令，返回耗时（微秒），失败返回 0 */
+static uint64_t run_sequential(int batch) {
+    command_result_buffer_t response;
+    uint64_t start = fake_camera_now_us();
+    for (int i = 0; i < batch; i++) {
+        CommandResult result = send_command(0x1D, 0x04, CMD_RESPONSE_OR_NOT, &s_mode_switch, generate_seq(), 1000,
+                                            &response);
+        if (result.structure == NULL) {
+            return 0;
+        }
+    }
+    return fake_camera_now_us() - start;
+}
+
+/* The same batch with every command in flight before the first await */
+/* 同一批命令，先全部提交再开始等待 */
+static uint64_t run_pipelined(int batch) {
+    command_handle_t handles[COMMAND_MAX_IN_FLIGHT];
+    command_result_buffer_t response;
+    uint64_t start = fake_camera_now_us();
+    for (int i = 0; i < batch; i++) {
+        handles[i] = command_submit(0x1D, 0x04, CMD_RESPONSE_OR_NOT, &s_mode_switch, generate_seq(), 1000);
+    }
+    bool ok = true;
+    for (int i = 0; i < batch; i++) {
+        CommandResult result = command_await(handles[i], &response);
+        if (result.structure == NULL) {
+            ok = false;
+        }
+    }
+    return ok ? fake_camera_now_us() - start : 0;
+}
+
+static void report(int batch, uint64_t sequential_us, uint64_t pipelined_us, int rounds) {
+    fprintf(stderr, "%5d %14.2f %14.2f %8.1fx\n", batch, sequential_us / 1000.0 / rounds,
+            pipelined_us / 1000.0 / rounds, (double)sequential_us / pipelined_us);
+}
+
+int main(int argc, char **argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : DEFAULT_ROUNDS;
+    if (rounds <= 0) {
+        rounds = DEFAULT_ROUNDS;
+    }
+
+    /* The data layer prints every RX frame to stdout; keep the report on stderr readable */
+    /* 数据层会把每个接收帧打印到 stdout，屏蔽掉以保证 stderr 上的报告清晰 */
+    if (freopen("/dev/null", "w", stdout) == NULL) {
+        return 1;
+    }
+    srand(1);
+
+    fake_camera_set_link_delay(5000, 3000);
+    fake_camera_start();
+    data_init();
+
+    fprintf(stderr, "link delay 5..8 ms, %d rounds per batch size, ms per batch\n", rounds);
+    fprintf(stderr, "%5s %14s %14s %9s\n", "batch", "sequential", "pipelined", "speedup");
+    int failures = 0;
+    for (int batch = 1; batch <= COMMAND_MAX_IN_FLIGHT; batch++) {
+        uint64_t sequential_us = 0, pipelined_us = 0;
+        for (int r = 0; r < rounds; r++) {
+            uint64_t s = run_sequential(batch);
+            uint64_t p = run_pipelined(batch);
+            if (s == 0 || p == 0) {
+                failures++;
+                continue;
+            }
+            sequential_us += s;
+            pipelined_us += p;
+        }
+        report(batch, sequential_us, pipelined_us, rounds);
+    }
+
+    if (failures) {
+        fprintf(stderr, "%d rounds failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
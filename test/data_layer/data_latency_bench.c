@@ -0,0 +1,168 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Host-side latency benchmark for the data layer wait path.
+ * 数据层等待路径的主机端延迟基准测试。
+ *
+ * A fake camera thread answers writes after a simulated BLE link delay and pushes
+ * unsolicited frames, feeding them through receive_camera_notify_handler exactly
+ * like the GATTC notify callback does. The benchmark reports how much latency the
+ * data layer adds on top of the link itself.
+ * 模拟相机线程在模拟的 BLE 链路延迟后应答写入并主动推送帧，与 GATTC notify 回调一样
+ * 经由 receive_camera_notify_handler 送入数据层。基准统计数据层在链路延迟之外额外引入的延迟。
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "freertos/FreeRTOS.h"
+
+#include "data.h"
+#include "dji_protocol_data_structures.h"
+
+#include "fake_camera.h"
+
+#define DEFAULT_ITERATIONS 400
+#define LINK_DELAY_US      5000   // Fixed part of the simulated link delay / 模拟链路延迟固定部分
+#define LINK_JITTER_US     3000   // Random extra delay / 随机附加延迟
+#define PUSH_WINDOW_US     20000  // Camera pushes land anywhere in this window / 相机推送在此窗口内随机到达
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void report(const char *name, uint64_t *samples, int count, int failures) {
+    qsort(samples, count, sizeof(samples[0]), cmp_u64);
+    uint64_t sum = 0;
+    for (int i = 0; i < count; i++) {
+        sum += samples[i];
+    }
+    fprintf(stderr, "%-28s n=%-4d p50=%6.2f ms  p99=%6.2f ms  max=%6.2f ms  mean=%6.2f ms  failures=%d\n",
+            name, count,
+            samples[count / 2] / 1000.0,
+            samples[(count * 99) / 100] / 1000.0,
+            samples[count - 1] / 1000.0,
+            count ? (double)sum / count / 1000.0 : 0.0,
+            failures);
+}
+
+/* ---------- scenarios ---------- */
+
+/* Request/response keyed by seq: latency from the response entering the data layer to the waiter returning */
+/* 基于 seq 的请求应答：从应答进入数据层到等待者返回的延迟 */
+static void bench_seq_round_trip(int iterations) {
+    uint64_t *samples = calloc(iterations, sizeof(uint64_t));
+    int count = 0, failures = 0;
+    uint8_t request[FAKE_CAMERA_MAX_FRAME];
+    uint8_t payload[4] = { 0 };
+
+    for (int i = 0; i < iterations; i++) {
+        uint16_t seq = (uint16_t)(0x100 + i);
+        size_t request_length = fake_camera_build_frame(0x03, seq, 0x1D, 0x04, payload, sizeof(payload), request);
+
+        if (data_write_with_response(seq, request, request_length) != ESP_OK) {
+            failures++;
+            continue;
+        }
+        void *result = NULL;
+        size_t result_length = 0;
+        esp_err_t ret = data_wait_for_result_by_seq(seq, 1000, &result, &result_length);
+        uint64_t end = fake_camera_now_us();
+        if (ret != ESP_OK) {
+            failures++;
+            continue;
+        }
+        free(result);
+        samples[count++] = end - fake_camera_last_delivery_us();
+    }
+    report("wait_by_seq (wake latency)", samples, count, failures);
+    free(samples);
+}
+
+/* Camera initiated command, the waiter is already parked when the frame arrives (e.g. 0x0019 handshake) */
+/* 相机主动发起的命令，帧到达时等待者已在等待（如 0x0019 握手） */
+static void bench_cmd_wait(int iterations) {
+    uint64_t *samples = calloc(iterations, sizeof(uint64_t));
+    int count = 0, failures = 0;
+    connection_request_command_frame push = { .device_id = 0x12345678, .verify_mode = 1 };
+    uint8_t frame[FAKE_CAMERA_MAX_FRAME];
+
+    for (int i = 0; i < iterations; i++) {
+        uint16_t seq = (uint16_t)(0x8000 + i);
+        size_t frame_length = fake_camera_build_frame(0x00, seq, 0x00, 0x19, &push, sizeof(push), frame);
+        fake_camera_schedule(frame, frame_length, fake_camera_now_us() + (uint64_t)(rand() % PUSH_WINDOW_US));
+
+        uint16_t out_seq = 0;
+        void *result = NULL;
+        size_t result_length = 0;
+        esp_err_t ret = data_wait_for_result_by_cmd(0x00, 0x19, 1000, &out_seq, &result, &result_length);
+        uint64_t end = fake_camera_now_us();
+        if (ret != ESP_OK || out_seq != seq) {
+            failures++;
+            free(result);
+            continue;
+        }
+        free(result);
+        samples[count++] = end - fake_camera_last_delivery_us();
+    }
+    report("wait_by_cmd (wake latency)", samples, count, failures);
+    free(samples);
+}
+
+/* Nothing is pushed: the waiter must give up after its timeout, not earlier and not much later */
+/* 无推送：等待者必须在超时后返回，既不提前也不明显延后 */
+static int check_timeout(void) {
+    uint16_t out_seq = 0;
+    void *result = NULL;
+    size_t result_length = 0;
+    uint64_t start = fake_camera_now_us();
+    esp_err_t ret = data_wait_for_result_by_cmd(0x1D, 0x03, 50, &out_seq, &result, &result_length);
+    uint64_t elapsed = fake_camera_now_us() - start;
+    bool ok = ret == ESP_ERR_TIMEOUT && elapsed >= 49000 && elapsed < 150000;
+    fprintf(stderr, "%-28s %s (%s after %.1f ms)\n", "timeout without push", ok ? "PASS" : "FAIL",
+            esp_err_to_name(ret), elapsed / 1000.0);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0) {
+        iterations = DEFAULT_ITERATIONS;
+    }
+
+    /* The data layer prints every RX frame to stdout; keep the report on stderr readable */
+    /* 数据层会把每个接收帧打印到 stdout，屏蔽掉以保证 stderr 上的报告清晰 */
+    if (freopen("/dev/null", "w", stdout) == NULL) {
+        return 1;
+    }
+    srand(1);
+
+    fake_camera_set_link_delay(LINK_DELAY_US, LINK_JITTER_US);
+    fake_camera_start();
+
+    data_init();
+    fprintf(stderr, "link delay %d..%d ms, push window %d ms, %d iterations per scenario\n",
+            LINK_DELAY_US / 1000, (LINK_DELAY_US + LINK_JITTER_US) / 1000, PUSH_WINDOW_US / 1000, iterations);
+    bench_seq_round_trip(iterations);
+    bench_cmd_wait(iterations);
+    return check_timeout();
+}
@@ -0,0 +1,222 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Microbenchmark of the pending-request table in data/data.c.
+ * data/data.c 中待应答请求表的微基准测试。
+ *
+ * data.c is included directly so its static lookup and allocation functions can be timed.
+ * Build it once per table size with -DMAX_SEQ_ENTRIES=<n>. Each run compares the hashed table
+ * against a reference copy of the previous linear scan over an array of the same size.
+ * 直接包含 data.c 以便测量其静态的查找与分配函数。每种表大小用 -DMAX_SEQ_ENTRIES=<n> 单独编译，
+ * 每次运行都会与同等大小数组上的旧线性扫描参考实现进行对比。
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../../data/data.c"
+
+#define LOOKUP_ROUNDS 2000000
+#define ALLOC_ROUNDS  200000
+
+ble_profile_t s_ble_profile;
+
+esp_err_t ble_write_with_response(uint16_t conn_id, uint16_t handle, const uint8_t *data, size_t length) {
+    return ESP_OK;
+}
+
+esp_err_t ble_write_without_response(uint16_t conn_id, uint16_t handle, const uint8_t *data, size_t length) {
+    return ESP_OK;
+}
+
+esp_err_t ble_write_without_response_prio(uint16_t conn_id, uint16_t handle, const uint8_t *data, size_t length,
+                                          ble_tx_prio_t prio) {
+    return ESP_OK;
+}
+
+static volatile uintptr_t s_sink;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* ---------- reference: the previous linear scan ---------- */
+
+typedef struct {
+    bool in_use;
+    bool is_seq_based;
+    uint16_t seq;
+    uint8_t cmd_set;
+    uint8_t cmd_id;
+    SemaphoreHandle_t sem;
+    uint32_t last_access_time;
+} ref_entry_t;
+
+static ref_entry_t s_ref[MAX_SEQ_ENTRIES];
+
+static ref_entry_t *ref_find_by_seq(uint16_t seq) {
+    for (int i = 0; i < MAX_SEQ_ENTRIES; i++) {
+        if (s_ref[i].in_use && s_ref[i].is_seq_based && s_ref[i].seq == seq) {
+            s_ref[i].last_access_time = xTaskGetTickCount();
+            return &s_ref[i];
+        }
+    }
+    return NULL;
+}
+
+static ref_entry_t *ref_find_by_cmd(uint8_t cmd_set, uint8_t cmd_id) {
+    for (int i = 0; i < MAX_SEQ_ENTRIES; i++) {
+        if (s_ref[i].in_use && !s_ref[i].is_seq_based &&
+            s_ref[i].cmd_set == cmd_set && s_ref[i].cmd_id == cmd_id) {
+            s_ref[i].last_access_time = xTaskGetTickCount();
+            return &s_ref[i];
+        }
+    }
+    return NULL;
+}
+
+static void ref_free(ref_entry_t *entry) {
+    entry->in_use = false;
+    vSemaphoreDelete(entry->sem);
+    entry->sem = NULL;
+}
+
+static ref_entry_t *ref_claim(ref_entry_t *entry, bool is_seq_based, uint16_t seq, uint8_t cmd_set, uint8_t cmd_id) {
+    entry->in_use = true;
+    entry->is_seq_based = is_seq_based;
+    entry->seq = seq;
+    entry->cmd_set = cmd_set;
+    entry->cmd_id = cmd_id;
+    entry->sem = xSemaphoreCreateBinary();
+    entry->last_access_time = xTaskGetTickCount();
+    return entry;
+}
+
+static ref_entry_t *ref_alloc_by_seq(uint16_t seq) {
+    ref_entry_t *existing = ref_find_by_seq(seq);
+    if (existing) {
+        ref_free(existing);
+    }
+    ref_entry_t *oldest = NULL;
+    uint32_t oldest_time = UINT32_MAX;
+    for (int i = 0; i < MAX_SEQ_ENTRIES; i++) {
+        if (!s_ref[i].in_use) {
+            return ref_claim(&s_ref[i], true, seq, 0, 0);
+        }
+        if (s_ref[i].last_access_time < oldest_time) {
+            oldest_time = s_ref[i].last_access_time;
+            oldest = &s_ref[i];
+        }
+    }
+    ref_free(oldest);
+    return ref_claim(oldest, true, seq, 0, 0);
+}
+
+/* ---------- workload ---------- */
+
+/* Table is filled with 3/4 seq-based and 1/4 cmd-based entries, like a busy link with a few pushes */
+/* 表中 3/4 为基于 seq 的条目，1/4 为基于 cmd 的条目，模拟繁忙链路加少量推送 */
+#define SEQ_COUNT (MAX_SEQ_ENTRIES - MAX_SEQ_ENTRIES / 4)
+#define CMD_COUNT (MAX_SEQ_ENTRIES / 4)
+
+static uint16_t s_seqs[SEQ_COUNT];
+static uint16_t s_cmds[CMD_COUNT > 0 ? CMD_COUNT : 1];
+
+static void fill_tables(void) {
+    reset_entries();
+    for (int i = 0; i < SEQ_COUNT; i++) {
+        s_seqs[i] = (uint16_t)(0x1000 + i * 7);
+        allocate_entry_by_seq(s_seqs[i]);
+        ref_alloc_by_seq(s_seqs[i]);
+    }
+    for (int i = 0; i < CMD_COUNT; i++) {
+        s_cmds[i] = (uint16_t)(0x1D00 + i);
+        allocate_entry_by_cmd(s_cmds[i] >> 8, s_cmds[i] & 0xFF);
+        ref_claim(&s_ref[SEQ_COUNT + i], false, 0, s_cmds[i] >> 8, s_cmds[i] & 0xFF);
+    }
+}
+
+static void row(const char *op, double old_ns, double new_ns) {
+    printf("%4d  %-22s %9.1f %9.1f %8.1fx\n", MAX_SEQ_ENTRIES, op, old_ns, new_ns, old_ns / new_ns);
+}
+
+int main(void) {
+    fill_tables();
+
+    /* Lookup of a pending seq (response arrives) */
+    /* 查找待应答 seq（应答到达） */
+    double t0 = now_ns();
+    for (int i = 0; i < LOOKUP_ROUNDS; i++) {
+        s_sink += (uintptr_t)ref_find_by_seq(s_seqs[(i * 13) % SEQ_COUNT]);
+    }
+    double t1 = now_ns();
+    for (int i = 0; i < LOOKUP_ROUNDS; i++) {
+        s_sink += (uintptr_t)find_entry_by_seq(s_seqs[(i * 13) % SEQ_COUNT]);
+    }
+    double t2 = now_ns();
+    row("seq lookup (hit)", (t1 - t0) / LOOKUP_ROUNDS, (t2 - t1) / LOOKUP_ROUNDS);
+
+    /* Lookup of an unknown seq (camera push) */
+    /* 查找未知 seq（相机主动推送） */
+    t0 = now_ns();
+    for (int i = 0; i < LOOKUP_ROUNDS; i++) {
+        s_sink += (uintptr_t)ref_find_by_seq((uint16_t)(0x9000 + (i & 0xFFF)));
+    }
+    t1 = now_ns();
+    for (int i = 0; i < LOOKUP_ROUNDS; i++) {
+        s_sink += (uintptr_t)find_entry_by_seq((uint16_t)(0x9000 + (i & 0xFFF)));
+    }
+    t2 = now_ns();
+    row("seq lookup (miss)", (t1 - t0) / LOOKUP_ROUNDS, (t2 - t1) / LOOKUP_ROUNDS);
+
+    /* Lookup by cmd_set/cmd_id */
+    /* 按 cmd_set/cmd_id 查找 */
+    t0 = now_ns();
+    for (int i = 0; i < LOOKUP_ROUNDS; i++) {
+        uint16_t key = s_cmds[i % (CMD_COUNT > 0 ? CMD_COUNT : 1)];
+        s_sink += (uintptr_t)ref_find_by_cmd(key >> 8, key & 0xFF);
+    }
+    t1 = now_ns();
+    for (int i = 0; i < LOOKUP_ROUNDS; i++) {
+        uint16_t key = s_cmds[i % (CMD_COUNT > 0 ? CMD_COUNT : 1)];
+        s_sink += (uintptr_t)find_entry_by_cmd_id(key >> 8, key & 0xFF);
+    }
+    t2 = now_ns();
+    row("cmd lookup (hit)", (t1 - t0) / LOOKUP_ROUNDS, (t2 - t1) / LOOKUP_ROUNDS);
+
+    /* Allocation on a full table, each one evicts the LRU entry (includes semaphore create/delete) */
+    /* 满表分配，每次都淘汰 LRU 条目（包含信号量创建与删除） */
+    t0 = now_ns();
+    for (int i = 0; i < ALLOC_ROUNDS; i++) {
+        s_sink += (uintptr_t)ref_alloc_by_seq((uint16_t)(0x4000 + i));
+    }
+    t1 = now_ns();
+    for (int i = 0; i < ALLOC_ROUNDS; i++) {
+        s_sink += (uintptr_t)allocate_entry_by_seq((uint16_t)(0x4000 + i));
+    }
+    t2 = now_ns();
+    row("alloc + LRU evict", (t1 - t0) / ALLOC_ROUNDS, (t2 - t1) / ALLOC_ROUNDS);
+
+    return 0;
+}
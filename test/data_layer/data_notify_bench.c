@@ -0,0 +1,211 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Notification throughput benchmark: replays 0x1D02 camera status pushes into
+ * receive_camera_notify_handler at fixed rates and once unthrottled, and reports delivered
+ * frames, ring overflows, heap allocations per notification and push-to-callback latency.
+ * 通知吞吐基准：以固定频率及不限速方式向 receive_camera_notify_handler 回放 0x1D02 相机状态推送，
+ * 报告送达帧数、环形缓冲区溢出数、每条通知的堆分配次数以及推送到回调的延迟。
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "data.h"
+#include "dji_protocol_data_structures.h"
+#include "host_heap.h"
+
+#include "fake_camera.h"
+
+#define BENCH_MTU           247     // Typical negotiated ATT MTU / 常见的协商 ATT MTU
+#define RATE_SECONDS        1       // Duration of each fixed-rate run / 每个固定频率场景的时长
+#define BURST_FRAMES        20000   // Frames pushed back to back in the unthrottled run / 不限速场景连续推送的帧数
+#define MAX_FRAMES          BURST_FRAMES
+#define HOLD_MS             200     // How long the consumer is held in the callback while the MTU is reported / 上报 MTU 时消费者在回调中被阻塞的时长
+#define MTU_REPORT_LIMIT_US 1000    // The MTU report must return within this / MTU 上报必须在此时间内返回
+
+static const int s_rates_hz[] = { 100, 200, 500, 1000 };
+
+/* Push timestamp of every frame, and callback timestamp of every delivered frame */
+/* 每帧的推送时间戳，以及每个送达帧的回调时间戳 */
+static uint64_t s_push_us[MAX_FRAMES];
+static uint64_t s_delivered_us[MAX_FRAMES];
+static volatile uint32_t s_delivered = 0;
+static volatile uint8_t s_last_mode = 0;
+
+/* Set to keep the consumer inside the status callback, s_held tells it has arrived */
+/* 置位时使消费者停留在状态回调中，s_held 表示其已进入 */
+static volatile uint8_t s_hold = 0;
+static volatile uint8_t s_held = 0;
+
+/* Status callback, borrows the parsed push like update_camera_state_handler does */
+/* 状态回调，与 update_camera_state_handler 一样借用解析后的推送数据 */
+static void status_callback(const void *data) {
+    const camera_status_push_command_frame *status = (const camera_status_push_command_frame *)data;
+    s_last_mode = status->camera_mode;
+    uint32_t n = s_delivered;
+    if (n < MAX_FRAMES) {
+        s_delivered_us[n] = fake_camera_now_us();
+    }
+    __atomic_store_n(&s_delivered, n + 1, __ATOMIC_RELEASE);
+
+    if (__atomic_load_n(&s_hold, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&s_held, 1, __ATOMIC_RELEASE);
+        while (__atomic_load_n(&s_hold, __ATOMIC_ACQUIRE)) {
+            vTaskDelay(pdMS_TO_TICKS(1));
+        }
+        __atomic_store_n(&s_held, 0, __ATOMIC_RELEASE);
+    }
+}
+
+static void sleep_until_us(uint64_t deadline) {
+    struct timespec ts = { .tv_sec = deadline / 1000000u, .tv_nsec = (long)(deadline % 1000000u) * 1000L };
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Wait until the notify task has been idle for a while */
+/* 等待通知任务空闲一段时间 */
+static void drain(void) {
+    uint32_t last;
+    do {
+        last = s_delivered;
+        vTaskDelay(pdMS_TO_TICKS(20));
+    } while (last != s_delivered);
+}
+
+/**
+ * Push count frames, interval_us apart (0 = back to back), and report one result line.
+ * 以 interval_us 为间隔（0 表示连续）推送 count 帧，并输出一行结果。
+ */
+static void run(const char *name, int count, uint64_t interval_us) {
+    uint8_t frame[FAKE_CAMERA_MAX_FRAME];
+    camera_status_push_command_frame push = { .camera_mode = 0x0A, .camera_status = 0x01, .video_resolution = 16 };
+    host_heap_stats_t heap_before, heap_after;
+
+    drain();
+    s_delivered = 0;
+    uint32_t overflow_before = data_get_notify_overflow_count();
+    host_heap_get_stats(&heap_before);
+
+    uint64_t start = fake_camera_now_us();
+    for (int i = 0; i < count; i++) {
+        if (interval_us) {
+            sleep_until_us(start + (uint64_t)i * interval_us);
+        }
+        push.remain_time = (uint32_t)i;
+        size_t length = fake_camera_build_frame(0x00, (uint16_t)(0x8000 | (i & 0x7FFF)), 0x1D, 0x02, &push, sizeof(push), frame);
+        s_push_us[i] = fake_camera_now_us();
+        receive_camera_notify_handler(frame, length);
+    }
+    drain();
+
+    host_heap_get_stats(&heap_after);
+    uint32_t delivered = s_delivered;
+    // Consumer throughput, from the first push to the last callback
+    // 消费者吞吐量，从第一次推送到最后一次回调
+    uint64_t elapsed = delivered ? s_delivered_us[(delivered < MAX_FRAMES ? delivered : MAX_FRAMES) - 1] - s_push_us[0] : 1;
+    uint32_t overflows = data_get_notify_overflow_count() - overflow_before;
+    double allocs = delivered ? (double)(heap_after.allocations - heap_before.allocations) / delivered : 0.0;
+
+    // Frames are delivered in push order, so without drops the n-th callback belongs to the n-th push
+    // 帧按推送顺序送达，无丢帧时第 n 次回调对应第 n 次推送
+    if (delivered == (uint32_t)count) {
+        uint64_t *latency = malloc(count * sizeof(uint64_t));
+        for (int i = 0; i < count; i++) {
+            latency[i] = s_delivered_us[i] - s_push_us[i];
+        }
+        qsort(latency, count, sizeof(uint64_t), compare_u64);
+        fprintf(stderr, "%-12s %8d %10u %9u %12.0f %11.2f %7.3f / %.3f ms\n", name, count, delivered, overflows,
+                delivered * 1e6 / elapsed, allocs, latency[count / 2] / 1000.0, latency[count * 99 / 100] / 1000.0);
+        free(latency);
+    } else {
+        fprintf(stderr, "%-12s %8d %10u %9u %12.0f %11.2f %17s\n", name, count, delivered, overflows,
+                delivered * 1e6 / elapsed, allocs, "-");
+    }
+}
+
+/**
+ * Report the MTU while the consumer is busy in a status callback, as the GATTC callback can at any
+ * time. Returns the time data_set_notify_mtu took.
+ * 在消费者忙于状态回调时上报 MTU（GATTC 回调随时可能如此），返回 data_set_notify_mtu 的耗时。
+ */
+static uint64_t report_mtu_while_busy(void) {
+    uint8_t frame[FAKE_CAMERA_MAX_FRAME];
+    camera_status_push_command_frame push = { .camera_mode = 0x0A, .camera_status = 0x01, .video_resolution = 16 };
+    size_t length = fake_camera_build_frame(0x00, 0x8000, 0x1D, 0x02, &push, sizeof(push), frame);
+
+    __atomic_store_n(&s_hold, 1, __ATOMIC_RELEASE);
+    receive_camera_notify_handler(frame, length);
+    while (!__atomic_load_n(&s_held, __ATOMIC_ACQUIRE)) {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+
+    uint64_t start = fake_camera_now_us();
+    data_set_notify_mtu(BENCH_MTU);
+    uint64_t took = fake_camera_now_us() - start;
+
+    vTaskDelay(pdMS_TO_TICKS(HOLD_MS));
+    __atomic_store_n(&s_hold, 0, __ATOMIC_RELEASE);
+    return took;
+}
+
+int main(int argc, char **argv) {
+    /* The data layer prints every RX frame to stdout; keep the report on stderr readable */
+    /* 数据层会把每个接收帧打印到 stdout，屏蔽掉以保证 stderr 上的报告清晰 */
+    if (freopen("/dev/null", "w", stdout) == NULL) {
+        return 1;
+    }
+
+    fake_camera_start();
+    data_init();
+    data_register_status_update_callback(status_callback);
+
+    // This thread plays the GATTC callback, so it is also the one that reports the MTU. The
+    // consumer resizes the ring once it leaves the callback, before the first run starts.
+    // 本线程扮演 GATTC 回调，因此也由它上报 MTU。消费者离开回调后调整环大小，在第一个场景开始之前完成。
+    uint64_t mtu_report_us = report_mtu_while_busy();
+    fprintf(stderr, "MTU report with the consumer busy for %d ms: %.3f ms\n", HOLD_MS, mtu_report_us / 1000.0);
+    if (mtu_report_us > MTU_REPORT_LIMIT_US) {
+        fprintf(stderr, "FAIL: the MTU report waited for the consumer\n");
+        return 1;
+    }
+
+    fprintf(stderr, "0x1D02 status push replay, %zu byte payload, MTU %d\n", sizeof(camera_status_push_command_frame), BENCH_MTU);
+    fprintf(stderr, "%-12s %8s %10s %9s %12s %11s %17s\n", "rate", "pushed", "delivered", "overflow", "frames/s",
+            "allocs/ntf", "latency p50 / p99");
+
+    for (size_t i = 0; i < sizeof(s_rates_hz) / sizeof(s_rates_hz[0]); i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "%d Hz", s_rates_hz[i]);
+        run(name, s_rates_hz[i] * RATE_SECONDS, 1000000u / s_rates_hz[i]);
+    }
+    run("unthrottled", BURST_FRAMES, 0);
+    return 0;
+}
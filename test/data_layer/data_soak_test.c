@@ -0,0 +1,221 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Soak test for the command path: runs thousands of command_submit/command_await and push/collect
+ * cycles through command_logic and the data layer, and checks that the steady state creates no
+ * kernel objects and does not touch the heap.
+ * 命令路径浸泡测试：经 command_logic 与数据层运行数千次 command_submit/command_await 与推送收取循环，
+ * 检查稳态下不创建内核对象、不使用堆。
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "data.h"
+#include "enums_logic.h"
+#include "connect_logic.h"
+#include "command_logic.h"
+#include "dji_protocol_data_structures.h"
+#include "host_heap.h"
+
+#include "fake_camera.h"
+
+#define WARMUP_CYCLES       50
+#define DEFAULT_CYCLES      5000
+#define PUSH_EVERY          10    // One camera push per this many commands / 每隔多少条命令推送一次
+#define TIMEOUT_EVERY       250   // One unanswered wait per this many commands / 每隔多少条命令一次无应答等待
+#define RAW_WRITE_EVERY     7     // One no-response command reusing the pending seq per this many commands / 每隔多少条命令一次复用在途 seq 的无响应命令
+#define SHARED_WAIT_EVERY   50    // One push collected by two tasks at once per this many commands / 每隔多少条命令一次由两个任务同时收取的推送
+#define SHARED_PARK_US      5000  // Time for both waiters to park before the push lands / 推送到达前两个等待者阻塞就位的时间
+
+typedef struct {
+    host_heap_stats_t heap;
+    host_freertos_stats_t kernel;
+} snapshot_t;
+
+/* command_logic only sends while the protocol link is up */
+/* command_logic 仅在协议连接建立后发送 */
+connect_state_t connect_logic_get_state(void) {
+    return PROTOCOL_CONNECTED;
+}
+
+static const camera_mode_switch_command_frame_t s_mode_switch = {
+    .device_id = 0xFF330000,
+    .mode = CAMERA_MODE_PHOTO,
+    .reserved = {0x01, 0x47, 0x39, 0x36}
+};
+
+/* Second waiter on the pushed cmd_set/cmd_id, like the handshake waiting next to a key command */
+/* 同一推送 cmd_set/cmd_id 上的第二个等待者，如同握手与按键命令同时等待 */
+static SemaphoreHandle_t s_shared_go;
+static SemaphoreHandle_t s_shared_done;
+static esp_err_t s_shared_ret;
+static uint16_t s_shared_seq;
+
+static void shared_waiter_task(void *arg) {
+    (void)arg;
+    uint8_t buffer[64];
+    size_t length;
+    while (1) {
+        xSemaphoreTake(s_shared_go, portMAX_DELAY);
+        s_shared_ret = data_wait_for_result_by_cmd_into(0x00, 0x19, 1000, &s_shared_seq, buffer, sizeof(buffer),
+                                                        &length);
+        xSemaphoreGive(s_shared_done);
+    }
+}
+
+static void take_snapshot(snapshot_t *out) {
+    // Let the notify task finish with everything the camera delivered
+    // 等待通知任务处理完相机送达的所有数据
+    fake_camera_flush();
+    vTaskDelay(pdMS_TO_TICKS(20));
+    host_heap_get_stats(&out->heap);
+    host_freertos_get_stats(&out->kernel);
+}
+
+static int run_cycle(int i) {
+    uint8_t frame[FAKE_CAMERA_MAX_FRAME];
+    command_result_buffer_t result;
+    size_t result_length = 0;
+
+    // Command answered by seq, the way every command_logic_* call sends it
+    // 按 seq 应答的命令，与所有 command_logic_* 调用的发送方式相同
+    uint16_t seq = (uint16_t)(i & 0x7FFF);
+    command_handle_t handle = command_submit(0x1D, 0x04, CMD_RESPONSE_OR_NOT, &s_mode_switch, seq, 1000);
+    if (handle == NULL) {
+        fprintf(stderr, "cycle %d: submit 0x%04X failed\n", i, seq);
+        return 1;
+    }
+
+    // A no-response command on the same seq, like data_send_raw_bytes, must leave the pending command alone
+    // 相同 seq 上的无响应命令（如 data_send_raw_bytes）不得影响在途命令
+    if (i % RAW_WRITE_EVERY == 0) {
+        command_handle_t raw = command_submit(0x1D, 0x04, CMD_NO_RESPONSE, &s_mode_switch, seq, 1000);
+        if (raw == NULL) {
+            fprintf(stderr, "cycle %d: no-response command failed\n", i);
+            return 1;
+        }
+        (void)command_await(raw, NULL);
+        fake_camera_flush();
+    }
+
+    CommandResult response = command_await(handle, &result);
+    if (response.structure == NULL) {
+        fprintf(stderr, "cycle %d: seq 0x%04X failed\n", i, seq);
+        return 1;
+    }
+
+    // Camera initiated command collected by cmd_set/cmd_id, as in the protocol handshake
+    // 相机主动发起、按 cmd_set/cmd_id 收取的命令，与协议握手相同
+    if (i % PUSH_EVERY == 0) {
+        connection_request_command_frame push = { .device_id = (uint32_t)i };
+        uint16_t push_seq = (uint16_t)(0x8000 | (i & 0x7FFF));
+        size_t length = fake_camera_build_frame(0x00, push_seq, 0x00, 0x19, &push, sizeof(push), frame);
+        fake_camera_schedule(frame, length, fake_camera_now_us() + 200);
+        uint16_t out_seq = 0;
+        if (data_wait_for_result_by_cmd_into(0x00, 0x19, 1000, &out_seq, result.data, sizeof(result.data),
+                                             &result_length) != ESP_OK ||
+            out_seq != push_seq) {
+            fprintf(stderr, "cycle %d: push 0x%04X failed\n", i, push_seq);
+            return 1;
+        }
+    }
+
+    // Two tasks wait for the same push, both must get it and the entry must be freed by the last one
+    // 两个任务等待同一推送，二者都必须收到，且条目由最后一个释放
+    if (i % SHARED_WAIT_EVERY == 0) {
+        connection_request_command_frame push = { .device_id = (uint32_t)i };
+        uint16_t push_seq = (uint16_t)(0x8000 | (i & 0x7FFF));
+        size_t length = fake_camera_build_frame(0x00, push_seq, 0x00, 0x19, &push, sizeof(push), frame);
+        xSemaphoreGive(s_shared_go);
+        fake_camera_schedule(frame, length, fake_camera_now_us() + SHARED_PARK_US);
+        uint16_t out_seq = 0;
+        const esp_err_t ret = data_wait_for_result_by_cmd_into(0x00, 0x19, 1000, &out_seq, result.data,
+                                                               sizeof(result.data), &result_length);
+        xSemaphoreTake(s_shared_done, portMAX_DELAY);
+        if (ret != ESP_OK || out_seq != push_seq || s_shared_ret != ESP_OK || s_shared_seq != push_seq) {
+            fprintf(stderr, "cycle %d: shared push 0x%04X failed (%s / %s)\n", i, push_seq, esp_err_to_name(ret),
+                    esp_err_to_name(s_shared_ret));
+            return 1;
+        }
+    }
+
+    // Wait that nobody answers, its entry must be released on timeout
+    // 无人应答的等待，超时后其条目必须被释放
+    if (i % TIMEOUT_EVERY == 0) {
+        if (data_wait_for_result_by_cmd_into(0x1D, 0x03, 2, &seq, result.data, sizeof(result.data),
+                                             &result_length) != ESP_ERR_TIMEOUT) {
+            fprintf(stderr, "cycle %d: expected timeout\n", i);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int cycles = argc > 1 ? atoi(argv[1]) : DEFAULT_CYCLES;
+    if (cycles <= 0) {
+        cycles = DEFAULT_CYCLES;
+    }
+
+    srand(1);
+
+    fake_camera_set_link_delay(100, 200);
+    fake_camera_start();
+    data_init();
+    s_shared_go = xSemaphoreCreateBinary();
+    s_shared_done = xSemaphoreCreateBinary();
+    xTaskCreate(shared_waiter_task, "shared_waiter", 4096, NULL, 5, NULL);
+
+    for (int i = 0; i < WARMUP_CYCLES; i++) {
+        if (run_cycle(i)) {
+            return 1;
+        }
+    }
+
+    snapshot_t before, after;
+    take_snapshot(&before);
+    for (int i = WARMUP_CYCLES; i < WARMUP_CYCLES + cycles; i++) {
+        if (run_cycle(i)) {
+            return 1;
+        }
+    }
+    take_snapshot(&after);
+
+    long sem_created = (long)(after.kernel.semaphores_created - before.kernel.semaphores_created);
+    long sem_deleted = (long)(after.kernel.semaphores_deleted - before.kernel.semaphores_deleted);
+    long long heap_delta = after.heap.bytes_in_use - before.heap.bytes_in_use;
+    unsigned long allocations = after.heap.allocations - before.heap.allocations;
+    double allocs_per_cycle = (double)allocations / cycles;
+
+    fprintf(stderr, "cycles                       %d\n", cycles);
+    fprintf(stderr, "semaphores created/deleted   %ld / %ld\n", sem_created, sem_deleted);
+    fprintf(stderr, "heap delta                   %lld bytes\n", heap_delta);
+    fprintf(stderr, "heap allocations per cycle   %.2f\n", allocs_per_cycle);
+
+    bool ok = sem_created == 0 && sem_deleted == 0 && heap_delta == 0 && allocations == 0;
+    fprintf(stderr, "soak                         %s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
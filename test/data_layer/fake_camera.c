@@ -0,0 +1,184 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ble.h"
+#include "data.h"
+#include "custom_crc16.h"
+#include "custom_crc32.h"
+#include "dji_protocol_data_structures.h"
+
+#include "fake_camera.h"
+
+#define PENDING_CAPACITY 64
+
+ble_profile_t s_ble_profile;
+
+typedef struct {
+    uint8_t frame[FAKE_CAMERA_MAX_FRAME];
+    size_t length;
+    uint64_t due_us;
+} pending_frame_t;
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_cond = PTHREAD_COND_INITIALIZER;
+static pending_frame_t s_pending[PENDING_CAPACITY];
+static unsigned int s_head;
+static unsigned int s_count;
+static bool s_delivering;
+static uint32_t s_delay_us;
+static uint32_t s_jitter_us;
+static volatile uint64_t s_last_delivery_us;
+
+uint64_t fake_camera_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static void sleep_until_us(uint64_t deadline) {
+    uint64_t now = fake_camera_now_us();
+    if (deadline > now) {
+        struct timespec ts = { .tv_sec = (deadline - now) / 1000000u,
+                               .tv_nsec = (long)((deadline - now) % 1000000u) * 1000L };
+        nanosleep(&ts, NULL);
+    }
+}
+
+size_t fake_camera_build_frame(uint8_t cmd_type, uint16_t seq, uint8_t cmd_set, uint8_t cmd_id,
+                               const void *payload, size_t payload_length, uint8_t *out) {
+    size_t length = 16 + 2 + payload_length;
+    memset(out, 0, length);
+    out[0] = 0xAA;
+    out[1] = length & 0xFF;
+    out[2] = (length >> 8) & 0x03;
+    out[3] = cmd_type;
+    out[8] = seq & 0xFF;
+    out[9] = seq >> 8;
+    uint16_t crc16 = calculate_crc16(out, 10);
+    out[10] = crc16 & 0xFF;
+    out[11] = crc16 >> 8;
+    out[12] = cmd_set;
+    out[13] = cmd_id;
+    memcpy(&out[14], payload, payload_length);
+    uint32_t crc32 = calculate_crc32(out, length - 4);
+    out[length - 4] = crc32 & 0xFF;
+    out[length - 3] = (crc32 >> 8) & 0xFF;
+    out[length - 2] = (crc32 >> 16) & 0xFF;
+    out[length - 1] = (crc32 >> 24) & 0xFF;
+    return length;
+}
+
+void fake_camera_schedule(const uint8_t *frame, size_t length, uint64_t due_us) {
+    pthread_mutex_lock(&s_lock);
+    while (s_count == PENDING_CAPACITY) {
+        pthread_cond_wait(&s_cond, &s_lock);
+    }
+    pending_frame_t *slot = &s_pending[(s_head + s_count) % PENDING_CAPACITY];
+    memcpy(slot->frame, frame, length);
+    slot->length = length;
+    slot->due_us = due_us;
+    s_count++;
+    pthread_cond_broadcast(&s_cond);
+    pthread_mutex_unlock(&s_lock);
+}
+
+void fake_camera_flush(void) {
+    pthread_mutex_lock(&s_lock);
+    while (s_count > 0 || s_delivering) {
+        pthread_cond_wait(&s_cond, &s_lock);
+    }
+    pthread_mutex_unlock(&s_lock);
+}
+
+uint64_t fake_camera_last_delivery_us(void) {
+    return s_last_delivery_us;
+}
+
+void fake_camera_set_link_delay(uint32_t delay_us, uint32_t jitter_us) {
+    s_delay_us = delay_us;
+    s_jitter_us = jitter_us;
+}
+
+static void *camera_thread(void *arg) {
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&s_lock);
+        while (s_count == 0) {
+            pthread_cond_wait(&s_cond, &s_lock);
+        }
+        pending_frame_t frame = s_pending[s_head];
+        s_head = (s_head + 1) % PENDING_CAPACITY;
+        s_count--;
+        s_delivering = true;
+        pthread_cond_broadcast(&s_cond);
+        pthread_mutex_unlock(&s_lock);
+
+        sleep_until_us(frame.due_us);
+        s_last_delivery_us = fake_camera_now_us();
+        receive_camera_notify_handler(frame.frame, frame.length);
+
+        pthread_mutex_lock(&s_lock);
+        s_delivering = false;
+        pthread_cond_broadcast(&s_cond);
+        pthread_mutex_unlock(&s_lock);
+    }
+    return NULL;
+}
+
+void fake_camera_start(void) {
+    pthread_t thread;
+    pthread_create(&thread, NULL, camera_thread, NULL);
+    pthread_detach(thread);
+}
+
+esp_err_t ble_write_with_response(uint16_t conn_id, uint16_t handle, const uint8_t *data, size_t length) {
+    (void)conn_id;
+    (void)handle;
+    if (length < 12) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint16_t seq = data[8] | (data[9] << 8);
+    camera_mode_switch_response_frame_t response = { .ret_code = 0 };
+    uint8_t frame[FAKE_CAMERA_MAX_FRAME];
+    size_t frame_length = fake_camera_build_frame(0x20, seq, 0x1D, 0x04, &response, sizeof(response), frame);
+    uint64_t delay = s_delay_us + (s_jitter_us ? (uint64_t)(rand() % s_jitter_us) : 0);
+    fake_camera_schedule(frame, frame_length, fake_camera_now_us() + delay);
+    return ESP_OK;
+}
+
+esp_err_t ble_write_without_response(uint16_t conn_id, uint16_t handle, const uint8_t *data, size_t length) {
+    (void)conn_id;
+    (void)handle;
+    (void)data;
+    (void)length;
+    return ESP_OK;
+}
+
+esp_err_t ble_write_without_response_prio(uint16_t conn_id, uint16_t handle, const uint8_t *data, size_t length,
+                                          ble_tx_prio_t prio) {
+    (void)prio;
+    return ble_write_without_response(conn_id, handle, data, length);
+}
@@ -0,0 +1,61 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Simulated camera for the data layer host tests.
+ * 数据层主机测试使用的模拟相机。
+ *
+ * Provides the ble_write_* functions data.c links against. Every write with response is
+ * answered with a 0x1D04 response carrying the same seq after the configured link delay.
+ * Frames are delivered from a separate thread through receive_camera_notify_handler,
+ * the same entry point the GATTC notify callback uses.
+ * 提供 data.c 所链接的 ble_write_* 函数。每次有响应写入都会在设定的链路延迟后收到一个相同 seq 的
+ * 0x1D04 应答。帧由独立线程经 receive_camera_notify_handler 送入，与 GATTC notify 回调入口相同。
+ */
+
+#ifndef FAKE_CAMERA_H
+#define FAKE_CAMERA_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define FAKE_CAMERA_MAX_FRAME 256
+
+uint64_t fake_camera_now_us(void);
+
+size_t fake_camera_build_frame(uint8_t cmd_type, uint16_t seq, uint8_t cmd_set, uint8_t cmd_id,
+                               const void *payload, size_t payload_length, uint8_t *out);
+
+void fake_camera_start(void);
+
+void fake_camera_set_link_delay(uint32_t delay_us, uint32_t jitter_us);
+
+/* Queue a frame for delivery at due_us; frames are delivered in the order they were queued */
+/* 排队一帧在 due_us 时刻送达；按入队顺序送达 */
+void fake_camera_schedule(const uint8_t *frame, size_t length, uint64_t due_us);
+
+/* Block until every queued frame has been handed to the data layer */
+/* 阻塞直到所有排队的帧都已交给数据层 */
+void fake_camera_flush(void);
+
+/* Timestamp taken right before the last frame entered the data layer */
+/* 最近一帧进入数据层之前的时间戳 */
+uint64_t fake_camera_last_delivery_us(void);
+
+#endif
@@ -0,0 +1,241 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Test and benchmark of the RX/TX frame tracer in data/frame_trace.c.
+ * data/frame_trace.c 中收发帧跟踪器的测试与基准。
+ *
+ * Checks that nothing is captured below FRAME_TRACE_FULL, then has four threads capture frames
+ * while a fifth drains: every drained record must be intact, each producer's frames must come
+ * out in order, and drained + dropped must equal captured. Finally times the per-frame cost of
+ * the tracer at each level against the previous printf hex dump (sent to /dev/null).
+ * 检查低于 FRAME_TRACE_FULL 时不捕获任何内容；随后四个线程并发捕获、第五个线程读取：读出的每条记录必须完整，
+ * 每个生产者的帧必须按序输出，且读出数 + 丢弃数必须等于捕获数。最后测量各级别下跟踪器的每帧开销，
+ * 并与旧的 printf 十六进制打印（输出到 /dev/null）对比。
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "frame_trace.h"
+
+#define PRODUCERS        4
+#define DEFAULT_FRAMES   50000   // Per producer / 每个生产者
+#define BENCH_FRAMES     200000
+#define MAX_FRAME        160
+
+static volatile int s_producers_done;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* Frame i of a producer: SOF, producer id, 32-bit counter, then a pattern derived from both */
+/* 生产者的第 i 帧：SOF、生产者编号、32 位计数，其后为由两者导出的填充 */
+static size_t build_frame(uint8_t *frame, int producer, uint32_t counter) {
+    size_t length = 16 + (counter * 7 + producer) % (MAX_FRAME - 16);
+    frame[0] = 0xAA;
+    frame[1] = (uint8_t)producer;
+    memcpy(&frame[2], &counter, sizeof(counter));
+    for (size_t i = 6; i < length; i++) {
+        frame[i] = (uint8_t)(producer * 31 + counter + i);
+    }
+    return length;
+}
+
+static int record_is_intact(const frame_trace_record_t *record, int *producer, uint32_t *counter) {
+    uint8_t expected[MAX_FRAME];
+    if (record->captured < 6 || record->data[0] != 0xAA || record->data[1] >= PRODUCERS) {
+        return 0;
+    }
+    *producer = record->data[1];
+    memcpy(counter, &record->data[2], sizeof(*counter));
+    size_t length = build_frame(expected, *producer, *counter);
+    size_t captured = length < FRAME_TRACE_CAPTURE_BYTES ? length : FRAME_TRACE_CAPTURE_BYTES;
+    return record->length == length && record->captured == captured &&
+           record->dir == (*producer & 1 ? FRAME_TRACE_TX : FRAME_TRACE_RX) &&
+           memcmp(record->data, expected, captured) == 0;
+}
+
+static void *producer_thread(void *arg) {
+    int producer = (int)(intptr_t)arg;
+    int frames = DEFAULT_FRAMES;
+    uint8_t frame[MAX_FRAME];
+    for (int i = 0; i < frames; i++) {
+        size_t length = build_frame(frame, producer, (uint32_t)i);
+        frame_trace(producer & 1 ? FRAME_TRACE_TX : FRAME_TRACE_RX, frame, length);
+        if ((i & 63) == 0) {
+            sched_yield();
+        }
+    }
+    __atomic_fetch_add(&s_producers_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static int check_levels(void) {
+    frame_trace_record_t record;
+    uint8_t frame[MAX_FRAME];
+    size_t length = build_frame(frame, 0, 1);
+
+    frame_trace_set_level(FRAME_TRACE_OFF);
+    frame_trace(FRAME_TRACE_RX, frame, length);
+    frame_trace_set_level(FRAME_TRACE_HEADERS);
+    frame_trace(FRAME_TRACE_RX, frame, length);
+    if (frame_trace_drain(&record, 1) != 0) {
+        printf("FAIL: frames captured below FRAME_TRACE_FULL\n");
+        return -1;
+    }
+
+    frame_trace_set_level(FRAME_TRACE_FULL);
+    frame_trace(FRAME_TRACE_RX, frame, length);
+    int producer;
+    uint32_t counter;
+    if (frame_trace_drain(&record, 1) != 1 || !record_is_intact(&record, &producer, &counter) || counter != 1) {
+        printf("FAIL: single captured frame not returned intact\n");
+        return -1;
+    }
+    return 0;
+}
+
+static int check_concurrent_capture(void) {
+    pthread_t threads[PRODUCERS];
+    uint32_t next_counter[PRODUCERS] = { 0 };
+    frame_trace_record_t records[8];
+    unsigned long drained = 0;
+    uint32_t dropped_before = frame_trace_dropped_count();
+
+    frame_trace_set_level(FRAME_TRACE_FULL);
+    s_producers_done = 0;
+    for (int p = 0; p < PRODUCERS; p++) {
+        pthread_create(&threads[p], NULL, producer_thread, (void *)(intptr_t)p);
+    }
+
+    for (;;) {
+        int done = __atomic_load_n(&s_producers_done, __ATOMIC_ACQUIRE) == PRODUCERS;
+        size_t count = frame_trace_drain(records, sizeof(records) / sizeof(records[0]));
+        for (size_t i = 0; i < count; i++) {
+            int producer;
+            uint32_t counter;
+            if (!record_is_intact(&records[i], &producer, &counter)) {
+                printf("FAIL: torn record after %lu drained\n", drained);
+                return -1;
+            }
+            if (counter < next_counter[producer]) {
+                printf("FAIL: producer %d frame %u out of order\n", producer, (unsigned)counter);
+                return -1;
+            }
+            next_counter[producer] = counter + 1;
+            drained++;
+        }
+        if (done && count == 0) {
+            break;
+        }
+    }
+
+    for (int p = 0; p < PRODUCERS; p++) {
+        pthread_join(threads[p], NULL);
+    }
+
+    unsigned long total = (unsigned long)PRODUCERS * DEFAULT_FRAMES;
+    unsigned long dropped = frame_trace_dropped_count() - dropped_before;
+    printf("concurrent capture: %lu frames, %lu drained, %lu dropped\n", total, drained, dropped);
+    if (drained + dropped != total) {
+        printf("FAIL: drained + dropped != captured\n");
+        return -1;
+    }
+    return 0;
+}
+
+/* ---------- benchmark ---------- */
+
+static void previous_hex_dump(const uint8_t *raw_data, size_t raw_data_length) {
+    printf("\033[95m");
+    printf("RX: [");
+    for (size_t i = 0; i < raw_data_length; i++) {
+        printf("%02X", raw_data[i]);
+        if (i < raw_data_length - 1) {
+            printf(", ");
+        }
+    }
+    printf("] (%zu bytes)\n", raw_data_length);
+    printf("\033[0m");
+    printf("\033[0;32m");
+}
+
+static double time_tracer(frame_trace_level_t level, const uint8_t *frame, size_t length) {
+    frame_trace_record_t records[16];
+    frame_trace_set_level(level);
+    double start = now_ns();
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        frame_trace(FRAME_TRACE_RX, frame, length);
+    }
+    double elapsed = now_ns() - start;
+    while (frame_trace_drain(records, 16) > 0) {
+    }
+    return elapsed / BENCH_FRAMES;
+}
+
+static void run_bench(void) {
+    uint8_t frame[MAX_FRAME];
+    size_t length = build_frame(frame, 0, 3);   // 37 bytes, about a 0x1D02 status push / 37 字节，接近 0x1D02 状态推送
+
+    // Console output goes to /dev/null so only the formatting and stdio cost is measured
+    // 控制台输出重定向到 /dev/null，只测量格式化与 stdio 的开销
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    dup2(null_fd, STDOUT_FILENO);
+    double start = now_ns();
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        previous_hex_dump(frame, length);
+    }
+    fflush(stdout);
+    double printf_ns = (now_ns() - start) / BENCH_FRAMES;
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(null_fd);
+    close(saved_stdout);
+
+    double off_ns = time_tracer(FRAME_TRACE_OFF, frame, length);
+    double full_ns = time_tracer(FRAME_TRACE_FULL, frame, length);
+
+    printf("\n%zu-byte frame, ns per frame on the RX/TX path\n", length);
+    printf("  printf hex dump (previous)   %8.1f\n", printf_ns);
+    printf("  frame_trace off              %8.1f\n", off_ns);
+    printf("  frame_trace full (capture)   %8.1f\n", full_ns);
+}
+
+int main(int argc, char **argv) {
+    if (check_levels() != 0 || check_concurrent_capture() != 0) {
+        return 1;
+    }
+    printf("PASS\n");
+
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        run_bench();
+    }
+    return 0;
+}
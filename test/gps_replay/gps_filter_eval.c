@@ -0,0 +1,424 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Offline evaluation of the GPS position/velocity filter (logic/gps_filter.c) against the true track.
+ * GPS 位置/速度滤波器（logic/gps_filter.c）相对真实轨迹的离线评估。
+ *
+ * The NMEA log is tokenized with nmea_scan_buffer and RMC/GGA are paired on their UTC time the way
+ * gps_logic does. Every fix goes through two paths:
+ * - raw: a reference copy of the previous gps_logic output, i.e. the mean of the RMC and GGA positions,
+ *   velocity from RMC speed and course, descent from the GGA altitude difference, a fixed degree
+ *   outlier threshold and hard-coded 1000 mm / 1000 mm / 10 cm/s accuracies;
+ * - filtered: gps_filter_update with its default measurement sigmas, accuracies from its covariance;
+ * - receiver sigmas: the same filter with the sigmas gps_logic now takes from GST, GSA and the GGA HDOP.
+ * Both are compared with the truth file written by nmea_log_gen. The process exits non-zero if the
+ * filter is not more accurate than the raw output in position, altitude and velocity.
+ * 用 nmea_scan_buffer 对 NMEA 日志分词，并像 gps_logic 一样按 UTC 时间配对 RMC/GGA。每次定位走两条路径：
+ * - raw：旧 gps_logic 输出的参考实现，即 RMC 与 GGA 位置的平均值、由 RMC 速度与航向得到的速度、由 GGA 高度差
+ *   得到的下降速度、固定度数的异常阈值，以及写死的 1000 mm / 1000 mm / 10 cm/s 精度；
+ * - filtered：使用默认测量 sigma 的 gps_filter_update，精度取自其协方差；
+ * - receiver sigmas：同一滤波器，使用 gps_logic 现从 GST、GSA 与 GGA HDOP 获取的 sigma。
+ * 两者都与 nmea_log_gen 写出的真实轨迹对比。若滤波器在位置、高度和速度上不比 raw 输出更准确，进程返回非零值。
+ *
+ * Usage / 用法: gps_filter_eval <log.nmea> <truth.txt>
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "nmea_parser.h"
+#include "gps_filter.h"
+
+#define WGS84_A_M   6378137.0
+#define WGS84_E2    6.69437999014e-3
+
+/* Outlier thresholds of the previous gps_logic, 0.009 and 0.0127 degrees */
+/* 旧 gps_logic 的异常阈值，0.009 度和 0.0127 度 */
+#define OLD_OUTLIER_LATITUDE_E7  90000
+#define OLD_OUTLIER_LONGITUDE_E7 127000
+
+typedef struct {
+    double latitude;
+    double longitude;
+    double altitude;
+    double v_north;
+    double v_east;
+    double v_descend;
+    int present;
+} truth_t;
+
+/* Errors of one output path against the truth */
+/* 一条输出路径相对真实值的误差 */
+typedef struct {
+    const char *name;
+    size_t fixes;
+    size_t withheld;            // Fixes not pushed (outlier)
+                                // 未推送的定位（异常值）
+    double *horizontal;         // Horizontal error of every pushed fix (m)
+                                // 每个推送定位的水平误差 (m)
+    double sum_h2, sum_v2, sum_vel2, sum_descend2;
+    size_t within_h, within_v, within_speed;
+} path_stats_t;
+
+/* One fix as paired from RMC and GGA */
+/* 由 RMC 与 GGA 配对得到的一次定位 */
+typedef struct {
+    int32_t rmc_time_ms, gga_time_ms;
+    int rmc_valid, gga_valid;
+    int32_t rmc_latitude_e7, rmc_longitude_e7, gga_latitude_e7, gga_longitude_e7;
+    int32_t speed_mknots, course_cdeg, altitude_mm;
+} pairing_t;
+
+static truth_t *s_truth;
+static int s_period_ms;
+static size_t s_slots;
+static pairing_t s_pair = { -1, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+static gps_filter_t s_filter, s_receiver_filter;
+static gps_receiver_accuracy_t s_accuracy;
+static int32_t s_last_sentence_time_ms = -1;
+static double s_filter_ns;
+static size_t s_filter_calls;
+
+/* State of the raw reference path */
+/* raw 参考路径的状态 */
+static int32_t s_old_previous_latitude_e7, s_old_previous_longitude_e7;
+static int32_t s_old_previous_altitude_mm, s_old_previous_time_ms = -1;
+static float s_old_descend;
+
+static path_stats_t s_raw = { .name = "raw" }, s_filtered = { .name = "filtered" },
+                    s_receiver = { .name = "receiver sigmas" };
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int32_t time_of_day_ms(uint8_t hour, uint8_t minute, uint8_t second, uint16_t millisecond) {
+    return ((hour * 60 + minute) * 60 + second) * 1000 + millisecond;
+}
+
+static int read_coordinate(const nmea_sentence_t *s, uint8_t value, uint8_t hemisphere, char negative, int32_t *out) {
+    int32_t v;
+    char h = nmea_field_char(s, hemisphere);
+    if (!nmea_field_degrees_e7(s, value, &v) || h == '\0') {
+        return 0;
+    }
+    *out = (h == negative) ? -v : v;
+    return 1;
+}
+
+static void record(path_stats_t *path, const truth_t *t, int32_t latitude_e7, int32_t longitude_e7, int32_t altitude_mm,
+                   float v_north, float v_east, float v_descend, uint32_t h_acc_mm, uint32_t v_acc_mm, uint32_t speed_acc_cm_s) {
+    double phi = t->latitude * M_PI / 180.0;
+    double w2 = 1.0 - WGS84_E2 * sin(phi) * sin(phi);
+    double meridian = WGS84_A_M * (1.0 - WGS84_E2) / (w2 * sqrt(w2));
+    double prime_vertical = WGS84_A_M / sqrt(w2);
+
+    double d_north = (latitude_e7 * 1e-7 - t->latitude) * M_PI / 180.0 * meridian;
+    double d_east = (longitude_e7 * 1e-7 - t->longitude) * M_PI / 180.0 * prime_vertical * cos(phi);
+    double d_up = altitude_mm * 1e-3 - t->altitude;
+    double e_vn = v_north - t->v_north, e_ve = v_east - t->v_east, e_vd = v_descend - t->v_descend;
+
+    double h = sqrt(d_north * d_north + d_east * d_east);
+    double speed_error = sqrt(e_vn * e_vn + e_ve * e_ve + e_vd * e_vd);
+    path->horizontal[path->fixes++] = h;
+    path->sum_h2 += h * h;
+    path->sum_v2 += d_up * d_up;
+    path->sum_vel2 += e_vn * e_vn + e_ve * e_ve;
+    path->sum_descend2 += e_vd * e_vd;
+    path->within_h += h <= h_acc_mm * 1e-3;
+    path->within_v += fabs(d_up) <= v_acc_mm * 1e-3;
+    path->within_speed += speed_error <= speed_acc_cm_s * 1e-2;
+}
+
+/* Reference copy of the previous complete_gps_fix and velocity code */
+/* 旧 complete_gps_fix 与速度计算的参考实现 */
+static void raw_fix(const truth_t *t, int32_t time_ms) {
+    int32_t latitude = (int32_t)(((int64_t)s_pair.rmc_latitude_e7 + s_pair.gga_latitude_e7) / 2);
+    int32_t longitude = (int32_t)(((int64_t)s_pair.rmc_longitude_e7 + s_pair.gga_longitude_e7) / 2);
+
+    float speed_m_s = (float)s_pair.speed_mknots * 0.000514444f;
+    float course_rad = (float)s_pair.course_cdeg * ((float)M_PI / 18000.0f);
+    float v_north = speed_m_s * cosf(course_rad), v_east = speed_m_s * sinf(course_rad);
+
+    if (s_old_previous_time_ms >= 0) {
+        int32_t dt = time_ms - s_old_previous_time_ms;
+        if (dt < -43200000) {
+            dt += 86400000;
+        } else if (dt > 43200000) {
+            dt -= 86400000;
+        }
+        int32_t da = s_pair.altitude_mm - s_old_previous_altitude_mm;
+        if (dt > 0 && dt < 10000 && abs(da) < 100000) {
+            s_old_descend = -(float)da / (float)dt;
+        }
+    }
+    s_old_previous_altitude_mm = s_pair.altitude_mm;
+    s_old_previous_time_ms = time_ms;
+
+    int outlier = llabs((int64_t)latitude - s_old_previous_latitude_e7) > OLD_OUTLIER_LATITUDE_E7 ||
+                  llabs((int64_t)longitude - s_old_previous_longitude_e7) > OLD_OUTLIER_LONGITUDE_E7;
+    s_old_previous_latitude_e7 = latitude;
+    s_old_previous_longitude_e7 = longitude;
+    if (outlier) {
+        s_raw.withheld++;
+        return;
+    }
+    record(&s_raw, t, latitude, longitude, s_pair.altitude_mm, v_north, v_east, s_old_descend, 1000, 1000, 10);
+}
+
+static void filtered_fix(const truth_t *t, int32_t time_ms, int receiver_sigmas) {
+    float speed_m_s = (float)s_pair.speed_mknots * 0.000514444f;
+    float course_rad = (float)s_pair.course_cdeg * ((float)M_PI / 18000.0f);
+    gps_filter_measurement_t m = {
+        .time_ms = time_ms,
+        .latitude_e7 = (int32_t)(((int64_t)s_pair.rmc_latitude_e7 + s_pair.gga_latitude_e7) / 2),
+        .longitude_e7 = (int32_t)(((int64_t)s_pair.rmc_longitude_e7 + s_pair.gga_longitude_e7) / 2),
+        .altitude_mm = s_pair.altitude_mm,
+        .has_velocity = true,
+        .velocity_north = speed_m_s * cosf(course_rad),
+        .velocity_east = speed_m_s * sinf(course_rad),
+    };
+    gps_filter_output_t out;
+    path_stats_t *path = receiver_sigmas ? &s_receiver : &s_filtered;
+    double start = now_ns();
+    if (receiver_sigmas) {
+        gps_filter_measurement_sigmas(&s_accuracy, &m);
+    }
+    int result = gps_filter_update(receiver_sigmas ? &s_receiver_filter : &s_filter, &m, &out);
+    if (!receiver_sigmas) {
+        s_filter_ns += now_ns() - start;
+        s_filter_calls++;
+    }
+    if (result != 0) {
+        path->withheld++;
+        return;
+    }
+    record(path, t, out.latitude_e7, out.longitude_e7, out.altitude_mm, out.velocity_north, out.velocity_east,
+           out.velocity_descend, out.horizontal_accuracy_mm, out.vertical_accuracy_mm, out.speed_accuracy_cm_s);
+}
+
+static void handle_sentence(const nmea_sentence_t *s, void *ctx) {
+    uint8_t hour, minute, second;
+    uint16_t millisecond;
+    int32_t quality, fix_type, lat, lon, alt;
+    if (!nmea_talker_is_gnss(s)) {
+        return;
+    }
+    // Error estimates, as Parse_GNGGA / Parse_GNGSA / Parse_GNGST keep them
+    // 误差估计，与 Parse_GNGGA / Parse_GNGSA / Parse_GNGST 的处理方式相同
+    if (s->id == NMEA_SENTENCE_GSA) {
+        if (nmea_field_int(s, 1, &fix_type) && fix_type >= 2 && s_last_sentence_time_ms >= 0 &&
+            nmea_field_fixed(s, 15, 2, &s_accuracy.hdop_x100)) {
+            nmea_field_fixed(s, 14, 2, &s_accuracy.pdop_x100);
+            if (fix_type < 3 || !nmea_field_fixed(s, 16, 2, &s_accuracy.vdop_x100)) {
+                s_accuracy.vdop_x100 = 0;
+            }
+            s_accuracy.gsa_time_ms = s_last_sentence_time_ms;
+        }
+        return;
+    }
+    if (s->id == NMEA_SENTENCE_GST) {
+        if (nmea_field_time(s, 0, &hour, &minute, &second, &millisecond) && nmea_field_fixed(s, 5, 3, &lat) &&
+            nmea_field_fixed(s, 6, 3, &lon) && nmea_field_fixed(s, 7, 3, &alt)) {
+            s_accuracy.latitude_sigma_mm = lat;
+            s_accuracy.longitude_sigma_mm = lon;
+            s_accuracy.altitude_sigma_mm = alt;
+            s_accuracy.gst_time_ms = time_of_day_ms(hour, minute, second, millisecond);
+        }
+        return;
+    }
+    if (s->id == NMEA_SENTENCE_RMC) {
+        s_pair.rmc_time_ms = nmea_field_time(s, 0, &hour, &minute, &second, &millisecond) ?
+                             time_of_day_ms(hour, minute, second, millisecond) : -1;
+        if (s_pair.rmc_time_ms >= 0) {
+            s_last_sentence_time_ms = s_pair.rmc_time_ms;
+        }
+        s_pair.rmc_valid = nmea_field_char(s, 1) == 'A';
+        read_coordinate(s, 2, 3, 'S', &s_pair.rmc_latitude_e7);
+        read_coordinate(s, 4, 5, 'W', &s_pair.rmc_longitude_e7);
+        nmea_field_fixed(s, 6, 3, &s_pair.speed_mknots);
+        nmea_field_fixed(s, 7, 2, &s_pair.course_cdeg);
+    } else if (s->id == NMEA_SENTENCE_GGA) {
+        s_pair.gga_time_ms = nmea_field_time(s, 0, &hour, &minute, &second, &millisecond) ?
+                             time_of_day_ms(hour, minute, second, millisecond) : -1;
+        if (s_pair.gga_time_ms >= 0) {
+            s_last_sentence_time_ms = s_pair.gga_time_ms;
+        }
+        s_accuracy.gga_time_ms = -1;
+        if (s_pair.gga_time_ms >= 0 && nmea_field_fixed(s, 7, 2, &s_accuracy.gga_hdop_x100)) {
+            s_accuracy.gga_time_ms = s_pair.gga_time_ms;
+        }
+        read_coordinate(s, 1, 2, 'S', &s_pair.gga_latitude_e7);
+        read_coordinate(s, 3, 4, 'W', &s_pair.gga_longitude_e7);
+        s_pair.gga_valid = nmea_field_int(s, 5, &quality) && quality > 0;
+        nmea_field_fixed(s, 8, 3, &s_pair.altitude_mm);
+    } else {
+        return;
+    }
+    if (s_pair.rmc_time_ms < 0 || s_pair.rmc_time_ms != s_pair.gga_time_ms) {
+        return;
+    }
+    int32_t time_ms = s_pair.rmc_time_ms;
+    s_pair.rmc_time_ms = s_pair.gga_time_ms = -1;
+    if (!s_pair.rmc_valid || !s_pair.gga_valid) {
+        return;
+    }
+    size_t slot = (size_t)(time_ms / s_period_ms);
+    if (slot >= s_slots || !s_truth[slot].present) {
+        return;
+    }
+    raw_fix(&s_truth[slot], time_ms);
+    filtered_fix(&s_truth[slot], time_ms, 0);
+    filtered_fix(&s_truth[slot], time_ms, 1);
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(double *values, size_t count, double p) {
+    if (count == 0) {
+        return 0.0;
+    }
+    qsort(values, count, sizeof(double), compare_double);
+    size_t index = (size_t)(p * (count - 1) + 0.5);
+    return values[index];
+}
+
+static void print_path(path_stats_t *path) {
+    double n = path->fixes ? (double)path->fixes : 1.0;
+    double p95 = percentile(path->horizontal, path->fixes, 0.95);
+    double max = path->fixes ? path->horizontal[path->fixes - 1] : 0.0;
+    printf("| %-15s | %6zu | %4zu | %6.2f | %6.2f | %6.2f | %6.2f | %6.3f | %6.3f | %5.1f%% | %5.1f%% | %5.1f%% |\n",
+           path->name, path->fixes, path->withheld, sqrt(path->sum_h2 / n), p95, max, sqrt(path->sum_v2 / n),
+           sqrt(path->sum_vel2 / n), sqrt(path->sum_descend2 / n), 100.0 * path->within_h / n,
+           100.0 * path->within_v / n, 100.0 * path->within_speed / n);
+}
+
+static char *read_file(const char *path, size_t *size) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    *size = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *data = malloc(*size + 1);
+    if (fread(data, 1, *size, f) != *size) {
+        fclose(f);
+        free(data);
+        return NULL;
+    }
+    fclose(f);
+    data[*size] = '\0';
+    return data;
+}
+
+static int load_truth(const char *path) {
+    size_t size;
+    char *text = read_file(path, &size);
+    if (text == NULL) {
+        return 0;
+    }
+    int rate = 0;
+    if (sscanf(text, "# rate_hz %d", &rate) != 1 || rate <= 0 || rate > 20) {
+        fprintf(stderr, "%s: missing rate header\n", path);
+        free(text);
+        return 0;
+    }
+    s_period_ms = 1000 / rate;
+    s_slots = 86400000 / (size_t)s_period_ms;
+    s_truth = calloc(s_slots, sizeof(truth_t));
+
+    for (char *line = strtok(text, "\n"); line != NULL; line = strtok(NULL, "\n")) {
+        long time_ms;
+        truth_t t;
+        if (line[0] == '#' || sscanf(line, "%ld %lf %lf %lf %lf %lf %lf", &time_ms, &t.latitude, &t.longitude,
+                                     &t.altitude, &t.v_north, &t.v_east, &t.v_descend) != 7) {
+            continue;
+        }
+        size_t slot = (size_t)(time_ms / s_period_ms);
+        if (slot < s_slots) {
+            t.present = 1;
+            s_truth[slot] = t;
+        }
+    }
+    free(text);
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <log.nmea> <truth.txt>\n", argv[0]);
+        return 2;
+    }
+    if (!load_truth(argv[2])) {
+        return 2;
+    }
+    size_t size;
+    char *log = read_file(argv[1], &size);
+    if (log == NULL) {
+        return 2;
+    }
+    size_t max_fixes = size / 64 + 1;
+    s_raw.horizontal = malloc(max_fixes * sizeof(double));
+    s_filtered.horizontal = malloc(max_fixes * sizeof(double));
+    s_receiver.horizontal = malloc(max_fixes * sizeof(double));
+    gps_filter_reset(&s_filter);
+    gps_filter_reset(&s_receiver_filter);
+    gps_receiver_accuracy_reset(&s_accuracy);
+
+    nmea_scan_buffer(log, size, handle_sentence, NULL, NULL);
+
+    printf("Errors against the true track; accuracy columns are the share of fixes within the reported accuracy\n");
+    printf("与真实轨迹的误差；精度列为误差不超过所报告精度的定位占比\n\n");
+    printf("| Path            | Pushed | Held | H RMS m | H p95 m | H max m | V RMS m | Vel RMS m/s | Descend RMS m/s | in h_acc | in v_acc | in s_acc |\n");
+    printf("|---|---|---|---|---|---|---|---|---|---|---|---|\n");
+    double raw_h = sqrt(s_raw.sum_h2 / (s_raw.fixes ? s_raw.fixes : 1));
+    double raw_v = sqrt(s_raw.sum_v2 / (s_raw.fixes ? s_raw.fixes : 1));
+    double raw_vel = sqrt(s_raw.sum_vel2 / (s_raw.fixes ? s_raw.fixes : 1));
+    double raw_descend = sqrt(s_raw.sum_descend2 / (s_raw.fixes ? s_raw.fixes : 1));
+    print_path(&s_raw);
+    print_path(&s_filtered);
+    print_path(&s_receiver);
+    printf("\nfilter: %zu updates, %.1f ns/update, %lu rejected, %lu restarts\n", s_filter_calls,
+           s_filter_calls ? s_filter_ns / s_filter_calls : 0.0, (unsigned long)s_filter.rejected,
+           (unsigned long)s_filter.restarts);
+
+    int failed = 0;
+    const path_stats_t *paths[] = { &s_filtered, &s_receiver };
+    for (size_t i = 0; i < 2; i++) {
+        double n = paths[i]->fixes ? (double)paths[i]->fixes : 1.0;
+        failed |= paths[i]->fixes == 0 ||
+                  sqrt(paths[i]->sum_h2 / n) >= raw_h || sqrt(paths[i]->sum_v2 / n) >= raw_v ||
+                  sqrt(paths[i]->sum_vel2 / n) >= raw_vel || sqrt(paths[i]->sum_descend2 / n) >= raw_descend;
+    }
+    printf("%s\n", failed ? "FAILED: filter is not more accurate than the raw output" : "PASSED");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,331 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Replays an NMEA log through the real gps_logic.c on the host, as a benchmark and a regression test.
+ * 在主机上让 NMEA 日志经过真实的 gps_logic.c 回放，用作基准测试和回归测试。
+ *
+ * gps_logic.c, nmea_parser.c and gps_filter.c are linked unchanged against the FreeRTOS and UART
+ * stubs in test/host_stubs. The push scheduler, the connection state and the BLE command are
+ * replaced here: every frame gps_logic publishes is recorded instead of sent. The log is fed to
+ * Parse_NMEA_Buffer one line at a time, the way rx_task_GPS reads it on each '\n' pattern event.
+ * gps_logic.c、nmea_parser.c 与 gps_filter.c 原样链接到 test/host_stubs 中的 FreeRTOS 与 UART 替代实现。
+ * 推送调度、连接状态与 BLE 命令在此替换：gps_logic 发布的每一帧都被记录而不是发送。日志按行送入
+ * Parse_NMEA_Buffer，与 rx_task_GPS 在每个 '\n' 模式检测事件上的读取方式相同。
+ *
+ * It reports sentences/s, fixes accepted and rejected by the filter, epochs without a fix, and the CPU
+ * time per fix, i.e. all parsing since the previous fix. The published frames are printed as text with
+ * the velocities rounded to 0.1 cm/s and hashed (FNV-1a 64). Against a golden file the run fails if the
+ * count or the hash differs, and the sampled frames show where the output first changed. Given
+ * "write", the golden file is regenerated instead.
+ * 输出语句每秒处理数、被滤波器接受与剔除的定位数、无定位的历元数，以及每次定位的 CPU 时间（即自上次定位以来
+ * 的全部解析）。发布的帧格式化为文本（速度四舍五入到 0.1 cm/s）并计算哈希（FNV-1a 64）。与黄金文件对比时，
+ * 帧数或哈希不同即失败，采样帧可定位输出首次变化的位置。指定 "write" 时改为重新生成黄金文件。
+ *
+ * Usage / 用法: gps_logic_replay <log.nmea> [golden_file [write]]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gps_logic.h"
+#include "gps_push.h"
+#include "connect_logic.h"
+#include "command_logic.h"
+
+/* One frame in GOLDEN_SAMPLE_EVERY is kept in the golden file */
+/* 黄金文件中每 GOLDEN_SAMPLE_EVERY 帧保留一帧 */
+#define GOLDEN_SAMPLE_EVERY 1000
+#define FRAME_TEXT_SIZE     160
+
+#define FNV_OFFSET_BASIS    0xcbf29ce484222325ULL
+#define FNV_PRIME           0x100000001b3ULL
+
+/* Frames published by gps_logic: count, hash, and the sampled frames */
+/* gps_logic 发布的帧：数量、哈希以及采样帧 */
+static size_t s_frames = 0;
+static uint64_t s_hash = FNV_OFFSET_BASIS;
+static char (*s_samples)[FRAME_TEXT_SIZE] = NULL;
+static size_t s_sample_capacity = 0;
+
+/* Frame published during the timed call, recorded after it so the recording is not timed */
+/* 计时调用中发布的帧，在调用结束后记录，记录开销不计入耗时 */
+static gps_data_push_command_frame s_pending;
+static int s_pending_count = 0;
+
+static void format_frame(const gps_data_push_command_frame *frame, char *out, size_t size) {
+    snprintf(out, size, "%ld %ld %ld %ld %ld %.1f %.1f %.1f %lu %lu %lu %lu",
+             (long)frame->year_month_day, (long)frame->hour_minute_second, (long)frame->gps_longitude,
+             (long)frame->gps_latitude, (long)frame->height, frame->speed_to_north, frame->speed_to_east,
+             frame->speed_to_wnward, (unsigned long)frame->vertical_accuracy,
+             (unsigned long)frame->horizontal_accuracy, (unsigned long)frame->speed_accuracy,
+             (unsigned long)frame->satellite_number);
+}
+
+static void record_frame(const gps_data_push_command_frame *frame) {
+    char text[FRAME_TEXT_SIZE];
+    format_frame(frame, text, sizeof(text));
+    for (const char *c = text; *c != '\0'; c++) {
+        s_hash = (s_hash ^ (uint8_t)*c) * FNV_PRIME;
+    }
+    s_hash = (s_hash ^ '\n') * FNV_PRIME;
+
+    if (s_frames % GOLDEN_SAMPLE_EVERY == 0) {
+        size_t slot = s_frames / GOLDEN_SAMPLE_EVERY;
+        if (slot >= s_sample_capacity) {
+            s_sample_capacity = s_sample_capacity ? s_sample_capacity * 2 : 256;
+            s_samples = realloc(s_samples, s_sample_capacity * sizeof(*s_samples));
+        }
+        memcpy(s_samples[slot], text, sizeof(text));
+    }
+    s_frames++;
+}
+
+/* Stand-ins for the push scheduler, the connection and the BLE command */
+/* 推送调度、连接与 BLE 命令的替代实现 */
+esp_err_t gps_push_init(gps_push_send_t send) {
+    return ESP_OK;
+}
+
+void gps_push_publish(const gps_data_push_command_frame *frame) {
+    s_pending = *frame;
+    s_pending_count++;
+}
+
+connect_state_t connect_logic_get_state(void) {
+    return PROTOCOL_CONNECTED;
+}
+
+void connect_logic_note_activity(link_activity_t activity) {
+}
+
+gps_data_push_response_frame *command_logic_push_gps_data(const gps_data_push_command_frame *gps_data) {
+    return NULL;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static char *read_file(const char *path, size_t *size) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    *size = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *data = malloc(*size + 1);
+    if (fread(data, 1, *size, f) != *size) {
+        fclose(f);
+        free(data);
+        return NULL;
+    }
+    fclose(f);
+    data[*size] = '\0';
+    return data;
+}
+
+static int write_golden(const char *path, const char *log_path) {
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        perror(path);
+        return 1;
+    }
+    fprintf(f, "# gps_logic_replay %s\n", log_path);
+    fprintf(f, "frames %zu\nfnv1a64 %016llx\nevery %d\n", s_frames, (unsigned long long)s_hash,
+            GOLDEN_SAMPLE_EVERY);
+    for (size_t i = 0; i * GOLDEN_SAMPLE_EVERY < s_frames; i++) {
+        fprintf(f, "%zu %s\n", i * GOLDEN_SAMPLE_EVERY, s_samples[i]);
+    }
+    fclose(f);
+    printf("golden: wrote %s\n", path);
+    return 0;
+}
+
+/**
+ * @brief Compare the run with a golden file
+ *        与黄金文件对比本次运行
+ *
+ * @return int 0 if identical, 1 otherwise
+ *             完全一致返回 0，否则返回 1
+ */
+static int check_golden(const char *path) {
+    size_t size;
+    char *text = read_file(path, &size);
+    if (text == NULL) {
+        return 1;
+    }
+    size_t frames = 0;
+    unsigned long long hash = 0;
+    int every = 0;
+    int failed = 0, first_reported = 0;
+    for (char *line = strtok(text, "\n"); line != NULL; line = strtok(NULL, "\n")) {
+        size_t index;
+        int offset;
+        if (line[0] == '#') {
+            continue;
+        } else if (sscanf(line, "frames %zu", &frames) == 1 || sscanf(line, "fnv1a64 %llx", &hash) == 1 ||
+                   sscanf(line, "every %d", &every) == 1) {
+            continue;
+        } else if (sscanf(line, "%zu %n", &index, &offset) == 1 && every == GOLDEN_SAMPLE_EVERY) {
+            const char *expected = line + offset;
+            const char *actual = index < s_frames ? s_samples[index / GOLDEN_SAMPLE_EVERY] : "(none)";
+            if (strcmp(expected, actual) != 0) {
+                failed = 1;
+                if (!first_reported) {
+                    first_reported = 1;
+                    printf("golden: first differing sample is frame %zu\n  expected %s\n  actual   %s\n",
+                           index, expected, actual);
+                }
+            }
+        }
+    }
+    free(text);
+
+    if (every != GOLDEN_SAMPLE_EVERY) {
+        printf("golden: %s sampled every %d frames, expected %d\n", path, every, GOLDEN_SAMPLE_EVERY);
+        return 1;
+    }
+    if (frames != s_frames || hash != s_hash) {
+        failed = 1;
+        printf("golden: expected %zu frames hash %016llx, got %zu frames hash %016llx\n", frames, hash, s_frames,
+               (unsigned long long)s_hash);
+        if (!first_reported) {
+            printf("golden: every sample matches, the change is between samples\n");
+        }
+    }
+    printf("golden: %s\n", failed ? "FAIL" : "PASS");
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || (argc > 3 && strcmp(argv[3], "write") != 0)) {
+        fprintf(stderr, "usage: %s <log.nmea> [golden_file [write]]\n", argv[0]);
+        return 2;
+    }
+    size_t size;
+    char *log = read_file(argv[1], &size);
+    if (log == NULL) {
+        return 1;
+    }
+
+    // Starts the receive task, which waits on the UART event queue for good, the log is fed directly
+    // 启动接收任务，它会一直等待 UART 事件队列，日志直接送入解析
+    initSendGpsDataToCameraTask();
+
+    size_t sentences = 0, epochs = 0, fix_capacity = 4096, fix_count = 0;
+    double *fix_ns = malloc(fix_capacity * sizeof(double));
+    double total_ns = 0.0, since_fix_ns = 0.0;
+    uint32_t accepted = 0, rejected = 0, restarts = 0, fixes_seen = 0;
+    int failed = 0;
+
+    const char *end = log + size;
+    for (const char *line = log; line < end;) {
+        const char *newline = memchr(line, '\n', (size_t)(end - line));
+        size_t length = newline != NULL ? (size_t)(newline - line) + 1 : (size_t)(end - line);
+        if (length > 6 && memcmp(line + 3, "RMC", 3) == 0) {
+            epochs++;
+        }
+        sentences++;
+
+        double start = now_ns();
+        Parse_NMEA_Buffer(line, length);
+        double elapsed = now_ns() - start;
+        total_ns += elapsed;
+        since_fix_ns += elapsed;
+
+        // One line completes at most one fix, so at most one frame was published
+        // 一行最多完成一次定位，因此最多发布一帧
+        if (s_pending_count > 0) {
+            if (s_pending_count > 1) {
+                printf("FAIL: %d frames published by one line\n", s_pending_count);
+                failed = 1;
+            }
+            record_frame(&s_pending);
+            s_pending_count = 0;
+        }
+
+        // A fix reached the filter, charge it everything parsed since the previous one
+        // 有定位进入滤波器，将自上次定位以来的全部解析计入本次定位
+        get_gps_filter_stats(&accepted, &rejected, &restarts);
+        if (accepted + rejected != fixes_seen) {
+            fixes_seen = accepted + rejected;
+            if (fix_count == fix_capacity) {
+                fix_capacity *= 2;
+                fix_ns = realloc(fix_ns, fix_capacity * sizeof(double));
+            }
+            fix_ns[fix_count++] = since_fix_ns;
+            since_fix_ns = 0.0;
+        }
+        line += length;
+    }
+
+    uint32_t good = 0, bad = 0, truncated = 0;
+    get_nmea_checksum_stats(&good, &bad, &truncated);
+    qsort(fix_ns, fix_count, sizeof(double), compare_double);
+    double fix_mean = fix_count ? total_ns / fix_count : 0.0;
+    double fix_p50 = fix_count ? fix_ns[fix_count / 2] : 0.0;
+    double fix_p99 = fix_count ? fix_ns[(size_t)(0.99 * (fix_count - 1) + 0.5)] : 0.0;
+    double fix_max = fix_count ? fix_ns[fix_count - 1] : 0.0;
+
+    printf("log: %s, %zu bytes, %zu sentences, %zu epochs\n", argv[1], size, sentences, epochs);
+    printf("parse: %.1f ms, %.1f ns/sentence, %.2f M sentences/s\n", total_ns / 1e6,
+           sentences ? total_ns / sentences : 0.0, total_ns > 0.0 ? sentences / total_ns * 1e3 : 0.0);
+    printf("checksum: %lu good, %lu bad, %lu truncated\n", (unsigned long)good, (unsigned long)bad,
+           (unsigned long)truncated);
+    printf("fixes: %lu accepted, %lu rejected, %lu filter restarts, %zu epochs without a fix\n",
+           (unsigned long)accepted, (unsigned long)rejected, (unsigned long)restarts,
+           epochs - (size_t)(accepted + rejected));
+    printf("published: %zu frames, fnv1a64 %016llx\n", s_frames, (unsigned long long)s_hash);
+    printf("cpu per fix: mean %.0f ns, p50 %.0f ns, p99 %.0f ns, max %.0f ns\n", fix_mean, fix_p50, fix_p99,
+           fix_max);
+
+    // Every accepted fix must be published, and a generated log has no checksum errors
+    // 每个被接受的定位都必须发布，生成的日志没有校验错误
+    if (s_frames != accepted) {
+        printf("FAIL: %zu frames published for %lu accepted fixes\n", s_frames, (unsigned long)accepted);
+        failed = 1;
+    }
+    if (bad != 0 || truncated != 0) {
+        printf("FAIL: checksum errors in the log\n");
+        failed = 1;
+    }
+    if (argc > 3) {
+        failed |= write_golden(argv[2], argv[1]);
+    } else if (argc > 2) {
+        failed |= check_golden(argv[2]);
+    }
+
+    free(fix_ns);
+    free(s_samples);
+    free(log);
+    return failed;
+}
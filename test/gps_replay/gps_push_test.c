@@ -0,0 +1,282 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Test for the GPS push scheduler (logic/gps_push.c) on the host FreeRTOS stubs.
+ * GPS 推送调度（logic/gps_push.c）在主机 FreeRTOS 替代实现上的测试。
+ *
+ * The main thread publishes fixes at 10 Hz, as the parser does, with a sequence number in
+ * year_month_day, while a fake send stands in for the BLE round trip. For each push rate it checks
+ * that publishing never waits for the send, that sends keep to the rate, that every send carries a
+ * newer fix than the last and no older than the one published just before it was taken, and that
+ * the counters account for every published fix. A stalled send with a silent receiver checks that
+ * a fix left over past GPS_PUSH_MAX_AGE_MS is dropped, and a disconnected camera that it is
+ * counted as not sent.
+ * 主线程像解析器一样以 10 Hz 发布定位，year_month_day 中存放序号，伪发送函数代替 BLE 往返。对每种推送频率
+ * 检查：发布从不等待发送，发送遵守频率，每次发送的定位都比上一次新、且不早于取出前刚发布的那个，计数能覆盖
+ * 每个发布的定位。发送卡顿且接收端静默时，检查超过 GPS_PUSH_MAX_AGE_MS 的残留定位被丢弃；相机断开时检查计为
+ * 未发送。
+ *
+ * Usage / 用法: gps_push_test [seconds_per_rate]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+#include "gps_push.h"
+
+#define PUBLISH_PERIOD_MS   100
+#define SEND_TIME_MS        30
+#define STALL_TIME_MS       1500
+#define DEFAULT_SECONDS     3
+#define MAX_SENDS           1024
+
+/* Fake BLE link state, read by the send function on the sender task */
+/* 伪 BLE 链路状态，由发送任务中的发送函数读取 */
+static int s_connected = 1;
+static int s_stall_next = 0;
+
+/* Newest sequence number published, and what the sender saw */
+/* 最新发布的序号，以及发送任务收到的内容 */
+static int32_t s_last_published = 0;
+static int32_t s_sent_seq[MAX_SENDS];
+static int32_t s_latest_at_send[MAX_SENDS];
+static int64_t s_sent_at_us[MAX_SENDS];
+static int s_send_count = 0;
+
+static int fake_send(const gps_data_push_command_frame *frame) {
+    if (!__atomic_load_n(&s_connected, __ATOMIC_ACQUIRE)) {
+        return -1;
+    }
+    int n = s_send_count;
+    if (n < MAX_SENDS) {
+        s_sent_seq[n] = frame->year_month_day;
+        s_latest_at_send[n] = __atomic_load_n(&s_last_published, __ATOMIC_ACQUIRE);
+        s_sent_at_us[n] = esp_timer_get_time();
+        __atomic_store_n(&s_send_count, n + 1, __ATOMIC_RELEASE);
+    }
+    if (__atomic_exchange_n(&s_stall_next, 0, __ATOMIC_ACQ_REL)) {
+        vTaskDelay(pdMS_TO_TICKS(STALL_TIME_MS));
+    } else {
+        vTaskDelay(pdMS_TO_TICKS(SEND_TIME_MS));
+    }
+    return 0;
+}
+
+static int64_t publish(int32_t seq) {
+    gps_data_push_command_frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.year_month_day = seq;
+    __atomic_store_n(&s_last_published, seq, __ATOMIC_RELEASE);
+    int64_t start = esp_timer_get_time();
+    gps_push_publish(&frame);
+    return esp_timer_get_time() - start;
+}
+
+/* Wait until the sender has taken what is left in the mailbox and finished sending it */
+/* 等待发送任务取走信箱中剩余的定位并发送完毕 */
+static void quiesce(void) {
+    vTaskDelay(pdMS_TO_TICKS(STALL_TIME_MS + 500));
+}
+
+static void reset_run(void) {
+    quiesce();
+    gps_push_reset_stats();
+    __atomic_store_n(&s_send_count, 0, __ATOMIC_RELEASE);
+}
+
+static int check_accounting(const char *name, const gps_push_stats_t *st) {
+    uint32_t total = st->coalesced + st->dropped_stale + st->sent + st->not_sent;
+    if (total != st->published) {
+        printf("  FAIL %s: coalesced %lu + stale %lu + sent %lu + not sent %lu != published %lu\n", name,
+               (unsigned long)st->coalesced, (unsigned long)st->dropped_stale, (unsigned long)st->sent,
+               (unsigned long)st->not_sent, (unsigned long)st->published);
+        return 1;
+    }
+    return 0;
+}
+
+static int run_rate(uint32_t rate, int seconds, int32_t *seq) {
+    int failures = 0;
+    reset_run();
+    gps_push_set_rate(rate);
+
+    int publishes = seconds * 1000 / PUBLISH_PERIOD_MS;
+    int64_t publish_max_us = 0;
+    for (int i = 0; i < publishes; i++) {
+        int64_t took = publish(++*seq);
+        if (took > publish_max_us) {
+            publish_max_us = took;
+        }
+        vTaskDelay(pdMS_TO_TICKS(PUBLISH_PERIOD_MS));
+    }
+    quiesce();
+
+    gps_push_stats_t st;
+    gps_push_get_stats(&st);
+    int sends = __atomic_load_n(&s_send_count, __ATOMIC_ACQUIRE);
+
+    /* Send starts may not come closer than one period, allow 2 ms of tick rounding */
+    /* 相邻两次发送开始的间隔不得小于一个周期，允许 2 ms 的节拍取整误差 */
+    int64_t period_us = 1000000 / rate;
+    int64_t min_gap_us = INT64_MAX;
+    int skipped = 0;
+    for (int i = 0; i < sends; i++) {
+        if (i > 0) {
+            int64_t gap = s_sent_at_us[i] - s_sent_at_us[i - 1];
+            if (gap < min_gap_us) {
+                min_gap_us = gap;
+            }
+            if (s_sent_seq[i] <= s_sent_seq[i - 1]) {
+                printf("  FAIL %u Hz: send %d carries fix %ld after fix %ld\n", (unsigned)rate, i,
+                       (long)s_sent_seq[i], (long)s_sent_seq[i - 1]);
+                failures++;
+            }
+        }
+        /* At most the fix published between taking it and calling send may be newer */
+        /* 最多只允许在取出与调用发送之间发布的那个定位更新 */
+        if (s_latest_at_send[i] - s_sent_seq[i] > 1) {
+            skipped++;
+        }
+    }
+    if (skipped > 0) {
+        printf("  FAIL %u Hz: %d sends were not the newest fix\n", (unsigned)rate, skipped);
+        failures++;
+    }
+    if (sends > 1 && min_gap_us < period_us - 2000) {
+        printf("  FAIL %u Hz: two sends %lld us apart, period is %lld us\n", (unsigned)rate,
+               (long long)min_gap_us, (long long)period_us);
+        failures++;
+    }
+    /* Rate over the span between the first and last send */
+    /* 按第一次与最后一次发送之间的时长计算频率 */
+    double achieved_hz = (sends > 1) ? (sends - 1) * 1e6 / (double)(s_sent_at_us[sends - 1] - s_sent_at_us[0]) : 0.0;
+    if (achieved_hz > rate * 1.02) {
+        printf("  FAIL %u Hz: sent at %.2f Hz\n", (unsigned)rate, achieved_hz);
+        failures++;
+    }
+    if (publish_max_us > 5000) {
+        printf("  FAIL %u Hz: gps_push_publish took %lld us\n", (unsigned)rate, (long long)publish_max_us);
+        failures++;
+    }
+    if (st.sent != (uint32_t)sends) {
+        printf("  FAIL %u Hz: stats report %lu sent, send was called %d times\n", (unsigned)rate,
+               (unsigned long)st.sent, sends);
+        failures++;
+    }
+    failures += check_accounting("rate", &st);
+
+    printf("  %2u Hz: published %4lu  sent %4lu (%.2f Hz)  coalesced %4lu  stale %lu  "
+           "publish max %lld us  fix age min/mean/max %lu/%lu/%lu us\n",
+           (unsigned)rate, (unsigned long)st.published, (unsigned long)st.sent, achieved_hz,
+           (unsigned long)st.coalesced, (unsigned long)st.dropped_stale, (long long)publish_max_us,
+           (unsigned long)st.age_min_us, (unsigned long)st.age_mean_us, (unsigned long)st.age_max_us);
+    return failures;
+}
+
+/* The send stalls and the receiver goes quiet, so the one fix published during the stall goes stale */
+/* 发送卡顿且接收端静默，卡顿期间发布的唯一定位因此过期 */
+static int run_stale(int32_t *seq) {
+    int failures = 0;
+    reset_run();
+    gps_push_set_rate(10);
+
+    __atomic_store_n(&s_stall_next, 1, __ATOMIC_RELEASE);
+    publish(++*seq);
+    vTaskDelay(pdMS_TO_TICKS(PUBLISH_PERIOD_MS));
+    int32_t stale_seq = ++*seq;
+    publish(stale_seq);
+    quiesce();
+
+    gps_push_stats_t st;
+    gps_push_get_stats(&st);
+    int sends = __atomic_load_n(&s_send_count, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < sends; i++) {
+        if (s_sent_seq[i] == stale_seq) {
+            printf("  FAIL stale: fix %ld was sent %lld ms after publishing\n", (long)stale_seq,
+                   (long long)(st.age_max_us / 1000));
+            failures++;
+        }
+    }
+    if (st.dropped_stale != 1) {
+        printf("  FAIL stale: %lu fixes dropped as stale, expected 1\n", (unsigned long)st.dropped_stale);
+        failures++;
+    }
+    failures += check_accounting("stale", &st);
+    printf("  stale: published %lu  sent %lu  dropped stale %lu\n", (unsigned long)st.published,
+           (unsigned long)st.sent, (unsigned long)st.dropped_stale);
+    return failures;
+}
+
+static int run_disconnected(int32_t *seq) {
+    int failures = 0;
+    reset_run();
+    gps_push_set_rate(10);
+
+    __atomic_store_n(&s_connected, 0, __ATOMIC_RELEASE);
+    for (int i = 0; i < 10; i++) {
+        publish(++*seq);
+        vTaskDelay(pdMS_TO_TICKS(PUBLISH_PERIOD_MS));
+    }
+    quiesce();
+    __atomic_store_n(&s_connected, 1, __ATOMIC_RELEASE);
+
+    gps_push_stats_t st;
+    gps_push_get_stats(&st);
+    if (st.sent != 0 || st.not_sent == 0) {
+        printf("  FAIL disconnected: sent %lu, not sent %lu\n", (unsigned long)st.sent, (unsigned long)st.not_sent);
+        failures++;
+    }
+    failures += check_accounting("disconnected", &st);
+    printf("  disconnected: published %lu  not sent %lu  coalesced %lu\n", (unsigned long)st.published,
+           (unsigned long)st.not_sent, (unsigned long)st.coalesced);
+    return failures;
+}
+
+int main(int argc, char **argv) {
+    int seconds = (argc > 1) ? atoi(argv[1]) : DEFAULT_SECONDS;
+    if (seconds < 1) {
+        seconds = 1;
+    }
+
+    if (gps_push_init(fake_send) != ESP_OK) {
+        printf("FAIL: gps_push_init\n");
+        return 1;
+    }
+
+    printf("GPS push scheduler, publishing at %d Hz, send takes %d ms, %d s per rate\n",
+           1000 / PUBLISH_PERIOD_MS, SEND_TIME_MS, seconds);
+
+    int failures = 0;
+    int32_t seq = 0;
+    static const uint32_t rates[] = {1, 5, 10};
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        failures += run_rate(rates[i], seconds, &seq);
+    }
+    failures += run_stale(&seq);
+    failures += run_disconnected(&seq);
+
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
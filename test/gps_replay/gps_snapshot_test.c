@@ -0,0 +1,197 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Stress test for the GPS fix snapshot (logic/gps_snapshot.c) with concurrent readers.
+ * GPS 定位快照（logic/gps_snapshot.c）的多读取方并发压力测试。
+ *
+ * One writer thread publishes fixes as fast as it can. Every field of fix n is derived from n, so a
+ * reader can tell from any one field which fix it should be looking at. Reader threads copy the
+ * snapshot in a loop and fail the test if a copy is not exactly fix n for some n, i.e. mixes two
+ * fixes, or if n goes backwards. The same writer and readers then run on a plain shared GPS_Data_t
+ * copied with memcpy, as gps_logic used to expose it, to show how often such a test sees tearing.
+ * 一个写入线程尽可能快地发布定位。第 n 个定位的每个字段都由 n 推出，读取方可由任一字段判断应看到哪一个定位。
+ * 读取线程循环拷贝快照；若拷贝结果不恰好等于某个第 n 个定位（即混合了两次定位），或 n 发生倒退，测试失败。
+ * 随后让同样的写入方与读取方作用于用 memcpy 拷贝的普通共享 GPS_Data_t（即 gps_logic 以前的暴露方式），
+ * 以显示这种测试检测到撕裂的频率。
+ *
+ * Usage / 用法: gps_snapshot_test [seconds_per_phase] [readers]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "gps_snapshot.h"
+
+#define DEFAULT_SECONDS 2
+#define DEFAULT_READERS 4
+#define MAX_READERS     16
+
+typedef struct {
+    uint64_t reads;
+    uint64_t torn;
+    uint64_t backwards;
+    uint64_t retries;
+} reader_stats_t;
+
+static gps_snapshot_t s_snapshot;
+static GPS_Data_t s_plain;              // Unsynchronized, for the comparison phase / 无同步，供对比阶段使用
+static int s_use_snapshot = 1;
+static int s_stop = 0;
+static uint32_t s_published = 0;
+
+/* Fix n, with every field derived from n and padding zeroed */
+/* 第 n 个定位，每个字段都由 n 推出，填充字节清零 */
+static void make_fix(uint32_t n, GPS_Data_t *fix) {
+    memset(fix, 0, sizeof(*fix));
+    fix->Year = (uint8_t)n;
+    fix->Month = (uint8_t)(n >> 8);
+    fix->Day = (uint8_t)(n >> 16);
+    fix->Hour = (uint8_t)(n * 3);
+    fix->Minute = (uint8_t)(n * 5);
+    fix->Second = (uint8_t)(n * 7);
+    fix->Millisecond = (uint16_t)(n * 11);
+    fix->Latitude_e7 = (int32_t)n;
+    fix->Lat_Indicator = (n & 1) ? 'S' : 'N';
+    fix->Longitude_e7 = -(int32_t)n;
+    fix->Lon_Indicator = (n & 2) ? 'W' : 'E';
+    fix->Speed_mknots = (int32_t)(n * 13);
+    fix->Course_cdeg = (int32_t)(n % 36000);
+    fix->Altitude_mm = (int32_t)(n * 17);
+    fix->Num_Satellites = (uint8_t)(n * 19);
+    fix->Velocity_North = (float)(n & 0xFFFF);
+    fix->Velocity_East = -(float)(n & 0xFFFF);
+    fix->Velocity_Descend = (float)((n >> 16) & 0xFFFF);
+    fix->Horizontal_Accuracy_mm = n ^ 0x5A5A5A5A;
+    fix->Vertical_Accuracy_mm = n ^ 0xA5A5A5A5;
+    fix->Speed_Accuracy_cm_s = ~n;
+    fix->Status = (uint8_t)(n & 1);
+    fix->RMC_Valid = 1;
+    fix->GGA_Valid = 1;
+    fix->RMC_Latitude_e7 = (int32_t)(n * 23);
+    fix->RMC_Longitude_e7 = (int32_t)(n * 29);
+    fix->GGA_Latitude_e7 = (int32_t)(n * 31);
+    fix->GGA_Longitude_e7 = (int32_t)(n * 37);
+    fix->GGA_Altitude_mm = (int32_t)(n * 41);
+    fix->RMC_Velocity_North = (float)(n % 1000);
+    fix->RMC_Velocity_East = (float)(n % 999);
+}
+
+static void *writer_thread(void *arg) {
+    GPS_Data_t fix;
+    uint32_t n = 0;
+    while (!__atomic_load_n(&s_stop, __ATOMIC_ACQUIRE)) {
+        make_fix(++n, &fix);
+        if (s_use_snapshot) {
+            gps_snapshot_publish(&s_snapshot, &fix);
+        } else {
+            memcpy((void *)&s_plain, &fix, sizeof(fix));
+        }
+        __atomic_store_n(&s_published, n, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+static void *reader_thread(void *arg) {
+    reader_stats_t *stats = arg;
+    GPS_Data_t fix, expected;
+    uint32_t last = 0;
+    while (!__atomic_load_n(&s_stop, __ATOMIC_ACQUIRE)) {
+        if (s_use_snapshot) {
+            stats->retries += gps_snapshot_read(&s_snapshot, &fix);
+        } else {
+            memcpy(&fix, (const void *)&s_plain, sizeof(fix));
+        }
+        stats->reads++;
+        uint32_t n = (uint32_t)fix.Latitude_e7;
+        make_fix(n, &expected);
+        if (n == 0) {
+            continue;   // Nothing published yet / 尚未发布
+        }
+        if (memcmp(&fix, &expected, sizeof(fix)) != 0) {
+            stats->torn++;
+        } else if (n < last) {
+            stats->backwards++;
+        } else {
+            last = n;
+        }
+    }
+    return NULL;
+}
+
+static void run_phase(int use_snapshot, int seconds, int readers, reader_stats_t *total, uint32_t *published) {
+    pthread_t writer, threads[MAX_READERS];
+    reader_stats_t stats[MAX_READERS];
+    memset(stats, 0, sizeof(stats));
+    memset(&s_plain, 0, sizeof(s_plain));
+    gps_snapshot_init(&s_snapshot);
+    s_use_snapshot = use_snapshot;
+    __atomic_store_n(&s_stop, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&s_published, 0, __ATOMIC_RELEASE);
+
+    pthread_create(&writer, NULL, writer_thread, NULL);
+    for (int i = 0; i < readers; i++) {
+        pthread_create(&threads[i], NULL, reader_thread, &stats[i]);
+    }
+    struct timespec duration = { .tv_sec = seconds, .tv_nsec = 0 };
+    nanosleep(&duration, NULL);
+    __atomic_store_n(&s_stop, 1, __ATOMIC_RELEASE);
+    pthread_join(writer, NULL);
+    memset(total, 0, sizeof(*total));
+    for (int i = 0; i < readers; i++) {
+        pthread_join(threads[i], NULL);
+        total->reads += stats[i].reads;
+        total->torn += stats[i].torn;
+        total->backwards += stats[i].backwards;
+        total->retries += stats[i].retries;
+    }
+    *published = __atomic_load_n(&s_published, __ATOMIC_ACQUIRE);
+}
+
+int main(int argc, char **argv) {
+    int seconds = argc > 1 ? atoi(argv[1]) : DEFAULT_SECONDS;
+    int readers = argc > 2 ? atoi(argv[2]) : DEFAULT_READERS;
+    if (seconds <= 0) {
+        seconds = DEFAULT_SECONDS;
+    }
+    if (readers <= 0 || readers > MAX_READERS) {
+        readers = DEFAULT_READERS;
+    }
+
+    reader_stats_t snapshot, plain;
+    uint32_t snapshot_published, plain_published;
+    run_phase(1, seconds, readers, &snapshot, &snapshot_published);
+    run_phase(0, seconds, readers, &plain, &plain_published);
+
+    printf("%d readers, %d s per phase, GPS_Data_t is %zu bytes\n\n", readers, seconds, sizeof(GPS_Data_t));
+    printf("| Reader / 读取方式 | Fixes published | Reads | Torn | Backwards | Retries |\n");
+    printf("|---|---|---|---|---|---|\n");
+    printf("| gps_snapshot_read | %lu | %llu | %llu | %llu | %llu |\n", (unsigned long)snapshot_published,
+           (unsigned long long)snapshot.reads, (unsigned long long)snapshot.torn,
+           (unsigned long long)snapshot.backwards, (unsigned long long)snapshot.retries);
+    printf("| plain memcpy | %lu | %llu | %llu | %llu | - |\n", (unsigned long)plain_published,
+           (unsigned long long)plain.reads, (unsigned long long)plain.torn, (unsigned long long)plain.backwards);
+
+    int failed = snapshot.torn != 0 || snapshot.backwards != 0 || snapshot.reads == 0 || snapshot_published == 0;
+    printf("%s\n", failed ? "FAIL" : "PASS");
+    return failed;
+}
@@ -0,0 +1,283 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Replay test for the sentence assembler behind Parse_NMEA_Buffer (logic/nmea_parser.c).
+ * Parse_NMEA_Buffer 所用语句拼接器（logic/nmea_parser.c）的回放测试。
+ *
+ * A drive log is fed to nmea_assembler_feed in random-sized chunks, from single bytes up to twice
+ * RX_BUF_SIZE, and every sentence it produces must match, in order, the sentences found by scanning
+ * the whole log at once. The same chunks parsed as self-contained reads, as rx_task_GPS used to,
+ * show how many RMC/GGA sentences were lost at read boundaries. An over-long line without a line
+ * end is injected to check that the assembler drops it and resynchronises. Finally single bytes
+ * of the log are corrupted and no sentence that differs from the log may reach the handler.
+ * 将行车日志按随机大小（从单字节到两倍 RX_BUF_SIZE）分块送入 nmea_assembler_feed，其输出的每条语句必须与
+ * 一次性扫描整个日志得到的语句按顺序一致。同样的分块若像旧 rx_task_GPS 那样各自独立解析，可看出有多少 RMC/GGA
+ * 语句在读取边界处丢失。另注入一条没有行尾的超长行，检查拼接器会丢弃它并重新同步。最后破坏日志中的
+ * 单个字节，任何与日志不同的语句都不得到达处理函数。
+ *
+ * Usage / 用法: nmea_assembler_replay_test <log.nmea> [seeds]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nmea_parser.h"
+
+#define RX_BUF_SIZE     800
+#define DEFAULT_SEEDS   20
+
+/* One byte in about this many is replaced in the corruption pass, never two in one sentence */
+/* 破坏测试中约每这么多字节替换一个，同一语句中不会有两处 */
+#define CORRUPT_EVERY   2000
+
+typedef struct {
+    uint32_t hash;
+    uint8_t id;
+    uint8_t field_count;
+} sentence_record_t;
+
+typedef struct {
+    sentence_record_t *items;
+    size_t count;
+    size_t capacity;
+    size_t rmc_gga;
+} record_list_t;
+
+static uint64_t s_rng;
+
+static uint64_t next_random(void) {
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 7;
+    s_rng ^= s_rng << 17;
+    return s_rng;
+}
+
+/* FNV-1a over the sentence up to its checksum */
+/* 对语句（到校验和为止）计算 FNV-1a */
+static uint32_t sentence_hash(const nmea_sentence_t *s) {
+    uint32_t h = 2166136261u;
+    for (uint16_t i = 0; i < s->length; i++) {
+        h = (h ^ (uint8_t)s->line[i]) * 16777619u;
+    }
+    return h;
+}
+
+static void record_sentence(const nmea_sentence_t *s, void *ctx) {
+    record_list_t *list = ctx;
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 4096;
+        list->items = realloc(list->items, list->capacity * sizeof(sentence_record_t));
+    }
+    list->items[list->count++] = (sentence_record_t){ sentence_hash(s), s->id, s->field_count };
+    if (s->id == NMEA_SENTENCE_RMC || s->id == NMEA_SENTENCE_GGA) {
+        list->rmc_gga++;
+    }
+}
+
+static size_t next_chunk(size_t remaining) {
+    size_t chunk;
+    switch (next_random() % 3) {
+        case 0: chunk = 1 + next_random() % 16; break;
+        case 1: chunk = 1 + next_random() % RX_BUF_SIZE; break;
+        default: chunk = RX_BUF_SIZE + next_random() % RX_BUF_SIZE; break;
+    }
+    return chunk < remaining ? chunk : remaining;
+}
+
+static int same_records(const record_list_t *a, const record_list_t *b, size_t *first_difference) {
+    size_t n = a->count < b->count ? a->count : b->count;
+    for (size_t i = 0; i < n; i++) {
+        if (a->items[i].hash != b->items[i].hash || a->items[i].id != b->items[i].id ||
+            a->items[i].field_count != b->items[i].field_count) {
+            *first_difference = i;
+            return 0;
+        }
+    }
+    *first_difference = n;
+    return a->count == b->count;
+}
+
+static int compare_hash(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <log.nmea> [seeds]\n", argv[0]);
+        return 2;
+    }
+    int seeds = argc > 2 ? atoi(argv[2]) : DEFAULT_SEEDS;
+    if (seeds <= 0) {
+        seeds = DEFAULT_SEEDS;
+    }
+
+    FILE *f = fopen(argv[1], "rb");
+    if (f == NULL) {
+        perror(argv[1]);
+        return 2;
+    }
+    fseek(f, 0, SEEK_END);
+    size_t size = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *log = malloc(size);
+    if (fread(log, 1, size, f) != size) {
+        fclose(f);
+        return 2;
+    }
+    fclose(f);
+
+    record_list_t truth = { 0 };
+    nmea_scan_buffer(log, size, record_sentence, &truth, NULL);
+
+    int failed = 0;
+    size_t chunks_total = 0, lost_total = 0, rmc_gga_total = 0;
+    for (int seed = 1; seed <= seeds; seed++) {
+        s_rng = 0x9E3779B97F4A7C15ULL * (uint64_t)seed;
+
+        nmea_line_assembler_t assembler;
+        memset(&assembler, 0, sizeof(assembler));
+        record_list_t assembled = { 0 }, per_read = { 0 };
+        for (size_t pos = 0; pos < size;) {
+            size_t chunk = next_chunk(size - pos);
+            nmea_assembler_feed(&assembler, log + pos, chunk, record_sentence, &assembled);
+            nmea_scan_buffer(log + pos, chunk, record_sentence, &per_read, NULL);
+            pos += chunk;
+            chunks_total++;
+        }
+
+        size_t at;
+        if (!same_records(&truth, &assembled, &at)) {
+            printf("FAIL seed %d: %zu of %zu sentences, first difference at %zu\n",
+                   seed, assembled.count, truth.count, at);
+            failed = 1;
+        }
+        if (assembler.overflows != 0) {
+            printf("FAIL seed %d: %lu unexpected overflows\n", seed, (unsigned long)assembler.overflows);
+            failed = 1;
+        }
+
+        // Self-contained reads: count RMC/GGA sentences that were not seen whole
+        // 独立解析每次读取：统计未被完整解析的 RMC/GGA 语句
+        size_t whole = 0, next = 0;
+        for (size_t j = 0; j < per_read.count; j++) {
+            // A fragment of a split sentence matches nothing nearby and is skipped
+            // 被拆分语句的片段在附近找不到匹配，直接跳过
+            for (size_t i = next; i < truth.count && i < next + 256; i++) {
+                if (truth.items[i].hash == per_read.items[j].hash) {
+                    if (truth.items[i].id == NMEA_SENTENCE_RMC || truth.items[i].id == NMEA_SENTENCE_GGA) {
+                        whole++;
+                    }
+                    next = i + 1;
+                    break;
+                }
+            }
+        }
+        lost_total += truth.rmc_gga - whole;
+        rmc_gga_total += truth.rmc_gga;
+        free(assembled.items);
+        free(per_read.items);
+    }
+
+    // An over-long line without a line end must be dropped and the next sentence recovered
+    // 没有行尾的超长行必须被丢弃，且下一条语句能够恢复
+    {
+        static const char s_tail[] = "$GNGGA,000000.100,2234.732734,N,11356.317512,E,1,7,1.31,47.379,M,-2.657,M,,*60\r\n";
+        char noise[400];
+        memset(noise, 'A', sizeof(noise));
+        memcpy(noise, "$PXXX,", 6);
+        nmea_line_assembler_t assembler;
+        memset(&assembler, 0, sizeof(assembler));
+        record_list_t out = { 0 };
+        nmea_assembler_feed(&assembler, log, 60, record_sentence, &out);          // partial first sentence
+        nmea_assembler_feed(&assembler, noise, 100, record_sentence, &out);       // runs past the carry
+        nmea_assembler_feed(&assembler, noise + 100, 300, record_sentence, &out);
+        nmea_assembler_feed(&assembler, "\r\n", 2, record_sentence, &out);
+        nmea_assembler_feed(&assembler, s_tail, sizeof(s_tail) - 1, record_sentence, &out);
+        if (assembler.overflows != 1 || out.count != 1 || out.items[0].id != NMEA_SENTENCE_GGA) {
+            printf("FAIL over-long line: overflows %lu, sentences %zu\n", (unsigned long)assembler.overflows, out.count);
+            failed = 1;
+        }
+        free(out.items);
+    }
+
+    // Replace single bytes with printable characters that are not framing ('$', '*', CR, LF);
+    // the XOR checksum catches every such change, so only sentences from the log may come out
+    // 将单个字节替换为非帧字符（'$'、'*'、CR、LF 以外）的可打印字符；XOR 校验能发现所有此类改动，
+    // 因此输出的只能是日志中原有的语句
+    nmea_checksum_stats_t corrupt_stats = { 0 };
+    int corrupt_failed = 0;
+    size_t corrupted_bytes = 0, foreign = 0;
+    {
+        uint32_t *known = malloc(truth.count * sizeof(uint32_t));
+        for (size_t i = 0; i < truth.count; i++) {
+            known[i] = truth.items[i].hash;
+        }
+        qsort(known, truth.count, sizeof(uint32_t), compare_hash);
+
+        char *damaged = malloc(size);
+        memcpy(damaged, log, size);
+        s_rng = 0xD1B54A32D192ED03ULL;
+        for (size_t pos = next_random() % CORRUPT_EVERY; pos < size; pos += NMEA_MAX_SENTENCE_LENGTH + next_random() % (2 * CORRUPT_EVERY)) {
+            char c;
+            do {
+                c = (char)(' ' + next_random() % 95);
+            } while (c == '$' || c == '*' || c == damaged[pos]);
+            damaged[pos] = c;
+            corrupted_bytes++;
+        }
+
+        nmea_line_assembler_t assembler;
+        memset(&assembler, 0, sizeof(assembler));
+        record_list_t out = { 0 };
+        for (size_t pos = 0; pos < size;) {
+            size_t chunk = next_chunk(size - pos);
+            nmea_assembler_feed(&assembler, damaged + pos, chunk, record_sentence, &out);
+            pos += chunk;
+        }
+        for (size_t i = 0; i < out.count; i++) {
+            if (bsearch(&out.items[i].hash, known, truth.count, sizeof(uint32_t), compare_hash) == NULL) {
+                foreign++;
+            }
+        }
+        corrupt_stats = assembler.checksum;
+        if (foreign != 0 || corrupt_stats.good != out.count || corrupt_stats.bad + corrupt_stats.truncated == 0) {
+            printf("FAIL corruption: %zu corrupted sentences reached the handler\n", foreign);
+            corrupt_failed = 1;
+        }
+        free(out.items);
+        free(damaged);
+        free(known);
+    }
+
+    printf("log: %s, %zu bytes, %zu sentences, %d seeds, %zu reads of 1..%d bytes\n",
+           argv[1], size, truth.count, seeds, chunks_total, 2 * RX_BUF_SIZE);
+    printf("assembler: every sentence identical to a whole-log scan%s\n", failed ? " -- NO" : "");
+    printf("self-contained reads: %zu of %zu RMC/GGA sentences (%.2f%%) lost or cut at read boundaries\n",
+           lost_total, rmc_gga_total, 100.0 * lost_total / rmc_gga_total);
+    printf("corruption: %zu bytes replaced, sentences good %lu / bad %lu / truncated %lu, %zu corrupted accepted\n",
+           corrupted_bytes, (unsigned long)corrupt_stats.good, (unsigned long)corrupt_stats.bad,
+           (unsigned long)corrupt_stats.truncated, foreign);
+    failed |= corrupt_failed;
+    printf("%s\n", failed ? "FAIL" : "PASS");
+    return failed ? 1 : 0;
+}
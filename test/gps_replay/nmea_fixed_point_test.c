@@ -0,0 +1,463 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Conformance test for the fixed-point field accessors in logic/nmea_parser.c.
+ * logic/nmea_parser.c 中定点字段读取函数的一致性测试。
+ *
+ * nmea_field_degrees_e7 and nmea_field_fixed are compared against an exact reference that keeps
+ * every digit as a 128-bit rational and rounds half away from zero once at the end. The corpus is
+ * every coordinate, altitude, speed and course field of a drive log, plus random fields with 0 to
+ * 20 fraction digits, exact half-way cases and their nearest neighbours, and malformed fields.
+ * The previous double path (digit-by-digit division, atof, truncating cast) is run on the same
+ * fields to show how far it drifted.
+ * nmea_field_degrees_e7 与 nmea_field_fixed 与精确参考实现对比：参考实现以 128 位有理数保留全部数位，最后只做一次
+ * 四舍五入（远离零）。语料包括行车日志中全部坐标、高度、速度与航向字段，以及 0 到 20 位小数的随机字段、恰好位于中点的
+ * 情形及其最近邻、和格式错误的字段。旧的 double 路径（逐位相除、atof、截断转换）也在同样的字段上运行，以显示其偏差。
+ *
+ * Usage / 用法: nmea_fixed_point_test [log.nmea] [random_fields]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+#include "nmea_parser.h"
+
+#define DEFAULT_RANDOM_FIELDS 1000000
+#define MAX_FIELD_LENGTH      48
+
+typedef unsigned __int128 u128;
+
+typedef enum {
+    FIELD_COORDINATE,           // ddmm.mmmm / dddmm.mmmm -> 1e-7 degree
+    FIELD_FIXED_3,              // altitude / speed -> 1e-3
+    FIELD_FIXED_2,              // course -> 1e-2
+} field_kind_t;
+
+typedef struct {
+    size_t checked;
+    size_t mismatches;
+    size_t old_differs;
+    long long old_max_error;
+    double fixed_ns;
+    double old_ns;
+} kind_stats_t;
+
+static kind_stats_t s_stats[3];
+static int s_reported;
+
+static uint64_t s_rng = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t next_random(void) {
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 7;
+    s_rng ^= s_rng << 17;
+    return s_rng;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* ---------- exact reference ---------- */
+
+/* Parse [sign] digits [. digits] into a 128-bit integer and its number of fraction digits */
+/* 将 [符号] 数字 [. 数字] 解析为 128 位整数及其小数位数 */
+static int reference_decimal(const char *text, int allow_sign, int *negative, u128 *value, int *fraction_digits) {
+    const char *p = text;
+    *negative = 0;
+    if (allow_sign && (*p == '-' || *p == '+')) {
+        *negative = (*p == '-');
+        p++;
+    }
+    u128 v = 0;
+    int digits = 0, fraction = -1;
+    for (; *p; p++) {
+        if (isdigit((unsigned char)*p)) {
+            v = v * 10 + (u128)(*p - '0');
+            digits++;
+            if (fraction >= 0) {
+                fraction++;
+            }
+        } else if (*p == '.' && fraction < 0) {
+            fraction = 0;
+        } else {
+            return 0;
+        }
+    }
+    if (digits == 0 || digits > 36) {
+        return 0;
+    }
+    *value = v;
+    *fraction_digits = fraction < 0 ? 0 : fraction;
+    return 1;
+}
+
+static u128 pow10_u128(int n) {
+    u128 v = 1;
+    while (n-- > 0) {
+        v *= 10;
+    }
+    return v;
+}
+
+static int reference_degrees_e7(const char *text, int32_t *out) {
+    int negative, f;
+    u128 n;
+    if (text[0] == '.' || !reference_decimal(text, 0, &negative, &n, &f)) {
+        return 0;
+    }
+    u128 scale = pow10_u128(f);
+    u128 degrees = n / (100 * scale);
+    u128 minutes = n % (100 * scale);       // minutes * 10^f
+    if (minutes >= 60 * scale) {
+        return 0;
+    }
+    // round(degrees * 1e7 + minutes * 1e7 / (60 * 10^f)), half away from zero
+    u128 denominator = 60 * scale;
+    u128 fraction = (2 * minutes * 10000000 + denominator) / (2 * denominator);
+    u128 value = degrees * 10000000 + fraction;
+    if (value > 1800000000) {
+        return 0;
+    }
+    *out = (int32_t)value;
+    return 1;
+}
+
+static int reference_fixed(const char *text, int decimals, int32_t *out) {
+    int negative, f;
+    u128 n;
+    if (!reference_decimal(text, 1, &negative, &n, &f)) {
+        return 0;
+    }
+    u128 scale = pow10_u128(f);
+    u128 value = (2 * n * pow10_u128(decimals) + scale) / (2 * scale);
+    if (value > INT32_MAX) {
+        return 0;
+    }
+    *out = negative ? -(int32_t)value : (int32_t)value;
+    return 1;
+}
+
+/* ---------- previous double path ---------- */
+
+static double old_convert_degree(const char *nmea) {
+    double deg = 0.0, min = 0.0;
+    const char *dot = nmea;
+    while (*dot && *dot != '.') {
+        dot++;
+    }
+    int int_part = 0;
+    const char *ptr = nmea;
+    while (ptr < dot && isdigit((unsigned char)*ptr)) {
+        int_part = int_part * 10 + (*ptr - '0');
+        ptr++;
+    }
+    double frac_part = 0.0, divisor = 10.0;
+    ptr = (*dot == '.') ? dot + 1 : dot;
+    while (*ptr && isdigit((unsigned char)*ptr)) {
+        frac_part += (*ptr - '0') / divisor;
+        divisor *= 10.0;
+        ptr++;
+    }
+    deg = int_part + frac_part;
+    min = deg - ((int)(deg / 100)) * 100;
+    return ((int)(deg / 100)) + min / 60.0;
+}
+
+static int32_t old_path(field_kind_t kind, const char *text) {
+    switch (kind) {
+        case FIELD_COORDINATE: return (int32_t)(old_convert_degree(text) * 1e7);
+        case FIELD_FIXED_3: return (int32_t)(atof(text) * 1000);
+        default: return (int32_t)(atof(text) * 100);
+    }
+}
+
+/* ---------- driver ---------- */
+
+static int tokenized_field(const char *text, nmea_sentence_t *sentence, char *line, size_t size) {
+    int length = snprintf(line, size, "$GNGGA,%s*00\r\n", text);
+    return nmea_tokenize(line, (size_t)length, sentence) == 0 && sentence->field_count >= 1 ? 0 : -1;
+}
+
+static void check_field(field_kind_t kind, const char *text, int compare_old) {
+    char line[MAX_FIELD_LENGTH + 16];
+    nmea_sentence_t sentence;
+    kind_stats_t *stats = &s_stats[kind];
+    if (tokenized_field(text, &sentence, line, sizeof(line)) != 0) {
+        return;
+    }
+
+    int32_t expected = 0, actual = 0;
+    int expected_ok, actual_ok;
+    switch (kind) {
+        case FIELD_COORDINATE:
+            expected_ok = reference_degrees_e7(text, &expected);
+            actual_ok = nmea_field_degrees_e7(&sentence, 0, &actual);
+            break;
+        case FIELD_FIXED_3:
+            expected_ok = reference_fixed(text, 3, &expected);
+            actual_ok = nmea_field_fixed(&sentence, 0, 3, &actual);
+            break;
+        default:
+            expected_ok = reference_fixed(text, 2, &expected);
+            actual_ok = nmea_field_fixed(&sentence, 0, 2, &actual);
+            break;
+    }
+    stats->checked++;
+    if (expected_ok != actual_ok || (expected_ok && expected != actual)) {
+        stats->mismatches++;
+        if (s_reported++ < 10) {
+            printf("  MISMATCH kind %d \"%s\": reference %s %ld, parser %s %ld\n", kind, text,
+                   expected_ok ? "ok" : "rejected", (long)expected, actual_ok ? "ok" : "rejected", (long)actual);
+        }
+        return;
+    }
+    if (compare_old && expected_ok) {
+        long long error = llabs((long long)old_path(kind, text) - expected);
+        if (error != 0) {
+            stats->old_differs++;
+            if (error > stats->old_max_error) {
+                stats->old_max_error = error;
+            }
+        }
+    }
+}
+
+static void random_digits(char *out, int count) {
+    for (int i = 0; i < count; i++) {
+        out[i] = (char)('0' + next_random() % 10);
+    }
+    out[count] = '\0';
+}
+
+static void random_coordinate(char *out) {
+    int longitude = next_random() & 1;
+    unsigned degrees = (unsigned)(next_random() % (longitude ? 181 : 91));
+    unsigned minutes = (unsigned)(next_random() % 60);
+    char fraction[24];
+    int k = (int)(next_random() % 21);
+    random_digits(fraction, k);
+    if (k == 0) {
+        sprintf(out, longitude ? "%03u%02u" : "%02u%02u", degrees, minutes);
+    } else {
+        sprintf(out, longitude ? "%03u%02u.%s" : "%02u%02u.%s", degrees, minutes, fraction);
+    }
+}
+
+/* A coordinate exactly half way between two 1e-7 degree steps, or one unit in the last digit away */
+/* 恰好位于两个 1e-7 度刻度中点的坐标，或在最后一位上相差一个单位的坐标 */
+static void tie_coordinate(char *out, int variant) {
+    unsigned degrees = (unsigned)(next_random() % 180);
+    uint64_t step = next_random() % 600000000ULL;           // 1e-7 degree steps in one degree
+    uint64_t minutes_e7 = step * 60 + 30;                  // half way, in 1e-7 minute
+    int zeros = (int)(next_random() % 11);                  // pad up to 17 fraction digits
+    char fraction[32];
+    sprintf(fraction, "%07llu", (unsigned long long)(minutes_e7 % 10000000ULL));
+    for (int i = 0; i < zeros; i++) {
+        strcat(fraction, "0");
+    }
+    if (variant != 0) {
+        // Nudge by one unit in an extra last digit: ...29999 / ...30001
+        // 在额外的最后一位上偏移一个单位：...29999 / ...30001
+        size_t len = strlen(fraction);
+        if (variant < 0) {
+            int i = (int)len - 1;
+            while (i >= 0 && fraction[i] == '0') {
+                fraction[i--] = '9';
+            }
+            if (i < 0) {
+                return tie_coordinate(out, 0);
+            }
+            fraction[i]--;
+            strcat(fraction, "9");
+        } else {
+            strcat(fraction, "1");
+        }
+    }
+    sprintf(out, "%03u%02llu.%s", degrees, (unsigned long long)(minutes_e7 / 10000000ULL), fraction);
+}
+
+static void random_fixed(char *out) {
+    char whole[12], fraction[24];
+    random_digits(whole, 1 + (int)(next_random() % 6));
+    int k = (int)(next_random() % 12);
+    random_digits(fraction, k);
+    const char *sign = (next_random() % 4 == 0) ? "-" : "";
+    if (k == 0) {
+        sprintf(out, "%s%s", sign, whole);
+    } else {
+        sprintf(out, "%s%s.%s", sign, whole, fraction);
+    }
+}
+
+typedef struct {
+    size_t count;
+} log_ctx_t;
+
+static void log_handler(const nmea_sentence_t *s, void *ctx) {
+    log_ctx_t *log = ctx;
+    static const struct { uint8_t id; uint8_t index; field_kind_t kind; } s_fields[] = {
+        { NMEA_SENTENCE_RMC, 2, FIELD_COORDINATE }, { NMEA_SENTENCE_RMC, 4, FIELD_COORDINATE },
+        { NMEA_SENTENCE_RMC, 6, FIELD_FIXED_3 },    { NMEA_SENTENCE_RMC, 7, FIELD_FIXED_2 },
+        { NMEA_SENTENCE_GGA, 1, FIELD_COORDINATE }, { NMEA_SENTENCE_GGA, 3, FIELD_COORDINATE },
+        { NMEA_SENTENCE_GGA, 8, FIELD_FIXED_3 },
+    };
+    for (size_t i = 0; i < sizeof(s_fields) / sizeof(s_fields[0]); i++) {
+        if (s->id != s_fields[i].id || nmea_field_is_empty(s, s_fields[i].index)) {
+            continue;
+        }
+        char text[MAX_FIELD_LENGTH];
+        const nmea_field_t *field = &s->fields[s_fields[i].index];
+        if (field->length >= sizeof(text)) {
+            continue;
+        }
+        memcpy(text, s->line + field->offset, field->length);
+        text[field->length] = '\0';
+        check_field(s_fields[i].kind, text, 1);
+        log->count++;
+    }
+}
+
+/* Time both paths on the same prepared coordinate fields */
+/* 在同一批已分词的坐标字段上分别计时两条路径 */
+static void time_paths(void) {
+    enum { COUNT = 20000 };
+    static char texts[COUNT][MAX_FIELD_LENGTH];
+    static char lines[COUNT][MAX_FIELD_LENGTH + 16];
+    static nmea_sentence_t sentences[COUNT];
+    for (int kind = 0; kind < 3; kind++) {
+        for (int i = 0; i < COUNT; i++) {
+            if (kind == FIELD_COORDINATE) {
+                unsigned fraction = (unsigned)(next_random() % 1000000);
+                sprintf(texts[i], "%05u.%06u", (unsigned)(next_random() % 18000) / 100 * 100 + (unsigned)(next_random() % 60), fraction);
+            } else {
+                sprintf(texts[i], "%u.%03u", (unsigned)(next_random() % 5000), (unsigned)(next_random() % 1000));
+            }
+            tokenized_field(texts[i], &sentences[i], lines[i], sizeof(lines[i]));
+        }
+        volatile int32_t sink = 0;
+        double best_fixed = 1e30, best_old = 1e30;
+        for (int round = 0; round < 5; round++) {
+            double start = now_ns();
+            for (int i = 0; i < COUNT; i++) {
+                int32_t v = 0;
+                if (kind == FIELD_COORDINATE) {
+                    nmea_field_degrees_e7(&sentences[i], 0, &v);
+                } else {
+                    nmea_field_fixed(&sentences[i], 0, kind == FIELD_FIXED_3 ? 3 : 2, &v);
+                }
+                sink += v;
+            }
+            double mid = now_ns();
+            for (int i = 0; i < COUNT; i++) {
+                sink += old_path((field_kind_t)kind, texts[i]);
+            }
+            double end = now_ns();
+            best_fixed = mid - start < best_fixed ? mid - start : best_fixed;
+            best_old = end - mid < best_old ? end - mid : best_old;
+        }
+        s_stats[kind].fixed_ns = best_fixed / COUNT;
+        s_stats[kind].old_ns = best_old / COUNT;
+        (void)sink;
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *log_path = argc > 1 ? argv[1] : NULL;
+    long random_fields = argc > 2 ? atol(argv[2]) : DEFAULT_RANDOM_FIELDS;
+    int failed = 0;
+
+    // 1. Every numeric field of the drive log
+    // 1. 行车日志中的每个数值字段
+    size_t log_fields = 0;
+    if (log_path != NULL) {
+        FILE *f = fopen(log_path, "rb");
+        if (f == NULL) {
+            perror(log_path);
+            return 2;
+        }
+        fseek(f, 0, SEEK_END);
+        size_t size = (size_t)ftell(f);
+        fseek(f, 0, SEEK_SET);
+        char *text = malloc(size);
+        if (fread(text, 1, size, f) != size) {
+            fclose(f);
+            return 2;
+        }
+        fclose(f);
+        log_ctx_t ctx = { 0 };
+        nmea_scan_buffer(text, size, log_handler, &ctx, NULL);
+        log_fields = ctx.count;
+        free(text);
+    }
+
+    // 2. Random fields, half-way cases and their neighbours
+    // 2. 随机字段、中点情形及其近邻
+    char text[MAX_FIELD_LENGTH];
+    for (long i = 0; i < random_fields; i++) {
+        switch (i % 4) {
+            case 0: random_coordinate(text); check_field(FIELD_COORDINATE, text, 0); break;
+            case 1: tie_coordinate(text, (int)(next_random() % 3) - 1); check_field(FIELD_COORDINATE, text, 0); break;
+            case 2: random_fixed(text); check_field(FIELD_FIXED_3, text, 0); break;
+            default: random_fixed(text); check_field(FIELD_FIXED_2, text, 0); break;
+        }
+    }
+
+    // 3. Boundaries and malformed fields, the reference decides what is valid
+    // 3. 边界与格式错误的字段，由参考实现判定是否合法
+    static const char *s_edges[] = {
+        "0000.0000", "0000", "0000.", "5959.9999999", "8959.99999995", "8959.99999994999999",
+        "9000.0000", "18000.000000", "18000.0000001", "18100.0000", "1260.0000", "12.", "1234.5a",
+        ".5", "", "12.3.4", "-1234.5", "+1234.5", "0000.00000300", "0000.00000299999999999",
+        "00000.000003000000000000001", "4717.11399", "12319.123456789012345678",
+    };
+    static const char *s_fixed_edges[] = {
+        "0", "-0", "0.0005", "-0.0005", "0.0004999", "2147483.647", "2147483.6474", "2147483.6475",
+        "2147483.648", "-2147483.647", "21474836", "1.", ".5", "-", "", "1e3", "12.34.5", "+7.0015",
+    };
+    for (size_t i = 0; i < sizeof(s_edges) / sizeof(s_edges[0]); i++) {
+        check_field(FIELD_COORDINATE, s_edges[i], 0);
+    }
+    for (size_t i = 0; i < sizeof(s_fixed_edges) / sizeof(s_fixed_edges[0]); i++) {
+        check_field(FIELD_FIXED_3, s_fixed_edges[i], 0);
+        check_field(FIELD_FIXED_2, s_fixed_edges[i], 0);
+    }
+
+    time_paths();
+
+    static const char *s_names[] = { "coordinate -> 1e-7 deg", "fixed 1e-3 (alt, speed)", "fixed 1e-2 (course)" };
+    printf("drive log fields: %zu, random fields: %ld\n\n", log_fields, random_fields);
+    printf("%-24s %10s %10s %14s %10s %10s %10s\n", "field", "checked", "mismatch", "old differs", "old max", "fixed ns", "old ns");
+    for (int kind = 0; kind < 3; kind++) {
+        const kind_stats_t *st = &s_stats[kind];
+        printf("%-24s %10zu %10zu %14zu %10lld %10.1f %10.1f\n", s_names[kind], st->checked, st->mismatches,
+               st->old_differs, st->old_max_error, st->fixed_ns, st->old_ns);
+        failed |= st->mismatches != 0;
+    }
+    printf("\n(old differs / old max: drive log fields where the previous double path was off, and by how many units)\n");
+    printf("%s\n", failed ? "FAIL" : "PASS");
+    return failed ? 1 : 0;
+}
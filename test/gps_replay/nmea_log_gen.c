@@ -0,0 +1,250 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Generates NMEA logs shaped like the LC76G output of a drive, for the host GPS tests.
+ * 为主机端 GPS 测试生成形如 LC76G 行车输出的 NMEA 日志。
+ *
+ * RMC and GGA are written at the fix rate, GSA/GSV/GST/VTG once per second. The track starts
+ * with GP talkers before switching to GN, crosses midnight UTC, and has a 5 s dropout every
+ * 3 minutes where the receiver reports no fix and leaves the position fields empty. From the second
+ * hour on, each hour also has 10 minutes on the GL talker and a 45 s tunnel without a fix.
+ * RMC 与 GGA 按定位频率输出，GSA/GSV/GST/VTG 每秒一次。轨迹开始时使用 GP 发送方，之后切换为 GN，
+ * 会跨过 UTC 零点，并且每 3 分钟有 5 秒失锁，期间接收机报告无定位且位置字段为空。从第二个小时起，
+ * 每小时还有 10 分钟使用 GL 发送方，以及一段 45 秒无定位的隧道。
+ *
+ * With a noise level the reported fixes carry receiver-like errors: a slowly wandering bias plus
+ * white noise on the position, white noise on the velocity, and a multipath spike every 97 s.
+ * The true track is then written to truth_file, one line per epoch, for gps_filter_eval.
+ * 指定噪声水平时，输出的定位带有类似接收机的误差：位置上为缓慢漂移的偏差加白噪声，速度上为白噪声，
+ * 并且每 97 s 有一次多径跳点。真实轨迹按每个历元一行写入 truth_file，供 gps_filter_eval 使用。
+ *
+ * Usage / 用法: nmea_log_gen <seconds> [rate_hz] [seed] [noise_m truth_file] > drive.nmea
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+
+#define WGS84_A_M        6378137.0
+#define WGS84_E2         6.69437999014e-3
+#define KNOTS_PER_MPS    1.943844
+#define DROPOUT_PERIOD_S 180
+#define DROPOUT_LENGTH_S 5
+
+// Long drives, from the second hour: GL talker for minutes 20-30, a tunnel at minute 40
+// 长时间行车，从第二个小时起：第 20-30 分钟使用 GL 发送方，第 40 分钟进入隧道
+#define HOUR_S           3600
+#define GL_START_S       1200
+#define GL_END_S         1800
+#define TUNNEL_START_S   2400
+#define TUNNEL_LENGTH_S  45
+
+// Noise model, scaled by noise_m: bias correlation time, bias and white sigma, spike size
+// 噪声模型，按 noise_m 缩放：偏差相关时间、偏差与白噪声 sigma、跳点大小
+#define BIAS_TIME_S      30.0
+#define BIAS_SCALE       0.8
+#define WHITE_SCALE      0.6
+#define VERTICAL_SCALE   1.5
+#define SPEED_NOISE_MPS  0.1
+#define SPIKE_PERIOD_S   97
+#define SPIKE_SCALE      12.0
+
+static double uniform(double lo, double hi) {
+    return lo + (hi - lo) * ((double)rand() / RAND_MAX);
+}
+
+/* Standard normal deviate, Box-Muller */
+/* 标准正态分布随机数，Box-Muller 变换 */
+static double gaussian(void) {
+    double u = uniform(1e-12, 1.0), v = uniform(0.0, 1.0);
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+static void emit(const char *fmt, ...) {
+    char body[160];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(body, sizeof(body), fmt, args);
+    va_end(args);
+
+    unsigned char checksum = 0;
+    for (const char *p = body; *p; p++) {
+        checksum ^= (unsigned char)*p;
+    }
+    printf("$%s*%02X\r\n", body, checksum);
+}
+
+static void format_coordinate(char *out, size_t size, double degrees, int degree_digits) {
+    double magnitude = fabs(degrees);
+    int whole = (int)magnitude;
+    double minutes = (magnitude - whole) * 60.0;
+    snprintf(out, size, "%0*d%09.6f", degree_digits, whole, minutes);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argc == 5) {
+        fprintf(stderr, "usage: %s <seconds> [rate_hz] [seed] [noise_m truth_file]\n", argv[0]);
+        return 2;
+    }
+    int seconds = atoi(argv[1]);
+    int rate = argc > 2 ? atoi(argv[2]) : 10;
+    srand(argc > 3 ? (unsigned)atoi(argv[3]) : 1u);
+    double noise = argc > 5 ? atof(argv[4]) : 0.0;
+    if (seconds <= 0 || rate <= 0 || rate > 20 || noise < 0.0) {
+        fprintf(stderr, "seconds must be > 0, rate within 1..20 and noise_m >= 0\n");
+        return 2;
+    }
+    FILE *truth = NULL;
+    if (argc > 5) {
+        truth = fopen(argv[5], "w");
+        if (truth == NULL) {
+            perror(argv[5]);
+            return 1;
+        }
+        fprintf(truth, "# rate_hz %d\n# time_ms latitude longitude altitude_m v_north v_east v_descend\n", rate);
+    }
+    double bias_north = 0.0, bias_east = 0.0, bias_up = 0.0;
+
+    double latitude = 22.578878, longitude = 113.938542, altitude = 45.0;
+    double speed = 0.0, course = 285.0, climb = 0.0, accel = 0.0, yaw_rate = 0.0;
+    unsigned long t_ms = (23 * 3600 + 50 * 60) * 1000L;   // 23:50:00 UTC, crosses midnight after 10 minutes / 10 分钟后跨过零点
+    int day = 15, month = 1, year = 25;
+    double dt = 1.0 / rate;
+
+    for (long epoch = 0; epoch < (long)seconds * rate; epoch++) {
+        double elapsed = epoch * dt;
+        int whole_second = (epoch % rate) == 0;
+
+        // Motion: acceleration and yaw rate random walks, so speed and course change smoothly the way
+        // a car's do, with lateral acceleration kept under 4 m/s^2; altitude follows a gentle climb rate
+        // 运动：加速度与转向角速度随机游走，速度与航向像汽车一样平滑变化，横向加速度不超过 4 m/s^2；
+        // 高度按缓变的爬升率变化
+        accel = fmin(fmax(accel * 0.95 + uniform(-0.3, 0.35) * dt * 10, -3.0), 2.5);
+        speed += accel * dt;
+        if (speed < 0.0 || speed > 33.0) {
+            speed = fmin(fmax(speed, 0.0), 33.0);
+            accel = 0.0;
+        }
+        double max_yaw = fmin(20.0, 4.0 / fmax(speed, 1.0) * 180.0 / M_PI);
+        yaw_rate = fmin(fmax(yaw_rate * 0.97 + uniform(-1.5, 1.5) * dt * 10, -max_yaw), max_yaw);
+        course = fmod(course + yaw_rate * dt + 360.0, 360.0);
+        climb = fmin(fmax(climb + uniform(-0.05, 0.05), -2.0), 2.0);
+        altitude += climb * dt;
+        double phi = latitude * M_PI / 180.0;
+        double w2 = 1.0 - WGS84_E2 * sin(phi) * sin(phi);
+        double meridian = WGS84_A_M * (1.0 - WGS84_E2) / (w2 * sqrt(w2));
+        double prime_vertical = WGS84_A_M / sqrt(w2);
+        double v_north = speed * cos(course * M_PI / 180.0), v_east = speed * sin(course * M_PI / 180.0);
+        latitude += v_north * dt / meridian * 180.0 / M_PI;
+        longitude += v_east * dt / (prime_vertical * cos(phi)) * 180.0 / M_PI;
+
+        if (t_ms >= 86400000UL) {
+            t_ms -= 86400000UL;
+            day++;
+        }
+        char time_str[32];
+        snprintf(time_str, sizeof(time_str), "%02lu%02lu%02lu.%03lu", t_ms / 3600000, t_ms / 60000 % 60,
+                 t_ms / 1000 % 60, t_ms % 1000);
+        if (truth != NULL) {
+            fprintf(truth, "%lu %.9f %.9f %.4f %.4f %.4f %.4f\n", t_ms, latitude, longitude, altitude,
+                    v_north, v_east, -climb);
+        }
+        t_ms += 1000 / rate;
+
+        // Reported fix: truth plus the receiver error model
+        // 输出的定位：真实值加接收机误差模型
+        double fix_latitude = latitude, fix_longitude = longitude, fix_altitude = altitude;
+        double fix_speed = speed, fix_course = course;
+        if (noise > 0.0) {
+            double decay = exp(-dt / BIAS_TIME_S), drive = sqrt(1.0 - decay * decay) * BIAS_SCALE * noise;
+            bias_north = bias_north * decay + drive * gaussian();
+            bias_east = bias_east * decay + drive * gaussian();
+            bias_up = bias_up * decay + drive * VERTICAL_SCALE * gaussian();
+            double e_north = bias_north + WHITE_SCALE * noise * gaussian();
+            double e_east = bias_east + WHITE_SCALE * noise * gaussian();
+            double e_up = bias_up + WHITE_SCALE * VERTICAL_SCALE * noise * gaussian();
+            if (epoch % ((long)SPIKE_PERIOD_S * rate) == (long)SPIKE_PERIOD_S * rate / 2) {
+                e_north += SPIKE_SCALE * noise;
+            }
+            fix_latitude += e_north / meridian * 180.0 / M_PI;
+            fix_longitude += e_east / (prime_vertical * cos(phi)) * 180.0 / M_PI;
+            fix_altitude += e_up;
+
+            double n = v_north + SPEED_NOISE_MPS * gaussian(), e = v_east + SPEED_NOISE_MPS * gaussian();
+            fix_speed = sqrt(n * n + e * e);
+            fix_course = fmod(atan2(e, n) * 180.0 / M_PI + 360.0, 360.0);
+        }
+
+        double in_hour = fmod(elapsed, HOUR_S);
+        int later_hour = elapsed >= HOUR_S;
+        const char *talker = elapsed < 60.0 ? "GP" : "GN";
+        if (later_hour && in_hour >= GL_START_S && in_hour < GL_END_S) {
+            talker = "GL";
+        }
+        int dropout = elapsed > 30.0 && fmod(elapsed, DROPOUT_PERIOD_S) < DROPOUT_LENGTH_S;
+        if (later_hour && in_hour >= TUNNEL_START_S && in_hour < TUNNEL_START_S + TUNNEL_LENGTH_S) {
+            dropout = 1;
+        }
+        int satellites = dropout ? 0 : 7 + (int)(elapsed / 40) % 9;
+        double hdop = 0.8 + 0.05 * (16 - satellites);
+
+        char lat_str[24], lon_str[24];
+        format_coordinate(lat_str, sizeof(lat_str), fix_latitude, 2);
+        format_coordinate(lon_str, sizeof(lon_str), fix_longitude, 3);
+        char lat_hemi = fix_latitude >= 0 ? 'N' : 'S', lon_hemi = fix_longitude >= 0 ? 'E' : 'W';
+
+        if (dropout) {
+            emit("%sRMC,%s,V,,,,,,,%02d%02d%02d,,,N,V", talker, time_str, day, month, year);
+            emit("%sGGA,%s,,,,,0,00,99.99,,,,,,", talker, time_str);
+        } else {
+            emit("%sRMC,%s,A,%s,%c,%s,%c,%.2f,%.2f,%02d%02d%02d,,,A,V", talker, time_str,
+                 lat_str, lat_hemi, lon_str, lon_hemi, fix_speed * KNOTS_PER_MPS, fix_course, day, month, year);
+            emit("%sGGA,%s,%s,%c,%s,%c,1,%02d,%.2f,%.3f,M,-2.657,M,,", talker, time_str,
+                 lat_str, lat_hemi, lon_str, lon_hemi, satellites, hdop, fix_altitude);
+        }
+
+        if (whole_second) {
+            emit("GNGSA,A,%d,05,12,15,18,24,25,,,,,,,%.2f,%.2f,%.2f,1", dropout ? 1 : 3,
+                 hdop * 1.6, hdop, hdop * 1.3);
+            emit("GNGSA,A,%d,72,73,80,,,,,,,,,,%.2f,%.2f,%.2f,2", dropout ? 1 : 3,
+                 hdop * 1.6, hdop, hdop * 1.3);
+            emit("GPGSV,3,1,10,05,45,120,38,12,30,045,35,15,62,300,41,18,12,200,29,1");
+            emit("GPGSV,3,2,10,24,55,080,40,25,20,330,33,29,05,150,,32,18,270,27,1");
+            emit("GPGSV,3,3,10,10,08,010,,13,02,100,,1");
+            emit("GLGSV,2,1,06,72,40,060,36,73,22,010,31,80,50,250,39,81,10,190,,1");
+            emit("GLGSV,2,2,06,82,03,300,,88,15,120,,1");
+            if (dropout) {
+                emit("GNGST,%s,,,,,,,", time_str);
+                emit("GNVTG,,T,,M,,N,,K,N");
+            } else {
+                emit("GNGST,%s,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f", time_str, hdop * 3.0,
+                     hdop * 2.2, hdop * 1.4, uniform(0.0, 180.0), hdop * 1.5, hdop * 1.9, hdop * 3.4);
+                emit("GNVTG,%.2f,T,,M,%.2f,N,%.2f,K,A", fix_course, fix_speed * KNOTS_PER_MPS, fix_speed * 3.6);
+            }
+        }
+    }
+    if (truth != NULL) {
+        fclose(truth);
+    }
+    return 0;
+}
@@ -0,0 +1,423 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Benchmark of the NMEA tokenizer in logic/nmea_parser.c on a recorded-style drive log.
+ * 在行车日志上对 logic/nmea_parser.c 中的 NMEA 分词器进行基准测试。
+ *
+ * The log is cut into reads of whole lines up to RX_BUF_SIZE bytes, as uart_rx_task_GPS sees
+ * them. Each read goes through a reference copy of the previous Parse_NMEA_Buffer (the read
+ * copied into buff_t, every line copied into a zeroed 800-byte stack array, strtok and atof)
+ * and through nmea_scan_buffer with the field accessors Parse_GNRMC / Parse_GNGGA now use.
+ * Both extract the same RMC/GGA values, which are compared sentence by sentence.
+ * A third pass also reads the error estimates gps_logic.c takes from GGA, GSA and GST in the same
+ * scan, to measure what they add.
+ * 日志按 uart_rx_task_GPS 的读取方式切成不超过 RX_BUF_SIZE 字节的整行数据块。每块分别经过旧
+ * Parse_NMEA_Buffer 的参考实现（读数据拷入 buff_t，每行拷入清零的 800 字节栈数组，再用 strtok 与 atof），
+ * 以及 nmea_scan_buffer 加 Parse_GNRMC / Parse_GNGGA 现用的字段读取函数。两者提取相同的 RMC/GGA 数值并逐句比对。
+ * 第三遍在同一次扫描中额外读取 gps_logic.c 从 GGA、GSA 与 GST 获取的误差估计，以测量其额外开销。
+ *
+ * Usage / 用法: nmea_tokenizer_bench <log.nmea> [rounds]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <ctype.h>
+#include <time.h>
+
+#include "nmea_parser.h"
+
+#define RX_BUF_SIZE     800
+#define DEFAULT_ROUNDS  5
+
+typedef struct {
+    char type;                  // 'R' for RMC, 'G' for GGA
+    char status;
+    uint8_t hour, minute;
+    double second;
+    double latitude, longitude;
+    double speed_knots, course, altitude;
+    int quality, satellites;
+    uint8_t day, month, year;
+} extracted_t;
+
+typedef struct {
+    extracted_t *items;
+    size_t count;
+    size_t capacity;
+} extracted_list_t;
+
+static extracted_t *list_add(extracted_list_t *list, char type) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 4096;
+        list->items = realloc(list->items, list->capacity * sizeof(extracted_t));
+    }
+    extracted_t *item = &list->items[list->count++];
+    memset(item, 0, sizeof(*item));
+    item->type = type;
+    return item;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* ---------- reference: the previous strtok parser ---------- */
+
+static char s_buff_t[RX_BUF_SIZE + 1];
+
+static double reference_convert_degree(const char *nmea, char direction) {
+    double deg = 0.0, min = 0.0;
+    const char *dot = nmea;
+    while (*dot && *dot != '.') {
+        dot++;
+    }
+    int int_part = 0;
+    const char *ptr = nmea;
+    while (ptr < dot && isdigit((unsigned char)*ptr)) {
+        int_part = int_part * 10 + (*ptr - '0');
+        ptr++;
+    }
+    double frac_part = 0.0, divisor = 10.0;
+    ptr = dot + 1;
+    while (*ptr && isdigit((unsigned char)*ptr)) {
+        frac_part += (*ptr - '0') / divisor;
+        divisor *= 10.0;
+        ptr++;
+    }
+    deg = int_part + frac_part;
+    min = deg - ((int)(deg / 100)) * 100;
+    deg = ((int)(deg / 100)) + min / 60.0;
+    return (direction == 'S' || direction == 'W') ? -deg : deg;
+}
+
+static void reference_rmc(char *sentence, extracted_t *out) {
+    char *token = strtok(sentence, ",");
+    int field = 0;
+    double lat = 0.0, lon = 0.0;
+    while (token != NULL) {
+        field++;
+        switch (field) {
+            case 2:
+                out->hour = (token[0] - '0') * 10 + (token[1] - '0');
+                out->minute = (token[2] - '0') * 10 + (token[3] - '0');
+                out->second = atof(token + 4);
+                break;
+            case 3: out->status = token[0]; break;
+            case 4: lat = reference_convert_degree(token, 'N'); break;
+            case 5: out->latitude = token[0] == 'S' ? -lat : lat; break;
+            case 6: lon = reference_convert_degree(token, 'E'); break;
+            case 7: out->longitude = token[0] == 'W' ? -lon : lon; break;
+            case 8: out->speed_knots = atof(token); break;
+            case 9: out->course = atof(token); break;
+            case 10:
+                out->day = (token[0] - '0') * 10 + (token[1] - '0');
+                out->month = (token[2] - '0') * 10 + (token[3] - '0');
+                out->year = (token[4] - '0') * 10 + (token[5] - '0');
+                break;
+            default: break;
+        }
+        token = strtok(NULL, ",");
+    }
+}
+
+static void reference_gga(char *sentence, extracted_t *out) {
+    char *token = strtok(sentence, ",");
+    int field = 0;
+    double lat = 0.0, lon = 0.0;
+    while (token != NULL) {
+        field++;
+        switch (field) {
+            case 3: lat = reference_convert_degree(token, 'N'); break;
+            case 4: out->latitude = token[0] == 'S' ? -lat : lat; break;
+            case 5: lon = reference_convert_degree(token, 'E'); break;
+            case 6: out->longitude = token[0] == 'W' ? -lon : lon; break;
+            case 7: if (token[0] != '\0') { out->quality = atoi(token); } break;
+            case 8: out->satellites = atoi(token); break;
+            case 10: out->altitude = atof(token); break;
+            default: break;
+        }
+        token = strtok(NULL, ",");
+    }
+}
+
+static void reference_parse_read(const char *read, size_t length, extracted_list_t *list) {
+    memcpy(s_buff_t, read, length);
+    s_buff_t[length] = '\0';
+
+    char *start = s_buff_t, *end;
+    while ((end = strchr(start, '\n')) != NULL) {
+        size_t line_length = end - start;
+        if (line_length > 0) {
+            char line[RX_BUF_SIZE] = {0};
+            strncpy(line, start, line_length);
+            line[line_length] = '\0';
+            if (strncmp(line, "$GNRMC", 6) == 0 || strncmp(line, "$GPRMC", 6) == 0) {
+                reference_rmc(line, list_add(list, 'R'));
+            } else if (strncmp(line, "$GNGGA", 6) == 0 || strncmp(line, "$GPGGA", 6) == 0) {
+                reference_gga(line, list_add(list, 'G'));
+            }
+        }
+        start = end + 1;
+    }
+}
+
+/* ---------- new: single-pass tokenizer, same accessors as gps_logic.c ---------- */
+
+static void tokenizer_handler(const nmea_sentence_t *s, void *ctx) {
+    extracted_list_t *list = ctx;
+    if (!nmea_talker_is_gnss(s) || (s->talker[1] != 'N' && s->talker[1] != 'P')) {
+        return;
+    }
+    int32_t value;
+    char hemisphere;
+    if (s->id == NMEA_SENTENCE_RMC) {
+        extracted_t *out = list_add(list, 'R');
+        uint8_t second;
+        uint16_t millisecond;
+        if (nmea_field_time(s, 0, &out->hour, &out->minute, &second, &millisecond)) {
+            out->second = second + millisecond / 1000.0;
+        }
+        out->status = nmea_field_char(s, 1);
+        hemisphere = nmea_field_char(s, 3);
+        if (nmea_field_degrees_e7(s, 2, &value) && hemisphere) {
+            out->latitude = (hemisphere == 'S' ? -value : value) / 1e7;
+        }
+        hemisphere = nmea_field_char(s, 5);
+        if (nmea_field_degrees_e7(s, 4, &value) && hemisphere) {
+            out->longitude = (hemisphere == 'W' ? -value : value) / 1e7;
+        }
+        if (nmea_field_fixed(s, 6, 3, &value)) {
+            out->speed_knots = value / 1e3;
+        }
+        if (nmea_field_fixed(s, 7, 2, &value)) {
+            out->course = value / 1e2;
+        }
+        nmea_field_date(s, 8, &out->day, &out->month, &out->year);
+    } else if (s->id == NMEA_SENTENCE_GGA) {
+        extracted_t *out = list_add(list, 'G');
+        hemisphere = nmea_field_char(s, 2);
+        if (nmea_field_degrees_e7(s, 1, &value) && hemisphere) {
+            out->latitude = (hemisphere == 'S' ? -value : value) / 1e7;
+        }
+        hemisphere = nmea_field_char(s, 4);
+        if (nmea_field_degrees_e7(s, 3, &value) && hemisphere) {
+            out->longitude = (hemisphere == 'W' ? -value : value) / 1e7;
+        }
+        if (nmea_field_int(s, 5, &value)) {
+            out->quality = value;
+        }
+        if (nmea_field_int(s, 6, &value)) {
+            out->satellites = value;
+        }
+        if (nmea_field_fixed(s, 8, 3, &value)) {
+            out->altitude = value / 1e3;
+        }
+    }
+}
+
+/* Error estimates, same fields and accessors as Parse_GNGGA / Parse_GNGSA / Parse_GNGST */
+/* 误差估计，字段与读取函数同 Parse_GNGGA / Parse_GNGSA / Parse_GNGST */
+typedef struct {
+    int32_t gga_hdop, pdop, hdop, vdop;
+    int32_t latitude_sigma, longitude_sigma, altitude_sigma;
+    size_t updates;
+} accuracy_t;
+
+static void accuracy_handler(const nmea_sentence_t *s, void *ctx) {
+    accuracy_t *acc = ctx;
+    int32_t fix_type, lat, lon, alt;
+    uint8_t hour, minute, second;
+    uint16_t millisecond;
+    if (!nmea_talker_is_gnss(s)) {
+        return;
+    }
+    switch (s->id) {
+        case NMEA_SENTENCE_GGA:
+            acc->updates += nmea_field_fixed(s, 7, 2, &acc->gga_hdop);
+            break;
+        case NMEA_SENTENCE_GSA:
+            if (nmea_field_int(s, 1, &fix_type) && fix_type >= 2 && nmea_field_fixed(s, 15, 2, &acc->hdop)) {
+                nmea_field_fixed(s, 14, 2, &acc->pdop);
+                nmea_field_fixed(s, 16, 2, &acc->vdop);
+                acc->updates++;
+            }
+            break;
+        case NMEA_SENTENCE_GST:
+            if (nmea_field_time(s, 0, &hour, &minute, &second, &millisecond) && nmea_field_fixed(s, 5, 3, &lat) &&
+                nmea_field_fixed(s, 6, 3, &lon) && nmea_field_fixed(s, 7, 3, &alt)) {
+                acc->latitude_sigma = lat;
+                acc->longitude_sigma = lon;
+                acc->altitude_sigma = alt;
+                acc->updates++;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+typedef struct {
+    extracted_list_t *list;
+    accuracy_t accuracy;
+} with_accuracy_t;
+
+static void tokenizer_accuracy_handler(const nmea_sentence_t *s, void *ctx) {
+    with_accuracy_t *both = ctx;
+    tokenizer_handler(s, both->list);
+    accuracy_handler(s, &both->accuracy);
+}
+
+/* ---------- driver ---------- */
+
+typedef struct {
+    size_t offset;
+    size_t length;
+} read_t;
+
+/* The tokenizer path is fixed point, so values agree to half of its resolution */
+/* 分词器路径为定点数，数值在其分辨率的一半以内一致 */
+static int same(const extracted_t *a, const extracted_t *b) {
+    return a->type == b->type && a->status == b->status && a->hour == b->hour && a->minute == b->minute &&
+           fabs(a->second - b->second) < 1e-9 && fabs(a->latitude - b->latitude) <= 0.5e-7 + 1e-12 &&
+           fabs(a->longitude - b->longitude) <= 0.5e-7 + 1e-12 && fabs(a->speed_knots - b->speed_knots) <= 0.5e-3 &&
+           fabs(a->course - b->course) <= 0.5e-2 && fabs(a->altitude - b->altitude) <= 0.5e-3 &&
+           a->quality == b->quality && a->satellites == b->satellites &&
+           a->day == b->day && a->month == b->month && a->year == b->year;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <log.nmea> [rounds]\n", argv[0]);
+        return 2;
+    }
+    int rounds = argc > 2 ? atoi(argv[2]) : DEFAULT_ROUNDS;
+    if (rounds <= 0) {
+        rounds = DEFAULT_ROUNDS;
+    }
+
+    FILE *f = fopen(argv[1], "rb");
+    if (f == NULL) {
+        perror(argv[1]);
+        return 2;
+    }
+    fseek(f, 0, SEEK_END);
+    size_t size = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *log = malloc(size);
+    if (fread(log, 1, size, f) != size) {
+        fclose(f);
+        return 2;
+    }
+    fclose(f);
+
+    // Cut into UART-sized reads of whole lines
+    // 切分为 UART 读取大小的整行数据块
+    size_t read_count = 0, sentences = 0;
+    read_t *reads = malloc((size / 16 + 1) * sizeof(read_t));
+    for (size_t pos = 0; pos < size;) {
+        size_t end = pos, cut = pos;
+        while (end < size && end - pos < RX_BUF_SIZE) {
+            if (log[end++] == '\n') {
+                cut = end;
+                sentences++;
+            }
+        }
+        if (cut == pos) {
+            cut = end;
+        }
+        reads[read_count++] = (read_t){ pos, cut - pos };
+        pos = cut;
+    }
+
+    extracted_list_t reference = { 0 }, tokenized = { 0 }, with_errors = { 0 };
+    with_accuracy_t accuracy_ctx = { &with_errors, { 0 } };
+    double reference_ns = 1e30, tokenizer_ns = 1e30, accuracy_ns = 1e30;
+    for (int round = 0; round < rounds; round++) {
+        reference.count = 0;
+        double start = now_ns();
+        for (size_t i = 0; i < read_count; i++) {
+            reference_parse_read(log + reads[i].offset, reads[i].length, &reference);
+        }
+        reference_ns = fmin(reference_ns, now_ns() - start);
+
+        tokenized.count = 0;
+        start = now_ns();
+        for (size_t i = 0; i < read_count; i++) {
+            nmea_scan_buffer(log + reads[i].offset, reads[i].length, tokenizer_handler, &tokenized, NULL);
+        }
+        tokenizer_ns = fmin(tokenizer_ns, now_ns() - start);
+
+        with_errors.count = 0;
+        memset(&accuracy_ctx.accuracy, 0, sizeof(accuracy_ctx.accuracy));
+        start = now_ns();
+        for (size_t i = 0; i < read_count; i++) {
+            nmea_scan_buffer(log + reads[i].offset, reads[i].length, tokenizer_accuracy_handler, &accuracy_ctx, NULL);
+        }
+        accuracy_ns = fmin(accuracy_ns, now_ns() - start);
+    }
+
+    // Compare sentence by sentence; strtok collapses empty fields, so those are counted separately
+    // 逐句比对；strtok 会合并空字段，这类语句单独计数
+    if (reference.count != tokenized.count) {
+        printf("FAIL: reference parsed %zu RMC/GGA sentences, tokenizer %zu\n", reference.count, tokenized.count);
+        return 1;
+    }
+    size_t differ_complete = 0, differ_empty = 0, with_empty = 0;
+    for (size_t i = 0; i < reference.count; i++) {
+        int has_empty = reference.items[i].type == 'R' ? tokenized.items[i].status != 'A'
+                                                      : tokenized.items[i].quality == 0;
+        with_empty += has_empty;
+        if (!same(&reference.items[i], &tokenized.items[i])) {
+            if (has_empty) {
+                differ_empty++;
+            } else {
+                differ_complete++;
+            }
+        }
+    }
+
+    printf("log: %s, %zu bytes, %zu sentences, %zu reads of <= %d bytes\n",
+           argv[1], size, sentences, read_count, RX_BUF_SIZE);
+    printf("RMC/GGA sentences: %zu, %zu of them with empty fields (no fix)\n", reference.count, with_empty);
+    printf("\n%-34s %10s %14s %12s\n", "parser", "ns/sent", "sentences/s", "stack/line");
+    printf("%-34s %10.1f %14.0f %12d\n", "line copy + strtok + atof", reference_ns / sentences,
+           sentences / (reference_ns * 1e-9), RX_BUF_SIZE);
+    printf("%-34s %10.1f %14.0f %12zu\n", "nmea_scan_buffer (in place)", tokenizer_ns / sentences,
+           sentences / (tokenizer_ns * 1e-9), sizeof(nmea_sentence_t));
+    printf("%-34s %10.1f %14.0f %12zu\n", "  + GGA HDOP, GSA, GST errors", accuracy_ns / sentences,
+           sentences / (accuracy_ns * 1e-9), sizeof(nmea_sentence_t));
+    printf("\nspeedup %.2fx\n", reference_ns / tokenizer_ns);
+    printf("error estimates: %zu updates, %+.1f ns per RMC/GGA pair (%+.1f%%)\n", accuracy_ctx.accuracy.updates,
+           (accuracy_ns - tokenizer_ns) / (reference.count / 2.0), 100.0 * (accuracy_ns - tokenizer_ns) / tokenizer_ns);
+    printf("values differing on complete sentences: %zu\n", differ_complete);
+    printf("values differing on sentences with empty fields: %zu (strtok shifts the fields that follow)\n", differ_empty);
+
+    if (differ_complete != 0) {
+        printf("FAIL\n");
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,483 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Compares ingesting UBX NAV-PVT (logic/ubx_parser.c) with NMEA (logic/nmea_parser.c), per fix.
+ * 按每次定位对比 UBX NAV-PVT（logic/ubx_parser.c）与 NMEA（logic/nmea_parser.c）的接收开销。
+ *
+ * The NMEA log is parsed the way gps_logic does: RMC and GGA paired on their UTC time, plus the GSA
+ * DOPs and GST sigmas. Each epoch is then encoded as the NAV-PVT a UBX receiver would send for it.
+ * Both streams are fed in 128-byte reads, and each handler converts its fields to the same fix
+ * record; the NMEA one also derives the velocity from RMC speed and course with cosf/sinf. The tool
+ * reports the bytes and the UART time per fix, and the CPU time per fix.
+ * 按 gps_logic 的方式解析 NMEA 日志：按 UTC 时间配对 RMC 与 GGA，并读取 GSA 的 DOP 与 GST 的 sigma。
+ * 然后将每个历元编码为 UBX 接收机对应输出的 NAV-PVT。两种数据流都以 128 字节为一次读取送入，各自的处理
+ * 函数把字段转换为相同的定位记录；NMEA 还需用 cosf/sinf 由 RMC 速度与航向求出速度。工具输出每次定位的
+ * 字节数与 UART 时间，以及每次定位的 CPU 时间。
+ *
+ * The process exits non-zero if any of these hold:
+ * - a decoded NAV-PVT differs from the NMEA fix it was built from
+ * - NMEA text ahead of the UBX stream costs a frame
+ * - a frame with one byte replaced is accepted
+ * 出现以下任一情况时进程返回非零值：
+ * - 解码出的 NAV-PVT 与其来源 NMEA 定位不一致
+ * - UBX 数据流之前的 NMEA 文本导致丢帧
+ * - 替换了一个字节的帧被接受
+ *
+ * Usage / 用法: ubx_decoder_bench <log.nmea> [rounds]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "nmea_parser.h"
+#include "ubx_parser.h"
+
+#define READ_SIZE       128
+#define DEFAULT_ROUNDS  5
+#define UART_BAUD       115200
+#define UART_BITS       10      // 8N1: start, 8 data, stop / 8N1：起始位、8 个数据位、停止位
+#define FIX_RATE_HZ     10
+#define CORRUPT_EVERY   20      // One frame in CORRUPT_EVERY gets a byte replaced / 每 CORRUPT_EVERY 帧替换一个字节
+
+/* One fix in the units of GPS_Data_t */
+/* 一次定位，单位与 GPS_Data_t 一致 */
+typedef struct {
+    int32_t time_ms;
+    uint8_t day, month, year;
+    uint8_t valid;
+    uint8_t satellites;
+    int32_t latitude_e7;
+    int32_t longitude_e7;
+    int32_t altitude_mm;
+    int32_t speed_mknots;
+    int32_t course_cdeg;
+    float velocity_north;
+    float velocity_east;
+    int32_t horizontal_sigma_mm;
+    int32_t vertical_sigma_mm;
+} fix_t;
+
+typedef struct {
+    fix_t *items;
+    size_t count;
+    size_t capacity;
+    int record;             // Keep the fixes, only on the first round / 保存定位，仅在第一轮
+} fix_list_t;
+
+static void list_add(fix_list_t *list, const fix_t *fix) {
+    if (!list->record) {
+        list->count++;
+        return;
+    }
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 4096;
+        list->items = realloc(list->items, list->capacity * sizeof(fix_t));
+    }
+    list->items[list->count++] = *fix;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint64_t s_random = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t next_random(void) {
+    s_random ^= s_random << 13;
+    s_random ^= s_random >> 7;
+    s_random ^= s_random << 17;
+    return s_random;
+}
+
+/* ---------- NMEA: the fields gps_logic reads ---------- */
+
+typedef struct {
+    fix_t fix;
+    int32_t rmc_time_ms, gga_time_ms;
+    uint8_t rmc_valid, gga_valid;
+    int32_t rmc_latitude, rmc_longitude, gga_latitude, gga_longitude;
+    int32_t pdop, hdop, vdop;
+    fix_list_t fixes;
+} nmea_state_t;
+
+static int32_t nmea_time_ms(const nmea_sentence_t *s, uint8_t index) {
+    uint8_t hour, minute, second;
+    uint16_t millisecond;
+    if (!nmea_field_time(s, index, &hour, &minute, &second, &millisecond)) {
+        return -1;
+    }
+    return ((hour * 60 + minute) * 60 + second) * 1000 + millisecond;
+}
+
+static int read_coordinate(const nmea_sentence_t *s, uint8_t value, uint8_t hemisphere, char negative, int32_t *out) {
+    int32_t degrees;
+    char indicator = nmea_field_char(s, hemisphere);
+    if (!nmea_field_degrees_e7(s, value, &degrees) || indicator == '\0') {
+        return 0;
+    }
+    *out = indicator == negative ? -degrees : degrees;
+    return 1;
+}
+
+static void nmea_handler(const nmea_sentence_t *s, void *ctx) {
+    nmea_state_t *st = ctx;
+    if (!nmea_talker_is_gnss(s)) {
+        return;
+    }
+    int32_t value;
+    switch (s->id) {
+        case NMEA_SENTENCE_RMC: {
+            st->rmc_time_ms = nmea_time_ms(s, 0);
+            st->rmc_valid = nmea_field_char(s, 1) == 'A';
+            read_coordinate(s, 2, 3, 'S', &st->rmc_latitude);
+            read_coordinate(s, 4, 5, 'W', &st->rmc_longitude);
+            nmea_field_fixed(s, 6, 3, &st->fix.speed_mknots);
+            nmea_field_fixed(s, 7, 2, &st->fix.course_cdeg);
+            nmea_field_date(s, 8, &st->fix.day, &st->fix.month, &st->fix.year);
+            float speed_m_s = (float)st->fix.speed_mknots * 0.000514444f;
+            float course_rad = (float)st->fix.course_cdeg * ((float)M_PI / 18000.0f);
+            st->fix.velocity_north = speed_m_s * cosf(course_rad);
+            st->fix.velocity_east = speed_m_s * sinf(course_rad);
+            break;
+        }
+        case NMEA_SENTENCE_GGA:
+            st->gga_time_ms = nmea_time_ms(s, 0);
+            read_coordinate(s, 1, 2, 'S', &st->gga_latitude);
+            read_coordinate(s, 3, 4, 'W', &st->gga_longitude);
+            st->gga_valid = nmea_field_int(s, 5, &value) && value > 0;
+            if (nmea_field_int(s, 6, &value)) {
+                st->fix.satellites = (uint8_t)value;
+            }
+            nmea_field_fixed(s, 7, 2, &st->hdop);
+            nmea_field_fixed(s, 8, 3, &st->fix.altitude_mm);
+            break;
+        case NMEA_SENTENCE_GSA:
+            nmea_field_fixed(s, 14, 2, &st->pdop);
+            nmea_field_fixed(s, 15, 2, &st->hdop);
+            nmea_field_fixed(s, 16, 2, &st->vdop);
+            return;
+        case NMEA_SENTENCE_GST:
+            nmea_field_fixed(s, 5, 3, &st->fix.horizontal_sigma_mm);
+            nmea_field_fixed(s, 7, 3, &st->fix.vertical_sigma_mm);
+            return;
+        default:
+            return;
+    }
+    if (st->rmc_time_ms >= 0 && st->rmc_time_ms == st->gga_time_ms) {
+        st->fix.time_ms = st->gga_time_ms;
+        st->fix.valid = st->rmc_valid && st->gga_valid;
+        st->fix.latitude_e7 = (int32_t)(((int64_t)st->rmc_latitude + st->gga_latitude) / 2);
+        st->fix.longitude_e7 = (int32_t)(((int64_t)st->rmc_longitude + st->gga_longitude) / 2);
+        list_add(&st->fixes, &st->fix);
+        st->rmc_time_ms = -1;
+        st->gga_time_ms = -1;
+    }
+}
+
+/* ---------- UBX: NAV-PVT to the same fix record ---------- */
+
+static void ubx_handler(const ubx_frame_t *frame, void *ctx) {
+    fix_list_t *fixes = ctx;
+    ubx_nav_pvt_t pvt;
+    if (ubx_parse_nav_pvt(frame, &pvt) != 0) {
+        return;
+    }
+    fix_t fix = {
+        .time_ms = (int32_t)(((pvt.hour * 60 + pvt.minute) * 60 + pvt.second) * 1000 + pvt.itow_ms % 1000),
+        .day = pvt.day,
+        .month = pvt.month,
+        .year = (uint8_t)(pvt.year % 100),
+        .valid = ubx_nav_pvt_fix_ok(&pvt),
+        .satellites = pvt.num_sv,
+        .latitude_e7 = pvt.latitude_e7,
+        .longitude_e7 = pvt.longitude_e7,
+        .altitude_mm = pvt.height_msl_mm,
+        .speed_mknots = (int32_t)((int64_t)pvt.ground_speed_mm_s * 1943844 / 1000000),
+        .course_cdeg = pvt.heading_motion_e5 / 1000,
+        .velocity_north = (float)pvt.velocity_north_mm_s * 1e-3f,
+        .velocity_east = (float)pvt.velocity_east_mm_s * 1e-3f,
+        .horizontal_sigma_mm = (int32_t)pvt.horizontal_accuracy_mm,
+        .vertical_sigma_mm = (int32_t)pvt.vertical_accuracy_mm,
+    };
+    list_add(fixes, &fix);
+}
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+/* The NAV-PVT a UBX receiver would send for this fix; itow is the time of day plus 18 leap seconds */
+/* UBX 接收机对应此定位输出的 NAV-PVT；itow 取当日时间加 18 个闰秒 */
+static size_t encode_nav_pvt(const fix_t *fix, uint8_t *out, size_t size) {
+    uint8_t p[UBX_NAV_PVT_LENGTH] = { 0 };
+    put_u32(p + 0, (uint32_t)fix->time_ms + 18000);
+    put_u16(p + 4, (uint16_t)(2000 + fix->year));
+    p[6] = fix->month;
+    p[7] = fix->day;
+    p[8] = (uint8_t)(fix->time_ms / 3600000);
+    p[9] = (uint8_t)(fix->time_ms / 60000 % 60);
+    p[10] = (uint8_t)(fix->time_ms / 1000 % 60);
+    p[11] = UBX_NAV_PVT_VALID_DATE | UBX_NAV_PVT_VALID_TIME;
+    p[20] = fix->valid ? UBX_FIX_TYPE_3D : 0;
+    p[21] = fix->valid ? UBX_NAV_PVT_GNSS_FIX_OK : 0;
+    p[23] = fix->satellites;
+    put_u32(p + 24, (uint32_t)fix->longitude_e7);
+    put_u32(p + 28, (uint32_t)fix->latitude_e7);
+    put_u32(p + 32, (uint32_t)fix->altitude_mm);
+    put_u32(p + 36, (uint32_t)fix->altitude_mm);
+    put_u32(p + 40, (uint32_t)fix->horizontal_sigma_mm);
+    put_u32(p + 44, (uint32_t)fix->vertical_sigma_mm);
+    put_u32(p + 48, (uint32_t)lrintf(fix->velocity_north * 1000.0f));
+    put_u32(p + 52, (uint32_t)lrintf(fix->velocity_east * 1000.0f));
+    put_u32(p + 60, (uint32_t)lrint(fix->speed_mknots * 0.514444));
+    put_u32(p + 64, (uint32_t)(fix->course_cdeg * 1000));
+    put_u32(p + 68, 200);
+    return ubx_build_frame(UBX_CLASS_NAV, UBX_ID_NAV_PVT, p, sizeof(p), out, size);
+}
+
+/* Speed goes through mm/s, which may move it by up to 2 mknots; the rest must match exactly */
+/* 速度经过 mm/s 换算，可能相差 2 mknots 以内；其余字段必须完全一致 */
+static int same_fix(const fix_t *a, const fix_t *b) {
+    if (a->valid != b->valid || a->time_ms != b->time_ms) {
+        return 0;
+    }
+    if (!a->valid) {
+        return 1;
+    }
+    return a->day == b->day && a->month == b->month && a->year == b->year && a->satellites == b->satellites &&
+           a->latitude_e7 == b->latitude_e7 && a->longitude_e7 == b->longitude_e7 &&
+           a->altitude_mm == b->altitude_mm && abs(a->speed_mknots - b->speed_mknots) <= 2 &&
+           a->course_cdeg == b->course_cdeg && fabsf(a->velocity_north - b->velocity_north) <= 0.0006f &&
+           fabsf(a->velocity_east - b->velocity_east) <= 0.0006f;
+}
+
+/* Frames accepted from the corrupted stream, checked against the original frames in order */
+/* 从被破坏的数据流中接受的帧，按顺序与原始帧比对 */
+typedef struct {
+    const uint8_t *original;
+    size_t frame_count;
+    size_t next;
+    size_t accepted;
+    size_t accepted_corrupted;
+} corruption_check_t;
+
+static void corruption_handler(const ubx_frame_t *frame, void *ctx) {
+    corruption_check_t *check = ctx;
+    check->accepted++;
+    const size_t frame_size = UBX_NAV_PVT_LENGTH + UBX_FRAME_OVERHEAD;
+    for (size_t i = check->next; i < check->frame_count && i < check->next + 4; i++) {
+        const uint8_t *original = check->original + i * frame_size;
+        if (frame->length == UBX_NAV_PVT_LENGTH && memcmp(original + 6, frame->payload, UBX_NAV_PVT_LENGTH) == 0) {
+            check->next = i + 1;
+            return;
+        }
+    }
+    check->accepted_corrupted++;
+}
+
+static char *read_file(const char *path, size_t *size) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    *size = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *data = malloc(*size + 1);
+    if (fread(data, 1, *size, f) != *size) {
+        fclose(f);
+        free(data);
+        return NULL;
+    }
+    fclose(f);
+    data[*size] = '\0';
+    return data;
+}
+
+static size_t count_rmc_gga_bytes(const char *log, size_t size) {
+    size_t bytes = 0;
+    for (const char *line = log; line < log + size;) {
+        const char *newline = memchr(line, '\n', (size_t)(log + size - line));
+        size_t length = newline ? (size_t)(newline - line) + 1 : (size_t)(log + size - line);
+        if (length > 6 && (memcmp(line + 3, "RMC", 3) == 0 || memcmp(line + 3, "GGA", 3) == 0)) {
+            bytes += length;
+        }
+        line += length;
+    }
+    return bytes;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <log.nmea> [rounds]\n", argv[0]);
+        return 2;
+    }
+    int rounds = argc > 2 ? atoi(argv[2]) : DEFAULT_ROUNDS;
+    if (rounds <= 0) {
+        rounds = DEFAULT_ROUNDS;
+    }
+    size_t nmea_size;
+    char *log = read_file(argv[1], &nmea_size);
+    if (log == NULL) {
+        return 2;
+    }
+
+    // NMEA rounds; the first one keeps the fixes the UBX stream is built from
+    // NMEA 各轮；第一轮保存定位，用于生成 UBX 数据流
+    nmea_state_t nmea = { .rmc_time_ms = -1, .gga_time_ms = -1, .fixes = { .record = 1 } };
+    double nmea_ns = 0.0;
+    for (int round = 0; round < rounds; round++) {
+        nmea_line_assembler_t assembler = { 0 };
+        nmea.fixes.count = 0;
+        double start = now_ns();
+        for (size_t pos = 0; pos < nmea_size; pos += READ_SIZE) {
+            size_t length = nmea_size - pos < READ_SIZE ? nmea_size - pos : READ_SIZE;
+            nmea_assembler_feed(&assembler, log + pos, length, nmea_handler, &nmea);
+        }
+        nmea_ns += now_ns() - start;
+        nmea.fixes.record = 0;
+    }
+    size_t epochs = nmea.fixes.count;
+    const fix_t *reference = nmea.fixes.items;
+
+    const size_t frame_size = UBX_NAV_PVT_LENGTH + UBX_FRAME_OVERHEAD;
+    size_t ubx_size = epochs * frame_size;
+    uint8_t *ubx = malloc(ubx_size);
+    for (size_t i = 0; i < epochs; i++) {
+        encode_nav_pvt(&reference[i], ubx + i * frame_size, frame_size);
+    }
+
+    // UBX rounds; the first one checks every decoded fix against its NMEA source
+    // UBX 各轮；第一轮将每个解码出的定位与其 NMEA 来源比对
+    fix_list_t ubx_fixes = { .record = 1 };
+    double ubx_ns = 0.0;
+    for (int round = 0; round < rounds; round++) {
+        ubx_decoder_t decoder = { 0 };
+        ubx_fixes.count = 0;
+        double start = now_ns();
+        for (size_t pos = 0; pos < ubx_size; pos += READ_SIZE) {
+            size_t length = ubx_size - pos < READ_SIZE ? ubx_size - pos : READ_SIZE;
+            ubx_decoder_feed(&decoder, ubx + pos, length, ubx_handler, &ubx_fixes);
+        }
+        ubx_ns += now_ns() - start;
+        ubx_fixes.record = 0;
+    }
+    int failed = 0;
+    size_t mismatches = 0;
+    if (ubx_fixes.count != epochs) {
+        printf("FAIL: %zu NAV-PVT decoded for %zu epochs\n", ubx_fixes.count, epochs);
+        failed = 1;
+    }
+    for (size_t i = 0; i < epochs && i < ubx_fixes.count; i++) {
+        if (!same_fix(&reference[i], &ubx_fixes.items[i])) {
+            if (mismatches++ == 0) {
+                printf("FAIL: epoch %zu at %ld ms differs between NMEA and NAV-PVT\n", i, (long)reference[i].time_ms);
+            }
+            failed = 1;
+        }
+    }
+
+    // NMEA text ahead of the binary stream, as right after the receiver is switched, must not cost a frame
+    // 二进制数据流之前的 NMEA 文本（例如接收机刚切换时）不得导致丢帧
+    size_t text = nmea_size < 65536 ? nmea_size : 65536;
+    uint8_t *mixed = malloc(text + ubx_size);
+    memcpy(mixed, log, text);
+    memcpy(mixed + text, ubx, ubx_size);
+    ubx_decoder_t mixed_decoder = { 0 };
+    for (size_t pos = 0; pos < text + ubx_size; pos += READ_SIZE) {
+        size_t length = text + ubx_size - pos < READ_SIZE ? text + ubx_size - pos : READ_SIZE;
+        ubx_decoder_feed(&mixed_decoder, mixed + pos, length, NULL, NULL);
+    }
+    if (mixed_decoder.stats.good != epochs || mixed_decoder.stats.bad != 0) {
+        printf("FAIL: after %zu bytes of NMEA text, %lu good and %lu bad frames for %zu epochs\n", text,
+               (unsigned long)mixed_decoder.stats.good, (unsigned long)mixed_decoder.stats.bad, epochs);
+        failed = 1;
+    }
+
+    // Replace one byte in one frame of CORRUPT_EVERY; the Fletcher checksum catches every single-byte change
+    // 每 CORRUPT_EVERY 帧替换其中一个字节；Fletcher 校验能发现所有单字节改动
+    uint8_t *corrupted = malloc(ubx_size);
+    memcpy(corrupted, ubx, ubx_size);
+    size_t replaced = 0;
+    for (size_t i = 0; i < epochs; i++) {
+        if (next_random() % CORRUPT_EVERY != 0) {
+            continue;
+        }
+        size_t at = i * frame_size + next_random() % frame_size;
+        corrupted[at] = (uint8_t)(corrupted[at] + 1 + next_random() % 255);
+        replaced++;
+    }
+    corruption_check_t check = { .original = ubx, .frame_count = epochs };
+    ubx_decoder_t corrupted_decoder = { 0 };
+    for (size_t pos = 0; pos < ubx_size; pos += READ_SIZE) {
+        size_t length = ubx_size - pos < READ_SIZE ? ubx_size - pos : READ_SIZE;
+        ubx_decoder_feed(&corrupted_decoder, corrupted + pos, length, corruption_handler, &check);
+    }
+    if (check.accepted_corrupted != 0) {
+        printf("FAIL: %zu corrupted frames accepted\n", check.accepted_corrupted);
+        failed = 1;
+    }
+
+    size_t rmc_gga_bytes = count_rmc_gga_bytes(log, nmea_size);
+    double nmea_bytes = (double)nmea_size / epochs, rmc_gga = (double)rmc_gga_bytes / epochs;
+    double ubx_bytes = (double)frame_size;
+    double nmea_fix_ns = nmea_ns / rounds / epochs, ubx_fix_ns = ubx_ns / rounds / epochs;
+
+    printf("%zu epochs, %d rounds, %d-byte reads\n\n", epochs, rounds, READ_SIZE);
+    printf("| Stream | Bytes/fix | UART ms/fix at %d | Link load at %d Hz | ns/fix | fixes/s |\n", UART_BAUD, FIX_RATE_HZ);
+    printf("|---|---|---|---|---|---|\n");
+    printf("| NMEA, all sentences | %.1f | %.2f | %.1f%% | %.1f | %.2f M |\n", nmea_bytes,
+           nmea_bytes * UART_BITS * 1000.0 / UART_BAUD, 100.0 * nmea_bytes * UART_BITS * FIX_RATE_HZ / UART_BAUD,
+           nmea_fix_ns, 1e3 / nmea_fix_ns);
+    printf("| NMEA, RMC + GGA only | %.1f | %.2f | %.1f%% | - | - |\n", rmc_gga,
+           rmc_gga * UART_BITS * 1000.0 / UART_BAUD, 100.0 * rmc_gga * UART_BITS * FIX_RATE_HZ / UART_BAUD);
+    printf("| UBX NAV-PVT | %.1f | %.2f | %.1f%% | %.1f | %.2f M |\n\n", ubx_bytes,
+           ubx_bytes * UART_BITS * 1000.0 / UART_BAUD, 100.0 * ubx_bytes * UART_BITS * FIX_RATE_HZ / UART_BAUD,
+           ubx_fix_ns, 1e3 / ubx_fix_ns);
+    printf("NAV-PVT vs NMEA: %.2fx fewer bytes, %.2fx less CPU per fix\n", nmea_bytes / ubx_bytes,
+           nmea_fix_ns / ubx_fix_ns);
+    printf("decoded fixes matching NMEA: %zu of %zu\n", epochs - mismatches, epochs);
+    printf("after %zu bytes of NMEA text: %lu of %zu frames\n", text, (unsigned long)mixed_decoder.stats.good, epochs);
+    printf("corruption: %zu bytes replaced, %lu bad, %lu oversize, %zu good frames accepted, %zu corrupted accepted\n",
+           replaced, (unsigned long)corrupted_decoder.stats.bad, (unsigned long)corrupted_decoder.stats.oversize,
+           check.accepted, check.accepted_corrupted);
+    printf("%s\n", failed ? "FAIL" : "PASS");
+
+    free(corrupted);
+    free(mixed);
+    free(ubx);
+    free(ubx_fixes.items);
+    free(nmea.fixes.items);
+    free(log);
+    return failed;
+}
@@ -0,0 +1,34 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Host-side stand-in for ESP-IDF's driver/gpio.h, only the pin numbers gps_logic.h uses.
+ * 用于主机端测试工具的 ESP-IDF driver/gpio.h 替代实现，仅提供 gps_logic.h 用到的引脚号。
+ */
+
+#ifndef HOST_STUBS_DRIVER_GPIO_H
+#define HOST_STUBS_DRIVER_GPIO_H
+
+typedef enum {
+    GPIO_NUM_NC = -1,
+    GPIO_NUM_4 = 4,
+    GPIO_NUM_5 = 5,
+} gpio_num_t;
+
+#endif
@@ -0,0 +1,56 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Host stand-in for the Bluedroid Bluetooth definitions used by ble.c and product_nvs.c
+ * 主机端替代 ble.c 与 product_nvs.c 所用的 Bluedroid 蓝牙定义
+ */
+
+#ifndef HOST_STUBS_ESP_BT_DEFS_H
+#define HOST_STUBS_ESP_BT_DEFS_H
+
+#include <stdint.h>
+
+#define ESP_BD_ADDR_LEN   6
+typedef uint8_t esp_bd_addr_t[ESP_BD_ADDR_LEN];
+
+typedef enum {
+    ESP_BT_STATUS_SUCCESS = 0,
+    ESP_BT_STATUS_FAIL,
+} esp_bt_status_t;
+
+typedef enum {
+    BLE_ADDR_TYPE_PUBLIC = 0x00,
+    BLE_ADDR_TYPE_RANDOM = 0x01,
+} esp_ble_addr_type_t;
+
+#define ESP_UUID_LEN_16   2
+#define ESP_UUID_LEN_32   4
+#define ESP_UUID_LEN_128  16
+
+typedef struct {
+    uint16_t len;
+    union {
+        uint16_t uuid16;
+        uint32_t uuid32;
+        uint8_t uuid128[ESP_UUID_LEN_128];
+    } uuid;
+} __attribute__((packed)) esp_bt_uuid_t;
+
+#endif
@@ -0,0 +1,198 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Host stand-in for the Bluedroid GAP API used by ble.c, implemented by the simulated stack in test/ble_link.
+ * 主机端替代 ble.c 所用的 Bluedroid GAP API，由 test/ble_link 中的模拟协议栈实现。
+ */
+
+#ifndef HOST_STUBS_ESP_GAP_BLE_API_H
+#define HOST_STUBS_ESP_GAP_BLE_API_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "esp_err.h"
+#include "esp_bt_defs.h"
+
+#define ESP_BLE_ADV_DATA_LEN_MAX        31
+#define ESP_BLE_SCAN_RSP_DATA_LEN_MAX   31
+#define ESP_BLE_ADV_NAME_LEN_MAX        29
+
+#define ESP_BLE_AD_TYPE_NAME_CMPL               0x09
+#define ESP_BLE_AD_MANUFACTURER_SPECIFIC_TYPE   0xFF
+typedef uint8_t esp_ble_adv_data_type;
+
+typedef enum {
+    ESP_GAP_BLE_ADV_DATA_RAW_SET_COMPLETE_EVT,
+    ESP_GAP_BLE_SCAN_PARAM_SET_COMPLETE_EVT,
+    ESP_GAP_BLE_SCAN_RESULT_EVT,
+    ESP_GAP_BLE_ADV_START_COMPLETE_EVT,
+    ESP_GAP_BLE_SCAN_START_COMPLETE_EVT,
+    ESP_GAP_BLE_ADV_STOP_COMPLETE_EVT,
+    ESP_GAP_BLE_SCAN_STOP_COMPLETE_EVT,
+    ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT,
+    ESP_GAP_BLE_SET_PKT_LENGTH_COMPLETE_EVT,
+    ESP_GAP_BLE_SET_PREFERRED_PHY_COMPLETE_EVT,
+    ESP_GAP_BLE_PHY_UPDATE_COMPLETE_EVT,
+} esp_gap_ble_cb_event_t;
+
+typedef enum {
+    ESP_GAP_SEARCH_INQ_RES_EVT = 0,
+    ESP_GAP_SEARCH_INQ_CMPL_EVT = 1,
+} esp_gap_search_evt_t;
+
+typedef enum {
+    BLE_SCAN_TYPE_PASSIVE = 0x0,
+    BLE_SCAN_TYPE_ACTIVE = 0x1,
+} esp_ble_scan_type_t;
+
+typedef enum {
+    BLE_SCAN_FILTER_ALLOW_ALL = 0x0,
+} esp_ble_scan_filter_t;
+
+typedef enum {
+    BLE_SCAN_DUPLICATE_DISABLE = 0x0,
+    BLE_SCAN_DUPLICATE_ENABLE = 0x1,
+} esp_ble_scan_duplicate_t;
+
+typedef struct {
+    esp_ble_scan_type_t scan_type;
+    esp_ble_addr_type_t own_addr_type;
+    esp_ble_scan_filter_t scan_filter_policy;
+    uint16_t scan_interval;
+    uint16_t scan_window;
+    esp_ble_scan_duplicate_t scan_duplicate;
+} esp_ble_scan_params_t;
+
+typedef enum {
+    ADV_TYPE_IND = 0x00,
+} esp_ble_adv_type_t;
+
+typedef enum {
+    ADV_CHNL_ALL = 0x07,
+} esp_ble_adv_channel_t;
+
+typedef struct {
+    uint16_t adv_int_min;
+    uint16_t adv_int_max;
+    esp_ble_adv_type_t adv_type;
+    esp_ble_addr_type_t own_addr_type;
+    esp_ble_adv_channel_t channel_map;
+} esp_ble_adv_params_t;
+
+typedef struct {
+    esp_bd_addr_t bda;
+    uint16_t min_int;               // 1.25 ms units
+    uint16_t max_int;
+    uint16_t latency;               // Connection events the peripheral may skip
+    uint16_t timeout;               // Supervision timeout, 10 ms units
+} esp_ble_conn_update_params_t;
+
+typedef struct {
+    uint16_t rx_len;
+    uint16_t tx_len;
+} esp_ble_pkt_data_length_params_t;
+
+typedef uint8_t esp_ble_gap_all_phys_t;
+#define ESP_BLE_GAP_NO_PREFER_TRANSMIT_PHY  (1 << 0)
+#define ESP_BLE_GAP_NO_PREFER_RECEIVE_PHY   (1 << 1)
+
+typedef uint8_t esp_ble_gap_phy_mask_t;
+#define ESP_BLE_GAP_PHY_1M_PREF_MASK        (1 << 0)
+#define ESP_BLE_GAP_PHY_2M_PREF_MASK        (1 << 1)
+#define ESP_BLE_GAP_PHY_CODED_PREF_MASK     (1 << 2)
+
+typedef uint16_t esp_ble_gap_prefer_phy_options_t;
+#define ESP_BLE_GAP_PHY_OPTIONS_NO_PREF     0
+
+typedef uint8_t esp_ble_gap_phy_t;
+#define ESP_BLE_GAP_PHY_1M                  1
+#define ESP_BLE_GAP_PHY_2M                  2
+#define ESP_BLE_GAP_PHY_CODED               3
+
+typedef union {
+    struct ble_scan_param_cmpl_evt_param {
+        esp_bt_status_t status;
+    } scan_param_cmpl;
+
+    struct ble_scan_result_evt_param {
+        esp_gap_search_evt_t search_evt;
+        esp_bd_addr_t bda;
+        esp_ble_addr_type_t ble_addr_type;
+        int rssi;
+        uint8_t ble_adv[ESP_BLE_ADV_DATA_LEN_MAX + ESP_BLE_SCAN_RSP_DATA_LEN_MAX];
+        uint8_t adv_data_len;
+        uint8_t scan_rsp_len;
+    } scan_rst;
+
+    struct ble_scan_start_cmpl_evt_param {
+        esp_bt_status_t status;
+    } scan_start_cmpl;
+
+    struct ble_scan_stop_cmpl_evt_param {
+        esp_bt_status_t status;
+    } scan_stop_cmpl;
+
+    struct ble_update_conn_params_evt_param {
+        esp_bt_status_t status;
+        esp_bd_addr_t bda;
+        uint16_t min_int;
+        uint16_t max_int;
+        uint16_t latency;
+        uint16_t conn_int;
+        uint16_t timeout;
+    } update_conn_params;
+
+    struct ble_pkt_data_length_cmpl_evt_param {
+        esp_bt_status_t status;
+        esp_ble_pkt_data_length_params_t params;
+    } pkt_data_length_cmpl;
+
+    struct ble_set_perf_phy_cmpl_evt_param {
+        esp_bt_status_t status;
+    } set_perf_phy;
+
+    struct ble_phy_update_cmpl_evt_param {
+        esp_bt_status_t status;
+        esp_bd_addr_t bda;
+        esp_ble_gap_phy_t tx_phy;
+        esp_ble_gap_phy_t rx_phy;
+    } phy_update;
+} esp_ble_gap_cb_param_t;
+
+typedef void (*esp_gap_ble_cb_t)(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param);
+
+esp_err_t esp_ble_gap_register_callback(esp_gap_ble_cb_t callback);
+esp_err_t esp_ble_gap_set_scan_params(esp_ble_scan_params_t *scan_params);
+esp_err_t esp_ble_gap_start_scanning(uint32_t duration);
+esp_err_t esp_ble_gap_stop_scanning(void);
+uint16_t esp_ble_get_cur_sendable_packets_num(uint16_t connid);
+esp_err_t esp_ble_gap_update_conn_params(esp_ble_conn_update_params_t *params);
+esp_err_t esp_ble_gap_set_pkt_data_len(esp_bd_addr_t remote_device, uint16_t tx_data_length);
+esp_err_t esp_ble_gap_set_preferred_phy(esp_bd_addr_t bd_addr, esp_ble_gap_all_phys_t all_phys_mask,
+                                        esp_ble_gap_phy_mask_t tx_phy_mask, esp_ble_gap_phy_mask_t rx_phy_mask,
+                                        esp_ble_gap_prefer_phy_options_t phy_options);
+uint8_t *esp_ble_resolve_adv_data_by_type(uint8_t *adv_data, uint16_t adv_data_len, esp_ble_adv_data_type type,
+                                          uint8_t *length);
+esp_err_t esp_ble_gap_config_adv_data_raw(uint8_t *raw_data, uint32_t raw_data_len);
+esp_err_t esp_ble_gap_start_advertising(esp_ble_adv_params_t *adv_params);
+esp_err_t esp_ble_gap_stop_advertising(void);
+
+#endif
@@ -0,0 +1,31 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/* Host stand-in for the local MTU setting in ble_init, see esp_gap_ble_api.h */
+/* 主机端替代 ble_init 中的本地 MTU 设置，参见 esp_gap_ble_api.h */
+
+#ifndef HOST_STUBS_ESP_GATT_COMMON_API_H
+#define HOST_STUBS_ESP_GATT_COMMON_API_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+esp_err_t esp_ble_gatt_set_local_mtu(uint16_t mtu);
+
+#endif
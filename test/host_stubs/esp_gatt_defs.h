@@ -0,0 +1,72 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/* Host stand-in for the Bluedroid GATT definitions referenced by ble.h and ble.c */
+/* 主机端替代 ble.h 与 ble.c 所引用的 Bluedroid GATT 定义 */
+
+#ifndef HOST_STUBS_ESP_GATT_DEFS_H
+#define HOST_STUBS_ESP_GATT_DEFS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "esp_bt_defs.h"
+
+#define ESP_GATT_IF_NONE  0xff
+
+#define ESP_GATT_UUID_CHAR_DECLARE        0x2803
+#define ESP_GATT_UUID_CHAR_CLIENT_CONFIG  0x2902
+
+#define ESP_GATT_CHAR_PROP_BIT_READ       (1 << 1)
+#define ESP_GATT_CHAR_PROP_BIT_WRITE_NR   (1 << 2)
+#define ESP_GATT_CHAR_PROP_BIT_WRITE      (1 << 3)
+#define ESP_GATT_CHAR_PROP_BIT_NOTIFY     (1 << 4)
+
+typedef uint8_t esp_gatt_if_t;
+typedef uint8_t esp_gatt_char_prop_t;
+
+typedef enum {
+    ESP_GATT_OK                 = 0x00,
+    ESP_GATT_INVALID_HANDLE     = 0x01,
+    ESP_GATT_READ_NOT_PERMIT    = 0x02,
+    ESP_GATT_WRITE_NOT_PERMIT   = 0x03,
+    ESP_GATT_INVALID_PDU        = 0x04,
+    ESP_GATT_NOT_FOUND          = 0x0a,
+    ESP_GATT_NO_RESOURCES       = 0x80,
+    ESP_GATT_INTERNAL_ERROR     = 0x81,
+    ESP_GATT_BUSY               = 0x84,
+    ESP_GATT_ERROR              = 0x85,
+    ESP_GATT_CONGESTED          = 0x8f,
+} esp_gatt_status_t;
+
+typedef enum {
+    ESP_GATT_WRITE_TYPE_NO_RSP = 1,
+    ESP_GATT_WRITE_TYPE_RSP,
+} esp_gatt_write_type_t;
+
+typedef enum {
+    ESP_GATT_AUTH_REQ_NONE = 0,
+} esp_gatt_auth_req_t;
+
+typedef struct {
+    esp_bt_uuid_t uuid;
+    uint8_t inst_id;
+} __attribute__((packed)) esp_gatt_id_t;
+
+#endif
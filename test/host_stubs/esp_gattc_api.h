@@ -0,0 +1,176 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Host stand-in for the Bluedroid GATT client API. The functions are implemented by the
+ * simulated stack in test/ble_link; the other host tools only use the types.
+ * 主机端替代 Bluedroid GATT 客户端 API。函数由 test/ble_link 中的模拟协议栈实现，其他主机工具只使用其中的类型。
+ */
+
+#ifndef HOST_STUBS_ESP_GATTC_API_H
+#define HOST_STUBS_ESP_GATTC_API_H
+
+#include "esp_err.h"
+#include "esp_bt_defs.h"
+#include "esp_gatt_defs.h"
+
+typedef enum {
+    ESP_GATTC_REG_EVT,
+    ESP_GATTC_OPEN_EVT,
+    ESP_GATTC_READ_CHAR_EVT,
+    ESP_GATTC_WRITE_CHAR_EVT,
+    ESP_GATTC_CLOSE_EVT,
+    ESP_GATTC_SEARCH_CMPL_EVT,
+    ESP_GATTC_SEARCH_RES_EVT,
+    ESP_GATTC_WRITE_DESCR_EVT,
+    ESP_GATTC_NOTIFY_EVT,
+    ESP_GATTC_SRVC_CHG_EVT,
+    ESP_GATTC_CFG_MTU_EVT,
+    ESP_GATTC_CONGEST_EVT,
+    ESP_GATTC_REG_FOR_NOTIFY_EVT,
+    ESP_GATTC_CONNECT_EVT,
+    ESP_GATTC_DISCONNECT_EVT,
+} esp_gattc_cb_event_t;
+
+typedef union {
+    struct gattc_reg_evt_param {
+        esp_gatt_status_t status;
+        uint16_t app_id;
+    } reg;
+
+    struct gattc_open_evt_param {
+        esp_gatt_status_t status;
+        uint16_t conn_id;
+        esp_bd_addr_t remote_bda;
+        uint16_t mtu;
+    } open;
+
+    struct gattc_close_evt_param {
+        esp_gatt_status_t status;
+        uint16_t conn_id;
+        esp_bd_addr_t remote_bda;
+        int reason;
+    } close;
+
+    struct gattc_cfg_mtu_evt_param {
+        esp_gatt_status_t status;
+        uint16_t conn_id;
+        uint16_t mtu;
+    } cfg_mtu;
+
+    struct gattc_search_cmpl_evt_param {
+        esp_gatt_status_t status;
+        uint16_t conn_id;
+    } search_cmpl;
+
+    struct gattc_search_res_evt_param {
+        uint16_t conn_id;
+        uint16_t start_handle;
+        uint16_t end_handle;
+        esp_gatt_id_t srvc_id;
+        bool is_primary;
+    } search_res;
+
+    struct gattc_read_char_evt_param {
+        esp_gatt_status_t status;
+        uint16_t conn_id;
+        uint16_t handle;
+        uint8_t *value;
+        uint16_t value_len;
+    } read;
+
+    struct gattc_write_evt_param {
+        esp_gatt_status_t status;
+        uint16_t conn_id;
+        uint16_t handle;
+        uint16_t offset;
+    } write;
+
+    struct gattc_notify_evt_param {
+        uint16_t conn_id;
+        esp_bd_addr_t remote_bda;
+        uint16_t handle;
+        uint16_t value_len;
+        uint8_t *value;
+        bool is_notify;
+    } notify;
+
+    struct gattc_srvc_chg_evt_param {
+        esp_bd_addr_t remote_bda;
+    } srvc_chg;
+
+    struct gattc_congest_evt_param {
+        uint16_t conn_id;
+        bool congested;
+    } congest;
+
+    struct gattc_reg_for_notify_evt_param {
+        esp_gatt_status_t status;
+        uint16_t handle;
+    } reg_for_notify;
+
+    struct gattc_connect_evt_param {
+        uint16_t conn_id;
+        uint8_t link_role;
+        esp_bd_addr_t remote_bda;
+    } connect;
+
+    struct gattc_disconnect_evt_param {
+        int reason;
+        uint16_t conn_id;
+        esp_bd_addr_t remote_bda;
+    } disconnect;
+} esp_ble_gattc_cb_param_t;
+
+typedef struct {
+    uint16_t char_handle;
+    esp_gatt_char_prop_t properties;
+    esp_bt_uuid_t uuid;
+} esp_gattc_char_elem_t;
+
+typedef struct {
+    uint16_t handle;
+    esp_bt_uuid_t uuid;
+} esp_gattc_descr_elem_t;
+
+typedef void (*esp_gattc_cb_t)(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_if, esp_ble_gattc_cb_param_t *param);
+
+esp_err_t esp_ble_gattc_register_callback(esp_gattc_cb_t callback);
+esp_err_t esp_ble_gattc_app_register(uint16_t app_id);
+esp_err_t esp_ble_gattc_open(esp_gatt_if_t gattc_if, esp_bd_addr_t remote_bda, esp_ble_addr_type_t remote_addr_type,
+                             bool is_direct);
+esp_err_t esp_ble_gattc_close(esp_gatt_if_t gattc_if, uint16_t conn_id);
+esp_err_t esp_ble_gattc_send_mtu_req(esp_gatt_if_t gattc_if, uint16_t conn_id);
+esp_err_t esp_ble_gattc_search_service(esp_gatt_if_t gattc_if, uint16_t conn_id, esp_bt_uuid_t *filter_uuid);
+esp_gatt_status_t esp_ble_gattc_get_char_by_uuid(esp_gatt_if_t gattc_if, uint16_t conn_id, uint16_t start_handle,
+                                                 uint16_t end_handle, esp_bt_uuid_t char_uuid,
+                                                 esp_gattc_char_elem_t *result, uint16_t *count);
+esp_gatt_status_t esp_ble_gattc_get_descr_by_char_handle(esp_gatt_if_t gattc_if, uint16_t conn_id,
+                                                         uint16_t char_handle, esp_bt_uuid_t descr_uuid,
+                                                         esp_gattc_descr_elem_t *result, uint16_t *count);
+esp_err_t esp_ble_gattc_read_char(esp_gatt_if_t gattc_if, uint16_t conn_id, uint16_t handle,
+                                  esp_gatt_auth_req_t auth_req);
+esp_err_t esp_ble_gattc_write_char(esp_gatt_if_t gattc_if, uint16_t conn_id, uint16_t handle, uint16_t value_len,
+                                   uint8_t *value, esp_gatt_write_type_t write_type, esp_gatt_auth_req_t auth_req);
+esp_err_t esp_ble_gattc_write_char_descr(esp_gatt_if_t gattc_if, uint16_t conn_id, uint16_t handle,
+                                         uint16_t value_len, uint8_t *value, esp_gatt_write_type_t write_type,
+                                         esp_gatt_auth_req_t auth_req);
+esp_err_t esp_ble_gattc_register_for_notify(esp_gatt_if_t gattc_if, esp_bd_addr_t server_bda, uint16_t handle);
+
+#endif
@@ -0,0 +1,61 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Host-side stand-in for ESP-IDF's esp_log.h.
+ * 主机端 ESP-IDF esp_log.h 替代实现。
+ *
+ * Only messages at or below HOST_LOG_LEVEL are printed (0 = none, 1 = error,
+ * 2 = warning, 3 = info), so benchmarks are not dominated by console output.
+ * 仅打印不高于 HOST_LOG_LEVEL 的日志（0 关闭，1 错误，2 警告，3 信息），避免基准测试被控制台输出拖慢。
+ */
+
+#ifndef HOST_STUBS_ESP_LOG_H
+#define HOST_STUBS_ESP_LOG_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#ifndef HOST_LOG_LEVEL
+#define HOST_LOG_LEVEL 1
+#endif
+
+#define HOST_LOG(level, letter, tag, fmt, ...) do {                         \
+        if ((level) <= HOST_LOG_LEVEL) {                                      \
+            fprintf(stderr, letter " %s: " fmt "\n", tag, ##__VA_ARGS__);     \
+        }                                                                     \
+    } while (0)
+
+#define ESP_LOGE(tag, fmt, ...) HOST_LOG(1, "E", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) HOST_LOG(2, "W", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) HOST_LOG(3, "I", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) HOST_LOG(4, "D", tag, fmt, ##__VA_ARGS__)
+
+#define ESP_LOG_BUFFER_HEX(tag, buf, len) do {                              \
+        if (3 <= HOST_LOG_LEVEL) {                                            \
+            const unsigned char *p_ = (const unsigned char *)(buf);           \
+            fprintf(stderr, "I %s:", tag);                                    \
+            for (size_t i_ = 0; i_ < (size_t)(len); i_++) {                   \
+                fprintf(stderr, " %02x", p_[i_]);                             \
+            }                                                                 \
+            fprintf(stderr, "\n");                                            \
+        }                                                                     \
+    } while (0)
+
+#endif
@@ -0,0 +1,70 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * One-shot esp_timer on top of the FreeRTOS timer stub, see esp_timer.h. Resolution is one tick (1 ms).
+ * 基于 FreeRTOS 定时器替代实现的单次 esp_timer，参见 esp_timer.h。分辨率为一个 tick（1 ms）。
+ */
+
+#include <stdlib.h>
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/timers.h"
+
+struct esp_timer {
+    TimerHandle_t timer;
+    esp_timer_cb_t callback;
+    void *arg;
+};
+
+static void timer_expired(TimerHandle_t timer) {
+    esp_timer_handle_t t = pvTimerGetTimerID(timer);
+    t->callback(t->arg);
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle) {
+    if (create_args == NULL || create_args->callback == NULL || out_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_timer_handle_t t = calloc(1, sizeof(*t));
+    if (t == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    t->callback = create_args->callback;
+    t->arg = create_args->arg;
+    t->timer = xTimerCreate(create_args->name, 1, pdFALSE, t, timer_expired);
+    if (t->timer == NULL) {
+        free(t);
+        return ESP_ERR_NO_MEM;
+    }
+    *out_handle = t;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    TickType_t ticks = (TickType_t)((timeout_us + 999) / 1000);
+    xTimerChangePeriod(timer->timer, ticks ? ticks : 1, 0);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    xTimerStop(timer->timer, 0);
+    return ESP_OK;
+}
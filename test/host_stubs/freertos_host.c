@@ -0,0 +1,515 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * pthread backed implementation of the FreeRTOS subset declared in freertos/FreeRTOS.h.
+ * freertos/FreeRTOS.h 中所声明 FreeRTOS 子集的 pthread 实现。
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+
+#include "freertos/FreeRTOS.h"
+
+static pthread_mutex_t s_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static host_freertos_stats_t s_stats;
+
+static pthread_mutex_t s_critical_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void stats_add(unsigned long *counter) {
+    pthread_mutex_lock(&s_stats_lock);
+    (*counter)++;
+    pthread_mutex_unlock(&s_stats_lock);
+}
+
+void host_freertos_get_stats(host_freertos_stats_t *out) {
+    pthread_mutex_lock(&s_stats_lock);
+    *out = s_stats;
+    pthread_mutex_unlock(&s_stats_lock);
+}
+
+void host_enter_critical(void) {
+    pthread_mutex_lock(&s_critical_lock);
+}
+
+void host_exit_critical(void) {
+    pthread_mutex_unlock(&s_critical_lock);
+}
+
+/* ---------- time ---------- */
+
+static void make_deadline(struct timespec *ts, TickType_t ticks) {
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec += ticks / 1000;
+    ts->tv_nsec += (long)(ticks % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+static void init_cond(pthread_cond_t *cond) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+/* Wait on cond until pred() holds or the tick budget runs out; lock must be held */
+/* 在持锁状态下等待条件成立或超时 */
+#define WAIT_UNTIL(cond, lock, ticks, pred)                              \
+    ({                                                                   \
+        int _ok = 1;                                                     \
+        if (!(pred)) {                                                   \
+            if ((ticks) == 0) {                                          \
+                _ok = 0;                                                 \
+            } else if ((ticks) == portMAX_DELAY) {                       \
+                while (!(pred)) pthread_cond_wait((cond), (lock));       \
+            } else {                                                     \
+                struct timespec _dl;                                     \
+                make_deadline(&_dl, (ticks));                            \
+                while (!(pred)) {                                        \
+                    if (pthread_cond_timedwait((cond), (lock), &_dl) == ETIMEDOUT) { \
+                        _ok = (pred);                                    \
+                        break;                                           \
+                    }                                                    \
+                }                                                        \
+            }                                                            \
+        }                                                                \
+        _ok;                                                             \
+    })
+
+TickType_t xTaskGetTickCount(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (TickType_t)((uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u);
+}
+
+TickType_t xTaskGetTickCountFromISR(void) {
+    return xTaskGetTickCount();
+}
+
+void vTaskDelay(TickType_t ticks) {
+    struct timespec ts = { .tv_sec = ticks / 1000, .tv_nsec = (long)(ticks % 1000) * 1000000L };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+/* ---------- semaphores ---------- */
+
+struct host_sem {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    UBaseType_t count;
+    UBaseType_t max;
+};
+
+static SemaphoreHandle_t sem_create(UBaseType_t max, UBaseType_t initial) {
+    SemaphoreHandle_t sem = calloc(1, sizeof(*sem));
+    if (sem == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&sem->lock, NULL);
+    init_cond(&sem->cond);
+    sem->count = initial;
+    sem->max = max;
+    stats_add(&s_stats.semaphores_created);
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    /* Priority inheritance and recursion checks are not emulated */
+    /* 不模拟优先级继承和递归检查 */
+    return sem_create(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return sem_create(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count) {
+    return sem_create(max_count, initial_count);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    pthread_mutex_lock(&sem->lock);
+    int ok = WAIT_UNTIL(&sem->cond, &sem->lock, ticks, sem->count > 0);
+    if (ok) {
+        sem->count--;
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    BaseType_t ret = pdFALSE;
+    pthread_mutex_lock(&sem->lock);
+    if (sem->count < sem->max) {
+        sem->count++;
+        ret = pdTRUE;
+        pthread_cond_signal(&sem->cond);
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ret;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *woken) {
+    if (woken) {
+        *woken = pdFALSE;
+    }
+    return xSemaphoreGive(sem);
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t sem) {
+    pthread_mutex_lock(&sem->lock);
+    UBaseType_t count = sem->count;
+    pthread_mutex_unlock(&sem->lock);
+    return count;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+    if (sem == NULL) {
+        return;
+    }
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->lock);
+    free(sem);
+    stats_add(&s_stats.semaphores_deleted);
+}
+
+/* ---------- queues ---------- */
+
+struct host_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    uint8_t *storage;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    QueueHandle_t q = calloc(1, sizeof(*q));
+    if (q == NULL) {
+        return NULL;
+    }
+    q->storage = malloc((size_t)length * item_size);
+    if (q->storage == NULL) {
+        free(q);
+        return NULL;
+    }
+    pthread_mutex_init(&q->lock, NULL);
+    init_cond(&q->not_empty);
+    init_cond(&q->not_full);
+    q->length = length;
+    q->item_size = item_size;
+    stats_add(&s_stats.queues_created);
+    return q;
+}
+
+static void queue_push_locked(QueueHandle_t q, const void *item) {
+    UBaseType_t tail = (q->head + q->count) % q->length;
+    memcpy(q->storage + (size_t)tail * q->item_size, item, q->item_size);
+    q->count++;
+    pthread_cond_signal(&q->not_empty);
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks) {
+    pthread_mutex_lock(&q->lock);
+    int ok = WAIT_UNTIL(&q->not_full, &q->lock, ticks, q->count < q->length);
+    if (ok) {
+        queue_push_locked(q, item);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t q, const void *item, BaseType_t *woken) {
+    if (woken) {
+        *woken = pdFALSE;
+    }
+    return xQueueSend(q, item, 0);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t q, const void *item) {
+    pthread_mutex_lock(&q->lock);
+    if (q->count == q->length) {
+        q->head = (q->head + 1) % q->length;
+        q->count--;
+    }
+    queue_push_locked(q, item);
+    pthread_mutex_unlock(&q->lock);
+    return pdTRUE;
+}
+
+static BaseType_t queue_take(QueueHandle_t q, void *item, TickType_t ticks, bool remove) {
+    pthread_mutex_lock(&q->lock);
+    int ok = WAIT_UNTIL(&q->not_empty, &q->lock, ticks, q->count > 0);
+    if (ok) {
+        memcpy(item, q->storage + (size_t)q->head * q->item_size, q->item_size);
+        if (remove) {
+            q->head = (q->head + 1) % q->length;
+            q->count--;
+            pthread_cond_signal(&q->not_full);
+        }
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks) {
+    return queue_take(q, item, ticks, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t q, void *item, TickType_t ticks) {
+    return queue_take(q, item, ticks, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+    pthread_mutex_lock(&q->lock);
+    UBaseType_t count = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return count;
+}
+
+BaseType_t xQueueReset(QueueHandle_t q) {
+    pthread_mutex_lock(&q->lock);
+    q->head = 0;
+    q->count = 0;
+    pthread_cond_broadcast(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+    return pdPASS;
+}
+
+void vQueueDelete(QueueHandle_t q) {
+    if (q == NULL) {
+        return;
+    }
+    pthread_cond_destroy(&q->not_empty);
+    pthread_cond_destroy(&q->not_full);
+    pthread_mutex_destroy(&q->lock);
+    free(q->storage);
+    free(q);
+    stats_add(&s_stats.queues_deleted);
+}
+
+/* ---------- tasks ---------- */
+
+struct host_task {
+    pthread_t thread;
+    TaskFunction_t fn;
+    void *param;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify;
+};
+
+static __thread TaskHandle_t s_current_task;
+
+static TaskHandle_t task_alloc(void) {
+    TaskHandle_t t = calloc(1, sizeof(*t));
+    if (t != NULL) {
+        pthread_mutex_init(&t->lock, NULL);
+        init_cond(&t->cond);
+    }
+    return t;
+}
+
+static void *task_trampoline(void *arg) {
+    TaskHandle_t t = arg;
+    s_current_task = t;
+    t->fn(t->param);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                       void *param, UBaseType_t priority, TaskHandle_t *out_handle) {
+    (void)name;
+    (void)stack_depth;
+    (void)priority;
+    TaskHandle_t t = task_alloc();
+    if (t == NULL) {
+        return pdFAIL;
+    }
+    t->fn = fn;
+    t->param = param;
+    if (pthread_create(&t->thread, NULL, task_trampoline, t) != 0) {
+        free(t);
+        return pdFAIL;
+    }
+    pthread_detach(t->thread);
+    if (out_handle) {
+        *out_handle = t;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    /* Only self-deletion is supported; the handle is kept alive for late notifiers */
+    /* 仅支持删除自身；句柄不释放，避免迟到的通知访问野指针 */
+    if (task == NULL || task == s_current_task) {
+        pthread_exit(NULL);
+    }
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    if (s_current_task == NULL) {
+        s_current_task = task_alloc();
+    }
+    return s_current_task;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    pthread_mutex_lock(&task->lock);
+    task->notify++;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+    TaskHandle_t t = xTaskGetCurrentTaskHandle();
+    pthread_mutex_lock(&t->lock);
+    WAIT_UNTIL(&t->cond, &t->lock, ticks, t->notify > 0);
+    uint32_t value = t->notify;
+    if (value > 0) {
+        t->notify = clear_on_exit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&t->lock);
+    return value;
+}
+
+/* ---------- timers ---------- */
+
+struct host_timer {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    TickType_t period;
+    bool auto_reload;
+    bool running;
+    bool deleted;
+    uint32_t generation;
+    void *id;
+    TimerCallbackFunction_t callback;
+};
+
+static void *timer_thread(void *arg) {
+    TimerHandle_t t = arg;
+    pthread_mutex_lock(&t->lock);
+    while (!t->deleted) {
+        if (!t->running) {
+            pthread_cond_wait(&t->cond, &t->lock);
+            continue;
+        }
+        uint32_t gen = t->generation;
+        struct timespec dl;
+        make_deadline(&dl, t->period);
+        int rc = 0;
+        while (t->running && !t->deleted && t->generation == gen && rc != ETIMEDOUT) {
+            rc = pthread_cond_timedwait(&t->cond, &t->lock, &dl);
+        }
+        if (rc == ETIMEDOUT && t->running && !t->deleted && t->generation == gen) {
+            if (!t->auto_reload) {
+                t->running = false;
+            }
+            pthread_mutex_unlock(&t->lock);
+            t->callback(t);
+            pthread_mutex_lock(&t->lock);
+        }
+    }
+    pthread_mutex_unlock(&t->lock);
+    pthread_cond_destroy(&t->cond);
+    pthread_mutex_destroy(&t->lock);
+    free(t);
+    return NULL;
+}
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t auto_reload,
+                           void *timer_id, TimerCallbackFunction_t callback) {
+    (void)name;
+    TimerHandle_t t = calloc(1, sizeof(*t));
+    if (t == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&t->lock, NULL);
+    init_cond(&t->cond);
+    t->period = period;
+    t->auto_reload = auto_reload != 0;
+    t->id = timer_id;
+    t->callback = callback;
+    if (pthread_create(&t->thread, NULL, timer_thread, t) != 0) {
+        free(t);
+        return NULL;
+    }
+    pthread_detach(t->thread);
+    return t;
+}
+
+static BaseType_t timer_update(TimerHandle_t t, bool running, TickType_t period) {
+    pthread_mutex_lock(&t->lock);
+    if (period) {
+        t->period = period;
+    }
+    t->running = running;
+    t->generation++;
+    pthread_cond_signal(&t->cond);
+    pthread_mutex_unlock(&t->lock);
+    return pdPASS;
+}
+
+BaseType_t xTimerStart(TimerHandle_t t, TickType_t ticks) {
+    (void)ticks;
+    return timer_update(t, true, 0);
+}
+
+BaseType_t xTimerReset(TimerHandle_t t, TickType_t ticks) {
+    (void)ticks;
+    return timer_update(t, true, 0);
+}
+
+BaseType_t xTimerStop(TimerHandle_t t, TickType_t ticks) {
+    (void)ticks;
+    return timer_update(t, false, 0);
+}
+
+BaseType_t xTimerChangePeriod(TimerHandle_t t, TickType_t period, TickType_t ticks) {
+    (void)ticks;
+    return timer_update(t, true, period);
+}
+
+BaseType_t xTimerDelete(TimerHandle_t t, TickType_t ticks) {
+    (void)ticks;
+    pthread_mutex_lock(&t->lock);
+    t->deleted = true;
+    pthread_cond_signal(&t->cond);
+    pthread_mutex_unlock(&t->lock);
+    return pdPASS;
+}
+
+void *pvTimerGetTimerID(TimerHandle_t t) {
+    return t->id;
+}
@@ -0,0 +1,81 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/* Counting wrappers for the libc allocator, see host_heap.h */
+/* libc 分配器的计数包装，见 host_heap.h */
+
+#define _GNU_SOURCE
+#include <malloc.h>
+#include <stdlib.h>
+
+#include "host_heap.h"
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+static host_heap_stats_t s_stats;
+
+void host_heap_get_stats(host_heap_stats_t *out) {
+    out->allocations = __atomic_load_n(&s_stats.allocations, __ATOMIC_RELAXED);
+    out->frees = __atomic_load_n(&s_stats.frees, __ATOMIC_RELAXED);
+    out->bytes_in_use = __atomic_load_n(&s_stats.bytes_in_use, __ATOMIC_RELAXED);
+}
+
+static void *count_allocation(void *ptr) {
+    if (ptr) {
+        __atomic_add_fetch(&s_stats.allocations, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&s_stats.bytes_in_use, (long long)malloc_usable_size(ptr), __ATOMIC_RELAXED);
+    }
+    return ptr;
+}
+
+static void count_free(void *ptr) {
+    if (ptr) {
+        __atomic_add_fetch(&s_stats.frees, 1, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&s_stats.bytes_in_use, (long long)malloc_usable_size(ptr), __ATOMIC_RELAXED);
+    }
+}
+
+void *__wrap_malloc(size_t size) {
+    return count_allocation(__real_malloc(size));
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    return count_allocation(__real_calloc(count, size));
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    size_t old_size = ptr ? malloc_usable_size(ptr) : 0;
+    void *result = __real_realloc(ptr, size);
+    if (result) {
+        if (ptr) {
+            __atomic_add_fetch(&s_stats.frees, 1, __ATOMIC_RELAXED);
+            __atomic_sub_fetch(&s_stats.bytes_in_use, (long long)old_size, __ATOMIC_RELAXED);
+        }
+        count_allocation(result);
+    }
+    return result;
+}
+
+void __wrap_free(void *ptr) {
+    count_free(ptr);
+    __real_free(ptr);
+}
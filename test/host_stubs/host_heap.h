@@ -0,0 +1,39 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Heap traffic counters for host tests. Link with
+ * -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free to route the code under test through them.
+ * 主机测试用的堆流量计数器。链接时加上上述 --wrap 选项，使被测代码的堆操作经过计数。
+ */
+
+#ifndef HOST_STUBS_HOST_HEAP_H
+#define HOST_STUBS_HOST_HEAP_H
+
+#include <stddef.h>
+
+typedef struct {
+    unsigned long allocations;   // malloc/calloc/realloc calls that returned memory / 成功的分配次数
+    unsigned long frees;         // free calls with a non-NULL pointer / 非空指针的释放次数
+    long long bytes_in_use;      // Usable bytes currently allocated / 当前已分配的可用字节数
+} host_heap_stats_t;
+
+void host_heap_get_stats(host_heap_stats_t *out);
+
+#endif
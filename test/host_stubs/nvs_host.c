@@ -0,0 +1,191 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * In-memory NVS for the host tools, see nvs.h. One flat table; namespaces only prefix the keys.
+ * 主机工具使用的内存 NVS，参见 nvs.h。仅一张平表，命名空间只作为键的前缀。
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "nvs.h"
+#include "nvs_flash.h"
+
+#define HOST_NVS_MAX_ENTRIES    32
+#define HOST_NVS_MAX_NAME       32
+#define HOST_NVS_MAX_VALUE      64
+#define HOST_NVS_MAX_HANDLES    8
+
+typedef struct {
+    char name[HOST_NVS_MAX_NAME];   // "namespace/key"
+    size_t length;
+    uint8_t value[HOST_NVS_MAX_VALUE];
+} host_nvs_entry_t;
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static host_nvs_entry_t s_entries[HOST_NVS_MAX_ENTRIES];
+static char s_namespaces[HOST_NVS_MAX_HANDLES + 1][16];
+static unsigned long s_writes;
+
+static void entry_name(nvs_handle_t handle, const char *key, char *out) {
+    snprintf(out, HOST_NVS_MAX_NAME, "%s/%s", s_namespaces[handle], key);
+}
+
+static host_nvs_entry_t *find_entry(nvs_handle_t handle, const char *key) {
+    char name[HOST_NVS_MAX_NAME];
+    entry_name(handle, key, name);
+    for (int i = 0; i < HOST_NVS_MAX_ENTRIES; i++) {
+        if (s_entries[i].name[0] != '\0' && strcmp(s_entries[i].name, name) == 0) {
+            return &s_entries[i];
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t get_value(nvs_handle_t handle, const char *key, void *out, size_t *length, bool exact) {
+    pthread_mutex_lock(&s_lock);
+    host_nvs_entry_t *e = find_entry(handle, key);
+    esp_err_t ret = ESP_OK;
+    if (e == NULL) {
+        ret = ESP_ERR_NVS_NOT_FOUND;
+    } else if (out == NULL) {
+        *length = e->length;
+    } else if (*length < e->length || (exact && *length != e->length)) {
+        ret = ESP_ERR_NVS_INVALID_LENGTH;
+    } else {
+        memcpy(out, e->value, e->length);
+        *length = e->length;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return ret;
+}
+
+static esp_err_t set_value(nvs_handle_t handle, const char *key, const void *value, size_t length) {
+    if (length > HOST_NVS_MAX_VALUE) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    pthread_mutex_lock(&s_lock);
+    host_nvs_entry_t *e = find_entry(handle, key);
+    for (int i = 0; e == NULL && i < HOST_NVS_MAX_ENTRIES; i++) {
+        if (s_entries[i].name[0] == '\0') {
+            e = &s_entries[i];
+            entry_name(handle, key, e->name);
+            e->length = (size_t)-1;
+        }
+    }
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    if (e != NULL) {
+        if (e->length != length || memcmp(e->value, value, length) != 0) {
+            memcpy(e->value, value, length);
+            e->length = length;
+            s_writes++;
+        }
+        ret = ESP_OK;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return ret;
+}
+
+esp_err_t nvs_flash_init(void) {
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void) {
+    pthread_mutex_lock(&s_lock);
+    memset(s_entries, 0, sizeof(s_entries));
+    pthread_mutex_unlock(&s_lock);
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *name_space, nvs_open_mode_t open_mode, nvs_handle_t *out_handle) {
+    pthread_mutex_lock(&s_lock);
+    nvs_handle_t handle = 0;
+    for (nvs_handle_t i = 1; i <= HOST_NVS_MAX_HANDLES; i++) {
+        if (strcmp(s_namespaces[i], name_space) == 0) {
+            handle = i;
+            break;
+        }
+        if (handle == 0 && s_namespaces[i][0] == '\0') {
+            handle = i;
+        }
+    }
+    if (handle != 0 && s_namespaces[handle][0] == '\0') {
+        snprintf(s_namespaces[handle], sizeof(s_namespaces[handle]), "%s", name_space);
+    }
+    pthread_mutex_unlock(&s_lock);
+    if (handle == 0) {
+        return ESP_ERR_NO_MEM;
+    }
+    *out_handle = handle;
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle) {
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key) {
+    pthread_mutex_lock(&s_lock);
+    host_nvs_entry_t *e = find_entry(handle, key);
+    if (e != NULL) {
+        memset(e, 0, sizeof(*e));
+        s_writes++;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return e != NULL ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length) {
+    return get_value(handle, key, out_value, length, false);
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length) {
+    return set_value(handle, key, value, length);
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char *key, uint8_t *out_value) {
+    size_t length = sizeof(*out_value);
+    return get_value(handle, key, out_value, &length, true);
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char *key, uint8_t value) {
+    return set_value(handle, key, &value, sizeof(value));
+}
+
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char *key, uint32_t *out_value) {
+    size_t length = sizeof(*out_value);
+    return get_value(handle, key, out_value, &length, true);
+}
+
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char *key, uint32_t value) {
+    return set_value(handle, key, &value, sizeof(value));
+}
+
+unsigned long host_nvs_write_count(void) {
+    pthread_mutex_lock(&s_lock);
+    unsigned long writes = s_writes;
+    pthread_mutex_unlock(&s_lock);
+    return writes;
+}
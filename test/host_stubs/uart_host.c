@@ -0,0 +1,78 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Unconnected UART for the host tools, see driver/uart.h.
+ * 供主机工具使用的未连接 UART，参见 driver/uart.h。
+ */
+
+#include "driver/uart.h"
+
+static size_t s_bytes_written;
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size, int queue_size,
+                              QueueHandle_t *uart_queue, int intr_alloc_flags) {
+    if (uart_queue != NULL) {
+        *uart_queue = queue_size > 0 ? xQueueCreate(queue_size, sizeof(uart_event_t)) : NULL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t *uart_config) {
+    return ESP_OK;
+}
+
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num, int rts_io_num, int cts_io_num) {
+    return ESP_OK;
+}
+
+int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t ticks_to_wait) {
+    return 0;
+}
+
+int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size) {
+    __atomic_fetch_add(&s_bytes_written, size, __ATOMIC_RELAXED);
+    return (int)size;
+}
+
+esp_err_t uart_enable_pattern_det_baud_intr(uart_port_t uart_num, char pattern_chr, uint8_t chr_num, int chr_tout,
+                                            int post_idle, int pre_idle) {
+    return ESP_OK;
+}
+
+esp_err_t uart_pattern_queue_reset(uart_port_t uart_num, int queue_length) {
+    return ESP_OK;
+}
+
+int uart_pattern_pop_pos(uart_port_t uart_num) {
+    return -1;
+}
+
+esp_err_t uart_get_buffered_data_len(uart_port_t uart_num, size_t *size) {
+    *size = 0;
+    return ESP_OK;
+}
+
+esp_err_t uart_flush_input(uart_port_t uart_num) {
+    return ESP_OK;
+}
+
+size_t host_uart_bytes_written(void) {
+    return __atomic_load_n(&s_bytes_written, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,246 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Benchmark of find_data_descriptor and the inbound parse path in protocol/.
+ * protocol/ 中 find_data_descriptor 及接收解析路径的基准测试。
+ *
+ * The lookup part times the direct-index dispatch against a reference copy of the previous
+ * linear scan, over the real descriptor list and over shuffled catalogues grown to 64 and 255
+ * entries. The parse part runs a mixed stream of camera frames through protocol_decode_frame and
+ * protocol_parse_data_into, the path notify_processing_task takes for every frame. Link against
+ * another revision of dji_protocol_data_processor.c to compare it (see README.md).
+ * 查找部分将直接索引分发与旧线性扫描的参考实现对比，覆盖真实描述符列表以及打乱顺序后扩充到 64 和 255 项的目录。
+ * 解析部分让混合的相机帧流依次经过 protocol_decode_frame 和 protocol_parse_data_into，
+ * 即 notify_processing_task 处理每帧的路径。可链接其他版本的 dji_protocol_data_processor.c 进行对比（见 README.md）。
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "custom_crc16.h"
+#include "custom_crc32.h"
+#include "dji_protocol_parser.h"
+#include "dji_protocol_data_processor.h"
+#include "dji_protocol_data_structures.h"
+#include "dji_protocol_reassembler.h"
+
+#define STREAM_FRAMES 1024
+#define LOOKUP_ROUNDS 200
+#define PARSE_ROUNDS  2000
+
+typedef struct {
+    uint8_t cmd_type;
+    uint8_t cmd_set;
+    uint8_t cmd_id;
+    size_t payload_length;
+    int weight;
+} traffic_t;
+
+/* Inbound traffic of a recording session, in frames per 100 / 一次录制会话的接收流量，每 100 帧中的帧数 */
+static const traffic_t s_traffic[] = {
+    { 0x00, 0x1D, 0x02, sizeof(camera_status_push_command_frame), 60 },
+    { 0x00, 0x1D, 0x06, sizeof(new_camera_status_push_command_frame), 15 },
+    { 0x20, 0x00, 0x17, sizeof(gps_data_push_response_frame), 8 },
+    { 0x20, 0x1D, 0x04, sizeof(camera_mode_switch_response_frame_t), 5 },
+    { 0x20, 0x1D, 0x03, sizeof(record_control_response_frame_t), 4 },
+    { 0x20, 0x00, 0x11, sizeof(key_report_response_frame_t), 3 },
+    { 0x20, 0x00, 0x00, 2 + 16 + 8, 2 },
+    { 0x00, 0x00, 0x19, sizeof(connection_request_command_frame), 1 },
+    { 0x00, 0x1D, 0x07, 4, 1 },   // not in the descriptor list / 不在描述符列表中
+    { 0x00, 0x0E, 0x01, 4, 1 },   // not in the descriptor list / 不在描述符列表中
+};
+
+typedef struct {
+    uint8_t data[PROTOCOL_MAX_FRAME_LENGTH];
+    size_t length;
+} frame_t;
+
+static frame_t s_frames[STREAM_FRAMES];
+static uint16_t s_keys[STREAM_FRAMES];
+static uint8_t s_parse_buffer[PROTOCOL_MAX_FRAME_LENGTH];
+
+static data_descriptor_t s_catalogue[255];
+
+static volatile uintptr_t s_sink;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* ---------- reference: the previous linear scan ---------- */
+
+static const data_descriptor_t *linear_find(const data_descriptor_t *table, size_t count, uint8_t cmd_set, uint8_t cmd_id) {
+    for (size_t i = 0; i < count; ++i) {
+        if (table[i].cmd_set == cmd_set && table[i].cmd_id == cmd_id) {
+            return &table[i];
+        }
+    }
+    return NULL;
+}
+
+/* The real descriptors plus unused keys, shuffled, as the list would look with more of the catalogue */
+/* 真实描述符加上未使用的键并打乱顺序，模拟收录更多命令后的列表 */
+static void build_catalogue(size_t count) {
+    size_t n = 0;
+    for (size_t i = 0; i < DATA_DESCRIPTORS_COUNT; i++) {
+        s_catalogue[n++] = data_descriptors[i];
+    }
+    for (uint16_t key = 0x4000; n < count; key++) {
+        s_catalogue[n].cmd_set = key >> 8;
+        s_catalogue[n].cmd_id = key & 0xFF;
+        s_catalogue[n].creator = NULL;
+        s_catalogue[n].parser = NULL;
+        n++;
+    }
+    for (size_t i = count - 1; i > 0; i--) {
+        size_t j = (size_t)rand() % (i + 1);
+        data_descriptor_t tmp = s_catalogue[i];
+        s_catalogue[i] = s_catalogue[j];
+        s_catalogue[j] = tmp;
+    }
+}
+
+/* ---------- mixed frame stream ---------- */
+
+static size_t build_frame(const traffic_t *traffic, uint16_t seq, uint8_t *out) {
+    size_t length = 16 + 2 + traffic->payload_length;
+    memset(out, 0, length);
+    out[0] = 0xAA;
+    out[1] = length & 0xFF;
+    out[2] = (length >> 8) & 0x03;
+    out[3] = traffic->cmd_type;
+    out[8] = seq & 0xFF;
+    out[9] = seq >> 8;
+    uint16_t crc16 = calculate_crc16(out, 10);
+    out[10] = crc16 & 0xFF;
+    out[11] = crc16 >> 8;
+    out[12] = traffic->cmd_set;
+    out[13] = traffic->cmd_id;
+    for (size_t i = 0; i < traffic->payload_length; i++) {
+        out[14 + i] = (uint8_t)rand();
+    }
+    uint32_t crc32 = calculate_crc32(out, length - 4);
+    out[length - 4] = crc32 & 0xFF;
+    out[length - 3] = (crc32 >> 8) & 0xFF;
+    out[length - 2] = (crc32 >> 16) & 0xFF;
+    out[length - 1] = (crc32 >> 24) & 0xFF;
+    return length;
+}
+
+static void build_stream(void) {
+    int total = 0;
+    for (size_t t = 0; t < sizeof(s_traffic) / sizeof(s_traffic[0]); t++) {
+        total += s_traffic[t].weight;
+    }
+    for (int i = 0; i < STREAM_FRAMES; i++) {
+        int pick = rand() % total;
+        size_t t = 0;
+        while (pick >= s_traffic[t].weight) {
+            pick -= s_traffic[t].weight;
+            t++;
+        }
+        s_frames[i].length = build_frame(&s_traffic[t], (uint16_t)i, s_frames[i].data);
+        s_keys[i] = (s_traffic[t].cmd_set << 8) | s_traffic[t].cmd_id;
+    }
+}
+
+/* ---------- measurements ---------- */
+
+static double time_direct_lookup(void) {
+    uintptr_t acc = 0;
+    double start = now_ns();
+    for (int round = 0; round < LOOKUP_ROUNDS; round++) {
+        for (int i = 0; i < STREAM_FRAMES; i++) {
+            acc += (uintptr_t)find_data_descriptor(s_keys[i] >> 8, s_keys[i] & 0xFF);
+        }
+    }
+    double elapsed = now_ns() - start;
+    s_sink = acc;
+    return elapsed / ((double)LOOKUP_ROUNDS * STREAM_FRAMES);
+}
+
+static double time_linear_lookup(const data_descriptor_t *table, size_t count) {
+    uintptr_t acc = 0;
+    double start = now_ns();
+    for (int round = 0; round < LOOKUP_ROUNDS; round++) {
+        for (int i = 0; i < STREAM_FRAMES; i++) {
+            acc += (uintptr_t)linear_find(table, count, s_keys[i] >> 8, s_keys[i] & 0xFF);
+        }
+    }
+    double elapsed = now_ns() - start;
+    s_sink = acc;
+    return elapsed / ((double)LOOKUP_ROUNDS * STREAM_FRAMES);
+}
+
+static int check_lookup(void) {
+    int mismatches = 0;
+    for (int key = 0; key < 0x10000; key++) {
+        if (find_data_descriptor(key >> 8, key & 0xFF) != linear_find(data_descriptors, DATA_DESCRIPTORS_COUNT, key >> 8, key & 0xFF)) {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+int main(void) {
+    srand(1);
+    build_stream();
+
+    int mismatches = check_lookup();
+    printf("find_data_descriptor vs linear scan over all 65536 keys: %s\n", mismatches ? "MISMATCH" : "identical");
+    if (mismatches) {
+        return 1;
+    }
+
+    printf("\nlookup over the mixed key stream (%d keys)\n", STREAM_FRAMES);
+    printf("descriptors   linear ns   direct ns  speedup\n");
+    double direct = time_direct_lookup();
+    double linear = time_linear_lookup(data_descriptors, DATA_DESCRIPTORS_COUNT);
+    printf("%11zu  %10.2f  %10.2f  %6.1fx\n", DATA_DESCRIPTORS_COUNT, linear, direct, linear / direct);
+    size_t sizes[] = { 64, 255 };
+    for (size_t s = 0; s < 2; s++) {
+        build_catalogue(sizes[s]);
+        linear = time_linear_lookup(s_catalogue, sizes[s]);
+        printf("%11zu  %10.2f  %10.2f  %6.1fx\n", sizes[s], linear, direct, linear / direct);
+    }
+
+    int parsed = 0;
+    double start = now_ns();
+    for (int round = 0; round < PARSE_ROUNDS; round++) {
+        for (int i = 0; i < STREAM_FRAMES; i++) {
+            protocol_frame_t frame;
+            size_t parse_length;
+            protocol_decode_frame(s_frames[i].data, s_frames[i].length, &frame);
+            if (protocol_parse_data_into(frame.data, frame.data_length, frame.cmd_type,
+                                         s_parse_buffer, sizeof(s_parse_buffer), &parse_length) == 0) {
+                parsed++;
+            }
+        }
+    }
+    double per_frame = (now_ns() - start) / ((double)PARSE_ROUNDS * STREAM_FRAMES);
+    printf("\nmixed frame stream: %.1f ns/frame, %.2f M frames/s, %d of %d parsed\n",
+           per_frame, 1e3 / per_frame, parsed / PARSE_ROUNDS, STREAM_FRAMES);
+    return 0;
+}
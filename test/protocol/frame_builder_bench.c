@@ -0,0 +1,234 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Benchmark of building outgoing GPS push (0x00/0x17) frames.
+ * 构建发送方向 GPS 推送 (0x00/0x17) 帧的基准测试。
+ *
+ * Times protocol_create_frame_into on a stack buffer, as command_submit uses it, against a
+ * reference copy of the previous path (the creator mallocs the payload, the frame is malloc'ed,
+ * cleared and the payload copied in) and against the protocol_create_frame wrapper. The three
+ * must produce the same bytes, and protocol_create_frame_into must not touch the heap.
+ * 测量 command_submit 所用的栈缓冲区 protocol_create_frame_into，对比旧路径的参考实现
+ * （creator 分配负载内存，再分配帧内存、清零并拷入负载）以及 protocol_create_frame 封装。
+ * 三者输出必须逐字节一致，且 protocol_create_frame_into 不得使用堆内存。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "custom_crc16.h"
+#include "custom_crc32.h"
+#include "dji_protocol_parser.h"
+#include "dji_protocol_data_structures.h"
+#include "host_heap.h"
+
+#define GPS_CMD_SET   0x00
+#define GPS_CMD_ID    0x17
+#define GPS_SAMPLES   64
+#define FRAME_BUFFER  128
+#define DEFAULT_ROUNDS 200000
+
+static gps_data_push_command_frame s_samples[GPS_SAMPLES];
+static volatile uint32_t s_sink;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* ---------- reference: the previous heap-based path ---------- */
+
+static uint8_t *reference_gps_creator(const void *structure, size_t *data_length) {
+    *data_length = sizeof(gps_data_push_command_frame);
+    uint8_t *data = (uint8_t *)malloc(*data_length);
+    if (data == NULL) {
+        return NULL;
+    }
+    memcpy(data, structure, *data_length);
+    return data;
+}
+
+static uint8_t *reference_create_frame(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const void *structure,
+                                       uint16_t seq, size_t *frame_length_out) {
+    size_t data_length = 0;
+    uint8_t *payload = reference_gps_creator(structure, &data_length);
+    if (payload == NULL) {
+        return NULL;
+    }
+
+    *frame_length_out = 14 + data_length + 4;
+    uint8_t *frame = (uint8_t *)malloc(*frame_length_out);
+    if (frame == NULL) {
+        free(payload);
+        return NULL;
+    }
+    memset(frame, 0, *frame_length_out);
+
+    size_t offset = 0;
+    frame[offset++] = 0xAA;
+    frame[offset++] = *frame_length_out & 0xFF;
+    frame[offset++] = (*frame_length_out >> 8) & 0x03;
+    frame[offset++] = cmd_type;
+    offset += 4;   // ENC and RES, left zero / ENC 与 RES 保持为 0
+    frame[offset++] = seq & 0xFF;
+    frame[offset++] = (seq >> 8) & 0xFF;
+    uint16_t crc16 = calculate_crc16(frame, offset);
+    frame[offset++] = crc16 & 0xFF;
+    frame[offset++] = (crc16 >> 8) & 0xFF;
+    frame[offset++] = cmd_set;
+    frame[offset++] = cmd_id;
+    memcpy(&frame[offset], payload, data_length);
+    offset += data_length;
+    uint32_t crc32 = calculate_crc32(frame, offset);
+    for (int i = 0; i < 4; i++) {
+        frame[offset++] = (crc32 >> (8 * i)) & 0xFF;
+    }
+
+    free(payload);
+    return frame;
+}
+
+/* ---------- samples ---------- */
+
+static void build_samples(void) {
+    srand(0x0017);
+    for (int i = 0; i < GPS_SAMPLES; i++) {
+        gps_data_push_command_frame *g = &s_samples[i];
+        g->year_month_day = 20250312;
+        g->hour_minute_second = 180000 + i;
+        g->gps_longitude = 1139421000 + rand() % 10000;
+        g->gps_latitude = 225253000 + rand() % 10000;
+        g->height = 45000 + rand() % 1000;
+        g->speed_to_north = (float)(rand() % 500) / 10.0f;
+        g->speed_to_east = (float)(rand() % 500) / 10.0f;
+        g->speed_to_wnward = 0.0f;
+        g->vertical_accuracy = 2000;
+        g->horizontal_accuracy = 1500;
+        g->speed_accuracy = 30;
+        g->satellite_number = 8 + i % 12;
+    }
+}
+
+/* ---------- checks ---------- */
+
+static int check_identical(void) {
+    for (int i = 0; i < GPS_SAMPLES; i++) {
+        uint16_t seq = (uint16_t)(0x1234 + i);
+        uint8_t frame[FRAME_BUFFER];
+        size_t length = 0, reference_length = 0, wrapper_length = 0;
+
+        if (protocol_create_frame_into(GPS_CMD_SET, GPS_CMD_ID, 0x00, &s_samples[i], seq,
+                                       frame, sizeof(frame), &length) != 0) {
+            printf("FAIL: protocol_create_frame_into rejected sample %d\n", i);
+            return -1;
+        }
+        uint8_t *reference = reference_create_frame(GPS_CMD_SET, GPS_CMD_ID, 0x00, &s_samples[i], seq, &reference_length);
+        uint8_t *wrapper = protocol_create_frame(GPS_CMD_SET, GPS_CMD_ID, 0x00, &s_samples[i], seq, &wrapper_length);
+        int same = reference != NULL && wrapper != NULL &&
+                   length == reference_length && length == wrapper_length &&
+                   memcmp(frame, reference, length) == 0 && memcmp(frame, wrapper, length) == 0;
+        free(reference);
+        free(wrapper);
+        if (!same) {
+            printf("FAIL: sample %d differs from the previous frame builder\n", i);
+            return -1;
+        }
+    }
+
+    // A buffer one byte short must be refused and still report the length
+    // 缓冲区少一个字节时必须拒绝，并仍给出所需长度
+    uint8_t frame[FRAME_BUFFER];
+    size_t length = 0;
+    size_t needed = 18 + sizeof(gps_data_push_command_frame);
+    if (protocol_create_frame_into(GPS_CMD_SET, GPS_CMD_ID, 0x00, &s_samples[0], 0,
+                                   frame, needed - 1, &length) != -3 || length != needed) {
+        printf("FAIL: short buffer not rejected with -3 and the required length\n");
+        return -1;
+    }
+    if (protocol_create_frame_into(0x00, 0x7F, 0x00, &s_samples[0], 0, frame, sizeof(frame), &length) != -1) {
+        printf("FAIL: unknown command not rejected\n");
+        return -1;
+    }
+    return 0;
+}
+
+/* ---------- timing ---------- */
+
+typedef enum { PATH_REFERENCE, PATH_WRAPPER, PATH_IN_PLACE } build_path_t;
+
+static void time_path(const char *name, build_path_t path, int rounds, double *ns_out, double *allocs_out) {
+    host_heap_stats_t before, after;
+    host_heap_get_stats(&before);
+    double start = now_ns();
+    for (int round = 0; round < rounds; round++) {
+        const gps_data_push_command_frame *sample = &s_samples[round % GPS_SAMPLES];
+        uint16_t seq = (uint16_t)round;
+        size_t length = 0;
+        if (path == PATH_IN_PLACE) {
+            uint8_t frame[FRAME_BUFFER];
+            protocol_create_frame_into(GPS_CMD_SET, GPS_CMD_ID, 0x00, sample, seq, frame, sizeof(frame), &length);
+            s_sink += frame[length - 1];
+        } else {
+            uint8_t *frame = path == PATH_REFERENCE
+                ? reference_create_frame(GPS_CMD_SET, GPS_CMD_ID, 0x00, sample, seq, &length)
+                : protocol_create_frame(GPS_CMD_SET, GPS_CMD_ID, 0x00, sample, seq, &length);
+            s_sink += frame[length - 1];
+            free(frame);
+        }
+    }
+    double per_frame = (now_ns() - start) / rounds;
+    host_heap_get_stats(&after);
+    double allocs = (double)(after.allocations - before.allocations) / rounds;
+    printf("%-28s %8.1f %12.2f %14.2f\n", name, per_frame, 1e3 / per_frame, allocs);
+    *ns_out = per_frame;
+    *allocs_out = allocs;
+}
+
+int main(int argc, char **argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : DEFAULT_ROUNDS;
+    if (rounds <= 0) {
+        rounds = DEFAULT_ROUNDS;
+    }
+
+    build_samples();
+    if (check_identical() != 0) {
+        return 1;
+    }
+    printf("%d GPS push frames of %zu bytes match the previous builder byte for byte\n\n",
+           GPS_SAMPLES, 18 + sizeof(gps_data_push_command_frame));
+
+    double reference_ns, wrapper_ns, in_place_ns;
+    double reference_allocs, wrapper_allocs, in_place_allocs;
+    printf("%-28s %8s %12s %14s\n", "path", "ns/frame", "M frames/s", "allocs/frame");
+    time_path("previous (malloc x2)", PATH_REFERENCE, rounds, &reference_ns, &reference_allocs);
+    time_path("protocol_create_frame", PATH_WRAPPER, rounds, &wrapper_ns, &wrapper_allocs);
+    time_path("protocol_create_frame_into", PATH_IN_PLACE, rounds, &in_place_ns, &in_place_allocs);
+    printf("\nin place vs previous: %.2fx\n", reference_ns / in_place_ns);
+
+    if (in_place_allocs != 0.0) {
+        printf("FAIL: protocol_create_frame_into allocated %.2f times per frame\n", in_place_allocs);
+        return 1;
+    }
+    printf("PASS: zero heap allocations per in-place frame\n");
+    return 0;
+}
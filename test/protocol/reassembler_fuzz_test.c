@@ -0,0 +1,306 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright (C) 2025 SZ DJI Technology Co., Ltd.
+ *  
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI's authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ */
+
+/*
+ * Fuzz/replay test of the streaming frame reassembler in protocol/dji_protocol_reassembler.c.
+ * protocol/dji_protocol_reassembler.c 中流式帧重组器的模糊/回放测试。
+ *
+ * A corpus of frames shaped like a camera session (status pushes, command responses, the
+ * connection request, empty and near-maximum frames) is concatenated and cut at random
+ * boundaries, with garbage, corrupted and truncated frames mixed in. Every scenario checks that
+ * exactly the intact frames come out, byte for byte and in order, and that each of them passes
+ * protocol_parse_notification.
+ * 将形如一次相机会话的帧（状态推送、命令应答、连接请求、空帧和接近最大长度的帧）首尾相接后在随机位置切分，
+ * 并混入无效数据、损坏帧和截断帧。每个场景都检查输出的恰好是完好的帧，逐字节一致且顺序不变，
+ * 并且每一帧都能通过 protocol_parse_notification。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "custom_crc16.h"
+#include "custom_crc32.h"
+#include "dji_protocol_parser.h"
+#include "dji_protocol_reassembler.h"
+
+#define DEFAULT_ROUNDS 2000
+#define CORPUS_FRAMES  48
+#define STREAM_CAPACITY (CORPUS_FRAMES * (PROTOCOL_MAX_FRAME_LENGTH + 64))
+
+/* Largest notification payload at the MTU the remote offers (500 - ATT header) */
+/* 本端提供的 MTU 下单条通知的最大负载（500 减去 ATT 头） */
+#define MAX_CHUNK 497
+
+typedef struct {
+    uint8_t cmd_type;
+    uint8_t cmd_set;
+    uint8_t cmd_id;
+    size_t payload_length;
+} frame_shape_t;
+
+/* Frames a camera sends during a session / 一次会话中相机发送的帧 */
+static const frame_shape_t s_shapes[] = {
+    { 0x00, 0x1D, 0x02, 38 },   // status push / 状态推送
+    { 0x00, 0x1D, 0x06, 120 },  // new status push / 新状态推送
+    { 0x20, 0x00, 0x01, 33 },   // version response / 版本号应答
+    { 0x20, 0x1D, 0x04, 1 },    // mode switch response / 模式切换应答
+    { 0x00, 0x00, 0x19, 33 },   // connection request / 连接请求
+    { 0x20, 0x00, 0x17, 1 },    // GPS push ack / GPS 推送应答
+    { 0x20, 0x00, 0x00, 0 },    // CmdSet/CmdID only / 仅含 CmdSet/CmdID
+    { 0x00, 0xFF, 0xFF, PROTOCOL_MAX_FRAME_LENGTH - 18 },  // largest frame / 最大帧
+};
+
+typedef struct {
+    uint8_t data[PROTOCOL_MAX_FRAME_LENGTH];
+    size_t length;
+} frame_t;
+
+static frame_t s_corpus[CORPUS_FRAMES];
+static frame_t s_received[CORPUS_FRAMES * 2];
+static size_t s_received_count;
+static bool s_parse_failed;
+
+static uint8_t s_stream[STREAM_CAPACITY];
+
+static int s_failures;
+
+#define CHECK(cond, ...)                                      \
+    do {                                                      \
+        if (!(cond)) {                                        \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);       \
+            printf(__VA_ARGS__);                              \
+            printf("\n");                                     \
+            s_failures++;                                     \
+        }                                                     \
+    } while (0)
+
+static size_t build_frame(const frame_shape_t *shape, uint16_t seq, uint8_t *out) {
+    size_t length = 16 + 2 + shape->payload_length;
+    out[0] = 0xAA;
+    out[1] = length & 0xFF;
+    out[2] = (length >> 8) & 0x03;
+    out[3] = shape->cmd_type;
+    memset(&out[4], 0, 4);
+    out[8] = seq & 0xFF;
+    out[9] = seq >> 8;
+    uint16_t crc16 = calculate_crc16(out, 10);
+    out[10] = crc16 & 0xFF;
+    out[11] = crc16 >> 8;
+    out[12] = shape->cmd_set;
+    out[13] = shape->cmd_id;
+    for (size_t i = 0; i < shape->payload_length; i++) {
+        // Plenty of SOF bytes inside the payload to tempt the resync / 负载中含大量 SOF 字节以考验重同步
+        out[14 + i] = (rand() % 4 == 0) ? 0xAA : (uint8_t)rand();
+    }
+    uint32_t crc32 = calculate_crc32(out, length - 4);
+    out[length - 4] = crc32 & 0xFF;
+    out[length - 3] = (crc32 >> 8) & 0xFF;
+    out[length - 2] = (crc32 >> 16) & 0xFF;
+    out[length - 1] = (crc32 >> 24) & 0xFF;
+    return length;
+}
+
+static void build_corpus(void) {
+    for (int i = 0; i < CORPUS_FRAMES; i++) {
+        const frame_shape_t *shape = &s_shapes[rand() % (sizeof(s_shapes) / sizeof(s_shapes[0]))];
+        s_corpus[i].length = build_frame(shape, (uint16_t)rand(), s_corpus[i].data);
+    }
+}
+
+static void on_frame(const uint8_t *frame, size_t frame_length, void *ctx) {
+    protocol_frame_t parsed;
+    if (protocol_parse_notification(frame, frame_length, &parsed) != 0) {
+        s_parse_failed = true;
+    }
+    if (s_received_count < sizeof(s_received) / sizeof(s_received[0])) {
+        memcpy(s_received[s_received_count].data, frame, frame_length);
+        s_received[s_received_count].length = frame_length;
+    }
+    s_received_count++;
+}
+
+/* Feed the stream in random chunks of 1..max_chunk bytes / 以 1..max_chunk 字节的随机块送入数据流 */
+static void feed_fragmented(protocol_reassembler_t *reassembler, const uint8_t *stream, size_t length, size_t max_chunk) {
+    size_t pos = 0;
+    while (pos < length) {
+        size_t chunk = 1 + (size_t)rand() % max_chunk;
+        if (chunk > length - pos) {
+            chunk = length - pos;
+        }
+        protocol_reassembler_feed(reassembler, stream + pos, chunk);
+        pos += chunk;
+    }
+}
+
+static size_t append(size_t pos, const uint8_t *data, size_t length) {
+    memcpy(s_stream + pos, data, length);
+    return pos + length;
+}
+
+/* Garbage between frames, biased towards SOF bytes / 帧之间的无效数据，偏向 SOF 字节 */
+static size_t append_garbage(size_t pos, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        s_stream[pos + i] = (rand() % 3 == 0) ? 0xAA : (uint8_t)rand();
+    }
+    return pos + length;
+}
+
+/* Compare the received frames with the expected corpus indices / 将收到的帧与期望的语料下标对比 */
+static bool expect_frames(const char *scenario, const int *expected, size_t expected_count) {
+    bool ok = !s_parse_failed && s_received_count == expected_count;
+    for (size_t i = 0; ok && i < expected_count; i++) {
+        const frame_t *want = &s_corpus[expected[i]];
+        ok = s_received[i].length == want->length && memcmp(s_received[i].data, want->data, want->length) == 0;
+    }
+    CHECK(ok, "%s: got %zu frames, expected %zu%s", scenario, s_received_count, expected_count,
+          s_parse_failed ? ", parse failed" : "");
+    return ok;
+}
+
+static void reset_received(void) {
+    s_received_count = 0;
+    s_parse_failed = false;
+}
+
+/* Clean stream, cut anywhere from single bytes to several frames per chunk / 干净的数据流，切分从单字节到单块多帧不等 */
+static void scenario_fragmented(void) {
+    int expected[CORPUS_FRAMES];
+    size_t length = 0;
+    for (int i = 0; i < CORPUS_FRAMES; i++) {
+        length = append(length, s_corpus[i].data, s_corpus[i].length);
+        expected[i] = i;
+    }
+
+    protocol_reassembler_t reassembler;
+    protocol_reassembler_init(&reassembler, on_frame, NULL);
+    reset_received();
+    size_t max_chunks[] = { 1, 20, MAX_CHUNK, 4 * MAX_CHUNK };
+    feed_fragmented(&reassembler, s_stream, length, max_chunks[rand() % 4]);
+    expect_frames("fragmented", expected, CORPUS_FRAMES);
+    CHECK(reassembler.discarded_bytes == 0, "fragmented: %u bytes discarded", (unsigned)reassembler.discarded_bytes);
+    CHECK(reassembler.length == 0, "fragmented: %zu bytes left over", reassembler.length);
+}
+
+/* Garbage between frames must be skipped and counted exactly / 帧间无效数据必须被跳过且计数准确 */
+static void scenario_garbage(void) {
+    int expected[CORPUS_FRAMES];
+    size_t length = 0;
+    size_t garbage = 0;
+    for (int i = 0; i < CORPUS_FRAMES; i++) {
+        size_t n = (size_t)rand() % 40;
+        length = append_garbage(length, n);
+        garbage += n;
+        length = append(length, s_corpus[i].data, s_corpus[i].length);
+        expected[i] = i;
+    }
+
+    protocol_reassembler_t reassembler;
+    protocol_reassembler_init(&reassembler, on_frame, NULL);
+    reset_received();
+    feed_fragmented(&reassembler, s_stream, length, MAX_CHUNK);
+    // A false SOF near the end can pass the header CRC-16 (1 in 65536) and wait for bytes that never come
+    // 末尾附近的伪 SOF 可能通过帧头 CRC-16（1/65536），并等待永远不会到来的字节
+    protocol_reassembler_flush(&reassembler);
+    expect_frames("garbage", expected, CORPUS_FRAMES);
+    CHECK(reassembler.discarded_bytes == garbage, "garbage: discarded %u of %zu bytes",
+          (unsigned)reassembler.discarded_bytes, garbage);
+}
+
+/* Corrupted and truncated frames are dropped, the frame after them still arrives / 损坏帧和截断帧被丢弃，其后的帧仍能收到 */
+static void scenario_damaged(void) {
+    int expected[CORPUS_FRAMES];
+    size_t expected_count = 0;
+    size_t length = 0;
+    for (int i = 0; i < CORPUS_FRAMES; i++) {
+        const frame_t *frame = &s_corpus[i];
+        size_t start = length;
+        switch (rand() % 6) {
+        case 0:
+            // Flip one byte anywhere in the frame / 翻转帧内任意一个字节
+            length = append(length, frame->data, frame->length);
+            s_stream[start + (size_t)rand() % frame->length] ^= (uint8_t)(1 + rand() % 255);
+            break;
+        case 1: {
+            // Lose the tail, as if a notification went missing. If the first lost byte were a SOF,
+            // the next frame would complete this one for real, so cut elsewhere
+            // 丢失帧尾，如同一条通知丢失。若丢失的第一个字节恰为 SOF，下一帧会真正补全本帧，因此换个位置截断
+            size_t cut;
+            do {
+                cut = 1 + (size_t)rand() % (frame->length - 1);
+            } while (frame->data[cut] == 0xAA);
+            length = append(length, frame->data, cut);
+            break;
+        }
+        default:
+            length = append(length, frame->data, frame->length);
+            expected[expected_count++] = i;
+            break;
+        }
+    }
+    protocol_reassembler_t reassembler;
+    protocol_reassembler_init(&reassembler, on_frame, NULL);
+    reset_received();
+    feed_fragmented(&reassembler, s_stream, length, MAX_CHUNK);
+    // The link goes quiet, release the frames held behind a truncated one / 链路空闲，释放被截断帧扣留的帧
+    protocol_reassembler_flush(&reassembler);
+    expect_frames("damaged", expected, expected_count);
+}
+
+/* Frames inside one chunk are handed out in place / 位于单个数据块内的帧原地交出 */
+static const uint8_t *s_chunk_begin;
+static const uint8_t *s_chunk_end;
+static size_t s_in_place;
+
+static void on_frame_in_place(const uint8_t *frame, size_t frame_length, void *ctx) {
+    if (frame >= s_chunk_begin && frame + frame_length <= s_chunk_end) {
+        s_in_place++;
+    }
+}
+
+static void scenario_in_place(void) {
+    size_t length = 0;
+    for (int i = 0; i < CORPUS_FRAMES; i++) {
+        length = append(length, s_corpus[i].data, s_corpus[i].length);
+    }
+    protocol_reassembler_t reassembler;
+    protocol_reassembler_init(&reassembler, on_frame_in_place, NULL);
+    s_chunk_begin = s_stream;
+    s_chunk_end = s_stream + length;
+    s_in_place = 0;
+    protocol_reassembler_feed(&reassembler, s_stream, length);
+    CHECK(s_in_place == CORPUS_FRAMES, "in place: %zu of %d frames", s_in_place, CORPUS_FRAMES);
+}
+
+int main(int argc, char **argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : DEFAULT_ROUNDS;
+
+    srand(0x3aa3);
+    for (int round = 0; round < rounds && s_failures == 0; round++) {
+        build_corpus();
+        scenario_fragmented();
+        scenario_garbage();
+        scenario_damaged();
+        scenario_in_place();
+    }
+
+    printf("reassembler fuzz, %d rounds of %d frames: %s\n", rounds, CORPUS_FRAMES, s_failures ? "FAIL" : "PASS");
+    return s_failures ? 1 : 0;
+}
@@ -112,17 +112,20 @@ static void ble_send_timer_callback(void* arg) {
     const uint8_t* data = ble_test_packets[ble_test_index];
     size_t length = sizeof(ble_test_packets[ble_test_index]);
 
-    esp_err_t ret = ble_write_with_response(
+    // Bulk priority: the test frames queue behind commands and real GPS pushes when the controller is busy
+    // 批量优先级：控制器繁忙时，测试帧排在命令与真实 GPS 推送之后
+    esp_err_t ret = ble_write_without_response_prio(
         s_ble_profile.conn_id,
         s_ble_profile.write_char_handle,
         data,
-        length
+        length,
+        BLE_TX_PRIO_BULK
     );
 
     if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "Sent packet %zu", ble_test_index);
+        ESP_LOGI(TAG, "Queued packet %zu", ble_test_index);
     } else {
-        ESP_LOGE(TAG, "Failed to send packet %zu, err: 0x%x", ble_test_index, ret);
+        ESP_LOGE(TAG, "Failed to queue packet %zu, err: 0x%x", ble_test_index, ret);
     }
 
     ble_test_index++;